@@ -0,0 +1,200 @@
+#pragma once
+
+/**
+ * @file        bench.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the harness shared by the benchmarks:
+ *              every case is calibrated until a sample lasts long enough to be
+ *              measured, then it is sampled a few times and the results are
+ *              written as JSON, to the standard output or to the file named by
+ *              the --json option.
+ */
+
+#ifndef CLOX_BENCH_BENCH_H_
+#define CLOX_BENCH_BENCH_H_
+
+#include "clox/base/clock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BENCH_SAMPLE_TIME
+/**
+ * @brief       The minimum duration of a sample, in nanoseconds.
+ */
+#   define BENCH_SAMPLE_TIME UINT64_C(50000000)
+#endif
+
+#ifndef BENCH_SAMPLES_COUNT
+/**
+ * @brief       The number of samples of each case, the reported time is their
+ *              median.
+ */
+#   define BENCH_SAMPLES_COUNT 5
+#endif
+
+/**
+ * @brief       A benchmark case, it runs the measured operation iterations
+ *              times.
+ */
+typedef void (*BenchCase_t)(void *data, size_t iterations);
+
+/**
+ * @brief       A benchmark suite.
+ */
+typedef struct _Bench
+{
+    /**
+     * @brief   The name of the suite.
+     */
+    const char *suite;
+    /**
+     * @brief   The stream to which the results are written.
+     */
+    FILE       *stream;
+    /**
+     * @brief   The number of results written so far.
+     */
+    size_t      count;
+    /**
+     * @brief   The minimum duration of a sample, shortened by --quick.
+     */
+    uint64_t    sampleTime;
+} Bench_t;
+
+/**
+ * @brief       A sink for the results of the measured operations, which keeps
+ *              the compiler from optimizing them away.
+ */
+static volatile uint64_t benchSink;
+
+static int benchCompare(const void *x, const void *y)
+{
+    const uint64_t a = *(const uint64_t *)x, b = *(const uint64_t *)y;
+
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief       Opens a suite, consuming its options (--json <path> and --quick)
+ *              from the command line arguments: the arguments left are moved to
+ *              the front of argv.
+ *
+ * @return      The number of arguments left, or -1 on failure.
+ */
+static int benchOpen(Bench_t *const bench, const char *const suite, int argc, char **argv)
+{
+    int i, count = 0;
+
+    bench->suite = suite;
+    bench->stream = stdout;
+    bench->count = 0;
+    bench->sampleTime = BENCH_SAMPLE_TIME;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--json") && ((i + 1) < argc))
+        {
+            if (!(bench->stream = fopen(argv[++i], "w")))
+            {
+                fprintf(stderr, "error: cannot write '%s'\n", argv[i]);
+                return -1;
+            }
+        }
+        else if (!strcmp(argv[i], "--quick"))
+        {
+            bench->sampleTime /= 50;
+        }
+        else
+        {
+            argv[count++] = argv[i];
+        }
+    }
+
+    fprintf(bench->stream, "{\n  \"suite\": \"%s\",\n  \"unit\": \"ns\",\n  \"results\": [", suite);
+
+    return count;
+}
+
+/**
+ * @brief       Measures a case and writes its result.
+ *
+ * @param       name The name of the case.
+ * @param       function The case to measure.
+ * @param       data The data passed to the case.
+ * @param       bytes The number of bytes processed by an iteration, zero when
+ *              the throughput isn't meaningful.
+ */
+static void benchRun(Bench_t *const bench, const char *const name, const BenchCase_t function, void *const data, const size_t bytes)
+{
+    uint64_t samples[BENCH_SAMPLES_COUNT], begin, elapsed;
+    size_t iterations = 1;
+    int i;
+
+    /* the iterations double until a sample lasts long enough */
+    for (;;)
+    {
+        begin = cloxClockNow();
+        function(data, iterations);
+        elapsed = cloxClockNow() - begin;
+
+        if ((elapsed >= bench->sampleTime) || (iterations >= (SIZE_MAX / 2)))
+            break;
+        else if (elapsed < (bench->sampleTime / 16))
+            iterations *= 8;
+        else
+            iterations *= 2;
+    }
+
+    for (i = 0; i < BENCH_SAMPLES_COUNT; i++)
+    {
+        begin = cloxClockNow();
+        function(data, iterations);
+        samples[i] = cloxClockNow() - begin;
+    }
+
+    qsort(samples, BENCH_SAMPLES_COUNT, sizeof(samples[0]), &benchCompare);
+
+    const double median = (double)samples[BENCH_SAMPLES_COUNT / 2] / (double)iterations;
+    const double fastest = (double)samples[0] / (double)iterations;
+
+    fprintf(bench->stream, "%s\n    {\"name\": \"%s\", \"iterations\": %zu, \"samples\": %d, \"ns_per_op\": %.3f, \"min_ns_per_op\": %.3f",
+            bench->count ? "," : "", name, iterations, BENCH_SAMPLES_COUNT, median, fastest);
+
+    if (bytes)
+        fprintf(bench->stream, ", \"bytes_per_op\": %zu, \"bytes_per_second\": %.0f", bytes, (double)bytes * 1e9 / median);
+
+    fputc('}', bench->stream);
+    fflush(bench->stream);
+
+    if (bench->stream != stdout)
+        fprintf(stdout, "%-32s %12.3f ns/op\n", name, median);
+
+    bench->count++;
+}
+
+/**
+ * @brief       Closes a suite.
+ *
+ * @return      The exit code of the benchmark.
+ */
+static int benchClose(Bench_t *const bench)
+{
+    fputs("\n  ]\n}\n", bench->stream);
+
+    if (bench->stream != stdout)
+        fclose(bench->stream);
+
+    return EXIT_SUCCESS;
+}
+
+#endif /* CLOX_BENCH_BENCH_H_ */
@@ -0,0 +1,110 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/vm/code_block.h"
+
+#include "bench.h"
+
+/* the number of bytes emitted before the block starts over */
+#define BLOCK_SIZE 65536
+
+typedef struct _Chunk
+{
+    CloxCodeBlock_t *codeBlock;
+    byte_t           buffer[4096];
+    size_t           size;
+} Chunk_t;
+
+/* pushes into a block which already has the capacity it needs */
+static void benchPush(void *data, size_t iterations)
+{
+    CloxCodeBlock_t *const codeBlock = (CloxCodeBlock_t *)data;
+
+    while (iterations--)
+    {
+        if (codeBlock->count == BLOCK_SIZE)
+            codeBlock->count = 0;
+
+        cloxCodeBlockPush(codeBlock, (byte_t)iterations);
+    }
+
+    benchSink += codeBlock->count;
+}
+
+/* pushes into new blocks, paying for their growth */
+static void benchPushGrowing(void *data, size_t iterations)
+{
+    CloxCodeBlock_t *codeBlock = cloxCreateCodeBlock(0);
+
+    (void)data;
+
+    while (iterations--)
+    {
+        if (codeBlock->count == BLOCK_SIZE)
+        {
+            cloxDeleteCodeBlock(codeBlock);
+            codeBlock = cloxCreateCodeBlock(0);
+        }
+
+        cloxCodeBlockPush(codeBlock, (byte_t)iterations);
+    }
+
+    benchSink += codeBlock->count;
+
+    cloxDeleteCodeBlock(codeBlock);
+}
+
+static void benchWrite(void *data, size_t iterations)
+{
+    Chunk_t *const chunk = (Chunk_t *)data;
+    CloxCodeBlock_t *const codeBlock = chunk->codeBlock;
+
+    while (iterations--)
+    {
+        if ((codeBlock->count + chunk->size) > BLOCK_SIZE)
+            codeBlock->count = 0;
+
+        cloxCodeBlockWrite(codeBlock, chunk->buffer, chunk->size);
+    }
+
+    benchSink += codeBlock->count;
+}
+
+int main(int argc, char **argv)
+{
+    static const size_t sizes[] = { 3, 16, 256, 4096 };
+
+    Bench_t bench;
+    CloxCodeBlock_t codeBlock;
+    Chunk_t chunk;
+    char name[32];
+    size_t i;
+
+    if (benchOpen(&bench, "code-block", argc, argv) < 0)
+        return EXIT_FAILURE;
+
+    cloxInitCodeBlock(&codeBlock, BLOCK_SIZE);
+
+    benchRun(&bench, "push", &benchPush, &codeBlock, sizeof(byte_t));
+    benchRun(&bench, "push-growing", &benchPushGrowing, NULL, sizeof(byte_t));
+
+    chunk.codeBlock = &codeBlock;
+
+    for (i = 0; i < sizeof(chunk.buffer); i++)
+        chunk.buffer[i] = (byte_t)i;
+
+    for (i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++)
+    {
+        chunk.size = sizes[i];
+        snprintf(name, sizeof(name), "write-%zu", sizes[i]);
+
+        benchRun(&bench, name, &benchWrite, &chunk, sizes[i]);
+    }
+
+    cloxFreeCodeBlock(&codeBlock);
+
+    return benchClose(&bench);
+}
@@ -0,0 +1,143 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/compiler/compiler.h"
+#include "clox/source/source_buffer.h"
+#include "clox/vm/code_block.h"
+#include "clox/vm/vm.h"
+
+#include "bench.h"
+
+typedef struct _Script
+{
+    const char         *path;
+    CloxSourceBuffer_t *sourceBuffer;
+    CloxCodeBlock_t     codeBlock;
+} Script_t;
+
+static void benchCompile(void *data, size_t iterations)
+{
+    Script_t *const script = (Script_t *)data;
+    CloxCodeBlock_t codeBlock;
+    CloxCompiler_t compiler;
+    CloxArena_t arena;
+
+    cloxInitArena(&arena, 0);
+
+    while (iterations--)
+    {
+        const CloxArenaMark_t mark = cloxArenaMark(&arena);
+
+        cloxInitCompiler(&compiler, &arena);
+        cloxInitCodeBlock(&codeBlock, 0);
+
+        benchSink += cloxCompile(&compiler, script->sourceBuffer, script->path, &codeBlock);
+
+        cloxFreeCodeBlock(&codeBlock);
+        cloxFreeCompiler(&compiler);
+        cloxArenaRewind(&arena, mark);
+    }
+
+    cloxFreeArena(&arena);
+}
+
+/* the printed values are dropped, so the output doesn't weigh on the times */
+static void benchRunScript(void *data, size_t iterations)
+{
+    Script_t *const script = (Script_t *)data;
+    CloxVMStatus_t status;
+    CloxVM_t vm;
+
+    while (iterations--)
+    {
+        cloxInitVM(&vm, 0);
+
+        for (status = cloxVMRun(&vm, &script->codeBlock); status == CLOX_VM_STATUS_RAISE; status = cloxVMResume(&vm))
+        {
+            if (vm.signal != CLOX_COMPILER_SIGNAL_PRINT)
+                break;
+
+            cloxVMPop(&vm);
+            benchSink++;
+        }
+
+        if (status != CLOX_VM_STATUS_SUCCESS)
+        {
+            fprintf(stderr, "error: '%s' failed at run-time\n", script->path);
+            exit(EXIT_FAILURE);
+        }
+
+        cloxFreeVM(&vm);
+    }
+}
+
+static const char *scriptName(const char *const path)
+{
+    const char *name = path, *p;
+
+    for (p = path; *p; p++)
+    {
+        if ((*p == '/') || (*p == '\\'))
+            name = p + 1;
+    }
+
+    return name;
+}
+
+/**
+ * Each script given on the command line is compiled and run: both are timed,
+ * the compilation on its own and the run of the compiled block, on its bytecode
+ * and then on its decoded form.
+ */
+int main(int argc, char **argv)
+{
+    Bench_t bench;
+    Script_t script;
+    CloxCompiler_t compiler;
+    CloxArena_t arena;
+    char name[256];
+    int count, i;
+
+    if ((count = benchOpen(&bench, "scripts", argc, argv)) < 0)
+        return EXIT_FAILURE;
+
+    for (i = 0; i < count; i++)
+    {
+        script.path = argv[i];
+
+        if (!(script.sourceBuffer = cloxCreateSourceBufferFromFile(script.path)))
+        {
+            fprintf(stderr, "error: cannot read '%s'\n", script.path);
+            return EXIT_FAILURE;
+        }
+
+        cloxInitArena(&arena, 0);
+        cloxInitCompiler(&compiler, &arena);
+        cloxInitCodeBlock(&script.codeBlock, 0);
+
+        if (!cloxCompile(&compiler, script.sourceBuffer, script.path, &script.codeBlock))
+            return EXIT_FAILURE;
+
+        snprintf(name, sizeof(name), "compile-%s", scriptName(script.path));
+        benchRun(&bench, name, &benchCompile, &script, script.sourceBuffer->size);
+
+        snprintf(name, sizeof(name), "run-%s", scriptName(script.path));
+        benchRun(&bench, name, &benchRunScript, &script, 0);
+
+        if (cloxVMDecode(&script.codeBlock))
+        {
+            snprintf(name, sizeof(name), "run-decoded-%s", scriptName(script.path));
+            benchRun(&bench, name, &benchRunScript, &script, 0);
+        }
+
+        cloxFreeCodeBlock(&script.codeBlock);
+        cloxFreeCompiler(&compiler);
+        cloxFreeArena(&arena);
+        cloxDeleteSourceBuffer(script.sourceBuffer);
+    }
+
+    return benchClose(&bench);
+}
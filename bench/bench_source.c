@@ -0,0 +1,120 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/utf8.h"
+#include "clox/source/source_stream.h"
+
+#include "bench.h"
+
+/* the size of the generated inputs */
+#define TEXT_SIZE (4 * 1024 * 1024)
+
+typedef struct _Input
+{
+    CloxSourceStream_t *sourceStream;
+    const uint8_t      *text;
+    size_t              size;
+} Input_t;
+
+/* repeats a fragment until the text is TEXT_SIZE bytes long, cutting it only
+ * at the boundaries of the fragment so the UTF-8 text stays valid */
+static char *generate(const char *const fragment)
+{
+    const size_t length = strlen(fragment);
+    char *const text = (char *)cmalloc(TEXT_SIZE + 1);
+    size_t size = 0;
+
+    while ((size + length) <= TEXT_SIZE)
+    {
+        memcpy(text + size, fragment, length);
+        size += length;
+    }
+
+    text[size] = NUL;
+
+    return text;
+}
+
+static void benchStreamRead(void *data, size_t iterations)
+{
+    CloxSourceStream_t *const sourceStream = ((Input_t *)data)->sourceStream;
+    uint64_t sum = 0;
+    int32_t ch;
+
+    while (iterations--)
+    {
+        cloxResetSourceLocation(&sourceStream->beginLocation);
+        cloxResetSourceLocation(&sourceStream->forwardLocation);
+
+        while (((ch = cloxSourceStreamRead(sourceStream)) != EOF) && (ch != NUL))
+            sum += (uint64_t)ch;
+    }
+
+    benchSink += sum;
+}
+
+static void benchIterate(void *data, size_t iterations)
+{
+    const Input_t *const input = (const Input_t *)data;
+    uint64_t sum = 0;
+    int32_t codepoint;
+    ssize_t offset;
+    size_t i;
+
+    while (iterations--)
+    {
+        for (i = 0; i < input->size; i += (size_t)offset)
+        {
+            if ((offset = utf8_iterate(input->text + i, (ssize_t)(input->size - i), &codepoint)) <= 0)
+                break;
+
+            sum += (uint64_t)codepoint;
+        }
+    }
+
+    benchSink += sum;
+}
+
+int main(int argc, char **argv)
+{
+    Bench_t bench;
+    Input_t ascii, unicode;
+
+    if (benchOpen(&bench, "source", argc, argv) < 0)
+        return EXIT_FAILURE;
+
+    char *asciiText = generate("var total = 0;\nwhile (total < 100) { total = total + 1; print \"ascii\"; }\n");
+    char *unicodeText = generate("var città = \"perché\"; // 你好, мир, γειά σου, \xf0\x9f\x98\x80\n");
+
+    ascii.text = (const uint8_t *)asciiText;
+    ascii.size = strlen(asciiText);
+    ascii.sourceStream = cloxCreateSourceStreamFromText(asciiText, CLOX_SOURCE_ENCODING_ASCII);
+
+    unicode.text = (const uint8_t *)unicodeText;
+    unicode.size = strlen(unicodeText);
+    unicode.sourceStream = cloxCreateSourceStreamFromText(unicodeText, CLOX_SOURCE_ENCODING_UTF_8);
+
+    benchRun(&bench, "stream-read-ascii", &benchStreamRead, &ascii, ascii.size);
+    benchRun(&bench, "stream-read-utf-8", &benchStreamRead, &unicode, unicode.size);
+
+    /* ASCII text through the UTF-8 decoder takes its fast path */
+    cloxDeleteSourceStream(ascii.sourceStream);
+    ascii.sourceStream = cloxCreateSourceStreamFromText(asciiText, CLOX_SOURCE_ENCODING_UTF_8);
+
+    benchRun(&bench, "stream-read-ascii-as-utf-8", &benchStreamRead, &ascii, ascii.size);
+
+    benchRun(&bench, "utf8-iterate-ascii", &benchIterate, &ascii, ascii.size);
+    benchRun(&bench, "utf8-iterate-utf-8", &benchIterate, &unicode, unicode.size);
+
+    cloxDeleteSourceStream(ascii.sourceStream);
+    cloxDeleteSourceStream(unicode.sourceStream);
+
+    dealloc(asciiText);
+    dealloc(unicodeText);
+
+    return benchClose(&bench);
+}
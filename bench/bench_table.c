@@ -0,0 +1,121 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/string.h"
+#include "clox/vm/table.h"
+
+#include "bench.h"
+
+/* the number of distinct keys, a power of two */
+#define KEYS_COUNT 4096
+
+typedef struct _Tables
+{
+    CloxStringTable_t   strings;
+    CloxTable_t         table;
+    const CloxString_t *keys[KEYS_COUNT];
+} Tables_t;
+
+/* builds the name of a key piece by piece, as a script concatenating strings */
+static size_t build(char *const buffer, size_t index)
+{
+    static const char *const pieces[] = { "field", "_", "of", "_", "object" };
+
+    size_t length = 0, i;
+
+    for (i = 0; i < (sizeof(pieces) / sizeof(pieces[0])); i++)
+    {
+        const size_t count = strlen(pieces[i]);
+
+        memcpy(buffer + length, pieces[i], count);
+        length += count;
+    }
+
+    do
+    {
+        buffer[length++] = (char)('0' + (index % 10));
+    } while (index /= 10);
+
+    buffer[length] = NUL;
+
+    return length;
+}
+
+static void benchStringBuild(void *data, size_t iterations)
+{
+    Tables_t *const tables = (Tables_t *)data;
+    char buffer[64];
+
+    while (iterations--)
+    {
+        const size_t length = build(buffer, iterations % KEYS_COUNT);
+
+        benchSink += cloxStringTableIntern(&tables->strings, buffer, length)->hash;
+    }
+}
+
+static void benchFind(void *data, size_t iterations)
+{
+    Tables_t *const tables = (Tables_t *)data;
+
+    while (iterations--)
+        benchSink += (uint64_t)(uintptr_t)cloxTableFind(&tables->table, tables->keys[iterations % KEYS_COUNT]);
+}
+
+/* every round adds a key, looks up another one and removes a third one, so
+ * the table stays about half full while its slots keep changing */
+static void benchChurn(void *data, size_t iterations)
+{
+    Tables_t *const tables = (Tables_t *)data;
+    CloxTable_t *const table = &tables->table;
+    size_t i;
+
+    while (iterations--)
+    {
+        i = iterations % KEYS_COUNT;
+
+        cloxTableSet(table, tables->keys[i], cloxSIntValue((sint_t)i));
+        benchSink += (uint64_t)(uintptr_t)cloxTableFind(table, tables->keys[(i * 7) % KEYS_COUNT]);
+        cloxTableDelete(table, tables->keys[(i + (KEYS_COUNT / 2)) % KEYS_COUNT]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Bench_t bench;
+    Tables_t *const tables = alloc(Tables_t);
+    char buffer[64];
+    size_t i;
+
+    if (benchOpen(&bench, "table", argc, argv) < 0)
+        return EXIT_FAILURE;
+
+    cloxInitStringTable(&tables->strings, NULL);
+    cloxInitTable(&tables->table);
+
+    for (i = 0; i < KEYS_COUNT; i++)
+        tables->keys[i] = cloxStringTableIntern(&tables->strings, buffer, build(buffer, i));
+
+    benchRun(&bench, "string-build-intern", &benchStringBuild, tables, 0);
+
+    for (i = 0; i < KEYS_COUNT; i++)
+        cloxTableSet(&tables->table, tables->keys[i], cloxSIntValue((sint_t)i));
+
+    benchRun(&bench, "table-find", &benchFind, tables, 0);
+
+    cloxFreeTable(&tables->table);
+    cloxInitTable(&tables->table);
+
+    benchRun(&bench, "table-churn", &benchChurn, tables, 0);
+
+    cloxFreeTable(&tables->table);
+    cloxFreeStringTable(&tables->strings);
+
+    dealloc(tables);
+
+    return benchClose(&bench);
+}
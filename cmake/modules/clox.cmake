@@ -1,9 +1,11 @@
 define_property(GLOBAL PROPERTY CLOX_TARGETS)
 define_property(GLOBAL PROPERTY CLOX_LIBRARY)
+define_property(GLOBAL PROPERTY CLOX_BENCHMARKS)
 
 set(CLOX_LOG_PREFIX       "clox")
 set(CLOX_LIBRARY_PREFIX   "clox-lib-")
 set(CLOX_UNIT_TEST_PREFIX "clox-test-")
+set(CLOX_BENCHMARK_PREFIX "clox-bench-")
 
 set(CMAKE_STATIC_LIBRARY_PREFIX ${CLOX_LIBRARY_PREFIX})
 set(CMAKE_SHARED_LIBRARY_PREFIX ${CLOX_LIBRARY_PREFIX})
@@ -15,4 +17,5 @@ include(clox_log)
 include(clox_add_executable)
 include(clox_add_library)
 include(clox_add_unit_test)
+include(clox_add_benchmark)
 include(clox_link_libraries)
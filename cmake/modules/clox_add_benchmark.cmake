@@ -0,0 +1,47 @@
+# Usage:
+#
+#   clox_add_benchmark(<TARGET> SOURCES <SOURCES> [DEPENDS <DEPENDENCIES>] [ARGS <ARGUMENTS>])
+#
+# Adds a benchmark executable and a bench-<TARGET> target running it, which
+# writes its results as JSON into ${CLOX_BENCHMARK_RESULTS_DIR}/<TARGET>.json.
+# Every benchmark is also run by the bench target.
+#
+function(clox_add_benchmark TARGET)
+    set(_OPTIONS)
+    set(_ONE_VAL)
+    set(_MUL_VAL SOURCES DEPENDS ARGS)
+
+    cmake_parse_arguments(_ARG
+        "${_OPTIONS}"
+        "${_ONE_VAL}"
+        "${_MUL_VAL}"
+         ${ARGV}
+    )
+
+    set(_ARG_NAME "${CLOX_BENCHMARK_PREFIX}${TARGET}")
+    set(_ARG_JSON "${CLOX_BENCHMARK_RESULTS_DIR}/${TARGET}.json")
+
+    add_executable(${_ARG_NAME} "${_ARG_SOURCES}")
+
+    if(_ARG_DEPENDS)
+        target_link_libraries(${_ARG_NAME} "${_ARG_DEPENDS}")
+    endif()
+
+    add_custom_target(bench-${TARGET}
+        COMMAND ${CMAKE_COMMAND} -E make_directory "${CLOX_BENCHMARK_RESULTS_DIR}"
+        COMMAND ${_ARG_NAME} --json "${_ARG_JSON}" ${_ARG_ARGS}
+        DEPENDS ${_ARG_NAME}
+        COMMENT "Running benchmark ${_ARG_NAME}"
+        USES_TERMINAL
+    )
+
+    if(NOT TARGET bench)
+        add_custom_target(bench)
+    endif()
+
+    add_dependencies(bench bench-${TARGET})
+
+    set_property(GLOBAL APPEND PROPERTY CLOX_BENCHMARKS ${_ARG_NAME})
+
+    clox_log("add benchmark ${_ARG_NAME}")
+endfunction()
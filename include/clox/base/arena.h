@@ -0,0 +1,265 @@
+#pragma once
+
+/**
+ * @file        arena.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header are defined the region (arena) allocators, used
+ *              for data that shares the same lifetime (like the scratch data
+ *              of a compilation): blocks are taken from big chunks with a bump
+ *              pointer and released all together.
+ */
+
+#ifndef CLOX_BASE_ARENA_H_
+#define CLOX_BASE_ARENA_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/byte.h"
+
+#ifndef CLOX_ARENA_CHUNK_SIZE
+/**
+ * @brief       This constant represents the default number of bytes of each
+ *              chunk of an arena (bigger blocks get a dedicated chunk).
+ */
+#   define CLOX_ARENA_CHUNK_SIZE (CLOX_PAGESIZ * 16)
+#endif
+
+#ifndef CLOX_ARENA_ALIGNMENT
+/**
+ * @brief       This constant represents the alignment of the blocks allocated
+ *              from an arena, it must be a power of two.
+ */
+#   define CLOX_ARENA_ALIGNMENT (CLOX_SIZEOF_WORD_PTR * 2)
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    ARENA Arena
+ * @{
+ */
+
+#pragma region Arena
+
+/**
+ * @brief       This data structure provides a chunk of memory of an arena,
+ *              chunks are linked from the newest to the oldest one.
+ */
+typedef struct _CloxArenaChunk
+{
+    /**
+     * @brief   A pointer to the previous (older) chunk, or NULL.
+     */
+    struct _CloxArenaChunk *prev;
+    /**
+     * @brief   The number of bytes that the chunk can store.
+     */
+    size_t                  size;
+    /**
+     * @brief   The number of bytes already allocated from the chunk.
+     */
+    size_t                  used;
+} CloxArenaChunk_t;
+
+/**
+ * @brief       This data structure provides an arena (or region) allocator.
+ */
+typedef struct _CloxArena
+{
+    /**
+     * @brief   A pointer to the current (newest) chunk, or NULL when nothing
+     *          has been allocated yet.
+     */
+    CloxArenaChunk_t *chunk;
+    /**
+     * @brief   A pointer to a released chunk kept to be reused, so that a
+     *          mark/rewind loop does not allocate a chunk on each iteration.
+     */
+    CloxArenaChunk_t *spare;
+    /**
+     * @brief   The number of bytes of a new chunk.
+     */
+    size_t            chunkSize;
+    /**
+     * @brief   The number of chunks in use (the spare one excluded).
+     */
+    size_t            chunksCount;
+    /**
+     * @brief   The number of bytes allocated from the arena, padding
+     *          included.
+     */
+    size_t            allocated;
+} CloxArena_t;
+
+/**
+ * @brief       This data structure provides a saved position of an arena, to
+ *              rewind it releasing all blocks allocated after.
+ */
+typedef struct _CloxArenaMark
+{
+    /**
+     * @brief   The current chunk at the moment of the mark.
+     */
+    CloxArenaChunk_t *chunk;
+    /**
+     * @brief   The bytes used from the current chunk at the moment of the
+     *          mark.
+     */
+    size_t            used;
+    /**
+     * @brief   The bytes allocated from the arena at the moment of the mark.
+     */
+    size_t            allocated;
+} CloxArenaMark_t;
+
+/**
+ * @brief       This function initializes a CloxArena_t data structure, no
+ *              chunk is allocated until the first allocation.
+ *
+ * @param       arena A pointer to the CloxArena_t instance to initialize.
+ * @param       chunkSize The number of bytes of each chunk, when zero
+ *              CLOX_ARENA_CHUNK_SIZE is used.
+ * @return      On success this function returns a pointer to the initialized
+ *              arena (so the value of arena parameter).
+ */
+CLOX_API CloxArena_t *CLOX_STDCALL cloxInitArena(CloxArena_t *const arena, size_t chunkSize);
+/**
+ * @brief       This function releases all the chunks of an arena, so all the
+ *              blocks allocated from it, without deleting it. The arena can be
+ *              used again.
+ *
+ * @param       arena A pointer to the CloxArena_t instance to free.
+ * @return      On success this function returns a pointer to the freed arena
+ *              (so the value of arena parameter).
+ */
+CLOX_API CloxArena_t *CLOX_STDCALL cloxFreeArena(CloxArena_t *const arena);
+
+/**
+ * @brief       This function allocates a new CloxArena_t instance on the heap
+ *              and initializes it.
+ *
+ * @param       chunkSize The number of bytes of each chunk, when zero
+ *              CLOX_ARENA_CHUNK_SIZE is used.
+ * @return      On success this function returns a pointer to the just allocated
+ *              CloxArena_t instance.
+ */
+CLOX_API CloxArena_t *CLOX_STDCALL cloxCreateArena(size_t chunkSize);
+
+/**
+ * @brief       This function allocates a block of bytes from an arena, the
+ *              block is aligned to CLOX_ARENA_ALIGNMENT and its content is not
+ *              initialized.
+ *
+ * @param       arena A pointer to the CloxArena_t instance from which allocate.
+ * @param       size The number of bytes to allocate.
+ * @return      On success this function returns a pointer to the new block,
+ *              but on failure a fatal error will be raised.
+ */
+CLOX_API void *CLOX_STDCALL cloxArenaAlloc(CloxArena_t *const arena, const size_t size);
+/**
+ * @brief       This function allocates from an arena an array of count items
+ *              of the specified size, initialized to zero.
+ *
+ * @param       arena A pointer to the CloxArena_t instance from which allocate.
+ * @param       count The number of items to allocate.
+ * @param       size The size of each item.
+ * @return      On success this function returns a pointer to the new block,
+ *              but on failure a fatal error will be raised.
+ */
+CLOX_API void *CLOX_STDCALL cloxArenaDim(CloxArena_t *const arena, const size_t count, const size_t size);
+/**
+ * @brief       This function resizes a block allocated from an arena. The last
+ *              allocated block is resized in place when the chunk has enough
+ *              space, otherwise a new block is allocated and the old content
+ *              is copied (the old block is released only on rewind or free).
+ *
+ * @param       arena A pointer to the CloxArena_t instance.
+ * @param       block A pointer to the block to resize, it can be NULL.
+ * @param       oldSize The current number of bytes of the block.
+ * @param       newSize The new number of bytes of the block.
+ * @return      On success this function returns a pointer to the resized block,
+ *              but on failure a fatal error will be raised.
+ */
+CLOX_API void *CLOX_STDCALL cloxArenaRealloc(CloxArena_t *const arena, void *const block, const size_t oldSize, const size_t newSize);
+
+/**
+ * @brief       This function saves the current position of an arena.
+ *
+ * @param       arena A pointer to the CloxArena_t instance.
+ * @return      The mark of the current position.
+ */
+CLOX_API CloxArenaMark_t CLOX_STDCALL cloxArenaMark(const CloxArena_t *const arena);
+/**
+ * @brief       This function rewinds an arena to a position saved by
+ *              cloxArenaMark, releasing all the blocks allocated after it.
+ *
+ * @param       arena A pointer to the CloxArena_t instance.
+ * @param       mark The mark of the position to restore.
+ */
+CLOX_API void CLOX_STDCALL cloxArenaRewind(CloxArena_t *const arena, const CloxArenaMark_t mark);
+
+/**
+ * @brief       This function deletes a CloxArena_t heap-allocated instance,
+ *              releasing all its chunks and itself. Use it after cloxCreateArena
+ *              function.
+ *
+ * @param       arena A pointer to the CloxArena_t instance to delete.
+ */
+CLOX_API void CLOX_STDCALL cloxDeleteArena(CloxArena_t *const arena);
+
+#ifndef arenaalloc
+/**
+ * @brief       Allocates from an arena a block of bytes of the same dimension
+ *              of the specified data type.
+ *
+ * @param       A A pointer to the arena.
+ * @param       T The type to allocate.
+ * @return      A pointer to the new block of memory.
+ */
+#   define arenaalloc(A, T) (T *)cloxArenaAlloc((A), sizeof(T))
+#endif
+
+#ifndef arenadim
+/**
+ * @brief       Allocates from an arena a series of N zeroed items of the
+ *              specified data type.
+ *
+ * @param       A A pointer to the arena.
+ * @param       T The type to allocate.
+ * @param       N The number of items to allocate.
+ * @return      A pointer to the new block of memory.
+ */
+#   define arenadim(A, T, N) (T *)cloxArenaDim((A), (N), sizeof(T))
+#endif
+
+#ifndef arenaredim
+/**
+ * @brief       Resizes an array allocated from an arena.
+ *
+ * @param       A A pointer to the arena.
+ * @param       T The type of the items.
+ * @param       B A pointer to the array to resize.
+ * @param       O The current number of items.
+ * @param       N The new number of items.
+ * @return      A pointer to the resized array.
+ */
+#   define arenaredim(A, T, B, O, N) (T *)cloxArenaRealloc((A), (void *)(B), sizeof(T) * (O), sizeof(T) * (N))
+#endif
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_BASE_ARENA_H_ */
@@ -0,0 +1,211 @@
+#pragma once
+
+/**
+ * @file        builder.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined a string builder, which concatenates
+ *              strings into a buffer growing geometrically, so that appending
+ *              costs the appended characters only (where allocating a new
+ *              string with strfmt each time copies all the previous ones). The
+ *              terminator and the hash of the result are computed when they are
+ *              needed, and cached until the next append.
+ */
+
+#ifndef CLOX_BASE_BUILDER_H_
+#define CLOX_BASE_BUILDER_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/intern.h"
+#include "clox/base/memory.h"
+
+#include <stdarg.h>
+#include <string.h>
+
+#ifndef CLOX_STRING_BUILDER_CAPACITY
+/**
+ * @brief       This constant represents the initial number of bytes of the
+ *              buffer of a string builder.
+ */
+#   define CLOX_STRING_BUILDER_CAPACITY 64
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    BUILDER String Builder
+ * @{
+ */
+
+#pragma region String Builder
+
+/**
+ * @brief       This data structure provides a string builder.
+ */
+typedef struct _CloxStringBuilder
+{
+    /**
+     * @brief   A pointer to the characters, NULL until something is appended.
+     *          They are terminated only by cloxStringBuilderChars.
+     */
+    char         *chars;
+    /**
+     * @brief   The number of bytes of the string, the terminator excluded.
+     */
+    size_t        length;
+    /**
+     * @brief   The number of bytes of the buffer.
+     */
+    size_t        capacity;
+    /**
+     * @brief   The hash of the characters (cloxHashString), valid only when
+     *          hashed is TRUE.
+     */
+    uint32_t      hash;
+    bool_t        hashed;
+    /**
+     * @brief   A pointer to the memory that accounts the buffer, the current
+     *          one when the builder is initialized.
+     */
+    CloxMemory_t *memory;
+} CloxStringBuilder_t;
+
+/**
+ * @brief       This function initializes an empty CloxStringBuilder_t data
+ *              structure, the buffer is allocated by the first append.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance to
+ *              initialize.
+ * @return      On success this function returns a pointer to the initialized
+ *              builder (so the value of builder parameter).
+ */
+CLOX_API CloxStringBuilder_t *CLOX_STDCALL cloxInitStringBuilder(CloxStringBuilder_t *const builder);
+/**
+ * @brief       This function releases the buffer of a CloxStringBuilder_t
+ *              instance without deleting it.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance to free.
+ * @return      On success this function returns a pointer to the freed builder
+ *              (so the value of builder parameter).
+ */
+CLOX_API CloxStringBuilder_t *CLOX_STDCALL cloxFreeStringBuilder(CloxStringBuilder_t *const builder);
+
+/**
+ * @brief       This function empties a builder, keeping its buffer.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ */
+CLOX_API void CLOX_STDCALL cloxStringBuilderClear(CloxStringBuilder_t *const builder);
+/**
+ * @brief       This function makes room for at least the specified number of
+ *              bytes (the terminator excluded) after the string.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ * @param       count The number of bytes.
+ * @return      A pointer to the first free byte of the buffer.
+ */
+CLOX_API char *CLOX_STDCALL cloxStringBuilderReserve(CloxStringBuilder_t *const builder, const size_t count);
+
+/**
+ * @brief       This function appends a sequence of characters to a builder.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ * @param       chars A pointer to the characters, they don't need to be
+ *              terminated (nor they can be a part of the builder).
+ * @param       length The number of bytes to append.
+ */
+CLOX_API void CLOX_STDCALL cloxStringBuilderAppend(CloxStringBuilder_t *const builder, const char *const chars, const size_t length);
+/**
+ * @brief       This function appends a string formatted with a va_list, with
+ *              vprintf style format.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ * @param       format printf-style format string.
+ * @param       arglist Arguments list.
+ * @return      TRUE in case of success, FALSE if the string can't be formatted.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxStringBuilderAppendV(CloxStringBuilder_t *const builder, const char *const format, va_list arglist);
+/**
+ * @brief       This function appends a string formatted with a printf like
+ *              format.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ * @param       format printf-style format string.
+ * @return      TRUE in case of success, FALSE if the string can't be formatted.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxStringBuilderAppendF(CloxStringBuilder_t *const builder, const char *const format, ...);
+
+/**
+ * @brief       This function appends a NUL terminated string to a builder.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ * @param       str The string to append, NULL appends nothing.
+ */
+CLOX_INLINE void CLOX_STDCALL cloxStringBuilderAppendString(CloxStringBuilder_t *const builder, const char *const str)
+{
+    if (str)
+        cloxStringBuilderAppend(builder, str, strlen(str));
+
+    return;
+}
+
+/**
+ * @brief       This function appends a character to a builder.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ * @param       c The character to append.
+ */
+CLOX_INLINE void CLOX_STDCALL cloxStringBuilderAppendChar(CloxStringBuilder_t *const builder, const char c)
+{
+    *cloxStringBuilderReserve(builder, 1) = c;
+
+    builder->length++;
+    builder->hashed = FALSE;
+
+    return;
+}
+
+/**
+ * @brief       This function gets the characters of a builder, terminating
+ *              them.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ * @return      A pointer to the NUL terminated characters, valid until the next
+ *              append.
+ */
+CLOX_API const char *CLOX_STDCALL cloxStringBuilderChars(CloxStringBuilder_t *const builder);
+/**
+ * @brief       This function gets the hash of the characters of a builder,
+ *              computing it only when they changed since the last time.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ * @return      The hash of the characters (cloxHashString).
+ */
+CLOX_API uint32_t CLOX_STDCALL cloxStringBuilderHash(CloxStringBuilder_t *const builder);
+/**
+ * @brief       This function interns the characters of a builder.
+ *
+ * @param       builder A pointer to the CloxStringBuilder_t instance.
+ * @param       table A pointer to the CloxStringTable_t instance.
+ * @return      A pointer to the interned string, valid until the table is freed.
+ */
+CLOX_API const CloxString_t *CLOX_STDCALL cloxStringBuilderIntern(const CloxStringBuilder_t *const builder, CloxStringTable_t *const table);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_BASE_BUILDER_H_ */
@@ -0,0 +1,103 @@
+#pragma once
+
+/**
+ * @file        clock.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header are defined the clocks used to measure time
+ *              intervals: a monotonic clock in nanoseconds and a cheaper
+ *              cycle counter, meaningful only as a difference.
+ */
+
+#ifndef CLOX_BASE_CLOCK_H_
+#define CLOX_BASE_CLOCK_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+
+#if (CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC) && ((CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_AMD64) || (CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_IX86))
+#   include <intrin.h>
+#elif ((CLOX_COMPILER_ID == CLOX_COMPILER_ID_GNUC) || (CLOX_COMPILER_ID == CLOX_COMPILER_ID_LLVM)) && ((CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_AMD64) || (CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_IX86))
+#   include <x86intrin.h>
+#endif
+
+#ifndef CLOX_CLOCK_HAS_CYCLES
+#   if (CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_AMD64) || (CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_IX86)
+/**
+ * @brief       This constant can be used to check if cloxClockCycles reads a
+ *              hardware counter (the time stamp counter), instead of falling
+ *              back to the monotonic clock.
+ */
+#       define CLOX_CLOCK_HAS_CYCLES 1
+#   elif (CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_ARM64) && ((CLOX_COMPILER_ID == CLOX_COMPILER_ID_GNUC) || (CLOX_COMPILER_ID == CLOX_COMPILER_ID_LLVM))
+/**
+ * @brief       This constant can be used to check if cloxClockCycles reads a
+ *              hardware counter (the virtual counter), instead of falling back
+ *              to the monotonic clock.
+ */
+#       define CLOX_CLOCK_HAS_CYCLES 1
+#   else
+/**
+ * @brief       This constant can be used to check if cloxClockCycles reads a
+ *              hardware counter, instead of falling back to the monotonic
+ *              clock.
+ */
+#       define CLOX_CLOCK_HAS_CYCLES 0
+#   endif
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    CLOCK Clock
+ * @{
+ */
+
+#pragma region Clock
+
+/**
+ * @brief       This function reads the monotonic clock.
+ *
+ * @return      The number of nanoseconds elapsed since an unspecified point in
+ *              time, which doesn't change while the process runs.
+ */
+CLOX_API uint64_t CLOX_STDCALL cloxClockNow(void);
+
+/**
+ * @brief       This function reads the cycle counter, the unit of its ticks
+ *              depends on the processor (nanoseconds when CLOX_CLOCK_HAS_CYCLES
+ *              is zero).
+ *
+ * @return      The current value of the counter.
+ */
+CLOX_API_INLINE uint64_t CLOX_STDCALL cloxClockCycles(void)
+{
+#if !CLOX_CLOCK_HAS_CYCLES
+    return cloxClockNow();
+#elif (CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_AMD64) || (CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_IX86)
+    return (uint64_t)__rdtsc();
+#else
+    uint64_t ticks;
+
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+
+    return ticks;
+#endif
+}
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_BASE_CLOCK_H_ */
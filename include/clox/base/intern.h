@@ -0,0 +1,196 @@
+#pragma once
+
+/**
+ * @file        intern.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the string interning table, which
+ *              stores each distinct string only once together with its length
+ *              and its hash, so that interned strings are compared by pointer.
+ *
+ *              Keys are normalized to the Unicode NFC form before interning,
+ *              so identifiers that look the same but are encoded differently
+ *              (a precomposed letter or a letter followed by its combining
+ *              mark) are the same string.
+ */
+
+#ifndef CLOX_BASE_INTERN_H_
+#define CLOX_BASE_INTERN_H_
+
+#include "clox/base/api.h"
+#include "clox/base/arena.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/memory.h"
+
+#ifndef CLOX_STRING_TABLE_CAPACITY
+/**
+ * @brief       This constant represents the initial number of slots of a
+ *              string table, it must be a power of two.
+ */
+#   define CLOX_STRING_TABLE_CAPACITY 64
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    INTERN String Interning
+ * @{
+ */
+
+#pragma region String Interning
+
+/**
+ * @brief       This data structure provides an interned string, it is never
+ *              modified after its creation.
+ */
+typedef struct _CloxString
+{
+    /**
+     * @brief   A pointer to the NFC normalized characters of the string, they
+     *          are followed by a NUL terminator.
+     */
+    const char *chars;
+    /**
+     * @brief   The number of bytes of the string, the terminator excluded.
+     */
+    uint32_t    length;
+    /**
+     * @brief   The hash of the characters of the string (cloxHashString).
+     */
+    uint32_t    hash;
+} CloxString_t;
+
+/**
+ * @brief       This data structure provides a string interning table, an open
+ *              addressing hash set of interned strings.
+ */
+typedef struct _CloxStringTable
+{
+    /**
+     * @brief   A pointer to the first slot of the table, empty slots are NULL.
+     */
+    CloxString_t **slots;
+    /**
+     * @brief   The number of slots of the table, always a power of two.
+     */
+    size_t         capacity;
+    /**
+     * @brief   The number of interned strings.
+     */
+    size_t         count;
+    /**
+     * @brief   A pointer to the arena from which the slots and the strings are
+     *          allocated, or NULL when they are allocated on the heap.
+     */
+    CloxArena_t   *arena;
+    /**
+     * @brief   A pointer to the memory that accounts the slots and the strings
+     *          allocated on the heap, the current one when the table is
+     *          initialized.
+     */
+    CloxMemory_t  *memory;
+} CloxStringTable_t;
+
+/**
+ * @brief       This function initializes a CloxStringTable_t data structure.
+ *
+ * @param       table A pointer to the CloxStringTable_t instance to initialize.
+ * @param       arena A pointer to the arena from which allocate the strings, or
+ *              NULL to allocate them on the heap.
+ * @return      On success this function returns a pointer to the initialized
+ *              table (so the value of table parameter).
+ */
+CLOX_API CloxStringTable_t *CLOX_STDCALL cloxInitStringTable(CloxStringTable_t *const table, CloxArena_t *const arena);
+/**
+ * @brief       This function releases the resources of a CloxStringTable_t
+ *              instance without deleting it, the strings interned into the
+ *              table can't be used after.
+ *
+ * @param       table A pointer to the CloxStringTable_t instance to free.
+ * @return      On success this function returns a pointer to the freed table
+ *              (so the value of table parameter).
+ */
+CLOX_API CloxStringTable_t *CLOX_STDCALL cloxFreeStringTable(CloxStringTable_t *const table);
+
+/**
+ * @brief       This function allocates and initializes a new CloxStringTable_t
+ *              data structure.
+ *
+ * @param       arena A pointer to the arena from which allocate the strings, or
+ *              NULL to allocate them on the heap.
+ * @return      On success this function returns a pointer to the new table.
+ */
+CLOX_API CloxStringTable_t *CLOX_STDCALL cloxCreateStringTable(CloxArena_t *const arena);
+
+/**
+ * @brief       This function computes the hash of a sequence of bytes, the one
+ *              cached by interned strings (32 bits FNV-1a).
+ *
+ * @param       chars A pointer to the first byte.
+ * @param       length The number of bytes.
+ * @return      The hash of the bytes.
+ */
+CLOX_API uint32_t CLOX_STDCALL cloxHashString(const char *const chars, const size_t length);
+
+/**
+ * @brief       This function interns a string, adding it to the table when an
+ *              equal string is not interned yet.
+ *
+ * @note        The characters are normalized to NFC first, a string that is not
+ *              valid UTF-8 is interned as it is.
+ *
+ * @param       table A pointer to the CloxStringTable_t instance.
+ * @param       chars A pointer to the characters of the string, they don't need
+ *              to be terminated.
+ * @param       length The number of bytes of the string.
+ * @return      A pointer to the interned string, valid until the table is freed.
+ */
+CLOX_API const CloxString_t *CLOX_STDCALL cloxStringTableIntern(CloxStringTable_t *const table, const char *const chars, const size_t length);
+
+/**
+ * @brief       This function looks up an interned string without adding it.
+ *
+ * @param       table A pointer to the CloxStringTable_t instance.
+ * @param       chars A pointer to the characters of the string, they don't need
+ *              to be terminated.
+ * @param       length The number of bytes of the string.
+ * @return      A pointer to the interned string, or NULL if it isn't interned.
+ */
+CLOX_API const CloxString_t *CLOX_STDCALL cloxStringTableFind(const CloxStringTable_t *const table, const char *const chars, const size_t length);
+
+/**
+ * @brief       This function compares two strings interned into the same table.
+ *
+ * @param       x A pointer to the first string.
+ * @param       y A pointer to the second string.
+ * @return      TRUE if the strings have the same (normalized) content.
+ */
+CLOX_API_INLINE bool_t CLOX_STDCALL cloxStringEquals(const CloxString_t *const x, const CloxString_t *const y)
+{
+    return (bool_t)(x == y);
+}
+
+/**
+ * @brief       This function frees and deletes a CloxStringTable_t instance.
+ *
+ * @param       table A pointer to the CloxStringTable_t instance to delete.
+ */
+CLOX_API void CLOX_STDCALL cloxDeleteStringTable(CloxStringTable_t *const table);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_BASE_INTERN_H_ */
@@ -0,0 +1,314 @@
+#pragma once
+
+/**
+ * @file        memory.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the memory accounting of the runtime:
+ *              the long-lived data of the subsystems (source buffers, code
+ *              blocks, objects of the managed heap and interned strings) is
+ *              allocated through a CloxMemory_t, which forwards to a pluggable
+ *              allocator, counts bytes and blocks of each subsystem and can
+ *              enforce a hard limit.
+ *
+ *              Each thread has a current memory (the process-wide default one
+ *              until another is set), which the subsystems take when they are
+ *              initialized and then keep, so that a block is always released
+ *              into the memory that paid for it. Short-lived scratch data still
+ *              uses the allocation macros of alloc.h and is not accounted.
+ */
+
+#ifndef CLOX_BASE_MEMORY_H_
+#define CLOX_BASE_MEMORY_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+
+#ifndef CLOX_MEMORY_LIMIT_ERROR_MESSAGE
+/**
+ * @brief       This constant represents the default error message printed on
+ *              the error stream when an allocation exceeds the memory limit
+ *              and the limit function doesn't recover.
+ */
+#   define CLOX_MEMORY_LIMIT_ERROR_MESSAGE "out of memory (limit reached)"
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    MEMORY Memory Accounting
+ * @{
+ */
+
+#pragma region Memory Accounting
+
+/**
+ * @brief       This enumeration provides the subsystems whose memory is
+ *              accounted separately.
+ */
+typedef enum _CloxMemoryKind
+{
+    /**
+     * @brief   Any other accounted memory.
+     */
+    CLOX_MEMORY_KIND_OTHER  = 0x00,
+    /**
+     * @brief   The contents of the source buffers (mapped files excluded).
+     */
+    CLOX_MEMORY_KIND_SOURCE = 0x01,
+    /**
+     * @brief   The bytecode, constants, names and line tables of code blocks.
+     */
+    CLOX_MEMORY_KIND_CODE   = 0x02,
+    /**
+     * @brief   The objects of the managed heaps.
+     */
+    CLOX_MEMORY_KIND_HEAP   = 0x03,
+    /**
+     * @brief   The interned strings and the slots of their tables.
+     */
+    CLOX_MEMORY_KIND_STRING = 0x04,
+} CloxMemoryKind_t;
+
+#ifndef CLOX_MEMORY_KINDS_COUNT
+/**
+ * @brief       This constant represents the number of memory kinds.
+ */
+#   define CLOX_MEMORY_KINDS_COUNT 5
+#endif
+
+/**
+ * @brief       This datatype provides the allocator function of a memory, it
+ *              works like realloc with the old size as a hint: it allocates when
+ *              block is NULL, releases the block (returning NULL) when newSize
+ *              is zero and resizes it otherwise.
+ *
+ * @return      A pointer to the new block, or NULL if it cannot be allocated.
+ */
+typedef void *(CLOX_STDCALL *CloxAllocatorFunc_t)(void *const data, void *const block, const size_t oldSize, const size_t newSize);
+
+struct _CloxMemory;
+
+/**
+ * @brief       This datatype provides the function called when an allocation
+ *              would exceed the limit of a memory. To recover, it doesn't return
+ *              (like with a longjmp to a point set by the host), when it returns
+ *              a fatal error is raised.
+ */
+typedef void (CLOX_STDCALL *CloxMemoryLimitFunc_t)(struct _CloxMemory *const memory, const CloxMemoryKind_t kind, const size_t size);
+
+/**
+ * @brief       This data structure provides the statistics of a memory kind.
+ */
+typedef struct _CloxMemoryStats
+{
+    /**
+     * @brief   The number of bytes in use.
+     */
+    size_t bytes;
+    /**
+     * @brief   The number of blocks in use.
+     */
+    size_t count;
+    /**
+     * @brief   The number of allocations done (resizes included).
+     */
+    size_t allocations;
+} CloxMemoryStats_t;
+
+/**
+ * @brief       This data structure provides an accounted memory. Its counters
+ *              are updated atomically, so a memory can be shared by threads.
+ */
+typedef struct _CloxMemory
+{
+    /**
+     * @brief   The allocator function.
+     */
+    CloxAllocatorFunc_t   allocator;
+    /**
+     * @brief   The data passed to the allocator function.
+     */
+    void                 *allocatorData;
+    /**
+     * @brief   The maximum number of bytes in use, or zero for no limit. It
+     *          can be changed at any time.
+     */
+    size_t                limit;
+    /**
+     * @brief   The function called when the limit is reached, or NULL.
+     */
+    CloxMemoryLimitFunc_t onLimit;
+    /**
+     * @brief   A pointer to data of the host, for the limit function.
+     */
+    void                 *data;
+    /**
+     * @brief   The number of bytes in use, of every kind.
+     */
+    volatile size_t       bytes;
+    /**
+     * @brief   The highest number of bytes in use reached.
+     */
+    volatile size_t       peak;
+    /**
+     * @brief   The number of allocations refused because of the limit.
+     */
+    volatile size_t       failures;
+    /**
+     * @brief   The statistics of each kind.
+     */
+    CloxMemoryStats_t     stats[CLOX_MEMORY_KINDS_COUNT];
+} CloxMemory_t;
+
+/**
+ * @brief       This function initializes a CloxMemory_t data structure, with the
+ *              C allocator and no limit function.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance to initialize.
+ * @param       limit The maximum number of bytes in use, or zero for no limit.
+ * @return      On success this function returns a pointer to the initialized
+ *              memory (so the value of memory parameter).
+ */
+CLOX_API CloxMemory_t *CLOX_STDCALL cloxInitMemory(CloxMemory_t *const memory, const size_t limit);
+/**
+ * @brief       This function replaces the allocator function of a memory, it
+ *              must be done while no block of the memory is in use.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance.
+ * @param       allocator The allocator function, or NULL for the C allocator.
+ * @param       allocatorData The data passed to the allocator function.
+ */
+CLOX_API void CLOX_STDCALL cloxSetMemoryAllocator(CloxMemory_t *const memory, const CloxAllocatorFunc_t allocator, void *const allocatorData);
+
+/**
+ * @brief       This function gets the current memory of the calling thread.
+ *
+ * @return      A pointer to the current memory, the default one when none has
+ *              been set.
+ */
+CLOX_API CloxMemory_t *CLOX_STDCALL cloxGetMemory(void);
+/**
+ * @brief       This function sets the current memory of the calling thread, the
+ *              one taken by the subsystems initialized afterwards.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance, or NULL for the
+ *              default one.
+ * @return      A pointer to the previous current memory.
+ */
+CLOX_API CloxMemory_t *CLOX_STDCALL cloxSetMemory(CloxMemory_t *const memory);
+
+/**
+ * @brief       This function accounts a block obtained by other means (like a
+ *              block carved from an arena) without allocating it.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance.
+ * @param       kind The kind of the block.
+ * @param       size The number of bytes of the block.
+ * @return      TRUE on success, FALSE if the limit would be exceeded (then
+ *              nothing is accounted).
+ */
+CLOX_API bool_t CLOX_STDCALL cloxMemoryCharge(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size);
+/**
+ * @brief       This function removes from the accounting a block accounted by
+ *              cloxMemoryCharge.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance.
+ * @param       kind The kind of the block.
+ * @param       size The number of bytes of the block.
+ */
+CLOX_API void CLOX_STDCALL cloxMemoryDischarge(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size);
+
+/**
+ * @brief       This function allocates a block of bytes from a memory, its
+ *              content is not initialized.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance.
+ * @param       kind The kind of the block.
+ * @param       size The number of bytes to allocate.
+ * @return      A pointer to the new block, or NULL if the limit would be
+ *              exceeded (the limit function is not called) or if the allocator
+ *              fails.
+ */
+CLOX_API void *CLOX_STDCALL cloxMemoryTryAlloc(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size);
+/**
+ * @brief       This function allocates a block of bytes from a memory, its
+ *              content is not initialized.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance.
+ * @param       kind The kind of the block.
+ * @param       size The number of bytes to allocate.
+ * @return      On success this function returns a pointer to the new block. If
+ *              the limit would be exceeded the limit function is called, on
+ *              other failures a fatal error will be raised.
+ */
+CLOX_API void *CLOX_STDCALL cloxMemoryAlloc(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size);
+/**
+ * @brief       This function allocates from a memory an array of count items
+ *              of the specified size, initialized to zero.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance.
+ * @param       kind The kind of the block.
+ * @param       count The number of items to allocate.
+ * @param       size The size of each item.
+ * @return      On success this function returns a pointer to the new block,
+ *              failures are handled like in cloxMemoryAlloc.
+ */
+CLOX_API void *CLOX_STDCALL cloxMemoryDim(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t count, const size_t size);
+/**
+ * @brief       This function resizes a block allocated from a memory.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance.
+ * @param       kind The kind of the block.
+ * @param       block A pointer to the block to resize, it can be NULL.
+ * @param       oldSize The current number of bytes of the block.
+ * @param       newSize The new number of bytes of the block, not zero.
+ * @return      On success this function returns a pointer to the resized block,
+ *              failures are handled like in cloxMemoryAlloc.
+ */
+CLOX_API void *CLOX_STDCALL cloxMemoryRealloc(CloxMemory_t *const memory, const CloxMemoryKind_t kind, void *const block, const size_t oldSize, const size_t newSize);
+/**
+ * @brief       This function releases a block allocated from a memory.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance.
+ * @param       kind The kind of the block.
+ * @param       block A pointer to the block to release, it can be NULL.
+ * @param       size The number of bytes of the block.
+ */
+CLOX_API void CLOX_STDCALL cloxMemoryFree(CloxMemory_t *const memory, const CloxMemoryKind_t kind, void *const block, const size_t size);
+
+/**
+ * @brief       This function takes a snapshot of the statistics of a memory
+ *              kind.
+ *
+ * @param       memory A pointer to the CloxMemory_t instance.
+ * @param       kind The memory kind.
+ * @param       outStats A pointer to the CloxMemoryStats_t that receives them.
+ */
+CLOX_API void CLOX_STDCALL cloxGetMemoryStats(const CloxMemory_t *const memory, const CloxMemoryKind_t kind, CloxMemoryStats_t *const outStats);
+/**
+ * @brief       This function gets the name of a memory kind.
+ *
+ * @param       kind The memory kind.
+ * @return      The name of the kind (like "code"), or NULL if the kind is
+ *              unknown.
+ */
+CLOX_API const char *CLOX_STDCALL cloxGetMemoryKindName(const CloxMemoryKind_t kind);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_BASE_MEMORY_H_ */
@@ -0,0 +1,132 @@
+#pragma once
+
+/**
+ * @file        poll.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined a poller, which waits for several
+ *              handles (files, pipes or sockets) to be ready for a non-blocking
+ *              I/O operation, with the mechanism of the platform: epoll on
+ *              Linux, kqueue on macOS, WSAPoll on Windows and poll elsewhere.
+ */
+
+#ifndef CLOX_BASE_POLL_H_
+#define CLOX_BASE_POLL_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @brief       The datatype of the handles a poller waits for: a file
+ *              descriptor, or a socket on Windows.
+ */
+#if CLOX_PLATFORM_IS_WINDOWS
+typedef uintptr_t CloxPollHandle_t;
+#else
+typedef int CloxPollHandle_t;
+#endif
+
+/**
+ * @brief       This enumeration provides the events a handle can be waited
+ *              for, they can be combined.
+ */
+typedef enum _CloxPollEvents
+{
+    /**
+     * @brief   The handle can be read without blocking (or it has been closed
+     *          by the other end).
+     */
+    CLOX_POLL_READ  = 0x01,
+    /**
+     * @brief   The handle can be written without blocking.
+     */
+    CLOX_POLL_WRITE = 0x02,
+    /**
+     * @brief   An error occurred on the handle, reported whatever the events
+     *          waited for.
+     */
+    CLOX_POLL_ERROR = 0x04,
+} CloxPollEvents_t;
+
+/**
+ * @brief       This data structure provides an event reported by a poller.
+ */
+typedef struct _CloxPollEvent
+{
+    /**
+     * @brief   The events the handle is ready for.
+     */
+    uint32_t  events;
+    /**
+     * @brief   The data attached to the handle when it was added.
+     */
+    void     *data;
+} CloxPollEvent_t;
+
+/**
+ * @brief       An opaque handle to a poller.
+ */
+typedef struct _CloxPoller *CloxPoller_t;
+
+/**
+ * @brief       This function creates a poller.
+ *
+ * @return      The handle of the poller, or NULL if it cannot be created.
+ */
+CLOX_API CloxPoller_t CLOX_STDCALL cloxPollerCreate(void);
+/**
+ * @brief       This function releases a poller, the handles it waits for are
+ *              left open.
+ *
+ * @param       poller The handle of the poller.
+ */
+CLOX_API void CLOX_STDCALL cloxPollerDestroy(CloxPoller_t poller);
+
+/**
+ * @brief       This function adds a handle to wait for. The registration is
+ *              one-shot: it is removed once an event is reported for it, so it
+ *              must be added again to be waited for once more.
+ *
+ * @param       poller The handle of the poller.
+ * @param       handle The handle to wait for, not waited for already.
+ * @param       events The events to wait for (a combination of CLOX_POLL_READ
+ *              and CLOX_POLL_WRITE).
+ * @param       data The data reported with the events of the handle.
+ * @return      TRUE in case of success, else FALSE.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxPollerAdd(CloxPoller_t poller, const CloxPollHandle_t handle, const uint32_t events, void *const data);
+/**
+ * @brief       This function removes a handle before an event is reported for
+ *              it.
+ *
+ * @param       poller The handle of the poller.
+ * @param       handle The handle to remove.
+ * @return      TRUE in case of success, FALSE if it was not waited for.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxPollerRemove(CloxPoller_t poller, const CloxPollHandle_t handle);
+/**
+ * @brief       This function waits until at least one of the handles is ready,
+ *              or until the timeout expires.
+ *
+ * @param       poller The handle of the poller.
+ * @param       events An array into which the events are stored.
+ * @param       count The number of events the array can store.
+ * @param       timeout The maximum time to wait in milliseconds, a negative
+ *              one to wait with no limit, zero to not wait.
+ * @return      The number of events stored, zero on timeout or on error.
+ */
+CLOX_API size_t CLOX_STDCALL cloxPollerWait(CloxPoller_t poller, CloxPollEvent_t *const events, const size_t count, const int timeout);
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_BASE_POLL_H_ */
@@ -356,6 +356,10 @@ CLOX_INLINE const char **CLOX_STDCALL strisrt(const char **const a, size_t count
 /**
  * @brief       Allocates a new formatted string with a va_list, with vprintf
  *              style format.
+ *
+ * @note        Each call allocates and copies a whole new string, so strings
+ *              built by repeated concatenation should use a string builder
+ *              (see builder.h) instead.
  * 
  * @param       format printf-style format string. 
  * @param       others Arguments list.
@@ -369,7 +373,12 @@ CLOX_INLINE char *CLOX_STDCALL vstrfmt(const char *const format, va_list arglist
     char *result;
 
 #if CLOX_C_STANDARD >= CLOX_C_STANDARD_C99
-    int size = vsnprintf(NULL, 0, format, arglist);
+    va_list args;
+
+    /* the arguments are read twice, the list can be traversed only once */
+    va_copy(args, arglist);
+    int size = vsnprintf(NULL, 0, format, args);
+    va_end(args);
 
     if (!size)
         failno("cannot format an empty string");
@@ -0,0 +1,215 @@
+#pragma once
+
+/**
+ * @file        thread.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header are defined the few threading primitives used
+ *              to spread work over a pool of workers: threads, the number of
+ *              processors, an atomic counter and the few atomic accesses
+ *              shared by the virtual machine with the other threads (built on
+ *              the interlocked intrinsics with MSVC, on the __atomic builtins
+ *              elsewhere).
+ */
+
+#ifndef CLOX_BASE_THREAD_H_
+#define CLOX_BASE_THREAD_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/byte.h"
+
+#if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+#   include <intrin.h>
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @brief       The datatype of the function run by a thread.
+ */
+typedef void (CLOX_STDCALL *CloxThreadFunction_t)(void *const argument);
+
+/**
+ * @brief       An opaque handle to a thread.
+ */
+typedef struct _CloxThread *CloxThread_t;
+
+/**
+ * @brief       This function starts a thread.
+ *
+ * @param       function The function run by the thread.
+ * @param       argument The argument passed to the function.
+ * @return      The handle of the thread, or NULL if it cannot be started.
+ */
+CLOX_API CloxThread_t CLOX_STDCALL cloxThreadCreate(const CloxThreadFunction_t function, void *const argument);
+/**
+ * @brief       This function waits for the end of a thread, then releases its
+ *              handle.
+ *
+ * @param       thread The handle of the thread.
+ * @return      TRUE in case of success, else FALSE.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxThreadJoin(CloxThread_t thread);
+/**
+ * @brief       This function gets the number of processors available to the
+ *              process.
+ *
+ * @return      The number of processors, at least one.
+ */
+CLOX_API size_t CLOX_STDCALL cloxThreadCount(void);
+
+/**
+ * @brief       This function atomically adds a value to a counter shared by
+ *              threads.
+ *
+ * @param       counter A pointer to the counter.
+ * @param       value The value to add.
+ * @return      The value of the counter before the addition.
+ */
+CLOX_API size_t CLOX_STDCALL cloxAtomicFetchAdd(volatile size_t *const counter, const size_t value);
+/**
+ * @brief       This function atomically replaces the value of a counter shared
+ *              by threads, if it still holds the expected one.
+ *
+ * @param       counter A pointer to the counter.
+ * @param       expected The value the counter is expected to hold.
+ * @param       value The value to store.
+ * @return      The value of the counter before the operation, it equals the
+ *              expected one if the value has been stored.
+ */
+CLOX_API size_t CLOX_STDCALL cloxAtomicCompareExchange(volatile size_t *const counter, const size_t expected, const size_t value);
+
+/**
+ * @brief       This function atomically loads a 64-bit value, no access that
+ *              follows it can be moved before it (acquire ordering).
+ *
+ * @param       source A pointer to the value.
+ * @return      The loaded value.
+ */
+CLOX_API_INLINE uint64_t CLOX_STDCALL cloxAtomicLoadAcquire64(const volatile uint64_t *const source)
+{
+#if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+    /* a 64-bit load is not atomic on 32-bit targets, a failing exchange is */
+    return (uint64_t)_InterlockedCompareExchange64((volatile __int64 *)source, 0, 0);
+#else
+    return __atomic_load_n(source, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/**
+ * @brief       This function atomically loads a 64-bit value, without
+ *              ordering the other accesses (relaxed ordering).
+ *
+ * @param       source A pointer to the value.
+ * @return      The loaded value.
+ */
+CLOX_API_INLINE uint64_t CLOX_STDCALL cloxAtomicLoadRelaxed64(const volatile uint64_t *const source)
+{
+#if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+    return (uint64_t)_InterlockedCompareExchange64((volatile __int64 *)source, 0, 0);
+#else
+    return __atomic_load_n(source, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * @brief       This function atomically stores a 64-bit value, no access that
+ *              precedes it can be moved after it (release ordering).
+ *
+ * @param       target A pointer to the value.
+ * @param       value The value to store.
+ */
+CLOX_API_INLINE void CLOX_STDCALL cloxAtomicStoreRelease64(volatile uint64_t *const target, const uint64_t value)
+{
+#if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+    _InterlockedExchange64((volatile __int64 *)target, (__int64)value);
+#else
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+#endif
+
+    return;
+}
+
+/**
+ * @brief       This function atomically loads a byte, without ordering the
+ *              other accesses (relaxed ordering).
+ *
+ * @param       source A pointer to the byte.
+ * @return      The loaded byte.
+ */
+CLOX_API_INLINE byte_t CLOX_STDCALL cloxAtomicLoadRelaxedByte(const volatile byte_t *const source)
+{
+#if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+    /* the aligned accesses are atomic on every target of MSVC */
+    return *source;
+#else
+    return __atomic_load_n(source, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * @brief       This function atomically stores a byte, without ordering the
+ *              other accesses (relaxed ordering).
+ *
+ * @param       target A pointer to the byte.
+ * @param       value The byte to store.
+ */
+CLOX_API_INLINE void CLOX_STDCALL cloxAtomicStoreRelaxedByte(volatile byte_t *const target, const byte_t value)
+{
+#if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+    *target = value;
+#else
+    __atomic_store_n(target, value, __ATOMIC_RELAXED);
+#endif
+
+    return;
+}
+
+/**
+ * @brief       This function atomically stores a pointer, without ordering
+ *              the other accesses (relaxed ordering).
+ *
+ * @param       target A pointer to the pointer.
+ * @param       value The pointer to store.
+ */
+CLOX_API_INLINE void CLOX_STDCALL cloxAtomicStoreRelaxedPointer(const void *volatile *const target, const void *const value)
+{
+#if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+    *target = value;
+#else
+    __atomic_store_n(target, value, __ATOMIC_RELAXED);
+#endif
+
+    return;
+}
+
+/**
+ * @brief       This function prevents the loads that precede it from being
+ *              moved after the accesses that follow it (acquire fence).
+ */
+CLOX_API_INLINE void CLOX_STDCALL cloxAtomicFenceAcquire(void)
+{
+#if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+    /* an interlocked operation is a full barrier on every target */
+    volatile long barrier = 0;
+
+    _InterlockedOr(&barrier, 0);
+#else
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+#endif
+
+    return;
+}
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_BASE_THREAD_H_ */
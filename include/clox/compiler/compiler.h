@@ -0,0 +1,437 @@
+#pragma once
+
+/**
+ * @file        compiler.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the compiler, a single pass parser
+ *              that translates the tokens of a Lox script into the bytecode
+ *              of a code block.
+ *
+ *              The compiled language is the subset of Lox that the virtual
+ *              machine can run: numbers, booleans and nil, the arithmetic,
+ *              comparison and logical operators, variables, blocks, the
+ *              print, if, while and for statements and the functions declared
+ *              by the script, called by name.
+ *
+ *              Function bodies are compiled lazily: a declaration only finds
+ *              the bounds of its body, which is compiled at the end of the
+ *              source once a compiled call reaches it, so the functions that
+ *              nothing calls cost a scan of their tokens.
+ */
+
+#ifndef CLOX_COMPILER_COMPILER_H_
+#define CLOX_COMPILER_COMPILER_H_
+
+#include "clox/base/api.h"
+#include "clox/base/arena.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/byte.h"
+#include "clox/base/intern.h"
+
+#include "clox/compiler/lexer.h"
+
+#include "clox/source/source_buffer.h"
+
+#include "clox/vm/code_block.h"
+#include "clox/vm/emitter.h"
+#include "clox/vm/optimizer.h"
+#include "clox/vm/vm.h"
+
+#include <stdio.h>
+
+#ifndef CLOX_COMPILER_LOCALS_COUNT
+/**
+ * @brief       This constant represents the maximum number of variables alive
+ *              at the same time, each one is stored into a register of the
+ *              outermost window (one register is kept for temporaries).
+ */
+#   define CLOX_COMPILER_LOCALS_COUNT (CLOX_VM_REGISTERS_COUNT - 1)
+#endif
+
+#ifndef CLOX_COMPILER_SIGNAL_PRINT
+/**
+ * @brief       This constant represents the signal raised by the 'print'
+ *              statement, the value to print is on the top of the stack and
+ *              the host pops it before resuming the virtual machine.
+ */
+#   define CLOX_COMPILER_SIGNAL_PRINT 0x0001
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    COMPILER Compiler
+ * @{
+ */
+
+#pragma region Compiler
+
+/**
+ * @brief       This enumeration provides the results of an incremental
+ *              compilation.
+ */
+typedef enum _CloxCompilerStatus
+{
+    /**
+     * @brief   The source has been compiled without errors.
+     */
+    CLOX_COMPILER_STATUS_SUCCESS = 0x00,
+    /**
+     * @brief   The source has errors, they have been reported.
+     */
+    CLOX_COMPILER_STATUS_ERROR,
+    /**
+     * @brief   The source doesn't end with a complete statement yet, nothing
+     *          has been compiled.
+     */
+    CLOX_COMPILER_STATUS_INCOMPLETE,
+} CloxCompilerStatus_t;
+
+/**
+ * @brief       This data structure provides a variable in scope, bound to the
+ *              register that stores its value.
+ */
+typedef struct _CloxCompilerLocal
+{
+    /**
+     * @brief   The interned name of the variable.
+     */
+    const CloxString_t *name;
+    /**
+     * @brief   The depth of the scope of the variable, or -1 while its
+     *          initializer is compiled.
+     */
+    int32_t             depth;
+    /**
+     * @brief   The register that stores the value of the variable.
+     */
+    byte_t              reg;
+} CloxCompilerLocal_t;
+
+/**
+ * @brief       This data structure provides a function declared by the script,
+ *              with the range of tokens of its body.
+ */
+typedef struct _CloxCompilerFunction
+{
+    /**
+     * @brief   The interned name of the function.
+     */
+    const CloxString_t *name;
+    /**
+     * @brief   A pointer to the token of the name, the parameters follow it
+     *          between brackets.
+     */
+    const CloxToken_t  *declaration;
+    /**
+     * @brief   A pointer to the '}' token that closes the body.
+     */
+    const CloxToken_t  *end;
+    /**
+     * @brief   The offset of the code of the function in the code block, or
+     *          SIZE_MAX while its body isn't compiled.
+     */
+    size_t              offset;
+    /**
+     * @brief   The index of the next function waiting to be compiled, or
+     *          SIZE_MAX for the last one.
+     */
+    size_t              next;
+    /**
+     * @brief   The index of the kept chunk whose tokens hold the function, or
+     *          SIZE_MAX when they are the ones of the compiled source.
+     */
+    size_t              chunk;
+    /**
+     * @brief   The number of parameters.
+     */
+    byte_t              arity;
+    /**
+     * @brief   Set once a call reaches the function (or once it is declared,
+     *          when every body is compiled), so its body is compiled.
+     */
+    bool_t              isQueued;
+} CloxCompilerFunction_t;
+
+/**
+ * @brief       This data structure provides a chunk of an interactive session
+ *              that declared functions, kept with its tokens so that the next
+ *              chunks can compile their bodies.
+ */
+typedef struct _CloxCompilerChunk
+{
+    /**
+     * @brief   A pointer to a copy of the source of the chunk.
+     */
+    CloxSourceBuffer_t *sourceBuffer;
+    /**
+     * @brief   The lexer that scanned the copy, its tokens are allocated on the
+     *          heap.
+     */
+    CloxLexer_t         lexer;
+    /**
+     * @brief   The line on which the chunk begins.
+     */
+    uint32_t            line;
+} CloxCompilerChunk_t;
+
+/**
+ * @brief       This data structure provides a call whose target is not compiled
+ *              yet, patched at the end of the source.
+ */
+typedef struct _CloxCompilerCall
+{
+    /**
+     * @brief   The offset of the 'call' instruction.
+     */
+    size_t offset;
+    /**
+     * @brief   The index of the called function.
+     */
+    size_t function;
+} CloxCompilerCall_t;
+
+/**
+ * @brief       This data structure provides the state of a compiler.
+ */
+typedef struct _CloxCompiler
+{
+    /**
+     * @brief   The lexer that scans the compiled source buffer.
+     */
+    CloxLexer_t                   lexer;
+    /**
+     * @brief   The emitter that writes the compiled code block.
+     */
+    CloxEmitter_t                 emitter;
+    /**
+     * @brief   The table in which identifiers are interned, so that names are
+     *          compared by pointer.
+     */
+    CloxStringTable_t             strings;
+    /**
+     * @brief   The name of the compiled source, used in error messages.
+     */
+    const char                   *name;
+    /**
+     * @brief   The stream on which errors are reported, or NULL to report
+     *          them on stderr.
+     */
+    FILE                         *errorStream;
+    /**
+     * @brief   The line on which the compiled source begins, added to the lines
+     *          of its tokens (incremental compilations begin where the previous
+     *          one ended).
+     */
+    uint32_t                      line;
+    /**
+     * @brief   A pointer to the token being parsed.
+     */
+    const CloxToken_t            *current;
+    /**
+     * @brief   A pointer to the last parsed token.
+     */
+    const CloxToken_t            *previous;
+    /**
+     * @brief   The variables in scope, from the outermost to the innermost.
+     */
+    CloxCompilerLocal_t           locals[CLOX_COMPILER_LOCALS_COUNT];
+    /**
+     * @brief   The number of variables in scope.
+     */
+    size_t                        localsCount;
+    /**
+     * @brief   The depth of the current scope (zero for the script).
+     */
+    int32_t                       scopeDepth;
+    /**
+     * @brief   The register used for temporaries.
+     */
+    byte_t                        scratch;
+    /**
+     * @brief   A pointer to the functions declared by the source.
+     */
+    CloxCompilerFunction_t       *functions;
+    /**
+     * @brief   The number of declared functions.
+     */
+    size_t                        functionsCount;
+    /**
+     * @brief   The number of functions that can be stored before growing the
+     *          functions array.
+     */
+    size_t                        functionsCapacity;
+    /**
+     * @brief   The number of functions declared by the previous chunks of an
+     *          interactive session, which come first in the functions array.
+     */
+    size_t                        functionsKept;
+    /**
+     * @brief   A pointer to the chunks that declared the kept functions.
+     */
+    CloxCompilerChunk_t          *chunks;
+    /**
+     * @brief   The number of kept chunks.
+     */
+    size_t                        chunksCount;
+    /**
+     * @brief   The number of chunks that can be stored before growing the
+     *          chunks array.
+     */
+    size_t                        chunksCapacity;
+    /**
+     * @brief   A pointer to the names of the functions declared by the chunks
+     *          of an interactive session that failed to compile, so that their
+     *          calls are reported.
+     */
+    const CloxString_t          **dropped;
+    /**
+     * @brief   The number of dropped names.
+     */
+    size_t                        droppedCount;
+    /**
+     * @brief   The number of names that can be stored before growing the
+     *          dropped array.
+     */
+    size_t                        droppedCapacity;
+    /**
+     * @brief   The index of the first function waiting to be compiled, or
+     *          SIZE_MAX when there are none.
+     */
+    size_t                        pending;
+    /**
+     * @brief   A pointer to the calls to patch once their targets are compiled.
+     */
+    CloxCompilerCall_t           *calls;
+    /**
+     * @brief   The number of calls to patch.
+     */
+    size_t                        callsCount;
+    /**
+     * @brief   The number of calls that can be stored before growing the calls
+     *          array.
+     */
+    size_t                        callsCapacity;
+    /**
+     * @brief   A pointer to the function whose body is compiled, or NULL for
+     *          the script.
+     */
+    const CloxCompilerFunction_t *function;
+    /**
+     * @brief   A pointer to the first token of the value of the 'return' being
+     *          compiled, a call that begins there and ends the value is a tail
+     *          call. It is NULL outside of 'return' statements.
+     */
+    const CloxToken_t            *tailCall;
+    /**
+     * @brief   The index of the first variable of the function whose body is
+     *          compiled, the ones before it belong to the script.
+     */
+    size_t                        localsBase;
+    /**
+     * @brief   When it's set to TRUE every function body is compiled, even if
+     *          nothing calls it, so that all the errors of the source are
+     *          reported (FALSE by default).
+     */
+    bool_t                        verify;
+    /**
+     * @brief   The level at which the compiled blocks are optimized, see
+     *          cloxCodeBlockOptimize (CLOX_OPTIMIZATION_LEVEL_DEFAULT by
+     *          default, CLOX_OPTIMIZATION_LEVEL_O0 keeps the exact lines).
+     */
+    CloxOptimizationLevel_t       optimization;
+    /**
+     * @brief   The number of errors reported by the last compilation.
+     */
+    size_t                        errorsCount;
+    /**
+     * @brief   Set after an error until the next statement, so that errors
+     *          caused by the first one are not reported.
+     */
+    bool_t                        panicMode;
+} CloxCompiler_t;
+
+/**
+ * @brief       This function initializes a CloxCompiler_t data structure.
+ *
+ * @param       compiler A pointer to the CloxCompiler_t instance to initialize.
+ * @param       arena A pointer to the arena from which allocate the tokens and
+ *              the interned identifiers, or NULL to allocate them on the heap.
+ * @return      On success this function returns a pointer to the initialized
+ *              compiler (so the value of compiler parameter).
+ */
+CLOX_API CloxCompiler_t *CLOX_STDCALL cloxInitCompiler(CloxCompiler_t *const compiler, CloxArena_t *const arena);
+/**
+ * @brief       This function releases the resources of a CloxCompiler_t
+ *              instance without deleting it.
+ *
+ * @param       compiler A pointer to the CloxCompiler_t instance to free.
+ * @return      On success this function returns a pointer to the freed
+ *              compiler (so the value of compiler parameter).
+ */
+CLOX_API CloxCompiler_t *CLOX_STDCALL cloxFreeCompiler(CloxCompiler_t *const compiler);
+
+/**
+ * @brief       This function compiles a whole source buffer, appending its
+ *              bytecode to a code block. Errors are reported on the error
+ *              stream of the compiler as "name:line:column: error: message".
+ *
+ * @note        On success the block is already optimized at the level of the
+ *              compiler, so it is ready to run. Unless the verify flag of the compiler
+ *              is set, the errors in the bodies of the functions that nothing
+ *              calls are not reported, those bodies are not compiled. The
+ *              functions kept by an interactive session are dropped.
+ *
+ * @param       compiler A pointer to the CloxCompiler_t instance.
+ * @param       sourceBuffer A pointer to the source buffer to compile.
+ * @param       name The name of the source used in error messages, it can be
+ *              NULL.
+ * @param       codeBlock A pointer to the code block in which write.
+ * @return      TRUE if the source has been compiled without errors, otherwise
+ *              FALSE (and the content of the code block is unspecified).
+ */
+CLOX_API bool_t CLOX_STDCALL cloxCompile(CloxCompiler_t *const compiler, const CloxSourceBuffer_t *const sourceBuffer, const char *const name, CloxCodeBlock_t *const codeBlock);
+
+/**
+ * @brief       This function compiles the next chunk of an interactive session,
+ *              appending its bytecode to a code block. Unlike cloxCompile the
+ *              variables declared by the previous chunks stay in scope, bound
+ *              to their registers, so the chunks must run in order on the same
+ *              virtual machine, and the lines continue from the previous chunk.
+ * @note        A chunk is complete when its brackets are balanced and it ends
+ *              with a ';' or a '}' (so an 'else' must be on the line of the end
+ *              of its 'if'), the declarations of a chunk with errors are
+ *              discarded. The functions of a chunk are all compiled into its
+ *              code block (so that their errors are reported), the chunk is
+ *              then kept so that the next ones compile again the bodies of the
+ *              functions they call.
+ * @param       compiler A pointer to the CloxCompiler_t instance.
+ * @param       sourceBuffer A pointer to the source buffer to compile.
+ * @param       name The name of the source used in error messages, it can be
+ *              NULL.
+ * @param       codeBlock A pointer to the code block in which write.
+ * @param       isLast When it's set to TRUE the source is the end of the input,
+ *              so it is compiled even if it isn't complete.
+ * @return      The status of the compilation, an incomplete chunk is left to be
+ *              compiled again with the lines that follow it.
+ */
+CLOX_API CloxCompilerStatus_t CLOX_STDCALL cloxCompileIncremental(CloxCompiler_t *const compiler, const CloxSourceBuffer_t *const sourceBuffer, const char *const name, CloxCodeBlock_t *const codeBlock, const bool_t isLast);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_COMPILER_COMPILER_H_ */
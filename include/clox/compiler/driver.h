@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * @file        driver.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the compile driver, which compiles
+ *              independent modules on a pool of worker threads. Each worker
+ *              owns an arena and a compiler (so a shard of the interned
+ *              identifiers), the results are collected in the order of the
+ *              modules whatever the scheduling.
+ */
+
+#ifndef CLOX_COMPILER_DRIVER_H_
+#define CLOX_COMPILER_DRIVER_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+
+#include "clox/vm/code_block.h"
+#include "clox/vm/optimizer.h"
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @brief       This enumeration provides the results of a compile job.
+ */
+typedef enum _CloxCompileJobStatus
+{
+    /**
+     * @brief   The job has not been run yet.
+     */
+    CLOX_COMPILE_JOB_STATUS_PENDING = 0x00,
+    /**
+     * @brief   The module has been compiled without errors.
+     */
+    CLOX_COMPILE_JOB_STATUS_SUCCESS,
+    /**
+     * @brief   The module has errors, see the diagnostics of the job.
+     */
+    CLOX_COMPILE_JOB_STATUS_ERROR,
+    /**
+     * @brief   The module cannot be read.
+     */
+    CLOX_COMPILE_JOB_STATUS_NOINPUT,
+} CloxCompileJobStatus_t;
+
+/**
+ * @brief       This data structure provides the compilation of a module.
+ */
+typedef struct _CloxCompileJob
+{
+    /**
+     * @brief   The path of the module, also used as its name in errors.
+     */
+    const char             *path;
+    /**
+     * @brief   The code block of the module.
+     */
+    CloxCodeBlock_t         codeBlock;
+    /**
+     * @brief   The errors reported while compiling the module, as the compiler
+     *          writes them, or NULL when there are none.
+     */
+    char                   *diagnostics;
+    /**
+     * @brief   The result of the job.
+     */
+    CloxCompileJobStatus_t  status;
+    /**
+     * @brief   When it's set to TRUE every function body of the module is
+     *          compiled, so all its errors are reported (FALSE by default).
+     */
+    bool_t                  verify;
+    /**
+     * @brief   The level at which the module is optimized
+     *          (CLOX_OPTIMIZATION_LEVEL_DEFAULT by default).
+     */
+    CloxOptimizationLevel_t optimization;
+} CloxCompileJob_t;
+
+/**
+ * @brief       This function initializes a CloxCompileJob_t data structure.
+ *
+ * @param       job A pointer to the CloxCompileJob_t instance to initialize.
+ * @param       path The path of the module to compile.
+ * @return      On success this function returns a pointer to the initialized
+ *              job (so the value of job parameter).
+ */
+CLOX_API CloxCompileJob_t *CLOX_STDCALL cloxInitCompileJob(CloxCompileJob_t *const job, const char *const path);
+/**
+ * @brief       This function releases the resources of a CloxCompileJob_t
+ *              instance (its code block included) without deleting it.
+ *
+ * @param       job A pointer to the CloxCompileJob_t instance to free.
+ * @return      On success this function returns a pointer to the freed job
+ *              (so the value of job parameter).
+ */
+CLOX_API CloxCompileJob_t *CLOX_STDCALL cloxFreeCompileJob(CloxCompileJob_t *const job);
+
+/**
+ * @brief       This function runs the specified compile jobs. Workers take the
+ *              next pending job until none is left, the calling thread being
+ *              one of them. A compiler keeps no state from a module to the
+ *              next, so the results don't depend on how many workers run or on
+ *              which one takes a job.
+ *
+ * @param       jobs A pointer to the jobs.
+ * @param       count The number of jobs.
+ * @param       threads The number of workers, zero to use one for each
+ *              processor (never more than the jobs).
+ * @return      The number of jobs that compiled successfully.
+ */
+CLOX_API size_t CLOX_STDCALL cloxCompileJobs(CloxCompileJob_t *const jobs, const size_t count, size_t threads);
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_COMPILER_DRIVER_H_ */
@@ -0,0 +1,281 @@
+#pragma once
+
+/**
+ * @file        lexer.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header are defined the tokens of the Lox language and
+ *              the lexer, that splits the content of a source stream into a
+ *              flat array of tokens in a single pass.
+ */
+
+#ifndef CLOX_COMPILER_LEXER_H_
+#define CLOX_COMPILER_LEXER_H_
+
+#include "clox/base/api.h"
+#include "clox/base/arena.h"
+#include "clox/base/bits.h"
+#include "clox/base/byte.h"
+
+#include "clox/source/source_buffer.h"
+#include "clox/source/source_location.h"
+#include "clox/source/source_stream.h"
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    TOKEN Token
+ * @{
+ */
+
+#pragma region Token
+
+#ifndef CLOX_COMPILER_TOKEN_INC_
+/**
+ * @brief       This constant represents the inclusion path to 'token.inc'
+ *              x-macro file.
+ */
+#   define CLOX_COMPILER_TOKEN_INC_ "clox/compiler/token.inc"
+#endif
+
+/**
+ * @brief       This enumeration provides the kinds of the tokens of the Lox
+ *              language.
+ */
+typedef enum _CloxTokenKind
+{
+#ifndef cloxDefineTokenKind
+/**
+ * @brief       This macro defines a token kind specifing also its displayable
+ *              name, used in CLOX_COMPILER_TOKEN_INC_ file.
+ */
+#   define cloxDefineTokenKind(tokenEnum, ...) tokenEnum,
+#endif
+
+#include CLOX_COMPILER_TOKEN_INC_
+
+#ifdef cloxDefineTokenKind
+#   undef cloxDefineTokenKind
+#endif
+
+    /**
+     * @brief   The number of token kinds.
+     */
+    CLOX_TOKEN_KIND_COUNT,
+} CloxTokenKind_t;
+
+/**
+ * @brief       This enumeration provides the errors reported by tokens of
+ *              CLOX_TOKEN_KIND_ERROR kind.
+ */
+typedef enum _CloxTokenError
+{
+    /**
+     * @brief   No error.
+     */
+    CLOX_TOKEN_ERROR_NONE                 = 0x00,
+    /**
+     * @brief   A character that does not begin any token.
+     */
+    CLOX_TOKEN_ERROR_UNEXPECTED_CHARACTER = 0x01,
+    /**
+     * @brief   A string literal without the closing quote.
+     */
+    CLOX_TOKEN_ERROR_UNTERMINATED_STRING  = 0x02,
+} CloxTokenError_t;
+
+/**
+ * @brief       This data structure provides a token, so a slice of the source
+ *              buffer with its kind and its packed location. Tokens don't own
+ *              any string: the lexeme is read from the source buffer.
+ */
+typedef struct _CloxToken
+{
+    /**
+     * @brief   The offset of the first byte of the lexeme in the source
+     *          buffer.
+     */
+    uint32_t offset;
+    /**
+     * @brief   The number of bytes of the lexeme.
+     */
+    uint32_t length;
+    /**
+     * @brief   The line of the first byte of the lexeme (zero based).
+     */
+    uint32_t line;
+    /**
+     * @brief   The column of the first byte of the lexeme (zero based), it
+     *          saturates to UINT16_MAX on very long lines.
+     */
+    uint16_t column;
+    /**
+     * @brief   The kind of the token (a CloxTokenKind_t value).
+     */
+    uint8_t  kind;
+    /**
+     * @brief   The error of the token (a CloxTokenError_t value), for tokens
+     *          of CLOX_TOKEN_KIND_ERROR kind.
+     */
+    uint8_t  error;
+} CloxToken_t;
+
+/**
+ * @brief       This function gets the displayable name of a token kind.
+ *
+ * @param       kind The token kind.
+ * @return      The name of the token kind, or NULL if it doesn't exist.
+ */
+CLOX_API const char *CLOX_STDCALL cloxGetTokenKindName(const CloxTokenKind_t kind);
+
+/**
+ * @brief       This function gets the displayable message of a token error.
+ *
+ * @param       error The token error.
+ * @return      The message of the error.
+ */
+CLOX_API const char *CLOX_STDCALL cloxGetTokenErrorMessage(const CloxTokenError_t error);
+
+/**
+ * @brief       This function unpacks the location of a token.
+ *
+ * @param       token A pointer to the token.
+ * @return      The location of the first byte of the token.
+ */
+CLOX_API_INLINE CloxSourceLocation_t CLOX_STDCALL cloxTokenLocation(const CloxToken_t *const token)
+{
+    CloxSourceLocation_t sourceLocation;
+
+    return *cloxSetSourceLocation(&sourceLocation, token->offset, token->column, token->line);
+}
+
+#pragma endregion
+
+/**
+ * @}
+ *
+ * @defgroup    LEXER Lexer
+ * @{
+ */
+
+#pragma region Lexer
+
+/**
+ * @brief       This data structure provides the state of a lexer, so the
+ *              scanned source buffer and the array of its tokens.
+ */
+typedef struct _CloxLexer
+{
+    /**
+     * @brief   A pointer to the source buffer of the last scan.
+     */
+    const CloxSourceBuffer_t *sourceBuffer;
+    /**
+     * @brief   A pointer to the first token of the array.
+     */
+    CloxToken_t              *tokens;
+    /**
+     * @brief   The number of tokens of the array, the last one is always of
+     *          CLOX_TOKEN_KIND_EOF kind after a scan.
+     */
+    size_t                    tokensCount;
+    /**
+     * @brief   The number of tokens that the array can store before growing.
+     */
+    size_t                    tokensCapacity;
+    /**
+     * @brief   The number of tokens of CLOX_TOKEN_KIND_ERROR kind.
+     */
+    size_t                    errorsCount;
+    /**
+     * @brief   The number of bytes scanned by the last scan.
+     */
+    size_t                    scannedBytes;
+    /**
+     * @brief   A pointer to the arena from which the tokens array is taken,
+     *          or NULL when it is allocated on the heap.
+     */
+    CloxArena_t              *arena;
+} CloxLexer_t;
+
+/**
+ * @brief       This function initializes a CloxLexer_t data structure.
+ *
+ * @param       lexer A pointer to the CloxLexer_t instance to initialize.
+ * @param       arena A pointer to the arena from which allocate the tokens, or
+ *              NULL to allocate them on the heap.
+ * @return      On success this function returns a pointer to the initialized
+ *              lexer (so the value of lexer parameter).
+ */
+CLOX_API CloxLexer_t *CLOX_STDCALL cloxInitLexer(CloxLexer_t *const lexer, CloxArena_t *const arena);
+/**
+ * @brief       This function releases the tokens of a CloxLexer_t instance
+ *              without deleting it.
+ *
+ * @param       lexer A pointer to the CloxLexer_t instance to free.
+ * @return      On success this function returns a pointer to the freed lexer
+ *              (so the value of lexer parameter).
+ */
+CLOX_API CloxLexer_t *CLOX_STDCALL cloxFreeLexer(CloxLexer_t *const lexer);
+
+/**
+ * @brief       This function scans a whole source buffer, replacing the tokens
+ *              of the lexer with the ones of the buffer. The scan stops at the
+ *              end of the buffer or at the first NUL character.
+ *
+ * @param       lexer A pointer to the CloxLexer_t instance.
+ * @param       sourceBuffer A pointer to the source buffer to scan, it must
+ *              outlive the tokens.
+ * @return      The number of scanned tokens, the final CLOX_TOKEN_KIND_EOF one
+ *              included.
+ */
+CLOX_API size_t CLOX_STDCALL cloxLexerScanBuffer(CloxLexer_t *const lexer, const CloxSourceBuffer_t *const sourceBuffer);
+/**
+ * @brief       This function scans the source buffer of a loaded source stream
+ *              (created from a text, a file or a file stream).
+ *
+ * @param       lexer A pointer to the CloxLexer_t instance.
+ * @param       sourceStream A pointer to the source stream to scan.
+ * @return      The number of scanned tokens, the final CLOX_TOKEN_KIND_EOF one
+ *              included.
+ */
+CLOX_API size_t CLOX_STDCALL cloxLexerScan(CloxLexer_t *const lexer, const CloxSourceStream_t *const sourceStream);
+
+/**
+ * @brief       This function gets the first byte of the lexeme of a token.
+ *
+ * @param       lexer A pointer to the CloxLexer_t instance.
+ * @param       token A pointer to one of the tokens of the lexer.
+ * @return      A pointer to the lexeme (not NUL-terminated).
+ */
+CLOX_API_INLINE const char *CLOX_STDCALL cloxLexerTokenText(const CloxLexer_t *const lexer, const CloxToken_t *const token)
+{
+    return (const char *)lexer->sourceBuffer->data + token->offset;
+}
+
+/**
+ * @brief       This function dumps the tokens of a lexer on a stream, one for
+ *              each line. When stream parameter is NULL the default choice is
+ *              stderr stream.
+ *
+ * @param       lexer A pointer to the CloxLexer_t instance.
+ * @param       stream The stream on which dump the tokens.
+ */
+CLOX_API void CLOX_STDCALL cloxDumpLexer(const CloxLexer_t *const lexer, FILE *const stream);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_COMPILER_LEXER_H_ */
@@ -19,9 +19,19 @@
 #define CLOX_SOURCE_SOURCE_BUFFER_H_
 
 #include "clox/base/api.h"
+#include "clox/base/arena.h"
 #include "clox/base/bits.h"
 #include "clox/base/byte.h"
 #include "clox/base/file.h"
+#include "clox/base/memory.h"
+
+#ifndef CLOX_SOURCE_BUFFER_MAPPING_THRESHOLD
+/**
+ * @brief       This constant represents the size (in bytes) from which source
+ *              files are mapped in memory instead of being loaded into a copy.
+ */
+#   define CLOX_SOURCE_BUFFER_MAPPING_THRESHOLD (CLOX_PAGESIZ * 256)
+#endif
 
 CLOX_C_HEADER_BEGIN
 
@@ -40,6 +50,66 @@ typedef enum _CloxSourceEncoding
     CLOX_SOURCE_ENCODING_UTF_8 = 0x20,
 } CloxSourceEncoding_t;
 
+/**
+ * @brief       Enumeration of the classes of ASCII characters that can be spanned
+ *              in a single call, classes can be combined with the bitwise OR.
+ */
+typedef enum _CloxSourceClass
+{
+    /**
+     * @brief   No character.
+     */
+    CLOX_SOURCE_CLASS_NONE       = 0x00,
+    /**
+     * @brief   Letters and underscore (a-z, A-Z, _).
+     */
+    CLOX_SOURCE_CLASS_ALPHA      = 0x01,
+    /**
+     * @brief   Decimal digits (0-9).
+     */
+    CLOX_SOURCE_CLASS_DIGIT      = 0x02,
+    /**
+     * @brief   Whitespaces (space, tab, carriage return, line feed, vertical
+     *          tab and form feed).
+     */
+    CLOX_SOURCE_CLASS_SPACE      = 0x04,
+    /**
+     * @brief   Any ASCII character but line feed and NUL, to skip the rest of
+     *          a line (like a comment).
+     */
+    CLOX_SOURCE_CLASS_LINE       = 0x08,
+    /**
+     * @brief   The characters of an identifier after the first one.
+     */
+    CLOX_SOURCE_CLASS_IDENTIFIER = CLOX_SOURCE_CLASS_ALPHA
+                                 | CLOX_SOURCE_CLASS_DIGIT,
+} CloxSourceClass_t;
+
+/**
+ * @brief       Enumeration of the results of the validation of a source buffer.
+ */
+typedef enum _CloxSourceValidity
+{
+    /**
+     * @brief   The buffer has not been validated (or its content has changed
+     *          since it was).
+     */
+    CLOX_SOURCE_VALIDITY_UNKNOWN = 0x00,
+    /**
+     * @brief   The buffer contains ill-formed UTF-8 sequences.
+     */
+    CLOX_SOURCE_VALIDITY_INVALID,
+    /**
+     * @brief   The buffer is well-formed UTF-8.
+     */
+    CLOX_SOURCE_VALIDITY_UTF_8,
+    /**
+     * @brief   The buffer contains only ASCII characters (so it is well-formed
+     *          UTF-8 too).
+     */
+    CLOX_SOURCE_VALIDITY_ASCII,
+} CloxSourceValidity_t;
+
 /**
  * @brief       Source buffer data structure.
  */
@@ -48,18 +118,44 @@ typedef struct _CloxSourceBuffer
     /**
      * @brief   A pointer to the beginning of the buffer's data.
      */
-    byte_t *data;
+    byte_t       *data;
     /**
      * @brief   The maximum number of characters that this source buffer can
      *          contain.
      */
-    size_t  size;
+    size_t        size;
+    /**
+     * @brief   A pointer to the arena from which the buffer is allocated, or
+     *          NULL when it is allocated on the heap.
+     */
+    CloxArena_t  *arena;
+    /**
+     * @brief   A pointer to the memory that accounts the buffer allocated on
+     *          the heap, the current one when the buffer is created.
+     */
+    CloxMemory_t *memory;
+    /**
+     * @brief   When it's set to TRUE the data is a read-only view of a file
+     *          mapped in memory, it is not terminated by a NUL character.
+     */
+    bool_t        isMapped;
+    /**
+     * @brief   The handle of the file mapping object (used only on Windows).
+     */
+    void         *mapping;
+    /**
+     * @brief   The result of the last validation of the content (a
+     *          CloxSourceValidity_t value), well-formed buffers are decoded
+     *          without checking their sequences.
+     */
+    uint8_t       validity;
 } CloxSourceBuffer_t;
 
 /**
  * @brief       Creates a new source buffer of the same number of characters as
  *              size parameter specifies and an initial content specified by the
- *              content parameter.
+ *              content parameter. The buffer is not validated, since its content
+ *              is usually written afterwards (see cloxSourceBufferValidate).
  * 
  * @param       size The maximum number of bytes that the source buffer will
  *              store.
@@ -69,6 +165,20 @@ typedef struct _CloxSourceBuffer
  * @return      A pointer to the new source buffer.
  */
 CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBuffer(size_t size, byte_t *const content, size_t count);
+/**
+ * @brief       Creates a new source buffer like cloxCreateSourceBuffer, but
+ *              allocating it (and its data) from an arena.
+ * 
+ * @param       size The maximum number of bytes that the source buffer will
+ *              store.
+ * @param       content A buffer of bytes representing the content that will be
+ *              copied in the buffer on its creation. It can be NULL.
+ * @param       count The number of bytes stored into content parameter.
+ * @param       arena A pointer to the arena from which allocate, when NULL the
+ *              buffer is allocated on the heap.
+ * @return      A pointer to the new source buffer.
+ */
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferInArena(size_t size, byte_t *const content, size_t count, CloxArena_t *const arena);
 
 /**
  * @brief       Creates a new source buffer that will contain a specified string
@@ -78,6 +188,15 @@ CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBuffer(size_t size, by
  * @return      A pointer to the new source buffer.
  */
 CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromText(const char *const text);
+/**
+ * @brief       Creates a new source buffer that will contain a specified string
+ *              of bytes, allocating it from an arena.
+ * 
+ * @param       text The string to wrap into the buffer.
+ * @param       arena A pointer to the arena from which allocate, it can be NULL.
+ * @return      A pointer to the new source buffer.
+ */
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromTextInArena(const char *const text, CloxArena_t *const arena);
 /**
  * @brief       Creates a new source buffers with the entire content of the file
  *              specified by the path parameter.
@@ -86,6 +205,25 @@ CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromText(const c
  * @return      A pointer to the new source buffer.
  */
 CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromFile(const char *const path);
+/**
+ * @brief       Creates a new source buffers with the entire content of the file
+ *              specified by the path parameter, allocating it from an arena.
+ * 
+ * @param       path The path to the file to load and wrap into the buffer.
+ * @param       arena A pointer to the arena from which allocate, it can be NULL.
+ * @return      A pointer to the new source buffer.
+ */
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromFileInArena(const char *const path, CloxArena_t *const arena);
+/**
+ * @brief       Creates a new source buffer that is a read-only view of the file
+ *              specified by the path parameter mapped in memory, so without
+ *              copying its content (mmap on POSIX, CreateFileMapping on Windows).
+ * 
+ * @param       path The path to the file to map.
+ * @return      A pointer to the new source buffer, or NULL if the file could
+ *              not be mapped (for instance when it is empty).
+ */
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromMappedFile(const char *const path);
 
 /**
  * @brief       Creates a new source buffer loading the content of a file stream,
@@ -95,6 +233,15 @@ CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromFile(const c
  * @return      A pointer to the new source buffer.
  */
 CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromStream(FILE *const stream);
+/**
+ * @brief       Creates a new source buffer loading the content of a file stream,
+ *              allocating it from an arena.
+ * 
+ * @param       stream A source file stream.
+ * @param       arena A pointer to the arena from which allocate, it can be NULL.
+ * @return      A pointer to the new source buffer.
+ */
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromStreamInArena(FILE *const stream, CloxArena_t *const arena);
 /**
  * @brief       Creates a new source buffer loading the next line of the stdin.
  * 
@@ -102,8 +249,23 @@ CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromStream(FILE
  */
 CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromStdin(void);
 
+/**
+ * @brief       Validates the whole content of a source buffer as UTF-8, in a
+ *              single pass that skips the runs of ASCII characters with vector
+ *              instructions when CLOX_SOURCE_SIMD is set. The result is stored
+ *              into the buffer, the buffers created with their whole content
+ *              (from a text, a file or a stream) are validated on creation, the
+ *              others when their content has been written.
+ * 
+ * @param       sourceBuffer A pointer to the source buffer to validate.
+ * @return      The validity of the content of the buffer.
+ */
+CLOX_API CloxSourceValidity_t CLOX_STDCALL cloxSourceBufferValidate(CloxSourceBuffer_t *const sourceBuffer);
+
 /**
  * @brief       Gets thecharacter in the position specified by position parameter.
+ *              The UTF-8 sequences of a well-formed buffer are decoded without
+ *              checks, the other buffers go through the full decoder.
  * 
  * @param       sourceBuffer A pointer to the source buffer from which read.
  * @param       encoding The encoding of the character to read.
@@ -114,6 +276,20 @@ CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromStdin(void);
  */
 CLOX_API int32_t CLOX_STDCALL cloxSourceBufferGetChar(CloxSourceBuffer_t *const sourceBuffer, CloxSourceEncoding_t encoding, uint64_t position, ssize_t *const outOffset);
 
+/**
+ * @brief       Computes the length of the run of ASCII characters of the specified
+ *              classes that begins at the position specified by position parameter.
+ *              The run is scanned with vector instructions when CLOX_SOURCE_SIMD is
+ *              set, and it always stops on bytes with the high bit set (so the caller
+ *              can decode them) and at the end of the buffer.
+ * 
+ * @param       sourceBuffer A pointer to the source buffer from which read.
+ * @param       position The position of the first character of the run.
+ * @param       classes The classes of the characters of the run.
+ * @return      The number of bytes of the run.
+ */
+CLOX_API size_t CLOX_STDCALL cloxSourceBufferSpan(const CloxSourceBuffer_t *const sourceBuffer, uint64_t position, CloxSourceClass_t classes);
+
 /**
  * @brief       Dumps the content of a source buffer on a stream. When stream parameter
  *              is NULL the default choice is stderr stream.
@@ -128,12 +304,15 @@ CLOX_API int CLOX_STDCALL cloxDumpSourceBuffer(const CloxSourceBuffer_t *const s
  * @brief       Clears the content of the source buffer.
  * 
  * @param       sourceBuffer A pointer to the source buffer to clear.
- * @return      TRUE when the buffer is cleared succefully, FALSE in the other cases.
+ * @return      TRUE when the buffer is cleared succefully, FALSE in the other cases
+ *              (mapped buffers are read-only, so they are never cleared). A cleared
+ *              buffer has to be validated again.
  */
 CLOX_API bool_t CLOX_STDCALL cloxClearSourceBuffer(CloxSourceBuffer_t *const sourceBuffer);
 
 /**
- * @brief       Deletes the specified source buffer releasing each used resource.
+ * @brief       Deletes the specified source buffer releasing each used resource,
+ *              buffers allocated from an arena are left to the arena.
  * 
  * @param       sourceBuffer A pointer to the source buffer to delete.
  */
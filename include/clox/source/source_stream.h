@@ -29,6 +29,15 @@
 #   define CLOX_DEFAULT_ENCODING CLOX_SOURCE_ENCODING_UTF_8
 #endif
 
+#ifndef CLOX_SOURCE_STREAM_RING_SIZE
+/**
+ * @brief       This constant macro represents the size of the ring buffer of
+ *              the open source streams (it must be a power of two): refills
+ *              append to the ring, so the bytes already loaded never move.
+ */
+#   define CLOX_SOURCE_STREAM_RING_SIZE CLOX_PAGESIZ
+#endif
+
 CLOX_C_HEADER_BEGIN
 
 /**
@@ -88,6 +97,17 @@ typedef struct _CloxSourceStream
      * @brief   The current lexeme ending location.
      */
     CloxSourceLocation_t forwardLocation;
+    /**
+     * @brief   The number of bytes loaded from the file stream, the buffer of
+     *          an open stream is a ring that stores a position at the
+     *          remainder of its division by the size of the buffer.
+     */
+    uint64_t             loadedCount;
+    /**
+     * @brief   A pointer to the arena from which the stream and its buffer
+     *          are allocated, or NULL when they are allocated on the heap.
+     */
+    CloxArena_t         *arena;
 } CloxSourceStream_t;
 
 /**
@@ -99,6 +119,17 @@ typedef struct _CloxSourceStream
  * @return      A pointer to the new source stream.
  */
 CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromText(const char *const text, CloxSourceEncoding_t encoding);
+/**
+ * @brief       Creates a new source stream like cloxCreateSourceStreamFromText,
+ *              allocating the stream and its buffer from an arena.
+ * 
+ * @param       text The string of characters o wrap into the new source stream.
+ * @param       encoding The encoding of the stream.
+ * @param       arena A pointer to the arena from which allocate, when NULL the
+ *              stream is allocated on the heap.
+ * @return      A pointer to the new source stream.
+ */
+CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromTextInArena(const char *const text, CloxSourceEncoding_t encoding, CloxArena_t *const arena);
 /**
  * @brief       Creates a new source stream filling the buffer only once loading
  *              the full content of the specified file.
@@ -109,6 +140,18 @@ CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromText(const c
  * @return      A pointer to the new source stream.
  */
 CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromFile(const char *const path, bool_t cleanupPath, CloxSourceEncoding_t encoding);
+/**
+ * @brief       Creates a new source stream like cloxCreateSourceStreamFromFile,
+ *              allocating the stream and its buffer from an arena.
+ * 
+ * @param       path The path to the file to load.
+ * @param       cleanupPath This flag specifies if the path must be deleted.
+ * @param       encoding The encoding of the stream.
+ * @param       arena A pointer to the arena from which allocate, when NULL the
+ *              stream is allocated on the heap.
+ * @return      A pointer to the new source stream.
+ */
+CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromFileInArena(const char *const path, bool_t cleanupPath, CloxSourceEncoding_t encoding, CloxArena_t *const arena);
 
 /**
  * @brief       Creates a new source stream filling the source buffer only once
@@ -119,10 +162,22 @@ CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromFile(const c
  * @return      A pointer to the new source stream.
  */
 CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromStream(FILE *const stream, CloxSourceEncoding_t encoding);
+/**
+ * @brief       Creates a new source stream like cloxCreateSourceStreamFromStream,
+ *              allocating the stream and its buffer from an arena.
+ * 
+ * @param       stream The file stream to load.
+ * @param       encoding The encoding of the stream.
+ * @param       arena A pointer to the arena from which allocate, when NULL the
+ *              stream is allocated on the heap.
+ * @return      A pointer to the new source stream.
+ */
+CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromStreamInArena(FILE *const stream, CloxSourceEncoding_t encoding, CloxArena_t *const arena);
 
 /**
  * @brief       Opens a new source stream from a file specified by tha path
- *              parameter.
+ *              parameter, the file is loaded into a ring buffer of
+ *              CLOX_SOURCE_STREAM_RING_SIZE bytes while it is read.
  * 
  * @param       path The path to the file to open.
  * @param       cleanupPath This flag specifies if the path must be deleted.
@@ -132,7 +187,9 @@ CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromStream(FILE
 CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxOpenSourceStream(const char *const path, bool_t cleanupPath, CloxSourceEncoding_t encoding);
 /**
  * @brief       Opens the source stream that uses stdin as source file. This
- *              function is a special case of the cloxOpenSourceStream function.
+ *              function is a special case of the cloxOpenSourceStream function:
+ *              each refill loads at most a line, so an interactive stream can
+ *              be consumed as soon as a line arrives.
  * 
  * @return       A pointer to the new source stream.
  */
@@ -174,6 +231,31 @@ CLOX_API int32_t CLOX_STDCALL cloxSourceStreamPeekOffset(CloxSourceStream_t *con
  */
 CLOX_API int32_t CLOX_STDCALL cloxSourceStreamReadOffset(CloxSourceStream_t *const sourceStream, uint32_t offset);
 
+/**
+ * @brief       Skips the run of ASCII characters of the specified classes next in
+ *              the stream (see cloxSourceBufferSpan), updating the lines and the
+ *              columns of the stream and forward locations as reading them one by
+ *              one would do.
+ * 
+ * @param       sourceStream A pointer to the source stream from which skip the
+ *              characters.
+ * @param       classes The classes of the characters to skip.
+ * @return      The number of skipped bytes.
+ */
+CLOX_API size_t CLOX_STDCALL cloxSourceStreamSkip(CloxSourceStream_t *const sourceStream, CloxSourceClass_t classes);
+
+/**
+ * @brief       Reads the next line of the stream, like fgets: the bytes are
+ *              copied up to the end of line (included) or until the buffer is
+ *              full, then the copy is terminated by a NUL character.
+ * @param       sourceStream A pointer to the source stream from which read the
+ *              line.
+ * @param       buffer A pointer to the buffer in which copy the line.
+ * @param       size The size of the buffer (it must be at least one byte).
+ * @return      The number of copied bytes, zero at the end of the stream.
+ */
+CLOX_API size_t CLOX_STDCALL cloxSourceStreamReadLine(CloxSourceStream_t *const sourceStream, char *const buffer, size_t size);
+
 /**
  * @brief       Closes an open source stream.
  * 
@@ -191,7 +273,8 @@ CLOX_API bool_t CLOX_STDCALL cloxClearSourceStream(CloxSourceStream_t *const sou
 
 /**
  * @brief       Deletes a source stream, closing the file stream, clearing the source
- *              buffer and releasing the resources associated to it.
+ *              buffer and releasing the resources associated to it (streams allocated
+ *              from an arena are only closed, their memory is left to the arena).
  * 
  * @param       sourceStream A pointer to the source stream to delete.
  */
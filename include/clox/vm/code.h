@@ -11,6 +11,7 @@
 #include "clox/base/api.h"
 #include "clox/base/bits.h"
 #include "clox/base/bool.h"
+#include "clox/base/byte.h"
 
 CLOX_C_HEADER_BEGIN
 
@@ -102,6 +103,75 @@ typedef enum _CloxOpKind
 
 #pragma endregion
 
+/**
+ * @}
+ * 
+ * @defgroup    OP_OPERANDS OpOperands
+ * @{
+ */
+
+#pragma region OpOperands
+
+/**
+ * @brief       This function decodes a 16-bit operand stored in little-endian
+ *              order starting from the specified byte.
+ * 
+ * @param       bytes A pointer to the first byte of the operand.
+ * @return      The decoded operand value.
+ */
+CLOX_INLINE uint16_t CLOX_STDCALL cloxDecodeOpHalf(const byte_t *const bytes)
+{
+    return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+/**
+ * @brief       This function decodes a 32-bit operand stored in little-endian
+ *              order starting from the specified byte.
+ * 
+ * @param       bytes A pointer to the first byte of the operand.
+ * @return      The decoded operand value.
+ */
+CLOX_INLINE uint32_t CLOX_STDCALL cloxDecodeOpWord(const byte_t *const bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+/**
+ * @brief       This function encodes a 16-bit operand in little-endian order
+ *              into the specified buffer.
+ * 
+ * @param       bytes A pointer to the buffer in which write the operand.
+ * @param       value The operand value to encode.
+ * @return      A pointer to the byte next to the encoded operand.
+ */
+CLOX_INLINE byte_t *CLOX_STDCALL cloxEncodeOpHalf(byte_t *const bytes, const uint16_t value)
+{
+    bytes[0] = (byte_t)(value);
+    bytes[1] = (byte_t)(value >> 8);
+
+    return bytes + 2;
+}
+
+/**
+ * @brief       This function encodes a 32-bit operand in little-endian order
+ *              into the specified buffer.
+ * 
+ * @param       bytes A pointer to the buffer in which write the operand.
+ * @param       value The operand value to encode.
+ * @return      A pointer to the byte next to the encoded operand.
+ */
+CLOX_INLINE byte_t *CLOX_STDCALL cloxEncodeOpWord(byte_t *const bytes, const uint32_t value)
+{
+    bytes[0] = (byte_t)(value);
+    bytes[1] = (byte_t)(value >> 8);
+    bytes[2] = (byte_t)(value >> 16);
+    bytes[3] = (byte_t)(value >> 24);
+
+    return bytes + 4;
+}
+
+#pragma endregion
+
 /**
  * @}
  * 
@@ -163,6 +233,10 @@ typedef struct _CloxOpCodeInfo
     const char  *name;
     /**
      * @brief   Represents the instruction handler address.
+     *
+     * @note    Handlers named in the 'code.inc' file are dispatch targets
+     *          of the interpreter loop (labels or switch cases), so in the
+     *          static opcodes table this field is always NULL.
      */
     void       (*func)(void);
     /**
@@ -191,6 +265,40 @@ typedef struct _CloxOpCodeInfo
  */
 CLOX_API bool_t CLOX_STDCALL cloxGetOpCodeInfo(const CloxOpCode_t opCode, CloxOpCodeInfo_t *const outOpCodeInfo);
 
+#ifndef CLOX_OP_CODE_HISTOGRAM_SIZE
+/**
+ * @brief       This constant represents the number of buckets of the time
+ *              histogram of an opcode, bucket i counts the executions that
+ *              lasted from 2^i to 2^(i+1) - 1 cycles (the last one counts the
+ *              longer ones too).
+ */
+#   define CLOX_OP_CODE_HISTOGRAM_SIZE 32
+#endif
+
+/**
+ * @brief       This data structure provides the execution counters of an
+ *              opcode, recorded by the virtual machine when CLOX_VM_OPCODE_STATS
+ *              is enabled.
+ *
+ * @note        Cycles are read with cloxClockCycles, so they include the
+ *              dispatch of the instruction and the cost of the measure.
+ */
+typedef struct _CloxOpCodeStats
+{
+    /**
+     * @brief   The number of executed instructions with the opcode.
+     */
+    uint64_t count;
+    /**
+     * @brief   The total number of cycles spent executing them.
+     */
+    uint64_t cycles;
+    /**
+     * @brief   The histogram of the cycles of each execution.
+     */
+    uint64_t histogram[CLOX_OP_CODE_HISTOGRAM_SIZE];
+} CloxOpCodeStats_t;
+
 /**
  * @}
  */
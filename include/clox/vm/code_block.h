@@ -19,8 +19,16 @@
 #define CLOX_VM_CODE_BLOCK_H_
 
 #include "clox/base/api.h"
+#include "clox/base/arena.h"
 #include "clox/base/bits.h"
 #include "clox/base/byte.h"
+#include "clox/base/memory.h"
+
+#include "clox/source/source_location.h"
+
+#include "clox/vm/code.h"
+#include "clox/vm/jit.h"
+#include "clox/vm/value.h"
 
 #ifndef cloxAlignToWordPtr
 /**
@@ -30,6 +38,32 @@
 #   define cloxAlignToWordPtr(size) alignto(size, CLOX_SIZEOF_WORD_PTR)
 #endif
 
+#ifndef CLOX_LINE_TABLE_CHECKPOINT_INTERVAL
+/**
+ * @brief       This constant represents the number of runs of a line table
+ *              between two checkpoints, so the number of runs a lookup decodes
+ *              at most after its binary search.
+ */
+#   define CLOX_LINE_TABLE_CHECKPOINT_INTERVAL 16
+#endif
+
+#ifndef CLOX_DECODED_OP_CODE_END
+/**
+ * @brief       This constant represents the opcode of the record that ends a
+ *              decoded block. It must not be a valid opcode, so the decoder
+ *              never finds it into the bytecode.
+ */
+#   define CLOX_DECODED_OP_CODE_END BYTE_MAX
+#endif
+
+#ifndef CLOX_VM_QUICK_OPCODE_INC_
+/**
+ * @brief       This constant represents the inclusion path to 'quick.inc'
+ *              x-macro file.
+ */
+#   define CLOX_VM_QUICK_OPCODE_INC_ "clox/vm/quick.inc"
+#endif
+
 CLOX_C_HEADER_BEGIN
 
 /**
@@ -39,6 +73,215 @@ CLOX_C_HEADER_BEGIN
 
 #pragma region Code Block
 
+/**
+ * @brief       This enumeration provides the opcodes into which the virtual
+ *              machine rewrites the records of arithmetic and comparison
+ *              instructions once it has seen the types of their operands (see
+ *              CLOX_VM_QUICKENING).
+ */
+typedef enum _CloxQuickOpCode
+{
+#ifndef cloxDefineQuickOpCode
+/**
+ * @brief       This macro defines a quickened opcode specifing also the opcode
+ *              it specializes, used in CLOX_VM_QUICK_OPCODE_INC_ file.
+ */
+#   define cloxDefineQuickOpCode(opEnum, opCode, ...) opEnum = opCode,
+#endif
+
+#include CLOX_VM_QUICK_OPCODE_INC_
+
+#ifdef cloxDefineQuickOpCode
+#   undef cloxDefineQuickOpCode
+#endif
+} CloxQuickOpCode_t;
+
+/**
+ * @brief       This data structure provides the state of the decoder of a line
+ *              table before one of its runs, a run is the range of bytecode
+ *              compiled from the same source location.
+ */
+typedef struct _CloxLineCheckpoint
+{
+    /**
+     * @brief   The offset of the bytecode where the previous run begins.
+     */
+    uint32_t offset;
+    /**
+     * @brief   The line of the previous run.
+     */
+    uint32_t line;
+    /**
+     * @brief   The column of the previous run.
+     */
+    uint32_t column;
+    /**
+     * @brief   The position in the encoded runs where the next run begins.
+     */
+    uint32_t position;
+} CloxLineCheckpoint_t;
+
+/**
+ * @brief       This data structure provides the table that maps the offsets of
+ *              a block of bytecode to the source locations they are compiled
+ *              from.
+ *
+ * @note        Each run is encoded as three variable-length integers: the
+ *              (unsigned) distance of its offset from the previous run's one,
+ *              then the (zigzag encoded) differences of its line and column,
+ *              so a run usually takes three bytes. Every
+ *              CLOX_LINE_TABLE_CHECKPOINT_INTERVAL runs a checkpoint is stored,
+ *              so lookups binary search the checkpoints before decoding.
+ */
+typedef struct _CloxLineTable
+{
+    /**
+     * @brief   A pointer to the encoded runs.
+     */
+    byte_t               *runs;
+    /**
+     * @brief   The number of bytes alredy used in the runs array.
+     */
+    size_t                runsSize;
+    /**
+     * @brief   The number of bytes that can be stored in the runs array before
+     *          growing it.
+     */
+    size_t                runsCapacity;
+    /**
+     * @brief   A pointer to the checkpoints, ordered by offset.
+     */
+    CloxLineCheckpoint_t *checkpoints;
+    /**
+     * @brief   The number of checkpoints alredy stored.
+     */
+    size_t                checkpointsCount;
+    /**
+     * @brief   The number of checkpoints that can be stored before growing the
+     *          checkpoints array.
+     */
+    size_t                checkpointsCapacity;
+    /**
+     * @brief   The number of runs of the table.
+     */
+    size_t                count;
+    /**
+     * @brief   The last run, its position is the one where it is encoded: an
+     *          empty run is encoded again when the next one has its offset.
+     */
+    CloxLineCheckpoint_t  last;
+    /**
+     * @brief   The run preceding the last one.
+     */
+    CloxLineCheckpoint_t  base;
+} CloxLineTable_t;
+
+/**
+ * @brief       This data structure provides the symbol of a function compiled
+ *              into a block of bytecode: the range of its body and its name.
+ */
+typedef struct _CloxCodeSymbol
+{
+    /**
+     * @brief   The offset of the first instruction of the body.
+     */
+    uint32_t offset;
+    /**
+     * @brief   The offset past the last instruction of the body.
+     */
+    uint32_t end;
+    /**
+     * @brief   The offset of the name of the function in the names array.
+     */
+    uint32_t name;
+} CloxCodeSymbol_t;
+
+/**
+ * @brief       This data structure provides a pre-decoded instruction: its
+ *              operands are unpacked from the bytecode, so that executing it
+ *              doesn't need to decode them again.
+ *
+ * @note        The operands are unpacked according to the kind of the opcode:
+ *              byte operands into z, x and y (in the order they are stored),
+ *              the 16-bit or 32-bit operand into operand. Jumps and branches
+ *              store the index of their target record into operand instead,
+ *              register compare and jumps their registers into x and y.
+ *              The handler and the opcode of arithmetic and comparison records
+ *              are rewritten at run-time into a quickened opcode (see
+ *              CloxQuickOpCode_t), their operands never change.
+ */
+typedef struct _CloxDecodedInstruction
+{
+    /**
+     * @brief   The address of the handler which executes the instruction, as
+     *          given to the decoder (NULL when it was given no handlers) or the
+     *          one of its quickened opcode.
+     */
+    const void *handler;
+    /**
+     * @brief   The 16-bit or 32-bit operand, or the index of the target record
+     *          of a jump or a branch.
+     */
+    uint32_t    operand;
+    /**
+     * @brief   The opcode of the instruction, or the quickened opcode into
+     *          which it has been rewritten.
+     */
+    byte_t      opCode;
+    /**
+     * @brief   The first byte operand.
+     */
+    byte_t      z;
+    /**
+     * @brief   The second byte operand.
+     */
+    byte_t      x;
+    /**
+     * @brief   The third byte operand.
+     */
+    byte_t      y;
+} CloxDecodedInstruction_t;
+
+/**
+ * @brief       This data structure provides the pre-decoded form of a block of
+ *              bytecode, cached on the block until the block is modified.
+ */
+typedef struct _CloxDecodedBlock
+{
+    /**
+     * @brief   A pointer to the records, one for each instruction plus the
+     *          one that ends the block (whose opcode is CLOX_DECODED_OP_CODE_END),
+     *          or NULL when the block is not decoded.
+     */
+    CloxDecodedInstruction_t *instructions;
+    /**
+     * @brief   A pointer to the offset of each record into the bytecode, the
+     *          one of the last record is the size of the block.
+     */
+    uint32_t                 *offsets;
+    /**
+     * @brief   The number of records, the one that ends the block excluded.
+     */
+    size_t                    count;
+    /**
+     * @brief   A pointer to the handlers table with which the records have been
+     *          decoded.
+     */
+    const void *const        *handlers;
+#if CLOX_VM_JIT
+    /**
+     * @brief   A pointer to the hot counter of each record, incremented when
+     *          it is the target of a backward jump or of a call.
+     */
+    uint32_t                 *counters;
+    /**
+     * @brief   A pointer to the compiled region entered at each record, NULL
+     *          when the record is not hot (or its region cannot be compiled).
+     */
+    CloxJitCode_t           **regions;
+#endif
+} CloxDecodedBlock_t;
+
 /**
  * @brief       This data structure provides a dynamic container to store a
  *              block of bytecode (so a dynamic sequence of bytes).
@@ -58,6 +301,106 @@ typedef struct _CloxCodeBlock
      *          is automatically and dynamically increased.
      */
     size_t  capacity;
+    /**
+     * @brief   A pointer to the dynamic array of constant values, indexed
+     *          by 'lec' and 'lea' instructions (and by their wide variants).
+     */
+    CloxValue_t *constants;
+    /**
+     * @brief   The number of constants alredy stored in the constants array.
+     */
+    size_t       constantsCount;
+    /**
+     * @brief   The number of constants that can be stored in the constants
+     *          array before growing it.
+     */
+    size_t       constantsCapacity;
+    /**
+     * @brief   A pointer to the open addressing hash index of the constants
+     *          pool, used to find duplicates: each slot stores the index of a
+     *          constant plus one, or zero when it is empty.
+     */
+    uint32_t    *constantsIndex;
+    /**
+     * @brief   The number of slots of the constants index (a power of two, or
+     *          zero when the index has not been built yet).
+     */
+    size_t       constantsIndexCapacity;
+    /**
+     * @brief   The number of constants inserted into the index, the ones added
+     *          after by cloxCodeBlockAddConstant are inserted lazily.
+     */
+    size_t       constantsIndexCount;
+    /**
+     * @brief   A pointer to the names referenced by the global instructions,
+     *          stored back to back as NUL terminated strings and addressed by
+     *          their offset.
+     */
+    char        *names;
+    /**
+     * @brief   The number of bytes alredy used in the names array.
+     */
+    size_t       namesSize;
+    /**
+     * @brief   The number of bytes that can be stored in the names array
+     *          before growing it.
+     */
+    size_t       namesCapacity;
+    /**
+     * @brief   The number of inline cache slots used by the instructions of
+     *          the block (one for each global access), the virtual machine
+     *          allocates them when it runs the block.
+     */
+    size_t       cachesCount;
+    /**
+     * @brief   The table of the source locations of the bytecode, looked up
+     *          only to report errors and to disassemble the block.
+     */
+    CloxLineTable_t lines;
+    /**
+     * @brief   A pointer to the symbols of the functions of the block, sorted
+     *          by offset, looked up only to name the frames of the profiles.
+     */
+    CloxCodeSymbol_t *symbols;
+    /**
+     * @brief   The number of symbols alredy stored.
+     */
+    size_t       symbolsCount;
+    /**
+     * @brief   The number of symbols that can be stored before growing the
+     *          symbols array.
+     */
+    size_t       symbolsCapacity;
+    /**
+     * @brief   A pointer to the depth of the evaluation stack before each
+     *          instruction, proven by cloxCodeBlockVerify for the top-level
+     *          code (CLOX_VERIFIER_DEPTH_UNKNOWN for the other instructions), or
+     *          NULL when the block is not verified. Like the decoded form it is
+     *          released by any change of the bytecode.
+     */
+    int32_t     *depths;
+    /**
+     * @brief   The pre-decoded form of the bytecode, built by cloxCodeBlockDecode
+     *          and released by any change of the bytecode. The records are
+     *          always allocated on the heap.
+     */
+    CloxDecodedBlock_t decoded;
+    /**
+     * @brief   A pointer to the arena from which the arrays are allocated,
+     *          or NULL when they are allocated on the heap.
+     */
+    CloxArena_t *arena;
+    /**
+     * @brief   A pointer to the memory that accounts the arrays allocated on
+     *          the heap, the current one when the block is initialized.
+     */
+    CloxMemory_t *memory;
+    /**
+     * @brief   TRUE once the block has been frozen by cloxCodeBlockFreeze: it
+     *          is shared read-only by the virtual machines that run it, so it
+     *          must not be modified until it is freed.
+     */
+    bool_t       frozen;
 } CloxCodeBlock_t;
 
 /**
@@ -71,6 +414,19 @@ typedef struct _CloxCodeBlock
  *              code block (so the value of codeBlock parameter).
  */
 CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxInitCodeBlock(CloxCodeBlock_t *const codeBlock, size_t capacity);
+/**
+ * @brief       This function initializes a CloxCodeBlock_t data structure like
+ *              cloxInitCodeBlock but allocating its arrays from an arena, so
+ *              that they are released all together with the arena.
+ * 
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to initialize.
+ * @param       capacity The initial capacity of the block.
+ * @param       arena A pointer to the arena from which allocate, when NULL the
+ *              arrays are allocated on the heap.
+ * @return      On success this function returns a pointer to the initialized
+ *              code block (so the value of codeBlock parameter).
+ */
+CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxInitCodeBlockInArena(CloxCodeBlock_t *const codeBlock, size_t capacity, CloxArena_t *const arena);
 /**
  * @brief       This function releases memory blocks used by the specific
  *              instance of the CloxCodeBlock_t function and resets its fields
@@ -92,6 +448,19 @@ CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxFreeCodeBlock(CloxCodeBlock_t *const
  *              CloxCodeBlock_t instance.
  */
 CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxCreateCodeBlock(const size_t capacity);
+/**
+ * @brief       This function allocates a new CloxCodeBlock_t instance from an
+ *              arena (itself and its arrays) and initializes it. The instance
+ *              is released with the arena, cloxDeleteCodeBlock releases only its
+ *              decoded form (see cloxCodeBlockDecode).
+ * 
+ * @param       capacity The initial capacity of the block.
+ * @param       arena A pointer to the arena from which allocate, when NULL this
+ *              function behaves like cloxCreateCodeBlock.
+ * @return      On success this function returns a pointer to the just allocated
+ *              CloxCodeBlock_t instance.
+ */
+CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxCreateCodeBlockInArena(const size_t capacity, CloxArena_t *const arena);
 
 /**
  * @brief       This function resizes the specified CloxCodeBlock_t instance.
@@ -191,10 +560,230 @@ CLOX_API byte_t CLOX_STDCALL cloxCodeBlockGet(const CloxCodeBlock_t *const codeB
  */
 CLOX_API const byte_t *CLOX_STDCALL cloxCodeBlockWrite(CloxCodeBlock_t *const codeBlock, const byte_t *const buffer, const size_t count);
 
+/**
+ * @brief       This enumeration provides the rewritings that the peephole pass
+ *              can perform, they can be combined to choose which ones apply.
+ */
+typedef enum _CloxPeephole
+{
+    /**
+     * @brief   No rewriting, the pass leaves the block untouched.
+     */
+    CLOX_PEEPHOLE_NONE          = 0x00,
+    /**
+     * @brief   Fuses 'cmp' and 'rcmp' followed by a conditional jump on the
+     *          comparison flag into 'cjXX' and 'rjXX' opcodes.
+     */
+    CLOX_PEEPHOLE_COMPARE_JUMP  = 0x01,
+    /**
+     * @brief   Fuses 'ldc' followed by 'radd' or 'rsub' using the loaded
+     *          register into 'radc' and 'rsbc' opcodes.
+     */
+    CLOX_PEEPHOLE_CONSTANT_MATH = 0x02,
+    /**
+     * @brief   Retargets jumps and branches to a 'jmp' or 'br' instruction
+     *          directly to the final target of the chain.
+     */
+    CLOX_PEEPHOLE_JUMP_CHAINS   = 0x04,
+    /**
+     * @brief   Drops the 'nop' instructions (like the ones left by the
+     *          optimizer), the jumps to them land on the next instruction.
+     */
+    CLOX_PEEPHOLE_NOPS          = 0x08,
+    /**
+     * @brief   Every rewriting.
+     */
+    CLOX_PEEPHOLE_ALL           = CLOX_PEEPHOLE_COMPARE_JUMP
+                                | CLOX_PEEPHOLE_CONSTANT_MATH
+                                | CLOX_PEEPHOLE_JUMP_CHAINS
+                                | CLOX_PEEPHOLE_NOPS,
+} CloxPeephole_t;
+
+/**
+ * @brief       This function performs the peephole pass over a finished block,
+ *              fusing common sequences of instructions into superinstructions
+ *              and patching the offsets of jumps and branches.
+ * 
+ * @note        Sequences are never fused when their second instruction is the
+ *              target of a jump (the dropped instructions between them don't
+ *              count). If the block contains unknown opcodes or jumps
+ *              not targeting an instruction, the block is left untouched.
+ * 
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to optimize.
+ * @param       peephole The rewritings to perform.
+ * @return      The number of bytes by which the block has been shrunk.
+ */
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockPeephole(CloxCodeBlock_t *const codeBlock, const CloxPeephole_t peephole);
+
+/**
+ * @brief       This function pre-decodes the specified block into fixed-width
+ *              records, see CloxDecodedInstruction_t. The records are cached on
+ *              the block: decoding it again with the same handlers does nothing
+ *              until the bytecode is modified.
+ *
+ * @note        Blocks with unknown opcodes, truncated instructions, jumps not
+ *              targeting an instruction or constants and inline cache slots out
+ *              of bounds are not decoded, since only the bytecode interpreter
+ *              reports those errors.
+ *              A frozen block is never decoded again, so it is decoded only if
+ *              its records have been decoded with the same handlers.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to decode.
+ * @param       handlers A pointer to the table of the handler addresses indexed
+ *              by opcode (CLOX_DECODED_OP_CODE_END included), or NULL.
+ * @return      TRUE if the block is decoded, otherwise FALSE.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxCodeBlockDecode(CloxCodeBlock_t *const codeBlock, const void *const *const handlers);
+/**
+ * @brief       This function releases the pre-decoded form of the specified
+ *              block. The functions that modify the bytecode call it, the code
+ *              that writes the bytecode directly must call it too.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance.
+ */
+CLOX_API void CLOX_STDCALL cloxCodeBlockInvalidate(CloxCodeBlock_t *const codeBlock);
+/**
+ * @brief       This function freezes the specified block, so that it can be
+ *              shared read-only by virtual machines running on several threads
+ *              without copying it. The functions that modify a frozen block
+ *              must not be called, but decoding it again with the handlers of
+ *              its records (which does nothing).
+ *
+ * @note        The constants referencing heap objects belong to the heap of a
+ *              single virtual machine, blocks holding them are not frozen.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to freeze.
+ * @return      TRUE if the block is frozen, FALSE if its constants reference
+ *              heap objects.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxCodeBlockFreeze(CloxCodeBlock_t *const codeBlock);
+
+/**
+ * @brief       This function appends a constant value to the constants pool of
+ *              the specified block, growing the pool if necessary.
+ * 
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to which add
+ *              the constant.
+ * @param       value The constant value to add.
+ * @return      On success this function returns the index of the new constant
+ *              into the pool, to use as 'lec' and 'lea' argument.
+ */
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockAddConstant(CloxCodeBlock_t *const codeBlock, const CloxValue_t value);
+/**
+ * @brief       This function gets the index of a constant value in the pool of
+ *              the specified block, appending the value only if it is not yet
+ *              stored. Values are equal when they have the same type and the
+ *              same datum (reals are compared bitwise, so 0 and -0 are distinct
+ *              and NaN values are never merged).
+ * 
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance.
+ * @param       value The constant value to find or add.
+ * @return      The index of the first constant equal to value.
+ */
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockInternConstant(CloxCodeBlock_t *const codeBlock, const CloxValue_t value);
+/**
+ * @brief       This function gets the offset of a name in the names array of
+ *              the specified block, appending the name only if it is not yet
+ *              stored.
+ * 
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance.
+ * @param       name A pointer to the characters of the name, they don't need to
+ *              be terminated.
+ * @param       length The number of bytes of the name.
+ * @return      The offset of the name, to use as argument of the global
+ *              instructions.
+ */
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockAddName(CloxCodeBlock_t *const codeBlock, const char *const name, const size_t length);
+/**
+ * @brief       This function gets the name stored at the specified offset of
+ *              the names array.
+ * 
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance.
+ * @param       offset The offset of the name.
+ * @return      On success this function returns a pointer to the terminated
+ *              name, but on failure a fatal error will be raised.
+ * 
+ * @exception   Index out of range
+ */
+CLOX_API const char *CLOX_STDCALL cloxCodeBlockGetName(const CloxCodeBlock_t *const codeBlock, const size_t offset);
+/**
+ * @brief       This function reserves a new inline cache slot for an
+ *              instruction of the specified block.
+ * 
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance.
+ * @return      The index of the new slot.
+ */
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockAddCache(CloxCodeBlock_t *const codeBlock);
+
+/**
+ * @brief       This function gets a pointer to the constant stored at the
+ *              specified index of the constants pool.
+ * 
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance from which
+ *              take the constant.
+ * @param       index The index of the constant into the pool.
+ * @return      On success this function returns a pointer to the constant, but
+ *              on failure a fatal error will be raised.
+ * 
+ * @exception   Index out of range
+ */
+CLOX_API const CloxValue_t *CLOX_STDCALL cloxCodeBlockGetConstant(const CloxCodeBlock_t *const codeBlock, const size_t index);
+
+/**
+ * @brief       This function records that the bytecode starting at the
+ *              specified offset (up to the offset of the next record) is
+ *              compiled from the specified source location. Offsets must be
+ *              recorded in increasing order, a record at the same offset of
+ *              the previous one replaces it.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance.
+ * @param       offset The offset of the first byte compiled from the location.
+ * @param       location A pointer to the source location, only its line and
+ *              its column are stored.
+ */
+CLOX_API void CLOX_STDCALL cloxCodeBlockAddLine(CloxCodeBlock_t *const codeBlock, const size_t offset, const CloxSourceLocation_t *const location);
+
+/**
+ * @brief       This function looks up the source location from which the byte
+ *              at the specified offset has been compiled.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance.
+ * @param       offset The offset of the byte to look up.
+ * @param       outLocation A pointer to the location to set, its character
+ *              number is always zero.
+ * @return      TRUE on success, FALSE if the block has no location for the
+ *              specified offset.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxCodeBlockGetLine(const CloxCodeBlock_t *const codeBlock, const size_t offset, CloxSourceLocation_t *const outLocation);
+
+/**
+ * @brief       This function adds the symbol of a function to a block, its
+ *              body must follow the bodies of the symbols alredy added.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance.
+ * @param       offset The offset of the first instruction of the body.
+ * @param       end The offset past the last instruction of the body.
+ * @param       name A pointer to the characters of the name, they don't need
+ *              to be terminated.
+ * @param       length The number of bytes of the name.
+ */
+CLOX_API void CLOX_STDCALL cloxCodeBlockAddSymbol(CloxCodeBlock_t *const codeBlock, const size_t offset, const size_t end, const char *const name, const size_t length);
+/**
+ * @brief       This function looks up the function whose body contains the
+ *              byte at the specified offset.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance.
+ * @param       offset The offset of the byte to look up.
+ * @return      A pointer to the symbol of the function, or NULL when the byte
+ *              is not in a function (so it is in the top-level code).
+ */
+CLOX_API const CloxCodeSymbol_t *CLOX_STDCALL cloxCodeBlockFindSymbol(const CloxCodeBlock_t *const codeBlock, const size_t offset);
+
 /**
  * @brief       This function deletes a CloxCodeBlock_t heap-allocated instance,
  *              releasing used resources and itself. Use it after cloxCreateCodeBlock
- *              function to clean memory.
+ *              function to clean memory, code blocks allocated from an arena are
+ *              left to the arena (except for their decoded form).
  * 
  * @param       codeBlock A pointer to the CloxCodeBlock_t instance to delete.
  */
@@ -1,79 +1,105 @@
-#pragma once
-
-/**
- * @file        debug.h
- *
- * @author      Federico Cristina <federico.cristina@outlook.it>
- *
- * @copyright   Copyright (c) 2024 Federico Cristina
- *
- *              This file is part of the clox programming language project,
- *              under the MIT License. See repo's LICENSE file for license
- *              informations.
- * 
- * @brief       In this header are defined tool function to get debugging
- *              informations from the virtual machine and from the bytecode.
- */
-
-#ifndef CLOX_VM_DEBUG_H_
-#define CLOX_VM_DEBUG_H_
-
-#include "clox/vm/code_block.h"
-
-#include <stdio.h>
-
-#ifndef cloxDebug
-#   if CLOX_DEBUG
-/**
- * @brief       This macro provides conditional debugging statements compilation.
- */
-#       define cloxDebug(statement) statement
-#   else
-/**
- * @brief       This macro provides conditional debugging statements compilation.
- */
-#       define cloxDebug(statement)
-#   endif
-#endif
-
-CLOX_C_HEADER_BEGIN
-
-/**
- * @defgroup    DEBUGGER_DISASSEMBLER Debugger Disassembler
- * @{
- */
-
-#pragma region Debugger Disassembler
-
-/**
- * @brief       This function disassembles a bytecode instruction stored into
- *              a specific CloxCodeBlockReader_t instance, printing disassembled
- *              data into a FILE stream.
- * 
- * @param       stream A pointer to the FILE stream handler to which print the
- *              disassembled data.
- * @param       codeBlockReader A pointer to a CloxCodeBlockReader_t instance
- *              from which read bytes.
- */
-CLOX_API void CLOX_STDCALL cloxDisassembleInstruction(FILE *const stream, CloxCodeBlockReader_t *const codeBlockReader);
-/**
- * @brief       This function disassembles the bytecode stored into a specific
- *              CloxCodeBlock_t instance, printing disassembled data into a
- *              FILE stream.
- * 
- * @param       stream A pointer to the FILE stream handler to which print the
- *              disassembled data.
- * @param       codeBlock A pointer to the CloxCodeBlock_t instance to from which
- *              disassemble bytecode.
- */
-CLOX_API void CLOX_STDCALL cloxDisassembleCodeBlock(FILE *const stream, const CloxCodeBlock_t *const codeBlock);
-
-#pragma endregion
-
-/**
- * @}
- */
-
-CLOX_C_HEADER_END
-
-#endif /* CLOX_VM_DEBUG_H_ */
+#pragma once
+
+/**
+ * @file        debug.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ * 
+ * @brief       In this header are defined tool function to get debugging
+ *              informations from the virtual machine and from the bytecode.
+ */
+
+#ifndef CLOX_VM_DEBUG_H_
+#define CLOX_VM_DEBUG_H_
+
+#include "clox/vm/code_block.h"
+#include "clox/vm/trace.h"
+
+#include <stdio.h>
+
+#ifndef cloxDebug
+#   if CLOX_DEBUG
+/**
+ * @brief       This macro provides conditional debugging statements compilation.
+ */
+#       define cloxDebug(statement) statement
+#   else
+/**
+ * @brief       This macro provides conditional debugging statements compilation.
+ */
+#       define cloxDebug(statement)
+#   endif
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    DEBUGGER_DISASSEMBLER Debugger Disassembler
+ * @{
+ */
+
+#pragma region Debugger Disassembler
+
+/**
+ * @brief       This function disassembles a bytecode instruction stored into
+ *              a specific CloxCodeBlockReader_t instance, printing disassembled
+ *              data into a FILE stream.
+ * 
+ * @param       stream A pointer to the FILE stream handler to which print the
+ *              disassembled data.
+ * @param       codeBlockReader A pointer to a CloxCodeBlockReader_t instance
+ *              from which read bytes.
+ */
+CLOX_API void CLOX_STDCALL cloxDisassembleInstruction(FILE *const stream, CloxCodeBlockReader_t *const codeBlockReader);
+/**
+ * @brief       This function disassembles the bytecode stored into a specific
+ *              CloxCodeBlock_t instance, printing disassembled data into a
+ *              FILE stream. When the block has a line table each instruction
+ *              is preceded by its source line and column ('|' when they are
+ *              the ones of the previous instruction).
+ * 
+ * @param       stream A pointer to the FILE stream handler to which print the
+ *              disassembled data.
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to from which
+ *              disassemble bytecode.
+ */
+CLOX_API void CLOX_STDCALL cloxDisassembleCodeBlock(FILE *const stream, const CloxCodeBlock_t *const codeBlock);
+/**
+ * @brief       This function prints a table of the execution counters of the
+ *              opcodes (see cloxVMGetOpCodeStats), sorted from the opcode that
+ *              took the most cycles. The percentiles are upper bounds, taken
+ *              from the histograms.
+ *
+ * @param       stream A pointer to the FILE stream handler to which print the
+ *              table.
+ * @param       stats A pointer to an array of BYTE_MAX + 1 counters, indexed by
+ *              opcode.
+ */
+CLOX_API void CLOX_STDCALL cloxDumpOpCodeStats(FILE *const stream, const CloxOpCodeStats_t *const stats);
+/**
+ * @brief       This function prints a record of an execution trace on a line:
+ *              the offset and the name of the instruction, then the type of the
+ *              value on top of the stack ('-' when it is empty) and the depth
+ *              of the stack.
+ *
+ * @param       stream A pointer to the FILE stream handler to which print the
+ *              record.
+ * @param       record A pointer to the record to print.
+ */
+CLOX_API void CLOX_STDCALL cloxDumpTraceRecord(FILE *const stream, const CloxTraceRecord_t *const record);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_DEBUG_H_ */
@@ -0,0 +1,208 @@
+#pragma once
+
+/**
+ * @file        emitter.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header are defined the bytecode emitter, the tool used
+ *              by compilers to encode instructions into code blocks and to
+ *              allocate registers of the register window.
+ */
+
+#ifndef CLOX_VM_EMITTER_H_
+#define CLOX_VM_EMITTER_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/byte.h"
+
+#include "clox/vm/code.h"
+#include "clox/vm/code_block.h"
+#include "clox/vm/value.h"
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    EMITTER Emitter
+ * @{
+ */
+
+#pragma region Emitter
+
+/**
+ * @brief       This data structure provides the state of a bytecode emitter,
+ *              the code block in which write and the registers allocation.
+ *
+ *              Registers are allocated as a stack: temporaries are taken from
+ *              the lowest free register and released in reverse order, so the
+ *              highest allocated register tells the size of the window needed
+ *              by the emitted code.
+ */
+typedef struct _CloxEmitter
+{
+    /**
+     * @brief   A pointer to the code block in which instructions are written.
+     */
+    CloxCodeBlock_t *codeBlock;
+    /**
+     * @brief   The number of allocated registers, so the next free register.
+     */
+    uint16_t         registersCount;
+    /**
+     * @brief   The maximum number of registers allocated at the same time.
+     */
+    uint16_t         registersMax;
+} CloxEmitter_t;
+
+/**
+ * @brief       This function initializes a CloxEmitter_t data structure that
+ *              writes into the specified code block.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance to initialize.
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance in which
+ *              write instructions.
+ * @return      On success this function returns a pointer to the initialized
+ *              emitter (so the value of emitter parameter).
+ */
+CLOX_API CloxEmitter_t *CLOX_STDCALL cloxInitEmitter(CloxEmitter_t *const emitter, CloxCodeBlock_t *const codeBlock);
+/**
+ * @brief       This function releases a CloxEmitter_t instance, the code block
+ *              is not freed.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance to free.
+ * @return      On success this function returns a pointer to the freed emitter
+ *              (so the value of emitter parameter).
+ */
+CLOX_API CloxEmitter_t *CLOX_STDCALL cloxFreeEmitter(CloxEmitter_t *const emitter);
+
+/**
+ * @brief       This function gets the offset at which the next instruction will
+ *              be written, to be used as a jump target.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance.
+ * @return      The offset of the next instruction.
+ */
+CLOX_API size_t CLOX_STDCALL cloxEmitterOffset(const CloxEmitter_t *const emitter);
+
+/**
+ * @brief       This function allocates the lowest free register.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance.
+ * @return      On success this function returns the allocated register, but on
+ *              failure (when the window is full) a fatal error will be raised.
+ *
+ * @exception   Stack overflow
+ */
+CLOX_API byte_t CLOX_STDCALL cloxEmitterPushRegister(CloxEmitter_t *const emitter);
+/**
+ * @brief       This function releases the specified number of registers, the
+ *              last allocated ones.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance.
+ * @param       count The number of registers to release.
+ *
+ * @exception   Stack underflow
+ */
+CLOX_API void CLOX_STDCALL cloxEmitterPopRegisters(CloxEmitter_t *const emitter, const uint16_t count);
+
+/**
+ * @brief       These functions encode an instruction of the corresponding kind
+ *              and append it to the code block.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance.
+ * @param       opCode The opcode of the instruction, it must be of the kind
+ *              of the function.
+ * @return      The offset of the emitted instruction.
+ */
+CLOX_API size_t CLOX_STDCALL cloxEmitByte(CloxEmitter_t *const emitter, const CloxOpCode_t opCode);
+CLOX_API size_t CLOX_STDCALL cloxEmitFast(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t x);
+CLOX_API size_t CLOX_STDCALL cloxEmitCtrl(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const uint16_t x, const byte_t f);
+CLOX_API size_t CLOX_STDCALL cloxEmitData(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t z, const uint16_t x);
+CLOX_API size_t CLOX_STDCALL cloxEmitRegs(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t z, const byte_t x, const byte_t y);
+CLOX_API size_t CLOX_STDCALL cloxEmitLong(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t z, const uint16_t x, const uint16_t y);
+CLOX_API size_t CLOX_STDCALL cloxEmitJump(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const uint32_t z);
+CLOX_API size_t CLOX_STDCALL cloxEmitFull(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const uint16_t z, const uint16_t x, const uint16_t y, const byte_t f);
+
+/**
+ * @brief       This function emits a jump (or a branch) instruction to the
+ *              specified offset, computing the relative offset for jumps.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance.
+ * @param       opCode The opcode of the jump or branch instruction.
+ * @param       target The offset of the target instruction.
+ * @return      The offset of the emitted instruction.
+ */
+CLOX_API size_t CLOX_STDCALL cloxEmitJumpTo(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const size_t target);
+/**
+ * @brief       This function emits a call (or a tail call) instruction to the
+ *              specified offset, like a jump, storing the number of arguments
+ *              moved by tail calls into its last byte.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance.
+ * @param       opCode The opcode of the call instruction.
+ * @param       target The offset of the first instruction of the subroutine.
+ * @param       count The number of arguments, the last registers of the window.
+ * @return      The offset of the emitted instruction.
+ */
+CLOX_API size_t CLOX_STDCALL cloxEmitCall(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const size_t target, const byte_t count);
+/**
+ * @brief       This function patches a jump (or a branch) instruction already
+ *              emitted, so that it targets the specified offset. It is used
+ *              for forward jumps, emitted with an unknown target.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance.
+ * @param       offset The offset of the jump instruction to patch.
+ * @param       target The offset of the target instruction.
+ */
+CLOX_API void CLOX_STDCALL cloxEmitterPatchJump(CloxEmitter_t *const emitter, const size_t offset, const size_t target);
+
+/**
+ * @brief       This function emits the instruction that loads a constant into
+ *              a register: 'ldc' for small signed integers, otherwise 'lec'
+ *              (or 'lecw' past the 16-bit index of 'lec') with the index of
+ *              the value in the constants pool, where equal values are stored
+ *              only once.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance.
+ * @param       z The destination register.
+ * @param       value The constant value.
+ * @return      The offset of the emitted instruction.
+ *
+ * @exception   Index out of bounds, if the constants pool is full.
+ */
+CLOX_API size_t CLOX_STDCALL cloxEmitConstant(CloxEmitter_t *const emitter, const byte_t z, const CloxValue_t value);
+/**
+ * @brief       This function emits a global instruction ('ldg' or 'stg') on the
+ *              specified register, reserving a new inline cache slot for it.
+ *              The instructions that name a property ('getp', 'setp' and
+ *              'invk') and 'ncall' are emitted the same way.
+ *
+ * @param       emitter A pointer to the CloxEmitter_t instance.
+ * @param       opCode The opcode of the instruction.
+ * @param       z The register to load or to store (or the number of arguments
+ *              of a call).
+ * @param       name The offset of the name of the variable (or of the
+ *              property), as returned by cloxCodeBlockAddName.
+ * @return      The offset of the emitted instruction.
+ *
+ * @exception   Index out of bounds, if the name or the cache slot can't be
+ *              addressed with 16 bits.
+ */
+CLOX_API size_t CLOX_STDCALL cloxEmitGlobal(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t z, const size_t name);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_EMITTER_H_ */
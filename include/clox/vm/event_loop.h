@@ -0,0 +1,157 @@
+#pragma once
+
+/**
+ * @file        event_loop.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the event loop, which schedules the
+ *              fibers of a virtual machine. A native that would block on I/O
+ *              suspends the fiber that called it until its handle is ready,
+ *              while the other fibers keep running.
+ */
+
+#ifndef CLOX_VM_EVENT_LOOP_H_
+#define CLOX_VM_EVENT_LOOP_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/poll.h"
+
+#include "clox/vm/fiber.h"
+#include "clox/vm/vm.h"
+
+#ifndef CLOX_EVENT_LOOP_EVENTS_COUNT
+/**
+ * @brief       This constant represents the maximum number of events got from
+ *              the poller at once.
+ */
+#   define CLOX_EVENT_LOOP_EVENTS_COUNT 64
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    EVENT_LOOP Event Loop
+ * @{
+ */
+
+#pragma region Event Loop
+
+/**
+ * @brief       This data structure provides an event loop.
+ */
+typedef struct _CloxEventLoop
+{
+    /**
+     * @brief   A pointer to the virtual machine that executes the fibers.
+     */
+    CloxVM_t     *vm;
+    /**
+     * @brief   The poller that waits for the handles of the fibers.
+     */
+    CloxPoller_t  poller;
+    /**
+     * @brief   The first and the last fiber ready to run.
+     */
+    CloxFiber_t  *head;
+    CloxFiber_t  *tail;
+    /**
+     * @brief   The number of fibers ready to run.
+     */
+    size_t        readyCount;
+    /**
+     * @brief   The number of fibers that wait for a handle.
+     */
+    size_t        waitingCount;
+    /**
+     * @brief   The number of fibers to run before checking the handles without
+     *          waiting, so that one round of the ready fibers is run between
+     *          two checks.
+     */
+    size_t        budget;
+    /**
+     * @brief   The fiber returned by the last run, which is scheduled again (or
+     *          freed) by the next one.
+     */
+    CloxFiber_t  *stopped;
+} CloxEventLoop_t;
+
+/**
+ * @brief       This function initializes an event loop.
+ *
+ * @param       loop A pointer to the CloxEventLoop_t instance to initialize.
+ * @param       vm A pointer to the virtual machine that executes the fibers.
+ * @return      On success this function returns a pointer to the initialized
+ *              event loop (so the value of loop parameter), NULL if its poller
+ *              cannot be created.
+ */
+CLOX_API CloxEventLoop_t *CLOX_STDCALL cloxInitEventLoop(CloxEventLoop_t *const loop, CloxVM_t *const vm);
+/**
+ * @brief       This function releases resources used by an event loop, with
+ *              the fibers it has spawned.
+ *
+ * @param       loop A pointer to the CloxEventLoop_t instance to free.
+ * @return      On success this function returns a pointer to the freed event
+ *              loop (so the value of loop parameter).
+ */
+CLOX_API CloxEventLoop_t *CLOX_STDCALL cloxFreeEventLoop(CloxEventLoop_t *const loop);
+
+/**
+ * @brief       This function creates a fiber that executes the specified block
+ *              and schedules it to run.
+ *
+ * @param       loop A pointer to the event loop.
+ * @param       codeBlock A pointer to the block to execute, which must outlive
+ *              the fiber.
+ * @return      A pointer to the fiber, owned by the event loop.
+ */
+CLOX_API CloxFiber_t *CLOX_STDCALL cloxEventLoopSpawn(CloxEventLoop_t *const loop, const CloxCodeBlock_t *const codeBlock);
+
+/**
+ * @brief       This function suspends the fiber running on a virtual machine
+ *              until a handle is ready, it is meant to be returned by a native
+ *              function. When the fiber is resumed, the value returned by the
+ *              native is replaced by the events the handle is ready for.
+ *
+ * @param       vm A pointer to the virtual machine.
+ * @param       handle The handle to wait for.
+ * @param       events The events to wait for (a combination of CLOX_POLL_READ
+ *              and CLOX_POLL_WRITE).
+ * @return      The value to return from the native: the message that suspends
+ *              the fiber, or an error message if the fiber doesn't belong to an
+ *              event loop or the handle can't be waited for.
+ */
+CLOX_API const char *CLOX_STDCALL cloxEventLoopWait(CloxVM_t *const vm, const CloxPollHandle_t handle, const uint32_t events);
+
+/**
+ * @brief       This function runs the fibers, switching to another one each
+ *              time one yields or waits for a handle, and waiting for the
+ *              handles when all the fibers do, until a fiber stops or none is
+ *              left.
+ *
+ * @note        A fiber stopped by a 'break' or a 'raise' is scheduled again by
+ *              the next run, a fiber that has terminated is freed by it.
+ *
+ * @param       loop A pointer to the event loop.
+ * @return      A pointer to the fiber that has stopped for any reason but a
+ *              yield, NULL when no fiber is left.
+ */
+CLOX_API CloxFiber_t *CLOX_STDCALL cloxEventLoopRun(CloxEventLoop_t *const loop);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_EVENT_LOOP_H_ */
@@ -0,0 +1,164 @@
+#pragma once
+
+/**
+ * @file        fiber.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header are defined the fibers, lightweight coroutines
+ *              executed by a virtual machine. A fiber stores an execution
+ *              context (the evaluation stack, the register file, the call
+ *              frames, the instruction pointer, the flags and the inline cache
+ *              slots), which is swapped with the one of the virtual machine
+ *              while the fiber runs: the globals, the natives and the heap are
+ *              shared by all the fibers of a virtual machine.
+ */
+
+#ifndef CLOX_VM_FIBER_H_
+#define CLOX_VM_FIBER_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/poll.h"
+
+#include "clox/vm/vm.h"
+
+#ifndef CLOX_FIBER_STACK_SIZE
+/**
+ * @brief       This constant represents the number of values of the evaluation
+ *              stack of a new fiber, which grows when it's full.
+ */
+#   define CLOX_FIBER_STACK_SIZE 32
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    FIBER Fiber
+ * @{
+ */
+
+#pragma region Fiber
+
+struct _CloxEventLoop;
+
+/**
+ * @brief       This data structure provides a fiber. The fields of its context
+ *              have the meaning of the ones of CloxVM_t with the same names.
+ */
+typedef struct _CloxFiber
+{
+    CloxValue_t            *registers;
+    size_t                  registersSize;
+    CloxValue_t            *window;
+    size_t                  windowSize;
+    CloxVMWindow_t         *windows;
+    size_t                  windowsCount;
+    size_t                  windowsCapacity;
+    CloxVMFrame_t          *frames;
+    size_t                  framesCount;
+    size_t                  framesCapacity;
+    CloxValue_t            *stack;
+    CloxValue_t            *stackTop;
+    size_t                  stackSize;
+    size_t                  stackLimit;
+    const CloxCodeBlock_t  *codeBlock;
+    /**
+     * @brief   A pointer to the next instruction to execute, NULL until the
+     *          fiber starts.
+     */
+    const byte_t           *ip;
+    byte_t                  cf;
+    byte_t                  zf;
+    /**
+     * @brief   The status in which the last execution has left the fiber.
+     */
+    CloxVMStatus_t          status;
+    int                     exitCode;
+    int                     signal;
+    const char             *error;
+    CloxVMCache_t          *caches;
+    size_t                  cachesCapacity;
+    /**
+     * @brief   A pointer to the virtual machine that executes the fiber.
+     */
+    CloxVM_t               *vm;
+    /**
+     * @brief   The previous and the next fiber of the virtual machine.
+     */
+    struct _CloxFiber      *prev;
+    struct _CloxFiber      *next;
+    /**
+     * @brief   A pointer to the event loop that schedules the fiber, or NULL
+     *          if the host runs it directly.
+     */
+    struct _CloxEventLoop  *loop;
+    /**
+     * @brief   The next fiber of the queue of the event loop.
+     */
+    struct _CloxFiber      *link;
+    /**
+     * @brief   The handle the fiber waits for and its events, which are zero
+     *          when it doesn't wait for I/O.
+     */
+    CloxPollHandle_t        handle;
+    uint32_t                events;
+} CloxFiber_t;
+
+/**
+ * @brief       This function initializes a fiber that executes the specified
+ *              block from its first instruction, with a small evaluation stack
+ *              (of CLOX_FIBER_STACK_SIZE values) and the outermost register
+ *              window only, both growing when needed.
+ *
+ * @param       fiber A pointer to the CloxFiber_t instance to initialize.
+ * @param       vm A pointer to the virtual machine that executes the fiber.
+ * @param       codeBlock A pointer to the block to execute, which must outlive
+ *              the fiber.
+ * @param       stackLimit The maximum number of values of the evaluation stack,
+ *              when zero CLOX_VM_STACK_SIZE is used.
+ * @return      On success this function returns a pointer to the initialized
+ *              fiber (so the value of fiber parameter).
+ */
+CLOX_API CloxFiber_t *CLOX_STDCALL cloxInitFiber(CloxFiber_t *const fiber, CloxVM_t *const vm, const CloxCodeBlock_t *const codeBlock, size_t stackLimit);
+/**
+ * @brief       This function releases resources used by a fiber, which must
+ *              not be running.
+ *
+ * @param       fiber A pointer to the CloxFiber_t instance to free.
+ * @return      On success this function returns a pointer to the freed fiber
+ *              (so the value of fiber parameter).
+ */
+CLOX_API CloxFiber_t *CLOX_STDCALL cloxFreeFiber(CloxFiber_t *const fiber);
+
+/**
+ * @brief       This function runs a fiber until it stops: it starts executing
+ *              its block, or it resumes it if it has been suspended, then it
+ *              saves back its context. While the fiber runs, its natives find
+ *              it in the fiber field of the virtual machine.
+ *
+ * @note        The context is saved into the fiber, so the values left by the
+ *              execution are between its stack and stackTop fields.
+ *
+ * @param       fiber A pointer to the CloxFiber_t instance to run.
+ * @return      The status in which the execution has left the fiber, the
+ *              current status if it can't be resumed.
+ */
+CLOX_API CloxVMStatus_t CLOX_STDCALL cloxFiberResume(CloxFiber_t *const fiber);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_FIBER_H_ */
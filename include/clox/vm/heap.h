@@ -0,0 +1,463 @@
+#pragma once
+
+/**
+ * @file        heap.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the managed heap of the virtual
+ *              machine, whose objects are owned by an incremental tri-color
+ *              mark and sweep garbage collector.
+ *
+ *              A collection is split into steps, each one bounded by a pause
+ *              budget: steps are taken while allocating and at the safepoints
+ *              of the interpreter (backward jumps), so the mutator never waits
+ *              for a whole collection. Objects stored into black objects must
+ *              pass through the write barrier (cloxHeapSet or cloxHeapBarrier),
+ *              roots are scanned again before sweeping so they need none.
+ *
+ *              Small objects are allocated from size classes: each class has
+ *              a free list of released blocks, new blocks are carved from an
+ *              arena. Every object is accounted to the memory of the heap:
+ *              when its limit is reached the heap runs a whole collection and
+ *              tries again, then the allocation fails returning NULL.
+ */
+
+#ifndef CLOX_VM_HEAP_H_
+#define CLOX_VM_HEAP_H_
+
+#include "clox/base/api.h"
+#include "clox/base/arena.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/byte.h"
+#include "clox/base/memory.h"
+
+#include "clox/vm/value.h"
+
+#ifndef CLOX_HEAP_GRANULE
+/**
+ * @brief       This constant represents the difference in bytes between two
+ *              consecutive size classes, so the alignment of objects.
+ */
+#   define CLOX_HEAP_GRANULE CLOX_ARENA_ALIGNMENT
+#endif
+
+#ifndef CLOX_HEAP_SIZE_CLASSES
+/**
+ * @brief       This constant represents the number of size classes, bigger
+ *              objects are allocated one by one on the heap.
+ */
+#   define CLOX_HEAP_SIZE_CLASSES 32
+#endif
+
+#ifndef CLOX_HEAP_THRESHOLD
+/**
+ * @brief       This constant represents the minimum number of bytes that the
+ *              heap must reach before a collection starts.
+ */
+#   define CLOX_HEAP_THRESHOLD (1024 * 1024)
+#endif
+
+#ifndef CLOX_HEAP_STEP_SIZE
+/**
+ * @brief       This constant represents the number of bytes allocated during
+ *              a collection after which the allocator takes a step.
+ */
+#   define CLOX_HEAP_STEP_SIZE (64 * 1024)
+#endif
+
+#ifndef CLOX_HEAP_STEP_UNITS
+/**
+ * @brief       This constant represents the number of objects marked or swept
+ *              between two reads of the clock, while taking a step.
+ */
+#   define CLOX_HEAP_STEP_UNITS 64
+#endif
+
+#ifndef CLOX_HEAP_GRAY_CAPACITY
+/**
+ * @brief       This constant represents the initial capacity of the gray
+ *              stack.
+ */
+#   define CLOX_HEAP_GRAY_CAPACITY 64
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    HEAP Managed Heap
+ * @{
+ */
+
+#pragma region Managed Heap
+
+/**
+ * @brief       This enumeration provides the kinds of the objects of the
+ *              managed heap.
+ */
+typedef enum _CloxObjectKind
+{
+    /**
+     * @brief   An array of values, traced by the collector.
+     */
+    CLOX_OBJECT_KIND_ARRAY = 0x01,
+    /**
+     * @brief   An array of bytes, never traced.
+     */
+    CLOX_OBJECT_KIND_BYTES = 0x02,
+    /**
+     * @brief   An instance, whose values are laid out by its shape (see
+     *          shape.h), traced as an array.
+     */
+    CLOX_OBJECT_KIND_INSTANCE = 0x03,
+} CloxObjectKind_t;
+
+/**
+ * @brief       This enumeration provides the colors of the objects, there are
+ *              two whites which swap their meaning at each collection so that
+ *              the survivors don't need to be repainted before the next one.
+ */
+typedef enum _CloxObjectColor
+{
+    CLOX_OBJECT_COLOR_WHITE0 = 0x01,
+    CLOX_OBJECT_COLOR_WHITE1 = 0x02,
+    CLOX_OBJECT_COLOR_GRAY   = 0x04,
+    CLOX_OBJECT_COLOR_BLACK  = 0x08,
+} CloxObjectColor_t;
+
+/**
+ * @brief       This data structure provides the header of an object of the
+ *              managed heap, the payload follows it.
+ */
+typedef struct _CloxObject
+{
+    /**
+     * @brief   A pointer to the next object of the heap, or to the next free
+     *          block of the same size class once the object is released.
+     */
+    struct _CloxObject *next;
+    /**
+     * @brief   The number of values (or bytes) of the payload.
+     */
+    uint32_t            count;
+    /**
+     * @brief   The kind of the object (CloxObjectKind_t).
+     */
+    byte_t              kind;
+    /**
+     * @brief   The color of the object (CloxObjectColor_t).
+     */
+    byte_t              color;
+    /**
+     * @brief   The index of the size class of the block plus one, or zero for
+     *          the objects allocated one by one.
+     */
+    byte_t              sizeClass;
+    /**
+     * @brief   Reserved for the kinds of objects, zero.
+     */
+    byte_t              flags;
+} CloxObject_t;
+
+#ifndef CLOX_OBJECT_HEADER_SIZE
+/**
+ * @brief       This constant represents the number of bytes between the
+ *              beginning of an object and its payload.
+ */
+#   define CLOX_OBJECT_HEADER_SIZE alignto(sizeof(CloxObject_t), (size_t)CLOX_HEAP_GRANULE)
+#endif
+
+/**
+ * @brief       This enumeration provides the phases of a collection.
+ */
+typedef enum _CloxHeapPhase
+{
+    /**
+     * @brief   No collection is running.
+     */
+    CLOX_HEAP_PHASE_IDLE  = 0x00,
+    /**
+     * @brief   The reachable objects are being marked.
+     */
+    CLOX_HEAP_PHASE_MARK  = 0x01,
+    /**
+     * @brief   The unreachable objects are being released.
+     */
+    CLOX_HEAP_PHASE_SWEEP = 0x02,
+} CloxHeapPhase_t;
+
+struct _CloxHeap;
+
+/**
+ * @brief       This datatype provides the function that marks the roots of a
+ *              heap (with cloxHeapMarkValue or cloxHeapMarkObject), it is called
+ *              when a collection starts and again before sweeping.
+ */
+typedef void (CLOX_STDCALL *CloxHeapRootsFunc_t)(struct _CloxHeap *const heap, void *const data);
+
+/**
+ * @brief       This data structure provides a managed heap.
+ */
+typedef struct _CloxHeap
+{
+    /**
+     * @brief   The arena from which the blocks of the size classes are carved.
+     */
+    CloxArena_t         arena;
+    /**
+     * @brief   A pointer to the memory that accounts the objects, the current
+     *          one when the heap is initialized.
+     */
+    CloxMemory_t       *memory;
+    /**
+     * @brief   The released blocks of each size class.
+     */
+    CloxObject_t       *freeLists[CLOX_HEAP_SIZE_CLASSES];
+    /**
+     * @brief   A pointer to the newest object of the heap.
+     */
+    CloxObject_t       *objects;
+    /**
+     * @brief   The number of objects of the heap.
+     */
+    size_t              objectsCount;
+    /**
+     * @brief   A pointer to the link of the next object to sweep.
+     */
+    CloxObject_t      **sweep;
+    /**
+     * @brief   A pointer to the first object of the gray stack, the objects
+     *          marked but not traced yet.
+     */
+    CloxObject_t      **gray;
+    /**
+     * @brief   The number of objects of the gray stack.
+     */
+    size_t              grayCount;
+    /**
+     * @brief   The number of objects that the gray stack can store.
+     */
+    size_t              grayCapacity;
+    /**
+     * @brief   The phase of the running collection.
+     */
+    CloxHeapPhase_t     phase;
+    /**
+     * @brief   The current white, the one of the new objects.
+     */
+    byte_t              white;
+    /**
+     * @brief   The number of bytes of the objects of the heap.
+     */
+    size_t              allocated;
+    /**
+     * @brief   The number of bytes at which the next collection starts.
+     */
+    size_t              threshold;
+    /**
+     * @brief   The number of bytes allocated since the last step.
+     */
+    size_t              debt;
+    /**
+     * @brief   The growth factor (a percentage) used to compute the threshold
+     *          at the end of a collection, it can be changed at any time.
+     */
+    unsigned int        growthFactor;
+    /**
+     * @brief   The maximum pause (in microseconds) of a step, it can be changed
+     *          at any time.
+     */
+    unsigned int        maxPause;
+    /**
+     * @brief   The function that marks the roots, or NULL.
+     */
+    CloxHeapRootsFunc_t roots;
+    /**
+     * @brief   The data passed to the roots function.
+     */
+    void               *rootsData;
+    /**
+     * @brief   The number of completed collections.
+     */
+    size_t              cyclesCount;
+    /**
+     * @brief   The number of steps taken.
+     */
+    size_t              stepsCount;
+    /**
+     * @brief   The longest step taken (in nanoseconds).
+     */
+    uint64_t            longestStep;
+} CloxHeap_t;
+
+/**
+ * @brief       This function gets the payload of an array object.
+ *
+ * @param       object A pointer to the object.
+ * @return      A pointer to the first value of the array.
+ */
+CLOX_API_INLINE CloxValue_t *CLOX_STDCALL cloxObjectValues(CloxObject_t *const object)
+{
+    return (CloxValue_t *)((byte_t *)object + CLOX_OBJECT_HEADER_SIZE);
+}
+
+/**
+ * @brief       This function gets the payload of a bytes object.
+ *
+ * @param       object A pointer to the object.
+ * @return      A pointer to the first byte of the payload.
+ */
+CLOX_API_INLINE byte_t *CLOX_STDCALL cloxObjectBytes(CloxObject_t *const object)
+{
+    return (byte_t *)object + CLOX_OBJECT_HEADER_SIZE;
+}
+
+/**
+ * @brief       This function gets the object stored into a value.
+ *
+ * @param       value The value, it must be of CLOX_VALUE_TYPE_OBJT type.
+ * @return      A pointer to the object.
+ */
+CLOX_API_INLINE CloxObject_t *CLOX_STDCALL cloxValueAsObject(const CloxValue_t value)
+{
+    return (CloxObject_t *)cloxValueAsObjt(value);
+}
+
+/**
+ * @brief       This function initializes a CloxHeap_t data structure, with the
+ *              growth factor and the maximum pause of the configuration.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance to initialize.
+ * @param       roots The function that marks the roots, or NULL.
+ * @param       rootsData The data passed to the roots function.
+ * @return      On success this function returns a pointer to the initialized
+ *              heap (so the value of heap parameter).
+ */
+CLOX_API CloxHeap_t *CLOX_STDCALL cloxInitHeap(CloxHeap_t *const heap, const CloxHeapRootsFunc_t roots, void *const rootsData);
+/**
+ * @brief       This function releases all the objects of a CloxHeap_t instance
+ *              without deleting it.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance to free.
+ * @return      On success this function returns a pointer to the freed heap
+ *              (so the value of heap parameter).
+ */
+CLOX_API CloxHeap_t *CLOX_STDCALL cloxFreeHeap(CloxHeap_t *const heap);
+
+/**
+ * @brief       This function allocates and initializes a new CloxHeap_t data
+ *              structure.
+ *
+ * @param       roots The function that marks the roots, or NULL.
+ * @param       rootsData The data passed to the roots function.
+ * @return      On success this function returns a pointer to the new heap.
+ */
+CLOX_API CloxHeap_t *CLOX_STDCALL cloxCreateHeap(const CloxHeapRootsFunc_t roots, void *const rootsData);
+
+/**
+ * @brief       This function allocates an array object, its values are void.
+ *
+ * @note        The allocation can take a step of the collector, so objects not
+ *              reachable from the roots can be released.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       count The number of values of the array.
+ * @return      On success this function returns a pointer to the new object,
+ *              or NULL if the memory limit of the heap is reached.
+ */
+CLOX_API CloxObject_t *CLOX_STDCALL cloxHeapNewArray(CloxHeap_t *const heap, const size_t count);
+/**
+ * @brief       This function allocates a bytes object, its bytes are zero.
+ *
+ * @note        The allocation can take a step of the collector, so objects not
+ *              reachable from the roots can be released.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       size The number of bytes of the payload.
+ * @return      On success this function returns a pointer to the new object,
+ *              or NULL if the memory limit of the heap is reached.
+ */
+CLOX_API CloxObject_t *CLOX_STDCALL cloxHeapNewBytes(CloxHeap_t *const heap, const size_t size);
+
+/**
+ * @brief       This function stores a value into an array (or instance) object,
+ *              through the write barrier.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       object A pointer to the array object.
+ * @param       index The index of the value to store.
+ * @param       value The value to store.
+ *
+ * @exception   Index out of bounds
+ */
+CLOX_API void CLOX_STDCALL cloxHeapSet(CloxHeap_t *const heap, CloxObject_t *const object, const size_t index, const CloxValue_t value);
+/**
+ * @brief       This function is the write barrier, to call after a reference
+ *              has been stored into an object by other means than cloxHeapSet:
+ *              a black object goes back to the gray stack, to be traced again.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       object A pointer to the written object.
+ */
+CLOX_API void CLOX_STDCALL cloxHeapBarrier(CloxHeap_t *const heap, CloxObject_t *const object);
+
+/**
+ * @brief       This function marks an object as reachable, to be called by the
+ *              roots function.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       object A pointer to the object, it can be NULL.
+ */
+CLOX_API void CLOX_STDCALL cloxHeapMarkObject(CloxHeap_t *const heap, CloxObject_t *const object);
+/**
+ * @brief       This function marks the object stored into a value as reachable,
+ *              values of the other types are ignored.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       value A pointer to the value.
+ */
+CLOX_API void CLOX_STDCALL cloxHeapMarkValue(CloxHeap_t *const heap, const CloxValue_t *const value);
+
+/**
+ * @brief       This function takes a step of the collector, working until the
+ *              maximum pause is reached. When no collection is running a new
+ *              one is started if the heap has reached its threshold.
+ *
+ * @note        The end of the marking (roots scanned again and gray stack
+ *              drained) is done in a single step.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @return      TRUE if the step has completed a collection.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxHeapStep(CloxHeap_t *const heap);
+/**
+ * @brief       This function completes the running collection, if any, then
+ *              runs a whole collection without pause bounds.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ */
+CLOX_API void CLOX_STDCALL cloxHeapCollect(CloxHeap_t *const heap);
+
+/**
+ * @brief       This function frees and deletes a CloxHeap_t instance.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance to delete.
+ */
+CLOX_API void CLOX_STDCALL cloxDeleteHeap(CloxHeap_t *const heap);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_HEAP_H_ */
@@ -0,0 +1,272 @@
+#pragma once
+
+/**
+ * @file        image.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the bytecode image format, a file
+ *              that stores a compiled code block so that it can be loaded by
+ *              mapping the file into the memory, without any copy.
+ *
+ *              The layout of an image is relocatable: the header is followed
+ *              by the sections (code, constants, names, lines and the lines
+ *              index), each one aligned to CLOX_IMAGE_ALIGNMENT and addressed by its offset from the
+ *              beginning of the file.
+ */
+
+#ifndef CLOX_VM_IMAGE_H_
+#define CLOX_VM_IMAGE_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/byte.h"
+
+#include "clox/vm/code_block.h"
+#include "clox/vm/value.h"
+
+#ifndef CLOX_IMAGE_VERSION
+/**
+ * @brief       This constant represents the version of the image format, an
+ *              image of a different version is never loaded.
+ */
+#   define CLOX_IMAGE_VERSION 4
+#endif
+
+#ifndef CLOX_IMAGE_EXTENSION
+/**
+ * @brief       This constant represents the extension appended to the path of
+ *              a script to get the path of its image.
+ */
+#   define CLOX_IMAGE_EXTENSION "c"
+#endif
+
+#ifndef CLOX_IMAGE_ALIGNMENT
+/**
+ * @brief       This constant represents the alignment of the sections of an
+ *              image, enough for any CloxValue_t of the constants pool.
+ */
+#   define CLOX_IMAGE_ALIGNMENT 16
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    IMAGE Image
+ * @{
+ */
+
+#pragma region Image
+
+/**
+ * @brief       This data structure provides the identity of the source of an
+ *              image, an image is stale when its source changes.
+ */
+typedef struct _CloxImageStamp
+{
+    /**
+     * @brief   The size in bytes of the source file.
+     */
+    uint64_t size;
+    /**
+     * @brief   The last modification time of the source file, in nanoseconds
+     *          when the platform provides them.
+     */
+    int64_t  time;
+} CloxImageStamp_t;
+
+/**
+ * @brief       This data structure provides the header of an image, stored at
+ *              the beginning of the file.
+ *
+ * @note        Values are stored with the byte order of the writer, an image
+ *              written by a host with a different byte order has a different
+ *              magic number and it is refused.
+ */
+typedef struct _CloxImageHeader
+{
+    /**
+     * @brief   The magic number (CLOX_MAGIC_NUMBER).
+     */
+    uint32_t         magic;
+    /**
+     * @brief   The version of the format (CLOX_IMAGE_VERSION).
+     */
+    uint16_t         version;
+    /**
+     * @brief   The size of a CloxValue_t of the writer, which depends on the
+     *          configuration of the virtual machine.
+     */
+    uint16_t         valueSize;
+    /**
+     * @brief   The number of bytes of the whole image.
+     */
+    uint64_t         size;
+    /**
+     * @brief   The identity of the compiled source.
+     */
+    CloxImageStamp_t stamp;
+    /**
+     * @brief   The offset of the bytecode section.
+     */
+    uint64_t         codeOffset;
+    /**
+     * @brief   The number of bytes of the bytecode section.
+     */
+    uint64_t         codeCount;
+    /**
+     * @brief   The offset of the constants section.
+     */
+    uint64_t         constantsOffset;
+    /**
+     * @brief   The number of values of the constants section.
+     */
+    uint64_t         constantsCount;
+    /**
+     * @brief   The offset of the names section.
+     */
+    uint64_t         namesOffset;
+    /**
+     * @brief   The number of bytes of the names section.
+     */
+    uint64_t         namesCount;
+    /**
+     * @brief   The number of inline cache slots used by the bytecode.
+     */
+    uint64_t         cachesCount;
+    /**
+     * @brief   The offset of the lines section.
+     */
+    uint64_t         linesOffset;
+    /**
+     * @brief   The number of bytes of the lines section, the encoded runs of
+     *          the line table.
+     */
+    uint64_t         linesCount;
+    /**
+     * @brief   The offset of the lines index section.
+     */
+    uint64_t         linesIndexOffset;
+    /**
+     * @brief   The number of checkpoints of the lines index section.
+     */
+    uint64_t         linesIndexCount;
+    /**
+     * @brief   The offset of the symbols section.
+     */
+    uint64_t         symbolsOffset;
+    /**
+     * @brief   The number of symbols of the symbols section.
+     */
+    uint64_t         symbolsCount;
+} CloxImageHeader_t;
+
+/**
+ * @brief       This data structure provides a loaded image.
+ */
+typedef struct _CloxImage
+{
+    /**
+     * @brief   A pointer to the mapped bytes of the image.
+     */
+    const byte_t            *data;
+    /**
+     * @brief   The number of mapped bytes.
+     */
+    size_t                   size;
+    /**
+     * @brief   The handle of the file mapping (used only on Windows).
+     */
+    void                    *mapping;
+    /**
+     * @brief   A pointer to the header of the image.
+     */
+    const CloxImageHeader_t *header;
+    /**
+     * @brief   A view of the code block stored into the image, it points to
+     *          the mapped bytes and must never be resized or freed.
+     */
+    CloxCodeBlock_t          codeBlock;
+} CloxImage_t;
+
+/**
+ * @brief       This function gets the identity of a source file.
+ *
+ * @param       path The path of the source file.
+ * @param       outStamp A pointer to the stamp to fill.
+ * @return      TRUE on success, FALSE if the file cannot be inspected.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxGetImageStamp(const char *const path, CloxImageStamp_t *const outStamp);
+
+/**
+ * @brief       This function writes a code block into an image file. The
+ *              image is written aside and then renamed, so that readers never
+ *              see a partial image.
+ *
+ * @param       path The path of the image file.
+ * @param       codeBlock A pointer to the code block to write.
+ * @param       stamp A pointer to the identity of the source, it can be NULL.
+ * @return      TRUE on success, FALSE on I/O errors or when the constants pool
+ *              holds pointers (which are not relocatable).
+ */
+CLOX_API bool_t CLOX_STDCALL cloxWriteImage(const char *const path, const CloxCodeBlock_t *const codeBlock, const CloxImageStamp_t *const stamp);
+
+/**
+ * @brief       This function maps an image file and validates its header.
+ *
+ * @param       path The path of the image file.
+ * @return      On success a pointer to the loaded image, otherwise (if the
+ *              file doesn't exist or it isn't a valid image for this virtual
+ *              machine) NULL.
+ */
+CLOX_API CloxImage_t *CLOX_STDCALL cloxCreateImageFromFile(const char *const path);
+
+/**
+ * @brief       This function checks that an image has been compiled from the
+ *              source with the specified identity.
+ *
+ * @param       image A pointer to the image.
+ * @param       stamp A pointer to the identity of the source.
+ * @return      TRUE if the image is up to date, otherwise FALSE.
+ */
+CLOX_API_INLINE bool_t CLOX_STDCALL cloxImageIsFresh(const CloxImage_t *const image, const CloxImageStamp_t *const stamp)
+{
+    return (bool_t)((image->header->stamp.size == stamp->size) && (image->header->stamp.time == stamp->time));
+}
+
+/**
+ * @brief       This function initializes a reader over the bytecode of an
+ *              image, the reader reads the mapped bytes directly (so it must
+ *              be freed without releasing its array).
+ *
+ * @param       image A pointer to the image.
+ * @param       codeBlockReader A pointer to the reader to initialize.
+ * @return      On success this function returns a pointer to the initialized
+ *              reader (so the value of codeBlockReader parameter).
+ */
+CLOX_API CloxCodeBlockReader_t *CLOX_STDCALL cloxInitImageReader(const CloxImage_t *const image, CloxCodeBlockReader_t *const codeBlockReader);
+
+/**
+ * @brief       This function unmaps an image and deletes it, the code block
+ *              view of the image can't be used after.
+ *
+ * @param       image A pointer to the image to delete.
+ */
+CLOX_API void CLOX_STDCALL cloxDeleteImage(CloxImage_t *const image);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_IMAGE_H_ */
@@ -0,0 +1,348 @@
+#pragma once
+
+/**
+ * @file        jit.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header are defined the data structures and functions of
+ *              the copy-and-patch assembler used by the JIT tier: a region is
+ *              described as a sequence of stencils, each one a precompiled
+ *              function called with its operands patched into the native code,
+ *              and stitched into executable memory. The stencils moving values
+ *              between the registers and the evaluation stack are emitted
+ *              inline instead, on the targets that support it, and so are the
+ *              fast paths of the integer and real operations, compares and
+ *              branches, which call their function only when a guard fails.
+ */
+
+#ifndef CLOX_VM_JIT_H_
+#define CLOX_VM_JIT_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/byte.h"
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @brief       This enumeration provides the results of a stencil function.
+ */
+typedef enum _CloxJitStatus
+{
+    /**
+     * @brief   The instruction has been executed, the next stencil follows.
+     */
+    CLOX_JIT_STATUS_CONTINUE = 0x00,
+    /**
+     * @brief   The instruction has been executed and its branch is taken.
+     */
+    CLOX_JIT_STATUS_TAKEN    = 0x01,
+    /**
+     * @brief   A guard of the instruction failed before any side effect, the
+     *          interpreter resumes from it.
+     */
+    CLOX_JIT_STATUS_BAIL     = 0x02,
+} CloxJitStatus_t;
+
+/**
+ * @brief       This enumeration provides the kinds of stencils.
+ */
+typedef enum _CloxJitStencilKind
+{
+    /**
+     * @brief   Calls the function, bailing out when it doesn't continue.
+     */
+    CLOX_JIT_STENCIL_OP     = 0x00,
+    /**
+     * @brief   Calls the function, jumping to the target stencil when the
+     *          branch is taken and bailing out when a guard fails.
+     */
+    CLOX_JIT_STENCIL_BRANCH = 0x01,
+    /**
+     * @brief   Jumps to the target stencil.
+     */
+    CLOX_JIT_STENCIL_JUMP   = 0x02,
+    /**
+     * @brief   Leaves the region, resuming the interpreter from the record.
+     */
+    CLOX_JIT_STENCIL_EXIT   = 0x03,
+    /**
+     * @brief   Copies the register at the source into the one at the
+     *          destination.
+     */
+    CLOX_JIT_STENCIL_MOVE   = 0x04,
+    /**
+     * @brief   Pushes the register at the source, bailing out when the stack
+     *          is full.
+     */
+    CLOX_JIT_STENCIL_PUSH   = 0x05,
+    /**
+     * @brief   Pops the top of the stack into the register at the destination,
+     *          bailing out when the stack is empty.
+     */
+    CLOX_JIT_STENCIL_POP    = 0x06,
+    /**
+     * @brief   Copies the value the source bytes below the top of the stack
+     *          into the register at the destination, bailing out when the
+     *          stack is not as deep.
+     */
+    CLOX_JIT_STENCIL_PICK   = 0x07,
+    /**
+     * @brief   Copies the value at data, as it is when the region is assembled,
+     *          into the register at the destination.
+     */
+    CLOX_JIT_STENCIL_LOAD   = 0x08,
+    /**
+     * @brief   Stores the operation of the payloads of the values at the
+     *          source and at the other offset into the destination, with the
+     *          other words of the value at data. The function is called instead
+     *          when the header of either value differs from the one of data.
+     */
+    CLOX_JIT_STENCIL_ARITHMETIC = 0x09,
+    /**
+     * @brief   Compares the payloads of the values at the source and at the
+     *          other offset (guarded like an arithmetic stencil), storing the
+     *          flag at the destination offset of the context, then jumps to the
+     *          target stencil when the condition is met.
+     */
+    CLOX_JIT_STENCIL_COMPARE    = 0x0A,
+    /**
+     * @brief   Stores into the flag at the destination offset of the context
+     *          whether the first byte of the payload of the value at the source
+     *          is zero. The function is called instead when the header of the
+     *          value differs from the one of data.
+     */
+    CLOX_JIT_STENCIL_TEST       = 0x0B,
+    /**
+     * @brief   Jumps to the target stencil when the flag at the source offset
+     *          of the context meets the condition.
+     */
+    CLOX_JIT_STENCIL_FLAG       = 0x0C,
+    /**
+     * @brief   Jumps to the target stencil, calling the function first (as a
+     *          branch) when the 32 bits at the source offset of the context, or
+     *          the 64 bits at the destination one, are not zero.
+     */
+    CLOX_JIT_STENCIL_POLL       = 0x0D,
+} CloxJitStencilKind_t;
+
+/**
+ * @brief       This enumeration provides the operations of the arithmetic
+ *              stencils, on 64 bits integers or on the reals of the x87 unit
+ *              (80 bits).
+ */
+typedef enum _CloxJitOperation
+{
+    CLOX_JIT_OPERATION_ADD       = 0x00,
+    CLOX_JIT_OPERATION_SUB       = 0x01,
+    CLOX_JIT_OPERATION_MUL       = 0x02,
+    CLOX_JIT_OPERATION_REAL_ADD  = 0x04,
+    CLOX_JIT_OPERATION_REAL_SUB  = 0x05,
+    CLOX_JIT_OPERATION_REAL_MUL  = 0x06,
+    /**
+     * @brief   The bit of the operations on reals, alone for the compares.
+     */
+    CLOX_JIT_OPERATION_REAL      = 0x04,
+} CloxJitOperation_t;
+
+/**
+ * @brief       This enumeration provides the conditions of the branching
+ *              stencils on a flag: a compare sets its bit 0 when the first
+ *              value is less than the other, its bit 1 when it is greater, and
+ *              both when they are unordered.
+ */
+typedef enum _CloxJitCondition
+{
+    /**
+     * @brief   Never met, the compare stencils don't branch.
+     */
+    CLOX_JIT_CONDITION_NONE          = 0x00,
+    /**
+     * @brief   The flag is zero (equal values, or a test of a true value).
+     */
+    CLOX_JIT_CONDITION_ZERO          = 0x01,
+    CLOX_JIT_CONDITION_NONZERO       = 0x02,
+    CLOX_JIT_CONDITION_GREATER       = 0x03,
+    CLOX_JIT_CONDITION_GREATER_EQUAL = 0x04,
+    CLOX_JIT_CONDITION_LESS          = 0x05,
+    CLOX_JIT_CONDITION_LESS_EQUAL    = 0x06,
+} CloxJitCondition_t;
+
+/**
+ * @brief       This data structure provides the layout of the beginning of the
+ *              state given to the entry of a region with inline stencils (the
+ *              MOVE kind and the following ones): they address the registers
+ *              and the stack through it.
+ */
+typedef struct _CloxJitFrame
+{
+    /**
+     * @brief   A pointer to the first free byte of the evaluation stack.
+     */
+    byte_t *top;
+    /**
+     * @brief   A pointer to the first register, the origin of the source and
+     *          destination offsets.
+     */
+    byte_t *window;
+    /**
+     * @brief   A pointer to the first byte of the evaluation stack.
+     */
+    byte_t *bottom;
+    /**
+     * @brief   A pointer past the last byte of the evaluation stack.
+     */
+    byte_t *limit;
+    /**
+     * @brief   A pointer to the origin of the offsets of the flags and of the
+     *          polled words.
+     */
+    byte_t *context;
+} CloxJitFrame_t;
+
+/**
+ * @brief       The datatype of the stencil functions: they get the state given
+ *              to the entry of the region and their patched operands, and
+ *              return a CloxJitStatus_t value.
+ *
+ * @note        The native code calls them with the C calling convention of the
+ *              platform, so they aren't declared CLOX_STDCALL.
+ */
+typedef int (*CloxJitFunction_t)(void *state, uint64_t operands);
+
+/**
+ * @brief       The datatype of the entry of a compiled region.
+ *
+ * @return      The index of the record from which the interpreter resumes.
+ */
+typedef uint32_t (*CloxJitEntry_t)(void *state);
+
+/**
+ * @brief       This data structure provides a stencil of a region.
+ */
+typedef struct _CloxJitStencil
+{
+    /**
+     * @brief   The function of the instruction (for operations and branches),
+     *          inline stencils are called like operations (with the operands)
+     *          on the targets that don't emit them.
+     */
+    CloxJitFunction_t    function;
+    /**
+     * @brief   The operands patched into the call of the function.
+     */
+    uint64_t             operands;
+    /**
+     * @brief   The kind of the stencil.
+     */
+    CloxJitStencilKind_t kind;
+    /**
+     * @brief   The record from which the interpreter resumes when a guard of
+     *          the function fails, or when an exit is reached.
+     */
+    uint32_t             record;
+    /**
+     * @brief   The index of the target stencil of a branch or a jump.
+     */
+    uint32_t             target;
+    /**
+     * @brief   The number of bytes of a value copied by an inline stencil, a
+     *          multiple of eight.
+     */
+    uint32_t             size;
+    /**
+     * @brief   The offset (in bytes) of the source of an inline stencil, from
+     *          the window (or below the top of the stack for a pick, and when
+     *          the stencil pops).
+     */
+    uint32_t             source;
+    /**
+     * @brief   The offset (in bytes) of the destination of an inline stencil,
+     *          from the window (or below the top of the stack when the stencil
+     *          pops).
+     */
+    uint32_t             destination;
+    /**
+     * @brief   The offset (in bytes) of the second value of an arithmetic or
+     *          compare stencil, like the source.
+     */
+    uint32_t             other;
+    /**
+     * @brief   The number of bytes popped from the stack once an arithmetic,
+     *          compare or test stencil is done, zero for the ones on registers.
+     */
+    uint32_t             pop;
+    /**
+     * @brief   The offset (in bytes) of the payload of the values guarded by
+     *          their header, the first eight bytes.
+     */
+    uint32_t             payload;
+    /**
+     * @brief   The operation of an arithmetic or compare stencil.
+     */
+    CloxJitOperation_t   operation;
+    /**
+     * @brief   The condition of a compare or flag stencil.
+     */
+    CloxJitCondition_t   condition;
+    /**
+     * @brief   A pointer to the value of a load stencil, or to the one whose
+     *          header guards the values of an arithmetic, compare or test
+     *          stencil.
+     */
+    const void          *data;
+} CloxJitStencil_t;
+
+/**
+ * @brief       This data structure provides a compiled region.
+ */
+typedef struct _CloxJitCode
+{
+    /**
+     * @brief   A pointer to the executable memory.
+     */
+    void          *memory;
+    /**
+     * @brief   The size (in bytes) of the executable memory.
+     */
+    size_t         size;
+    /**
+     * @brief   The entry of the region, the first stencil.
+     */
+    CloxJitEntry_t entry;
+} CloxJitCode_t;
+
+/**
+ * @brief       This function stitches the specified stencils into executable
+ *              memory: the entry runs them from the first one until an exit or
+ *              a failed guard.
+ *
+ * @note        The last stencil must not fall through, so it must be a jump or
+ *              an exit. The offsets of the inline stencils, plus their size,
+ *              must fit 31 bits, and the payloads of the guarded ones must
+ *              follow their header.
+ *
+ * @param       stencils A pointer to the stencils of the region.
+ * @param       count The number of stencils.
+ * @return      A pointer to the compiled region, or NULL if the stencils are
+ *              malformed, the memory cannot be mapped or the target is not
+ *              supported.
+ */
+CLOX_API CloxJitCode_t *CLOX_STDCALL cloxJitAssemble(const CloxJitStencil_t *const stencils, const size_t count);
+/**
+ * @brief       This function unmaps and releases the specified compiled region.
+ *
+ * @param       code A pointer to the compiled region, or NULL.
+ */
+CLOX_API void CLOX_STDCALL cloxJitRelease(CloxJitCode_t *const code);
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_JIT_H_ */
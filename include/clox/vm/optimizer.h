@@ -0,0 +1,95 @@
+#pragma once
+
+/**
+ * @file        optimizer.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the optimizer of finished blocks,
+ *              which folds constant expressions and branches, drops the dead
+ *              code and then runs the peephole pass, as selected by the
+ *              optimization level.
+ */
+
+#ifndef CLOX_VM_OPTIMIZER_H_
+#define CLOX_VM_OPTIMIZER_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+
+#include "clox/vm/code_block.h"
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    OPTIMIZER Optimizer
+ * @{
+ */
+
+#pragma region Optimizer
+
+/**
+ * @brief       This enumeration provides the optimization levels of a block,
+ *              each one performs the rewritings of the previous one.
+ */
+typedef enum _CloxOptimizationLevel
+{
+    /**
+     * @brief   No rewriting, each instruction keeps its source line (for debug
+     *          builds).
+     */
+    CLOX_OPTIMIZATION_LEVEL_O0 = 0x00,
+    /**
+     * @brief   The peephole pass (see cloxCodeBlockPeephole).
+     */
+    CLOX_OPTIMIZATION_LEVEL_O1 = 0x01,
+    /**
+     * @brief   Folds the arithmetic over constants, the comparisons and the
+     *          tests of constants followed by a conditional jump (which becomes
+     *          unconditional or disappears), then drops the instructions that
+     *          can't be reached from the beginning of the block and the jumps
+     *          to the next instruction.
+     */
+    CLOX_OPTIMIZATION_LEVEL_O2 = 0x02,
+} CloxOptimizationLevel_t;
+
+#ifndef CLOX_OPTIMIZATION_LEVEL_DEFAULT
+/**
+ * @brief       This constant represents the optimization level of the blocks
+ *              compiled with the default settings.
+ */
+#   define CLOX_OPTIMIZATION_LEVEL_DEFAULT CLOX_OPTIMIZATION_LEVEL_O2
+#endif
+
+/**
+ * @brief       This function optimizes a finished block at the specified
+ *              level, then shrinks its capacity to the bytes it stores.
+ *
+ * @note        The folded constants are the ones loaded by 'lec' or 'ldc' into
+ *              a register and pushed right after by 'psh', as the compiler emits
+ *              them: their register is expected to be a scratch one, since once
+ *              folded it holds the result. Nothing is folded over the target of
+ *              a jump. Blocks the peephole pass would leave untouched (unknown
+ *              opcodes or jumps not targeting an instruction) are not optimized.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to optimize.
+ * @param       level The optimization level.
+ * @return      The number of bytes by which the block has been shrunk.
+ */
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockOptimize(CloxCodeBlock_t *const codeBlock, const CloxOptimizationLevel_t level);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_OPTIMIZER_H_ */
@@ -0,0 +1,266 @@
+#pragma once
+
+/**
+ * @file        profiler.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the sampling profiler of the virtual
+ *              machine, which records where the scripts spend their time as
+ *              call stacks of source lines, written as collapsed stacks for
+ *              the flamegraph tools.
+ */
+
+#ifndef CLOX_VM_PROFILER_H_
+#define CLOX_VM_PROFILER_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/clock.h"
+
+#include "clox/vm/code_block.h"
+
+#include <stdio.h>
+
+#ifndef CLOX_PROFILER_PERIOD
+/**
+ * @brief       This constant represents the default number of nanoseconds
+ *              between two samples (so a rate of 1000 samples per second).
+ */
+#   define CLOX_PROFILER_PERIOD 1000000
+#endif
+
+#ifndef CLOX_PROFILER_INTERVAL
+/**
+ * @brief       This constant represents the number of safepoints between two
+ *              reads of the clock, so the clock is read on a small fraction of
+ *              the backward jumps and of the calls.
+ */
+#   define CLOX_PROFILER_INTERVAL 256
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    PROFILER Profiler
+ * @{
+ */
+
+#pragma region Profiler
+
+/**
+ * @brief       This data structure provides a distinct call stack and the
+ *              number of samples that found it.
+ */
+typedef struct _CloxProfilerStack
+{
+    /**
+     * @brief   A pointer to the code block in execution.
+     */
+    const CloxCodeBlock_t *codeBlock;
+    /**
+     * @brief   The index in the lines (and functions) array of the outermost
+     *          frame.
+     */
+    size_t                 position;
+    /**
+     * @brief   The number of frames, the sampled instruction included.
+     */
+    uint32_t               depth;
+    /**
+     * @brief   The hash of the block, of the lines and of the functions of the
+     *          stack.
+     */
+    uint32_t               hash;
+    /**
+     * @brief   The number of samples.
+     */
+    uint64_t               samples;
+} CloxProfilerStack_t;
+
+/**
+ * @brief       This data structure provides a sampling profiler. The virtual
+ *              machine to which it is attached checks it at its safepoints (the
+ *              backward jumps and the calls, the compiled regions included):
+ *              every CLOX_PROFILER_INTERVAL of them it reads the clock and, once
+ *              a period has elapsed, it records the current call stack.
+ *
+ * @note        Since samples are taken at safepoints, straight code is charged
+ *              to the next loop or call it reaches. The stacks are resolved to
+ *              source lines and functions when they are recorded, the samples
+ *              of the same lines are merged.
+ */
+typedef struct _CloxProfiler
+{
+    /**
+     * @brief   The number of nanoseconds between two samples.
+     */
+    uint64_t             period;
+    /**
+     * @brief   The time at which the next sample is due.
+     */
+    uint64_t             deadline;
+    /**
+     * @brief   The number of safepoints left before the clock is read again.
+     */
+    uint32_t             countdown;
+    /**
+     * @brief   The line of each frame of the recorded stacks (one-based, zero
+     *          when the block has no line table), outermost frame first.
+     */
+    uint32_t            *lines;
+    /**
+     * @brief   The function of each frame of the recorded stacks, parallel to
+     *          the lines: the offset of its name in the names of the block
+     *          plus one, or zero for the top-level code.
+     */
+    uint32_t            *functions;
+    /**
+     * @brief   The number of lines alredy stored.
+     */
+    size_t               linesCount;
+    /**
+     * @brief   The number of lines that can be stored before growing the lines
+     *          (and the functions) array.
+     */
+    size_t               linesCapacity;
+    /**
+     * @brief   A pointer to the distinct stacks, in the order they have been
+     *          first sampled.
+     */
+    CloxProfilerStack_t *stacks;
+    /**
+     * @brief   The number of distinct stacks.
+     */
+    size_t               stacksCount;
+    /**
+     * @brief   The number of stacks that can be stored before growing the
+     *          stacks array.
+     */
+    size_t               stacksCapacity;
+    /**
+     * @brief   A pointer to the open addressing hash index of the stacks: each
+     *          slot stores the index of a stack plus one, or zero when empty.
+     */
+    uint32_t            *index;
+    /**
+     * @brief   The number of slots of the index (a power of two).
+     */
+    size_t               indexCapacity;
+    /**
+     * @brief   A pointer to the offsets of the stack being sampled, filled by
+     *          the virtual machine (see cloxProfilerReserve), then to their
+     *          lines followed by their functions.
+     */
+    uint32_t            *scratch;
+    /**
+     * @brief   The number of words the scratch array can store, twice the
+     *          depth of the deepest stack.
+     */
+    size_t               scratchCapacity;
+    /**
+     * @brief   The total number of samples.
+     */
+    uint64_t             samplesCount;
+} CloxProfiler_t;
+
+/**
+ * @brief       This function initializes a CloxProfiler_t data structure.
+ *
+ * @param       profiler A pointer to the CloxProfiler_t instance to initialize.
+ * @param       period The number of nanoseconds between two samples, when zero
+ *              CLOX_PROFILER_PERIOD is used.
+ * @return      On success this function returns a pointer to the initialized
+ *              profiler (so the value of profiler parameter).
+ */
+CLOX_API CloxProfiler_t *CLOX_STDCALL cloxInitProfiler(CloxProfiler_t *const profiler, uint64_t period);
+/**
+ * @brief       This function releases the resources of a CloxProfiler_t
+ *              instance, its samples included, without deleting it.
+ *
+ * @param       profiler A pointer to the CloxProfiler_t instance to free.
+ * @return      On success this function returns a pointer to the freed
+ *              profiler (so the value of profiler parameter).
+ */
+CLOX_API CloxProfiler_t *CLOX_STDCALL cloxFreeProfiler(CloxProfiler_t *const profiler);
+
+/**
+ * @brief       This function is called by the virtual machine at each of its
+ *              safepoints, it tells whether a sample is due.
+ *
+ * @param       profiler A pointer to the CloxProfiler_t instance.
+ * @return      TRUE if the current stack has to be recorded, otherwise FALSE.
+ */
+CLOX_API_INLINE bool_t CLOX_STDCALL cloxProfilerTick(CloxProfiler_t *const profiler)
+{
+    if (--profiler->countdown)
+        return FALSE;
+
+    profiler->countdown = CLOX_PROFILER_INTERVAL;
+
+    CLOX_REGISTER const uint64_t now = cloxClockNow();
+
+    if (now < profiler->deadline)
+        return FALSE;
+
+    profiler->deadline = now + profiler->period;
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function gets the scratch array in which the virtual
+ *              machine writes the offsets of the stack to record.
+ *
+ * @param       profiler A pointer to the CloxProfiler_t instance.
+ * @param       depth The number of frames of the stack.
+ * @return      A pointer to an array of at least depth offsets, valid until the
+ *              next call.
+ */
+CLOX_API uint32_t *CLOX_STDCALL cloxProfilerReserve(CloxProfiler_t *const profiler, const size_t depth);
+/**
+ * @brief       This function records a sample of the stack written into the
+ *              scratch array, resolving its offsets to source lines and to the
+ *              functions containing them (see cloxCodeBlockFindSymbol).
+ *
+ * @param       profiler A pointer to the CloxProfiler_t instance.
+ * @param       codeBlock A pointer to the code block in execution.
+ * @param       depth The number of offsets of the stack, outermost frame first
+ *              and the sampled instruction last.
+ */
+CLOX_API void CLOX_STDCALL cloxProfilerRecord(CloxProfiler_t *const profiler, const CloxCodeBlock_t *const codeBlock, const size_t depth);
+
+/**
+ * @brief       This function writes the samples as collapsed stacks, one line
+ *              for each distinct stack: its frames separated by semicolons,
+ *              then the number of its samples. A frame is written as the name
+ *              of its block, a colon and its line; the frames in a function
+ *              have its name and a colon before the line.
+ *
+ * @param       profiler A pointer to the CloxProfiler_t instance.
+ * @param       stream A pointer to the FILE stream to which write.
+ * @param       codeBlocks A pointer to the profiled code blocks.
+ * @param       names A pointer to the names of the code blocks (for instance
+ *              the paths of their scripts), the blocks not found are named
+ *              "?".
+ * @param       count The number of code blocks and of names.
+ * @return      TRUE on success, FALSE on I/O errors.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxProfilerWrite(const CloxProfiler_t *const profiler, FILE *const stream, const CloxCodeBlock_t *const *const codeBlocks, const char *const *const names, const size_t count);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_PROFILER_H_ */
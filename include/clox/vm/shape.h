@@ -0,0 +1,291 @@
+#pragma once
+
+/**
+ * @file        shape.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header are defined the shapes (hidden classes) of the
+ *              instances of the managed heap.
+ *
+ *              An instance doesn't store the names of its properties: it
+ *              points to a shape, which maps each name to the index of its
+ *              value in a flat array. Shapes form a tree rooted at the empty
+ *              one, adding a property to an instance moves it to the child of
+ *              its shape for that name (a transition), which is created once
+ *              and then shared, so instances that get the same properties in
+ *              the same order end up with the same shape. The shapes of a tree
+ *              live as long as the tree, so a pointer to a shape can be used as
+ *              the key of an inline cache.
+ */
+
+#ifndef CLOX_VM_SHAPE_H_
+#define CLOX_VM_SHAPE_H_
+
+#include "clox/base/api.h"
+#include "clox/base/arena.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/intern.h"
+
+#include "clox/vm/heap.h"
+#include "clox/vm/value.h"
+
+#ifndef CLOX_INSTANCE_SHAPE
+/**
+ * @brief       This constant represents the index of the value of an instance
+ *              that points to its shape.
+ */
+#   define CLOX_INSTANCE_SHAPE 0
+#endif
+
+#ifndef CLOX_INSTANCE_OVERFLOW
+/**
+ * @brief       This constant represents the index of the value of an instance
+ *              that stores the array object of the properties which don't fit
+ *              into the instance, void until it's needed.
+ */
+#   define CLOX_INSTANCE_OVERFLOW 1
+#endif
+
+#ifndef CLOX_INSTANCE_FIELDS
+/**
+ * @brief       This constant represents the index of the value of an instance
+ *              that stores its first property.
+ */
+#   define CLOX_INSTANCE_FIELDS 2
+#endif
+
+#ifndef CLOX_INSTANCE_CAPACITY
+/**
+ * @brief       This constant represents the number of properties stored into
+ *              an instance when no capacity is specified.
+ */
+#   define CLOX_INSTANCE_CAPACITY 4
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    SHAPE Shapes
+ * @{
+ */
+
+#pragma region Shapes
+
+/**
+ * @brief       This data structure provides a shape, so the layout of the
+ *              properties of an instance.
+ */
+typedef struct _CloxShape
+{
+    /**
+     * @brief   A pointer to the shape without the last property, NULL for the
+     *          root.
+     */
+    const struct _CloxShape *parent;
+    /**
+     * @brief   The interned name of the last property, NULL for the root.
+     */
+    const CloxString_t      *key;
+    /**
+     * @brief   The number of properties, so the index of the last one plus
+     *          one.
+     */
+    uint32_t                 count;
+    /**
+     * @brief   A pointer to the first shape reached from this one by a
+     *          transition.
+     */
+    struct _CloxShape       *transitions;
+    /**
+     * @brief   A pointer to the next shape reached by a transition from the
+     *          parent.
+     */
+    struct _CloxShape       *sibling;
+} CloxShape_t;
+
+/**
+ * @brief       This data structure provides a tree of shapes, whose root is
+ *              the shape of the new instances.
+ */
+typedef struct _CloxShapeTree
+{
+    /**
+     * @brief   The arena from which the shapes are allocated.
+     */
+    CloxArena_t arena;
+    /**
+     * @brief   The empty shape.
+     */
+    CloxShape_t root;
+    /**
+     * @brief   The number of shapes of the tree, the root included.
+     */
+    size_t      count;
+} CloxShapeTree_t;
+
+/**
+ * @brief       This function initializes a CloxShapeTree_t data structure, with
+ *              only the empty shape.
+ *
+ * @param       tree A pointer to the CloxShapeTree_t instance to initialize.
+ * @return      On success this function returns a pointer to the initialized
+ *              tree (so the value of tree parameter).
+ */
+CLOX_API CloxShapeTree_t *CLOX_STDCALL cloxInitShapeTree(CloxShapeTree_t *const tree);
+/**
+ * @brief       This function releases the shapes of a CloxShapeTree_t instance
+ *              without deleting it. The instances of its shapes must not be
+ *              used anymore.
+ *
+ * @param       tree A pointer to the CloxShapeTree_t instance to free.
+ * @return      On success this function returns a pointer to the freed tree
+ *              (so the value of tree parameter).
+ */
+CLOX_API CloxShapeTree_t *CLOX_STDCALL cloxFreeShapeTree(CloxShapeTree_t *const tree);
+
+/**
+ * @brief       This function gets the shape reached from another one adding a
+ *              property, creating it on the first transition.
+ *
+ * @param       tree A pointer to the CloxShapeTree_t instance of the shape.
+ * @param       shape A pointer to the shape, which must not have the property.
+ * @param       key A pointer to the interned name of the property.
+ * @return      A pointer to the shape with the property.
+ */
+CLOX_API const CloxShape_t *CLOX_STDCALL cloxShapeTransition(CloxShapeTree_t *const tree, const CloxShape_t *const shape, const CloxString_t *const key);
+/**
+ * @brief       This function finds the index of a property in a shape.
+ *
+ * @param       shape A pointer to the shape.
+ * @param       key A pointer to the interned name of the property.
+ * @return      The index of the property, or SIZE_MAX if the shape doesn't
+ *              have it.
+ */
+CLOX_API size_t CLOX_STDCALL cloxShapeLookup(const CloxShape_t *const shape, const CloxString_t *const key);
+
+#pragma endregion
+
+/**
+ * @}
+ *
+ * @defgroup    INSTANCE Instances
+ * @{
+ */
+
+#pragma region Instances
+
+/**
+ * @brief       This function gets the shape of an instance.
+ *
+ * @param       object A pointer to the instance object.
+ * @return      A pointer to the shape.
+ */
+CLOX_API_INLINE const CloxShape_t *CLOX_STDCALL cloxInstanceShape(CloxObject_t *const object)
+{
+    return (const CloxShape_t *)cloxValueAsVPtr(cloxObjectValues(object)[CLOX_INSTANCE_SHAPE]);
+}
+
+/**
+ * @brief       This function gets the value of a property of an instance.
+ *
+ * @param       object A pointer to the instance object.
+ * @param       index The index of the property, lower than the number of
+ *              properties of its shape.
+ * @return      A pointer to the value, valid until the next property is added.
+ */
+CLOX_API_INLINE CloxValue_t *CLOX_STDCALL cloxInstanceField(CloxObject_t *const object, const size_t index)
+{
+    CloxValue_t *const values = cloxObjectValues(object);
+    CLOX_REGISTER const size_t capacity = (size_t)object->count - CLOX_INSTANCE_FIELDS;
+
+    if (index < capacity)
+        return &values[CLOX_INSTANCE_FIELDS + index];
+
+    return &cloxObjectValues(cloxValueAsObject(values[CLOX_INSTANCE_OVERFLOW]))[index - capacity];
+}
+
+/**
+ * @brief       This function allocates an instance object, with the empty shape
+ *              of a tree.
+ *
+ * @note        An instance is traced as an array object: the first values store
+ *              its shape and its overflow array, then its properties follow.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       tree A pointer to the CloxShapeTree_t instance.
+ * @param       capacity The number of properties stored into the instance, the
+ *              following ones are stored into its overflow array. When zero
+ *              CLOX_INSTANCE_CAPACITY is used.
+ * @return      On success this function returns a pointer to the new object,
+ *              or NULL if the memory limit of the heap is reached.
+ */
+CLOX_API CloxObject_t *CLOX_STDCALL cloxNewInstance(CloxHeap_t *const heap, CloxShapeTree_t *const tree, size_t capacity);
+
+/**
+ * @brief       This function gets a property of an instance.
+ *
+ * @param       object A pointer to the instance object.
+ * @param       key A pointer to the interned name of the property.
+ * @param       outValue A pointer to the value that receives the property.
+ * @return      TRUE if the instance has the property, otherwise FALSE.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxInstanceGet(CloxObject_t *const object, const CloxString_t *const key, CloxValue_t *const outValue);
+/**
+ * @brief       This function stores the value of an existing property of an
+ *              instance, with the write barrier of the heap.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       object A pointer to the instance object.
+ * @param       index The index of the property, lower than the number of
+ *              properties of its shape.
+ * @param       value The value to store.
+ */
+CLOX_API void CLOX_STDCALL cloxInstanceStore(CloxHeap_t *const heap, CloxObject_t *const object, const size_t index, const CloxValue_t value);
+/**
+ * @brief       This function adds a property to an instance: it moves the
+ *              instance to the next shape, then stores the value.
+ *
+ * @note        The allocation of the overflow array can take a step of the
+ *              collector, the instance and the value must be reachable.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       object A pointer to the instance object.
+ * @param       shape A pointer to the shape reached by the transition, which
+ *              has one property more than the current one.
+ * @param       value The value of the new property.
+ * @return      TRUE on success, FALSE if the memory limit of the heap is
+ *              reached (then the instance is unchanged).
+ */
+CLOX_API bool_t CLOX_STDCALL cloxInstanceAppend(CloxHeap_t *const heap, CloxObject_t *const object, const CloxShape_t *const shape, const CloxValue_t value);
+/**
+ * @brief       This function sets a property of an instance, adding it if the
+ *              instance doesn't have it.
+ *
+ * @param       heap A pointer to the CloxHeap_t instance.
+ * @param       tree A pointer to the CloxShapeTree_t instance of the shapes of
+ *              the instance.
+ * @param       object A pointer to the instance object.
+ * @param       key A pointer to the interned name of the property.
+ * @param       value The value to store.
+ * @return      TRUE on success, FALSE if the memory limit of the heap is
+ *              reached.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxInstanceSet(CloxHeap_t *const heap, CloxShapeTree_t *const tree, CloxObject_t *const object, const CloxString_t *const key, const CloxValue_t value);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_SHAPE_H_ */
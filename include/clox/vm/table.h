@@ -0,0 +1,164 @@
+#pragma once
+
+/**
+ * @file        table.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the hash table of the virtual
+ *              machine, which maps interned strings to values.
+ *
+ *              The table uses open addressing with linear probing over a flat
+ *              array of entries, so a lookup touches consecutive memory, and
+ *              deletions shift back the entries that follow instead of leaving
+ *              tombstones. Since keys are interned they are compared by
+ *              pointer, the cached hash only selects the first slot.
+ */
+
+#ifndef CLOX_VM_TABLE_H_
+#define CLOX_VM_TABLE_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/intern.h"
+
+#include "clox/vm/value.h"
+
+#ifndef CLOX_TABLE_CAPACITY
+/**
+ * @brief       This constant represents the initial number of entries of a
+ *              table, it must be a power of two.
+ */
+#   define CLOX_TABLE_CAPACITY 16
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    TABLE Table
+ * @{
+ */
+
+#pragma region Table
+
+/**
+ * @brief       This data structure provides an entry of a table, the entry is
+ *              empty when its key is NULL.
+ */
+typedef struct _CloxTableEntry
+{
+    /**
+     * @brief   The interned key of the entry.
+     */
+    const CloxString_t *key;
+    /**
+     * @brief   The value bound to the key.
+     */
+    CloxValue_t         value;
+} CloxTableEntry_t;
+
+/**
+ * @brief       This data structure provides a hash table.
+ */
+typedef struct _CloxTable
+{
+    /**
+     * @brief   A pointer to the first entry of the table.
+     */
+    CloxTableEntry_t *entries;
+    /**
+     * @brief   The number of entries of the table, always a power of two (or
+     *          zero before the first insertion).
+     */
+    size_t            capacity;
+    /**
+     * @brief   The number of keys stored into the table.
+     */
+    size_t            count;
+    /**
+     * @brief   A counter incremented each time entries are moved (when the
+     *          table grows or a key is deleted), a pointer to an entry taken
+     *          at the same epoch is still valid.
+     */
+    uint32_t          epoch;
+} CloxTable_t;
+
+/**
+ * @brief       This function initializes a CloxTable_t data structure.
+ *
+ * @param       table A pointer to the CloxTable_t instance to initialize.
+ * @return      On success this function returns a pointer to the initialized
+ *              table (so the value of table parameter).
+ */
+CLOX_API CloxTable_t *CLOX_STDCALL cloxInitTable(CloxTable_t *const table);
+/**
+ * @brief       This function releases the entries of a CloxTable_t instance
+ *              without deleting it.
+ *
+ * @param       table A pointer to the CloxTable_t instance to free.
+ * @return      On success this function returns a pointer to the freed table
+ *              (so the value of table parameter).
+ */
+CLOX_API CloxTable_t *CLOX_STDCALL cloxFreeTable(CloxTable_t *const table);
+
+/**
+ * @brief       This function allocates and initializes a new CloxTable_t data
+ *              structure.
+ *
+ * @return      On success this function returns a pointer to the new table.
+ */
+CLOX_API CloxTable_t *CLOX_STDCALL cloxCreateTable(void);
+
+/**
+ * @brief       This function finds the entry of a key.
+ *
+ * @param       table A pointer to the CloxTable_t instance.
+ * @param       key A pointer to the interned key.
+ * @return      A pointer to the entry of the key, valid while the epoch of the
+ *              table doesn't change, or NULL if the key is not stored.
+ */
+CLOX_API CloxTableEntry_t *CLOX_STDCALL cloxTableFind(const CloxTable_t *const table, const CloxString_t *const key);
+
+/**
+ * @brief       This function binds a value to a key, adding the key if it is
+ *              not stored yet.
+ *
+ * @param       table A pointer to the CloxTable_t instance.
+ * @param       key A pointer to the interned key.
+ * @param       value The value to bind.
+ * @return      TRUE if the key has been added, FALSE if it was already stored.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxTableSet(CloxTable_t *const table, const CloxString_t *const key, const CloxValue_t value);
+
+/**
+ * @brief       This function removes a key from a table.
+ *
+ * @param       table A pointer to the CloxTable_t instance.
+ * @param       key A pointer to the interned key.
+ * @return      TRUE if the key has been removed, FALSE if it was not stored.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxTableDelete(CloxTable_t *const table, const CloxString_t *const key);
+
+/**
+ * @brief       This function frees and deletes a CloxTable_t instance.
+ *
+ * @param       table A pointer to the CloxTable_t instance to delete.
+ */
+CLOX_API void CLOX_STDCALL cloxDeleteTable(CloxTable_t *const table);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_TABLE_H_ */
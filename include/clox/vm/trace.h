@@ -0,0 +1,286 @@
+#pragma once
+
+/**
+ * @file        trace.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the execution trace of the virtual
+ *              machine: a ring buffer of compact binary records, one for each
+ *              executed instruction, optionally flushed into a file that the
+ *              clox-trace tool decodes.
+ */
+
+#ifndef CLOX_VM_TRACE_H_
+#define CLOX_VM_TRACE_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+#include "clox/base/byte.h"
+#include "clox/base/thread.h"
+
+#include <stdio.h>
+
+#ifndef CLOX_TRACE_CAPACITY
+/**
+ * @brief       This constant represents the default number of records of a
+ *              trace (512 KiB of records).
+ */
+#   define CLOX_TRACE_CAPACITY 65536
+#endif
+
+#ifndef CLOX_TRACE_MAGIC_NUMBER
+/**
+ * @brief       This constant represents the magic number of the trace files
+ *              ("CLXT").
+ */
+#   define CLOX_TRACE_MAGIC_NUMBER 0x434C5854
+#endif
+
+#ifndef CLOX_TRACE_VERSION
+/**
+ * @brief       This constant represents the version of the trace format, a
+ *              trace of a different version is never decoded.
+ */
+#   define CLOX_TRACE_VERSION 1
+#endif
+
+#ifndef CLOX_TRACE_TYPE_NONE
+/**
+ * @brief       This constant represents the type of the records of the
+ *              instructions executed with an empty evaluation stack.
+ */
+#   define CLOX_TRACE_TYPE_NONE 0xFF
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    TRACE Trace
+ * @{
+ */
+
+#pragma region Trace
+
+/**
+ * @brief       This data structure provides the record of an executed
+ *              instruction, taken before its execution.
+ */
+typedef struct _CloxTraceRecord
+{
+    /**
+     * @brief   The offset of the instruction into the bytecode.
+     */
+    uint32_t offset;
+    /**
+     * @brief   The opcode of the instruction (the one of the bytecode, also
+     *          when its decoded record is quickened).
+     */
+    byte_t   opCode;
+    /**
+     * @brief   The type of the value on top of the evaluation stack (the low
+     *          byte of its CloxValueType_t), CLOX_TRACE_TYPE_NONE when the
+     *          stack is empty.
+     */
+    byte_t   type;
+    /**
+     * @brief   The number of values of the evaluation stack, saturated to
+     *          UINT16_MAX.
+     */
+    uint16_t depth;
+} CloxTraceRecord_t;
+
+/**
+ * @brief       This data structure provides the header of a trace file, which
+ *              is followed by its records up to the end of the file.
+ *
+ * @note        Like images, traces are stored with the byte order of the
+ *              writer, a trace written by a host with a different byte order
+ *              has a different magic number and it is refused.
+ */
+typedef struct _CloxTraceHeader
+{
+    /**
+     * @brief   The magic number (CLOX_TRACE_MAGIC_NUMBER).
+     */
+    uint32_t magic;
+    /**
+     * @brief   The version of the format (CLOX_TRACE_VERSION).
+     */
+    uint16_t version;
+    /**
+     * @brief   The size of a CloxTraceRecord_t.
+     */
+    uint16_t recordSize;
+} CloxTraceHeader_t;
+
+/**
+ * @brief       This data structure provides an execution trace. The virtual
+ *              machine to which it is attached appends a record before each
+ *              instruction it executes (while a trace is attached the compiled
+ *              regions are not entered, so nothing is missed), overwriting the
+ *              oldest records once the ring is full.
+ *
+ * @note        A trace has a single writer, the thread running its virtual
+ *              machine, that never waits: the records are published by a
+ *              release store of the head, so other threads can take snapshots
+ *              at any time (see cloxTraceSnapshot). When a stream is given the
+ *              writer flushes each half of the ring as soon as it is complete,
+ *              so no record is lost (but the writer waits for the stream).
+ */
+typedef struct _CloxTrace
+{
+    /**
+     * @brief   A pointer to the ring of the records.
+     */
+    CloxTraceRecord_t *records;
+    /**
+     * @brief   The number of records of the ring (a power of two).
+     */
+    size_t             capacity;
+    /**
+     * @brief   The number of records written since the trace was initialized,
+     *          the next one is stored at head modulo capacity.
+     */
+    uint64_t           head;
+    /**
+     * @brief   A pointer to the FILE stream into which the records are
+     *          flushed, NULL when they are only kept into the ring.
+     */
+    FILE              *stream;
+    /**
+     * @brief   The number of records already flushed into the stream.
+     */
+    uint64_t           flushed;
+    /**
+     * @brief   TRUE once a write into the stream failed, then the records are
+     *          only kept into the ring.
+     */
+    bool_t             failed;
+} CloxTrace_t;
+
+/**
+ * @brief       This function initializes a CloxTrace_t data structure, writing
+ *              the header of the trace into the stream (if any).
+ *
+ * @param       trace A pointer to the CloxTrace_t instance to initialize.
+ * @param       capacity The number of records of the ring, rounded up to a
+ *              power of two, when zero CLOX_TRACE_CAPACITY is used.
+ * @param       stream A pointer to the FILE stream into which flush the
+ *              records, or NULL to keep them only into the ring.
+ * @return      On success this function returns a pointer to the initialized
+ *              trace (so the value of trace parameter).
+ */
+CLOX_API CloxTrace_t *CLOX_STDCALL cloxInitTrace(CloxTrace_t *const trace, size_t capacity, FILE *const stream);
+/**
+ * @brief       This function releases the resources of a CloxTrace_t instance
+ *              without deleting it. The records not yet flushed are lost (see
+ *              cloxTraceFlush) and the stream is not closed.
+ *
+ * @param       trace A pointer to the CloxTrace_t instance to free.
+ * @return      On success this function returns a pointer to the freed trace
+ *              (so the value of trace parameter).
+ */
+CLOX_API CloxTrace_t *CLOX_STDCALL cloxFreeTrace(CloxTrace_t *const trace);
+
+/**
+ * @brief       This function writes into the stream the records not yet
+ *              flushed. It is called by the writer each time it completes a
+ *              half of the ring, and by the host once the runs are over.
+ *
+ * @param       trace A pointer to the CloxTrace_t instance.
+ * @return      TRUE on success (or without a stream), FALSE on I/O errors.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxTraceFlush(CloxTrace_t *const trace);
+
+/**
+ * @brief       This function appends a record to the trace, it is called by
+ *              the virtual machine before each instruction.
+ *
+ * @param       trace A pointer to the CloxTrace_t instance.
+ * @param       offset The offset of the instruction.
+ * @param       opCode The opcode of the instruction.
+ * @param       type The type of the value on top of the stack.
+ * @param       depth The number of values of the stack.
+ */
+CLOX_API_INLINE void CLOX_STDCALL cloxTraceRecord(CloxTrace_t *const trace, const uint32_t offset, const byte_t opCode, const byte_t type, const uint16_t depth)
+{
+    CLOX_REGISTER const uint64_t head = trace->head;
+
+    CloxTraceRecord_t *const record = &trace->records[head & (trace->capacity - 1)];
+
+    record->offset = offset;
+    record->opCode = opCode;
+    record->type   = type;
+    record->depth  = depth;
+
+    cloxAtomicStoreRelease64(&trace->head, head + 1);
+
+    if (trace->stream && !((head + 1) & ((trace->capacity >> 1) - 1)))
+        cloxTraceFlush(trace);
+
+    return;
+}
+
+/**
+ * @brief       This function copies the most recent records of a trace, it
+ *              can be called by any thread while the virtual machine runs.
+ *              The records overwritten while they are copied are dropped, so
+ *              the copied ones are consecutive and consistent (and, since the
+ *              oldest slot may be in use by the writer, at most capacity - 1).
+ *
+ * @param       trace A pointer to the CloxTrace_t instance.
+ * @param       outRecords A pointer to the array into which copy the records,
+ *              oldest first.
+ * @param       count The number of records the array can store.
+ * @return      The number of records copied (the most recent ones).
+ */
+CLOX_API size_t CLOX_STDCALL cloxTraceSnapshot(const CloxTrace_t *const trace, CloxTraceRecord_t *const outRecords, const size_t count);
+
+/**
+ * @brief       This function writes a trace file with the records that are
+ *              still into the ring, oldest first. It is called by the thread
+ *              running the virtual machine (or when it doesn't run), for
+ *              instance after an error.
+ *
+ * @param       trace A pointer to the CloxTrace_t instance.
+ * @param       stream A pointer to the FILE stream to which write.
+ * @return      TRUE on success, FALSE on I/O errors.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxTraceWrite(const CloxTrace_t *const trace, FILE *const stream);
+/**
+ * @brief       This function reads and checks the header of a trace file.
+ *
+ * @param       stream A pointer to the FILE stream from which read.
+ * @return      TRUE if the stream holds a trace that can be decoded, FALSE
+ *              otherwise.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxTraceReadHeader(FILE *const stream);
+/**
+ * @brief       This function reads the next records of a trace file, after
+ *              its header.
+ *
+ * @param       stream A pointer to the FILE stream from which read.
+ * @param       outRecords A pointer to the array into which read the records.
+ * @param       count The number of records the array can store.
+ * @return      The number of records read, less than count at the end of the
+ *              file (a truncated record is ignored).
+ */
+CLOX_API size_t CLOX_STDCALL cloxTraceRead(FILE *const stream, CloxTraceRecord_t *const outRecords, const size_t count);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_TRACE_H_ */
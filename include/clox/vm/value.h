@@ -26,30 +26,51 @@
 #include "clox/base/bool.h"
 #include "clox/base/byte.h"
 
+#include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 CLOX_C_HEADER_BEGIN
 
+#if CLOX_VALUE_NAN_BOXING
+/**
+ * @brief       This datatype provides an unsigned integer type used to
+ *              represent the unsigned integer value.
+ * 
+ * @note        With NaN-boxed values integers are 32-bit wide, so that
+ *              they fit into the payload of a boxed value.
+ */
+typedef uint32_t uint_t;
+#else
 /**
  * @brief       This datatype provides an unsigned integer type used to
  *              represent the unsigned integer value.
  */
 typedef uintmax_t uint_t;
+#endif
 
 #ifndef CLOX_UINT_MIN
 /**
  * @brief       This constant provides the minimum value representable with
  *              an uint_t datatype.
  */
-#   define CLOX_UINT_MIN UINTMAX_MIN
+#   define CLOX_UINT_MIN ((uint_t)0)
 #endif
 
 #ifndef CLOX_UINT_MAX
+#   if CLOX_VALUE_NAN_BOXING
+/**
+ * @brief       This constant provides the maximum value representable with
+ *              an uint_t datatype.
+ */
+#       define CLOX_UINT_MAX UINT32_MAX
+#   else
 /**
  * @brief       This constant provides the maximum value representable with
  *              an uint_t datatype.
  */
-#   define CLOX_UINT_MAX UINTMAX_MAX
+#       define CLOX_UINT_MAX UINTMAX_MAX
+#   endif
 #endif
 
 #if CLOX_UINT_MAX == UINT32_MAX
@@ -72,26 +93,53 @@ typedef uintmax_t uint_t;
 #   define CLOX_UINT_WIDTH 64
 #endif
 
+#if CLOX_VALUE_NAN_BOXING
+/**
+ * @brief       This datatype provides a signed integer datatype used to
+ *              represent the signed integer value.
+ * 
+ * @note        With NaN-boxed values integers are 32-bit wide, so that
+ *              they fit into the payload of a boxed value.
+ */
+typedef int32_t sint_t;
+
+#   ifndef CLOX_SINT_MIN
+/**
+ * @brief       This constant provides the minimum value representable with
+ *              a sint_t datatype.
+ */
+#       define CLOX_SINT_MIN INT32_MIN
+#   endif
+
+#   ifndef CLOX_SINT_MAX
+/**
+ * @brief       This constant provides the maximum value representable with
+ *              a sint_t datatype.
+ */
+#       define CLOX_SINT_MAX INT32_MAX
+#   endif
+#else
 /**
  * @brief       This datatype provides a signed integer datatype used to
  *              represent the signed integer value.
  */
 typedef intmax_t sint_t;
 
-#ifndef CLOX_SINT_MIN
+#   ifndef CLOX_SINT_MIN
 /**
  * @brief       This constant provides the minimum value representable with
  *              a sint_t datatype.
  */
-#   define CLOX_SINT_MIN INTMAX_MIN
-#endif
+#       define CLOX_SINT_MIN INTMAX_MIN
+#   endif
 
-#ifndef CLOX_SINT_MAX
+#   ifndef CLOX_SINT_MAX
 /**
  * @brief       This constant provides the maximum value representable with
  *              a sint_t datatype.
  */
-#   define CLOX_SINT_MAX INTMAX_MAX
+#       define CLOX_SINT_MAX INTMAX_MAX
+#   endif
 #endif
 
 #if CLOX_SINT_MAX == INT32_MAX
@@ -114,26 +162,53 @@ typedef intmax_t sint_t;
 #   define CLOX_SINT_WIDTH 64
 #endif
 
+#if CLOX_VALUE_NAN_BOXING
+/**
+ * @brief       This datatype provides a double precision floating point
+ *              number used to represent real values.
+ * 
+ * @note        With NaN-boxed values reals are double precision numbers,
+ *              since the boxed value is the IEEE 754 binary64 word itself.
+ */
+typedef double real_t;
+
+#   ifndef CLOX_REAL_MIN
+/**
+ * @brief       This constant represents the minimum value representable
+ *              with the real_t datatype.
+ */
+#       define CLOX_REAL_MIN DBL_MIN
+#   endif
+
+#   ifndef CLOX_REAL_MAX
+/**
+ * @brief       This constant represents the maximum value representable
+ *              with the real_t datatype.
+ */
+#       define CLOX_REAL_MAX DBL_MAX
+#   endif
+#else
 /**
  * @brief       This datatype provides a long double precision floating
  *              point number used to represent real values.
  */
 typedef long double real_t;
 
-#ifndef CLOX_REAL_MIN
+#   ifndef CLOX_REAL_MIN
 /**
  * @brief       This constant represents the minimum value representable
  *              with the real_t datatype.
  */
-#   define CLOX_REAL_MIN LDBL_MIN
-#endif
+#       define CLOX_REAL_MIN LDBL_MIN
+#   endif
 
-#ifndef CLOX_REAL_MAX
+#   ifndef CLOX_REAL_MAX
 /**
  * @brief       This constant represents the maximum value representable
  *              with the real_t datatype.
  */
-#   define CLOX_REAL_MAX LDBL_MAX
+#       define CLOX_REAL_MAX LDBL_MAX
+#   endif
 #endif
 
 /**
@@ -244,6 +319,12 @@ typedef enum _CloxValueType
      *          can store only a raw pointer (an address of memory).
      */
     CLOX_VALUE_TYPE_VPTR = 0x06 | CLOX_VALUE_FLAG_POINTER,
+    /**
+     * @brief   Represents 'object' values, so values that store a pointer
+     *          to an object of the managed heap, owned by the garbage
+     *          collector (see clox/vm/heap.h).
+     */
+    CLOX_VALUE_TYPE_OBJT = 0x07 | CLOX_VALUE_FLAG_POINTER,
 } CloxValueType_t;
 
 #ifndef cloxValueTypeBoolToString
@@ -281,13 +362,13 @@ typedef enum _CloxValueType
  * @brief       This constant represents the unsigned value type printf
  *              style format.
  */
-#       define CLOX_VALUE_TYPE_UINT_FORMAT  "%lu"
+#       define CLOX_VALUE_TYPE_UINT_FORMAT  "%" PRIu32
 #   elif CLOX_UINT_WIDTH == 64
 /**
  * @brief       This constant represents the unsigned value type printf
  *              style format.
  */
-#       define CLOX_VALUE_TYPE_UINT_FORMAT  "%llu"
+#       define CLOX_VALUE_TYPE_UINT_FORMAT  "%" PRIu64
 #   else
 /**
  * @brief       This constant represents the unsigned value type printf
@@ -303,13 +384,13 @@ typedef enum _CloxValueType
  * @brief       This constant represents the integer value type printf
  *              style format.
  */
-#       define CLOX_VALUE_TYPE_SINT_FORMAT  "%ld"
+#       define CLOX_VALUE_TYPE_SINT_FORMAT  "%" PRId32
 #   elif CLOX_SINT_WIDTH == 64
 /**
  * @brief       This constant represents the integer value type printf
  *              style format.
  */
-#       define CLOX_VALUE_TYPE_SINT_FORMAT  "%lld"
+#       define CLOX_VALUE_TYPE_SINT_FORMAT  "%" PRId64
 #   else
 /**
  * @brief       This constant represents the integer value type printf
@@ -320,11 +401,19 @@ typedef enum _CloxValueType
 #endif
 
 #ifndef CLOX_VALUE_TYPE_REAL_FORMAT
+#   if CLOX_VALUE_NAN_BOXING
 /**
  * @brief       This constant represents the real value type printf
  *              style format.
  */
-#   define CLOX_VALUE_TYPE_REAL_FORMAT      "%Lg"
+#       define CLOX_VALUE_TYPE_REAL_FORMAT  "%g"
+#   else
+/**
+ * @brief       This constant represents the real value type printf
+ *              style format.
+ */
+#       define CLOX_VALUE_TYPE_REAL_FORMAT  "%Lg"
+#   endif
 #endif
 
 #ifndef CLOX_VALUE_TYPE_PNTR_FORMAT
@@ -466,6 +555,193 @@ typedef uint16_t CloxValueSize_t;
 typedef uint32_t CloxValueSize_t;
 #endif
 
+#if CLOX_VALUE_NAN_BOXING
+/**
+ * @brief       This data structure provides a container in which store
+ *              values during execution and compilation.
+ * 
+ *              Values are NaN-boxed into a single 64-bit word: reals are
+ *              stored as they are, any other type is stored as a quiet NaN
+ *              whose sign bit and two lowest exponent bits hold the type
+ *              tag (the value type code) and whose 48 lowest bits hold the
+ *              payload.
+ * 
+ * @note        Pointers must fit into 48 bits, as user-space addresses on
+ *              x86-64 and AArch64 do.
+ */
+typedef struct _CloxValue
+{
+    /**
+     * @brief   Represents the boxed word.
+     */
+    uint64_t word;
+} CloxValue_t;
+
+#   ifndef CLOX_VALUE_NAN_BOX_QNAN
+/**
+ * @brief       This constant represents the bits set in each boxed value
+ *              which is not a real.
+ */
+#       define CLOX_VALUE_NAN_BOX_QNAN      UINT64_C(0x7FFC000000000000)
+#   endif
+
+#   ifndef CLOX_VALUE_NAN_BOX_NAN
+/**
+ * @brief       This constant represents the canonical NaN real, to which
+ *              each NaN real is normalized to not be confused with other
+ *              boxed types.
+ */
+#       define CLOX_VALUE_NAN_BOX_NAN       UINT64_C(0x7FF8000000000000)
+#   endif
+
+#   ifndef CLOX_VALUE_NAN_BOX_PAYLOAD
+/**
+ * @brief       This constant represents the mask of the payload bits of a
+ *              boxed value.
+ */
+#       define CLOX_VALUE_NAN_BOX_PAYLOAD   UINT64_C(0x0000FFFFFFFFFFFF)
+#   endif
+
+/**
+ * @brief       This function boxes a payload of the specified type.
+ * 
+ * @param       valueType The value type of the payload, it must not be
+ *              CLOX_VALUE_TYPE_REAL.
+ * @param       payload The payload, truncated to 48 bits.
+ * @return      The boxed value.
+ */
+CLOX_INLINE CloxValue_t CLOX_STDCALL cloxNaNBox(const CloxValueType_t valueType, const uint64_t payload)
+{
+    return (CloxValue_t) {
+        .word = CLOX_VALUE_NAN_BOX_QNAN
+              | (((uint64_t)valueType & 0x04) << 61)
+              | (((uint64_t)valueType & 0x03) << 48)
+              | (payload & CLOX_VALUE_NAN_BOX_PAYLOAD),
+    };
+}
+
+/**
+ * @brief       This function boxes a real value.
+ * 
+ * @param       real The real value to box.
+ * @return      The boxed value.
+ */
+CLOX_INLINE CloxValue_t CLOX_STDCALL cloxNaNBoxReal(const real_t real)
+{
+    CloxValue_t value;
+
+    if (real != real)
+        value.word = CLOX_VALUE_NAN_BOX_NAN;
+    else
+        memcpy(&value.word, &real, sizeof(real));
+
+    return value;
+}
+
+/**
+ * @brief       This function unboxes a real value.
+ * 
+ * @param       value The boxed value, it must be a real.
+ * @return      The real value.
+ */
+CLOX_INLINE real_t CLOX_STDCALL cloxNaNUnboxReal(const CloxValue_t value)
+{
+    real_t real;
+
+    memcpy(&real, &value.word, sizeof(real));
+
+    return real;
+}
+
+/**
+ * @brief       This function gets the type of a boxed value.
+ * 
+ * @param       value The boxed value.
+ * @return      The value type.
+ */
+CLOX_INLINE CloxValueType_t CLOX_STDCALL cloxNaNBoxType(const CloxValue_t value)
+{
+    static const CloxValueType_t valueTypes[] = {
+        CLOX_VALUE_TYPE_VOID, CLOX_VALUE_TYPE_BOOL, CLOX_VALUE_TYPE_BYTE, CLOX_VALUE_TYPE_UINT,
+        CLOX_VALUE_TYPE_SINT, CLOX_VALUE_TYPE_VOID, CLOX_VALUE_TYPE_VPTR, CLOX_VALUE_TYPE_OBJT,
+    };
+
+    if ((value.word & CLOX_VALUE_NAN_BOX_QNAN) != CLOX_VALUE_NAN_BOX_QNAN)
+        return CLOX_VALUE_TYPE_REAL;
+
+    return valueTypes[((value.word >> 61) & 0x04) | ((value.word >> 48) & 0x03)];
+}
+
+/**
+ * @brief       This function gets the size (in bytes) of the data of a boxed
+ *              value.
+ * 
+ * @param       value The boxed value.
+ * @return      The value size.
+ */
+CLOX_INLINE CloxValueSize_t CLOX_STDCALL cloxNaNBoxSize(const CloxValue_t value)
+{
+    switch (cloxNaNBoxType(value))
+    {
+    case CLOX_VALUE_TYPE_BOOL:
+        return sizeof(bool_t);
+
+    case CLOX_VALUE_TYPE_BYTE:
+        return sizeof(byte_t);
+
+    case CLOX_VALUE_TYPE_UINT:
+        return sizeof(uint_t);
+
+    case CLOX_VALUE_TYPE_SINT:
+        return sizeof(sint_t);
+
+    case CLOX_VALUE_TYPE_REAL:
+        return sizeof(real_t);
+
+    case CLOX_VALUE_TYPE_VPTR:
+    case CLOX_VALUE_TYPE_OBJT:
+        return sizeof(vptr_t);
+
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief       This function boxes a value data of the specified type.
+ * 
+ * @param       valueType The value type of the data.
+ * @param       valueData The value data to box.
+ * @return      The boxed value.
+ */
+CLOX_INLINE CloxValue_t CLOX_STDCALL cloxNaNBoxData(const CloxValueType_t valueType, const CloxValueData_t valueData)
+{
+    switch (valueType)
+    {
+    case CLOX_VALUE_TYPE_BOOL:
+        return cloxNaNBox(valueType, asBool(valueData.Bool));
+
+    case CLOX_VALUE_TYPE_BYTE:
+        return cloxNaNBox(valueType, valueData.byte);
+
+    case CLOX_VALUE_TYPE_UINT:
+        return cloxNaNBox(valueType, valueData.uInt);
+
+    case CLOX_VALUE_TYPE_SINT:
+        return cloxNaNBox(valueType, (uint32_t)valueData.sInt);
+
+    case CLOX_VALUE_TYPE_REAL:
+        return cloxNaNBoxReal(valueData.real);
+
+    case CLOX_VALUE_TYPE_VPTR:
+    case CLOX_VALUE_TYPE_OBJT:
+        return cloxNaNBox(valueType, valueData.iPtr);
+
+    default:
+        return cloxNaNBox(CLOX_VALUE_TYPE_VOID, 0);
+    }
+}
+#else
 /**
  * @brief       This data structure provides a container in which store
  *              values during execution and compilation.
@@ -487,23 +763,195 @@ typedef struct _CloxValue
      */
     CloxValueData_t data;
 } CloxValue_t;
+#endif
 
-#ifndef cloxValue
-#   define cloxValue(valueType, valueData) \
-    (CloxValue_t) {                        \
-        .type = (valueType),               \
-        .size = sizeof(valueData),         \
-        .data = (valueData),               \
+#if CLOX_VALUE_NAN_BOXING
+#   ifndef cloxValue
+#       define cloxValue(valueType, valueData) cloxNaNBoxData((valueType), (valueData))
+#   endif
+
+#   ifndef cloxValueWithSize
+#       define cloxValueWithSize(valueType, valueSize, valueData) cloxNaNBoxData((valueType), (valueData))
+#   endif
+#else
+#   ifndef cloxValue
+#       define cloxValue(valueType, valueData) \
+    (CloxValue_t) {                            \
+        .type = (valueType),                   \
+        .size = sizeof(valueData),             \
+        .data = (valueData),                   \
     }
-#endif
+#   endif
 
-#ifndef cloxValueWithSize
-#   define cloxValueWithSize(valueType, valueSize, valueData) \
-    (CloxValue_t) {                                           \
-        .type = (valueType),                                  \
-        .size = (valueSize),                                  \
-        .data = (valueData),                                  \
+#   ifndef cloxValueWithSize
+#       define cloxValueWithSize(valueType, valueSize, valueData) \
+    (CloxValue_t) {                                               \
+        .type = (valueType),                                      \
+        .size = (valueSize),                                      \
+        .data = (valueData),                                      \
     }
+#   endif
+#endif
+
+/**
+ * @defgroup    VALUE_ACCESSORS Value Accessors
+ * 
+ *              These macros read the type, the size and the data of a value
+ *              independently from its representation, so they must be used
+ *              in place of structure fields.
+ * @{
+ */
+
+#if CLOX_VALUE_NAN_BOXING
+#   ifndef cloxValueType
+#       define cloxValueType(value)   cloxNaNBoxType((value))
+#   endif
+
+#   ifndef cloxValueSize
+#       define cloxValueSize(value)   cloxNaNBoxSize((value))
+#   endif
+
+#   ifndef cloxValueAsBool
+#       define cloxValueAsBool(value) asBool((value).word & 1)
+#   endif
+
+#   ifndef cloxValueAsByte
+#       define cloxValueAsByte(value) ((byte_t)(value).word)
+#   endif
+
+#   ifndef cloxValueAsUInt
+#       define cloxValueAsUInt(value) ((uint_t)(uint32_t)(value).word)
+#   endif
+
+#   ifndef cloxValueAsSInt
+#       define cloxValueAsSInt(value) ((sint_t)(int32_t)(uint32_t)(value).word)
+#   endif
+
+#   ifndef cloxValueAsReal
+#       define cloxValueAsReal(value) cloxNaNUnboxReal((value))
+#   endif
+
+#   ifndef cloxValueAsIPtr
+#       define cloxValueAsIPtr(value) ((iptr_t)((value).word & CLOX_VALUE_NAN_BOX_PAYLOAD))
+#   endif
+
+#   ifndef cloxValueAsVPtr
+#       define cloxValueAsVPtr(value) ((vptr_t)cloxValueAsIPtr(value))
+#   endif
+
+#   ifndef cloxValueAsObjt
+#       define cloxValueAsObjt(value) ((vptr_t)cloxValueAsIPtr(value))
+#   endif
+#else
+#   ifndef cloxValueType
+#       define cloxValueType(value)   ((value).type)
+#   endif
+
+#   ifndef cloxValueSize
+#       define cloxValueSize(value)   ((value).size)
+#   endif
+
+#   ifndef cloxValueAsBool
+#       define cloxValueAsBool(value) ((value).data.Bool)
+#   endif
+
+#   ifndef cloxValueAsByte
+#       define cloxValueAsByte(value) ((value).data.byte)
+#   endif
+
+#   ifndef cloxValueAsUInt
+#       define cloxValueAsUInt(value) ((value).data.uInt)
+#   endif
+
+#   ifndef cloxValueAsSInt
+#       define cloxValueAsSInt(value) ((value).data.sInt)
+#   endif
+
+#   ifndef cloxValueAsReal
+#       define cloxValueAsReal(value) ((value).data.real)
+#   endif
+
+#   ifndef cloxValueAsIPtr
+#       define cloxValueAsIPtr(value) ((value).data.iPtr)
+#   endif
+
+#   ifndef cloxValueAsVPtr
+#       define cloxValueAsVPtr(value) ((value).data.vPtr)
+#   endif
+
+#   ifndef cloxValueAsObjt
+#       define cloxValueAsObjt(value) ((value).data.vPtr)
+#   endif
+#endif
+
+/**
+ * @}
+ */
+
+#if CLOX_VALUE_NAN_BOXING
+#   ifndef cloxVoidValue
+#       define cloxVoidValue()      cloxNaNBox(CLOX_VALUE_TYPE_VOID, 0)
+#   endif
+
+#   ifndef cloxBoolValue
+#       define cloxBoolValue(value) cloxNaNBox(CLOX_VALUE_TYPE_BOOL, asBool(value))
+#   endif
+
+#   ifndef cloxByteValue
+#       define cloxByteValue(value) cloxNaNBox(CLOX_VALUE_TYPE_BYTE, (byte_t)(value))
+#   endif
+
+#   ifndef cloxUIntValue
+#       define cloxUIntValue(value) cloxNaNBox(CLOX_VALUE_TYPE_UINT, (uint32_t)(value))
+#   endif
+
+#   ifndef cloxSIntValue
+#       define cloxSIntValue(value) cloxNaNBox(CLOX_VALUE_TYPE_SINT, (uint32_t)(sint_t)(value))
+#   endif
+
+#   ifndef cloxRealValue
+#       define cloxRealValue(value) cloxNaNBoxReal((real_t)(value))
+#   endif
+
+#   ifndef cloxVPtrValue
+#       define cloxVPtrValue(value) cloxNaNBox(CLOX_VALUE_TYPE_VPTR, (iptr_t)(vptr_t)(value))
+#   endif
+
+#   ifndef cloxObjtValue
+#       define cloxObjtValue(value) cloxNaNBox(CLOX_VALUE_TYPE_OBJT, (iptr_t)(vptr_t)(value))
+#   endif
+#else
+#   ifndef cloxVoidValue
+#       define cloxVoidValue()      cloxValueWithSize(CLOX_VALUE_TYPE_VOID, 0, cloxVPtrValueData(CLOX_VPTR_NULL))
+#   endif
+
+#   ifndef cloxBoolValue
+#       define cloxBoolValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_BOOL, sizeof(bool_t), cloxBoolValueData(value))
+#   endif
+
+#   ifndef cloxByteValue
+#       define cloxByteValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_BYTE, sizeof(byte_t), cloxByteValueData(value))
+#   endif
+
+#   ifndef cloxUIntValue
+#       define cloxUIntValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_UINT, sizeof(uint_t), cloxUIntValueData(value))
+#   endif
+
+#   ifndef cloxSIntValue
+#       define cloxSIntValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_SINT, sizeof(sint_t), cloxSIntValueData(value))
+#   endif
+
+#   ifndef cloxRealValue
+#       define cloxRealValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_REAL, sizeof(real_t), cloxRealValueData(value))
+#   endif
+
+#   ifndef cloxVPtrValue
+#       define cloxVPtrValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_VPTR, sizeof(vptr_t), cloxVPtrValueData(value))
+#   endif
+
+#   ifndef cloxObjtValue
+#       define cloxObjtValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_OBJT, sizeof(vptr_t), cloxVPtrValueData((vptr_t)(value)))
+#   endif
 #endif
 
 /**
@@ -524,9 +972,12 @@ CLOX_INLINE CloxValue_t *CLOX_STDCALL cloxInitValue(CloxValue_t *const value, co
 {
     assert(value != NULL);
 
-    value->type = valueType;
-    value->size = valueSize;
-    value->data = valueData;
+#if CLOX_VALUE_NAN_BOXING
+    /* the size follows from the type of a boxed value */
+    (void)valueSize;
+#endif
+
+    *value = cloxValueWithSize(valueType, valueSize, valueData);
 
     return value;
 }
@@ -534,8 +985,8 @@ CLOX_INLINE CloxValue_t *CLOX_STDCALL cloxInitValue(CloxValue_t *const value, co
  * @brief       This function releases resources used by a specified instance of
  *              CloxValue_t type.
  * 
- * @note        Currently this function doesn't do its work, it will be done when
- *              objects will be implemented.
+ * @note        Objects are owned by the garbage collector of their heap, so
+ *              this function only drops the reference.
  * 
  * @param       value A pointer to the CloxValue_t instance to free.
  * @return      On success this function returns a pointer to the initialized
@@ -545,36 +996,11 @@ CLOX_INLINE CloxValue_t *CLOX_STDCALL cloxFreeValue(CloxValue_t *const value)
 {
     assert(value != NULL);
 
-    value->type = CLOX_VALUE_TYPE_VOID;
-    value->data.vPtr = CLOX_VPTR_NULL;
+    *value = cloxVoidValue();
 
     return value;
 }
 
-#ifndef cloxBoolValue
-#   define cloxBoolValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_BOOL, sizeof(bool_t), cloxBoolValueData(value))
-#endif
-
-#ifndef cloxByteValue
-#   define cloxByteValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_BYTE, sizeof(byte_t), cloxByteValueData(value))
-#endif
-
-#ifndef cloxUIntValue
-#   define cloxUIntValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_UINT, sizeof(uint_t), cloxUIntValueData(value))
-#endif
-
-#ifndef cloxSIntValue
-#   define cloxSIntValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_SINT, sizeof(sint_t), cloxSIntValueData(value))
-#endif
-
-#ifndef cloxRealValue
-#   define cloxRealValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_REAL, sizeof(real_t), cloxRealValueData(value))
-#endif
-
-#ifndef cloxVPtrValue
-#   define cloxVPtrValue(value) cloxValueWithSize(CLOX_VALUE_TYPE_VPTR, sizeof(vptr_t), cloxVPtrValueData(value))
-#endif
-
 /**
  * @brief       This function dumps a textual (and programmer friendly)
  *              representation of the specified instance of CloxValue_t type
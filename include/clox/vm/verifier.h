@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+ * @file        verifier.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the verifier of blocks, which proves
+ *              once that a block (compiled or loaded from an image) is well
+ *              formed, so that the interpreter of decoded blocks can skip the
+ *              checks of the evaluation stack.
+ *
+ *              The verifier splits the block into procedures, the beginning of
+ *              the block and the targets of the calls, and follows each one
+ *              from its entry tracking the depth of the evaluation stack
+ *              relative to it. A procedure is summarized by the number of
+ *              values below its entry it reads (its arguments) and by the depth
+ *              at its returns, which a call adds to the depth of the caller.
+ */
+
+#ifndef CLOX_VM_VERIFIER_H_
+#define CLOX_VM_VERIFIER_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/bool.h"
+
+#include "clox/vm/code_block.h"
+
+#ifndef CLOX_VERIFIER_DEPTH_UNKNOWN
+/**
+ * @brief       This constant represents the depth stored for the instructions
+ *              that are not part of the top-level code of a verified block
+ *              (they belong to a procedure, or they are never executed).
+ */
+#   define CLOX_VERIFIER_DEPTH_UNKNOWN INT32_MIN
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    VERIFIER Verifier
+ * @{
+ */
+
+#pragma region Verifier
+
+/**
+ * @brief       This function verifies the specified block: it proves that its
+ *              opcodes are known and its instructions are not truncated, that
+ *              the constants, the names and the inline cache slots referenced
+ *              by its operands exist, that its jumps and calls target an
+ *              instruction, and that the evaluation stack never underflows,
+ *              starting empty at the beginning of the block. On success the
+ *              depth of the evaluation stack before each instruction of the
+ *              top-level code is stored into the block (see the depths field of
+ *              CloxCodeBlock_t) until its bytecode is modified.
+ *
+ * @note        The depths of the procedures are relative to their entry, so
+ *              the paths reaching an instruction of the same procedure must
+ *              agree on the depth, and a procedure must return always the same
+ *              number of values: blocks that don't follow this discipline (or
+ *              whose code is shared by several procedures) are not verified.
+ *              The checks that depend on the state of the virtual machine (the
+ *              stack overflow, the register windows and the call frames) are
+ *              not proven and stay at run-time.
+ *              A frozen block is verified only if it was verified before being
+ *              frozen.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to verify.
+ * @return      TRUE if the block is verified, otherwise FALSE.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxCodeBlockVerify(CloxCodeBlock_t *const codeBlock);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_VERIFIER_H_ */
@@ -0,0 +1,746 @@
+#pragma once
+
+/**
+ * @file        vm.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header are defined the virtual machine data structure
+ *              and the functions to execute blocks of bytecode.
+ */
+
+#ifndef CLOX_VM_VM_H_
+#define CLOX_VM_VM_H_
+
+#include "clox/base/api.h"
+#include "clox/base/bits.h"
+#include "clox/base/byte.h"
+#include "clox/base/dload.h"
+#include "clox/base/intern.h"
+
+#include "clox/vm/code.h"
+#include "clox/vm/code_block.h"
+#include "clox/vm/heap.h"
+#include "clox/vm/profiler.h"
+#include "clox/vm/shape.h"
+#include "clox/vm/table.h"
+#include "clox/vm/trace.h"
+#include "clox/vm/value.h"
+
+#ifndef CLOX_VM_REGISTERS_COUNT
+/**
+ * @brief       This constant represents the number of registers addressable
+ *              with a single byte operand, so the maximum size of a register
+ *              window (and the size of the outermost one).
+ */
+#   define CLOX_VM_REGISTERS_COUNT (BYTE_MAX + 1)
+#endif
+
+#ifndef CLOX_VM_REGISTER_FILE_SIZE
+/**
+ * @brief       This constant represents the default number of registers of the
+ *              register file, from which register windows are taken (the file
+ *              grows by as many registers when a window doesn't fit).
+ */
+#   define CLOX_VM_REGISTER_FILE_SIZE (CLOX_VM_REGISTERS_COUNT * 16)
+#endif
+
+#ifndef CLOX_VM_REGISTER_FILE_MAX
+/**
+ * @brief       This constant represents the maximum number of registers of the
+ *              register file.
+ */
+#   define CLOX_VM_REGISTER_FILE_MAX (CLOX_VM_REGISTER_FILE_SIZE * 256)
+#endif
+
+#ifndef CLOX_VM_WINDOWS_COUNT
+/**
+ * @brief       This constant represents the maximum number of nested register
+ *              windows.
+ */
+#   define CLOX_VM_WINDOWS_COUNT 65536
+#endif
+
+#ifndef CLOX_VM_FRAMES_COUNT
+/**
+ * @brief       This constant represents the maximum number of nested calls.
+ */
+#   define CLOX_VM_FRAMES_COUNT 65536
+#endif
+
+#ifndef CLOX_VM_FRAMES_CHUNK
+/**
+ * @brief       This constant represents the number of entries by which the
+ *              stacks of the saved windows and of the call frames grow, so
+ *              that calls never allocate until a new depth is reached.
+ */
+#   define CLOX_VM_FRAMES_CHUNK 64
+#endif
+
+#ifndef CLOX_VM_JIT_THRESHOLD
+/**
+ * @brief       This constant represents the number of backward jumps and calls
+ *              targeting a record after which the JIT tier compiles the region
+ *              starting there (see CLOX_VM_JIT).
+ */
+#   define CLOX_VM_JIT_THRESHOLD 1000
+#endif
+
+#ifndef CLOX_VM_JIT_REGION_SIZE
+/**
+ * @brief       This constant represents the maximum number of records of a
+ *              compiled region.
+ */
+#   define CLOX_VM_JIT_REGION_SIZE 1024
+#endif
+
+#ifndef CLOX_VM_STACK_SIZE
+/**
+ * @brief       This constant represents the default number of values that the
+ *              evaluation stack of a new virtual machine can store.
+ */
+#   define CLOX_VM_STACK_SIZE 1024
+#endif
+
+#ifndef CLOX_VM_CACHE_SHAPES
+/**
+ * @brief       This constant represents the number of shapes that the inline
+ *              cache slot of a property instruction remembers, the sites that
+ *              see more shapes (megamorphic) look up the names each time.
+ */
+#   define CLOX_VM_CACHE_SHAPES 4
+#endif
+
+CLOX_C_HEADER_BEGIN
+
+/**
+ * @defgroup    VM Virtual Machine
+ * @{
+ */
+
+#pragma region Virtual Machine
+
+/**
+ * @brief       This enumeration provides the statuses in which the virtual
+ *              machine can be left after the execution of a block of bytecode.
+ */
+typedef enum _CloxVMStatus
+{
+    /**
+     * @brief   The execution has been completed, reaching the end of the
+     *          block or an 'exit' instruction.
+     */
+    CLOX_VM_STATUS_SUCCESS = 0x00,
+    /**
+     * @brief   The execution has been suspended by a 'break' instruction,
+     *          it can be resumed with cloxVMResume function.
+     */
+    CLOX_VM_STATUS_BREAK   = 0x01,
+    /**
+     * @brief   The execution has been suspended by a 'raise' instruction,
+     *          it can be resumed with cloxVMResume function.
+     */
+    CLOX_VM_STATUS_RAISE   = 0x02,
+    /**
+     * @brief   The execution has been terminated by an 'abort' instruction.
+     */
+    CLOX_VM_STATUS_ABORT   = 0x03,
+    /**
+     * @brief   The execution has been terminated by a runtime error, the
+     *          error message is stored into the virtual machine.
+     */
+    CLOX_VM_STATUS_ERROR   = 0x04,
+    /**
+     * @brief   The execution has been suspended by a native function after it
+     *          returned (see cloxVMYield), it can be resumed with cloxVMResume
+     *          function.
+     */
+    CLOX_VM_STATUS_YIELD   = 0x05,
+} CloxVMStatus_t;
+
+/**
+ * @brief       This data structure provides a saved register window, so the
+ *              registers range used by the instructions before an 'ent'.
+ */
+typedef struct _CloxVMWindow
+{
+    /**
+     * @brief   The index in the register file of the first register of the
+     *          window.
+     */
+    size_t base;
+    /**
+     * @brief   The number of registers of the window.
+     */
+    size_t size;
+} CloxVMWindow_t;
+
+/**
+ * @brief       This data structure provides a call frame, pushed by 'call' and
+ *              popped by 'ret'.
+ */
+typedef struct _CloxVMFrame
+{
+    /**
+     * @brief   The offset in the bytecode of the instruction next to the call.
+     */
+    size_t returnOffset;
+    /**
+     * @brief   The index of the decoded record of that instruction, or
+     *          SIZE_MAX when the call has been executed on the bytecode.
+     */
+    size_t returnRecord;
+    /**
+     * @brief   The number of saved windows when the frame has been pushed, so
+     *          the window of the caller is the current one at that depth.
+     */
+    size_t windowsCount;
+} CloxVMFrame_t;
+
+#ifndef CLOX_VM_NATIVE_VARIADIC
+/**
+ * @brief       This constant represents the arity of the native functions that
+ *              accept any number of arguments.
+ */
+#   define CLOX_VM_NATIVE_VARIADIC SIZE_MAX
+#endif
+
+struct _CloxVM;
+struct _CloxFiber;
+
+/**
+ * @brief       This datatype represents a native function, called by 'ncall'
+ *              on the arguments left on the evaluation stack: they are passed
+ *              in place, the first one is replaced by the result (a single
+ *              void value is passed to functions without arguments).
+ *
+ * @param       vm A pointer to the calling virtual machine.
+ * @param       arguments A pointer to the first argument.
+ * @param       count The number of arguments.
+ * @return      NULL on success, otherwise the message of the runtime error (or
+ *              the value returned by cloxVMYield, to suspend the execution).
+ */
+typedef const char *(CLOX_STDCALL *CloxVMNativeFunction_t)(struct _CloxVM *const vm, CloxValue_t *const arguments, const size_t count);
+
+/**
+ * @brief       This data structure provides a native function bound to the
+ *              virtual machine.
+ */
+typedef struct _CloxVMNative
+{
+    /**
+     * @brief   A pointer to the function, resolved when it has been bound.
+     */
+    CloxVMNativeFunction_t function;
+    /**
+     * @brief   The number of arguments of the function, or
+     *          CLOX_VM_NATIVE_VARIADIC.
+     */
+    size_t                 arity;
+    /**
+     * @brief   The handle of the shared library from which the function has
+     *          been imported, NULL for functions of the host.
+     */
+    handle_t               module;
+} CloxVMNative_t;
+
+/**
+ * @brief       This data structure provides an entry of the inline cache slot
+ *              of a property instruction, bound to a shape.
+ */
+typedef struct _CloxVMShapeCache
+{
+    /**
+     * @brief   A pointer to the shape of the instances to which the entry
+     *          applies.
+     */
+    const CloxShape_t *shape;
+    /**
+     * @brief   A pointer to the shape of the instances after a store: the same
+     *          shape, or the one reached adding the property.
+     */
+    const CloxShape_t *target;
+    /**
+     * @brief   The index of the property.
+     */
+    size_t             index;
+} CloxVMShapeCache_t;
+
+/**
+ * @brief       This data structure provides an inline cache slot of a global
+ *              (or native call) instruction, which remembers the entry of the
+ *              variable (or the function), or of a property instruction, which
+ *              remembers the index of the property in the shapes seen.
+ */
+typedef struct _CloxVMCache
+{
+    /**
+     * @brief   The interned name of the variable, or NULL until the first
+     *          execution of the instruction.
+     */
+    const CloxString_t   *key;
+    /**
+     * @brief   A pointer to the entry of the variable in the globals table
+     *          (or of the function in the natives table).
+     */
+    CloxTableEntry_t     *entry;
+    /**
+     * @brief   A pointer to the native function, for native calls (and the last
+     *          method called, for method calls).
+     */
+    const CloxVMNative_t *native;
+    /**
+     * @brief   The epoch of the table at which the entry has been found, the
+     *          slot is valid while the epoch doesn't change (zero never
+     *          matches).
+     */
+    uint32_t              epoch;
+    /**
+     * @brief   The number of shapes seen by a property instruction, the first
+     *          entry is the one of the monomorphic sites.
+     */
+    uint32_t              shapesCount;
+    /**
+     * @brief   The entries of the shapes seen by a property instruction.
+     */
+    CloxVMShapeCache_t    shapes[CLOX_VM_CACHE_SHAPES];
+} CloxVMCache_t;
+
+/**
+ * @brief       This data structure provides the state of a virtual machine,
+ *              the registers, the evaluation stack and the flags on which
+ *              instructions operate.
+ *
+ * @note        A virtual machine is an isolate: its stacks, heap, strings,
+ *              globals, natives and inline caches are its own, so virtual
+ *              machines can run on different threads without locks. The only
+ *              data they can share are the code blocks frozen by cloxVMFreeze.
+ */
+typedef struct _CloxVM
+{
+    /**
+     * @brief   A pointer to the first register of the register file.
+     */
+    CloxValue_t           *registers;
+    /**
+     * @brief   The number of registers of the register file.
+     */
+    size_t                 registersSize;
+    /**
+     * @brief   A pointer to the first register of the current window, the
+     *          register operands of instructions are relative to it.
+     */
+    CloxValue_t           *window;
+    /**
+     * @brief   The number of registers of the current window.
+     */
+    size_t                 windowSize;
+    /**
+     * @brief   A pointer to the first saved window.
+     */
+    CloxVMWindow_t        *windows;
+    /**
+     * @brief   The number of saved windows, so the nesting level of the
+     *          current one.
+     */
+    size_t                 windowsCount;
+    /**
+     * @brief   The number of windows that can be saved without growing the
+     *          stack of the saved windows.
+     */
+    size_t                 windowsCapacity;
+    /**
+     * @brief   A pointer to the first call frame.
+     */
+    CloxVMFrame_t         *frames;
+    /**
+     * @brief   The number of call frames, so the depth of the current call.
+     */
+    size_t                 framesCount;
+    /**
+     * @brief   The number of call frames that can be pushed without growing
+     *          their stack.
+     */
+    size_t                 framesCapacity;
+    /**
+     * @brief   A pointer to the first value of the evaluation stack.
+     */
+    CloxValue_t           *stack;
+    /**
+     * @brief   A pointer to the value next to the top of the evaluation
+     *          stack.
+     */
+    CloxValue_t           *stackTop;
+    /**
+     * @brief   The number of values that the evaluation stack can store.
+     */
+    size_t                 stackSize;
+    /**
+     * @brief   The maximum number of values of the evaluation stack, which
+     *          grows (doubling its size) up to this limit when it is full.
+     *          It is stackSize for the stack of the virtual machine, which
+     *          never grows, larger for the ones of the fibers.
+     */
+    size_t                 stackLimit;
+    /**
+     * @brief   A pointer to the block of bytecode in execution.
+     */
+    const CloxCodeBlock_t *codeBlock;
+    /**
+     * @brief   A pointer to the next instruction to execute.
+     */
+    const byte_t          *ip;
+    /**
+     * @brief   The comparison flag (CF), set by 'cmp' instruction.
+     */
+    byte_t                 cf;
+    /**
+     * @brief   The zero flag (ZF), set by 'tst' instruction.
+     */
+    byte_t                 zf;
+    /**
+     * @brief   The status in which the last execution has left the virtual
+     *          machine.
+     */
+    CloxVMStatus_t         status;
+    /**
+     * @brief   The termination code set by 'exit' instruction.
+     */
+    int                    exitCode;
+    /**
+     * @brief   The signal sent by the last 'raise' instruction.
+     */
+    int                    signal;
+    /**
+     * @brief   The message of the last runtime error, or NULL.
+     */
+    const char            *error;
+    /**
+     * @brief   The table in which the virtual machine interns its strings
+     *          (names and literals), shared by all the code blocks it runs.
+     */
+    CloxStringTable_t      strings;
+    /**
+     * @brief   The global variables, keyed by names interned into strings.
+     */
+    CloxTable_t            globals;
+    /**
+     * @brief   The native functions, keyed by names interned into strings, the
+     *          values point to their CloxVMNative_t records.
+     */
+    CloxTable_t            natives;
+    /**
+     * @brief   The shapes of the instances of the heap.
+     */
+    CloxShapeTree_t        shapes;
+    /**
+     * @brief   A pointer to the inline cache slots of the code block in
+     *          execution, reset by each run.
+     */
+    CloxVMCache_t         *caches;
+    /**
+     * @brief   The number of allocated inline cache slots.
+     */
+    size_t                 cachesCapacity;
+    /**
+     * @brief   The managed heap, whose roots are the registers, the evaluation
+     *          stack, the global variables and the constants of the code block
+     *          in execution.
+     */
+    CloxHeap_t             heap;
+    /**
+     * @brief   A pointer to the profiler that samples the executions, NULL
+     *          when they are not profiled. The host sets it (and keeps the
+     *          profiler alive) between the runs.
+     */
+    CloxProfiler_t        *profiler;
+    /**
+     * @brief   A pointer to the trace that records the executed instructions,
+     *          NULL when they are not traced. Like the profiler, the host sets
+     *          it between the runs (it is ignored when CLOX_VM_TRACE is 0).
+     */
+    CloxTrace_t           *trace;
+    /**
+     * @brief   A pointer to the fiber whose execution context is in the
+     *          virtual machine, or NULL when it has its own one.
+     */
+    struct _CloxFiber     *fiber;
+    /**
+     * @brief   A pointer to the first of the fibers of the virtual machine,
+     *          the values of the contexts saved into them are roots of the
+     *          heap.
+     */
+    struct _CloxFiber     *fibers;
+#if CLOX_VM_OPCODE_STATS
+    /**
+     * @brief   A pointer to the execution counters of each opcode (indexed by
+     *          opcode).
+     */
+    CloxOpCodeStats_t     *opCodeStats;
+#endif
+} CloxVM_t;
+
+/**
+ * @brief       This function initializes a CloxVM_t data structure allocating
+ *              an evaluation stack with as values as specified by stackSize
+ *              parameter and a register file of CLOX_VM_REGISTER_FILE_SIZE
+ *              registers.
+ *
+ * @param       vm A pointer to the CloxVM_t instance to initialize.
+ * @param       stackSize The number of values of the evaluation stack, when
+ *              zero CLOX_VM_STACK_SIZE is used.
+ * @return      On success this function returns a pointer to the initialized
+ *              virtual machine (so the value of vm parameter).
+ */
+CLOX_API CloxVM_t *CLOX_STDCALL cloxInitVM(CloxVM_t *const vm, size_t stackSize);
+/**
+ * @brief       This function releases resources used by a CloxVM_t instance
+ *              without deleting it.
+ *
+ * @param       vm A pointer to the CloxVM_t instance to free.
+ * @return      On success this function returns a pointer to the freed virtual
+ *              machine (so the value of vm parameter).
+ */
+CLOX_API CloxVM_t *CLOX_STDCALL cloxFreeVM(CloxVM_t *const vm);
+
+/**
+ * @brief       This function allocates a new CloxVM_t instance on the heap and
+ *              initializes it with the specified stack size.
+ *
+ * @param       stackSize The number of values of the evaluation stack, when
+ *              zero CLOX_VM_STACK_SIZE is used.
+ * @return      On success this function returns a pointer to the just allocated
+ *              CloxVM_t instance.
+ */
+CLOX_API CloxVM_t *CLOX_STDCALL cloxCreateVM(size_t stackSize);
+
+/**
+ * @brief       This function executes the specified block of bytecode from its
+ *              first instruction, resetting the evaluation stack, the register
+ *              windows, the call frames and the flags of the virtual machine.
+ *
+ * @note        Blocks decoded by cloxVMDecode are executed on their records,
+ *              the other ones on their bytecode.
+ *
+ * @param       vm A pointer to the CloxVM_t instance on which execute.
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to execute.
+ * @return      The status in which the execution has left the virtual machine.
+ */
+CLOX_API CloxVMStatus_t CLOX_STDCALL cloxVMRun(CloxVM_t *const vm, const CloxCodeBlock_t *const codeBlock);
+/**
+ * @brief       This function resumes an execution suspended by a 'break' or a
+ *              'raise' instruction, or by a native function.
+ *
+ * @param       vm A pointer to the CloxVM_t instance to resume.
+ * @return      The status in which the execution has left the virtual machine,
+ *              if the execution was not suspended the current status is returned.
+ */
+CLOX_API CloxVMStatus_t CLOX_STDCALL cloxVMResume(CloxVM_t *const vm);
+
+/**
+ * @brief       This function pre-decodes the specified block for the virtual
+ *              machine (see cloxCodeBlockDecode), so that the following runs
+ *              dispatch its records directly to their handlers, without
+ *              decoding the operands nor checking the bounds of the bytecode.
+ *              The block is also verified (see cloxCodeBlockVerify), so that
+ *              its top-level code runs without checking the stack underflow.
+ *              The decoded form is kept until the block is modified.
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to decode.
+ * @return      TRUE if the block is decoded, FALSE if it will be executed on
+ *              its bytecode.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxVMDecode(CloxCodeBlock_t *const codeBlock);
+/**
+ * @brief       This function decodes the specified block for the virtual
+ *              machine (see cloxVMDecode), then freezes it (see
+ *              cloxCodeBlockFreeze): from then on it can be run by any number
+ *              of virtual machines at the same time, on as many threads, while
+ *              its bytecode, constants and records are stored once.
+ *
+ * @note        The hot counters and the compiled regions of the JIT tier, and
+ *              the opcodes and handlers of the quickened records, are the only
+ *              data of a frozen block written by the runs, they are updated
+ *              atomically (the first virtual machine to reach the threshold of
+ *              a record compiles its region for all of them, the first to run a
+ *              record quickens it).
+ *
+ * @param       codeBlock A pointer to the CloxCodeBlock_t instance to freeze.
+ * @return      TRUE if the block is frozen, FALSE if its constants reference
+ *              heap objects.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxVMFreeze(CloxCodeBlock_t *const codeBlock);
+
+/**
+ * @brief       This function pushes a value onto the evaluation stack of the
+ *              specified virtual machine.
+ *
+ * @param       vm A pointer to the CloxVM_t instance on which push.
+ * @param       value The value to push.
+ * @return      On success this function returns a pointer to the pushed value,
+ *              but on failure a fatal error will be raised.
+ *
+ * @exception   Stack overflow
+ */
+CLOX_API CloxValue_t *CLOX_STDCALL cloxVMPush(CloxVM_t *const vm, const CloxValue_t value);
+/**
+ * @brief       This function pops a value from the evaluation stack of the
+ *              specified virtual machine.
+ *
+ * @param       vm A pointer to the CloxVM_t instance from which pop.
+ * @return      On success this function returns the popped value, but on failure
+ *              a fatal error will be raised.
+ *
+ * @exception   Stack underflow
+ */
+CLOX_API CloxValue_t CLOX_STDCALL cloxVMPop(CloxVM_t *const vm);
+
+/**
+ * @brief       This function defines a global variable, or assigns it a new
+ *              value if it is already defined.
+ *
+ * @param       vm A pointer to the CloxVM_t instance.
+ * @param       name The name of the variable.
+ * @param       value The value of the variable.
+ * @return      TRUE if the variable has been defined, FALSE if it was already
+ *              defined.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxVMDefineGlobal(CloxVM_t *const vm, const char *const name, const CloxValue_t value);
+/**
+ * @brief       This function gets a global variable.
+ *
+ * @param       vm A pointer to the CloxVM_t instance.
+ * @param       name The name of the variable.
+ * @return      A pointer to the value of the variable, valid until a global
+ *              variable is defined or removed, or NULL if it is not defined.
+ */
+CLOX_API CloxValue_t *CLOX_STDCALL cloxVMGetGlobal(CloxVM_t *const vm, const char *const name);
+/**
+ * @brief       This function removes a global variable.
+ *
+ * @param       vm A pointer to the CloxVM_t instance.
+ * @param       name The name of the variable.
+ * @return      TRUE if the variable has been removed, FALSE if it was not
+ *              defined.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxVMUndefineGlobal(CloxVM_t *const vm, const char *const name);
+
+/**
+ * @brief       This function defines a native function, or replaces the one
+ *              already defined with the same name.
+ *
+ * @param       vm A pointer to the CloxVM_t instance.
+ * @param       name The name by which scripts call the function.
+ * @param       function A pointer to the function.
+ * @param       arity The number of arguments of the function, or
+ *              CLOX_VM_NATIVE_VARIADIC.
+ * @return      TRUE if the function has been defined, FALSE if it replaced
+ *              another one.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxVMDefineNative(CloxVM_t *const vm, const char *const name, const CloxVMNativeFunction_t function, const size_t arity);
+/**
+ * @brief       This function imports a native function from a shared library,
+ *              resolving its symbol once: the calls go directly to the address
+ *              found. The library stays loaded while the function is defined.
+ *
+ * @param       vm A pointer to the CloxVM_t instance.
+ * @param       name The name by which scripts call the function.
+ * @param       module The path to or the name of the shared library, or NULL
+ *              for the running program.
+ * @param       symbol The name of the function in the library, which must be a
+ *              CloxVMNativeFunction_t.
+ * @param       arity The number of arguments of the function, or
+ *              CLOX_VM_NATIVE_VARIADIC.
+ * @return      TRUE on success, FALSE if the library can't be loaded or the
+ *              symbol is not found.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxVMImportNative(CloxVM_t *const vm, const char *const name, const char *const module, const char *const symbol, const size_t arity);
+/**
+ * @brief       This function gets a native function.
+ *
+ * @param       vm A pointer to the CloxVM_t instance.
+ * @param       name The name of the function.
+ * @return      A pointer to the function, valid while it is defined, or NULL if
+ *              it is not defined.
+ */
+CLOX_API const CloxVMNative_t *CLOX_STDCALL cloxVMGetNative(CloxVM_t *const vm, const char *const name);
+/**
+ * @brief       This function suspends the execution once the native function
+ *              calling it returns: natives return its result, after they store
+ *              their result (or a placeholder for it) into the first argument.
+ *              The execution is left with CLOX_VM_STATUS_YIELD status, and it
+ *              continues after the call with cloxVMResume function.
+ *
+ * @param       vm A pointer to the calling virtual machine.
+ * @return      The value to return from the native function.
+ */
+CLOX_API const char *CLOX_STDCALL cloxVMYield(CloxVM_t *const vm);
+
+/**
+ * @brief       This function evaluates an instruction over constant operands
+ *              as the interpreter would, so that it can be folded: 'add',
+ *              'sub', 'mul' and 'div' store their result into the first
+ *              operand, 'neg' and 'not' replace it (the second one is ignored),
+ *              'cmp' replaces it with the comparison flag (as a BYTE value) and
+ *              'tst' with the zero flag (as a BOOL value).
+ *
+ * @param       opCode The opcode of the instruction.
+ * @param       x A pointer to the first operand, then to the result.
+ * @param       y A pointer to the second operand.
+ * @return      TRUE on success, FALSE if the instruction is not one of the
+ *              above, if the operands are pointers (their values are only known
+ *              at run time) or if the instruction would fail.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxVMEvaluate(const CloxOpCode_t opCode, CloxValue_t *const x, const CloxValue_t *const y);
+
+/**
+ * @brief       This function looks up the source location of the instruction
+ *              executed last, the one that failed after a runtime error.
+ *
+ * @param       vm A pointer to the CloxVM_t instance.
+ * @param       outLocation A pointer to the location to set.
+ * @return      TRUE on success, FALSE if the virtual machine hasn't run a block
+ *              or the block has no line table.
+ */
+CLOX_API bool_t CLOX_STDCALL cloxVMGetLocation(const CloxVM_t *const vm, CloxSourceLocation_t *const outLocation);
+
+/**
+ * @brief       This function copies the execution counters of the opcodes.
+ *
+ * @param       vm A pointer to the CloxVM_t instance.
+ * @param       outStats A pointer to an array of BYTE_MAX + 1 counters, indexed
+ *              by opcode, in which write the snapshot.
+ * @return      TRUE if the counters are recorded, FALSE if CLOX_VM_OPCODE_STATS
+ *              is disabled (then the snapshot is zeroed).
+ */
+CLOX_API bool_t CLOX_STDCALL cloxVMGetOpCodeStats(const CloxVM_t *const vm, CloxOpCodeStats_t *const outStats);
+/**
+ * @brief       This function resets the execution counters of the opcodes.
+ *
+ * @param       vm A pointer to the CloxVM_t instance.
+ */
+CLOX_API void CLOX_STDCALL cloxVMResetOpCodeStats(CloxVM_t *const vm);
+
+/**
+ * @brief       This function deletes a CloxVM_t heap-allocated instance, releasing
+ *              used resources and itself. Use it after cloxCreateVM function.
+ *
+ * @param       vm A pointer to the CloxVM_t instance to delete.
+ */
+CLOX_API void CLOX_STDCALL cloxDeleteVM(CloxVM_t *const vm);
+
+#pragma endregion
+
+/**
+ * @}
+ */
+
+CLOX_C_HEADER_END
+
+#endif /* CLOX_VM_VM_H_ */
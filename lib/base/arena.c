@@ -0,0 +1,207 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/arena.h"
+#include "clox/base/utils.h"
+
+#include <string.h>
+
+#ifndef clox_ArenaAlign
+#   define clox_ArenaAlign(size) alignto((size_t)(size), (size_t)CLOX_ARENA_ALIGNMENT)
+#endif
+
+#ifndef clox_ArenaChunkData
+/* the data of a chunk follows its (aligned) header */
+#   define clox_ArenaChunkData(chunk) ((byte_t *)(chunk) + clox_ArenaAlign(sizeof(CloxArenaChunk_t)))
+#endif
+
+CLOX_INLINE CloxArenaChunk_t *CLOX_STDCALL clox_ArenaNewChunk(CloxArena_t *const arena, const size_t size)
+{
+    CloxArenaChunk_t *chunk;
+
+    if (arena->spare && (arena->spare->size >= size))
+    {
+        chunk = arena->spare;
+        arena->spare = NULL;
+    }
+    else
+    {
+        chunk = (CloxArenaChunk_t *)cmalloc(clox_ArenaAlign(sizeof(CloxArenaChunk_t)) + size);
+        chunk->size = size;
+    }
+
+    chunk->prev = arena->chunk;
+    chunk->used = 0;
+
+    arena->chunk = chunk;
+    arena->chunksCount++;
+
+    return chunk;
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_ArenaReleaseChunk(CloxArena_t *const arena, CloxArenaChunk_t *const chunk)
+{
+    /* only the biggest released chunk is kept, the others go back to the heap */
+    if (!arena->spare)
+    {
+        arena->spare = chunk;
+    }
+    else if (arena->spare->size < chunk->size)
+    {
+        free(arena->spare);
+        arena->spare = chunk;
+    }
+    else
+    {
+        free(chunk);
+    }
+
+    return;
+}
+
+CLOX_API CloxArena_t *CLOX_STDCALL cloxInitArena(CloxArena_t *const arena, size_t chunkSize)
+{
+    assert(arena != NULL);
+
+    arena->chunk       = NULL;
+    arena->spare       = NULL;
+    arena->chunkSize   = clox_ArenaAlign(chunkSize ? chunkSize : CLOX_ARENA_CHUNK_SIZE);
+    arena->chunksCount = 0;
+    arena->allocated   = 0;
+
+    return arena;
+}
+
+CLOX_API CloxArena_t *CLOX_STDCALL cloxFreeArena(CloxArena_t *const arena)
+{
+    assert(arena != NULL);
+
+    CloxArenaChunk_t *chunk = arena->chunk, *prev;
+
+    while (chunk)
+    {
+        prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+
+    if (arena->spare)
+        free(arena->spare);
+
+    arena->chunk       = NULL;
+    arena->spare       = NULL;
+    arena->chunksCount = 0;
+    arena->allocated   = 0;
+
+    return arena;
+}
+
+CLOX_API CloxArena_t *CLOX_STDCALL cloxCreateArena(size_t chunkSize)
+{
+    return cloxInitArena(alloc(CloxArena_t), chunkSize);
+}
+
+CLOX_API void *CLOX_STDCALL cloxArenaAlloc(CloxArena_t *const arena, const size_t size)
+{
+    assert(arena != NULL);
+
+    CLOX_REGISTER const size_t alignedSize = clox_ArenaAlign(max(size, (size_t)1));
+    CloxArenaChunk_t *chunk = arena->chunk;
+
+    if (!chunk || ((chunk->size - chunk->used) < alignedSize))
+        chunk = clox_ArenaNewChunk(arena, max(arena->chunkSize, alignedSize));
+
+    void *const block = clox_ArenaChunkData(chunk) + chunk->used;
+
+    chunk->used      += alignedSize;
+    arena->allocated += alignedSize;
+
+    return block;
+}
+
+CLOX_API void *CLOX_STDCALL cloxArenaDim(CloxArena_t *const arena, const size_t count, const size_t size)
+{
+    if (size && (count > (SIZE_MAX / size)))
+        fail("fatal error: %s", CLOX_ALLOC_ERROR_MESSAGE);
+
+    return memset(cloxArenaAlloc(arena, count * size), 0, count * size);
+}
+
+CLOX_API void *CLOX_STDCALL cloxArenaRealloc(CloxArena_t *const arena, void *const block, const size_t oldSize, const size_t newSize)
+{
+    assert(arena != NULL);
+
+    if (!block)
+        return cloxArenaAlloc(arena, newSize);
+
+    CLOX_REGISTER const size_t oldAligned = clox_ArenaAlign(max(oldSize, (size_t)1));
+    CLOX_REGISTER const size_t newAligned = clox_ArenaAlign(max(newSize, (size_t)1));
+    CloxArenaChunk_t *const chunk = arena->chunk;
+
+    /* the last allocated block can grow (or shrink) in place */
+    if (chunk && ((byte_t *)block + oldAligned == clox_ArenaChunkData(chunk) + chunk->used))
+    {
+        if ((chunk->used - oldAligned + newAligned) <= chunk->size)
+        {
+            chunk->used      = chunk->used - oldAligned + newAligned;
+            arena->allocated = arena->allocated - oldAligned + newAligned;
+
+            return block;
+        }
+    }
+    else if (newAligned <= oldAligned)
+    {
+        return block;
+    }
+
+    return memcpy(cloxArenaAlloc(arena, newSize), block, min(oldSize, newSize));
+}
+
+CLOX_API CloxArenaMark_t CLOX_STDCALL cloxArenaMark(const CloxArena_t *const arena)
+{
+    assert(arena != NULL);
+
+    CloxArenaMark_t mark;
+
+    mark.chunk     = arena->chunk;
+    mark.used      = arena->chunk ? arena->chunk->used : 0;
+    mark.allocated = arena->allocated;
+
+    return mark;
+}
+
+CLOX_API void CLOX_STDCALL cloxArenaRewind(CloxArena_t *const arena, const CloxArenaMark_t mark)
+{
+    assert(arena != NULL);
+
+    CloxArenaChunk_t *chunk = arena->chunk, *prev;
+
+    while (chunk && (chunk != mark.chunk))
+    {
+        prev = chunk->prev;
+        clox_ArenaReleaseChunk(arena, chunk);
+        chunk = prev;
+
+        arena->chunksCount--;
+    }
+
+    arena->chunk = chunk;
+
+    if (chunk)
+        chunk->used = mark.used;
+
+    arena->allocated = mark.allocated;
+
+    return;
+}
+
+CLOX_API void CLOX_STDCALL cloxDeleteArena(CloxArena_t *const arena)
+{
+    free(cloxFreeArena(arena));
+
+    return;
+}
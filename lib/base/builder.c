@@ -0,0 +1,179 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/builder.h"
+#include "clox/base/string.h"
+
+#include <assert.h>
+#include <stdio.h>
+
+CLOX_API CloxStringBuilder_t *CLOX_STDCALL cloxInitStringBuilder(CloxStringBuilder_t *const builder)
+{
+    assert(builder != NULL);
+
+    builder->chars    = NULL;
+    builder->length   = 0;
+    builder->capacity = 0;
+    builder->hash     = 0;
+    builder->hashed   = FALSE;
+    builder->memory   = cloxGetMemory();
+
+    return builder;
+}
+
+CLOX_API CloxStringBuilder_t *CLOX_STDCALL cloxFreeStringBuilder(CloxStringBuilder_t *const builder)
+{
+    assert(builder != NULL);
+
+    if (builder->chars)
+        cloxMemoryFree(builder->memory, CLOX_MEMORY_KIND_STRING, builder->chars, builder->capacity);
+
+    builder->chars    = NULL;
+    builder->length   = 0;
+    builder->capacity = 0;
+    builder->hashed   = FALSE;
+
+    return builder;
+}
+
+CLOX_API void CLOX_STDCALL cloxStringBuilderClear(CloxStringBuilder_t *const builder)
+{
+    assert(builder != NULL);
+
+    builder->length = 0;
+    builder->hashed = FALSE;
+
+    return;
+}
+
+CLOX_API char *CLOX_STDCALL cloxStringBuilderReserve(CloxStringBuilder_t *const builder, const size_t count)
+{
+    assert(builder != NULL);
+
+    /* one more byte is always kept for the terminator */
+    CLOX_REGISTER const size_t required = builder->length + count + 1;
+
+    if (required > builder->capacity)
+    {
+        CLOX_REGISTER size_t capacity = builder->capacity ? builder->capacity : CLOX_STRING_BUILDER_CAPACITY;
+
+        /* doubling makes a sequence of appends linear in the final length */
+        while (capacity < required)
+            capacity *= 2;
+
+        builder->chars    = (char *)cloxMemoryRealloc(builder->memory, CLOX_MEMORY_KIND_STRING, builder->chars, builder->capacity, capacity);
+        builder->capacity = capacity;
+    }
+
+    return builder->chars + builder->length;
+}
+
+CLOX_API void CLOX_STDCALL cloxStringBuilderAppend(CloxStringBuilder_t *const builder, const char *const chars, const size_t length)
+{
+    assert(builder != NULL && (chars != NULL || !length));
+
+    if (!length)
+        return;
+
+    memcpy(cloxStringBuilderReserve(builder, length), chars, length);
+
+    builder->length += length;
+    builder->hashed  = FALSE;
+
+    return;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxStringBuilderAppendV(CloxStringBuilder_t *const builder, const char *const format, va_list arglist)
+{
+    assert(builder != NULL);
+
+    if (!format)
+        return FALSE;
+
+#if CLOX_C_STANDARD >= CLOX_C_STANDARD_C99
+    va_list args;
+    int size;
+
+    /* the string is formatted in place when it fits in the free bytes, else
+     * it is formatted again once they have grown */
+    cloxStringBuilderReserve(builder, 0);
+
+    va_copy(args, arglist);
+    size = vsnprintf(builder->chars + builder->length, builder->capacity - builder->length, format, args);
+    va_end(args);
+
+    if (size < 0)
+        return FALSE;
+
+    if ((size_t)size >= (builder->capacity - builder->length))
+    {
+        va_copy(args, arglist);
+        size = vsnprintf(cloxStringBuilderReserve(builder, (size_t)size), (size_t)size + 1, format, args);
+        va_end(args);
+
+        if (size < 0)
+            return FALSE;
+    }
+
+    builder->length += (size_t)size;
+#else
+    char temp[CLOX_PAGESIZ] = { NUL };
+    const int size = vsprintf(temp, format, arglist);
+
+    if (size < 0)
+        return FALSE;
+
+    cloxStringBuilderAppend(builder, temp, (size_t)size);
+#endif
+
+    builder->hashed = FALSE;
+
+    return TRUE;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxStringBuilderAppendF(CloxStringBuilder_t *const builder, const char *const format, ...)
+{
+    bool_t result;
+    va_list args;
+
+    va_start(args, format);
+    result = cloxStringBuilderAppendV(builder, format, args);
+    va_end(args);
+
+    return result;
+}
+
+CLOX_API const char *CLOX_STDCALL cloxStringBuilderChars(CloxStringBuilder_t *const builder)
+{
+    assert(builder != NULL);
+
+    /* an empty builder gets its buffer here, so the result is never NULL */
+    *cloxStringBuilderReserve(builder, 0) = NUL;
+
+    return builder->chars;
+}
+
+CLOX_API uint32_t CLOX_STDCALL cloxStringBuilderHash(CloxStringBuilder_t *const builder)
+{
+    assert(builder != NULL);
+
+    if (!builder->hashed)
+    {
+        builder->hash   = cloxHashString(builder->chars, builder->length);
+        builder->hashed = TRUE;
+    }
+
+    return builder->hash;
+}
+
+CLOX_API const CloxString_t *CLOX_STDCALL cloxStringBuilderIntern(const CloxStringBuilder_t *const builder, CloxStringTable_t *const table)
+{
+    assert(builder != NULL && table != NULL);
+
+    /* the table copies the characters, they don't need a terminator */
+    return cloxStringTableIntern(table, builder->chars ? builder->chars : "", builder->length);
+}
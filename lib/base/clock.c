@@ -0,0 +1,35 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/clock.h"
+
+#if CLOX_PLATFORM_IS_WINDOWS
+#   include <windows.h>
+#else
+#   include <time.h>
+#endif
+
+CLOX_API uint64_t CLOX_STDCALL cloxClockNow(void)
+{
+#if CLOX_PLATFORM_IS_WINDOWS
+    CLOX_STATIC LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * UINT64_C(1000000000)
+         + (uint64_t)(counter.QuadPart % frequency.QuadPart) * UINT64_C(1000000000) / (uint64_t)frequency.QuadPart;
+#else
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * UINT64_C(1000000000) + (uint64_t)now.tv_nsec;
+#endif
+}
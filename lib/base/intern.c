@@ -0,0 +1,246 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/errno.h"
+#include "clox/base/intern.h"
+#include "clox/base/string.h"
+#include "clox/base/utf8.h"
+
+#ifndef clox_StringTableDim
+#   define clox_StringTableDim(table, T, N) ((table)->arena ? arenadim((table)->arena, T, N) : (T *)cloxMemoryDim((table)->memory, CLOX_MEMORY_KIND_STRING, (N), sizeof(T)))
+#endif
+
+#ifndef clox_StringTableRelease
+#   define clox_StringTableRelease(table, T, B, N) ((table)->arena ? (void)0 : cloxMemoryFree((table)->memory, CLOX_MEMORY_KIND_STRING, (void *)(B), sizeof(T) * (N)))
+#endif
+
+#ifndef clox_StringSize
+/* the characters are stored right after the string, in the same block */
+#   define clox_StringSize(length) (sizeof(CloxString_t) + (size_t)(length) + 1)
+#endif
+
+/**
+ * @brief       This data structure provides the normalized form of a key, the
+ *              characters are owned only when normalization produced a copy.
+ */
+typedef struct _CloxStringKey
+{
+    const char *chars;
+    size_t      length;
+    uint32_t    hash;
+    bool_t      owned;
+} CloxStringKey_t;
+
+CLOX_INLINE CloxStringKey_t *CLOX_STDCALL clox_StringTableInitKey(CloxStringKey_t *const key, const char *const chars, const size_t length)
+{
+    key->chars  = chars;
+    key->length = length;
+    key->owned  = FALSE;
+
+    /* ASCII text is already in NFC, so only the rest pays the normalization */
+    for (size_t i = 0; i < length; i++)
+    {
+        if (!((unsigned char)chars[i] & 0x80))
+            continue;
+
+        uint8_t *normalized = NULL;
+        CLOX_REGISTER const ssize_t result = utf8_map((const uint8_t *)chars, (ssize_t)length, &normalized, UTF8_STABLE | UTF8_COMPOSE);
+
+        if (result >= 0)
+        {
+            key->chars  = (const char *)normalized;
+            key->length = (size_t)result;
+            key->owned  = TRUE;
+        }
+
+        break;
+    }
+
+    key->hash = cloxHashString(key->chars, key->length);
+
+    return key;
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_StringTableFreeKey(CloxStringKey_t *const key)
+{
+    if (key->owned)
+        free((void *)key->chars);
+
+    return;
+}
+
+/**
+ * @brief       This function finds the slot that stores a string equal to key,
+ *              or the empty slot where it has to be inserted.
+ */
+CLOX_INLINE CloxString_t **CLOX_STDCALL clox_StringTableFindSlot(CloxString_t **const slots, const size_t capacity, const CloxStringKey_t *const key)
+{
+    CLOX_REGISTER const size_t mask = capacity - 1;
+    CLOX_REGISTER size_t slot = (size_t)key->hash & mask;
+
+    /* the table is never full, so linear probing always finds a slot */
+    for (; slots[slot]; slot = (slot + 1) & mask)
+    {
+        const CloxString_t *const string = slots[slot];
+
+        if ((string->hash == key->hash) && (string->length == key->length) && !memcmp(string->chars, key->chars, key->length))
+            break;
+    }
+
+    return &slots[slot];
+}
+
+/**
+ * @brief       This function grows the table, keeping its load factor below
+ *              three quarters.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_StringTableGrow(CloxStringTable_t *const table)
+{
+    CLOX_REGISTER const size_t capacity = table->capacity ? table->capacity * 2 : CLOX_STRING_TABLE_CAPACITY;
+    CloxString_t **const slots = clox_StringTableDim(table, CloxString_t *, capacity);
+
+    for (size_t i = 0; i < table->capacity; i++)
+    {
+        CloxString_t *const string = table->slots[i];
+
+        if (!string)
+            continue;
+
+        CLOX_REGISTER size_t slot = (size_t)string->hash & (capacity - 1);
+
+        while (slots[slot])
+            slot = (slot + 1) & (capacity - 1);
+
+        slots[slot] = string;
+    }
+
+    if (table->slots)
+        clox_StringTableRelease(table, CloxString_t *, table->slots, table->capacity);
+
+    table->slots    = slots;
+    table->capacity = capacity;
+
+    return;
+}
+
+CLOX_API CloxStringTable_t *CLOX_STDCALL cloxInitStringTable(CloxStringTable_t *const table, CloxArena_t *const arena)
+{
+    assert(table != NULL);
+
+    table->slots    = NULL;
+    table->capacity = 0;
+    table->count    = 0;
+    table->arena    = arena;
+    table->memory   = cloxGetMemory();
+
+    return table;
+}
+
+CLOX_API CloxStringTable_t *CLOX_STDCALL cloxFreeStringTable(CloxStringTable_t *const table)
+{
+    assert(table != NULL);
+
+    /* arena strings are released together with their arena */
+    if (!table->arena && table->slots)
+    {
+        for (size_t i = 0; i < table->capacity; i++)
+            if (table->slots[i])
+                cloxMemoryFree(table->memory, CLOX_MEMORY_KIND_STRING, table->slots[i], clox_StringSize(table->slots[i]->length));
+
+        clox_StringTableRelease(table, CloxString_t *, table->slots, table->capacity);
+    }
+
+    table->slots    = NULL;
+    table->capacity = 0;
+    table->count    = 0;
+
+    return table;
+}
+
+CLOX_API CloxStringTable_t *CLOX_STDCALL cloxCreateStringTable(CloxArena_t *const arena)
+{
+    return cloxInitStringTable(alloc(CloxStringTable_t), arena);
+}
+
+CLOX_API uint32_t CLOX_STDCALL cloxHashString(const char *const chars, const size_t length)
+{
+    CLOX_REGISTER uint32_t hash = UINT32_C(2166136261);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (uint32_t)(unsigned char)chars[i];
+        hash *= UINT32_C(16777619);
+    }
+
+    return hash;
+}
+
+CLOX_API const CloxString_t *CLOX_STDCALL cloxStringTableIntern(CloxStringTable_t *const table, const char *const chars, const size_t length)
+{
+    assert(table != NULL && (chars != NULL || !length));
+
+    CloxStringKey_t key;
+
+    clox_StringTableInitKey(&key, chars, length);
+
+    if (key.length > UINT32_MAX)
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    if (((table->count + 1) * 4) > (table->capacity * 3))
+        clox_StringTableGrow(table);
+
+    CloxString_t **const slot = clox_StringTableFindSlot(table->slots, table->capacity, &key);
+
+    if (!*slot)
+    {
+        CLOX_REGISTER const size_t size = clox_StringSize(key.length);
+        CloxString_t *const string = (CloxString_t *)(table->arena ? cloxArenaAlloc(table->arena, size) : cloxMemoryAlloc(table->memory, CLOX_MEMORY_KIND_STRING, size));
+        char *const stringChars = (char *)(string + 1);
+
+        /* the characters of the empty string may be NULL */
+        if (key.length)
+            memcpy(stringChars, key.chars, key.length);
+
+        stringChars[key.length] = NUL;
+
+        string->chars  = stringChars;
+        string->length = (uint32_t)key.length;
+        string->hash   = key.hash;
+
+        *slot = string;
+        table->count++;
+    }
+
+    clox_StringTableFreeKey(&key);
+
+    return *slot;
+}
+
+CLOX_API const CloxString_t *CLOX_STDCALL cloxStringTableFind(const CloxStringTable_t *const table, const char *const chars, const size_t length)
+{
+    assert(table != NULL && (chars != NULL || !length));
+
+    if (!table->count)
+        return NULL;
+
+    CloxStringKey_t key;
+
+    clox_StringTableInitKey(&key, chars, length);
+
+    const CloxString_t *const result = *clox_StringTableFindSlot(table->slots, table->capacity, &key);
+
+    clox_StringTableFreeKey(&key);
+
+    return result;
+}
+
+CLOX_API void CLOX_STDCALL cloxDeleteStringTable(CloxStringTable_t *const table)
+{
+    free(cloxFreeStringTable(table));
+
+    return;
+}
@@ -0,0 +1,274 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/byte.h"
+#include "clox/base/memory.h"
+#include "clox/base/thread.h"
+
+#include <string.h>
+
+#ifndef clox_MemoryThreadLocal
+#   if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+#       define clox_MemoryThreadLocal __declspec(thread)
+#   else
+#       define clox_MemoryThreadLocal __thread
+#   endif
+#endif
+
+CLOX_STATIC void *CLOX_STDCALL clox_MemoryDefaultAllocator(void *const data, void *const block, const size_t oldSize, const size_t newSize)
+{
+    (void)data, (void)oldSize;
+
+    if (!newSize)
+    {
+        free(block);
+        return NULL;
+    }
+
+    return realloc(block, newSize);
+}
+
+/* the default memory has no limit and the C allocator, so it can be used
+ * before being initialized */
+CLOX_STATIC CloxMemory_t clox_DefaultMemory = { &clox_MemoryDefaultAllocator, NULL, 0, NULL, NULL, 0, 0, 0, { { 0, 0, 0 } } };
+
+CLOX_STATIC clox_MemoryThreadLocal CloxMemory_t *clox_CurrentMemory = NULL;
+
+CLOX_INLINE size_t CLOX_STDCALL clox_MemoryAdd(volatile size_t *const counter, const size_t value)
+{
+    return cloxAtomicFetchAdd(counter, value);
+}
+
+CLOX_INLINE size_t CLOX_STDCALL clox_MemorySub(volatile size_t *const counter, const size_t value)
+{
+    return cloxAtomicFetchAdd(counter, (size_t)0 - value);
+}
+
+/**
+ * @brief       This function reserves bytes against the limit of a memory.
+ *
+ * @return      TRUE on success, FALSE if the limit would be exceeded.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_MemoryReserve(CloxMemory_t *const memory, const size_t size)
+{
+    CLOX_REGISTER const size_t bytes = clox_MemoryAdd(&memory->bytes, size) + size;
+
+    /* the bytes are added first, so threads racing for the last bytes can't
+     * both get them */
+    if (memory->limit && (bytes > memory->limit))
+    {
+        clox_MemorySub(&memory->bytes, size);
+        clox_MemoryAdd(&memory->failures, 1);
+
+        return FALSE;
+    }
+
+    /* raises the peak unless another thread raised it higher meanwhile */
+    CLOX_REGISTER size_t peak = memory->peak;
+
+    while (bytes > peak)
+    {
+        CLOX_REGISTER const size_t previous = cloxAtomicCompareExchange(&memory->peak, peak, bytes);
+
+        if (previous == peak)
+            break;
+
+        peak = previous;
+    }
+
+    return TRUE;
+}
+
+CLOX_STATIC CLOX_NORETURN void CLOX_STDCALL clox_MemoryExceeded(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size)
+{
+    if (memory->onLimit)
+        memory->onLimit(memory, kind, size);
+
+    fail("fatal error: %s", CLOX_MEMORY_LIMIT_ERROR_MESSAGE);
+}
+
+CLOX_API CloxMemory_t *CLOX_STDCALL cloxInitMemory(CloxMemory_t *const memory, const size_t limit)
+{
+    assert(memory != NULL);
+
+    memory->allocator     = &clox_MemoryDefaultAllocator;
+    memory->allocatorData = NULL;
+    memory->limit         = limit;
+    memory->onLimit       = NULL;
+    memory->data          = NULL;
+    memory->bytes         = 0;
+    memory->peak          = 0;
+    memory->failures      = 0;
+
+    memset(memory->stats, 0, sizeof(memory->stats));
+
+    return memory;
+}
+
+CLOX_API void CLOX_STDCALL cloxSetMemoryAllocator(CloxMemory_t *const memory, const CloxAllocatorFunc_t allocator, void *const allocatorData)
+{
+    assert(memory != NULL);
+
+    memory->allocator     = allocator ? allocator : &clox_MemoryDefaultAllocator;
+    memory->allocatorData = allocatorData;
+
+    return;
+}
+
+CLOX_API CloxMemory_t *CLOX_STDCALL cloxGetMemory(void)
+{
+    return clox_CurrentMemory ? clox_CurrentMemory : &clox_DefaultMemory;
+}
+
+CLOX_API CloxMemory_t *CLOX_STDCALL cloxSetMemory(CloxMemory_t *const memory)
+{
+    CloxMemory_t *const previous = cloxGetMemory();
+
+    clox_CurrentMemory = memory;
+
+    return previous;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxMemoryCharge(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size)
+{
+    assert(memory != NULL && (size_t)kind < CLOX_MEMORY_KINDS_COUNT);
+
+    if (!clox_MemoryReserve(memory, size))
+        return FALSE;
+
+    clox_MemoryAdd(&memory->stats[kind].bytes, size);
+    clox_MemoryAdd(&memory->stats[kind].count, 1);
+    clox_MemoryAdd(&memory->stats[kind].allocations, 1);
+
+    return TRUE;
+}
+
+CLOX_API void CLOX_STDCALL cloxMemoryDischarge(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size)
+{
+    assert(memory != NULL && (size_t)kind < CLOX_MEMORY_KINDS_COUNT);
+
+    clox_MemorySub(&memory->bytes, size);
+    clox_MemorySub(&memory->stats[kind].bytes, size);
+    clox_MemorySub(&memory->stats[kind].count, 1);
+
+    return;
+}
+
+CLOX_API void *CLOX_STDCALL cloxMemoryTryAlloc(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size)
+{
+    assert(memory != NULL);
+
+    void *block;
+
+    if (!cloxMemoryCharge(memory, kind, size))
+        return NULL;
+
+    if (!(block = memory->allocator(memory->allocatorData, NULL, 0, size ? size : 1)))
+        cloxMemoryDischarge(memory, kind, size);
+
+    return block;
+}
+
+CLOX_API void *CLOX_STDCALL cloxMemoryAlloc(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size)
+{
+    assert(memory != NULL);
+
+    void *block;
+
+    if (!cloxMemoryCharge(memory, kind, size))
+        clox_MemoryExceeded(memory, kind, size);
+
+    if (!(block = memory->allocator(memory->allocatorData, NULL, 0, size ? size : 1)))
+        fail("fatal error: %s", CLOX_ALLOC_ERROR_MESSAGE);
+
+    return block;
+}
+
+CLOX_API void *CLOX_STDCALL cloxMemoryDim(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t count, const size_t size)
+{
+    if (size && (count > (SIZE_MAX / size)))
+        fail("fatal error: %s", CLOX_ALLOC_ERROR_MESSAGE);
+
+    return memset(cloxMemoryAlloc(memory, kind, count * size), 0, count * size);
+}
+
+CLOX_API void *CLOX_STDCALL cloxMemoryRealloc(CloxMemory_t *const memory, const CloxMemoryKind_t kind, void *const block, const size_t oldSize, const size_t newSize)
+{
+    assert(memory != NULL && (size_t)kind < CLOX_MEMORY_KINDS_COUNT && newSize);
+
+    void *newBlock;
+
+    if (!block)
+        return cloxMemoryAlloc(memory, kind, newSize);
+
+    /* a resize is an allocation, but the number of blocks doesn't change */
+    if ((newSize > oldSize) && !clox_MemoryReserve(memory, newSize - oldSize))
+        clox_MemoryExceeded(memory, kind, newSize - oldSize);
+
+    if (!(newBlock = memory->allocator(memory->allocatorData, block, oldSize, newSize)))
+        fail("fatal error: %s", CLOX_RELOC_ERROR_MESSAGE);
+
+    if (newSize > oldSize)
+    {
+        clox_MemoryAdd(&memory->stats[kind].bytes, newSize - oldSize);
+    }
+    else
+    {
+        clox_MemorySub(&memory->bytes, oldSize - newSize);
+        clox_MemorySub(&memory->stats[kind].bytes, oldSize - newSize);
+    }
+
+    clox_MemoryAdd(&memory->stats[kind].allocations, 1);
+
+    return newBlock;
+}
+
+CLOX_API void CLOX_STDCALL cloxMemoryFree(CloxMemory_t *const memory, const CloxMemoryKind_t kind, void *const block, const size_t size)
+{
+    assert(memory != NULL);
+
+    if (!block)
+        return;
+
+    memory->allocator(memory->allocatorData, block, size, 0);
+    cloxMemoryDischarge(memory, kind, size);
+
+    return;
+}
+
+CLOX_API void CLOX_STDCALL cloxGetMemoryStats(const CloxMemory_t *const memory, const CloxMemoryKind_t kind, CloxMemoryStats_t *const outStats)
+{
+    assert(memory != NULL && (size_t)kind < CLOX_MEMORY_KINDS_COUNT && outStats != NULL);
+
+    *outStats = memory->stats[kind];
+
+    return;
+}
+
+CLOX_API const char *CLOX_STDCALL cloxGetMemoryKindName(const CloxMemoryKind_t kind)
+{
+    switch (kind)
+    {
+    case CLOX_MEMORY_KIND_OTHER:
+        return "other";
+
+    case CLOX_MEMORY_KIND_SOURCE:
+        return "source";
+
+    case CLOX_MEMORY_KIND_CODE:
+        return "code";
+
+    case CLOX_MEMORY_KIND_HEAP:
+        return "heap";
+
+    case CLOX_MEMORY_KIND_STRING:
+        return "string";
+
+    default:
+        return NULL;
+    }
+}
@@ -0,0 +1,337 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/poll.h"
+
+#include <assert.h>
+
+/* the mechanism used on each platform, the ones of the kernel keep the
+ * registrations while poll gets all the handles each time */
+#if CLOX_PLATFORM_IS_WINDOWS
+#   include <winsock2.h>
+#   define CLOX_POLLER_POLL 1
+#   define clox_PollFd_t    WSAPOLLFD
+#   define clox_Poll(fds, count, timeout) WSAPoll((fds), (ULONG)(count), (timeout))
+#elif CLOX_PLATFORM_ID == CLOX_PLATFORM_ID_LINUX
+#   include <sys/epoll.h>
+#   include <unistd.h>
+#   define CLOX_POLLER_EPOLL 1
+#elif CLOX_PLATFORM_IS_MACOS
+#   include <sys/event.h>
+#   include <sys/time.h>
+#   include <unistd.h>
+#   define CLOX_POLLER_KQUEUE 1
+#else
+#   include <poll.h>
+#   define CLOX_POLLER_POLL 1
+#   define clox_PollFd_t    struct pollfd
+#   define clox_Poll(fds, count, timeout) poll((fds), (nfds_t)(count), (timeout))
+#endif
+
+/**
+ * @brief       This data structure provides the registration of a handle, the
+ *              free ones are chained by their next field.
+ */
+typedef struct _CloxPollEntry
+{
+    CloxPollHandle_t handle;
+    uint32_t         events;
+    void            *data;
+    size_t           next;
+    bool_t           used;
+} CloxPollEntry_t;
+
+struct _CloxPoller
+{
+#if !CLOX_POLLER_POLL
+    int              fd;
+#endif
+    CloxPollEntry_t *entries;
+    size_t           count;
+    size_t           capacity;
+    size_t           next;
+};
+
+/**
+ * @brief       This function takes a free registration, growing them when all
+ *              are in use.
+ */
+CLOX_STATIC size_t CLOX_STDCALL clox_PollerTake(struct _CloxPoller *const poller)
+{
+    CLOX_REGISTER size_t slot;
+
+    if (poller->next != SIZE_MAX)
+    {
+        slot = poller->next;
+        poller->next = poller->entries[slot].next;
+    }
+    else
+    {
+        if (poller->count >= poller->capacity)
+        {
+            poller->capacity = poller->capacity ? poller->capacity * 2 : 16;
+            poller->entries  = redim(CloxPollEntry_t, poller->entries, poller->capacity);
+        }
+
+        slot = poller->count++;
+    }
+
+    poller->entries[slot].used = TRUE;
+
+    return slot;
+}
+
+/**
+ * @brief       This function releases a registration.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_PollerRelease(struct _CloxPoller *const poller, const size_t slot)
+{
+    poller->entries[slot].used = FALSE;
+    poller->entries[slot].next = poller->next;
+    poller->next = slot;
+
+    return;
+}
+
+/**
+ * @brief       This function finds the registration of a handle.
+ *
+ * @return      Its index, or SIZE_MAX if the handle is not waited for.
+ */
+CLOX_STATIC size_t CLOX_STDCALL clox_PollerFind(const struct _CloxPoller *const poller, const CloxPollHandle_t handle)
+{
+    for (size_t i = 0; i < poller->count; i++)
+        if (poller->entries[i].used && (poller->entries[i].handle == handle))
+            return i;
+
+    return SIZE_MAX;
+}
+
+CLOX_API CloxPoller_t CLOX_STDCALL cloxPollerCreate(void)
+{
+    CloxPoller_t poller = alloc(struct _CloxPoller);
+
+#if CLOX_POLLER_EPOLL
+    poller->fd = epoll_create1(EPOLL_CLOEXEC);
+#elif CLOX_POLLER_KQUEUE
+    poller->fd = kqueue();
+#endif
+
+#if !CLOX_POLLER_POLL
+    if (poller->fd < 0)
+    {
+        free(poller);
+        return NULL;
+    }
+#endif
+
+    poller->entries  = NULL;
+    poller->count    = 0;
+    poller->capacity = 0;
+    poller->next     = SIZE_MAX;
+
+    return poller;
+}
+
+CLOX_API void CLOX_STDCALL cloxPollerDestroy(CloxPoller_t poller)
+{
+#if !CLOX_POLLER_POLL
+    close(poller->fd);
+#endif
+
+    if (poller->entries)
+        free(poller->entries);
+
+    free(poller);
+
+    return;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxPollerAdd(CloxPoller_t poller, const CloxPollHandle_t handle, const uint32_t events, void *const data)
+{
+    assert(poller != NULL);
+    assert((events & (CLOX_POLL_READ | CLOX_POLL_WRITE)) != 0);
+
+    CLOX_REGISTER const size_t slot = clox_PollerTake(poller);
+
+#if CLOX_POLLER_EPOLL
+    struct epoll_event event;
+
+    event.events   = EPOLLONESHOT | ((events & CLOX_POLL_READ) ? EPOLLIN : 0) | ((events & CLOX_POLL_WRITE) ? EPOLLOUT : 0);
+    event.data.u64 = (uint64_t)slot;
+
+    if (epoll_ctl(poller->fd, EPOLL_CTL_ADD, handle, &event))
+    {
+        clox_PollerRelease(poller, slot);
+        return FALSE;
+    }
+#elif CLOX_POLLER_KQUEUE
+    struct kevent changes[2];
+    int n = 0;
+
+    if (events & CLOX_POLL_READ)
+        EV_SET(&changes[n++], handle, EVFILT_READ, EV_ADD | EV_ONESHOT, 0, 0, (void *)(uintptr_t)slot);
+
+    if (events & CLOX_POLL_WRITE)
+        EV_SET(&changes[n++], handle, EVFILT_WRITE, EV_ADD | EV_ONESHOT, 0, 0, (void *)(uintptr_t)slot);
+
+    if (kevent(poller->fd, changes, n, NULL, 0, NULL) < 0)
+    {
+        clox_PollerRelease(poller, slot);
+        return FALSE;
+    }
+#endif
+
+    poller->entries[slot].handle = handle;
+    poller->entries[slot].events = events;
+    poller->entries[slot].data   = data;
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function removes a registration from the system, if it
+ *              keeps them.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_PollerForget(struct _CloxPoller *const poller, const CloxPollEntry_t *const entry)
+{
+#if CLOX_POLLER_EPOLL
+    epoll_ctl(poller->fd, EPOLL_CTL_DEL, entry->handle, NULL);
+#elif CLOX_POLLER_KQUEUE
+    struct kevent change;
+
+    /* the filters that fired are already gone, the errors are ignored */
+    if (entry->events & CLOX_POLL_READ)
+    {
+        EV_SET(&change, entry->handle, EVFILT_READ, EV_DELETE, 0, 0, NULL);
+        kevent(poller->fd, &change, 1, NULL, 0, NULL);
+    }
+
+    if (entry->events & CLOX_POLL_WRITE)
+    {
+        EV_SET(&change, entry->handle, EVFILT_WRITE, EV_DELETE, 0, 0, NULL);
+        kevent(poller->fd, &change, 1, NULL, 0, NULL);
+    }
+#else
+    (void)poller;
+    (void)entry;
+#endif
+
+    return;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxPollerRemove(CloxPoller_t poller, const CloxPollHandle_t handle)
+{
+    assert(poller != NULL);
+
+    CLOX_REGISTER const size_t slot = clox_PollerFind(poller, handle);
+
+    if (slot == SIZE_MAX)
+        return FALSE;
+
+    clox_PollerForget(poller, &poller->entries[slot]);
+    clox_PollerRelease(poller, slot);
+
+    return TRUE;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxPollerWait(CloxPoller_t poller, CloxPollEvent_t *const events, const size_t count, const int timeout)
+{
+    assert(poller != NULL && events != NULL);
+
+    CLOX_REGISTER size_t i, n = 0;
+
+    if (!count)
+        return 0;
+
+#if CLOX_POLLER_POLL
+    clox_PollFd_t *const fds = dim(clox_PollFd_t, poller->count + 1);
+    size_t *const slots = dim(size_t, poller->count + 1);
+    size_t m = 0;
+
+    for (i = 0; i < poller->count; i++)
+    {
+        if (!poller->entries[i].used)
+            continue;
+
+        fds[m].fd      = poller->entries[i].handle;
+        fds[m].events  = ((poller->entries[i].events & CLOX_POLL_READ) ? POLLIN : 0) | ((poller->entries[i].events & CLOX_POLL_WRITE) ? POLLOUT : 0);
+        fds[m].revents = 0;
+        slots[m++]     = i;
+    }
+
+    if (m && (clox_Poll(fds, m, timeout) > 0))
+    {
+        for (i = 0; (i < m) && (n < count); i++)
+        {
+            if (!fds[i].revents)
+                continue;
+
+            events[n].events = ((fds[i].revents & (POLLIN | POLLHUP)) ? CLOX_POLL_READ : 0)
+                             | ((fds[i].revents & POLLOUT) ? CLOX_POLL_WRITE : 0)
+                             | ((fds[i].revents & (POLLERR | POLLNVAL)) ? CLOX_POLL_ERROR : 0);
+            events[n].data   = poller->entries[slots[i]].data;
+            n++;
+
+            clox_PollerRelease(poller, slots[i]);
+        }
+    }
+
+    free(slots);
+    free(fds);
+#elif CLOX_POLLER_EPOLL
+    struct epoll_event *const ready = dim(struct epoll_event, count);
+    const int m = epoll_wait(poller->fd, ready, (count > INT_MAX) ? INT_MAX : (int)count, timeout);
+
+    for (i = 0; (int)i < m; i++)
+    {
+        CloxPollEntry_t *const entry = &poller->entries[ready[i].data.u64];
+
+        events[n].events = ((ready[i].events & (EPOLLIN | EPOLLHUP)) ? CLOX_POLL_READ : 0)
+                         | ((ready[i].events & EPOLLOUT) ? CLOX_POLL_WRITE : 0)
+                         | ((ready[i].events & EPOLLERR) ? CLOX_POLL_ERROR : 0);
+        events[n].data   = entry->data;
+        n++;
+
+        /* the one-shot registration is disabled, not removed */
+        clox_PollerForget(poller, entry);
+        clox_PollerRelease(poller, (size_t)ready[i].data.u64);
+    }
+
+    free(ready);
+#elif CLOX_POLLER_KQUEUE
+    struct kevent *const ready = dim(struct kevent, count);
+    struct timespec limit;
+
+    limit.tv_sec  = (timeout > 0) ? (timeout / 1000) : 0;
+    limit.tv_nsec = (timeout > 0) ? ((long)(timeout % 1000) * 1000000L) : 0;
+
+    const int m = kevent(poller->fd, NULL, 0, ready, (count > INT_MAX) ? INT_MAX : (int)count, (timeout < 0) ? NULL : &limit);
+
+    for (i = 0; (int)i < m; i++)
+    {
+        CLOX_REGISTER const size_t slot = (size_t)(uintptr_t)ready[i].udata;
+        CloxPollEntry_t *const entry = &poller->entries[slot];
+
+        /* both filters of a handle may fire, it is reported once */
+        if (!entry->used)
+            continue;
+
+        events[n].events = ((ready[i].filter == EVFILT_READ) ? CLOX_POLL_READ : CLOX_POLL_WRITE)
+                         | ((ready[i].flags & EV_ERROR) ? CLOX_POLL_ERROR : 0);
+        events[n].data   = entry->data;
+        n++;
+
+        clox_PollerForget(poller, entry);
+        clox_PollerRelease(poller, slot);
+    }
+
+    free(ready);
+#endif
+
+    return n;
+}
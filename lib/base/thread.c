@@ -0,0 +1,124 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/thread.h"
+
+#if CLOX_PLATFORM_IS_WINDOWS
+#   include <windows.h>
+#else
+#   include <pthread.h>
+#   include <unistd.h>
+#endif
+
+struct _CloxThread
+{
+#if CLOX_PLATFORM_IS_WINDOWS
+    HANDLE               handle;
+#else
+    pthread_t            handle;
+#endif
+    CloxThreadFunction_t function;
+    void                *argument;
+};
+
+/* the entry points of the platforms have their own signatures */
+#if CLOX_PLATFORM_IS_WINDOWS
+CLOX_STATIC DWORD WINAPI clox_ThreadMain(LPVOID data)
+{
+    const struct _CloxThread *const thread = (const struct _CloxThread *)data;
+
+    thread->function(thread->argument);
+
+    return 0;
+}
+#else
+CLOX_STATIC void *clox_ThreadMain(void *data)
+{
+    const struct _CloxThread *const thread = (const struct _CloxThread *)data;
+
+    thread->function(thread->argument);
+
+    return NULL;
+}
+#endif
+
+CLOX_API CloxThread_t CLOX_STDCALL cloxThreadCreate(const CloxThreadFunction_t function, void *const argument)
+{
+    CloxThread_t thread = alloc(struct _CloxThread);
+
+    thread->function = function;
+    thread->argument = argument;
+
+#if CLOX_PLATFORM_IS_WINDOWS
+    if (!(thread->handle = CreateThread(NULL, 0, &clox_ThreadMain, thread, 0, NULL)))
+#else
+    if (pthread_create(&thread->handle, NULL, &clox_ThreadMain, thread))
+#endif
+    {
+        free(thread);
+        return NULL;
+    }
+
+    return thread;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxThreadJoin(CloxThread_t thread)
+{
+    bool_t result;
+
+#if CLOX_PLATFORM_IS_WINDOWS
+    result = (bool_t)(WaitForSingleObject(thread->handle, INFINITE) == WAIT_OBJECT_0);
+    CloseHandle(thread->handle);
+#else
+    result = (bool_t)!pthread_join(thread->handle, NULL);
+#endif
+
+    free(thread);
+
+    return result;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxThreadCount(void)
+{
+#if CLOX_PLATFORM_IS_WINDOWS
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+
+    return info.dwNumberOfProcessors ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return (count > 0) ? (size_t)count : 1;
+#endif
+}
+
+CLOX_API size_t CLOX_STDCALL cloxAtomicFetchAdd(volatile size_t *const counter, const size_t value)
+{
+#if CLOX_PLATFORM_IS_WINDOWS && CLOX_ARCHTECT_IS_64_BIT
+    return (size_t)InterlockedExchangeAdd64((volatile LONG64 *)counter, (LONG64)value);
+#elif CLOX_PLATFORM_IS_WINDOWS
+    return (size_t)InterlockedExchangeAdd((volatile LONG *)counter, (LONG)value);
+#else
+    return __atomic_fetch_add(counter, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+CLOX_API size_t CLOX_STDCALL cloxAtomicCompareExchange(volatile size_t *const counter, const size_t expected, const size_t value)
+{
+#if CLOX_PLATFORM_IS_WINDOWS && CLOX_ARCHTECT_IS_64_BIT
+    return (size_t)InterlockedCompareExchange64((volatile LONG64 *)counter, (LONG64)value, (LONG64)expected);
+#elif CLOX_PLATFORM_IS_WINDOWS
+    return (size_t)InterlockedCompareExchange((volatile LONG *)counter, (LONG)value, (LONG)expected);
+#else
+    size_t previous = expected;
+
+    __atomic_compare_exchange_n(counter, &previous, value, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+
+    return previous;
+#endif
+}
@@ -761,7 +761,7 @@ ssize_t CLOX_STDCALL utf8_normalize_utf32(int32_t *buffer, ssize_t length, utf8_
         int32_t *starter = NULL;
         int32_t current_char;
         const utf8_property_t *starter_property = NULL, *current_property;
-        uint16_t max_combining_class = -1;
+        int32_t max_combining_class = -1;
         ssize_t rpos;
         ssize_t wpos = 0;
         int32_t composition;
@@ -769,7 +769,7 @@ ssize_t CLOX_STDCALL utf8_normalize_utf32(int32_t *buffer, ssize_t length, utf8_
         {
             current_char = buffer[rpos];
             current_property = unsafe_get_property(current_char);
-            if (starter && current_property->combining_class > max_combining_class)
+            if (starter && (int32_t)current_property->combining_class > max_combining_class)
             {
                 /* combination perhaps possible */
                 int32_t hangul_lindex;
@@ -834,7 +834,7 @@ ssize_t CLOX_STDCALL utf8_normalize_utf32(int32_t *buffer, ssize_t length, utf8_
             buffer[wpos] = current_char;
             if (current_property->combining_class)
             {
-                if (current_property->combining_class > max_combining_class)
+                if ((int32_t)current_property->combining_class > max_combining_class)
                 {
                     max_combining_class = current_property->combining_class;
                 }
@@ -0,0 +1,1612 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/utils.h"
+#include "clox/compiler/compiler.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef CLOX_COMPILER_NUMBER_LENGTH
+/* the longest number literal converted without truncation */
+#   define CLOX_COMPILER_NUMBER_LENGTH 64
+#endif
+
+/**
+ * @brief       The precedences of the operators, from the lowest to the
+ *              highest.
+ */
+typedef enum _CloxCompilerPrecedence
+{
+    CLOX_COMPILER_PRECEDENCE_NONE = 0x00,
+    CLOX_COMPILER_PRECEDENCE_ASSIGNMENT,
+    CLOX_COMPILER_PRECEDENCE_OR,
+    CLOX_COMPILER_PRECEDENCE_AND,
+    CLOX_COMPILER_PRECEDENCE_EQUALITY,
+    CLOX_COMPILER_PRECEDENCE_COMPARISON,
+    CLOX_COMPILER_PRECEDENCE_TERM,
+    CLOX_COMPILER_PRECEDENCE_FACTOR,
+    CLOX_COMPILER_PRECEDENCE_UNARY,
+    CLOX_COMPILER_PRECEDENCE_PRIMARY,
+} CloxCompilerPrecedence_t;
+
+typedef void (CLOX_STDCALL *CloxCompilerParser_t)(CloxCompiler_t *const compiler, const bool_t canAssign);
+
+/**
+ * @brief       The parsing rule of a token kind: the parsers of the expressions
+ *              that it begins or continues and its precedence as an operator.
+ */
+typedef struct _CloxCompilerRule
+{
+    CloxCompilerParser_t     prefix;
+    CloxCompilerParser_t     infix;
+    CloxCompilerPrecedence_t precedence;
+} CloxCompilerRule_t;
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerExpression(CloxCompiler_t *const compiler);
+CLOX_STATIC void CLOX_STDCALL clox_CompilerStatement(CloxCompiler_t *const compiler);
+CLOX_STATIC void CLOX_STDCALL clox_CompilerDeclaration(CloxCompiler_t *const compiler);
+
+#pragma region Diagnostics
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerErrorAt(CloxCompiler_t *const compiler, const CloxToken_t *const token, const char *const message)
+{
+    if (compiler->panicMode)
+        return;
+
+    FILE *const stream = compiler->errorStream ? compiler->errorStream : stderr;
+
+    compiler->panicMode = TRUE;
+    compiler->errorsCount++;
+
+    fprintf(stream, "%s:%" PRIu32 ":%u: error: ", compiler->name ? compiler->name : "<script>", compiler->line + token->line + 1, (unsigned)token->column + 1);
+
+    if (token->kind == CLOX_TOKEN_KIND_ERROR)
+        fprintf(stream, "%s\n", cloxGetTokenErrorMessage((CloxTokenError_t)token->error));
+    else if (token->kind == CLOX_TOKEN_KIND_EOF)
+        fprintf(stream, "%s at end\n", message);
+    else
+        fprintf(stream, "%s at '%.*s'\n", message, (int)token->length, cloxLexerTokenText(&compiler->lexer, token));
+
+    return;
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_CompilerError(CloxCompiler_t *const compiler, const char *const message)
+{
+    clox_CompilerErrorAt(compiler, compiler->previous, message);
+
+    return;
+}
+
+#pragma endregion
+
+#pragma region Tokens
+
+/**
+ * @brief       This function reports the error tokens starting from the
+ *              current one, moving to the first valid token.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_CompilerSkipErrors(CloxCompiler_t *const compiler)
+{
+    /* the last token is always the EOF one, so the loop always ends */
+    while (compiler->current->kind == CLOX_TOKEN_KIND_ERROR)
+    {
+        clox_CompilerErrorAt(compiler, compiler->current, NULL);
+        compiler->current++;
+    }
+
+    return;
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_CompilerAdvance(CloxCompiler_t *const compiler)
+{
+    compiler->previous = compiler->current;
+
+    /* the parser never goes past the EOF token */
+    if (compiler->current->kind != CLOX_TOKEN_KIND_EOF)
+    {
+        compiler->current++;
+        clox_CompilerSkipErrors(compiler);
+    }
+
+    return;
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_CompilerCheck(const CloxCompiler_t *const compiler, const CloxTokenKind_t kind)
+{
+    return compiler->current->kind == kind;
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_CompilerMatch(CloxCompiler_t *const compiler, const CloxTokenKind_t kind)
+{
+    if (!clox_CompilerCheck(compiler, kind))
+        return FALSE;
+
+    clox_CompilerAdvance(compiler);
+
+    return TRUE;
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_CompilerConsume(CloxCompiler_t *const compiler, const CloxTokenKind_t kind, const char *const message)
+{
+    if (clox_CompilerCheck(compiler, kind))
+        clox_CompilerAdvance(compiler);
+    else
+        clox_CompilerErrorAt(compiler, compiler->current, message);
+
+    return;
+}
+
+CLOX_INLINE const CloxString_t *CLOX_STDCALL clox_CompilerIntern(CloxCompiler_t *const compiler, const CloxToken_t *const name)
+{
+    return cloxStringTableIntern(&compiler->strings, cloxLexerTokenText(&compiler->lexer, name), name->length);
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerSynchronize(CloxCompiler_t *const compiler)
+{
+    compiler->panicMode = FALSE;
+
+    while (compiler->current->kind != CLOX_TOKEN_KIND_EOF)
+    {
+        if (compiler->previous->kind == CLOX_TOKEN_KIND_SEMICOLON)
+            return;
+
+        switch (compiler->current->kind)
+        {
+        case CLOX_TOKEN_KIND_CLASS:
+        case CLOX_TOKEN_KIND_FUN:
+        case CLOX_TOKEN_KIND_VAR:
+        case CLOX_TOKEN_KIND_FOR:
+        case CLOX_TOKEN_KIND_IF:
+        case CLOX_TOKEN_KIND_WHILE:
+        case CLOX_TOKEN_KIND_PRINT:
+        case CLOX_TOKEN_KIND_RETURN:
+            return;
+
+        default:
+            clox_CompilerAdvance(compiler);
+            break;
+        }
+    }
+
+    return;
+}
+
+#pragma endregion
+
+#pragma region Code Generation
+
+/**
+ * @brief       This function records that the code emitted from now on is
+ *              compiled from the specified token, so runtime errors can point
+ *              to it.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_CompilerMark(CloxCompiler_t *const compiler, const CloxToken_t *const token)
+{
+    CloxSourceLocation_t location = cloxTokenLocation(token);
+
+    location.ln += compiler->line;
+
+    cloxCodeBlockAddLine(compiler->emitter.codeBlock, cloxEmitterOffset(&compiler->emitter), &location);
+
+    return;
+}
+
+/**
+ * @brief       This function pushes a constant on the evaluation stack,
+ *              passing through the scratch register.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_CompilerEmitConstant(CloxCompiler_t *const compiler, const CloxValue_t value)
+{
+    cloxEmitConstant(&compiler->emitter, compiler->scratch, value);
+    cloxEmitFast(&compiler->emitter, CLOX_OP_CODE_PSH, compiler->scratch);
+
+    return;
+}
+
+/**
+ * @brief       This function turns the comparison flag into a boolean on the
+ *              evaluation stack, true when the specified jump is taken.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerEmitCompare(CloxCompiler_t *const compiler, const CloxOpCode_t jump)
+{
+    CloxEmitter_t *const emitter = &compiler->emitter;
+
+    cloxEmitByte(emitter, CLOX_OP_CODE_CMP);
+
+    CLOX_REGISTER const size_t thenJump = cloxEmitJump(emitter, jump, 0);
+
+    cloxEmitConstant(emitter, compiler->scratch, cloxBoolValue(FALSE));
+
+    CLOX_REGISTER const size_t elseJump = cloxEmitJump(emitter, CLOX_OP_CODE_JMP, 0);
+
+    cloxEmitterPatchJump(emitter, thenJump, cloxEmitterOffset(emitter));
+    cloxEmitConstant(emitter, compiler->scratch, cloxBoolValue(TRUE));
+    cloxEmitterPatchJump(emitter, elseJump, cloxEmitterOffset(emitter));
+    cloxEmitFast(emitter, CLOX_OP_CODE_PSH, compiler->scratch);
+
+    return;
+}
+
+/**
+ * @brief       This function discards the value on the top of the evaluation
+ *              stack.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_CompilerEmitDrop(CloxCompiler_t *const compiler)
+{
+    cloxEmitFast(&compiler->emitter, CLOX_OP_CODE_POP, compiler->scratch);
+
+    return;
+}
+
+/**
+ * @brief       This function pops a condition from the evaluation stack and
+ *              emits the jump taken when it is falsey, to patch later.
+ */
+CLOX_INLINE size_t CLOX_STDCALL clox_CompilerEmitCondition(CloxCompiler_t *const compiler)
+{
+    cloxEmitByte(&compiler->emitter, CLOX_OP_CODE_TST);
+
+    return cloxEmitJump(&compiler->emitter, CLOX_OP_CODE_JNT, 0);
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_CompilerPatchHere(CloxCompiler_t *const compiler, const size_t offset)
+{
+    cloxEmitterPatchJump(&compiler->emitter, offset, cloxEmitterOffset(&compiler->emitter));
+
+    return;
+}
+
+#pragma endregion
+
+#pragma region Scopes
+
+CLOX_INLINE void CLOX_STDCALL clox_CompilerBeginScope(CloxCompiler_t *const compiler)
+{
+    compiler->scopeDepth++;
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerEndScope(CloxCompiler_t *const compiler)
+{
+    CLOX_REGISTER uint16_t count = 0;
+
+    compiler->scopeDepth--;
+
+    /* the registers of the variables are freed, no code is needed */
+    while (compiler->localsCount && (compiler->locals[compiler->localsCount - 1].depth > compiler->scopeDepth))
+    {
+        compiler->localsCount--;
+        count++;
+    }
+
+    cloxEmitterPopRegisters(&compiler->emitter, count);
+
+    return;
+}
+
+CLOX_STATIC CloxCompilerLocal_t *CLOX_STDCALL clox_CompilerResolve(CloxCompiler_t *const compiler, const CloxToken_t *const name)
+{
+    /* a name never interned can't be the name of a variable */
+    const CloxString_t *const string = cloxStringTableFind(&compiler->strings, cloxLexerTokenText(&compiler->lexer, name), name->length);
+
+    if (!string)
+        return NULL;
+
+    for (size_t i = compiler->localsCount; i > 0; i--)
+    {
+        CloxCompilerLocal_t *const local = &compiler->locals[i - 1];
+
+        if (!cloxStringEquals(local->name, string))
+            continue;
+
+        if (local->depth < 0)
+            clox_CompilerError(compiler, "can't read a variable in its own initializer");
+
+        /* a function runs on its own window, the registers of the script are
+         * out of its reach (the variables of the script are not globals) */
+        if ((i - 1) < compiler->localsBase)
+        {
+            clox_CompilerError(compiler, "can't use a variable of the script in a function (pass it as an argument)");
+            return NULL;
+        }
+
+        return local;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief       This function declares the variable named by the previous token,
+ *              the script scope allows to declare again a variable (which keeps
+ *              its register).
+ */
+CLOX_STATIC CloxCompilerLocal_t *CLOX_STDCALL clox_CompilerDeclare(CloxCompiler_t *const compiler)
+{
+    const CloxString_t *const name = clox_CompilerIntern(compiler, compiler->previous);
+
+    for (size_t i = compiler->localsCount; i > 0; i--)
+    {
+        CloxCompilerLocal_t *const local = &compiler->locals[i - 1];
+
+        if ((local->depth >= 0) && (local->depth < compiler->scopeDepth))
+            break;
+
+        if (!cloxStringEquals(local->name, name))
+            continue;
+
+        if (compiler->scopeDepth)
+            clox_CompilerError(compiler, "already a variable with this name in this scope");
+
+        return local;
+    }
+
+    if (compiler->localsCount >= CLOX_COMPILER_LOCALS_COUNT)
+    {
+        clox_CompilerError(compiler, "too many variables in scope");
+        return NULL;
+    }
+
+    CloxCompilerLocal_t *const local = &compiler->locals[compiler->localsCount++];
+
+    local->name  = name;
+    local->depth = -1;
+    local->reg   = cloxEmitterPushRegister(&compiler->emitter);
+
+    return local;
+}
+
+#pragma endregion
+
+#pragma region Functions
+
+CLOX_STATIC CloxCompilerFunction_t *CLOX_STDCALL clox_CompilerFindFunction(CloxCompiler_t *const compiler, const CloxToken_t *const name)
+{
+    const CloxString_t *const string = cloxStringTableFind(&compiler->strings, cloxLexerTokenText(&compiler->lexer, name), name->length);
+
+    if (!string)
+        return NULL;
+
+    for (size_t i = 0; i < compiler->functionsCount; i++)
+    {
+        if (cloxStringEquals(compiler->functions[i].name, string))
+            return &compiler->functions[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief       This function exchanges the lexer of the compiler with the one
+ *              of a kept chunk (a second exchange restores it).
+ */
+CLOX_INLINE void CLOX_STDCALL clox_CompilerSwapLexer(CloxCompiler_t *const compiler, CloxCompilerChunk_t *const chunk)
+{
+    const CloxLexer_t lexer = compiler->lexer;
+
+    compiler->lexer = chunk->lexer;
+    chunk->lexer    = lexer;
+
+    return;
+}
+
+/**
+ * @brief       This function keeps the chunk just compiled when it declared
+ *              functions, so that their tokens outlive it.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerKeepChunk(CloxCompiler_t *const compiler)
+{
+    if (compiler->functionsKept == compiler->functionsCount)
+        return;
+
+    if (compiler->chunksCount >= compiler->chunksCapacity)
+    {
+        compiler->chunksCapacity = compiler->chunksCapacity ? compiler->chunksCapacity * 2 : 8;
+        compiler->chunks = redim(CloxCompilerChunk_t, compiler->chunks, compiler->chunksCapacity);
+    }
+
+    CloxCompilerChunk_t *const chunk = &compiler->chunks[compiler->chunksCount];
+
+    const CloxSourceBuffer_t *const sourceBuffer = compiler->lexer.sourceBuffer;
+    const CloxToken_t *const tokens = compiler->lexer.tokens;
+
+    /* the copy is scanned into the same tokens, so the functions move to
+     * them by their indexes */
+    chunk->sourceBuffer = cloxCreateSourceBuffer(sourceBuffer->size, sourceBuffer->data, sourceBuffer->size);
+    chunk->line         = compiler->line;
+
+    cloxInitLexer(&chunk->lexer, NULL);
+    cloxLexerScanBuffer(&chunk->lexer, chunk->sourceBuffer);
+
+    for (size_t i = compiler->functionsKept; i < compiler->functionsCount; i++)
+    {
+        CloxCompilerFunction_t *const function = &compiler->functions[i];
+
+        function->declaration = chunk->lexer.tokens + (function->declaration - tokens);
+        function->end         = chunk->lexer.tokens + (function->end - tokens);
+        function->chunk       = compiler->chunksCount;
+    }
+
+    compiler->functionsKept = compiler->functionsCount;
+    compiler->chunksCount++;
+
+    return;
+}
+
+/**
+ * @brief       This function drops the functions kept by an interactive
+ *              session, with their chunks.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerDropChunks(CloxCompiler_t *const compiler)
+{
+    for (size_t i = 0; i < compiler->chunksCount; i++)
+    {
+        cloxFreeLexer(&compiler->chunks[i].lexer);
+        cloxDeleteSourceBuffer(compiler->chunks[i].sourceBuffer);
+    }
+
+    compiler->chunksCount   = 0;
+    compiler->functionsKept = 0;
+    compiler->droppedCount  = 0;
+
+    return;
+}
+
+/**
+ * @brief       This function remembers the names of the functions declared by
+ *              a chunk that failed to compile, which are dropped with it.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerDropFunctions(CloxCompiler_t *const compiler)
+{
+    for (size_t i = compiler->functionsKept; i < compiler->functionsCount; i++)
+    {
+        if (compiler->droppedCount >= compiler->droppedCapacity)
+        {
+            compiler->droppedCapacity = compiler->droppedCapacity ? compiler->droppedCapacity * 2 : 8;
+            compiler->dropped = redim(const CloxString_t *, compiler->dropped, compiler->droppedCapacity);
+        }
+
+        compiler->dropped[compiler->droppedCount++] = compiler->functions[i].name;
+    }
+
+    compiler->functionsCount = compiler->functionsKept;
+
+    return;
+}
+
+CLOX_STATIC bool_t CLOX_STDCALL clox_CompilerIsDropped(CloxCompiler_t *const compiler, const CloxToken_t *const name)
+{
+    const CloxString_t *const string = cloxStringTableFind(&compiler->strings, cloxLexerTokenText(&compiler->lexer, name), name->length);
+
+    if (!string)
+        return FALSE;
+
+    for (size_t i = 0; i < compiler->droppedCount; i++)
+    {
+        if (cloxStringEquals(compiler->dropped[i], string))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief       This function queues the body of a function to be compiled at
+ *              the end of the source, if it isn't already.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_CompilerQueue(CloxCompiler_t *const compiler, CloxCompilerFunction_t *const function)
+{
+    if (function->isQueued)
+        return;
+
+    function->isQueued = TRUE;
+    function->next     = compiler->pending;
+
+    compiler->pending = (size_t)(function - compiler->functions);
+
+    return;
+}
+
+/**
+ * @brief       This function compiles the call of a function of the script:
+ *              the arguments are pushed on the evaluation stack, where the
+ *              callee pops them into its registers and pushes its result.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerCallFunction(CloxCompiler_t *const compiler, const CloxToken_t *const name, CloxCompilerFunction_t *const function)
+{
+    CLOX_REGISTER size_t count = 0;
+
+    if (!clox_CompilerCheck(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN))
+    {
+        do
+        {
+            clox_CompilerExpression(compiler);
+            count++;
+        } while (clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_COMMA));
+    }
+
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN, "expected ')' after arguments");
+
+    if (count != function->arity)
+    {
+        clox_CompilerErrorAt(compiler, name, "wrong number of arguments");
+        return;
+    }
+
+    clox_CompilerMark(compiler, name);
+    clox_CompilerQueue(compiler, function);
+
+    /* a tail call replaces the frame of the caller, it carries no registers
+     * since the arguments are on the stack; the 'ret' after it is dead code */
+    const bool_t isTail = (bool_t)((name == compiler->tailCall) && clox_CompilerCheck(compiler, CLOX_TOKEN_KIND_SEMICOLON));
+    const CloxOpCode_t opCode = isTail ? CLOX_OP_CODE_TCALL : CLOX_OP_CODE_CALL;
+    const byte_t carried = isTail ? 0 : (byte_t)count;
+
+    if (function->offset != SIZE_MAX)
+    {
+        cloxEmitCall(&compiler->emitter, opCode, function->offset, carried);
+        return;
+    }
+
+    if (compiler->callsCount >= compiler->callsCapacity)
+    {
+        compiler->callsCapacity = compiler->callsCapacity ? compiler->callsCapacity * 2 : 8;
+        compiler->calls = redim(CloxCompilerCall_t, compiler->calls, compiler->callsCapacity);
+    }
+
+    CloxCompilerCall_t *const call = &compiler->calls[compiler->callsCount++];
+
+    call->offset   = cloxEmitCall(&compiler->emitter, opCode, 0, carried);
+    call->function = (size_t)(function - compiler->functions);
+
+    return;
+}
+
+/**
+ * @brief       This function compiles the body of a function, from its
+ *              parameters to its closing bracket. The function opens a window
+ *              sized at the end of its body, so the registers of the caller are
+ *              kept as they are.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerFunctionBody(CloxCompiler_t *const compiler, CloxCompilerFunction_t *const function)
+{
+    CloxEmitter_t *const emitter = &compiler->emitter;
+
+    const size_t localsBase = compiler->localsBase;
+    const uint16_t registersCount = emitter->registersCount;
+    const uint16_t registersMax = emitter->registersMax;
+    const byte_t scratch = compiler->scratch;
+    const uint32_t line = compiler->line;
+
+    /* the body of a kept function is parsed from the tokens of its chunk */
+    if (function->chunk != SIZE_MAX)
+    {
+        clox_CompilerSwapLexer(compiler, &compiler->chunks[function->chunk]);
+        compiler->line = compiler->chunks[function->chunk].line;
+    }
+
+    compiler->function   = function;
+    compiler->localsBase = compiler->localsCount;
+    compiler->panicMode  = FALSE;
+
+    emitter->registersCount = 0;
+    emitter->registersMax   = 0;
+
+    compiler->previous = function->declaration;
+    compiler->current  = function->declaration + 2;
+
+    clox_CompilerMark(compiler, function->declaration);
+
+    function->offset = cloxEmitterOffset(emitter);
+
+    CLOX_REGISTER const size_t enter = cloxEmitCtrl(emitter, CLOX_OP_CODE_ENT, 0, 0);
+
+    compiler->scratch = cloxEmitterPushRegister(emitter);
+    clox_CompilerBeginScope(compiler);
+
+    /* the parameters have been checked by the declaration */
+    while (clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_IDENTIFIER))
+    {
+        CloxCompilerLocal_t *const local = clox_CompilerDeclare(compiler);
+
+        if (local)
+            local->depth = compiler->scopeDepth;
+
+        clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_COMMA);
+    }
+
+    /* the last argument is on the top of the stack */
+    for (size_t i = compiler->localsCount; i > compiler->localsBase; i--)
+        cloxEmitFast(emitter, CLOX_OP_CODE_POP, compiler->locals[i - 1].reg);
+
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN, "expected ')' after parameters");
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_LEFT_BRACE, "expected '{' before function body");
+
+    /* the bounds found by the declaration stop a broken body from going on
+     * with the tokens that follow it */
+    while (compiler->current < function->end)
+        clox_CompilerDeclaration(compiler);
+
+    compiler->current = function->end;
+    clox_CompilerAdvance(compiler);
+
+    clox_CompilerEmitConstant(compiler, cloxVoidValue());
+    cloxEmitByte(emitter, CLOX_OP_CODE_RET);
+    cloxEncodeOpHalf(emitter->codeBlock->array + enter + 1, emitter->registersMax);
+    cloxCodeBlockAddSymbol(emitter->codeBlock, function->offset, cloxEmitterOffset(emitter), function->name->chars, function->name->length);
+
+    compiler->localsCount = compiler->localsBase;
+    compiler->scopeDepth  = 0;
+    compiler->localsBase  = localsBase;
+    compiler->function    = NULL;
+    compiler->scratch     = scratch;
+    compiler->line        = line;
+
+    if (function->chunk != SIZE_MAX)
+        clox_CompilerSwapLexer(compiler, &compiler->chunks[function->chunk]);
+
+    emitter->registersCount = registersCount;
+    emitter->registersMax   = registersMax;
+
+    return;
+}
+
+/**
+ * @brief       This function compiles the queued function bodies after the code
+ *              of the script, which jumps over them, then patches the calls to
+ *              them.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerFunctions(CloxCompiler_t *const compiler)
+{
+    if (compiler->pending == SIZE_MAX)
+        return;
+
+    CLOX_REGISTER const size_t endJump = cloxEmitJump(&compiler->emitter, CLOX_OP_CODE_JMP, 0);
+
+    /* a body can queue more functions, the last queued is compiled first */
+    while (compiler->pending != SIZE_MAX)
+    {
+        CloxCompilerFunction_t *const function = &compiler->functions[compiler->pending];
+
+        compiler->pending = function->next;
+        clox_CompilerFunctionBody(compiler, function);
+    }
+
+    clox_CompilerPatchHere(compiler, endJump);
+
+    for (size_t i = 0; i < compiler->callsCount; i++)
+        cloxEmitterPatchJump(&compiler->emitter, compiler->calls[i].offset, compiler->functions[compiler->calls[i].function].offset);
+
+    compiler->callsCount = 0;
+
+    return;
+}
+
+#pragma endregion
+
+#pragma region Expressions
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerParsePrecedence(CloxCompiler_t *const compiler, const CloxCompilerPrecedence_t precedence);
+CLOX_STATIC const CloxCompilerRule_t *CLOX_STDCALL clox_CompilerGetRule(const CloxTokenKind_t kind);
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerNumber(CloxCompiler_t *const compiler, const bool_t canAssign)
+{
+    (void)canAssign;
+
+    char text[CLOX_COMPILER_NUMBER_LENGTH];
+    CLOX_REGISTER const size_t length = min((size_t)compiler->previous->length, sizeof(text) - 1);
+
+    /* lexemes are not NUL-terminated, and the next byte could extend them */
+    memcpy(text, cloxLexerTokenText(&compiler->lexer, compiler->previous), length);
+    text[length] = '\0';
+
+    clox_CompilerEmitConstant(compiler, cloxRealValue((real_t)strtod(text, NULL)));
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerLiteral(CloxCompiler_t *const compiler, const bool_t canAssign)
+{
+    (void)canAssign;
+
+    switch (compiler->previous->kind)
+    {
+    case CLOX_TOKEN_KIND_TRUE:
+        clox_CompilerEmitConstant(compiler, cloxBoolValue(TRUE));
+        break;
+
+    case CLOX_TOKEN_KIND_FALSE:
+        clox_CompilerEmitConstant(compiler, cloxBoolValue(FALSE));
+        break;
+
+    default:
+        clox_CompilerEmitConstant(compiler, cloxVoidValue());
+        break;
+    }
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerUnsupported(CloxCompiler_t *const compiler, const bool_t canAssign)
+{
+    (void)canAssign;
+
+    clox_CompilerError(compiler, "unsupported expression");
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerGrouping(CloxCompiler_t *const compiler, const bool_t canAssign)
+{
+    (void)canAssign;
+
+    clox_CompilerExpression(compiler);
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN, "expected ')' after expression");
+
+    return;
+}
+
+/**
+ * @brief       This function compiles the call of a native function, whose
+ *              arguments are left on the evaluation stack: the function reads
+ *              them in place and replaces them by its result.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerCall(CloxCompiler_t *const compiler, const CloxToken_t *const name, const size_t offset)
+{
+    CLOX_REGISTER size_t count = 0;
+
+    if (!clox_CompilerCheck(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN))
+    {
+        do
+        {
+            clox_CompilerExpression(compiler);
+
+            if (count++ == BYTE_MAX)
+                clox_CompilerError(compiler, "too many arguments");
+        } while (clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_COMMA));
+    }
+
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN, "expected ')' after arguments");
+    clox_CompilerMark(compiler, name);
+
+    cloxEmitGlobal(&compiler->emitter, CLOX_OP_CODE_NCALL, (byte_t)count, offset);
+
+    return;
+}
+
+/**
+ * @brief       This function compiles the access to a name that is not a
+ *              variable in scope, so a global variable defined by the host: the
+ *              value goes through the scratch register.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerGlobal(CloxCompiler_t *const compiler, const CloxToken_t *const name, const bool_t canAssign)
+{
+    CloxCodeBlock_t *const codeBlock = compiler->emitter.codeBlock;
+    CLOX_REGISTER const size_t offset = cloxCodeBlockAddName(codeBlock, cloxLexerTokenText(&compiler->lexer, name), name->length);
+
+    if ((offset > UINT16_MAX) || (codeBlock->cachesCount > UINT16_MAX))
+    {
+        clox_CompilerError(compiler, "too many global variable accesses");
+        return;
+    }
+
+    if (clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_LEFT_PAREN))
+    {
+        clox_CompilerCall(compiler, name, offset);
+        return;
+    }
+
+    if (canAssign && clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_EQUAL))
+    {
+        clox_CompilerExpression(compiler);
+        clox_CompilerMark(compiler, name);
+
+        cloxEmitData(&compiler->emitter, CLOX_OP_CODE_MOV, compiler->scratch, 0x8000);
+        cloxEmitGlobal(&compiler->emitter, CLOX_OP_CODE_STG, compiler->scratch, offset);
+    }
+    else
+    {
+        clox_CompilerMark(compiler, name);
+        cloxEmitGlobal(&compiler->emitter, CLOX_OP_CODE_LDG, compiler->scratch, offset);
+        cloxEmitFast(&compiler->emitter, CLOX_OP_CODE_PSH, compiler->scratch);
+    }
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerVariable(CloxCompiler_t *const compiler, const bool_t canAssign)
+{
+    const CloxToken_t *const name = compiler->previous;
+    const CloxCompilerLocal_t *const local = clox_CompilerResolve(compiler, name);
+
+    if (!local)
+    {
+        CloxCompilerFunction_t *const function = clox_CompilerFindFunction(compiler, name);
+
+        /* the call would fail as the one of a missing native function */
+        if (!function && clox_CompilerCheck(compiler, CLOX_TOKEN_KIND_LEFT_PAREN) && clox_CompilerIsDropped(compiler, name))
+            clox_CompilerError(compiler, "function declared by a chunk that failed to compile");
+        else if (!function)
+            clox_CompilerGlobal(compiler, name, canAssign);
+        else if (clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_LEFT_PAREN))
+            clox_CompilerCallFunction(compiler, name, function);
+        else
+            clox_CompilerError(compiler, "functions can only be called");
+
+        return;
+    }
+
+    if (clox_CompilerCheck(compiler, CLOX_TOKEN_KIND_LEFT_PAREN))
+    {
+        clox_CompilerError(compiler, "only functions can be called");
+        return;
+    }
+
+    if (canAssign && clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_EQUAL))
+    {
+        clox_CompilerExpression(compiler);
+
+        /* the assigned value stays on the stack as the result */
+        cloxEmitData(&compiler->emitter, CLOX_OP_CODE_MOV, local->reg, 0x8000);
+    }
+    else
+    {
+        cloxEmitFast(&compiler->emitter, CLOX_OP_CODE_PSH, local->reg);
+    }
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerUnary(CloxCompiler_t *const compiler, const bool_t canAssign)
+{
+    (void)canAssign;
+
+    const CloxToken_t *const token = compiler->previous;
+    CLOX_REGISTER const CloxTokenKind_t operator = (CloxTokenKind_t)token->kind;
+
+    clox_CompilerParsePrecedence(compiler, CLOX_COMPILER_PRECEDENCE_UNARY);
+    clox_CompilerMark(compiler, token);
+
+    cloxEmitByte(&compiler->emitter, (operator == CLOX_TOKEN_KIND_MINUS) ? CLOX_OP_CODE_NEG : CLOX_OP_CODE_NOT);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerBinary(CloxCompiler_t *const compiler, const bool_t canAssign)
+{
+    (void)canAssign;
+
+    const CloxToken_t *const token = compiler->previous;
+    CLOX_REGISTER const CloxTokenKind_t operator = (CloxTokenKind_t)token->kind;
+
+    clox_CompilerParsePrecedence(compiler, (CloxCompilerPrecedence_t)(clox_CompilerGetRule(operator)->precedence + 1));
+    clox_CompilerMark(compiler, token);
+
+    switch (operator)
+    {
+    case CLOX_TOKEN_KIND_PLUS:
+        cloxEmitByte(&compiler->emitter, CLOX_OP_CODE_ADD);
+        break;
+
+    case CLOX_TOKEN_KIND_MINUS:
+        cloxEmitByte(&compiler->emitter, CLOX_OP_CODE_SUB);
+        break;
+
+    case CLOX_TOKEN_KIND_STAR:
+        cloxEmitByte(&compiler->emitter, CLOX_OP_CODE_MUL);
+        break;
+
+    case CLOX_TOKEN_KIND_SLASH:
+        cloxEmitByte(&compiler->emitter, CLOX_OP_CODE_DIV);
+        break;
+
+    case CLOX_TOKEN_KIND_EQUAL_EQUAL:
+        clox_CompilerEmitCompare(compiler, CLOX_OP_CODE_JEQ);
+        break;
+
+    case CLOX_TOKEN_KIND_BANG_EQUAL:
+        clox_CompilerEmitCompare(compiler, CLOX_OP_CODE_JNE);
+        break;
+
+    case CLOX_TOKEN_KIND_GREATER:
+        clox_CompilerEmitCompare(compiler, CLOX_OP_CODE_JGT);
+        break;
+
+    case CLOX_TOKEN_KIND_GREATER_EQUAL:
+        clox_CompilerEmitCompare(compiler, CLOX_OP_CODE_JGE);
+        break;
+
+    case CLOX_TOKEN_KIND_LESS:
+        clox_CompilerEmitCompare(compiler, CLOX_OP_CODE_JLT);
+        break;
+
+    default:
+        clox_CompilerEmitCompare(compiler, CLOX_OP_CODE_JLE);
+        break;
+    }
+
+    return;
+}
+
+/**
+ * @brief       This function compiles the right operand of 'and' and 'or',
+ *              evaluated only when the left one doesn't decide the result.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerLogical(CloxCompiler_t *const compiler, const bool_t canAssign)
+{
+    (void)canAssign;
+
+    CLOX_REGISTER const CloxTokenKind_t operator = (CloxTokenKind_t)compiler->previous->kind;
+
+    cloxEmitByte(&compiler->emitter, CLOX_OP_CODE_DUP);
+    cloxEmitByte(&compiler->emitter, CLOX_OP_CODE_TST);
+
+    CLOX_REGISTER const size_t endJump = cloxEmitJump(&compiler->emitter, (operator == CLOX_TOKEN_KIND_AND) ? CLOX_OP_CODE_JNT : CLOX_OP_CODE_JIT, 0);
+
+    clox_CompilerEmitDrop(compiler);
+    clox_CompilerParsePrecedence(compiler, (operator == CLOX_TOKEN_KIND_AND) ? CLOX_COMPILER_PRECEDENCE_AND : CLOX_COMPILER_PRECEDENCE_OR);
+    clox_CompilerPatchHere(compiler, endJump);
+
+    return;
+}
+
+#define clox_CompilerDefineRule(kind, prefix, infix, precedence) [kind] = { prefix, infix, precedence }
+
+CLOX_STATIC const CloxCompilerRule_t clox_CompilerRules[CLOX_TOKEN_KIND_COUNT] = {
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_LEFT_PAREN,    clox_CompilerGrouping,    NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_MINUS,         clox_CompilerUnary,       clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_TERM),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_PLUS,          NULL,                     clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_TERM),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_SLASH,         NULL,                     clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_FACTOR),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_STAR,          NULL,                     clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_FACTOR),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_BANG,          clox_CompilerUnary,       NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_BANG_EQUAL,    NULL,                     clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_EQUALITY),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_EQUAL_EQUAL,   NULL,                     clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_EQUALITY),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_GREATER,       NULL,                     clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_COMPARISON),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_GREATER_EQUAL, NULL,                     clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_COMPARISON),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_LESS,          NULL,                     clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_COMPARISON),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_LESS_EQUAL,    NULL,                     clox_CompilerBinary,  CLOX_COMPILER_PRECEDENCE_COMPARISON),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_IDENTIFIER,    clox_CompilerVariable,    NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_STRING,        clox_CompilerUnsupported, NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_NUMBER,        clox_CompilerNumber,      NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_AND,           NULL,                     clox_CompilerLogical, CLOX_COMPILER_PRECEDENCE_AND),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_OR,            NULL,                     clox_CompilerLogical, CLOX_COMPILER_PRECEDENCE_OR),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_FALSE,         clox_CompilerLiteral,     NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_NIL,           clox_CompilerLiteral,     NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_TRUE,          clox_CompilerLiteral,     NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_THIS,          clox_CompilerUnsupported, NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+    clox_CompilerDefineRule(CLOX_TOKEN_KIND_SUPER,         clox_CompilerUnsupported, NULL,                 CLOX_COMPILER_PRECEDENCE_NONE),
+};
+
+#undef clox_CompilerDefineRule
+
+CLOX_STATIC const CloxCompilerRule_t *CLOX_STDCALL clox_CompilerGetRule(const CloxTokenKind_t kind)
+{
+    return &clox_CompilerRules[kind];
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerParsePrecedence(CloxCompiler_t *const compiler, const CloxCompilerPrecedence_t precedence)
+{
+    clox_CompilerAdvance(compiler);
+
+    const CloxCompilerParser_t prefix = clox_CompilerGetRule((CloxTokenKind_t)compiler->previous->kind)->prefix;
+
+    if (!prefix)
+    {
+        clox_CompilerError(compiler, "expected expression");
+        return;
+    }
+
+    CLOX_REGISTER const bool_t canAssign = precedence <= CLOX_COMPILER_PRECEDENCE_ASSIGNMENT;
+
+    prefix(compiler, canAssign);
+
+    while (precedence <= clox_CompilerGetRule((CloxTokenKind_t)compiler->current->kind)->precedence)
+    {
+        clox_CompilerAdvance(compiler);
+        clox_CompilerGetRule((CloxTokenKind_t)compiler->previous->kind)->infix(compiler, canAssign);
+    }
+
+    if (canAssign && clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_EQUAL))
+        clox_CompilerError(compiler, "invalid assignment target");
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerExpression(CloxCompiler_t *const compiler)
+{
+    clox_CompilerParsePrecedence(compiler, CLOX_COMPILER_PRECEDENCE_ASSIGNMENT);
+
+    return;
+}
+
+#pragma endregion
+
+#pragma region Statements
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerVarDeclaration(CloxCompiler_t *const compiler)
+{
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_IDENTIFIER, "expected variable name");
+
+    if (compiler->previous->kind != CLOX_TOKEN_KIND_IDENTIFIER)
+        return;
+
+    CloxCompilerLocal_t *const local = clox_CompilerDeclare(compiler);
+
+    if (clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_EQUAL))
+        clox_CompilerExpression(compiler);
+    else
+        clox_CompilerEmitConstant(compiler, cloxVoidValue());
+
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_SEMICOLON, "expected ';' after variable declaration");
+
+    if (!local)
+        return;
+
+    local->depth = compiler->scopeDepth;
+    cloxEmitFast(&compiler->emitter, CLOX_OP_CODE_POP, local->reg);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerExpressionStatement(CloxCompiler_t *const compiler)
+{
+    clox_CompilerExpression(compiler);
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_SEMICOLON, "expected ';' after expression");
+    clox_CompilerEmitDrop(compiler);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerPrintStatement(CloxCompiler_t *const compiler)
+{
+    clox_CompilerExpression(compiler);
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_SEMICOLON, "expected ';' after value");
+
+    cloxEmitCtrl(&compiler->emitter, CLOX_OP_CODE_RAISE, CLOX_COMPILER_SIGNAL_PRINT, 0);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerBlock(CloxCompiler_t *const compiler)
+{
+    while (!clox_CompilerCheck(compiler, CLOX_TOKEN_KIND_RIGHT_BRACE) && !clox_CompilerCheck(compiler, CLOX_TOKEN_KIND_EOF))
+        clox_CompilerDeclaration(compiler);
+
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_RIGHT_BRACE, "expected '}' after block");
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerIfStatement(CloxCompiler_t *const compiler)
+{
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_LEFT_PAREN, "expected '(' after 'if'");
+    clox_CompilerExpression(compiler);
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN, "expected ')' after condition");
+
+    CLOX_REGISTER const size_t thenJump = clox_CompilerEmitCondition(compiler);
+
+    clox_CompilerStatement(compiler);
+
+    if (!clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_ELSE))
+    {
+        clox_CompilerPatchHere(compiler, thenJump);
+        return;
+    }
+
+    CLOX_REGISTER const size_t elseJump = cloxEmitJump(&compiler->emitter, CLOX_OP_CODE_JMP, 0);
+
+    clox_CompilerPatchHere(compiler, thenJump);
+    clox_CompilerStatement(compiler);
+    clox_CompilerPatchHere(compiler, elseJump);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerWhileStatement(CloxCompiler_t *const compiler)
+{
+    CLOX_REGISTER const size_t loopStart = cloxEmitterOffset(&compiler->emitter);
+
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_LEFT_PAREN, "expected '(' after 'while'");
+    clox_CompilerExpression(compiler);
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN, "expected ')' after condition");
+
+    CLOX_REGISTER const size_t exitJump = clox_CompilerEmitCondition(compiler);
+
+    clox_CompilerStatement(compiler);
+    cloxEmitJumpTo(&compiler->emitter, CLOX_OP_CODE_JMP, loopStart);
+    clox_CompilerPatchHere(compiler, exitJump);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerForStatement(CloxCompiler_t *const compiler)
+{
+    clox_CompilerBeginScope(compiler);
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_LEFT_PAREN, "expected '(' after 'for'");
+
+    if (clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_VAR))
+        clox_CompilerVarDeclaration(compiler);
+    else if (!clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_SEMICOLON))
+        clox_CompilerExpressionStatement(compiler);
+
+    CLOX_REGISTER size_t loopStart = cloxEmitterOffset(&compiler->emitter);
+    CLOX_REGISTER bool_t hasExit   = FALSE;
+    CLOX_REGISTER size_t exitJump  = 0;
+
+    if (!clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_SEMICOLON))
+    {
+        clox_CompilerExpression(compiler);
+        clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_SEMICOLON, "expected ';' after loop condition");
+
+        exitJump = clox_CompilerEmitCondition(compiler);
+        hasExit  = TRUE;
+    }
+
+    if (!clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN))
+    {
+        /* the increment is emitted before the body, which jumps back to it */
+        CLOX_REGISTER const size_t bodyJump = cloxEmitJump(&compiler->emitter, CLOX_OP_CODE_JMP, 0);
+        CLOX_REGISTER const size_t incrementStart = cloxEmitterOffset(&compiler->emitter);
+
+        clox_CompilerExpression(compiler);
+        clox_CompilerEmitDrop(compiler);
+        clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN, "expected ')' after for clauses");
+
+        cloxEmitJumpTo(&compiler->emitter, CLOX_OP_CODE_JMP, loopStart);
+
+        loopStart = incrementStart;
+        clox_CompilerPatchHere(compiler, bodyJump);
+    }
+
+    clox_CompilerStatement(compiler);
+    cloxEmitJumpTo(&compiler->emitter, CLOX_OP_CODE_JMP, loopStart);
+
+    if (hasExit)
+        clox_CompilerPatchHere(compiler, exitJump);
+
+    clox_CompilerEndScope(compiler);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerReturnStatement(CloxCompiler_t *const compiler)
+{
+    if (!compiler->function)
+        clox_CompilerError(compiler, "can't return from the script");
+
+    if (clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_SEMICOLON))
+    {
+        clox_CompilerEmitConstant(compiler, cloxVoidValue());
+    }
+    else
+    {
+        compiler->tailCall = compiler->function ? compiler->current : NULL;
+
+        clox_CompilerExpression(compiler);
+        clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_SEMICOLON, "expected ';' after return value");
+
+        compiler->tailCall = NULL;
+    }
+
+    cloxEmitByte(&compiler->emitter, CLOX_OP_CODE_RET);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerStatement(CloxCompiler_t *const compiler)
+{
+    switch (compiler->current->kind)
+    {
+    case CLOX_TOKEN_KIND_PRINT:
+        clox_CompilerAdvance(compiler);
+        clox_CompilerPrintStatement(compiler);
+        break;
+
+    case CLOX_TOKEN_KIND_IF:
+        clox_CompilerAdvance(compiler);
+        clox_CompilerIfStatement(compiler);
+        break;
+
+    case CLOX_TOKEN_KIND_WHILE:
+        clox_CompilerAdvance(compiler);
+        clox_CompilerWhileStatement(compiler);
+        break;
+
+    case CLOX_TOKEN_KIND_FOR:
+        clox_CompilerAdvance(compiler);
+        clox_CompilerForStatement(compiler);
+        break;
+
+    case CLOX_TOKEN_KIND_LEFT_BRACE:
+        clox_CompilerAdvance(compiler);
+        clox_CompilerBeginScope(compiler);
+        clox_CompilerBlock(compiler);
+        clox_CompilerEndScope(compiler);
+        break;
+
+    case CLOX_TOKEN_KIND_RETURN:
+        clox_CompilerAdvance(compiler);
+        clox_CompilerReturnStatement(compiler);
+        break;
+
+    default:
+        clox_CompilerExpressionStatement(compiler);
+        break;
+    }
+
+    return;
+}
+
+/**
+ * @brief       This function declares a function, its body is only scanned for
+ *              its closing bracket: unless every body has to be compiled, it is
+ *              compiled once a call to the function is.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CompilerFunDeclaration(CloxCompiler_t *const compiler)
+{
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_IDENTIFIER, "expected function name");
+
+    if (compiler->previous->kind != CLOX_TOKEN_KIND_IDENTIFIER)
+        return;
+
+    const CloxToken_t *const declaration = compiler->previous;
+
+    /* a misplaced declaration is still skipped as a whole */
+    if (compiler->function || compiler->scopeDepth)
+        clox_CompilerError(compiler, "functions can only be declared by the script");
+    else if (clox_CompilerFindFunction(compiler, declaration))
+        clox_CompilerError(compiler, "already a function with this name");
+
+    CLOX_REGISTER size_t arity = 0;
+
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_LEFT_PAREN, "expected '(' after function name");
+
+    if (!clox_CompilerCheck(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN))
+    {
+        do
+        {
+            clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_IDENTIFIER, "expected parameter name");
+
+            if (arity++ == BYTE_MAX)
+                clox_CompilerError(compiler, "too many parameters");
+        } while (clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_COMMA));
+    }
+
+    clox_CompilerConsume(compiler, CLOX_TOKEN_KIND_RIGHT_PAREN, "expected ')' after parameters");
+
+    if (!clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_LEFT_BRACE))
+    {
+        clox_CompilerErrorAt(compiler, compiler->current, "expected '{' before function body");
+        return;
+    }
+
+    CLOX_REGISTER size_t depth = 1;
+
+    /* the tokens of the body are skipped as they are, their errors are
+     * reported when it is compiled */
+    for (; compiler->current->kind != CLOX_TOKEN_KIND_EOF; compiler->current++)
+    {
+        if (compiler->current->kind == CLOX_TOKEN_KIND_LEFT_BRACE)
+            depth++;
+        else if ((compiler->current->kind == CLOX_TOKEN_KIND_RIGHT_BRACE) && !--depth)
+            break;
+    }
+
+    if (depth)
+    {
+        clox_CompilerErrorAt(compiler, compiler->current, "expected '}' after function body");
+        return;
+    }
+
+    /* the declaration has been skipped as a whole, so the parser is already
+     * synchronized (the errors that follow the bracket are reported) */
+    if (compiler->panicMode)
+    {
+        compiler->panicMode = FALSE;
+        clox_CompilerAdvance(compiler);
+        return;
+    }
+
+    if (compiler->functionsCount >= compiler->functionsCapacity)
+    {
+        compiler->functionsCapacity = compiler->functionsCapacity ? compiler->functionsCapacity * 2 : 8;
+        compiler->functions = redim(CloxCompilerFunction_t, compiler->functions, compiler->functionsCapacity);
+    }
+
+    CloxCompilerFunction_t *const function = &compiler->functions[compiler->functionsCount++];
+
+    function->name        = clox_CompilerIntern(compiler, declaration);
+    function->declaration = declaration;
+    function->end         = compiler->current;
+    function->offset      = SIZE_MAX;
+    function->next        = SIZE_MAX;
+    function->chunk       = SIZE_MAX;
+    function->arity       = (byte_t)arity;
+    function->isQueued    = FALSE;
+
+    clox_CompilerAdvance(compiler);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_CompilerDeclaration(CloxCompiler_t *const compiler)
+{
+    clox_CompilerMark(compiler, compiler->current);
+
+    switch (compiler->current->kind)
+    {
+    case CLOX_TOKEN_KIND_VAR:
+        clox_CompilerAdvance(compiler);
+        clox_CompilerVarDeclaration(compiler);
+        break;
+
+    case CLOX_TOKEN_KIND_FUN:
+        clox_CompilerAdvance(compiler);
+        clox_CompilerFunDeclaration(compiler);
+        break;
+
+    case CLOX_TOKEN_KIND_CLASS:
+        clox_CompilerAdvance(compiler);
+        clox_CompilerError(compiler, "unsupported declaration");
+        break;
+
+    default:
+        clox_CompilerStatement(compiler);
+        break;
+    }
+
+    if (compiler->panicMode)
+        clox_CompilerSynchronize(compiler);
+
+    return;
+}
+
+#pragma endregion
+
+CLOX_API CloxCompiler_t *CLOX_STDCALL cloxInitCompiler(CloxCompiler_t *const compiler, CloxArena_t *const arena)
+{
+    assert(compiler != NULL);
+
+    cloxInitLexer(&compiler->lexer, arena);
+    cloxInitStringTable(&compiler->strings, arena);
+
+    compiler->emitter.codeBlock      = NULL;
+    compiler->emitter.registersCount = 0;
+    compiler->emitter.registersMax   = 0;
+
+    compiler->name        = NULL;
+    compiler->errorStream = NULL;
+    compiler->line        = 0;
+    compiler->current     = NULL;
+    compiler->previous    = NULL;
+    compiler->localsCount = 0;
+    compiler->scopeDepth  = 0;
+    compiler->scratch     = 0;
+    compiler->errorsCount = 0;
+    compiler->panicMode   = FALSE;
+
+    compiler->functions         = NULL;
+    compiler->functionsCount    = 0;
+    compiler->functionsCapacity = 0;
+    compiler->functionsKept     = 0;
+    compiler->chunks            = NULL;
+    compiler->chunksCount       = 0;
+    compiler->chunksCapacity    = 0;
+    compiler->dropped           = NULL;
+    compiler->droppedCount      = 0;
+    compiler->droppedCapacity   = 0;
+    compiler->pending           = SIZE_MAX;
+    compiler->calls             = NULL;
+    compiler->callsCount        = 0;
+    compiler->callsCapacity     = 0;
+    compiler->function          = NULL;
+    compiler->tailCall          = NULL;
+    compiler->localsBase        = 0;
+    compiler->verify            = FALSE;
+    compiler->optimization      = CLOX_OPTIMIZATION_LEVEL_DEFAULT;
+
+    return compiler;
+}
+
+CLOX_API CloxCompiler_t *CLOX_STDCALL cloxFreeCompiler(CloxCompiler_t *const compiler)
+{
+    assert(compiler != NULL);
+
+    cloxFreeLexer(&compiler->lexer);
+    cloxFreeEmitter(&compiler->emitter);
+    cloxFreeStringTable(&compiler->strings);
+
+    clox_CompilerDropChunks(compiler);
+
+    if (compiler->chunks)
+        dealloc(compiler->chunks);
+
+    if (compiler->functions)
+        dealloc(compiler->functions);
+
+    if (compiler->dropped)
+        dealloc(compiler->dropped);
+
+    if (compiler->calls)
+        dealloc(compiler->calls);
+
+    compiler->functionsCount    = 0;
+    compiler->functionsCapacity = 0;
+    compiler->chunks            = NULL;
+    compiler->chunksCapacity    = 0;
+    compiler->dropped           = NULL;
+    compiler->droppedCapacity   = 0;
+    compiler->callsCount        = 0;
+    compiler->callsCapacity     = 0;
+
+    compiler->current     = NULL;
+    compiler->previous    = NULL;
+    compiler->localsCount = 0;
+    compiler->scopeDepth  = 0;
+
+    return compiler;
+}
+
+/**
+ * @brief       This function parses the scanned tokens up to the end of the
+ *              source, then compiles the bodies of the functions that are
+ *              called (or all of them when isEager is set). The state of the
+ *              scopes is set by the caller.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_CompilerParse(CloxCompiler_t *const compiler, const char *const name, const bool_t isEager)
+{
+    compiler->name        = name;
+    compiler->errorsCount = 0;
+    compiler->panicMode   = FALSE;
+
+    compiler->functionsCount = compiler->functionsKept;
+    compiler->pending        = SIZE_MAX;
+    compiler->callsCount     = 0;
+    compiler->function       = NULL;
+    compiler->tailCall       = NULL;
+    compiler->localsBase     = 0;
+
+    /* the kept functions are compiled again into the block that calls them */
+    for (size_t i = 0; i < compiler->functionsKept; i++)
+    {
+        compiler->functions[i].offset   = SIZE_MAX;
+        compiler->functions[i].next     = SIZE_MAX;
+        compiler->functions[i].isQueued = FALSE;
+    }
+
+    compiler->current = compiler->lexer.tokens;
+    clox_CompilerSkipErrors(compiler);
+    compiler->previous = compiler->current;
+
+    while (!clox_CompilerMatch(compiler, CLOX_TOKEN_KIND_EOF))
+        clox_CompilerDeclaration(compiler);
+
+    if (isEager)
+    {
+        for (size_t i = compiler->functionsKept; i < compiler->functionsCount; i++)
+            clox_CompilerQueue(compiler, &compiler->functions[i]);
+    }
+
+    clox_CompilerFunctions(compiler);
+
+    return !compiler->errorsCount;
+}
+
+/**
+ * @brief       This function checks if the scanned tokens end with a complete
+ *              statement: the brackets are balanced (or closed too many times,
+ *              which is an error to report) and the last token ends a
+ *              statement.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_CompilerIsComplete(const CloxCompiler_t *const compiler)
+{
+    const CloxToken_t *const tokens = compiler->lexer.tokens;
+    const size_t count = compiler->lexer.tokensCount - 1;
+    int64_t depth = 0;
+
+    /* an empty source is complete, it compiles to nothing */
+    if (!count)
+        return TRUE;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        switch (tokens[i].kind)
+        {
+        case CLOX_TOKEN_KIND_LEFT_PAREN:
+        case CLOX_TOKEN_KIND_LEFT_BRACE:
+            depth++;
+            break;
+
+        case CLOX_TOKEN_KIND_RIGHT_PAREN:
+        case CLOX_TOKEN_KIND_RIGHT_BRACE:
+            depth--;
+            break;
+
+        case CLOX_TOKEN_KIND_ERROR:
+            return TRUE;
+
+        default:
+            break;
+        }
+    }
+
+    if (depth < 0)
+        return TRUE;
+
+    return !depth && ((tokens[count - 1].kind == CLOX_TOKEN_KIND_SEMICOLON) || (tokens[count - 1].kind == CLOX_TOKEN_KIND_RIGHT_BRACE));
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxCompile(CloxCompiler_t *const compiler, const CloxSourceBuffer_t *const sourceBuffer, const char *const name, CloxCodeBlock_t *const codeBlock)
+{
+    assert(compiler != NULL && sourceBuffer != NULL && codeBlock != NULL);
+
+    cloxLexerScanBuffer(&compiler->lexer, sourceBuffer);
+    cloxInitEmitter(&compiler->emitter, codeBlock);
+
+    compiler->line        = 0;
+    compiler->localsCount = 0;
+    compiler->scopeDepth  = 0;
+    compiler->scratch     = cloxEmitterPushRegister(&compiler->emitter);
+
+    clox_CompilerDropChunks(compiler);
+
+    if (!clox_CompilerParse(compiler, name, compiler->verify))
+        return FALSE;
+
+    cloxCodeBlockOptimize(codeBlock, compiler->optimization);
+
+    return TRUE;
+}
+
+CLOX_API CloxCompilerStatus_t CLOX_STDCALL cloxCompileIncremental(CloxCompiler_t *const compiler, const CloxSourceBuffer_t *const sourceBuffer, const char *const name, CloxCodeBlock_t *const codeBlock, const bool_t isLast)
+{
+    assert(compiler != NULL && sourceBuffer != NULL && codeBlock != NULL);
+
+    cloxLexerScanBuffer(&compiler->lexer, sourceBuffer);
+
+    if (!isLast && !clox_CompilerIsComplete(compiler))
+        return CLOX_COMPILER_STATUS_INCOMPLETE;
+
+    const size_t localsCount = compiler->localsCount;
+
+    /* the variables of the previous chunks keep their registers, which follow
+     * the scratch one */
+    cloxInitEmitter(&compiler->emitter, codeBlock);
+
+    compiler->scopeDepth = 0;
+    compiler->scratch    = cloxEmitterPushRegister(&compiler->emitter);
+
+    compiler->emitter.registersCount += (uint16_t)localsCount;
+    compiler->emitter.registersMax    = compiler->emitter.registersCount;
+
+    /* the functions of a chunk are all compiled, so that their errors are
+     * reported before it is kept */
+    const bool_t result = clox_CompilerParse(compiler, name, TRUE);
+
+    if (result)
+        clox_CompilerKeepChunk(compiler);
+
+    /* the next chunk begins on the line of the end of this one */
+    compiler->line += compiler->lexer.tokens[compiler->lexer.tokensCount - 1].line;
+
+    if (!result)
+    {
+        clox_CompilerDropFunctions(compiler);
+
+        compiler->localsCount = localsCount;
+        compiler->scopeDepth  = 0;
+
+        return CLOX_COMPILER_STATUS_ERROR;
+    }
+
+    cloxCodeBlockOptimize(codeBlock, compiler->optimization);
+
+    return CLOX_COMPILER_STATUS_SUCCESS;
+}
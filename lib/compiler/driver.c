@@ -0,0 +1,182 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/thread.h"
+#include "clox/compiler/compiler.h"
+#include "clox/compiler/driver.h"
+#include "clox/source/source_buffer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief       This data structure provides the jobs shared by the workers.
+ */
+typedef struct _CloxCompileQueue
+{
+    CloxCompileJob_t *jobs;
+    size_t            count;
+    volatile size_t   next;
+    volatile size_t   compiled;
+    CloxMemory_t     *memory;
+} CloxCompileQueue_t;
+
+/**
+ * @brief       This function moves the errors written since the specified
+ *              position of the stream into the diagnostics of a job.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_DriverCollect(FILE *const stream, const long begin, CloxCompileJob_t *const job)
+{
+    const long end = ftell(stream);
+
+    if ((begin < 0) || (end <= begin))
+        return;
+
+    job->diagnostics = dim(char, (size_t)(end - begin) + 1);
+
+    fseek(stream, begin, SEEK_SET);
+    job->diagnostics[fread(job->diagnostics, 1, (size_t)(end - begin), stream)] = '\0';
+    fseek(stream, end, SEEK_SET);
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_DriverWork(void *const argument)
+{
+    CloxCompileQueue_t *const queue = (CloxCompileQueue_t *)argument;
+    CloxCompiler_t compiler;
+    CloxArena_t arena;
+
+    CLOX_REGISTER size_t index;
+
+    /* the workers account their memory like the thread that started them */
+    CloxMemory_t *const memory = cloxSetMemory(queue->memory);
+
+    /* the errors are kept apart, so that they are reported in the order of
+     * the modules (without a temporary file they go straight to stderr) */
+    FILE *const errors = tmpfile();
+
+    cloxInitArena(&arena, 0);
+    cloxInitCompiler(&compiler, &arena);
+
+    compiler.errorStream = errors;
+
+    while ((index = cloxAtomicFetchAdd(&queue->next, 1)) < queue->count)
+    {
+        CloxCompileJob_t *const job = &queue->jobs[index];
+        CloxSourceBuffer_t *const sourceBuffer = cloxCreateSourceBufferFromFile(job->path);
+
+        if (!sourceBuffer)
+        {
+            job->status = CLOX_COMPILE_JOB_STATUS_NOINPUT;
+            continue;
+        }
+
+        const long begin = errors ? ftell(errors) : -1;
+
+        compiler.verify       = job->verify;
+        compiler.optimization = job->optimization;
+
+        if (cloxCompile(&compiler, sourceBuffer, job->path, &job->codeBlock))
+        {
+            job->status = CLOX_COMPILE_JOB_STATUS_SUCCESS;
+            cloxAtomicFetchAdd(&queue->compiled, 1);
+        }
+        else
+        {
+            job->status = CLOX_COMPILE_JOB_STATUS_ERROR;
+        }
+
+        if (errors)
+            clox_DriverCollect(errors, begin, job);
+
+        cloxDeleteSourceBuffer(sourceBuffer);
+    }
+
+    cloxFreeCompiler(&compiler);
+    cloxFreeArena(&arena);
+
+    if (errors)
+        fclose(errors);
+
+    cloxSetMemory(memory);
+
+    return;
+}
+
+CLOX_API CloxCompileJob_t *CLOX_STDCALL cloxInitCompileJob(CloxCompileJob_t *const job, const char *const path)
+{
+    assert(job != NULL && path != NULL);
+
+    job->path         = path;
+    job->diagnostics  = NULL;
+    job->status       = CLOX_COMPILE_JOB_STATUS_PENDING;
+    job->verify       = FALSE;
+    job->optimization = CLOX_OPTIMIZATION_LEVEL_DEFAULT;
+
+    cloxInitCodeBlock(&job->codeBlock, 0);
+
+    return job;
+}
+
+CLOX_API CloxCompileJob_t *CLOX_STDCALL cloxFreeCompileJob(CloxCompileJob_t *const job)
+{
+    assert(job != NULL);
+
+    cloxFreeCodeBlock(&job->codeBlock);
+
+    if (job->diagnostics)
+        dealloc(job->diagnostics);
+
+    return job;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxCompileJobs(CloxCompileJob_t *const jobs, const size_t count, size_t threads)
+{
+    assert(jobs != NULL || !count);
+
+    CloxCompileQueue_t queue;
+    CloxThread_t *workers;
+
+    CLOX_REGISTER size_t i, started;
+
+    queue.jobs     = jobs;
+    queue.count    = count;
+    queue.next     = 0;
+    queue.compiled = 0;
+    queue.memory   = cloxGetMemory();
+
+    if (!threads)
+        threads = cloxThreadCount();
+
+    if (threads > count)
+        threads = count;
+
+    if (threads <= 1)
+    {
+        clox_DriverWork(&queue);
+        return queue.compiled;
+    }
+
+    /* workers that cannot start leave their jobs to the others */
+    workers = dim(CloxThread_t, threads - 1);
+
+    for (i = 0, started = 0; i < (threads - 1); i++)
+    {
+        if ((workers[started] = cloxThreadCreate(&clox_DriverWork, &queue)))
+            started++;
+    }
+
+    clox_DriverWork(&queue);
+
+    for (i = 0; i < started; i++)
+        cloxThreadJoin(workers[i]);
+
+    dealloc(workers);
+
+    return queue.compiled;
+}
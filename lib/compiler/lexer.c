@@ -0,0 +1,454 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/errno.h"
+#include "clox/base/utils.h"
+#include "clox/compiler/lexer.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#ifndef CLOX_LEXER_GROWING_FACTOR
+#   define CLOX_LEXER_GROWING_FACTOR 2
+#endif
+
+#ifndef CLOX_LEXER_SHORT_RUN
+#   define CLOX_LEXER_SHORT_RUN 16
+#endif
+
+#ifndef CLOX_LEXER_BYTES_PER_TOKEN
+/* the initial capacity of the tokens array is guessed from the buffer size */
+#   define CLOX_LEXER_BYTES_PER_TOKEN 4
+#endif
+
+/**
+ * @brief       The actions of the lexer, selected by the first byte of each
+ *              lexeme.
+ */
+typedef enum _CloxLexerAction
+{
+    CLOX_LEXER_ACTION_INVALID = 0x00,
+    CLOX_LEXER_ACTION_SPACE,
+    CLOX_LEXER_ACTION_SINGLE,
+    CLOX_LEXER_ACTION_EQUAL,
+    CLOX_LEXER_ACTION_SLASH,
+    CLOX_LEXER_ACTION_ALPHA,
+    CLOX_LEXER_ACTION_DIGIT,
+    CLOX_LEXER_ACTION_QUOTE,
+} CloxLexerAction_t;
+
+/* bytes not listed (so the ones with the high bit set too) are invalid */
+CLOX_STATIC const byte_t clox_LexerActions[BYTE_MAX + 1] = {
+    [' ']  = CLOX_LEXER_ACTION_SPACE,  ['\t'] = CLOX_LEXER_ACTION_SPACE,  ['\r'] = CLOX_LEXER_ACTION_SPACE,
+    ['\n'] = CLOX_LEXER_ACTION_SPACE,  ['\v'] = CLOX_LEXER_ACTION_SPACE,  ['\f'] = CLOX_LEXER_ACTION_SPACE,
+
+    ['(']  = CLOX_LEXER_ACTION_SINGLE, [')']  = CLOX_LEXER_ACTION_SINGLE, ['{']  = CLOX_LEXER_ACTION_SINGLE,
+    ['}']  = CLOX_LEXER_ACTION_SINGLE, [',']  = CLOX_LEXER_ACTION_SINGLE, ['.']  = CLOX_LEXER_ACTION_SINGLE,
+    ['-']  = CLOX_LEXER_ACTION_SINGLE, ['+']  = CLOX_LEXER_ACTION_SINGLE, [';']  = CLOX_LEXER_ACTION_SINGLE,
+    ['*']  = CLOX_LEXER_ACTION_SINGLE,
+
+    ['!']  = CLOX_LEXER_ACTION_EQUAL,  ['=']  = CLOX_LEXER_ACTION_EQUAL,  ['>']  = CLOX_LEXER_ACTION_EQUAL,
+    ['<']  = CLOX_LEXER_ACTION_EQUAL,
+
+    ['/']  = CLOX_LEXER_ACTION_SLASH,
+    ['"']  = CLOX_LEXER_ACTION_QUOTE,
+
+    ['0']  = CLOX_LEXER_ACTION_DIGIT,  ['1']  = CLOX_LEXER_ACTION_DIGIT,  ['2']  = CLOX_LEXER_ACTION_DIGIT,
+    ['3']  = CLOX_LEXER_ACTION_DIGIT,  ['4']  = CLOX_LEXER_ACTION_DIGIT,  ['5']  = CLOX_LEXER_ACTION_DIGIT,
+    ['6']  = CLOX_LEXER_ACTION_DIGIT,  ['7']  = CLOX_LEXER_ACTION_DIGIT,  ['8']  = CLOX_LEXER_ACTION_DIGIT,
+    ['9']  = CLOX_LEXER_ACTION_DIGIT,
+
+    ['_']  = CLOX_LEXER_ACTION_ALPHA,
+    ['a']  = CLOX_LEXER_ACTION_ALPHA,  ['b']  = CLOX_LEXER_ACTION_ALPHA,  ['c']  = CLOX_LEXER_ACTION_ALPHA,
+    ['d']  = CLOX_LEXER_ACTION_ALPHA,  ['e']  = CLOX_LEXER_ACTION_ALPHA,  ['f']  = CLOX_LEXER_ACTION_ALPHA,
+    ['g']  = CLOX_LEXER_ACTION_ALPHA,  ['h']  = CLOX_LEXER_ACTION_ALPHA,  ['i']  = CLOX_LEXER_ACTION_ALPHA,
+    ['j']  = CLOX_LEXER_ACTION_ALPHA,  ['k']  = CLOX_LEXER_ACTION_ALPHA,  ['l']  = CLOX_LEXER_ACTION_ALPHA,
+    ['m']  = CLOX_LEXER_ACTION_ALPHA,  ['n']  = CLOX_LEXER_ACTION_ALPHA,  ['o']  = CLOX_LEXER_ACTION_ALPHA,
+    ['p']  = CLOX_LEXER_ACTION_ALPHA,  ['q']  = CLOX_LEXER_ACTION_ALPHA,  ['r']  = CLOX_LEXER_ACTION_ALPHA,
+    ['s']  = CLOX_LEXER_ACTION_ALPHA,  ['t']  = CLOX_LEXER_ACTION_ALPHA,  ['u']  = CLOX_LEXER_ACTION_ALPHA,
+    ['v']  = CLOX_LEXER_ACTION_ALPHA,  ['w']  = CLOX_LEXER_ACTION_ALPHA,  ['x']  = CLOX_LEXER_ACTION_ALPHA,
+    ['y']  = CLOX_LEXER_ACTION_ALPHA,  ['z']  = CLOX_LEXER_ACTION_ALPHA,
+    ['A']  = CLOX_LEXER_ACTION_ALPHA,  ['B']  = CLOX_LEXER_ACTION_ALPHA,  ['C']  = CLOX_LEXER_ACTION_ALPHA,
+    ['D']  = CLOX_LEXER_ACTION_ALPHA,  ['E']  = CLOX_LEXER_ACTION_ALPHA,  ['F']  = CLOX_LEXER_ACTION_ALPHA,
+    ['G']  = CLOX_LEXER_ACTION_ALPHA,  ['H']  = CLOX_LEXER_ACTION_ALPHA,  ['I']  = CLOX_LEXER_ACTION_ALPHA,
+    ['J']  = CLOX_LEXER_ACTION_ALPHA,  ['K']  = CLOX_LEXER_ACTION_ALPHA,  ['L']  = CLOX_LEXER_ACTION_ALPHA,
+    ['M']  = CLOX_LEXER_ACTION_ALPHA,  ['N']  = CLOX_LEXER_ACTION_ALPHA,  ['O']  = CLOX_LEXER_ACTION_ALPHA,
+    ['P']  = CLOX_LEXER_ACTION_ALPHA,  ['Q']  = CLOX_LEXER_ACTION_ALPHA,  ['R']  = CLOX_LEXER_ACTION_ALPHA,
+    ['S']  = CLOX_LEXER_ACTION_ALPHA,  ['T']  = CLOX_LEXER_ACTION_ALPHA,  ['U']  = CLOX_LEXER_ACTION_ALPHA,
+    ['V']  = CLOX_LEXER_ACTION_ALPHA,  ['W']  = CLOX_LEXER_ACTION_ALPHA,  ['X']  = CLOX_LEXER_ACTION_ALPHA,
+    ['Y']  = CLOX_LEXER_ACTION_ALPHA,  ['Z']  = CLOX_LEXER_ACTION_ALPHA,
+};
+
+/* the kinds of single tokens, for '!', '=', '>' and '<' the next kind is the
+ * one of the token followed by '=' */
+CLOX_STATIC const byte_t clox_LexerKinds[BYTE_MAX + 1] = {
+    ['(']  = CLOX_TOKEN_KIND_LEFT_PAREN,  [')']  = CLOX_TOKEN_KIND_RIGHT_PAREN,
+    ['{']  = CLOX_TOKEN_KIND_LEFT_BRACE,  ['}']  = CLOX_TOKEN_KIND_RIGHT_BRACE,
+    [',']  = CLOX_TOKEN_KIND_COMMA,       ['.']  = CLOX_TOKEN_KIND_DOT,
+    ['-']  = CLOX_TOKEN_KIND_MINUS,       ['+']  = CLOX_TOKEN_KIND_PLUS,
+    [';']  = CLOX_TOKEN_KIND_SEMICOLON,   ['*']  = CLOX_TOKEN_KIND_STAR,
+    ['!']  = CLOX_TOKEN_KIND_BANG,        ['=']  = CLOX_TOKEN_KIND_EQUAL,
+    ['>']  = CLOX_TOKEN_KIND_GREATER,     ['<']  = CLOX_TOKEN_KIND_LESS,
+};
+
+/* the source classes of each byte, as used by cloxSourceBufferSpan */
+CLOX_STATIC const byte_t clox_LexerClasses[BYTE_MAX + 1] = {
+    [' ']  = CLOX_SOURCE_CLASS_SPACE,  ['\t'] = CLOX_SOURCE_CLASS_SPACE,  ['\r'] = CLOX_SOURCE_CLASS_SPACE,
+    ['\n'] = CLOX_SOURCE_CLASS_SPACE,  ['\v'] = CLOX_SOURCE_CLASS_SPACE,  ['\f'] = CLOX_SOURCE_CLASS_SPACE,
+
+    ['0']  = CLOX_SOURCE_CLASS_DIGIT,  ['1']  = CLOX_SOURCE_CLASS_DIGIT,  ['2']  = CLOX_SOURCE_CLASS_DIGIT,
+    ['3']  = CLOX_SOURCE_CLASS_DIGIT,  ['4']  = CLOX_SOURCE_CLASS_DIGIT,  ['5']  = CLOX_SOURCE_CLASS_DIGIT,
+    ['6']  = CLOX_SOURCE_CLASS_DIGIT,  ['7']  = CLOX_SOURCE_CLASS_DIGIT,  ['8']  = CLOX_SOURCE_CLASS_DIGIT,
+    ['9']  = CLOX_SOURCE_CLASS_DIGIT,
+
+    ['_']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['a']  = CLOX_SOURCE_CLASS_ALPHA,  ['b']  = CLOX_SOURCE_CLASS_ALPHA,  ['c']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['d']  = CLOX_SOURCE_CLASS_ALPHA,  ['e']  = CLOX_SOURCE_CLASS_ALPHA,  ['f']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['g']  = CLOX_SOURCE_CLASS_ALPHA,  ['h']  = CLOX_SOURCE_CLASS_ALPHA,  ['i']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['j']  = CLOX_SOURCE_CLASS_ALPHA,  ['k']  = CLOX_SOURCE_CLASS_ALPHA,  ['l']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['m']  = CLOX_SOURCE_CLASS_ALPHA,  ['n']  = CLOX_SOURCE_CLASS_ALPHA,  ['o']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['p']  = CLOX_SOURCE_CLASS_ALPHA,  ['q']  = CLOX_SOURCE_CLASS_ALPHA,  ['r']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['s']  = CLOX_SOURCE_CLASS_ALPHA,  ['t']  = CLOX_SOURCE_CLASS_ALPHA,  ['u']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['v']  = CLOX_SOURCE_CLASS_ALPHA,  ['w']  = CLOX_SOURCE_CLASS_ALPHA,  ['x']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['y']  = CLOX_SOURCE_CLASS_ALPHA,  ['z']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['A']  = CLOX_SOURCE_CLASS_ALPHA,  ['B']  = CLOX_SOURCE_CLASS_ALPHA,  ['C']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['D']  = CLOX_SOURCE_CLASS_ALPHA,  ['E']  = CLOX_SOURCE_CLASS_ALPHA,  ['F']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['G']  = CLOX_SOURCE_CLASS_ALPHA,  ['H']  = CLOX_SOURCE_CLASS_ALPHA,  ['I']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['J']  = CLOX_SOURCE_CLASS_ALPHA,  ['K']  = CLOX_SOURCE_CLASS_ALPHA,  ['L']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['M']  = CLOX_SOURCE_CLASS_ALPHA,  ['N']  = CLOX_SOURCE_CLASS_ALPHA,  ['O']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['P']  = CLOX_SOURCE_CLASS_ALPHA,  ['Q']  = CLOX_SOURCE_CLASS_ALPHA,  ['R']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['S']  = CLOX_SOURCE_CLASS_ALPHA,  ['T']  = CLOX_SOURCE_CLASS_ALPHA,  ['U']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['V']  = CLOX_SOURCE_CLASS_ALPHA,  ['W']  = CLOX_SOURCE_CLASS_ALPHA,  ['X']  = CLOX_SOURCE_CLASS_ALPHA,
+    ['Y']  = CLOX_SOURCE_CLASS_ALPHA,  ['Z']  = CLOX_SOURCE_CLASS_ALPHA,
+};
+
+CLOX_STATIC const char *const clox_TokenKindNames[] = {
+#define cloxDefineTokenKind(tokenEnum, tokenName) tokenName,
+#include CLOX_COMPILER_TOKEN_INC_
+};
+
+CLOX_API const char *CLOX_STDCALL cloxGetTokenKindName(const CloxTokenKind_t kind)
+{
+    if ((size_t)kind < countof(clox_TokenKindNames))
+        return clox_TokenKindNames[kind];
+    else
+        return NULL;
+}
+
+CLOX_API const char *CLOX_STDCALL cloxGetTokenErrorMessage(const CloxTokenError_t error)
+{
+    switch (error)
+    {
+    case CLOX_TOKEN_ERROR_NONE:
+        return "no error";
+
+    case CLOX_TOKEN_ERROR_UNEXPECTED_CHARACTER:
+        return "unexpected character";
+
+    case CLOX_TOKEN_ERROR_UNTERMINATED_STRING:
+        return "unterminated string";
+
+    default:
+        return "unknown error";
+    }
+}
+
+CLOX_API CloxLexer_t *CLOX_STDCALL cloxInitLexer(CloxLexer_t *const lexer, CloxArena_t *const arena)
+{
+    assert(lexer != NULL);
+
+    lexer->sourceBuffer   = NULL;
+    lexer->tokens         = NULL;
+    lexer->tokensCount    = 0;
+    lexer->tokensCapacity = 0;
+    lexer->errorsCount    = 0;
+    lexer->scannedBytes   = 0;
+    lexer->arena          = arena;
+
+    return lexer;
+}
+
+CLOX_API CloxLexer_t *CLOX_STDCALL cloxFreeLexer(CloxLexer_t *const lexer)
+{
+    assert(lexer != NULL);
+
+    if (!lexer->arena && lexer->tokens)
+        free(lexer->tokens);
+
+    return cloxInitLexer(lexer, lexer->arena);
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_LexerReserve(CloxLexer_t *const lexer, const size_t capacity)
+{
+    if (capacity <= lexer->tokensCapacity)
+        return;
+
+    if (lexer->arena)
+        lexer->tokens = arenaredim(lexer->arena, CloxToken_t, lexer->tokens, lexer->tokensCapacity, capacity);
+    else
+        lexer->tokens = redim(CloxToken_t, lexer->tokens, capacity);
+
+    lexer->tokensCapacity = capacity;
+
+    return;
+}
+
+CLOX_INLINE CloxToken_t *CLOX_STDCALL clox_LexerPush(CloxLexer_t *const lexer)
+{
+    if (lexer->tokensCount >= lexer->tokensCapacity)
+        clox_LexerReserve(lexer, max(lexer->tokensCapacity * CLOX_LEXER_GROWING_FACTOR, (size_t)16));
+
+    return &lexer->tokens[lexer->tokensCount++];
+}
+
+CLOX_INLINE const byte_t *CLOX_STDCALL clox_LexerSpan(const CloxSourceBuffer_t *const sourceBuffer, const byte_t *p, const byte_t *const limit, const CloxSourceClass_t classes)
+{
+    /* most runs are short, so the vectorized span is used only for the
+     * ones longer than CLOX_LEXER_SHORT_RUN bytes */
+    const byte_t *const stop = ((size_t)(limit - p) > CLOX_LEXER_SHORT_RUN) ? p + CLOX_LEXER_SHORT_RUN : limit;
+
+    while ((p < stop) && (clox_LexerClasses[*p] & classes))
+        p++;
+
+    if ((p == stop) && (p < limit))
+        p += cloxSourceBufferSpan(sourceBuffer, (uint64_t)(p - sourceBuffer->data), classes);
+
+    return p;
+}
+
+CLOX_INLINE CloxTokenKind_t CLOX_STDCALL clox_LexerKeyword(const byte_t *const lexeme, const size_t length, const size_t offset, const char *const rest, const CloxTokenKind_t kind)
+{
+    if ((length == offset + strlen(rest)) && !memcmp(lexeme + offset, rest, length - offset))
+        return kind;
+    else
+        return CLOX_TOKEN_KIND_IDENTIFIER;
+}
+
+CLOX_INLINE CloxTokenKind_t CLOX_STDCALL clox_LexerIdentifierKind(const byte_t *const lexeme, const size_t length)
+{
+    switch (lexeme[0])
+    {
+    case 'a':
+        return clox_LexerKeyword(lexeme, length, 1, "nd", CLOX_TOKEN_KIND_AND);
+    case 'c':
+        return clox_LexerKeyword(lexeme, length, 1, "lass", CLOX_TOKEN_KIND_CLASS);
+    case 'e':
+        return clox_LexerKeyword(lexeme, length, 1, "lse", CLOX_TOKEN_KIND_ELSE);
+    case 'f':
+        if (length > 1)
+        {
+            switch (lexeme[1])
+            {
+            case 'a':
+                return clox_LexerKeyword(lexeme, length, 2, "lse", CLOX_TOKEN_KIND_FALSE);
+            case 'o':
+                return clox_LexerKeyword(lexeme, length, 2, "r", CLOX_TOKEN_KIND_FOR);
+            case 'u':
+                return clox_LexerKeyword(lexeme, length, 2, "n", CLOX_TOKEN_KIND_FUN);
+            }
+        }
+        break;
+    case 'i':
+        return clox_LexerKeyword(lexeme, length, 1, "f", CLOX_TOKEN_KIND_IF);
+    case 'n':
+        return clox_LexerKeyword(lexeme, length, 1, "il", CLOX_TOKEN_KIND_NIL);
+    case 'o':
+        return clox_LexerKeyword(lexeme, length, 1, "r", CLOX_TOKEN_KIND_OR);
+    case 'p':
+        return clox_LexerKeyword(lexeme, length, 1, "rint", CLOX_TOKEN_KIND_PRINT);
+    case 'r':
+        return clox_LexerKeyword(lexeme, length, 1, "eturn", CLOX_TOKEN_KIND_RETURN);
+    case 's':
+        return clox_LexerKeyword(lexeme, length, 1, "uper", CLOX_TOKEN_KIND_SUPER);
+    case 't':
+        if (length > 1)
+        {
+            switch (lexeme[1])
+            {
+            case 'h':
+                return clox_LexerKeyword(lexeme, length, 2, "is", CLOX_TOKEN_KIND_THIS);
+            case 'r':
+                return clox_LexerKeyword(lexeme, length, 2, "ue", CLOX_TOKEN_KIND_TRUE);
+            }
+        }
+        break;
+    case 'v':
+        return clox_LexerKeyword(lexeme, length, 1, "ar", CLOX_TOKEN_KIND_VAR);
+    case 'w':
+        return clox_LexerKeyword(lexeme, length, 1, "hile", CLOX_TOKEN_KIND_WHILE);
+    }
+
+    return CLOX_TOKEN_KIND_IDENTIFIER;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxLexerScanBuffer(CloxLexer_t *const lexer, const CloxSourceBuffer_t *const sourceBuffer)
+{
+    assert(lexer != NULL && sourceBuffer != NULL);
+
+    if (sourceBuffer->size > UINT32_MAX)
+        fail(CLOX_ERROR_MESSAGE_BUFFER_OVERRUN, NULL);
+
+    const byte_t *const data = sourceBuffer->data;
+    const byte_t *const end = sourceBuffer->size ? (const byte_t *)memchr(data, NUL, sourceBuffer->size) : data;
+    const byte_t *const limit = end ? end : data + sourceBuffer->size;
+
+    const byte_t *p = data, *start, *lineStart = data, *newLine;
+    uint32_t line = 0;
+    size_t span = 0;
+
+    CloxTokenKind_t kind;
+    CloxTokenError_t error;
+    CloxToken_t *token;
+
+    lexer->sourceBuffer = sourceBuffer;
+    lexer->tokensCount  = 0;
+    lexer->errorsCount  = 0;
+    lexer->scannedBytes = (size_t)(limit - data);
+
+    clox_LexerReserve(lexer, lexer->scannedBytes / CLOX_LEXER_BYTES_PER_TOKEN + 1);
+
+    while (p < limit)
+    {
+        start = p;
+        error = CLOX_TOKEN_ERROR_NONE;
+
+        switch (clox_LexerActions[*p])
+        {
+        case CLOX_LEXER_ACTION_SPACE:
+            p = clox_LexerSpan(sourceBuffer, p, limit, CLOX_SOURCE_CLASS_SPACE);
+
+            /* whitespace runs are short, a plain loop beats memchr calls */
+            for (; start < p; start++)
+            {
+                if (*start == EOL)
+                    lineStart = start + 1, line++;
+            }
+
+            continue;
+
+        case CLOX_LEXER_ACTION_SINGLE:
+            kind = (CloxTokenKind_t)clox_LexerKinds[*p++];
+            break;
+
+        case CLOX_LEXER_ACTION_EQUAL:
+            kind = (CloxTokenKind_t)clox_LexerKinds[*p++];
+
+            if ((p < limit) && (*p == '='))
+                kind = (CloxTokenKind_t)(kind + 1), p++;
+
+            break;
+
+        case CLOX_LEXER_ACTION_SLASH:
+            if (((p + 1) < limit) && (p[1] == '/'))
+            {
+                /* the comment ends at the end of the line, non-ASCII bytes
+                 * stop the span so they are skipped one at a time */
+                for (p += 2; (p < limit) && (*p != EOL); p += max(span, (size_t)1))
+                    span = cloxSourceBufferSpan(sourceBuffer, (uint64_t)(p - data), CLOX_SOURCE_CLASS_LINE);
+
+                continue;
+            }
+
+            kind = CLOX_TOKEN_KIND_SLASH, p++;
+            break;
+
+        case CLOX_LEXER_ACTION_ALPHA:
+            p = clox_LexerSpan(sourceBuffer, p + 1, limit, CLOX_SOURCE_CLASS_IDENTIFIER);
+            kind = clox_LexerIdentifierKind(start, (size_t)(p - start));
+            break;
+
+        case CLOX_LEXER_ACTION_DIGIT:
+            p = clox_LexerSpan(sourceBuffer, p, limit, CLOX_SOURCE_CLASS_DIGIT);
+
+            if (((p + 1) < limit) && (*p == '.') && (clox_LexerActions[p[1]] == CLOX_LEXER_ACTION_DIGIT))
+                p = clox_LexerSpan(sourceBuffer, p + 1, limit, CLOX_SOURCE_CLASS_DIGIT);
+
+            kind = CLOX_TOKEN_KIND_NUMBER;
+            break;
+
+        case CLOX_LEXER_ACTION_QUOTE:
+            p = (const byte_t *)memchr(p + 1, '"', (size_t)(limit - p - 1));
+
+            if (!p)
+                p = limit, kind = CLOX_TOKEN_KIND_ERROR, error = CLOX_TOKEN_ERROR_UNTERMINATED_STRING;
+            else
+                p++, kind = CLOX_TOKEN_KIND_STRING;
+
+            break;
+
+        default:
+            /* a whole UTF-8 sequence is a single unexpected character */
+            for (p++; (p < limit) && ((*p & 0xC0) == 0x80); p++)
+                ;
+
+            kind = CLOX_TOKEN_KIND_ERROR, error = CLOX_TOKEN_ERROR_UNEXPECTED_CHARACTER;
+            break;
+        }
+
+        token = clox_LexerPush(lexer);
+
+        token->offset = (uint32_t)(start - data);
+        token->length = (uint32_t)(p - start);
+        token->line   = line;
+        token->column = (uint16_t)min((size_t)(start - lineStart), (size_t)UINT16_MAX);
+        token->kind   = (uint8_t)kind;
+        token->error  = (uint8_t)error;
+
+        if (kind == CLOX_TOKEN_KIND_ERROR)
+            lexer->errorsCount++;
+
+        /* strings can span lines */
+        if (kind != CLOX_TOKEN_KIND_STRING)
+            continue;
+
+        while ((newLine = (const byte_t *)memchr(start, EOL, (size_t)(p - start))))
+            start = lineStart = newLine + 1, line++;
+    }
+
+    token = clox_LexerPush(lexer);
+
+    token->offset = (uint32_t)(p - data);
+    token->length = 0;
+    token->line   = line;
+    token->column = (uint16_t)min((size_t)(p - lineStart), (size_t)UINT16_MAX);
+    token->kind   = (uint8_t)CLOX_TOKEN_KIND_EOF;
+    token->error  = (uint8_t)CLOX_TOKEN_ERROR_NONE;
+
+    return lexer->tokensCount;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxLexerScan(CloxLexer_t *const lexer, const CloxSourceStream_t *const sourceStream)
+{
+    assert(sourceStream != NULL);
+
+    /* open streams hold only a window of the source */
+    if (sourceStream->isOpen)
+        fail(CLOX_ERROR_MESSAGE_BUFFER_OVERRUN, NULL);
+
+    return cloxLexerScanBuffer(lexer, sourceStream->buffer);
+}
+
+CLOX_API void CLOX_STDCALL cloxDumpLexer(const CloxLexer_t *const lexer, FILE *const stream)
+{
+    assert(lexer != NULL);
+
+    FILE *const out = !stream ? stderr : stream;
+    const CloxToken_t *token;
+    size_t i;
+
+    for (i = 0; i < lexer->tokensCount; i++)
+    {
+        token = &lexer->tokens[i];
+
+        if (token->kind == CLOX_TOKEN_KIND_ERROR)
+            fprintf(out, "%4" PRIu32 ":%-4u %-12s %s\n", token->line + 1, (unsigned)token->column + 1, "error", cloxGetTokenErrorMessage((CloxTokenError_t)token->error));
+        else
+            fprintf(out, "%4" PRIu32 ":%-4u %-12s '%.*s'\n", token->line + 1, (unsigned)token->column + 1, cloxGetTokenKindName((CloxTokenKind_t)token->kind), (int)token->length, cloxLexerTokenText(lexer, token));
+    }
+
+    return;
+}
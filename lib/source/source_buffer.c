@@ -9,21 +9,66 @@
 
 #include "clox/source/source_buffer.h"
 
+#include <string.h>
+
+#if CLOX_SOURCE_SIMD
+#   if defined __AVX2__
+#       include <immintrin.h>
+#   elif defined __SSE2__ || defined _M_X64
+#       include <emmintrin.h>
+#   elif defined __ARM_NEON
+#       include <arm_neon.h>
+#   endif
+#   if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+#       include <intrin.h>
+#   endif
+#endif
+
+#if CLOX_PLATFORM_IS_WINDOWS
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#endif
+
 CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBuffer(size_t size, byte_t *const content, size_t count)
 {
-    CloxSourceBuffer_t *sourceBuffer = alloc(CloxSourceBuffer_t);
+    return cloxCreateSourceBufferInArena(size, content, count, NULL);
+}
+
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferInArena(size_t size, byte_t *const content, size_t count, CloxArena_t *const arena)
+{
+    CloxMemory_t *const memory = cloxGetMemory();
+    CloxSourceBuffer_t *sourceBuffer;
+    byte_t *data;
+
+    if (!arena)
+        sourceBuffer = alloc(CloxSourceBuffer_t), data = (byte_t *)cloxMemoryDim(memory, CLOX_MEMORY_KIND_SOURCE, size, sizeof(byte_t));
+    else
+        sourceBuffer = arenaalloc(arena, CloxSourceBuffer_t), data = arenadim(arena, byte_t, size);
 
     if (!content || !count)
-        sourceBuffer->data = dim(byte_t, size);
+        sourceBuffer->data = data;
     else
-        sourceBuffer->data = bufcpy(dim(byte_t, size), content, count);
+        sourceBuffer->data = bufcpy(data, content, count);
 
     sourceBuffer->size = size;
+    sourceBuffer->arena = arena;
+    sourceBuffer->memory = memory;
+    sourceBuffer->isMapped = FALSE;
+    sourceBuffer->mapping = NULL;
+    sourceBuffer->validity = CLOX_SOURCE_VALIDITY_UNKNOWN;
 
     return sourceBuffer;
 }
 
 CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromText(const char *const text)
+{
+    return cloxCreateSourceBufferFromTextInArena(text, NULL);
+}
+
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromTextInArena(const char *const text, CloxArena_t *const arena)
 {
     size_t length;
 
@@ -32,10 +77,19 @@ CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromText(const c
     else
         length = strlen(text);
 
-    return cloxCreateSourceBuffer(length + 1, (byte_t *)text, length);
+    CloxSourceBuffer_t *const sourceBuffer = cloxCreateSourceBufferInArena(length + 1, (byte_t *)text, length, arena);
+
+    cloxSourceBufferValidate(sourceBuffer);
+
+    return sourceBuffer;
 }
 
 CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromFile(const char *const path)
+{
+    return cloxCreateSourceBufferFromFileInArena(path, NULL);
+}
+
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromFileInArena(const char *const path, CloxArena_t *const arena)
 {
     assert(path != NULL);
 
@@ -45,28 +99,104 @@ CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromFile(const c
     if (!stream)
         sourceBuffer = NULL;
     else
-        sourceBuffer = cloxCreateSourceBufferFromStream(stream), fclose(stream);
+        sourceBuffer = cloxCreateSourceBufferFromStreamInArena(stream, arena), fclose(stream);
+
+    return sourceBuffer;
+}
+
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromMappedFile(const char *const path)
+{
+    assert(path != NULL);
+
+    void *view, *mapping = NULL;
+    size_t size;
+
+#if CLOX_PLATFORM_IS_WINDOWS
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    LARGE_INTEGER fileSize;
+
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!GetFileSizeEx(file, &fileSize) || !fileSize.QuadPart || !(mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL)))
+        return CloseHandle(file), NULL;
+
+    /* the view keeps the mapping alive, the file handle is not needed */
+    CloseHandle(file);
+
+    if (!(view = MapViewOfFile((HANDLE)mapping, FILE_MAP_READ, 0, 0, 0)))
+        return CloseHandle((HANDLE)mapping), NULL;
+
+    size = (size_t)fileSize.QuadPart;
+#else
+    int file = open(path, O_RDONLY);
+    struct stat info;
+
+    if (file < 0)
+        return NULL;
+
+    if (fstat(file, &info) || (info.st_size <= 0))
+        return close(file), NULL;
+
+    size = (size_t)info.st_size;
+    view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    /* the mapping keeps a reference to the file, the descriptor is not needed */
+    close(file);
+
+    if (view == MAP_FAILED)
+        return NULL;
+
+#   ifdef MADV_SEQUENTIAL
+    madvise(view, size, MADV_SEQUENTIAL);
+#   endif
+#endif
+
+    CloxSourceBuffer_t *sourceBuffer = alloc(CloxSourceBuffer_t);
+
+    sourceBuffer->data = (byte_t *)view;
+    sourceBuffer->size = size;
+    sourceBuffer->arena = NULL;
+    sourceBuffer->memory = NULL;
+    sourceBuffer->isMapped = TRUE;
+    sourceBuffer->mapping = mapping;
+
+    cloxSourceBufferValidate(sourceBuffer);
 
     return sourceBuffer;
 }
 
 CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromStream(FILE *const stream)
+{
+    return cloxCreateSourceBufferFromStreamInArena(stream, NULL);
+}
+
+CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromStreamInArena(FILE *const stream, CloxArena_t *const arena)
 {
     assert(stream != NULL);
 
     size_t size = fgetsiz(stream);
-    size_t fpos = 0;
+    size_t fpos = 0, read;
 
-    CloxSourceBuffer_t *sourceBuffer = cloxCreateSourceBuffer(size, NULL, 0);
+    /* one more byte for the terminator */
+    CloxSourceBuffer_t *sourceBuffer = cloxCreateSourceBufferInArena(size + 1, NULL, 0, arena);
 
     byte_t *p = sourceBuffer->data;
 
-    do
-        fpos += fread(p + fpos, sizeof(byte_t), min(CLOX_PAGESIZ, (size - fpos)), stream);
-    while (fpos < size);
+    while (fpos < size)
+    {
+        read = fread(p + fpos, sizeof(byte_t), min(CLOX_PAGESIZ, (size - fpos)), stream);
+
+        if (!read)
+            break;
+
+        fpos += read;
+    }
 
     p[fpos] = NUL;
 
+    cloxSourceBufferValidate(sourceBuffer);
+
     return sourceBuffer;
 }
 
@@ -79,16 +209,301 @@ CLOX_API CloxSourceBuffer_t *CLOX_STDCALL cloxCreateSourceBufferFromStdin(void)
 
     if (length < CLOX_PAGESIZ)
     {
-        newBuffer = (char *)realloc((void *)buffer, length + 1);
+        newBuffer = (char *)cloxMemoryRealloc(sourceBuffer->memory, CLOX_MEMORY_KIND_SOURCE, (void *)buffer, sourceBuffer->size, length + 1);
+
+        sourceBuffer->data = (byte_t *)newBuffer;
+        sourceBuffer->size = length + 1;
+    }
+
+    cloxSourceBufferValidate(sourceBuffer);
+
+    return sourceBuffer;
+}
+
+/* the classes of each byte, bytes with the high bit set belong to none */
+CLOX_STATIC const byte_t clox_SourceClassTable[BYTE_MAX + 1] = {
+    0x00, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0C, 0x04, 0x0C, 0x0C, 0x0C, 0x08, 0x08,
+    0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+    0x0C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+    0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x0A, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08,
+    0x08, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09,
+    0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x08, 0x08, 0x08, 0x08, 0x09,
+    0x08, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09,
+    0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09, 0x08, 0x08, 0x08, 0x08, 0x08,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+#if CLOX_SOURCE_SIMD
+
+CLOX_INLINE unsigned CLOX_STDCALL clox_SourceCountTrailingZeros(uint64_t mask)
+{
+#if CLOX_COMPILER_ID == CLOX_COMPILER_ID_MSVC
+    unsigned long index;
+
+    return _BitScanForward64(&index, mask) ? (unsigned)index : 64;
+#else
+    return mask ? (unsigned)__builtin_ctzll(mask) : 64;
+#endif
+}
+
+#if defined __AVX2__
+
+/* the number of bytes classified by each step */
+#define CLOX_SOURCE_SIMD_WIDTH 32
+
+CLOX_INLINE size_t CLOX_STDCALL clox_SourceSpanBlock(const byte_t *const data, const unsigned classes)
+{
+    const __m256i v = _mm256_loadu_si256((const __m256i *)data);
+    __m256i m = _mm256_setzero_si256();
+
+    /* signed comparisons leave out the bytes with the high bit set */
+    if (classes & CLOX_SOURCE_CLASS_ALPHA)
+    {
+        const __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+
+        m = _mm256_or_si256(m, _mm256_and_si256(_mm256_cmpgt_epi8(folded, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), folded)));
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    }
+
+    if (classes & CLOX_SOURCE_CLASS_DIGIT)
+        m = _mm256_or_si256(m, _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v)));
+
+    if (classes & CLOX_SOURCE_CLASS_SPACE)
+    {
+        m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+        m = _mm256_or_si256(m, _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('\t' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), v)));
+    }
+
+    if (classes & CLOX_SOURCE_CLASS_LINE)
+        m = _mm256_or_si256(m, _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(EOL)), _mm256_cmpgt_epi8(v, _mm256_setzero_si256())));
+
+    return clox_SourceCountTrailingZeros(~(uint64_t)(uint32_t)_mm256_movemask_epi8(m));
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_SourceIsAsciiBlock(const byte_t *const data)
+{
+    return (bool_t)!_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *)data));
+}
+
+#elif defined __SSE2__ || defined _M_X64
+
+/* the number of bytes classified by each step */
+#define CLOX_SOURCE_SIMD_WIDTH 16
+
+CLOX_INLINE size_t CLOX_STDCALL clox_SourceSpanBlock(const byte_t *const data, const unsigned classes)
+{
+    const __m128i v = _mm_loadu_si128((const __m128i *)data);
+    __m128i m = _mm_setzero_si128();
+
+    /* signed comparisons leave out the bytes with the high bit set */
+    if (classes & CLOX_SOURCE_CLASS_ALPHA)
+    {
+        const __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+        m = _mm_or_si128(m, _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1))));
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    }
+
+    if (classes & CLOX_SOURCE_CLASS_DIGIT)
+        m = _mm_or_si128(m, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1))));
+
+    if (classes & CLOX_SOURCE_CLASS_SPACE)
+    {
+        m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+        m = _mm_or_si128(m, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('\r' + 1))));
+    }
+
+    if (classes & CLOX_SOURCE_CLASS_LINE)
+        m = _mm_or_si128(m, _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(EOL)), _mm_cmpgt_epi8(v, _mm_setzero_si128())));
+
+    return clox_SourceCountTrailingZeros(~(uint64_t)(uint32_t)_mm_movemask_epi8(m));
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_SourceIsAsciiBlock(const byte_t *const data)
+{
+    return (bool_t)!_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)data));
+}
+
+#elif defined __ARM_NEON
+
+/* the number of bytes classified by each step */
+#define CLOX_SOURCE_SIMD_WIDTH 16
+
+CLOX_INLINE size_t CLOX_STDCALL clox_SourceSpanBlock(const byte_t *const data, const unsigned classes)
+{
+    const uint8x16_t v = vld1q_u8((const uint8_t *)data);
+    uint8x16_t m = vdupq_n_u8(0);
+
+    /* unsigned ranges leave out the bytes with the high bit set */
+    if (classes & CLOX_SOURCE_CLASS_ALPHA)
+    {
+        const uint8x16_t folded = vorrq_u8(v, vdupq_n_u8(0x20));
+
+        m = vorrq_u8(m, vandq_u8(vcgeq_u8(folded, vdupq_n_u8('a')), vcleq_u8(folded, vdupq_n_u8('z'))));
+        m = vorrq_u8(m, vceqq_u8(v, vdupq_n_u8('_')));
+    }
+
+    if (classes & CLOX_SOURCE_CLASS_DIGIT)
+        m = vorrq_u8(m, vandq_u8(vcgeq_u8(v, vdupq_n_u8('0')), vcleq_u8(v, vdupq_n_u8('9'))));
+
+    if (classes & CLOX_SOURCE_CLASS_SPACE)
+    {
+        m = vorrq_u8(m, vceqq_u8(v, vdupq_n_u8(' ')));
+        m = vorrq_u8(m, vandq_u8(vcgeq_u8(v, vdupq_n_u8('\t')), vcleq_u8(v, vdupq_n_u8('\r'))));
+    }
+
+    if (classes & CLOX_SOURCE_CLASS_LINE)
+        m = vorrq_u8(m, vbicq_u8(vandq_u8(vcgeq_u8(v, vdupq_n_u8(1)), vcleq_u8(v, vdupq_n_u8(0x7F))), vceqq_u8(v, vdupq_n_u8(EOL))));
 
-        if (newBuffer)
+    /* narrowing leaves 4 bits for each byte */
+    const uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+
+    return clox_SourceCountTrailingZeros(~mask) / 4;
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_SourceIsAsciiBlock(const byte_t *const data)
+{
+    const uint64x2_t v = vreinterpretq_u64_u8(vld1q_u8((const uint8_t *)data));
+
+    return (bool_t)!((vgetq_lane_u64(v, 0) | vgetq_lane_u64(v, 1)) & UINT64_C(0x8080808080808080));
+}
+
+#endif
+
+#endif
+
+CLOX_API size_t CLOX_STDCALL cloxSourceBufferSpan(const CloxSourceBuffer_t *const sourceBuffer, uint64_t position, CloxSourceClass_t classes)
+{
+    assert(sourceBuffer != NULL);
+
+    if (position >= sourceBuffer->size)
+        return 0;
+
+    const byte_t *const begin = sourceBuffer->data + position, *const end = sourceBuffer->data + sourceBuffer->size;
+    const byte_t *p = begin;
+
+#if CLOX_SOURCE_SIMD && defined CLOX_SOURCE_SIMD_WIDTH
+    CLOX_REGISTER size_t run;
+
+    /* whole blocks only, mapped buffers cannot be read past their end */
+    while ((size_t)(end - p) >= CLOX_SOURCE_SIMD_WIDTH)
+    {
+        run = clox_SourceSpanBlock(p, (unsigned)classes);
+        p += run;
+
+        if (run < CLOX_SOURCE_SIMD_WIDTH)
+            return (size_t)(p - begin);
+    }
+#endif
+
+    while ((p < end) && (clox_SourceClassTable[*p] & classes))
+        p++;
+
+    return (size_t)(p - begin);
+}
+
+/* the classes of the bytes for the UTF-8 automaton: ASCII, the continuation
+ * ranges 80-8F, 90-9F and A0-BF, the leading bytes C2-DF, E0, E1-EC and EE-EF,
+ * ED, F0, F1-F3, F4 and the bytes that never appear */
+CLOX_STATIC const byte_t clox_SourceUtf8Classes[BYTE_MAX + 1] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,  1,
+     2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,  2,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+     3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,  3,
+    11, 11,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,
+     4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,  4,
+     5,  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  6,  7,  6,  6,
+     8,  9,  9,  9, 10, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11, 11,
+};
+
+/* the states of the automaton: 0 between sequences, 1 on errors (it stays
+ * there), 2, 3 and 6 waiting for 1, 2 and 3 continuation bytes, 4 after E0, 5
+ * after ED, 7 after F0 and 8 after F4 (which restrict the next byte) */
+CLOX_STATIC const byte_t clox_SourceUtf8States[9][12] = {
+    { 0, 1, 1, 1, 2, 4, 3, 5, 7, 6, 8, 1 },
+    { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 3, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 1, 3, 3, 1, 1, 1, 1, 1, 1, 1, 1 },
+    { 1, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1 },
+};
+
+CLOX_API CloxSourceValidity_t CLOX_STDCALL cloxSourceBufferValidate(CloxSourceBuffer_t *const sourceBuffer)
+{
+    assert(sourceBuffer != NULL);
+
+    const byte_t *p = sourceBuffer->data, *const end = sourceBuffer->data + sourceBuffer->size;
+
+    CLOX_REGISTER byte_t state = 0, bits = 0;
+
+    while (p < end)
+    {
+#if CLOX_SOURCE_SIMD && defined CLOX_SOURCE_SIMD_WIDTH
+        /* whole blocks only, mapped buffers cannot be read past their end */
+        if (!state && ((size_t)(end - p) >= CLOX_SOURCE_SIMD_WIDTH) && clox_SourceIsAsciiBlock(p))
+        {
+            p += CLOX_SOURCE_SIMD_WIDTH;
+            continue;
+        }
+
+        /* a block with other characters is run through the automaton */
+        const byte_t *const limit = p + min((size_t)(end - p), (size_t)CLOX_SOURCE_SIMD_WIDTH);
+#else
+        const byte_t *const limit = end;
+#endif
+
+        for (; p < limit; p++)
         {
-            sourceBuffer->data = (byte_t *)newBuffer;
-            sourceBuffer->size = length + 1;
+            bits |= *p;
+            state = clox_SourceUtf8States[state][clox_SourceUtf8Classes[*p]];
         }
+
+        if (state == 1)
+            break;
     }
 
-    return sourceBuffer;
+    /* a sequence cut by the end of the buffer is ill-formed too */
+    if (state)
+        sourceBuffer->validity = CLOX_SOURCE_VALIDITY_INVALID;
+    else if (bits & 0x80)
+        sourceBuffer->validity = CLOX_SOURCE_VALIDITY_UTF_8;
+    else
+        sourceBuffer->validity = CLOX_SOURCE_VALIDITY_ASCII;
+
+    return (CloxSourceValidity_t)sourceBuffer->validity;
+}
+
+/**
+ * @brief       This function decodes a sequence of a well-formed buffer, the
+ *              leading byte tells its length.
+ */
+CLOX_INLINE int32_t CLOX_STDCALL clox_SourceDecodeValid(const byte_t *const p, ssize_t *const outOffset)
+{
+    if (p[0] < 0xE0)
+        return *outOffset = 2, ((int32_t)(p[0] & 0x1F) << 6) | (p[1] & 0x3F);
+
+    if (p[0] < 0xF0)
+        return *outOffset = 3, ((int32_t)(p[0] & 0x0F) << 12) | ((int32_t)(p[1] & 0x3F) << 6) | (p[2] & 0x3F);
+
+    return *outOffset = 4, ((int32_t)(p[0] & 0x07) << 18) | ((int32_t)(p[1] & 0x3F) << 12) | ((int32_t)(p[2] & 0x3F) << 6) | (p[3] & 0x3F);
 }
 
 CLOX_API int32_t CLOX_STDCALL cloxSourceBufferGetChar(CloxSourceBuffer_t *const sourceBuffer, CloxSourceEncoding_t encoding, uint64_t position, ssize_t *const outOffset)
@@ -106,6 +521,20 @@ CLOX_API int32_t CLOX_STDCALL cloxSourceBufferGetChar(CloxSourceBuffer_t *const
             break;
 
         case CLOX_SOURCE_ENCODING_UTF_8:
+            /* only bytes with the high bit set need the decoder */
+            if (sourceBuffer->data[position] < 0x80)
+            {
+                result = sourceBuffer->data[position];
+                offset = 1;
+                break;
+            }
+
+            if (sourceBuffer->validity >= CLOX_SOURCE_VALIDITY_UTF_8)
+            {
+                result = clox_SourceDecodeValid(sourceBuffer->data + position, &offset);
+                break;
+            }
+
             offset = utf8_iterate((const uint8_t *)(sourceBuffer->data + position), (ssize_t)(sourceBuffer->size - position), &result);
             break;
 
@@ -116,9 +545,10 @@ CLOX_API int32_t CLOX_STDCALL cloxSourceBufferGetChar(CloxSourceBuffer_t *const
     else
     {
         result = EOF;
+        offset = 0;
     }
 
-    if (outOffset && *outOffset)
+    if (outOffset)
         *outOffset = offset;
 
     return result;
@@ -126,17 +556,38 @@ CLOX_API int32_t CLOX_STDCALL cloxSourceBufferGetChar(CloxSourceBuffer_t *const
 
 CLOX_API int CLOX_STDCALL cloxDumpSourceBuffer(const CloxSourceBuffer_t *const sourceBuffer, FILE *const stream)
 {
-    return fputs((const char *)sourceBuffer->data, !stream ? stderr : stream);
+    /* mapped buffers are not terminated, so the content is limited by size */
+    const byte_t *end = (const byte_t *)memchr(sourceBuffer->data, NUL, sourceBuffer->size);
+    size_t length = end ? (size_t)(end - sourceBuffer->data) : sourceBuffer->size;
+
+    return (int)fwrite(sourceBuffer->data, sizeof(byte_t), length, !stream ? stderr : stream);
 }
 
 CLOX_API bool_t CLOX_STDCALL cloxClearSourceBuffer(CloxSourceBuffer_t *const sourceBuffer)
 {
+    if (sourceBuffer->isMapped)
+        return FALSE;
+
+    sourceBuffer->validity = CLOX_SOURCE_VALIDITY_UNKNOWN;
+
     return (bool_t)(!!bufclr(sourceBuffer->data, sourceBuffer->size));
 }
 
 CLOX_API void CLOX_STDCALL cloxDeleteSourceBuffer(CloxSourceBuffer_t *const sourceBuffer)
 {
-    free(sourceBuffer->data);
+    /* buffers allocated from an arena are released with it */
+    if (sourceBuffer->arena)
+        return;
+
+    if (!sourceBuffer->isMapped)
+        cloxMemoryFree(sourceBuffer->memory, CLOX_MEMORY_KIND_SOURCE, sourceBuffer->data, sourceBuffer->size);
+    else
+#if CLOX_PLATFORM_IS_WINDOWS
+        UnmapViewOfFile((LPCVOID)sourceBuffer->data), CloseHandle((HANDLE)sourceBuffer->mapping);
+#else
+        munmap((void *)sourceBuffer->data, sourceBuffer->size);
+#endif
+
     free(sourceBuffer);
 
     return;
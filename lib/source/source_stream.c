@@ -5,9 +5,20 @@
  */
 
 #include "clox/base/alloc.h"
+#include "clox/base/utils.h"
 
 #include "clox/source/source_stream.h"
 
+#include <string.h>
+#include <sys/stat.h>
+
+#if CLOX_SOURCE_STREAM_RING_SIZE & (CLOX_SOURCE_STREAM_RING_SIZE - 1)
+#   error "CLOX_SOURCE_STREAM_RING_SIZE must be a power of two"
+#endif
+
+/* the index of a position of an open stream in its ring */
+#define clox_SourceStreamRingIndex(position) ((size_t)(position) & (CLOX_SOURCE_STREAM_RING_SIZE - 1))
+
 CLOX_INLINE CloxSourceStream_t *CLOX_STDCALL clox_InitializeSourceStream(CloxSourceStream_t *const sourceStream)
 {
     sourceStream->path = NULL;
@@ -19,6 +30,8 @@ CLOX_INLINE CloxSourceStream_t *CLOX_STDCALL clox_InitializeSourceStream(CloxSou
     sourceStream->cleanup = FALSE;
 
     sourceStream->buffer = NULL;
+    sourceStream->arena = NULL;
+    sourceStream->loadedCount = 0;
 
     cloxResetSourceLocation(&sourceStream->streamLocation);
     cloxResetSourceLocation(&sourceStream->beginLocation);
@@ -27,9 +40,9 @@ CLOX_INLINE CloxSourceStream_t *CLOX_STDCALL clox_InitializeSourceStream(CloxSou
     return sourceStream;
 }
 
-CLOX_INLINE CloxSourceStream_t *CLOX_STDCALL clox_CreateSourceStream(const char *const path, FILE *const stream, bool_t isStdin, bool_t isInitialized, bool_t isOpen, bool_t cleanup, CloxSourceEncoding_t encoding, CloxSourceBuffer_t *const sourceBuffer)
+CLOX_INLINE CloxSourceStream_t *CLOX_STDCALL clox_CreateSourceStream(const char *const path, FILE *const stream, bool_t isStdin, bool_t isInitialized, bool_t isOpen, bool_t cleanup, CloxSourceEncoding_t encoding, CloxSourceBuffer_t *const sourceBuffer, CloxArena_t *const arena)
 {
-    CloxSourceStream_t *sourceStream = alloc(CloxSourceStream_t);
+    CloxSourceStream_t *sourceStream = !arena ? alloc(CloxSourceStream_t) : arenaalloc(arena, CloxSourceStream_t);
 
     sourceStream->path = (char *)path;
     sourceStream->stream = stream;
@@ -41,6 +54,8 @@ CLOX_INLINE CloxSourceStream_t *CLOX_STDCALL clox_CreateSourceStream(const char
 
     sourceStream->encoding = encoding;
     sourceStream->buffer = sourceBuffer;
+    sourceStream->arena = arena;
+    sourceStream->loadedCount = 0;
 
     cloxResetSourceLocation(&sourceStream->streamLocation);
     cloxResetSourceLocation(&sourceStream->beginLocation);
@@ -49,33 +64,68 @@ CLOX_INLINE CloxSourceStream_t *CLOX_STDCALL clox_CreateSourceStream(const char
     return sourceStream;
 }
 
+CLOX_INLINE size_t CLOX_STDCALL clox_SourceStreamFileSize(const char *const path)
+{
+#if CLOX_PLATFORM_IS_WINDOWS
+    struct _stat64 info;
+
+    return _stat64(path, &info) ? 0 : (size_t)info.st_size;
+#else
+    struct stat info;
+
+    return stat(path, &info) ? 0 : (size_t)info.st_size;
+#endif
+}
+
 CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromText(const char *const text, CloxSourceEncoding_t encoding)
 {
-    return clox_CreateSourceStream(NULL, NULL, FALSE, FALSE, FALSE, FALSE, encoding, cloxCreateSourceBufferFromText(text));
+    return cloxCreateSourceStreamFromTextInArena(text, encoding, NULL);
+}
+
+CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromTextInArena(const char *const text, CloxSourceEncoding_t encoding, CloxArena_t *const arena)
+{
+    return clox_CreateSourceStream(NULL, NULL, FALSE, TRUE, FALSE, FALSE, encoding, cloxCreateSourceBufferFromTextInArena(text, arena), arena);
 }
 
 CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromFile(const char *const path, bool_t cleanupPath, CloxSourceEncoding_t encoding)
+{
+    return cloxCreateSourceStreamFromFileInArena(path, cleanupPath, encoding, NULL);
+}
+
+CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromFileInArena(const char *const path, bool_t cleanupPath, CloxSourceEncoding_t encoding, CloxArena_t *const arena)
 {
     assert(path != NULL);
 
-    CloxSourceBuffer_t *sourceBuffer = cloxCreateSourceBufferFromFile(path);
+    CloxSourceBuffer_t *sourceBuffer = NULL;
+
+    /* big files are mapped instead of copied, small ones are cheaper to read */
+    if (clox_SourceStreamFileSize(path) >= CLOX_SOURCE_BUFFER_MAPPING_THRESHOLD)
+        sourceBuffer = cloxCreateSourceBufferFromMappedFile(path);
+
+    if (!sourceBuffer)
+        sourceBuffer = cloxCreateSourceBufferFromFileInArena(path, arena);
 
     if (!sourceBuffer)
         return NULL;
     else
-        return clox_CreateSourceStream(path, NULL, FALSE, FALSE, FALSE, cleanupPath, encoding, sourceBuffer);
+        return clox_CreateSourceStream(path, NULL, FALSE, TRUE, FALSE, cleanupPath, encoding, sourceBuffer, arena);
 }
 
 CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromStream(FILE *const stream, CloxSourceEncoding_t encoding)
+{
+    return cloxCreateSourceStreamFromStreamInArena(stream, encoding, NULL);
+}
+
+CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxCreateSourceStreamFromStreamInArena(FILE *const stream, CloxSourceEncoding_t encoding, CloxArena_t *const arena)
 {
     assert(stream != NULL);
 
-    CloxSourceBuffer_t *sourceBuffer = cloxCreateSourceBufferFromStream(stream);
+    CloxSourceBuffer_t *sourceBuffer = cloxCreateSourceBufferFromStreamInArena(stream, arena);
 
     if (!sourceBuffer)
         return NULL;
     else
-        return clox_CreateSourceStream(NULL, NULL, FALSE, FALSE, FALSE, FALSE, encoding, sourceBuffer);
+        return clox_CreateSourceStream(NULL, NULL, FALSE, TRUE, FALSE, FALSE, encoding, sourceBuffer, arena);
 }
 
 CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxOpenSourceStream(const char *const path, bool_t cleanupPath, CloxSourceEncoding_t encoding)
@@ -87,56 +137,160 @@ CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxOpenSourceStream(const char *const
     if (!stream)
         return NULL;
 
-    return clox_CreateSourceStream(path, stream, FALSE, FALSE, TRUE, cleanupPath, encoding, cloxCreateSourceBuffer(CLOX_PAGESIZ, NULL, 0));
+    return clox_CreateSourceStream(path, stream, FALSE, FALSE, TRUE, cleanupPath, encoding, cloxCreateSourceBuffer(CLOX_SOURCE_STREAM_RING_SIZE, NULL, 0), NULL);
 }
 
 CLOX_API CloxSourceStream_t *CLOX_STDCALL cloxOpenStandardSourceStream(void)
 {
-    return clox_CreateSourceStream("<stdin>", stdin, TRUE, FALSE, TRUE, FALSE, CLOX_DEFAULT_ENCODING, cloxCreateSourceBuffer(CLOX_PAGESIZ, NULL, 0));
+    return clox_CreateSourceStream("<stdin>", stdin, TRUE, FALSE, TRUE, FALSE, CLOX_DEFAULT_ENCODING, cloxCreateSourceBuffer(CLOX_SOURCE_STREAM_RING_SIZE, NULL, 0), NULL);
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_SourceStreamIsRing(const CloxSourceStream_t *const sourceStream)
+{
+    /* only the open streams are refilled from a file stream */
+    return sourceStream->stream != NULL;
 }
 
 CLOX_INLINE bool_t CLOX_STDCALL clox_SourceStreamNeedsARefill(CloxSourceStream_t *const sourceStream, uint32_t offset)
 {
-    return !sourceStream->isInitialized || ((sourceStream->forwardLocation.ch + offset) >= sourceStream->buffer->size);
+    const uint64_t end = clox_SourceStreamIsRing(sourceStream) ? sourceStream->loadedCount : sourceStream->buffer->size;
+
+    return !sourceStream->isInitialized || ((sourceStream->forwardLocation.ch + offset) >= end);
+}
+
+/**
+ * @brief       This function returns a view of the bytes that can be read from
+ *              a position without a refill and without wrapping around the ring.
+ */
+CLOX_INLINE CloxSourceBuffer_t *CLOX_STDCALL clox_SourceStreamWindow(const CloxSourceStream_t *const sourceStream, uint64_t position, CloxSourceBuffer_t *const window)
+{
+    const CloxSourceBuffer_t *const sourceBuffer = sourceStream->buffer;
+
+    window->arena = NULL;
+    window->memory = NULL;
+    window->isMapped = sourceBuffer->isMapped;
+    window->mapping = NULL;
+
+    /* the ring is refilled as it is read, so it is never validated */
+    window->validity = sourceBuffer->validity;
+
+    if (clox_SourceStreamIsRing(sourceStream))
+    {
+        CLOX_REGISTER const size_t index = clox_SourceStreamRingIndex(position);
+
+        window->data = sourceBuffer->data + index;
+        window->size = (position < sourceStream->loadedCount) ? (size_t)min(sourceStream->loadedCount - position, (uint64_t)(CLOX_SOURCE_STREAM_RING_SIZE - index)) : 0;
+    }
+    else
+    {
+        window->data = sourceBuffer->data + min(position, (uint64_t)sourceBuffer->size);
+        window->size = (position < sourceBuffer->size) ? (size_t)(sourceBuffer->size - position) : 0;
+    }
+
+    return window;
+}
+
+CLOX_STATIC int32_t CLOX_STDCALL clox_SourceStreamGetChar(CloxSourceStream_t *const sourceStream, uint64_t position, ssize_t *const outOffset)
+{
+    if (!clox_SourceStreamIsRing(sourceStream))
+        return cloxSourceBufferGetChar(sourceStream->buffer, sourceStream->encoding, position, outOffset);
+
+    CloxSourceBuffer_t window;
+    byte_t joined[4];
+
+    clox_SourceStreamWindow(sourceStream, position, &window);
+
+    /* a character split by the end of the ring is joined before decoding it */
+    if ((window.size < sizeof(joined)) && (window.size < (sourceStream->loadedCount - position)))
+    {
+        CLOX_REGISTER const size_t count = (size_t)min(sourceStream->loadedCount - position, (uint64_t)sizeof(joined));
+
+        memcpy(joined, window.data, window.size);
+        memcpy(joined + window.size, sourceStream->buffer->data, count - window.size);
+
+        window.data = joined;
+        window.size = count;
+    }
+
+    return cloxSourceBufferGetChar(&window, sourceStream->encoding, 0, outOffset);
 }
 
-CLOX_INLINE bool_t CLOX_STDCALL clox_SourceStreamRefill(CloxSourceStream_t *const sourceStream)
+/**
+ * @brief       This function loads the next bytes of the file stream into the
+ *              free part of the ring: the loaded bytes never move, the unread
+ *              ones and the current lexeme (while it fits in the ring) are
+ *              never overwritten.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_SourceStreamRefill(CloxSourceStream_t *const sourceStream)
 {
     if (!sourceStream->isOpen || !sourceStream->stream)
         return FALSE;
 
     FILE *stream = sourceStream->stream;
-    byte_t *data = sourceStream->buffer->data;
-    size_t begin = sourceStream->beginLocation.ch, count = sourceStream->buffer->size - begin;
 
     if (feof(stream))
         return FALSE;
 
-    if (begin)
-        bufmov(data, (data + begin), count);
+    const uint64_t loaded = sourceStream->loadedCount, begin = sourceStream->beginLocation.ch, forward = sourceStream->forwardLocation.ch;
+    const uint64_t kept = ((begin <= forward) && ((forward - begin) < CLOX_SOURCE_STREAM_RING_SIZE)) ? begin : forward;
 
-    if (!sourceStream->isStdin)
-        fread((void *)(data + begin), sizeof(byte_t), count, stream);
-    else
-        fgets((char *)(data + begin), count, stream);
+    CLOX_REGISTER const size_t index = clox_SourceStreamRingIndex(loaded);
+    CLOX_REGISTER const size_t used = (kept < loaded) ? (size_t)min(loaded - kept, (uint64_t)CLOX_SOURCE_STREAM_RING_SIZE) : 0;
+    CLOX_REGISTER const size_t count = min(CLOX_SOURCE_STREAM_RING_SIZE - used, CLOX_SOURCE_STREAM_RING_SIZE - index);
+
+    byte_t *data = sourceStream->buffer->data + index;
+    size_t length = 0;
+    int ch;
 
-    if (!sourceStream->isInitialized)
+    if (!count)
+        return FALSE;
+
+    if (!sourceStream->isStdin)
     {
-        sourceStream->isInitialized = TRUE;
+        length = fread((void *)data, sizeof(byte_t), count, stream);
     }
     else
     {
-        CloxSourceLocation_t *beginLoc = &sourceStream->beginLocation, *forwardLoc = &sourceStream->forwardLocation;
+        /* interactive streams are never read past the end of the line */
+        while ((length < count) && ((ch = getc(stream)) != EOF))
+        {
+            data[length++] = (byte_t)ch;
+
+            if (ch == EOL)
+                break;
+        }
+    }
 
-        if (begin)
-            cloxSetSourceLocation(forwardLoc, forwardLoc->ch - beginLoc->ch, forwardLoc->co - beginLoc->co, forwardLoc->ln - beginLoc->ln);
-        else
-            cloxResetSourceLocation(forwardLoc);
+    sourceStream->isInitialized = TRUE;
+    sourceStream->loadedCount += length;
 
-        cloxResetSourceLocation(beginLoc);
+    return length != 0;
+}
+
+/**
+ * @brief       This function moves the stream and forward locations past count
+ *              bytes, which contain the specified number of lines: the column
+ *              restarts after the last one of them.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_SourceStreamAdvance(CloxSourceStream_t *const sourceStream, size_t count, uint32_t lines, uint32_t column)
+{
+    if (lines)
+    {
+        sourceStream->streamLocation.co = column;
+        sourceStream->streamLocation.ln += lines;
+        sourceStream->forwardLocation.co = column;
+        sourceStream->forwardLocation.ln += lines;
+    }
+    else
+    {
+        sourceStream->streamLocation.co += (uint32_t)count;
+        sourceStream->forwardLocation.co += (uint32_t)count;
     }
 
-    return TRUE;
+    sourceStream->streamLocation.ch += count;
+    sourceStream->forwardLocation.ch += count;
+
+    return;
 }
 
 CLOX_API int32_t CLOX_STDCALL cloxSourceStreamPeek(CloxSourceStream_t *const sourceStream)
@@ -144,7 +298,7 @@ CLOX_API int32_t CLOX_STDCALL cloxSourceStreamPeek(CloxSourceStream_t *const sou
     if (clox_SourceStreamNeedsARefill(sourceStream, 0) && !clox_SourceStreamRefill(sourceStream))
         return EOF;
     else
-        return cloxSourceBufferGetChar(sourceStream->buffer, sourceStream->encoding, sourceStream->forwardLocation.ch, NULL);
+        return clox_SourceStreamGetChar(sourceStream, sourceStream->forwardLocation.ch, NULL);
 }
 
 CLOX_INLINE int32_t CLOX_STDCALL clox_SourceStreamRead(CloxSourceStream_t *const sourceStream, ssize_t *const outOffset)
@@ -155,7 +309,7 @@ CLOX_INLINE int32_t CLOX_STDCALL clox_SourceStreamRead(CloxSourceStream_t *const
     int32_t result;
     ssize_t offset;
 
-    result = cloxSourceBufferGetChar(sourceStream->buffer, sourceStream->encoding, sourceStream->forwardLocation.ch, &offset);
+    result = clox_SourceStreamGetChar(sourceStream, sourceStream->forwardLocation.ch, &offset);
 
     switch (result)
     {
@@ -179,7 +333,7 @@ CLOX_INLINE int32_t CLOX_STDCALL clox_SourceStreamRead(CloxSourceStream_t *const
     sourceStream->streamLocation.ch += offset;
     sourceStream->forwardLocation.ch += offset;
 
-    if (outOffset && *outOffset)
+    if (outOffset)
         *outOffset = offset;
 
     return result;
@@ -192,7 +346,7 @@ CLOX_API int32_t CLOX_STDCALL cloxSourceStreamRead(CloxSourceStream_t *const sou
 
 CLOX_API int32_t CLOX_STDCALL cloxSourceStreamPeekOffset(CloxSourceStream_t *const sourceStream, uint32_t offset)
 {
-    return cloxSourceBufferGetChar(sourceStream->buffer, sourceStream->encoding, sourceStream->forwardLocation.ch + offset, NULL);
+    return clox_SourceStreamGetChar(sourceStream, sourceStream->forwardLocation.ch + offset, NULL);
 }
 
 CLOX_API int32_t CLOX_STDCALL cloxSourceStreamReadOffset(CloxSourceStream_t *const sourceStream, uint32_t offset)
@@ -209,6 +363,80 @@ CLOX_API int32_t CLOX_STDCALL cloxSourceStreamReadOffset(CloxSourceStream_t *con
     return result;
 }
 
+CLOX_API size_t CLOX_STDCALL cloxSourceStreamSkip(CloxSourceStream_t *const sourceStream, CloxSourceClass_t classes)
+{
+    CloxSourceBuffer_t window;
+    size_t count, total = 0;
+
+    /* a run can continue after the end of the ring or of the loaded bytes */
+    do
+    {
+        if (clox_SourceStreamNeedsARefill(sourceStream, 0) && !clox_SourceStreamRefill(sourceStream))
+            break;
+
+        clox_SourceStreamWindow(sourceStream, sourceStream->forwardLocation.ch, &window);
+        count = cloxSourceBufferSpan(&window, 0, classes);
+
+        const byte_t *p = window.data, *const end = p + count, *last = NULL;
+        uint32_t lines = 0;
+
+        /* only whitespaces span lines, the column restarts after the last one */
+        if (hasflag(classes, CLOX_SOURCE_CLASS_SPACE))
+        {
+            while ((p < end) && (p = (const byte_t *)memchr(p, EOL, (size_t)(end - p))))
+                last = p++, lines++;
+        }
+
+        clox_SourceStreamAdvance(sourceStream, count, lines, lines ? (uint32_t)(end - last - 1) : 0);
+        total += count;
+    }
+    while (count && (count == window.size));
+
+    return total;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxSourceStreamReadLine(CloxSourceStream_t *const sourceStream, char *const buffer, size_t size)
+{
+    assert(sourceStream != NULL && buffer != NULL && size > 0);
+
+    CloxSourceBuffer_t window;
+    const byte_t *stop;
+    size_t count, length = 0;
+
+    /* the line is the current lexeme, so the refills keep it in the ring */
+    sourceStream->beginLocation = sourceStream->forwardLocation;
+
+    while (length < (size - 1))
+    {
+        if (clox_SourceStreamNeedsARefill(sourceStream, 0) && !clox_SourceStreamRefill(sourceStream))
+            break;
+
+        clox_SourceStreamWindow(sourceStream, sourceStream->forwardLocation.ch, &window);
+        count = min(window.size, size - 1 - length);
+
+        /* the text streams end with their terminator */
+        if ((stop = (const byte_t *)memchr(window.data, NUL, count)))
+            count = (size_t)(stop - window.data);
+
+        const bool_t terminated = (bool_t)(stop != NULL);
+
+        if ((stop = (const byte_t *)memchr(window.data, EOL, count)))
+            count = (size_t)(stop - window.data) + 1;
+
+        memcpy(buffer + length, window.data, count);
+        length += count;
+
+        clox_SourceStreamAdvance(sourceStream, count, stop ? 1 : 0, 0);
+
+        if (stop || terminated)
+            break;
+    }
+
+    buffer[length] = NUL;
+
+    return length;
+}
+
 CLOX_API bool_t CLOX_STDCALL cloxCloseSourceStream(CloxSourceStream_t *const sourceStream)
 {
     if (sourceStream->isOpen)
@@ -230,7 +458,8 @@ CLOX_API void CLOX_STDCALL cloxDeleteSourceStream(CloxSourceStream_t *const sour
     if (sourceStream->cleanup)
         free(sourceStream->path);
 
-    free(sourceStream);
+    if (!sourceStream->arena)
+        free(sourceStream);
 
     return;
 }
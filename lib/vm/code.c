@@ -29,7 +29,7 @@ CLOX_STATIC const CloxOpCodeInfo_t clox_OpCodeInfos[CLOX_OP_CODE_INFOS_MAX] = {
 #      define cloxDefineOpCode(opEnum, opCode, opName, opKind, opFunc) \
     [opCode] = {                                                       \
         .name = opName,                                                \
-        .func = opFunc,                                                \
+        .func = NULL,                                                  \
         .code = opEnum,                                                \
         .kind = opKind,                                                \
     },
@@ -52,7 +52,7 @@ CLOX_STATIC const CloxOpCodeInfo_t clox_OpCodeInfos[CLOX_OP_CODE_INFOS_MAX] = {
 #      define cloxDefineOpCode(opEnum, opCode, opName, opKind, opFunc) \
     {                                                                  \
         .name = opName,                                                \
-        .func = opFunc,                                                \
+        .func = NULL,                                                  \
         .code = opEnum,                                                \
         .kind = opKind,                                                \
     },
@@ -70,7 +70,7 @@ CLOX_API bool_t CLOX_STDCALL cloxGetOpCodeInfo(const CloxOpCode_t opCode, CloxOp
 {
     CLOX_REGISTER bool_t result;
 
-    if ((opCode < 0) || (opCode >= countof(clox_OpCodeInfos)))
+    if ((opCode < 0) || (opCode >= countof(clox_OpCodeInfos)) || !clox_OpCodeInfos[opCode].name)
     {
         if (outOpCodeInfo)
         {
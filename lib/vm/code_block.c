@@ -5,21 +5,78 @@
  */
 
 #include "clox/base/alloc.h"
+#include "clox/base/string.h"
+#include "clox/base/utils.h"
 #include "clox/vm/code_block.h"
 
+#include <math.h>
+#include <string.h>
+
 #ifndef CLOX_CODE_BLOCK_GROWING_FACTOR
 #   define CLOX_CODE_BLOCK_GROWING_FACTOR 2
 #endif
 
+#ifndef CLOX_CODE_BLOCK_CONSTANTS_CAPACITY
+#   define CLOX_CODE_BLOCK_CONSTANTS_CAPACITY 8
+#endif
+
+#ifndef CLOX_CODE_BLOCK_CONSTANTS_INDEX_CAPACITY
+/* the initial number of slots of the constants index, a power of two */
+#   define CLOX_CODE_BLOCK_CONSTANTS_INDEX_CAPACITY 16
+#endif
+
+#ifndef CLOX_CODE_BLOCK_NAMES_CAPACITY
+#   define CLOX_CODE_BLOCK_NAMES_CAPACITY 64
+#endif
+
+#ifndef CLOX_CODE_BLOCK_SYMBOLS_CAPACITY
+#   define CLOX_CODE_BLOCK_SYMBOLS_CAPACITY 8
+#endif
+
+#ifndef CLOX_CODE_BLOCK_LINES_CAPACITY
+#   define CLOX_CODE_BLOCK_LINES_CAPACITY 64
+#endif
+
+#ifndef CLOX_LINE_TABLE_RUN_SIZE
+/* the maximum size of an encoded run: three 64-bit varints */
+#   define CLOX_LINE_TABLE_RUN_SIZE 30
+#endif
+
+#ifndef clox_CodeBlockScratch
+/* code blocks allocate from their arena when they have one */
+#   define clox_CodeBlockScratch(codeBlock, T, N) ((codeBlock)->arena ? arenadim((codeBlock)->arena, T, N) : dim(T, N))
+#endif
+
+#ifndef clox_CodeBlockDim
+/* the arrays kept by the block are accounted to its memory */
+#   define clox_CodeBlockDim(codeBlock, T, N) ((codeBlock)->arena ? arenadim((codeBlock)->arena, T, N) : (T *)cloxMemoryDim((codeBlock)->memory, CLOX_MEMORY_KIND_CODE, (N), sizeof(T)))
+#endif
+
+#ifndef clox_CodeBlockRedim
+#   define clox_CodeBlockRedim(codeBlock, T, B, O, N) ((codeBlock)->arena ? arenaredim((codeBlock)->arena, T, B, O, N) : (T *)cloxMemoryRealloc((codeBlock)->memory, CLOX_MEMORY_KIND_CODE, (void *)(B), sizeof(T) * (O), sizeof(T) * (N)))
+#endif
+
+#ifndef clox_CodeBlockRelease
+#   define clox_CodeBlockRelease(codeBlock, T, B, N) ((codeBlock)->arena ? (void)0 : cloxMemoryFree((codeBlock)->memory, CLOX_MEMORY_KIND_CODE, (void *)(B), sizeof(T) * (N)))
+#endif
+
 CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxInitCodeBlock(CloxCodeBlock_t *const codeBlock, size_t capacity)
+{
+    return cloxInitCodeBlockInArena(codeBlock, capacity, NULL);
+}
+
+CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxInitCodeBlockInArena(CloxCodeBlock_t *const codeBlock, size_t capacity, CloxArena_t *const arena)
 {
     assert(codeBlock != NULL);
 
+    codeBlock->arena = arena;
+    codeBlock->memory = cloxGetMemory();
+
     if (capacity)
     {
         capacity = cloxAlignToWordPtr(capacity);
 
-        codeBlock->array = dim(byte_t, capacity);
+        codeBlock->array = clox_CodeBlockDim(codeBlock, byte_t, capacity);
         codeBlock->count = 0;
         codeBlock->capacity = capacity;
     }
@@ -30,6 +87,30 @@ CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxInitCodeBlock(CloxCodeBlock_t *const
         codeBlock->capacity = 0;
     }
 
+    codeBlock->constants = NULL;
+    codeBlock->constantsCount = 0;
+    codeBlock->constantsCapacity = 0;
+
+    codeBlock->constantsIndex = NULL;
+    codeBlock->constantsIndexCapacity = 0;
+    codeBlock->constantsIndexCount = 0;
+
+    codeBlock->names = NULL;
+    codeBlock->namesSize = 0;
+    codeBlock->namesCapacity = 0;
+
+    codeBlock->cachesCount = 0;
+
+    codeBlock->symbols = NULL;
+    codeBlock->symbolsCount = 0;
+    codeBlock->symbolsCapacity = 0;
+
+    memset(&codeBlock->lines, 0, sizeof(codeBlock->lines));
+    memset(&codeBlock->decoded, 0, sizeof(codeBlock->decoded));
+
+    codeBlock->depths = NULL;
+    codeBlock->frozen = FALSE;
+
     return codeBlock;
 }
 
@@ -37,13 +118,56 @@ CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxFreeCodeBlock(CloxCodeBlock_t *const
 {
     assert(codeBlock != NULL);
 
+    /* the virtual machines sharing a frozen block are done with it */
+    codeBlock->frozen = FALSE;
+
     if (codeBlock->capacity)
-        free(codeBlock->array);
+        clox_CodeBlockRelease(codeBlock, byte_t, codeBlock->array, codeBlock->capacity);
     
     codeBlock->array = NULL;
     codeBlock->count = 0;
     codeBlock->capacity = 0;
 
+    if (codeBlock->constantsCapacity)
+        clox_CodeBlockRelease(codeBlock, CloxValue_t, codeBlock->constants, codeBlock->constantsCapacity);
+
+    codeBlock->constants = NULL;
+    codeBlock->constantsCount = 0;
+    codeBlock->constantsCapacity = 0;
+
+    if (codeBlock->constantsIndexCapacity)
+        clox_CodeBlockRelease(codeBlock, uint32_t, codeBlock->constantsIndex, codeBlock->constantsIndexCapacity);
+
+    codeBlock->constantsIndex = NULL;
+    codeBlock->constantsIndexCapacity = 0;
+    codeBlock->constantsIndexCount = 0;
+
+    if (codeBlock->namesCapacity)
+        clox_CodeBlockRelease(codeBlock, char, codeBlock->names, codeBlock->namesCapacity);
+
+    codeBlock->names = NULL;
+    codeBlock->namesSize = 0;
+    codeBlock->namesCapacity = 0;
+
+    codeBlock->cachesCount = 0;
+
+    if (codeBlock->symbolsCapacity)
+        clox_CodeBlockRelease(codeBlock, CloxCodeSymbol_t, codeBlock->symbols, codeBlock->symbolsCapacity);
+
+    codeBlock->symbols = NULL;
+    codeBlock->symbolsCount = 0;
+    codeBlock->symbolsCapacity = 0;
+
+    if (codeBlock->lines.runsCapacity)
+        clox_CodeBlockRelease(codeBlock, byte_t, codeBlock->lines.runs, codeBlock->lines.runsCapacity);
+
+    if (codeBlock->lines.checkpointsCapacity)
+        clox_CodeBlockRelease(codeBlock, CloxLineCheckpoint_t, codeBlock->lines.checkpoints, codeBlock->lines.checkpointsCapacity);
+
+    memset(&codeBlock->lines, 0, sizeof(codeBlock->lines));
+
+    cloxCodeBlockInvalidate(codeBlock);
+
     return codeBlock;
 }
 
@@ -52,9 +176,19 @@ CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxCreateCodeBlock(const size_t capacity
     return cloxInitCodeBlock(alloc(CloxCodeBlock_t), capacity);
 }
 
+CLOX_API CloxCodeBlock_t *CLOX_STDCALL cloxCreateCodeBlockInArena(const size_t capacity, CloxArena_t *const arena)
+{
+    if (!arena)
+        return cloxCreateCodeBlock(capacity);
+    else
+        return cloxInitCodeBlockInArena(arenaalloc(arena, CloxCodeBlock_t), capacity, arena);
+}
+
 CLOX_API void CLOX_STDCALL cloxCodeBlockResize(CloxCodeBlock_t *const codeBlock, size_t newCapacity)
 {
-    assert(codeBlock != NULL);
+    assert(codeBlock != NULL && !codeBlock->frozen);
+
+    cloxCodeBlockInvalidate(codeBlock);
 
     if (codeBlock->capacity)
     {
@@ -62,21 +196,29 @@ CLOX_API void CLOX_STDCALL cloxCodeBlockResize(CloxCodeBlock_t *const codeBlock,
         {
             newCapacity = cloxAlignToWordPtr(newCapacity);
 
-            codeBlock->array = redim(byte_t, codeBlock->array, newCapacity);
+            codeBlock->array = clox_CodeBlockRedim(codeBlock, byte_t, codeBlock->array, codeBlock->capacity, newCapacity);
 
-            if (codeBlock->count >= newCapacity)
-                codeBlock->count = newCapacity - 1;
+            if (codeBlock->count > newCapacity)
+                codeBlock->count = newCapacity;
 
             codeBlock->capacity = newCapacity;
         }
         else
         {
-            cloxFreeCodeBlock(codeBlock);
+            clox_CodeBlockRelease(codeBlock, byte_t, codeBlock->array, codeBlock->capacity);
+
+            codeBlock->array = NULL;
+            codeBlock->count = 0;
+            codeBlock->capacity = 0;
         }
     }
-    else
+    else if (newCapacity)
     {
-        cloxInitCodeBlock(codeBlock, newCapacity);
+        newCapacity = cloxAlignToWordPtr(newCapacity);
+
+        codeBlock->array = clox_CodeBlockDim(codeBlock, byte_t, newCapacity);
+        codeBlock->count = 0;
+        codeBlock->capacity = newCapacity;
     }
 
     return;
@@ -94,22 +236,25 @@ CLOX_API void CLOX_STDCALL cloxCodeBlockShrink(CloxCodeBlock_t *const codeBlock,
 
 CLOX_INLINE void CLOX_STDCALL clox_CodeBlockGrow(CloxCodeBlock_t *const codeBlock)
 {
-    return cloxCodeBlockResize(codeBlock, codeBlock->capacity * CLOX_CODE_BLOCK_GROWING_FACTOR);
+    return cloxCodeBlockResize(codeBlock, max(codeBlock->capacity * CLOX_CODE_BLOCK_GROWING_FACTOR, CLOX_SIZEOF_WORD_PTR));
 }
 
 CLOX_API byte_t CLOX_STDCALL cloxCodeBlockPush(CloxCodeBlock_t *const codeBlock, const byte_t value)
 {
-    assert(codeBlock != NULL);
+    assert(codeBlock != NULL && !codeBlock->frozen);
 
     if (codeBlock->count >= codeBlock->capacity)
         clox_CodeBlockGrow(codeBlock);
 
+    if (codeBlock->decoded.instructions)
+        cloxCodeBlockInvalidate(codeBlock);
+
     return codeBlock->array[codeBlock->count++] = value;
 }
 
 CLOX_INLINE bool_t CLOX_STDCALL clox_CodeBlockCheckBounds(const CloxCodeBlock_t *const codeBlock, const size_t index)
 {
-    return (index > 0) && (index < codeBlock->capacity);
+    return index < codeBlock->count;
 }
 
 CLOX_API byte_t CLOX_STDCALL cloxCodeBlockPeek(const CloxCodeBlock_t *const codeBlock, const uint32_t offset)
@@ -118,7 +263,7 @@ CLOX_API byte_t CLOX_STDCALL cloxCodeBlockPeek(const CloxCodeBlock_t *const code
 
     CLOX_REGISTER byte_t result;
 
-    if (clox_CodeBlockCheckBounds(codeBlock, codeBlock->count - offset))
+    if (offset < codeBlock->count)
         result = codeBlock->array[codeBlock->count - offset - 1];
     else
         fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
@@ -128,7 +273,7 @@ CLOX_API byte_t CLOX_STDCALL cloxCodeBlockPeek(const CloxCodeBlock_t *const code
 
 CLOX_API byte_t CLOX_STDCALL cloxCodeBlockPop(CloxCodeBlock_t *const codeBlock)
 {
-    assert(codeBlock != NULL);
+    assert(codeBlock != NULL && !codeBlock->frozen);
 
     CLOX_REGISTER byte_t result;
 
@@ -137,6 +282,8 @@ CLOX_API byte_t CLOX_STDCALL cloxCodeBlockPop(CloxCodeBlock_t *const codeBlock)
     else
         fail(CLOX_ERROR_MESSAGE_BUFFER_UNDERRUN, NULL);
 
+    cloxCodeBlockInvalidate(codeBlock);
+
     return result;
 }
 
@@ -170,24 +317,1119 @@ CLOX_API byte_t CLOX_STDCALL cloxCodeBlockGet(const CloxCodeBlock_t *const codeB
 
 CLOX_API const byte_t *CLOX_STDCALL cloxCodeBlockWrite(CloxCodeBlock_t *const codeBlock, const byte_t *const buffer, const size_t count)
 {
-    assert(codeBlock != NULL);
+    assert(codeBlock != NULL && !codeBlock->frozen);
 
     if ((codeBlock->count + count) >= codeBlock->capacity)
-        cloxCodeBlockExpand(codeBlock, (codeBlock->count + count) - codeBlock->capacity);
+    {
+        CLOX_REGISTER size_t capacity = max(codeBlock->capacity, CLOX_SIZEOF_WORD_PTR);
+
+        /* grows like the pushes, so the writes of a block take linear time */
+        while ((codeBlock->count + count) >= capacity)
+            capacity *= CLOX_CODE_BLOCK_GROWING_FACTOR;
+
+        cloxCodeBlockResize(codeBlock, capacity);
+    }
+    else
+        cloxCodeBlockInvalidate(codeBlock);
 
-    bufcpy(codeBlock->array, buffer, count);
+    bufcpy(codeBlock->array + codeBlock->count, buffer, count);
 
     return codeBlock->count += count, buffer;
 }
 
+/**
+ * @brief       This function encodes an unsigned variable-length integer (7 bits
+ *              per byte, the high bit set when more bytes follow).
+ *
+ * @return      The number of bytes written.
+ */
+CLOX_INLINE size_t CLOX_STDCALL clox_LineTableEncode(byte_t *const buffer, uint64_t value)
+{
+    CLOX_REGISTER size_t count = 0;
+
+    do
+    {
+        CLOX_REGISTER const byte_t bits = (byte_t)(value & 0x7F);
+
+        value >>= 7;
+        buffer[count++] = bits | (value ? 0x80 : 0x00);
+    } while (value);
+
+    return count;
+}
+
+/**
+ * @brief       This function decodes an unsigned variable-length integer,
+ *              never reading past the end of the runs (a malformed table just
+ *              stops the decoding).
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_LineTableDecodeValue(const byte_t *const runs, const size_t size, size_t *const position, uint64_t *const outValue)
+{
+    CLOX_REGISTER uint64_t value = 0;
+    CLOX_REGISTER unsigned shift;
+
+    for (shift = 0; (*position < size) && (shift < 64); shift += 7)
+    {
+        CLOX_REGISTER const byte_t bits = runs[(*position)++];
+
+        value |= (uint64_t)(bits & 0x7F) << shift;
+
+        if (!(bits & 0x80))
+            return *outValue = value, TRUE;
+    }
+
+    return FALSE;
+}
+
+/* signed differences are zigzag encoded, so small negative ones stay small */
+#define clox_LineTableZigZag(delta)   (((uint64_t)(delta) << 1) ^ (uint64_t)((delta) >> 63))
+#define clox_LineTableUnZigZag(value) ((int64_t)((value) >> 1) ^ -(int64_t)((value) & 1))
+
+/**
+ * @brief       This function decodes the run that follows the specified state,
+ *              updating the state to it.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_LineTableDecode(const CloxLineTable_t *const lines, size_t *const position, CloxLineCheckpoint_t *const state)
+{
+    uint64_t offset, line, column;
+
+    if (!clox_LineTableDecodeValue(lines->runs, lines->runsSize, position, &offset)
+     || !clox_LineTableDecodeValue(lines->runs, lines->runsSize, position, &line)
+     || !clox_LineTableDecodeValue(lines->runs, lines->runsSize, position, &column))
+        return FALSE;
+
+    state->offset += (uint32_t)offset;
+    state->line    = (uint32_t)((int64_t)state->line + clox_LineTableUnZigZag(line));
+    state->column  = (uint32_t)((int64_t)state->column + clox_LineTableUnZigZag(column));
+
+    return TRUE;
+}
+
+/**
+ * @brief       This data structure provides an instruction decoded by the
+ *              peephole pass.
+ */
+typedef struct _CloxPeepholeInstruction
+{
+    /**
+     * @brief   The bytes of the instruction (opcode and operands).
+     */
+    byte_t bytes[cloxGetOpKindSize(CLOX_OP_KIND_FULL)];
+    /**
+     * @brief   The size (in bytes) of the instruction.
+     */
+    byte_t size;
+    /**
+     * @brief   TRUE if the instruction has been fused into the previous one
+     *          or dropped.
+     */
+    bool_t removed;
+    /**
+     * @brief   TRUE if the instruction is the target of a jump or a branch.
+     */
+    bool_t isTarget;
+    /**
+     * @brief   The offset of the instruction, in the original block and then
+     *          in the rewritten one.
+     */
+    size_t offset;
+    /**
+     * @brief   The index of the target instruction of a jump or a branch, or
+     *          SIZE_MAX for other instructions.
+     */
+    size_t target;
+    /**
+     * @brief   The index of the first instruction kept from this one on (the
+     *          instruction itself when it is kept), once the 'nop' ones have
+     *          been dropped.
+     */
+    size_t kept;
+} CloxPeepholeInstruction_t;
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_PeepholeIsRelativeJump(const byte_t opCode)
+{
+    return (opCode == CLOX_OP_CODE_CALL) || (opCode == CLOX_OP_CODE_TCALL)
+        || ((opCode >= CLOX_OP_CODE_JMP) && (opCode <= CLOX_OP_CODE_JLE))
+        || ((opCode >= CLOX_OP_CODE_CJEQ) && (opCode <= CLOX_OP_CODE_CJLE));
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_PeepholeIsCompareJump(const byte_t opCode)
+{
+    return (opCode >= CLOX_OP_CODE_JEQ) && (opCode <= CLOX_OP_CODE_JLE);
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_CodeBlockPeepholeRelease(CloxCodeBlock_t *const codeBlock, const CloxArenaMark_t mark, CloxPeepholeInstruction_t *const instructions, size_t *const indexes)
+{
+    if (codeBlock->arena)
+    {
+        cloxArenaRewind(codeBlock->arena, mark);
+    }
+    else
+    {
+        free(instructions);
+        free(indexes);
+    }
+
+    return;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockPeephole(CloxCodeBlock_t *const codeBlock, const CloxPeephole_t peephole)
+{
+    assert(codeBlock != NULL && !codeBlock->frozen);
+
+    CLOX_REGISTER size_t i, j, n, offset;
+
+    CloxPeepholeInstruction_t *instructions;
+    size_t *indexes;
+
+    CloxArenaMark_t mark = { NULL, 0, 0 };
+
+    if (!peephole || !codeBlock->count)
+        return 0;
+
+    cloxCodeBlockInvalidate(codeBlock);
+
+    /* the block is relaid in place, so the scratch arrays taken from the
+     * arena can be released rewinding it */
+    if (codeBlock->arena)
+        mark = cloxArenaMark(codeBlock->arena);
+
+    /* indexes maps each offset of the block to the index of the instruction
+     * starting there (SIZE_MAX when inside an instruction), the end of the
+     * block is a valid target too */
+    instructions = clox_CodeBlockScratch(codeBlock, CloxPeepholeInstruction_t, codeBlock->count + 1);
+    indexes      = clox_CodeBlockScratch(codeBlock, size_t, codeBlock->count + 1);
+
+    for (offset = 0; offset <= codeBlock->count; offset++)
+        indexes[offset] = SIZE_MAX;
+
+    for (n = 0, offset = 0; offset < codeBlock->count; n++)
+    {
+        CloxOpCodeInfo_t opCodeInfo;
+
+        if (!cloxGetOpCodeInfo(codeBlock->array[offset], &opCodeInfo) || ((offset + cloxGetOpKindSize(opCodeInfo.kind)) > codeBlock->count))
+            goto l_untouched;
+
+        instructions[n].size     = (byte_t)cloxGetOpKindSize(opCodeInfo.kind);
+        instructions[n].removed  = FALSE;
+        instructions[n].isTarget = FALSE;
+        instructions[n].offset   = offset;
+        instructions[n].target   = SIZE_MAX;
+
+        memcpy(instructions[n].bytes, codeBlock->array + offset, instructions[n].size);
+
+        indexes[offset] = n;
+        offset += instructions[n].size;
+    }
+
+    indexes[codeBlock->count] = n;
+    instructions[n].offset    = codeBlock->count;
+
+    /* resolves jumps and branches targets */
+    for (i = 0; i < n; i++)
+    {
+        CloxPeepholeInstruction_t *const instruction = &instructions[i];
+
+        CLOX_REGISTER const byte_t opCode = instruction->bytes[0];
+        CLOX_REGISTER int64_t target;
+
+        /* the fused register jumps of a block already rewritten are relative
+         * on 16 bits */
+        if ((opCode >= CLOX_OP_CODE_RJEQ) && (opCode <= CLOX_OP_CODE_RJLE))
+            target = (int64_t)(instruction->offset + instruction->size) + (int16_t)cloxDecodeOpHalf(instruction->bytes + 1);
+        else if ((instruction->size != cloxGetOpKindSize(CLOX_OP_KIND_JUMP)) || (opCode < CLOX_OP_CODE_CALL) || (opCode > CLOX_OP_CODE_CJLE) || ((opCode > CLOX_OP_CODE_BLE) && !clox_PeepholeIsRelativeJump(opCode)))
+            continue;
+        else if (clox_PeepholeIsRelativeJump(opCode))
+            target = (int64_t)(instruction->offset + instruction->size) + (int32_t)cloxDecodeOpWord(instruction->bytes + 1);
+        else
+            target = (int64_t)cloxDecodeOpWord(instruction->bytes + 1);
+
+        if ((target < 0) || (target > (int64_t)codeBlock->count) || (indexes[target] == SIZE_MAX))
+            goto l_untouched;
+
+        instruction->target = indexes[target];
+    }
+
+    if (hasflag(peephole, CLOX_PEEPHOLE_NOPS))
+    {
+        for (i = 0; i < n; i++)
+            instructions[i].removed = (bool_t)(instructions[i].bytes[0] == CLOX_OP_CODE_NOP);
+
+        /* the jumps to a dropped instruction land on the next one kept */
+        for (i = n, j = n; i--; )
+            instructions[i].kept = instructions[i].removed ? j : (j = i);
+
+        for (i = 0; i < n; i++)
+        {
+            if (instructions[i].target < n)
+                instructions[i].target = instructions[instructions[i].target].kept;
+        }
+    }
+
+    if (hasflag(peephole, CLOX_PEEPHOLE_JUMP_CHAINS))
+    {
+        for (i = 0; i < n; i++)
+        {
+            CLOX_REGISTER size_t target = instructions[i].target, steps;
+
+            /* a longer register jump might not fit into its 16 bits */
+            if ((instructions[i].bytes[0] >= CLOX_OP_CODE_RJEQ) && (instructions[i].bytes[0] <= CLOX_OP_CODE_RJLE))
+                continue;
+
+            /* the steps bound stops on cycles of unconditional jumps */
+            for (steps = 0; (target < n) && (steps < n); steps++)
+            {
+                CLOX_REGISTER const byte_t opCode = instructions[target].bytes[0];
+
+                if ((opCode != CLOX_OP_CODE_JMP) && (opCode != CLOX_OP_CODE_BR))
+                    break;
+
+                target = instructions[target].target;
+            }
+
+            if (steps < n)
+                instructions[i].target = target;
+        }
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if (instructions[i].target < n)
+            instructions[instructions[i].target].isTarget = TRUE;
+    }
+
+    for (i = 0; (i + 1) < n; i++)
+    {
+        /* the dropped instructions between the two are skipped, each run of
+         * them once (from the instruction kept before it) */
+        if (instructions[i].removed)
+            continue;
+
+        for (j = i + 1; (j < n) && instructions[j].removed; j++)
+            continue;
+
+        if (j >= n)
+            break;
+
+        CloxPeepholeInstruction_t *const first  = &instructions[i];
+        CloxPeepholeInstruction_t *const second = &instructions[j];
+
+        if (second->isTarget)
+            continue;
+
+        if (hasflag(peephole, CLOX_PEEPHOLE_COMPARE_JUMP) && clox_PeepholeIsCompareJump(second->bytes[0]))
+        {
+            CLOX_REGISTER const byte_t condition = second->bytes[0] - CLOX_OP_CODE_JEQ;
+
+            if (first->bytes[0] == CLOX_OP_CODE_CMP)
+            {
+                first->bytes[0] = CLOX_OP_CODE_CJEQ + condition;
+                first->size     = cloxGetOpKindSize(CLOX_OP_KIND_JUMP);
+                first->target   = second->target;
+                second->removed = TRUE;
+            }
+            else if (first->bytes[0] == CLOX_OP_CODE_RCMP)
+            {
+                /* the rewritten offsets can only be nearer, so the original
+                 * distance tells if the jump fits into 16 bits */
+                CLOX_REGISTER const int64_t distance = (int64_t)instructions[second->target].offset - (int64_t)(second->offset + second->size);
+
+                if ((distance >= INT16_MIN) && (distance <= INT16_MAX))
+                {
+                    CLOX_REGISTER const byte_t x = first->bytes[2], y = first->bytes[3];
+
+                    memset(first->bytes, 0, sizeof(first->bytes));
+
+                    first->bytes[0] = CLOX_OP_CODE_RJEQ + condition;
+                    first->bytes[3] = x;
+                    first->bytes[5] = y;
+                    first->size     = cloxGetOpKindSize(CLOX_OP_KIND_FULL);
+                    first->target   = second->target;
+                    second->removed = TRUE;
+                }
+            }
+        }
+        else if (hasflag(peephole, CLOX_PEEPHOLE_CONSTANT_MATH) && (first->bytes[0] == CLOX_OP_CODE_LDC))
+        {
+            CLOX_REGISTER const byte_t t = first->bytes[1];
+            CLOX_REGISTER const byte_t z = second->bytes[1], x = second->bytes[2], y = second->bytes[3];
+
+            CLOX_REGISTER byte_t opCode, source;
+
+            if ((second->bytes[0] == CLOX_OP_CODE_RADD) && (y == t))
+                opCode = CLOX_OP_CODE_RADC, source = x;
+            else if ((second->bytes[0] == CLOX_OP_CODE_RADD) && (x == t))
+                opCode = CLOX_OP_CODE_RADC, source = y;
+            else if ((second->bytes[0] == CLOX_OP_CODE_RSUB) && (y == t))
+                opCode = CLOX_OP_CODE_RSBC, source = x;
+            else
+                continue;
+
+            CLOX_REGISTER const byte_t constantLow = first->bytes[2], constantHigh = first->bytes[3];
+
+            first->bytes[0] = opCode;
+            first->bytes[1] = z;
+            first->bytes[2] = source;
+            first->bytes[3] = t;
+            first->bytes[4] = constantLow;
+            first->bytes[5] = constantHigh;
+            first->size     = cloxGetOpKindSize(CLOX_OP_KIND_LONG);
+            second->removed = TRUE;
+        }
+    }
+
+    /* lays out the rewritten block, the end of the block is the n-th one; a
+     * dropped instruction gets the offset of the next kept one */
+    for (i = 0, offset = 0; i < n; i++)
+    {
+        instructions[i].offset = offset;
+
+        if (!instructions[i].removed)
+            offset += instructions[i].size;
+    }
+
+    instructions[n].offset = offset;
+
+    for (i = 0; i < n; i++)
+    {
+        CloxPeepholeInstruction_t *const instruction = &instructions[i];
+
+        if (instruction->removed || (instruction->target == SIZE_MAX))
+            continue;
+
+        CLOX_REGISTER const size_t target = instructions[instruction->target].offset;
+        CLOX_REGISTER const int64_t distance = (int64_t)target - (int64_t)(instruction->offset + instruction->size);
+
+        if ((instruction->bytes[0] >= CLOX_OP_CODE_RJEQ) && (instruction->bytes[0] <= CLOX_OP_CODE_RJLE))
+            cloxEncodeOpHalf(instruction->bytes + 1, (uint16_t)(int16_t)distance);
+        else if (clox_PeepholeIsRelativeJump(instruction->bytes[0]))
+            cloxEncodeOpWord(instruction->bytes + 1, (uint32_t)(int32_t)distance);
+        else
+            cloxEncodeOpWord(instruction->bytes + 1, (uint32_t)target);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if (!instructions[i].removed)
+            memcpy(codeBlock->array + instructions[i].offset, instructions[i].bytes, instructions[i].size);
+    }
+
+    /* the runs of the line table move with their instructions, the runs of
+     * fused instructions begin with the next one; they are kept on the heap
+     * since the scratch arrays may be rewound */
+    CloxLineCheckpoint_t *runs = NULL;
+    size_t runsCount = 0;
+
+    if (codeBlock->lines.count)
+    {
+        CloxLineCheckpoint_t state = { 0, 0, 0, 0 };
+        size_t position = 0;
+
+        runs = dim(CloxLineCheckpoint_t, codeBlock->lines.count);
+
+        while ((runsCount < codeBlock->lines.count) && clox_LineTableDecode(&codeBlock->lines, &position, &state))
+        {
+            CLOX_REGISTER size_t start = min((size_t)state.offset, codeBlock->count);
+
+            while (indexes[start] == SIZE_MAX)
+                start--;
+
+            runs[runsCount] = state;
+            runs[runsCount++].offset = (uint32_t)instructions[indexes[start]].offset;
+        }
+    }
+
+    /* so do the bodies of the functions, the ones left empty are dropped */
+    for (i = 0, j = 0; i < codeBlock->symbolsCount; i++)
+    {
+        CloxCodeSymbol_t symbol = codeBlock->symbols[i];
+
+        if ((indexes[symbol.offset] == SIZE_MAX) || (indexes[symbol.end] == SIZE_MAX))
+            continue;
+
+        symbol.offset = (uint32_t)instructions[indexes[symbol.offset]].offset;
+        symbol.end    = (uint32_t)instructions[indexes[symbol.end]].offset;
+
+        if (symbol.offset < symbol.end)
+            codeBlock->symbols[j++] = symbol;
+    }
+
+    codeBlock->symbolsCount = j;
+
+    offset = codeBlock->count - instructions[n].offset;
+    codeBlock->count = instructions[n].offset;
+
+    clox_CodeBlockPeepholeRelease(codeBlock, mark, instructions, indexes);
+
+    if (runs)
+    {
+        codeBlock->lines.runsSize = 0;
+        codeBlock->lines.checkpointsCount = 0;
+        codeBlock->lines.count = 0;
+
+        memset(&codeBlock->lines.last, 0, sizeof(codeBlock->lines.last));
+        memset(&codeBlock->lines.base, 0, sizeof(codeBlock->lines.base));
+
+        for (i = 0; i < runsCount; i++)
+        {
+            CloxSourceLocation_t location;
+
+            cloxCodeBlockAddLine(codeBlock, runs[i].offset, cloxSetSourceLocation(&location, 0, runs[i].column, runs[i].line));
+        }
+
+        free(runs);
+    }
+
+    return offset;
+
+l_untouched:
+    clox_CodeBlockPeepholeRelease(codeBlock, mark, instructions, indexes);
+
+    return 0;
+}
+
+/**
+ * @brief       This function gets the index of the record of the instruction a
+ *              jump or a branch targets.
+ *
+ * @return      The index of the target record, or SIZE_MAX if the target is not
+ *              an instruction (the end of the block is one).
+ */
+CLOX_INLINE size_t CLOX_STDCALL clox_CodeBlockDecodeTarget(const CloxCodeBlock_t *const codeBlock, const uint32_t *const indexes, const int64_t target)
+{
+    if ((target < 0) || (target > (int64_t)codeBlock->count) || !indexes[target])
+        return SIZE_MAX;
+
+    return (size_t)indexes[target] - 1;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxCodeBlockDecode(CloxCodeBlock_t *const codeBlock, const void *const *const handlers)
+{
+    assert(codeBlock != NULL);
+
+    CLOX_REGISTER size_t i, n, offset;
+
+    CloxDecodedInstruction_t *instructions;
+    uint32_t *offsets, *indexes;
+
+    if (codeBlock->decoded.instructions && (codeBlock->decoded.handlers == handlers))
+        return TRUE;
+
+    if (codeBlock->frozen)
+        return FALSE;
+
+    cloxCodeBlockInvalidate(codeBlock);
+
+    if (codeBlock->count >= UINT32_MAX)
+        return FALSE;
+
+    /* indexes maps each offset of the block to the index of the instruction
+     * starting there plus one (zero when inside an instruction), the end of
+     * the block is the record that ends the decoded block */
+    indexes = dim(uint32_t, codeBlock->count + 1);
+
+    for (n = 0, offset = 0; offset < codeBlock->count; n++)
+    {
+        CloxOpCodeInfo_t opCodeInfo;
+
+        if (!cloxGetOpCodeInfo(codeBlock->array[offset], &opCodeInfo) || ((offset + cloxGetOpKindSize(opCodeInfo.kind)) > codeBlock->count))
+        {
+            free(indexes);
+            return FALSE;
+        }
+
+        indexes[offset] = (uint32_t)(n + 1);
+        offset += cloxGetOpKindSize(opCodeInfo.kind);
+    }
+
+    indexes[codeBlock->count] = (uint32_t)(n + 1);
+
+    instructions = dim(CloxDecodedInstruction_t, n + 1);
+    offsets      = dim(uint32_t, n + 1);
+
+    for (i = 0, offset = 0; i < n; i++)
+    {
+        const byte_t *const bytes = codeBlock->array + offset;
+        CloxDecodedInstruction_t *const instruction = &instructions[i];
+        CloxOpCodeInfo_t opCodeInfo;
+
+        CLOX_REGISTER size_t target = SIZE_MAX;
+
+        cloxGetOpCodeInfo(bytes[0], &opCodeInfo);
+
+        instruction->handler = handlers ? handlers[bytes[0]] : NULL;
+        instruction->opCode  = bytes[0];
+        offsets[i]           = (uint32_t)offset;
+
+        switch (opCodeInfo.kind)
+        {
+        case CLOX_OP_KIND_FAST:
+            instruction->z = bytes[1];
+            break;
+
+        case CLOX_OP_KIND_CTRL:
+            instruction->operand = cloxDecodeOpHalf(bytes + 1);
+            instruction->z       = bytes[3];
+            break;
+
+        case CLOX_OP_KIND_DATA:
+            instruction->z       = bytes[1];
+            instruction->operand = cloxDecodeOpHalf(bytes + 2);
+            break;
+
+        case CLOX_OP_KIND_REGS:
+            instruction->z = bytes[1];
+            instruction->x = bytes[2];
+            instruction->y = bytes[3];
+            break;
+
+        case CLOX_OP_KIND_LONG:
+            /* the two 16-bit operands are stored as a single word, with the
+             * first byte of hX into x and the second one into y */
+            instruction->z       = bytes[1];
+            instruction->x       = bytes[2];
+            instruction->y       = bytes[3];
+            instruction->operand = cloxDecodeOpWord(bytes + 2);
+            break;
+
+        case CLOX_OP_KIND_JUMP:
+            if (clox_PeepholeIsRelativeJump(bytes[0]))
+                target = clox_CodeBlockDecodeTarget(codeBlock, indexes, (int64_t)(offset + cloxGetOpKindSize(CLOX_OP_KIND_JUMP)) + (int32_t)cloxDecodeOpWord(bytes + 1));
+            else
+                target = clox_CodeBlockDecodeTarget(codeBlock, indexes, (int64_t)cloxDecodeOpWord(bytes + 1));
+
+            if (target == SIZE_MAX)
+                goto l_rejected;
+
+            /* calls keep their count of arguments into z */
+            instruction->z       = bytes[5];
+            instruction->operand = (uint32_t)target;
+            break;
+
+        case CLOX_OP_KIND_FULL:
+            target = clox_CodeBlockDecodeTarget(codeBlock, indexes, (int64_t)(offset + cloxGetOpKindSize(CLOX_OP_KIND_FULL)) + (int16_t)cloxDecodeOpHalf(bytes + 1));
+
+            if (target == SIZE_MAX)
+                goto l_rejected;
+
+            instruction->x       = bytes[3];
+            instruction->y       = bytes[5];
+            instruction->operand = (uint32_t)target;
+            break;
+
+        default:
+            break;
+        }
+
+        /* the operands checked here are not checked again at run-time */
+        switch (bytes[0])
+        {
+        case CLOX_OP_CODE_LEC:
+        case CLOX_OP_CODE_LEA:
+        case CLOX_OP_CODE_LECW:
+        case CLOX_OP_CODE_LEAW:
+            if (instruction->operand >= codeBlock->constantsCount)
+                goto l_rejected;
+
+            break;
+
+        case CLOX_OP_CODE_LDG:
+        case CLOX_OP_CODE_STG:
+        case CLOX_OP_CODE_NCALL:
+        case CLOX_OP_CODE_GETP:
+        case CLOX_OP_CODE_SETP:
+        case CLOX_OP_CODE_INVK:
+            if ((instruction->operand >> 16) >= codeBlock->cachesCount)
+                goto l_rejected;
+
+            break;
+
+        default:
+            break;
+        }
+
+        offset += cloxGetOpKindSize(opCodeInfo.kind);
+    }
+
+    instructions[n].handler = handlers ? handlers[CLOX_DECODED_OP_CODE_END] : NULL;
+    instructions[n].opCode  = CLOX_DECODED_OP_CODE_END;
+    offsets[n]              = (uint32_t)codeBlock->count;
+
+    free(indexes);
+
+    codeBlock->decoded.instructions = instructions;
+    codeBlock->decoded.offsets      = offsets;
+    codeBlock->decoded.count        = n;
+    codeBlock->decoded.handlers     = handlers;
+
+#if CLOX_VM_JIT
+    codeBlock->decoded.counters     = dim(uint32_t, n + 1);
+    codeBlock->decoded.regions      = dim(CloxJitCode_t *, n + 1);
+#endif
+
+    return TRUE;
+
+l_rejected:
+    free(instructions);
+    free(offsets);
+    free(indexes);
+
+    return FALSE;
+}
+
+CLOX_API void CLOX_STDCALL cloxCodeBlockInvalidate(CloxCodeBlock_t *const codeBlock)
+{
+    assert(codeBlock != NULL && !codeBlock->frozen);
+
+    if (codeBlock->decoded.instructions)
+        free(codeBlock->decoded.instructions);
+
+    if (codeBlock->decoded.offsets)
+        free(codeBlock->decoded.offsets);
+
+#if CLOX_VM_JIT
+    if (codeBlock->decoded.regions)
+    {
+        CLOX_REGISTER size_t i;
+
+        for (i = 0; i <= codeBlock->decoded.count; i++)
+            cloxJitRelease(codeBlock->decoded.regions[i]);
+
+        free(codeBlock->decoded.regions);
+    }
+
+    if (codeBlock->decoded.counters)
+        free(codeBlock->decoded.counters);
+#endif
+
+    memset(&codeBlock->decoded, 0, sizeof(codeBlock->decoded));
+
+    if (codeBlock->depths)
+        free(codeBlock->depths);
+
+    codeBlock->depths = NULL;
+
+    return;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxCodeBlockFreeze(CloxCodeBlock_t *const codeBlock)
+{
+    assert(codeBlock != NULL);
+
+    for (size_t i = 0; i < codeBlock->constantsCount; i++)
+        if (cloxValueType(codeBlock->constants[i]) == CLOX_VALUE_TYPE_OBJT)
+            return FALSE;
+
+    codeBlock->frozen = TRUE;
+
+    return TRUE;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockAddConstant(CloxCodeBlock_t *const codeBlock, const CloxValue_t value)
+{
+    assert(codeBlock != NULL && !codeBlock->frozen);
+
+    if (codeBlock->constantsCount >= codeBlock->constantsCapacity)
+    {
+        CLOX_REGISTER const size_t oldCapacity = codeBlock->constantsCapacity;
+
+        if (codeBlock->constantsCapacity)
+            codeBlock->constantsCapacity *= CLOX_CODE_BLOCK_GROWING_FACTOR;
+        else
+            codeBlock->constantsCapacity = CLOX_CODE_BLOCK_CONSTANTS_CAPACITY;
+
+        codeBlock->constants = clox_CodeBlockRedim(codeBlock, CloxValue_t, codeBlock->constants, oldCapacity, codeBlock->constantsCapacity);
+    }
+
+    codeBlock->constants[codeBlock->constantsCount] = value;
+
+    return codeBlock->constantsCount++;
+}
+
+/**
+ * @brief       This function gets the datum of a constant as an integer, equal
+ *              constants of the same type have the same datum.
+ */
+CLOX_INLINE uint64_t CLOX_STDCALL clox_CodeBlockConstantDatum(const CloxValue_t *const value)
+{
+    switch (cloxValueType(*value))
+    {
+    case CLOX_VALUE_TYPE_BOOL:
+        return (uint64_t)asBool(cloxValueAsBool(*value));
+
+    case CLOX_VALUE_TYPE_BYTE:
+        return (uint64_t)cloxValueAsByte(*value);
+
+    case CLOX_VALUE_TYPE_UINT:
+        return (uint64_t)cloxValueAsUInt(*value);
+
+    case CLOX_VALUE_TYPE_SINT:
+        return (uint64_t)(int64_t)cloxValueAsSInt(*value);
+
+    case CLOX_VALUE_TYPE_REAL:
+    {
+        /* long double reals have padding bytes, so only the double part is
+         * hashed (the comparison is exact anyway) */
+        const double real = (double)cloxValueAsReal(*value);
+        uint64_t datum;
+
+        memcpy(&datum, &real, sizeof(datum));
+
+        return datum;
+    }
+
+    case CLOX_VALUE_TYPE_VPTR:
+    case CLOX_VALUE_TYPE_OBJT:
+        return (uint64_t)(iptr_t)cloxValueAsVPtr(*value);
+
+    default:
+        return 0;
+    }
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_CodeBlockConstantEquals(const CloxValue_t *const x, const CloxValue_t *const y)
+{
+    if (cloxValueType(*x) != cloxValueType(*y))
+        return FALSE;
+
+    if (cloxValueType(*x) == CLOX_VALUE_TYPE_REAL)
+    {
+        CLOX_REGISTER const real_t a = cloxValueAsReal(*x), b = cloxValueAsReal(*y);
+
+        return (bool_t)((a == b) && (!signbit(a) == !signbit(b)));
+    }
+
+    return (bool_t)(clox_CodeBlockConstantDatum(x) == clox_CodeBlockConstantDatum(y));
+}
+
+CLOX_INLINE size_t CLOX_STDCALL clox_CodeBlockConstantHash(const CloxValue_t *const value)
+{
+    /* the finalizer of MurmurHash3, so that close data spread over the slots */
+    CLOX_REGISTER uint64_t hash = clox_CodeBlockConstantDatum(value) ^ ((uint64_t)cloxValueType(*value) << 56);
+
+    hash ^= hash >> 33;
+    hash *= UINT64_C(0xFF51AFD7ED558CCD);
+    hash ^= hash >> 33;
+    hash *= UINT64_C(0xC4CEB9FE1A85EC53);
+    hash ^= hash >> 33;
+
+    return (size_t)hash;
+}
+
+/**
+ * @brief       This function finds the slot of the index that stores a constant
+ *              equal to value, or the empty slot where it has to be inserted.
+ */
+CLOX_INLINE uint32_t *CLOX_STDCALL clox_CodeBlockFindSlot(const CloxCodeBlock_t *const codeBlock, const CloxValue_t *const value)
+{
+    CLOX_REGISTER const size_t mask = codeBlock->constantsIndexCapacity - 1;
+    CLOX_REGISTER size_t slot = clox_CodeBlockConstantHash(value) & mask;
+
+    /* the index is never full, so linear probing always finds a slot */
+    while (codeBlock->constantsIndex[slot] && !clox_CodeBlockConstantEquals(&codeBlock->constants[codeBlock->constantsIndex[slot] - 1], value))
+        slot = (slot + 1) & mask;
+
+    return &codeBlock->constantsIndex[slot];
+}
+
+/**
+ * @brief       This function inserts into the index the constants not indexed
+ *              yet, growing it so that one more constant keeps the load factor
+ *              below one half.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_CodeBlockIndexConstants(CloxCodeBlock_t *const codeBlock)
+{
+    CLOX_REGISTER const size_t count = codeBlock->constantsCount;
+
+    if (((count + 1) * 2) > codeBlock->constantsIndexCapacity)
+    {
+        CLOX_REGISTER size_t capacity = codeBlock->constantsIndexCapacity ? codeBlock->constantsIndexCapacity : CLOX_CODE_BLOCK_CONSTANTS_INDEX_CAPACITY;
+
+        while (((count + 1) * 2) > capacity)
+            capacity *= CLOX_CODE_BLOCK_GROWING_FACTOR;
+
+        if (codeBlock->constantsIndexCapacity)
+            clox_CodeBlockRelease(codeBlock, uint32_t, codeBlock->constantsIndex, codeBlock->constantsIndexCapacity);
+
+        codeBlock->constantsIndex = clox_CodeBlockDim(codeBlock, uint32_t, capacity);
+        codeBlock->constantsIndexCapacity = capacity;
+        codeBlock->constantsIndexCount = 0;
+    }
+
+    /* duplicates added by cloxCodeBlockAddConstant never take a slot */
+    for (size_t i = codeBlock->constantsIndexCount; i < count; i++)
+    {
+        uint32_t *const slot = clox_CodeBlockFindSlot(codeBlock, &codeBlock->constants[i]);
+
+        if (!*slot)
+            *slot = (uint32_t)(i + 1);
+    }
+
+    codeBlock->constantsIndexCount = count;
+
+    return;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockInternConstant(CloxCodeBlock_t *const codeBlock, const CloxValue_t value)
+{
+    assert(codeBlock != NULL && !codeBlock->frozen);
+
+    if (codeBlock->constantsCount >= UINT32_MAX)
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    clox_CodeBlockIndexConstants(codeBlock);
+
+    uint32_t *const slot = clox_CodeBlockFindSlot(codeBlock, &value);
+
+    if (!*slot)
+    {
+        *slot = (uint32_t)(cloxCodeBlockAddConstant(codeBlock, value) + 1);
+        codeBlock->constantsIndexCount = codeBlock->constantsCount;
+    }
+
+    return (size_t)*slot - 1;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockAddName(CloxCodeBlock_t *const codeBlock, const char *const name, const size_t length)
+{
+    assert(codeBlock != NULL && !codeBlock->frozen && (name != NULL || !length));
+
+    /* a block references a few names, so a scan is enough to share them */
+    for (size_t offset = 0; offset < codeBlock->namesSize; offset += strlen(codeBlock->names + offset) + 1)
+        if (!strncmp(codeBlock->names + offset, name, length) && (codeBlock->names[offset + length] == NUL))
+            return offset;
+
+    if ((codeBlock->namesSize + length + 1) > codeBlock->namesCapacity)
+    {
+        CLOX_REGISTER size_t capacity = codeBlock->namesCapacity ? codeBlock->namesCapacity : CLOX_CODE_BLOCK_NAMES_CAPACITY;
+
+        while ((codeBlock->namesSize + length + 1) > capacity)
+            capacity *= CLOX_CODE_BLOCK_GROWING_FACTOR;
+
+        if (codeBlock->namesCapacity)
+            codeBlock->names = clox_CodeBlockRedim(codeBlock, char, codeBlock->names, codeBlock->namesCapacity, capacity);
+        else
+            codeBlock->names = clox_CodeBlockDim(codeBlock, char, capacity);
+
+        codeBlock->namesCapacity = capacity;
+    }
+
+    CLOX_REGISTER const size_t offset = codeBlock->namesSize;
+
+    memcpy(codeBlock->names + offset, name, length);
+    codeBlock->names[offset + length] = NUL;
+    codeBlock->namesSize += length + 1;
+
+    return offset;
+}
+
+CLOX_API const char *CLOX_STDCALL cloxCodeBlockGetName(const CloxCodeBlock_t *const codeBlock, const size_t offset)
+{
+    assert(codeBlock != NULL);
+
+    if (offset >= codeBlock->namesSize)
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    return codeBlock->names + offset;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockAddCache(CloxCodeBlock_t *const codeBlock)
+{
+    assert(codeBlock != NULL && !codeBlock->frozen);
+
+    return codeBlock->cachesCount++;
+}
+
+CLOX_API const CloxValue_t *CLOX_STDCALL cloxCodeBlockGetConstant(const CloxCodeBlock_t *const codeBlock, const size_t index)
+{
+    assert(codeBlock != NULL);
+
+    CLOX_REGISTER const CloxValue_t *result;
+
+    if (index < codeBlock->constantsCount)
+        result = &codeBlock->constants[index];
+    else
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    return result;
+}
+
+CLOX_API void CLOX_STDCALL cloxCodeBlockAddLine(CloxCodeBlock_t *const codeBlock, const size_t offset, const CloxSourceLocation_t *const location)
+{
+    assert(codeBlock != NULL && !codeBlock->frozen && location != NULL);
+
+    CloxLineTable_t *const lines = &codeBlock->lines;
+
+    assert(!lines->count || (offset >= lines->last.offset));
+
+    if (lines->count && (location->ln == lines->last.line) && (location->co == lines->last.column))
+        return;
+
+    /* an empty run is dropped, the new one is encoded in its place (and it
+     * merges into the previous one when they have the same location) */
+    if (lines->count && (offset == lines->last.offset))
+    {
+        lines->runsSize = lines->last.position;
+        lines->count--;
+
+        if (lines->checkpointsCount && (lines->checkpoints[lines->checkpointsCount - 1].position == lines->runsSize))
+            lines->checkpointsCount--;
+
+        lines->last = lines->base;
+
+        if (lines->count && (location->ln == lines->last.line) && (location->co == lines->last.column))
+            return;
+    }
+
+    if ((lines->runsSize + CLOX_LINE_TABLE_RUN_SIZE) > lines->runsCapacity)
+    {
+        CLOX_REGISTER const size_t oldCapacity = lines->runsCapacity;
+
+        if (lines->runsCapacity)
+            lines->runsCapacity *= CLOX_CODE_BLOCK_GROWING_FACTOR;
+        else
+            lines->runsCapacity = CLOX_CODE_BLOCK_LINES_CAPACITY;
+
+        lines->runs = clox_CodeBlockRedim(codeBlock, byte_t, lines->runs, oldCapacity, lines->runsCapacity);
+    }
+
+    if (!(lines->count % CLOX_LINE_TABLE_CHECKPOINT_INTERVAL))
+    {
+        if (lines->checkpointsCount >= lines->checkpointsCapacity)
+        {
+            CLOX_REGISTER const size_t oldCapacity = lines->checkpointsCapacity;
+
+            if (lines->checkpointsCapacity)
+                lines->checkpointsCapacity *= CLOX_CODE_BLOCK_GROWING_FACTOR;
+            else
+                lines->checkpointsCapacity = CLOX_CODE_BLOCK_LINES_CAPACITY / CLOX_LINE_TABLE_CHECKPOINT_INTERVAL;
+
+            lines->checkpoints = clox_CodeBlockRedim(codeBlock, CloxLineCheckpoint_t, lines->checkpoints, oldCapacity, lines->checkpointsCapacity);
+        }
+
+        lines->checkpoints[lines->checkpointsCount] = lines->last;
+        lines->checkpoints[lines->checkpointsCount++].position = (uint32_t)lines->runsSize;
+    }
+
+    CLOX_REGISTER const int64_t line   = (int64_t)location->ln - (int64_t)lines->last.line;
+    CLOX_REGISTER const int64_t column = (int64_t)location->co - (int64_t)lines->last.column;
+
+    lines->base = lines->last;
+
+    lines->last.offset   = (uint32_t)offset;
+    lines->last.line     = location->ln;
+    lines->last.column   = location->co;
+    lines->last.position = (uint32_t)lines->runsSize;
+
+    lines->runsSize += clox_LineTableEncode(lines->runs + lines->runsSize, (uint64_t)(offset - lines->base.offset));
+    lines->runsSize += clox_LineTableEncode(lines->runs + lines->runsSize, clox_LineTableZigZag(line));
+    lines->runsSize += clox_LineTableEncode(lines->runs + lines->runsSize, clox_LineTableZigZag(column));
+    lines->count++;
+
+    return;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxCodeBlockGetLine(const CloxCodeBlock_t *const codeBlock, const size_t offset, CloxSourceLocation_t *const outLocation)
+{
+    assert(codeBlock != NULL && outLocation != NULL);
+
+    const CloxLineTable_t *const lines = &codeBlock->lines;
+    CloxLineCheckpoint_t state = { 0, 0, 0, 0 }, next;
+    size_t low = 0, high = lines->checkpointsCount, middle, position;
+    bool_t found;
+
+    /* the last checkpoint not after the offset, the first one is the state
+     * before the first run */
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+
+        if (lines->checkpoints[middle].offset <= offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low)
+        state = lines->checkpoints[low - 1];
+
+    found = (bool_t)(low > 1);
+
+    if ((position = state.position) > lines->runsSize)
+        return FALSE;
+
+    for (next = state; clox_LineTableDecode(lines, &position, &next) && (next.offset <= offset); state = next)
+        found = TRUE;
+
+    if (found)
+        cloxSetSourceLocation(outLocation, 0, state.column, state.line);
+
+    return found;
+}
+
+CLOX_API void CLOX_STDCALL cloxCodeBlockAddSymbol(CloxCodeBlock_t *const codeBlock, const size_t offset, const size_t end, const char *const name, const size_t length)
+{
+    assert(codeBlock != NULL && !codeBlock->frozen && (offset < end) && (end <= codeBlock->count));
+    assert(!codeBlock->symbolsCount || (codeBlock->symbols[codeBlock->symbolsCount - 1].end <= offset));
+
+    if (codeBlock->symbolsCount >= codeBlock->symbolsCapacity)
+    {
+        CLOX_REGISTER const size_t capacity = codeBlock->symbolsCapacity ? codeBlock->symbolsCapacity * CLOX_CODE_BLOCK_GROWING_FACTOR : CLOX_CODE_BLOCK_SYMBOLS_CAPACITY;
+
+        if (codeBlock->symbolsCapacity)
+            codeBlock->symbols = clox_CodeBlockRedim(codeBlock, CloxCodeSymbol_t, codeBlock->symbols, codeBlock->symbolsCapacity, capacity);
+        else
+            codeBlock->symbols = clox_CodeBlockDim(codeBlock, CloxCodeSymbol_t, capacity);
+
+        codeBlock->symbolsCapacity = capacity;
+    }
+
+    CloxCodeSymbol_t *const symbol = &codeBlock->symbols[codeBlock->symbolsCount++];
+
+    symbol->offset = (uint32_t)offset;
+    symbol->end    = (uint32_t)end;
+    symbol->name   = (uint32_t)cloxCodeBlockAddName(codeBlock, name, length);
+
+    return;
+}
+
+CLOX_API const CloxCodeSymbol_t *CLOX_STDCALL cloxCodeBlockFindSymbol(const CloxCodeBlock_t *const codeBlock, const size_t offset)
+{
+    assert(codeBlock != NULL);
+
+    size_t low = 0, high = codeBlock->symbolsCount, middle;
+
+    /* the last symbol beginning not after the offset */
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+
+        if (codeBlock->symbols[middle].offset <= offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (!low || (offset >= codeBlock->symbols[low - 1].end))
+        return NULL;
+
+    return &codeBlock->symbols[low - 1];
+}
+
 CLOX_API void CLOX_STDCALL cloxDeleteCodeBlock(CloxCodeBlock_t *const codeBlock)
 {
     assert(codeBlock != NULL);
 
-    if (codeBlock->array)
-        free(codeBlock->array);
+    codeBlock->frozen = FALSE;
+
+    /* the decoded form is never allocated from the arena */
+    cloxCodeBlockInvalidate(codeBlock);
+
+    /* blocks allocated from an arena are released with it */
+    if (codeBlock->arena)
+        return;
 
-    free(codeBlock);
+    free(cloxFreeCodeBlock(codeBlock));
     
     return;
 }
@@ -275,7 +1517,7 @@ CLOX_API size_t CLOX_STDCALL cloxCodeBlockReaderRead(CloxCodeBlockReader_t *cons
         CLOX_REGISTER byte_t *array = codeBlockReader->array;
 
         for (readCount = 0; (readCount < count) && (i < n); readCount++, i++)
-            outBuffer[readCount] = array[i + readCount];
+            outBuffer[readCount] = array[i];
 
         codeBlockReader->index = i;
     }
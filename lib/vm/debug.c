@@ -1,57 +1,222 @@
-/**
- * This file is part of the clox programming language project,
- * under the MIT License. See repo's LICENSE file for license
- * informations.
- */
-
-#include "clox/base/errno.h"
-#include "clox/base/file.h"
-#include "clox/vm/debug.h"
-#include "clox/vm/code.h"
-
-#ifndef CLOX_DISASSEMBLER_OFFSET_FORMAT
-#   if CLOX_ARCHTECT_IS_64_BIT
-#       define CLOX_DISASSEMBLER_OFFSET_FORMAT "%08X"
-#   else
-#       define CLOX_DISASSEMBLER_OFFSET_FORMAT "%04X"
-#   endif
-#endif
-
-CLOX_API void CLOX_STDCALL cloxDisassembleInstruction(FILE *const stream, CloxCodeBlockReader_t *const codeBlockReader)
-{
-    CloxOpCodeInfo_t opCodeInfo;
-
-    if (cloxGetOpCodeInfo(cloxCodeBlockReaderGet(codeBlockReader), &opCodeInfo))
-    {
-        fprintf(stream, CLOX_DISASSEMBLER_OFFSET_FORMAT " %-8s", (uint32_t)codeBlockReader->index - 1, opCodeInfo.name);
-
-        switch (opCodeInfo.kind)
-        {
-        default:
-            unreach();
-        }
-    }
-    else
-    {
-        fprintf(stream, CLOX_DISASSEMBLER_OFFSET_FORMAT " uknown (%02X)", (uint32_t)codeBlockReader->index - 1, opCodeInfo.code);
-    }
-
-    fputc(EOL, stream);
-
-    return;
-}
-
-CLOX_API void CLOX_STDCALL cloxDisassembleCodeBlock(FILE *const stream, const CloxCodeBlock_t *const codeBlock)
-{
-    assert(stream != NULL);
-
-    CloxCodeBlockReader_t codeBlockReader;
-
-    if (cloxInitCodeBlockReader(&codeBlockReader, codeBlock)->array)
-    {
-        while (!cloxCodeBlockReaderIsAtEnd(&codeBlockReader))
-            cloxDisassembleInstruction(stream, &codeBlockReader);
-    }
-
-    return;
-}
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/errno.h"
+#include "clox/base/file.h"
+#include "clox/vm/debug.h"
+#include "clox/vm/code.h"
+
+#ifndef CLOX_DISASSEMBLER_OFFSET_FORMAT
+#   if CLOX_ARCHTECT_IS_64_BIT
+#       define CLOX_DISASSEMBLER_OFFSET_FORMAT "%08X"
+#   else
+#       define CLOX_DISASSEMBLER_OFFSET_FORMAT "%04X"
+#   endif
+#endif
+
+CLOX_API void CLOX_STDCALL cloxDisassembleInstruction(FILE *const stream, CloxCodeBlockReader_t *const codeBlockReader)
+{
+    CloxOpCodeInfo_t opCodeInfo;
+
+    if (cloxGetOpCodeInfo(cloxCodeBlockReaderGet(codeBlockReader), &opCodeInfo))
+    {
+        fprintf(stream, CLOX_DISASSEMBLER_OFFSET_FORMAT " %-8s", (uint32_t)codeBlockReader->index - 1, opCodeInfo.name);
+
+        byte_t operands[8];
+
+        CLOX_REGISTER const size_t operandsCount = cloxGetOpKindSize(opCodeInfo.kind) - 1;
+
+        if (cloxCodeBlockReaderRead(codeBlockReader, operands, operandsCount) < operandsCount)
+        {
+            fputs(" <truncated>", stream);
+        }
+        else
+        {
+            switch (opCodeInfo.kind)
+            {
+            case CLOX_OP_KIND_BYTE:
+                break;
+
+            case CLOX_OP_KIND_FAST:
+                fprintf(stream, " r%u", operands[0]);
+                break;
+
+            case CLOX_OP_KIND_CTRL:
+                fprintf(stream, " %u, %u", cloxDecodeOpHalf(operands), operands[2]);
+                break;
+
+            case CLOX_OP_KIND_DATA:
+                fprintf(stream, " r%u, %u", operands[0], cloxDecodeOpHalf(operands + 1));
+                break;
+
+            case CLOX_OP_KIND_REGS:
+                fprintf(stream, " r%u, r%u, r%u", operands[0], operands[1], operands[2]);
+                break;
+
+            case CLOX_OP_KIND_LONG:
+                if ((opCodeInfo.code == CLOX_OP_CODE_RADC) || (opCodeInfo.code == CLOX_OP_CODE_RSBC))
+                    fprintf(stream, " r%u, r%u, %d (r%u)", operands[0], operands[1], (int16_t)cloxDecodeOpHalf(operands + 3), operands[2]);
+                else if ((opCodeInfo.code == CLOX_OP_CODE_LECW) || (opCodeInfo.code == CLOX_OP_CODE_LEAW))
+                    fprintf(stream, " r%u, %" PRIu32, operands[0], (uint32_t)cloxDecodeOpHalf(operands + 1) | ((uint32_t)cloxDecodeOpHalf(operands + 3) << 16));
+                else
+                    fprintf(stream, " r%u, %u, %u", operands[0], cloxDecodeOpHalf(operands + 1), cloxDecodeOpHalf(operands + 3));
+                break;
+
+            case CLOX_OP_KIND_JUMP:
+                if ((opCodeInfo.code < CLOX_OP_CODE_BR) || ((opCodeInfo.code >= CLOX_OP_CODE_CJEQ) && (opCodeInfo.code <= CLOX_OP_CODE_CJLE)))
+                {
+                    CLOX_REGISTER const int32_t offset = (int32_t)cloxDecodeOpWord(operands);
+
+                    fprintf(stream, " %+d (" CLOX_DISASSEMBLER_OFFSET_FORMAT ")", offset, (uint32_t)(codeBlockReader->index + offset));
+
+                    if ((opCodeInfo.code == CLOX_OP_CODE_CALL) || (opCodeInfo.code == CLOX_OP_CODE_TCALL))
+                        fprintf(stream, ", %u", operands[4]);
+                }
+                else
+                {
+                    fprintf(stream, " " CLOX_DISASSEMBLER_OFFSET_FORMAT, cloxDecodeOpWord(operands));
+                }
+                break;
+
+            case CLOX_OP_KIND_FULL:
+                if ((opCodeInfo.code >= CLOX_OP_CODE_RJEQ) && (opCodeInfo.code <= CLOX_OP_CODE_RJLE))
+                {
+                    CLOX_REGISTER const int16_t offset = (int16_t)cloxDecodeOpHalf(operands);
+
+                    fprintf(stream, " r%u, r%u, %+d (" CLOX_DISASSEMBLER_OFFSET_FORMAT ")", operands[2], operands[4], offset, (uint32_t)(codeBlockReader->index + offset));
+                    break;
+                }
+
+                fprintf(stream, " %u, %u, %u, %u", cloxDecodeOpHalf(operands), cloxDecodeOpHalf(operands + 2), cloxDecodeOpHalf(operands + 4), operands[6]);
+                break;
+
+            default:
+                unreach();
+            }
+        }
+    }
+    else
+    {
+        fprintf(stream, CLOX_DISASSEMBLER_OFFSET_FORMAT " uknown (%02X)", (uint32_t)codeBlockReader->index - 1, opCodeInfo.code);
+    }
+
+    fputc(EOL, stream);
+
+    return;
+}
+
+/**
+ * @brief       This function prints the source location of the instruction at
+ *              the specified offset, unless it is the previous one.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_DisassembleLine(FILE *const stream, const CloxCodeBlock_t *const codeBlock, const size_t offset, CloxSourceLocation_t *const previous)
+{
+    CloxSourceLocation_t location;
+
+    if (!cloxCodeBlockGetLine(codeBlock, offset, &location))
+        fputs("          ", stream);
+    else if ((location.ln == previous->ln) && (location.co == previous->co))
+        fputs("        | ", stream);
+    else
+        fprintf(stream, "%4" PRIu32 ":%-4" PRIu32 " ", location.ln + 1, location.co + 1), *previous = location;
+
+    return;
+}
+
+CLOX_API void CLOX_STDCALL cloxDisassembleCodeBlock(FILE *const stream, const CloxCodeBlock_t *const codeBlock)
+{
+    assert(stream != NULL);
+
+    CloxCodeBlockReader_t codeBlockReader;
+    CloxSourceLocation_t previous = { 0, UINT32_MAX, UINT32_MAX };
+
+    if (cloxInitCodeBlockReader(&codeBlockReader, codeBlock)->array)
+    {
+        while (!cloxCodeBlockReaderIsAtEnd(&codeBlockReader))
+        {
+            if (codeBlock->lines.runsSize)
+                clox_DisassembleLine(stream, codeBlock, codeBlockReader.index, &previous);
+
+            cloxDisassembleInstruction(stream, &codeBlockReader);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief       This function gets an upper bound of the cycles taken by the
+ *              specified fraction (per thousand) of the executions of an opcode.
+ */
+CLOX_INLINE uint64_t CLOX_STDCALL clox_OpCodeStatsPercentile(const CloxOpCodeStats_t *const stats, const uint64_t perMille)
+{
+    CLOX_REGISTER const uint64_t target = (stats->count * perMille + 999) / 1000;
+    CLOX_REGISTER uint64_t seen = 0;
+    size_t bucket;
+
+    for (bucket = 0; bucket < (CLOX_OP_CODE_HISTOGRAM_SIZE - 1); bucket++)
+        if ((seen += stats->histogram[bucket]) >= target)
+            break;
+
+    return (UINT64_C(2) << bucket) - 1;
+}
+
+CLOX_API void CLOX_STDCALL cloxDumpOpCodeStats(FILE *const stream, const CloxOpCodeStats_t *const stats)
+{
+    assert(stream != NULL && stats != NULL);
+
+    byte_t order[BYTE_MAX + 1];
+    size_t count = 0;
+
+    /* the executed opcodes, by insertion from the most expensive */
+    for (size_t opCode = 0; opCode <= BYTE_MAX; opCode++)
+    {
+        if (!stats[opCode].count)
+            continue;
+
+        size_t i = count++;
+
+        for (; i && (stats[order[i - 1]].cycles < stats[opCode].cycles); i--)
+            order[i] = order[i - 1];
+
+        order[i] = (byte_t)opCode;
+    }
+
+    fprintf(stream, "%-8s %12s %16s %8s %8s %8s\n", "opcode", "count", "cycles", "avg", "p50", "p99");
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const CloxOpCodeStats_t *const opCodeStats = &stats[order[i]];
+        CloxOpCodeInfo_t opCodeInfo;
+
+        cloxGetOpCodeInfo((CloxOpCode_t)order[i], &opCodeInfo);
+
+        fprintf(stream, "%-8s %12" PRIu64 " %16" PRIu64 " %8" PRIu64 " %8" PRIu64 " %8" PRIu64 "\n",
+            opCodeInfo.name, opCodeStats->count, opCodeStats->cycles, opCodeStats->cycles / opCodeStats->count,
+            clox_OpCodeStatsPercentile(opCodeStats, 500), clox_OpCodeStatsPercentile(opCodeStats, 990));
+    }
+
+    return;
+}
+
+CLOX_API void CLOX_STDCALL cloxDumpTraceRecord(FILE *const stream, const CloxTraceRecord_t *const record)
+{
+    assert(stream != NULL && record != NULL);
+
+    /* indexed by the low byte of the value types */
+    CLOX_STATIC const char *const typeNames[] = {
+        "void", "bool", "byte", "uint", "sint", "real", "vptr", "objt",
+    };
+
+    CloxOpCodeInfo_t opCodeInfo;
+
+    const char *const name = cloxGetOpCodeInfo((CloxOpCode_t)record->opCode, &opCodeInfo) ? opCodeInfo.name : "?";
+    const char *const type = (record->type == CLOX_TRACE_TYPE_NONE) ? "-" : (record->type < countof(typeNames)) ? typeNames[record->type] : "?";
+
+    fprintf(stream, CLOX_DISASSEMBLER_OFFSET_FORMAT " %-8s %-4s %" PRIu16 "\n", record->offset, name, type, record->depth);
+
+    return;
+}
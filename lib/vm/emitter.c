@@ -0,0 +1,259 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/errno.h"
+#include "clox/vm/emitter.h"
+
+#ifndef clox_EmitterCheckKind
+#   if CLOX_DEBUG
+#       define clox_EmitterCheckKind(opCode, opKind)                       \
+    do                                                                     \
+    {                                                                      \
+        CloxOpCodeInfo_t _opCodeInfo;                                      \
+                                                                           \
+        assert(cloxGetOpCodeInfo((opCode), &_opCodeInfo));                 \
+        assert(_opCodeInfo.kind == (opKind));                              \
+    } while (0)
+#   else
+#       define clox_EmitterCheckKind(opCode, opKind) ((void)0)
+#   endif
+#endif
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_EmitterIsRelativeJump(const CloxOpCode_t opCode)
+{
+    return (opCode == CLOX_OP_CODE_CALL) || (opCode == CLOX_OP_CODE_TCALL)
+        || ((opCode >= CLOX_OP_CODE_JMP) && (opCode <= CLOX_OP_CODE_JLE));
+}
+
+CLOX_INLINE size_t CLOX_STDCALL clox_EmitterWrite(CloxEmitter_t *const emitter, const byte_t *const instruction, const size_t count)
+{
+    CLOX_REGISTER const size_t offset = emitter->codeBlock->count;
+
+    cloxCodeBlockWrite(emitter->codeBlock, instruction, count);
+
+    return offset;
+}
+
+CLOX_API CloxEmitter_t *CLOX_STDCALL cloxInitEmitter(CloxEmitter_t *const emitter, CloxCodeBlock_t *const codeBlock)
+{
+    assert(emitter != NULL && codeBlock != NULL);
+
+    emitter->codeBlock      = codeBlock;
+    emitter->registersCount = 0;
+    emitter->registersMax   = 0;
+
+    return emitter;
+}
+
+CLOX_API CloxEmitter_t *CLOX_STDCALL cloxFreeEmitter(CloxEmitter_t *const emitter)
+{
+    assert(emitter != NULL);
+
+    emitter->codeBlock      = NULL;
+    emitter->registersCount = 0;
+    emitter->registersMax   = 0;
+
+    return emitter;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitterOffset(const CloxEmitter_t *const emitter)
+{
+    assert(emitter != NULL);
+
+    return emitter->codeBlock->count;
+}
+
+CLOX_API byte_t CLOX_STDCALL cloxEmitterPushRegister(CloxEmitter_t *const emitter)
+{
+    assert(emitter != NULL);
+
+    if (emitter->registersCount > BYTE_MAX)
+        fail(CLOX_ERROR_MESSAGE_STACK_OVERFLOW, NULL);
+
+    CLOX_REGISTER const byte_t result = (byte_t)emitter->registersCount++;
+
+    if (emitter->registersCount > emitter->registersMax)
+        emitter->registersMax = emitter->registersCount;
+
+    return result;
+}
+
+CLOX_API void CLOX_STDCALL cloxEmitterPopRegisters(CloxEmitter_t *const emitter, const uint16_t count)
+{
+    assert(emitter != NULL);
+
+    if (count > emitter->registersCount)
+        fail(CLOX_ERROR_MESSAGE_STACK_UNDERFLOW, NULL);
+
+    emitter->registersCount -= count;
+
+    return;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitByte(CloxEmitter_t *const emitter, const CloxOpCode_t opCode)
+{
+    assert(emitter != NULL);
+    clox_EmitterCheckKind(opCode, CLOX_OP_KIND_BYTE);
+
+    const byte_t instruction[] = { (byte_t)opCode };
+
+    return clox_EmitterWrite(emitter, instruction, sizeof(instruction));
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitFast(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t x)
+{
+    assert(emitter != NULL);
+    clox_EmitterCheckKind(opCode, CLOX_OP_KIND_FAST);
+
+    const byte_t instruction[] = { (byte_t)opCode, x };
+
+    return clox_EmitterWrite(emitter, instruction, sizeof(instruction));
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitCtrl(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const uint16_t x, const byte_t f)
+{
+    assert(emitter != NULL);
+    clox_EmitterCheckKind(opCode, CLOX_OP_KIND_CTRL);
+
+    byte_t instruction[cloxGetOpKindSize(CLOX_OP_KIND_CTRL)] = { (byte_t)opCode };
+
+    cloxEncodeOpHalf(instruction + 1, x);
+    instruction[3] = f;
+
+    return clox_EmitterWrite(emitter, instruction, sizeof(instruction));
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitData(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t z, const uint16_t x)
+{
+    assert(emitter != NULL);
+    clox_EmitterCheckKind(opCode, CLOX_OP_KIND_DATA);
+
+    byte_t instruction[cloxGetOpKindSize(CLOX_OP_KIND_DATA)] = { (byte_t)opCode, z };
+
+    cloxEncodeOpHalf(instruction + 2, x);
+
+    return clox_EmitterWrite(emitter, instruction, sizeof(instruction));
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitRegs(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t z, const byte_t x, const byte_t y)
+{
+    assert(emitter != NULL);
+    clox_EmitterCheckKind(opCode, CLOX_OP_KIND_REGS);
+
+    const byte_t instruction[] = { (byte_t)opCode, z, x, y };
+
+    return clox_EmitterWrite(emitter, instruction, sizeof(instruction));
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitLong(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t z, const uint16_t x, const uint16_t y)
+{
+    assert(emitter != NULL);
+    clox_EmitterCheckKind(opCode, CLOX_OP_KIND_LONG);
+
+    byte_t instruction[cloxGetOpKindSize(CLOX_OP_KIND_LONG)] = { (byte_t)opCode, z };
+
+    cloxEncodeOpHalf(cloxEncodeOpHalf(instruction + 2, x), y);
+
+    return clox_EmitterWrite(emitter, instruction, sizeof(instruction));
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitJump(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const uint32_t z)
+{
+    assert(emitter != NULL);
+    clox_EmitterCheckKind(opCode, CLOX_OP_KIND_JUMP);
+
+    byte_t instruction[cloxGetOpKindSize(CLOX_OP_KIND_JUMP)] = { (byte_t)opCode };
+
+    cloxEncodeOpWord(instruction + 1, z);
+
+    return clox_EmitterWrite(emitter, instruction, sizeof(instruction));
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitFull(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const uint16_t z, const uint16_t x, const uint16_t y, const byte_t f)
+{
+    assert(emitter != NULL);
+    clox_EmitterCheckKind(opCode, CLOX_OP_KIND_FULL);
+
+    byte_t instruction[cloxGetOpKindSize(CLOX_OP_KIND_FULL)] = { (byte_t)opCode };
+
+    cloxEncodeOpHalf(cloxEncodeOpHalf(cloxEncodeOpHalf(instruction + 1, z), x), y);
+    instruction[7] = f;
+
+    return clox_EmitterWrite(emitter, instruction, sizeof(instruction));
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitJumpTo(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const size_t target)
+{
+    CLOX_REGISTER const size_t offset = cloxEmitJump(emitter, opCode, 0);
+
+    cloxEmitterPatchJump(emitter, offset, target);
+
+    return offset;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitCall(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const size_t target, const byte_t count)
+{
+    CLOX_REGISTER const size_t offset = cloxEmitJumpTo(emitter, opCode, target);
+
+    emitter->codeBlock->array[offset + 5] = count;
+
+    return offset;
+}
+
+CLOX_API void CLOX_STDCALL cloxEmitterPatchJump(CloxEmitter_t *const emitter, const size_t offset, const size_t target)
+{
+    assert(emitter != NULL);
+
+    CloxCodeBlock_t *const codeBlock = emitter->codeBlock;
+
+    if ((offset + cloxGetOpKindSize(CLOX_OP_KIND_JUMP)) > codeBlock->count)
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    CLOX_REGISTER const CloxOpCode_t opCode = (CloxOpCode_t)codeBlock->array[offset];
+
+    clox_EmitterCheckKind(opCode, CLOX_OP_KIND_JUMP);
+
+    if (clox_EmitterIsRelativeJump(opCode))
+    {
+        /* relative jumps are relative to the next instruction */
+        CLOX_REGISTER const int64_t distance = (int64_t)target - (int64_t)(offset + cloxGetOpKindSize(CLOX_OP_KIND_JUMP));
+
+        cloxEncodeOpWord(codeBlock->array + offset + 1, (uint32_t)(int32_t)distance);
+    }
+    else
+    {
+        cloxEncodeOpWord(codeBlock->array + offset + 1, (uint32_t)target);
+    }
+
+    cloxCodeBlockInvalidate(codeBlock);
+
+    return;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitConstant(CloxEmitter_t *const emitter, const byte_t z, const CloxValue_t value)
+{
+    assert(emitter != NULL);
+
+    if ((cloxValueType(value) == CLOX_VALUE_TYPE_SINT) && (cloxValueAsSInt(value) >= INT16_MIN) && (cloxValueAsSInt(value) <= INT16_MAX))
+        return cloxEmitData(emitter, CLOX_OP_CODE_LDC, z, (uint16_t)(int16_t)cloxValueAsSInt(value));
+
+    CLOX_REGISTER const size_t index = cloxCodeBlockInternConstant(emitter->codeBlock, value);
+
+    if (index > UINT16_MAX)
+        return cloxEmitLong(emitter, CLOX_OP_CODE_LECW, z, (uint16_t)index, (uint16_t)(index >> 16));
+
+    return cloxEmitData(emitter, CLOX_OP_CODE_LEC, z, (uint16_t)index);
+}
+
+CLOX_API size_t CLOX_STDCALL cloxEmitGlobal(CloxEmitter_t *const emitter, const CloxOpCode_t opCode, const byte_t z, const size_t name)
+{
+    assert(emitter != NULL);
+
+    if ((name > UINT16_MAX) || (emitter->codeBlock->cachesCount > UINT16_MAX))
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    return cloxEmitLong(emitter, opCode, z, (uint16_t)name, (uint16_t)cloxCodeBlockAddCache(emitter->codeBlock));
+}
@@ -0,0 +1,215 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/vm/event_loop.h"
+
+#include <assert.h>
+
+CLOX_STATIC const char clox_EventLoopNoFiberMessage[] = "no fiber of an event loop is running";
+CLOX_STATIC const char clox_EventLoopBadHandleMessage[] = "the handle cannot be waited for";
+
+/**
+ * @brief       This function appends a fiber to the queue of the ready ones.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_EventLoopEnqueue(CloxEventLoop_t *const loop, CloxFiber_t *const fiber)
+{
+    fiber->link = NULL;
+
+    if (loop->tail)
+        loop->tail->link = fiber;
+    else
+        loop->head = fiber;
+
+    loop->tail = fiber;
+    loop->readyCount++;
+
+    return;
+}
+
+/**
+ * @brief       This function removes the first fiber from the queue of the
+ *              ready ones, which must not be empty.
+ */
+CLOX_STATIC CloxFiber_t *CLOX_STDCALL clox_EventLoopDequeue(CloxEventLoop_t *const loop)
+{
+    CloxFiber_t *const fiber = loop->head;
+
+    loop->head = fiber->link;
+
+    if (!loop->head)
+        loop->tail = NULL;
+
+    fiber->link = NULL;
+    loop->readyCount--;
+
+    return fiber;
+}
+
+/**
+ * @brief       This function schedules the fibers whose handles are ready,
+ *              storing the events as the value returned by the native that
+ *              suspended them.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_EventLoopPoll(CloxEventLoop_t *const loop, const int timeout)
+{
+    CloxPollEvent_t events[CLOX_EVENT_LOOP_EVENTS_COUNT];
+    CLOX_REGISTER const size_t count = cloxPollerWait(loop->poller, events, CLOX_EVENT_LOOP_EVENTS_COUNT, timeout);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        CloxFiber_t *const fiber = (CloxFiber_t *)events[i].data;
+
+        fiber->stackTop[-1] = cloxUIntValue(events[i].events);
+        fiber->events = 0;
+
+        loop->waitingCount--;
+        clox_EventLoopEnqueue(loop, fiber);
+    }
+
+    loop->budget = loop->readyCount;
+
+    return;
+}
+
+/**
+ * @brief       This function releases a fiber spawned by an event loop.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_EventLoopRelease(CloxEventLoop_t *const loop, CloxFiber_t *const fiber)
+{
+    if (fiber->events)
+    {
+        cloxPollerRemove(loop->poller, fiber->handle);
+        loop->waitingCount--;
+    }
+
+    free(cloxFreeFiber(fiber));
+
+    return;
+}
+
+CLOX_API CloxEventLoop_t *CLOX_STDCALL cloxInitEventLoop(CloxEventLoop_t *const loop, CloxVM_t *const vm)
+{
+    assert(loop != NULL && vm != NULL);
+
+    if (!(loop->poller = cloxPollerCreate()))
+        return NULL;
+
+    loop->vm           = vm;
+    loop->head         = NULL;
+    loop->tail         = NULL;
+    loop->readyCount   = 0;
+    loop->waitingCount = 0;
+    loop->budget       = 0;
+    loop->stopped      = NULL;
+
+    return loop;
+}
+
+CLOX_API CloxEventLoop_t *CLOX_STDCALL cloxFreeEventLoop(CloxEventLoop_t *const loop)
+{
+    assert(loop != NULL && loop->vm != NULL);
+
+    CloxFiber_t *fiber = loop->vm->fibers;
+
+    while (fiber)
+    {
+        CloxFiber_t *const next = fiber->next;
+
+        if (fiber->loop == loop)
+            clox_EventLoopRelease(loop, fiber);
+
+        fiber = next;
+    }
+
+    cloxPollerDestroy(loop->poller);
+
+    loop->poller       = NULL;
+    loop->head         = NULL;
+    loop->tail         = NULL;
+    loop->readyCount   = 0;
+    loop->waitingCount = 0;
+    loop->budget       = 0;
+    loop->stopped      = NULL;
+
+    return loop;
+}
+
+CLOX_API CloxFiber_t *CLOX_STDCALL cloxEventLoopSpawn(CloxEventLoop_t *const loop, const CloxCodeBlock_t *const codeBlock)
+{
+    assert(loop != NULL && codeBlock != NULL);
+
+    CloxFiber_t *const fiber = cloxInitFiber(alloc(CloxFiber_t), loop->vm, codeBlock, 0);
+
+    fiber->loop = loop;
+    clox_EventLoopEnqueue(loop, fiber);
+
+    return fiber;
+}
+
+CLOX_API const char *CLOX_STDCALL cloxEventLoopWait(CloxVM_t *const vm, const CloxPollHandle_t handle, const uint32_t events)
+{
+    assert(vm != NULL);
+
+    CloxFiber_t *const fiber = vm->fiber;
+
+    if (!fiber || !fiber->loop)
+        return clox_EventLoopNoFiberMessage;
+
+    if (!cloxPollerAdd(fiber->loop->poller, handle, events, fiber))
+        return clox_EventLoopBadHandleMessage;
+
+    fiber->handle = handle;
+    fiber->events = events;
+    fiber->loop->waitingCount++;
+
+    return cloxVMYield(vm);
+}
+
+CLOX_API CloxFiber_t *CLOX_STDCALL cloxEventLoopRun(CloxEventLoop_t *const loop)
+{
+    assert(loop != NULL);
+
+    CloxFiber_t *fiber = loop->stopped;
+
+    if (fiber)
+    {
+        loop->stopped = NULL;
+
+        if ((fiber->status == CLOX_VM_STATUS_BREAK) || (fiber->status == CLOX_VM_STATUS_RAISE))
+            clox_EventLoopEnqueue(loop, fiber);
+        else
+            clox_EventLoopRelease(loop, fiber);
+    }
+
+    for (;;)
+    {
+        /* the handles are checked once per round of the ready fibers, they
+         * are waited for when no fiber is ready */
+        if (loop->waitingCount && (!loop->head || !loop->budget))
+            clox_EventLoopPoll(loop, loop->head ? 0 : -1);
+
+        if (!loop->head)
+        {
+            if (!loop->waitingCount)
+                return NULL;
+
+            continue;
+        }
+
+        if (loop->budget)
+            loop->budget--;
+
+        fiber = clox_EventLoopDequeue(loop);
+
+        if (cloxFiberResume(fiber) != CLOX_VM_STATUS_YIELD)
+            return loop->stopped = fiber;
+
+        /* a fiber waiting for a handle is scheduled by the poller */
+        if (!fiber->events)
+            clox_EventLoopEnqueue(loop, fiber);
+    }
+}
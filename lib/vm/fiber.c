@@ -0,0 +1,183 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/vm/fiber.h"
+
+#include <assert.h>
+
+/**
+ * @brief       This macro exchanges two lvalues of the specified type.
+ */
+#define clox_FiberSwap(T, a, b) \
+    do                          \
+    {                           \
+        T _swap = (a);          \
+        (a) = (b);              \
+        (b) = _swap;            \
+    } while (0)
+
+/**
+ * @brief       This function exchanges the execution context of a fiber with
+ *              the one of its virtual machine, so the same call enters and
+ *              leaves the fiber.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_FiberSwapContext(CloxFiber_t *const fiber)
+{
+    CloxVM_t *const vm = fiber->vm;
+
+    clox_FiberSwap(CloxValue_t *, vm->registers, fiber->registers);
+    clox_FiberSwap(size_t, vm->registersSize, fiber->registersSize);
+    clox_FiberSwap(CloxValue_t *, vm->window, fiber->window);
+    clox_FiberSwap(size_t, vm->windowSize, fiber->windowSize);
+    clox_FiberSwap(CloxVMWindow_t *, vm->windows, fiber->windows);
+    clox_FiberSwap(size_t, vm->windowsCount, fiber->windowsCount);
+    clox_FiberSwap(size_t, vm->windowsCapacity, fiber->windowsCapacity);
+    clox_FiberSwap(CloxVMFrame_t *, vm->frames, fiber->frames);
+    clox_FiberSwap(size_t, vm->framesCount, fiber->framesCount);
+    clox_FiberSwap(size_t, vm->framesCapacity, fiber->framesCapacity);
+    clox_FiberSwap(CloxValue_t *, vm->stack, fiber->stack);
+    clox_FiberSwap(CloxValue_t *, vm->stackTop, fiber->stackTop);
+    clox_FiberSwap(size_t, vm->stackSize, fiber->stackSize);
+    clox_FiberSwap(size_t, vm->stackLimit, fiber->stackLimit);
+    clox_FiberSwap(const CloxCodeBlock_t *, vm->codeBlock, fiber->codeBlock);
+    clox_FiberSwap(const byte_t *, vm->ip, fiber->ip);
+    clox_FiberSwap(byte_t, vm->cf, fiber->cf);
+    clox_FiberSwap(byte_t, vm->zf, fiber->zf);
+    clox_FiberSwap(CloxVMStatus_t, vm->status, fiber->status);
+    clox_FiberSwap(int, vm->exitCode, fiber->exitCode);
+    clox_FiberSwap(int, vm->signal, fiber->signal);
+    clox_FiberSwap(const char *, vm->error, fiber->error);
+    clox_FiberSwap(CloxVMCache_t *, vm->caches, fiber->caches);
+    clox_FiberSwap(size_t, vm->cachesCapacity, fiber->cachesCapacity);
+
+    return;
+}
+
+CLOX_API CloxFiber_t *CLOX_STDCALL cloxInitFiber(CloxFiber_t *const fiber, CloxVM_t *const vm, const CloxCodeBlock_t *const codeBlock, size_t stackLimit)
+{
+    assert(fiber != NULL && vm != NULL && codeBlock != NULL);
+
+    if (!stackLimit)
+        stackLimit = CLOX_VM_STACK_SIZE;
+
+    /* only the outermost window is allocated, calls grow the register file
+     * and the stacks of the windows and of the frames */
+    fiber->registers     = dim(CloxValue_t, CLOX_VM_REGISTERS_COUNT);
+    fiber->registersSize = CLOX_VM_REGISTERS_COUNT;
+
+    for (size_t i = 0; i < fiber->registersSize; i++)
+        fiber->registers[i] = cloxVoidValue();
+
+    fiber->window          = fiber->registers;
+    fiber->windowSize      = CLOX_VM_REGISTERS_COUNT;
+    fiber->windows         = NULL;
+    fiber->windowsCount    = 0;
+    fiber->windowsCapacity = 0;
+    fiber->frames          = NULL;
+    fiber->framesCount     = 0;
+    fiber->framesCapacity  = 0;
+
+    fiber->stackSize  = (stackLimit < CLOX_FIBER_STACK_SIZE) ? stackLimit : CLOX_FIBER_STACK_SIZE;
+    fiber->stackLimit = stackLimit;
+    fiber->stack      = dim(CloxValue_t, fiber->stackSize);
+    fiber->stackTop   = fiber->stack;
+    fiber->codeBlock  = codeBlock;
+    fiber->ip         = NULL;
+    fiber->cf         = 0;
+    fiber->zf         = 0;
+    fiber->status     = CLOX_VM_STATUS_SUCCESS;
+    fiber->exitCode   = 0;
+    fiber->signal     = 0;
+    fiber->error      = NULL;
+
+    fiber->caches         = NULL;
+    fiber->cachesCapacity = 0;
+
+    fiber->vm     = vm;
+    fiber->prev   = NULL;
+    fiber->next   = vm->fibers;
+    fiber->loop   = NULL;
+    fiber->link   = NULL;
+    fiber->handle = 0;
+    fiber->events = 0;
+
+    if (vm->fibers)
+        vm->fibers->prev = fiber;
+
+    vm->fibers = fiber;
+
+    return fiber;
+}
+
+CLOX_API CloxFiber_t *CLOX_STDCALL cloxFreeFiber(CloxFiber_t *const fiber)
+{
+    assert(fiber != NULL && fiber->vm != NULL);
+    assert(fiber->vm->fiber != fiber);
+
+    if (fiber->prev)
+        fiber->prev->next = fiber->next;
+    else
+        fiber->vm->fibers = fiber->next;
+
+    if (fiber->next)
+        fiber->next->prev = fiber->prev;
+
+    if (fiber->stack)
+        dealloc(fiber->stack);
+
+    if (fiber->registers)
+        dealloc(fiber->registers);
+
+    if (fiber->windows)
+        dealloc(fiber->windows);
+
+    if (fiber->frames)
+        dealloc(fiber->frames);
+
+    if (fiber->caches)
+        dealloc(fiber->caches);
+
+    fiber->registersSize   = 0;
+    fiber->window          = NULL;
+    fiber->windowSize      = 0;
+    fiber->windowsCount    = 0;
+    fiber->windowsCapacity = 0;
+    fiber->framesCount     = 0;
+    fiber->framesCapacity  = 0;
+    fiber->stackTop        = NULL;
+    fiber->stackSize       = 0;
+    fiber->stackLimit      = 0;
+    fiber->cachesCapacity  = 0;
+    fiber->codeBlock       = NULL;
+    fiber->ip              = NULL;
+    fiber->vm              = NULL;
+    fiber->prev            = NULL;
+    fiber->next            = NULL;
+
+    return fiber;
+}
+
+CLOX_API CloxVMStatus_t CLOX_STDCALL cloxFiberResume(CloxFiber_t *const fiber)
+{
+    assert(fiber != NULL && fiber->vm != NULL);
+    assert(fiber->vm->fiber == NULL);
+
+    CloxVM_t *const vm = fiber->vm;
+    CLOX_REGISTER const bool_t started = (bool_t)(fiber->ip != NULL);
+    const CloxCodeBlock_t *const codeBlock = fiber->codeBlock;
+    CloxVMStatus_t status;
+
+    clox_FiberSwapContext(fiber);
+    vm->fiber = fiber;
+
+    status = started ? cloxVMResume(vm) : cloxVMRun(vm, codeBlock);
+
+    vm->fiber = NULL;
+    clox_FiberSwapContext(fiber);
+
+    return status;
+}
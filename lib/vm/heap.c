@@ -0,0 +1,474 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/clock.h"
+#include "clox/base/errno.h"
+#include "clox/base/utils.h"
+#include "clox/vm/heap.h"
+
+#include <string.h>
+
+#ifndef clox_HeapClassSize
+/* the number of bytes of the blocks of a size class (from zero) */
+#   define clox_HeapClassSize(sizeClass) (((size_t)(sizeClass) + 1) * (size_t)CLOX_HEAP_GRANULE)
+#endif
+
+#ifndef clox_HeapOtherWhite
+#   define clox_HeapOtherWhite(heap) ((byte_t)((heap)->white ^ (CLOX_OBJECT_COLOR_WHITE0 | CLOX_OBJECT_COLOR_WHITE1)))
+#endif
+
+/**
+ * @brief       This function gets the number of bytes accounted for an object,
+ *              the whole block of its size class for the small ones.
+ */
+CLOX_INLINE size_t CLOX_STDCALL clox_HeapObjectSize(const CloxObject_t *const object)
+{
+    if (object->sizeClass)
+        return clox_HeapClassSize(object->sizeClass - 1);
+
+    return CLOX_OBJECT_HEADER_SIZE + (size_t)object->count * ((object->kind != CLOX_OBJECT_KIND_BYTES) ? sizeof(CloxValue_t) : 1);
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_HeapPushGray(CloxHeap_t *const heap, CloxObject_t *const object)
+{
+    if (heap->grayCount >= heap->grayCapacity)
+    {
+        heap->grayCapacity = heap->grayCapacity ? heap->grayCapacity * 2 : CLOX_HEAP_GRAY_CAPACITY;
+        heap->gray         = redim(CloxObject_t *, heap->gray, heap->grayCapacity);
+    }
+
+    object->color = CLOX_OBJECT_COLOR_GRAY;
+    heap->gray[heap->grayCount++] = object;
+
+    return;
+}
+
+/**
+ * @brief       This function marks the objects referenced by a gray object,
+ *              then paints it black.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_HeapTrace(CloxHeap_t *const heap, CloxObject_t *const object)
+{
+    object->color = CLOX_OBJECT_COLOR_BLACK;
+
+    if (object->kind == CLOX_OBJECT_KIND_BYTES)
+        return;
+
+    const CloxValue_t *const values = cloxObjectValues(object);
+
+    for (size_t i = 0; i < object->count; i++)
+        cloxHeapMarkValue(heap, &values[i]);
+
+    return;
+}
+
+CLOX_INLINE void CLOX_STDCALL clox_HeapRelease(CloxHeap_t *const heap, CloxObject_t *const object)
+{
+    CLOX_REGISTER const size_t size = clox_HeapObjectSize(object);
+
+    heap->allocated -= size;
+
+    if (object->sizeClass)
+    {
+        cloxMemoryDischarge(heap->memory, CLOX_MEMORY_KIND_HEAP, size);
+
+        object->next = heap->freeLists[object->sizeClass - 1];
+        heap->freeLists[object->sizeClass - 1] = object;
+    }
+    else
+    {
+        cloxMemoryFree(heap->memory, CLOX_MEMORY_KIND_HEAP, object, size);
+    }
+
+    heap->objectsCount--;
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_HeapStartCycle(CloxHeap_t *const heap)
+{
+    heap->phase = CLOX_HEAP_PHASE_MARK;
+    heap->debt  = 0;
+
+    if (heap->roots)
+        heap->roots(heap, heap->rootsData);
+
+    return;
+}
+
+/**
+ * @brief       This function ends the marking: the roots are scanned again,
+ *              since they are written without barrier, and the gray stack is
+ *              drained, then the whites swap so that the old one marks the
+ *              garbage.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_HeapFinishMark(CloxHeap_t *const heap)
+{
+    if (heap->roots)
+        heap->roots(heap, heap->rootsData);
+
+    while (heap->grayCount)
+        clox_HeapTrace(heap, heap->gray[--heap->grayCount]);
+
+    heap->white = clox_HeapOtherWhite(heap);
+    heap->phase = CLOX_HEAP_PHASE_SWEEP;
+    heap->sweep = &heap->objects;
+
+    return;
+}
+
+CLOX_STATIC void CLOX_STDCALL clox_HeapFinishSweep(CloxHeap_t *const heap)
+{
+    CLOX_REGISTER const size_t threshold = (heap->allocated / 100) * heap->growthFactor;
+
+    heap->phase     = CLOX_HEAP_PHASE_IDLE;
+    heap->sweep     = NULL;
+    heap->threshold = max(threshold, (size_t)CLOX_HEAP_THRESHOLD);
+    heap->cyclesCount++;
+
+    return;
+}
+
+/**
+ * @brief       This function does up to the specified number of units of work
+ *              (an object traced or swept).
+ *
+ * @return      TRUE if the collection has been completed.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_HeapWork(CloxHeap_t *const heap, size_t units)
+{
+    if (heap->phase == CLOX_HEAP_PHASE_MARK)
+    {
+        for (; units && heap->grayCount; units--)
+            clox_HeapTrace(heap, heap->gray[--heap->grayCount]);
+
+        if (heap->grayCount)
+            return FALSE;
+
+        clox_HeapFinishMark(heap);
+    }
+
+    if (heap->phase == CLOX_HEAP_PHASE_SWEEP)
+    {
+        CLOX_REGISTER const byte_t dead = clox_HeapOtherWhite(heap);
+
+        for (; units && *heap->sweep; units--)
+        {
+            CloxObject_t *const object = *heap->sweep;
+
+            if (object->color == dead)
+            {
+                *heap->sweep = object->next;
+                clox_HeapRelease(heap, object);
+            }
+            else
+            {
+                object->color = heap->white;
+                heap->sweep   = &object->next;
+            }
+        }
+
+        if (*heap->sweep)
+            return FALSE;
+
+        clox_HeapFinishSweep(heap);
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * @brief       This function takes a block for an object from its size class,
+ *              or from the memory of the heap for the big ones.
+ *
+ * @return      A pointer to the block, or NULL if the memory limit is reached.
+ */
+CLOX_STATIC CloxObject_t *CLOX_STDCALL clox_HeapTake(CloxHeap_t *const heap, const size_t size)
+{
+    CloxObject_t *object;
+
+    if (size <= clox_HeapClassSize(CLOX_HEAP_SIZE_CLASSES - 1))
+    {
+        CLOX_REGISTER const size_t sizeClass = (size - 1) / CLOX_HEAP_GRANULE;
+
+        /* the blocks carved from the arena are accounted one by one */
+        if (!cloxMemoryCharge(heap->memory, CLOX_MEMORY_KIND_HEAP, clox_HeapClassSize(sizeClass)))
+            return NULL;
+
+        if ((object = heap->freeLists[sizeClass]))
+            heap->freeLists[sizeClass] = object->next;
+        else
+            object = (CloxObject_t *)cloxArenaAlloc(&heap->arena, clox_HeapClassSize(sizeClass));
+
+        object->sizeClass = (byte_t)(sizeClass + 1);
+        heap->allocated  += clox_HeapClassSize(sizeClass);
+    }
+    else
+    {
+        if (!(object = (CloxObject_t *)cloxMemoryTryAlloc(heap->memory, CLOX_MEMORY_KIND_HEAP, size)))
+            return NULL;
+
+        object->sizeClass = 0;
+        heap->allocated  += size;
+    }
+
+    return object;
+}
+
+CLOX_STATIC CloxObject_t *CLOX_STDCALL clox_HeapAllocate(CloxHeap_t *const heap, const CloxObjectKind_t kind, const size_t count, const size_t payloadSize)
+{
+    CLOX_REGISTER const size_t size = CLOX_OBJECT_HEADER_SIZE + payloadSize;
+    CloxObject_t *object;
+
+    if (count > UINT32_MAX)
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    /* the allocator pays for the collection with steps proportional to the
+     * bytes it allocates */
+    heap->debt += size;
+
+    if (heap->phase == CLOX_HEAP_PHASE_IDLE ? (heap->allocated >= heap->threshold) : (heap->debt >= CLOX_HEAP_STEP_SIZE))
+        cloxHeapStep(heap);
+
+    /* at the limit, the garbage might leave enough room */
+    if (!(object = clox_HeapTake(heap, size)))
+    {
+        cloxHeapCollect(heap);
+
+        if (!(object = clox_HeapTake(heap, size)))
+            return NULL;
+    }
+
+    object->count = (uint32_t)count;
+    object->kind  = (byte_t)kind;
+    object->flags = 0;
+
+    /* objects created while marking are reachable (new ones are held by the
+     * mutator), so they are black: nothing they'll reference gets lost since
+     * writes go through the barrier */
+    object->color = (heap->phase == CLOX_HEAP_PHASE_MARK) ? (byte_t)CLOX_OBJECT_COLOR_BLACK : heap->white;
+
+    object->next  = heap->objects;
+    heap->objects = object;
+    heap->objectsCount++;
+
+    return object;
+}
+
+CLOX_API CloxHeap_t *CLOX_STDCALL cloxInitHeap(CloxHeap_t *const heap, const CloxHeapRootsFunc_t roots, void *const rootsData)
+{
+    assert(heap != NULL);
+
+    cloxInitArena(&heap->arena, 0);
+
+    heap->memory = cloxGetMemory();
+
+    memset(heap->freeLists, 0, sizeof(heap->freeLists));
+
+    heap->objects      = NULL;
+    heap->objectsCount = 0;
+    heap->sweep        = NULL;
+    heap->gray         = NULL;
+    heap->grayCount    = 0;
+    heap->grayCapacity = 0;
+    heap->phase        = CLOX_HEAP_PHASE_IDLE;
+    heap->white        = CLOX_OBJECT_COLOR_WHITE0;
+    heap->allocated    = 0;
+    heap->threshold    = CLOX_HEAP_THRESHOLD;
+    heap->debt         = 0;
+    heap->growthFactor = CLOX_HEAP_GROWTH_FACTOR;
+    heap->maxPause     = CLOX_HEAP_MAX_PAUSE;
+    heap->roots        = roots;
+    heap->rootsData    = rootsData;
+    heap->cyclesCount  = 0;
+    heap->stepsCount   = 0;
+    heap->longestStep  = 0;
+
+    return heap;
+}
+
+CLOX_API CloxHeap_t *CLOX_STDCALL cloxFreeHeap(CloxHeap_t *const heap)
+{
+    assert(heap != NULL);
+
+    /* small objects are released together with the arena */
+    for (CloxObject_t *object = heap->objects, *next; object; object = next)
+    {
+        next = object->next;
+
+        if (object->sizeClass)
+            cloxMemoryDischarge(heap->memory, CLOX_MEMORY_KIND_HEAP, clox_HeapObjectSize(object));
+        else
+            cloxMemoryFree(heap->memory, CLOX_MEMORY_KIND_HEAP, object, clox_HeapObjectSize(object));
+    }
+
+    if (heap->gray)
+        dealloc(heap->gray);
+
+    cloxFreeArena(&heap->arena);
+
+    memset(heap->freeLists, 0, sizeof(heap->freeLists));
+
+    heap->objects      = NULL;
+    heap->objectsCount = 0;
+    heap->sweep        = NULL;
+    heap->grayCount    = 0;
+    heap->grayCapacity = 0;
+    heap->phase        = CLOX_HEAP_PHASE_IDLE;
+    heap->allocated    = 0;
+    heap->debt         = 0;
+
+    return heap;
+}
+
+CLOX_API CloxHeap_t *CLOX_STDCALL cloxCreateHeap(const CloxHeapRootsFunc_t roots, void *const rootsData)
+{
+    return cloxInitHeap(alloc(CloxHeap_t), roots, rootsData);
+}
+
+CLOX_API CloxObject_t *CLOX_STDCALL cloxHeapNewArray(CloxHeap_t *const heap, const size_t count)
+{
+    assert(heap != NULL);
+
+    if (count > ((SIZE_MAX - CLOX_OBJECT_HEADER_SIZE) / sizeof(CloxValue_t)))
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    CloxObject_t *const object = clox_HeapAllocate(heap, CLOX_OBJECT_KIND_ARRAY, count, count * sizeof(CloxValue_t));
+
+    if (!object)
+        return NULL;
+
+    CloxValue_t *const values = cloxObjectValues(object);
+
+    for (size_t i = 0; i < count; i++)
+        values[i] = cloxVoidValue();
+
+    return object;
+}
+
+CLOX_API CloxObject_t *CLOX_STDCALL cloxHeapNewBytes(CloxHeap_t *const heap, const size_t size)
+{
+    assert(heap != NULL);
+
+    if (size > (SIZE_MAX - CLOX_OBJECT_HEADER_SIZE))
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    CloxObject_t *const object = clox_HeapAllocate(heap, CLOX_OBJECT_KIND_BYTES, size, size);
+
+    if (!object)
+        return NULL;
+
+    memset(cloxObjectBytes(object), 0, size);
+
+    return object;
+}
+
+CLOX_API void CLOX_STDCALL cloxHeapSet(CloxHeap_t *const heap, CloxObject_t *const object, const size_t index, const CloxValue_t value)
+{
+    assert(heap != NULL && object != NULL && object->kind != CLOX_OBJECT_KIND_BYTES);
+
+    if (index >= object->count)
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    cloxObjectValues(object)[index] = value;
+
+    if (cloxValueType(value) == CLOX_VALUE_TYPE_OBJT)
+        cloxHeapBarrier(heap, object);
+
+    return;
+}
+
+CLOX_API void CLOX_STDCALL cloxHeapBarrier(CloxHeap_t *const heap, CloxObject_t *const object)
+{
+    assert(heap != NULL && object != NULL);
+
+    /* the barrier is backward: the written object is traced again (once, for
+     * any number of writes), instead of marking each stored reference */
+    if ((heap->phase == CLOX_HEAP_PHASE_MARK) && (object->color == CLOX_OBJECT_COLOR_BLACK))
+        clox_HeapPushGray(heap, object);
+
+    return;
+}
+
+CLOX_API void CLOX_STDCALL cloxHeapMarkObject(CloxHeap_t *const heap, CloxObject_t *const object)
+{
+    assert(heap != NULL);
+
+    if (object && (heap->phase == CLOX_HEAP_PHASE_MARK) && (object->color == heap->white))
+        clox_HeapPushGray(heap, object);
+
+    return;
+}
+
+CLOX_API void CLOX_STDCALL cloxHeapMarkValue(CloxHeap_t *const heap, const CloxValue_t *const value)
+{
+    assert(heap != NULL && value != NULL);
+
+    if (cloxValueType(*value) == CLOX_VALUE_TYPE_OBJT)
+        cloxHeapMarkObject(heap, cloxValueAsObject(*value));
+
+    return;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxHeapStep(CloxHeap_t *const heap)
+{
+    assert(heap != NULL);
+
+    if (heap->phase == CLOX_HEAP_PHASE_IDLE)
+    {
+        if (heap->allocated < heap->threshold)
+            return FALSE;
+
+        clox_HeapStartCycle(heap);
+    }
+
+    CLOX_REGISTER const uint64_t start = cloxClockNow();
+    CLOX_REGISTER const uint64_t budget = (uint64_t)heap->maxPause * 1000;
+    CLOX_REGISTER uint64_t elapsed;
+    bool_t completed;
+
+    /* the clock is read once every few units, so that it doesn't cost more
+     * than the work it bounds */
+    do
+    {
+        completed = clox_HeapWork(heap, CLOX_HEAP_STEP_UNITS);
+        elapsed   = cloxClockNow() - start;
+    } while (!completed && (elapsed < budget));
+
+    heap->debt = 0;
+    heap->stepsCount++;
+
+    if (elapsed > heap->longestStep)
+        heap->longestStep = elapsed;
+
+    return completed;
+}
+
+CLOX_API void CLOX_STDCALL cloxHeapCollect(CloxHeap_t *const heap)
+{
+    assert(heap != NULL);
+
+    /* a running collection can't release the garbage made after its start */
+    while ((heap->phase != CLOX_HEAP_PHASE_IDLE) && !clox_HeapWork(heap, SIZE_MAX))
+        continue;
+
+    clox_HeapStartCycle(heap);
+
+    while (!clox_HeapWork(heap, SIZE_MAX))
+        continue;
+
+    return;
+}
+
+CLOX_API void CLOX_STDCALL cloxDeleteHeap(CloxHeap_t *const heap)
+{
+    free(cloxFreeHeap(heap));
+
+    return;
+}
@@ -0,0 +1,334 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/utils.h"
+#include "clox/vm/image.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if CLOX_PLATFORM_IS_WINDOWS
+#   include <windows.h>
+#   include <sys/stat.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#ifndef CLOX_IMAGE_TEMPORARY_EXTENSION
+#   define CLOX_IMAGE_TEMPORARY_EXTENSION ".tmp"
+#endif
+
+#ifndef clox_ImageAlign
+#   define clox_ImageAlign(offset) alignto((uint64_t)(offset), (uint64_t)CLOX_IMAGE_ALIGNMENT)
+#endif
+
+/**
+ * @brief       This function checks that a section lies entirely into the
+ *              image, without overflowing.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_ImageHasSection(const CloxImageHeader_t *const header, const uint64_t offset, const uint64_t count, const uint64_t size)
+{
+    if ((offset < sizeof(CloxImageHeader_t)) || (offset % CLOX_IMAGE_ALIGNMENT) || (offset > header->size))
+        return FALSE;
+
+    if (size && (count > (UINT64_MAX / size)))
+        return FALSE;
+
+    return (bool_t)((count * size) <= (header->size - offset));
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_ImageIsValid(const byte_t *const data, const size_t size)
+{
+    const CloxImageHeader_t *const header = (const CloxImageHeader_t *)data;
+
+    if (size < sizeof(CloxImageHeader_t))
+        return FALSE;
+
+    if ((header->magic != CLOX_MAGIC_NUMBER) || (header->version != CLOX_IMAGE_VERSION) || (header->valueSize != sizeof(CloxValue_t)))
+        return FALSE;
+
+    if (header->size != (uint64_t)size)
+        return FALSE;
+
+    /* the instructions address the cache slots with 16 bits */
+    if (header->cachesCount > ((uint64_t)UINT16_MAX + 1))
+        return FALSE;
+
+    if (!(clox_ImageHasSection(header, header->codeOffset, header->codeCount, 1)
+          && clox_ImageHasSection(header, header->constantsOffset, header->constantsCount, sizeof(CloxValue_t))
+          && clox_ImageHasSection(header, header->namesOffset, header->namesCount, 1)
+          && (!header->namesCount || (data[header->namesOffset + header->namesCount - 1] == '\0'))
+          && clox_ImageHasSection(header, header->linesOffset, header->linesCount, 1)
+          && clox_ImageHasSection(header, header->linesIndexOffset, header->linesIndexCount, sizeof(CloxLineCheckpoint_t))
+          && clox_ImageHasSection(header, header->symbolsOffset, header->symbolsCount, sizeof(CloxCodeSymbol_t))))
+        return FALSE;
+
+    /* the symbols are looked up by a binary search and their names read as
+     * they are, so they must be sorted and in bounds */
+    const CloxCodeSymbol_t *const symbols = (const CloxCodeSymbol_t *)(data + header->symbolsOffset);
+
+    for (uint64_t i = 0; i < header->symbolsCount; i++)
+    {
+        if ((symbols[i].offset >= symbols[i].end) || (symbols[i].end > header->codeCount) || (symbols[i].name >= header->namesCount))
+            return FALSE;
+
+        if (i && (symbols[i - 1].end > symbols[i].offset))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_ImageWritePadding(FILE *const stream, uint64_t position, const uint64_t offset)
+{
+    CLOX_STATIC const byte_t padding[CLOX_IMAGE_ALIGNMENT] = { 0 };
+
+    return (bool_t)(fwrite(padding, 1, (size_t)(offset - position), stream) == (size_t)(offset - position));
+}
+
+/**
+ * @brief       This function writes the items of a section, the buffer of an
+ *              empty section may be NULL so nothing is written.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_ImageWriteSection(FILE *const stream, const void *const items, const size_t size, const size_t count)
+{
+    return (bool_t)(!count || (fwrite(items, size, count, stream) == count));
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxGetImageStamp(const char *const path, CloxImageStamp_t *const outStamp)
+{
+    assert(path != NULL && outStamp != NULL);
+
+#if CLOX_PLATFORM_IS_WINDOWS
+    struct _stat64 info;
+
+    if (_stat64(path, &info))
+        return FALSE;
+
+    outStamp->time = (int64_t)info.st_mtime * 1000000000;
+#else
+    struct stat info;
+
+    if (stat(path, &info))
+        return FALSE;
+
+#   if CLOX_PLATFORM_IS_MACOS
+    outStamp->time = (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#   else
+    outStamp->time = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#   endif
+#endif
+
+    outStamp->size = (uint64_t)info.st_size;
+
+    return TRUE;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxWriteImage(const char *const path, const CloxCodeBlock_t *const codeBlock, const CloxImageStamp_t *const stamp)
+{
+    assert(path != NULL && codeBlock != NULL);
+
+    CloxImageHeader_t header;
+
+    /* pointers are meaningful only in the process that created them */
+    for (size_t i = 0; i < codeBlock->constantsCount; i++)
+        if (hasflag(cloxValueType(codeBlock->constants[i]), CLOX_VALUE_FLAG_POINTER))
+            return FALSE;
+
+    memset(&header, 0, sizeof(header));
+
+    header.magic            = CLOX_MAGIC_NUMBER;
+    header.version          = CLOX_IMAGE_VERSION;
+    header.valueSize        = (uint16_t)sizeof(CloxValue_t);
+    header.codeOffset       = clox_ImageAlign(sizeof(CloxImageHeader_t));
+    header.codeCount        = (uint64_t)codeBlock->count;
+    header.constantsOffset  = clox_ImageAlign(header.codeOffset + header.codeCount);
+    header.constantsCount   = (uint64_t)codeBlock->constantsCount;
+    header.namesOffset      = clox_ImageAlign(header.constantsOffset + header.constantsCount * sizeof(CloxValue_t));
+    header.namesCount       = (uint64_t)codeBlock->namesSize;
+    header.cachesCount      = (uint64_t)codeBlock->cachesCount;
+    header.linesOffset      = clox_ImageAlign(header.namesOffset + header.namesCount);
+    header.linesCount       = (uint64_t)codeBlock->lines.runsSize;
+    header.linesIndexOffset = clox_ImageAlign(header.linesOffset + header.linesCount);
+    header.linesIndexCount  = (uint64_t)codeBlock->lines.checkpointsCount;
+    header.symbolsOffset    = clox_ImageAlign(header.linesIndexOffset + header.linesIndexCount * sizeof(CloxLineCheckpoint_t));
+    header.symbolsCount     = (uint64_t)codeBlock->symbolsCount;
+    header.size             = header.symbolsOffset + header.symbolsCount * sizeof(CloxCodeSymbol_t);
+
+    if (stamp)
+        header.stamp = *stamp;
+
+    const size_t pathLength = strlen(path);
+    char *temporaryPath = dim(char, pathLength + sizeof(CLOX_IMAGE_TEMPORARY_EXTENSION));
+
+    memcpy(temporaryPath, path, pathLength);
+    memcpy(temporaryPath + pathLength, CLOX_IMAGE_TEMPORARY_EXTENSION, sizeof(CLOX_IMAGE_TEMPORARY_EXTENSION));
+
+    FILE *const stream = fopen(temporaryPath, "wb");
+    bool_t result = FALSE;
+
+    if (stream)
+    {
+        result = (bool_t)((fwrite(&header, sizeof(header), 1, stream) == 1)
+            && clox_ImageWritePadding(stream, sizeof(header), header.codeOffset)
+            && clox_ImageWriteSection(stream, codeBlock->array, 1, codeBlock->count)
+            && clox_ImageWritePadding(stream, header.codeOffset + header.codeCount, header.constantsOffset)
+            && clox_ImageWriteSection(stream, codeBlock->constants, sizeof(CloxValue_t), codeBlock->constantsCount)
+            && clox_ImageWritePadding(stream, header.constantsOffset + header.constantsCount * sizeof(CloxValue_t), header.namesOffset)
+            && clox_ImageWriteSection(stream, codeBlock->names, 1, codeBlock->namesSize)
+            && clox_ImageWritePadding(stream, header.namesOffset + header.namesCount, header.linesOffset)
+            && clox_ImageWriteSection(stream, codeBlock->lines.runs, 1, codeBlock->lines.runsSize)
+            && clox_ImageWritePadding(stream, header.linesOffset + header.linesCount, header.linesIndexOffset)
+            && clox_ImageWriteSection(stream, codeBlock->lines.checkpoints, sizeof(CloxLineCheckpoint_t), codeBlock->lines.checkpointsCount)
+            && clox_ImageWritePadding(stream, header.linesIndexOffset + header.linesIndexCount * sizeof(CloxLineCheckpoint_t), header.symbolsOffset)
+            && clox_ImageWriteSection(stream, codeBlock->symbols, sizeof(CloxCodeSymbol_t), codeBlock->symbolsCount));
+
+        result = (bool_t)(!fclose(stream) && result);
+
+#if CLOX_PLATFORM_IS_WINDOWS
+        result = (bool_t)(result && MoveFileExA(temporaryPath, path, MOVEFILE_REPLACE_EXISTING));
+#else
+        result = (bool_t)(result && !rename(temporaryPath, path));
+#endif
+
+        if (!result)
+            remove(temporaryPath);
+    }
+
+    dealloc(temporaryPath);
+
+    return result;
+}
+
+CLOX_API CloxImage_t *CLOX_STDCALL cloxCreateImageFromFile(const char *const path)
+{
+    assert(path != NULL);
+
+    void *view, *mapping = NULL;
+    size_t size;
+
+#if CLOX_PLATFORM_IS_WINDOWS
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER fileSize;
+
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (!GetFileSizeEx(file, &fileSize) || !fileSize.QuadPart || !(mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL)))
+        return CloseHandle(file), NULL;
+
+    CloseHandle(file);
+
+    if (!(view = MapViewOfFile((HANDLE)mapping, FILE_MAP_READ, 0, 0, 0)))
+        return CloseHandle((HANDLE)mapping), NULL;
+
+    size = (size_t)fileSize.QuadPart;
+#else
+    int file = open(path, O_RDONLY);
+    struct stat info;
+
+    if (file < 0)
+        return NULL;
+
+    if (fstat(file, &info) || (info.st_size <= 0))
+        return close(file), NULL;
+
+    size = (size_t)info.st_size;
+    view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    close(file);
+
+    if (view == MAP_FAILED)
+        return NULL;
+#endif
+
+    if (!clox_ImageIsValid((const byte_t *)view, size))
+    {
+#if CLOX_PLATFORM_IS_WINDOWS
+        UnmapViewOfFile((LPCVOID)view), CloseHandle((HANDLE)mapping);
+#else
+        munmap(view, size);
+#endif
+
+        return NULL;
+    }
+
+    CloxImage_t *const image = alloc(CloxImage_t);
+    const CloxImageHeader_t *const header = (const CloxImageHeader_t *)view;
+
+    image->data    = (const byte_t *)view;
+    image->size    = size;
+    image->mapping = mapping;
+    image->header  = header;
+
+    /* the view is never written: the VM takes code blocks as constant */
+    image->codeBlock.array                  = (byte_t *)image->data + header->codeOffset;
+    image->codeBlock.count                  = (size_t)header->codeCount;
+    image->codeBlock.capacity               = (size_t)header->codeCount;
+    image->codeBlock.constants              = (CloxValue_t *)(image->data + header->constantsOffset);
+    image->codeBlock.constantsCount         = (size_t)header->constantsCount;
+    image->codeBlock.constantsCapacity      = (size_t)header->constantsCount;
+    image->codeBlock.constantsIndex         = NULL;
+    image->codeBlock.constantsIndexCapacity = 0;
+    image->codeBlock.constantsIndexCount    = 0;
+    image->codeBlock.names                  = (char *)(image->data + header->namesOffset);
+    image->codeBlock.namesSize              = (size_t)header->namesCount;
+    image->codeBlock.namesCapacity          = (size_t)header->namesCount;
+    image->codeBlock.cachesCount            = (size_t)header->cachesCount;
+    image->codeBlock.symbols                = (CloxCodeSymbol_t *)(image->data + header->symbolsOffset);
+    image->codeBlock.symbolsCount           = (size_t)header->symbolsCount;
+    image->codeBlock.symbolsCapacity        = (size_t)header->symbolsCount;
+    image->codeBlock.arena                  = NULL;
+    image->codeBlock.memory                 = cloxGetMemory();
+    image->codeBlock.frozen                 = FALSE;
+
+    /* only lookups are done on the line table, they need its encoded runs
+     * and its checkpoints */
+    memset(&image->codeBlock.lines, 0, sizeof(image->codeBlock.lines));
+
+    image->codeBlock.lines.runs             = (byte_t *)image->data + header->linesOffset;
+    image->codeBlock.lines.runsSize         = (size_t)header->linesCount;
+    image->codeBlock.lines.checkpoints      = (CloxLineCheckpoint_t *)(image->data + header->linesIndexOffset);
+    image->codeBlock.lines.checkpointsCount = (size_t)header->linesIndexCount;
+
+    /* the decoded form is built on demand, see cloxCodeBlockDecode, and
+     * so is the proof of the verifier */
+    memset(&image->codeBlock.decoded, 0, sizeof(image->codeBlock.decoded));
+
+    image->codeBlock.depths = NULL;
+
+    return image;
+}
+
+CLOX_API CloxCodeBlockReader_t *CLOX_STDCALL cloxInitImageReader(const CloxImage_t *const image, CloxCodeBlockReader_t *const codeBlockReader)
+{
+    assert(image != NULL);
+
+    return cloxInitCodeBlockReaderFromBuffer(codeBlockReader, image->codeBlock.array, image->codeBlock.count);
+}
+
+CLOX_API void CLOX_STDCALL cloxDeleteImage(CloxImage_t *const image)
+{
+    assert(image != NULL);
+
+    image->codeBlock.frozen = FALSE;
+
+    cloxCodeBlockInvalidate(&image->codeBlock);
+
+#if CLOX_PLATFORM_IS_WINDOWS
+    UnmapViewOfFile((LPCVOID)image->data), CloseHandle((HANDLE)image->mapping);
+#else
+    munmap((void *)image->data, image->size);
+#endif
+
+    free(image);
+
+    return;
+}
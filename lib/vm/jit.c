@@ -0,0 +1,893 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/bool.h"
+#include "clox/vm/jit.h"
+
+#include <assert.h>
+#include <string.h>
+
+#if CLOX_VM_JIT
+#   include <sys/mman.h>
+#   include <unistd.h>
+#endif
+
+#if CLOX_VM_JIT
+#   if CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_AMD64
+/*
+ * The region saves rbx and keeps the state there, each stencil is:
+ *
+ *     mov    rdi, rbx
+ *     movabs rsi, operands
+ *     movabs rax, function
+ *     call   rax
+ *     test   eax, eax
+ *     jnz    bail                  ; operations
+ *
+ *     jz     next                  ; branches
+ *     cmp    eax, 1
+ *     je     target
+ *     jmp    bail
+ *
+ * and the exits (and bail stubs) are mov eax, record; pop rbx; ret.
+ *
+ * A region with inline stencils also saves r12 to r15 and keeps the frame at
+ * the beginning of the state there (r12 the limit, r13 the top, r14 the
+ * window, r15 the bottom): the top is stored before each call and loaded
+ * after it, and stored by the exits. The inline stencils check the bounds of
+ * the stack into rcx and copy the values eight bytes at a time through rax:
+ *
+ *     mov    rcx, r12
+ *     sub    rcx, r13
+ *     cmp    rcx, size
+ *     jb     bail
+ *     mov    rax, [r14 + source]   ; for each word
+ *     mov    [r13], rax
+ *     add    r13, size
+ *
+ * The guarded ones compare the headers of their values with rax, and jump to
+ * a slow stub after the code (the call of their function, then a jump to the
+ * next stencil) when they differ. The integers are computed into rcx, the
+ * reals on the x87 unit, and the flags into al:
+ *
+ *     movabs rax, header
+ *     cmp    [r14 + source], rax   ; for each value
+ *     jne    slow
+ *     mov    rcx, [r14 + source + payload]
+ *     add    rcx, [r14 + other + payload]
+ *     movabs rax, word             ; for each other word of data
+ *     mov    [r14 + destination], rax
+ *     mov    [r14 + destination + payload], rcx
+ *
+ * and load the context into rdx to store the flag, or to poll its words.
+ */
+#       define CLOX_JIT_PROLOGUE_SIZE(frame) ((frame) ? 28 : 4)
+#       define CLOX_JIT_CALL_SIZE(frame)     ((frame) ? 35 : 27)
+#       define CLOX_JIT_OP_SIZE(frame)       (CLOX_JIT_CALL_SIZE(frame) + 6)
+#       define CLOX_JIT_BRANCH_SIZE(frame)   (CLOX_JIT_CALL_SIZE(frame) + 16)
+#       define CLOX_JIT_JUMP_SIZE            5
+#       define CLOX_JIT_EXIT_SIZE(frame)     ((frame) ? 19 : 7)
+#       define CLOX_JIT_CHECK_SIZE           19
+#       define CLOX_JIT_COPY_SIZE            14
+#       define CLOX_JIT_LOAD_SIZE            17
+#       define CLOX_JIT_ADJUST_SIZE          7
+#       define CLOX_JIT_GUARD_SIZE(values)   (10 + (13 * (values)))
+#       define CLOX_JIT_ACCESS_SIZE          7
+#       define CLOX_JIT_STORE_SIZE           10
+#       define CLOX_JIT_CONDITION_SIZE       8
+#       define CLOX_JIT_POLL_SIZE            36
+#       define CLOX_JIT_INLINE               1
+#   else
+/*
+ * The region saves x19 (and the frame record) and keeps the state there,
+ * each stencil is:
+ *
+ *     mov  x0, x19
+ *     movz x1, operands            ; then three movk
+ *     movz x16, function           ; then three movk
+ *     blr  x16
+ *     cbnz w0, bail                ; operations
+ *
+ *     cbz  w0, next                ; branches
+ *     cmp  w0, #1
+ *     b.eq target
+ *     b    bail
+ *
+ * and the exits (and bail stubs) load the record into w0, restore x19 and the
+ * frame record, then return. The inline stencils are called like operations.
+ */
+#       define CLOX_JIT_PROLOGUE_SIZE(frame) 16
+#       define CLOX_JIT_CALL_SIZE(frame)     40
+#       define CLOX_JIT_OP_SIZE(frame)       (CLOX_JIT_CALL_SIZE(frame) + 4)
+#       define CLOX_JIT_BRANCH_SIZE(frame)   (CLOX_JIT_CALL_SIZE(frame) + 16)
+#       define CLOX_JIT_JUMP_SIZE            4
+#       define CLOX_JIT_EXIT_SIZE(frame)     20
+#       define CLOX_JIT_INLINE               0
+#   endif
+
+/* the inline stencils are emitted when the target supports it, otherwise
+ * their function is called like an operation (or a branch) */
+CLOX_INLINE bool_t CLOX_STDCALL clox_JitInline(const CloxJitStencil_t *const stencil)
+{
+    return CLOX_JIT_INLINE && (stencil->kind >= CLOX_JIT_STENCIL_MOVE) && stencil->size && !(stencil->size & 7);
+}
+
+/* the kind of the call of a stencil that is not inline, and of the slow stub
+ * of a guarded one */
+CLOX_INLINE CloxJitStencilKind_t CLOX_STDCALL clox_JitCallKind(const CloxJitStencil_t *const stencil)
+{
+    switch (stencil->kind)
+    {
+    case CLOX_JIT_STENCIL_COMPARE:
+        return stencil->condition ? CLOX_JIT_STENCIL_BRANCH : CLOX_JIT_STENCIL_OP;
+
+    case CLOX_JIT_STENCIL_FLAG:
+    case CLOX_JIT_STENCIL_POLL:
+        return CLOX_JIT_STENCIL_BRANCH;
+
+    default:
+        return (stencil->kind >= CLOX_JIT_STENCIL_MOVE) ? CLOX_JIT_STENCIL_OP : stencil->kind;
+    }
+}
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_JitBranches(const CloxJitStencil_t *const stencil)
+{
+    return (stencil->kind == CLOX_JIT_STENCIL_JUMP) || (clox_JitCallKind(stencil) == CLOX_JIT_STENCIL_BRANCH);
+}
+
+/* the inline stencils that call their function when a guard fails */
+CLOX_INLINE bool_t CLOX_STDCALL clox_JitGuarded(const CloxJitStencil_t *const stencil)
+{
+    return clox_JitInline(stencil) && (stencil->kind >= CLOX_JIT_STENCIL_ARITHMETIC) && (stencil->kind != CLOX_JIT_STENCIL_FLAG);
+}
+
+/* the offsets of an inline stencil fit 31 bits, and its fields are in range */
+CLOX_STATIC bool_t CLOX_STDCALL clox_JitValid(const CloxJitStencil_t *const stencil)
+{
+    CLOX_REGISTER const uint32_t limit = (uint32_t)INT32_MAX - stencil->size;
+    CLOX_REGISTER const uint32_t bytes = (stencil->operation & CLOX_JIT_OPERATION_REAL) ? 10 : 8;
+
+    /* the payload follows the header, within the value */
+    const bool_t guard = (bool_t)(stencil->data && stencil->function && (stencil->payload >= 8) && !(stencil->payload & 7) && ((stencil->payload + bytes) <= stencil->size));
+
+    if ((stencil->source > limit) || (stencil->destination > limit) || (stencil->other > limit) || (stencil->pop > limit))
+        return FALSE;
+
+    switch (stencil->kind)
+    {
+    case CLOX_JIT_STENCIL_LOAD:
+        return (bool_t)(stencil->data != NULL);
+
+    case CLOX_JIT_STENCIL_ARITHMETIC:
+        return (bool_t)(guard && ((stencil->operation & 3) != 3) && (stencil->operation <= CLOX_JIT_OPERATION_REAL_MUL));
+
+    case CLOX_JIT_STENCIL_COMPARE:
+        return (bool_t)(guard && !(stencil->operation & ~CLOX_JIT_OPERATION_REAL) && (stencil->condition <= CLOX_JIT_CONDITION_LESS_EQUAL));
+
+    case CLOX_JIT_STENCIL_TEST:
+        return guard;
+
+    case CLOX_JIT_STENCIL_FLAG:
+        return (bool_t)(stencil->condition && (stencil->condition <= CLOX_JIT_CONDITION_LESS_EQUAL));
+
+    case CLOX_JIT_STENCIL_POLL:
+        return (bool_t)(stencil->function != NULL);
+
+    default:
+        return TRUE;
+    }
+}
+
+CLOX_INLINE size_t CLOX_STDCALL clox_JitStencilSize(const CloxJitStencil_t *const stencil, const bool_t frame)
+{
+#   if CLOX_JIT_INLINE
+    CLOX_REGISTER const size_t words = stencil->size / 8;
+    CLOX_REGISTER const bool_t real  = (bool_t)((stencil->operation & CLOX_JIT_OPERATION_REAL) != 0);
+
+    /* the guarded stencils on the stack check its depth, and pop it */
+    CLOX_REGISTER const size_t stack = stencil->pop ? (CLOX_JIT_CHECK_SIZE + CLOX_JIT_ADJUST_SIZE) : 0;
+
+    if (clox_JitInline(stencil))
+    {
+        switch (stencil->kind)
+        {
+        case CLOX_JIT_STENCIL_MOVE:
+            return CLOX_JIT_COPY_SIZE * words;
+
+        case CLOX_JIT_STENCIL_PICK:
+            return CLOX_JIT_CHECK_SIZE + (CLOX_JIT_COPY_SIZE * words);
+
+        case CLOX_JIT_STENCIL_LOAD:
+            return CLOX_JIT_LOAD_SIZE * words;
+
+        /* the operation, then the other words of data and the result */
+        case CLOX_JIT_STENCIL_ARITHMETIC:
+            return stack + CLOX_JIT_GUARD_SIZE(2) + (CLOX_JIT_ACCESS_SIZE * 3) + (real ? 2 : (stencil->operation == CLOX_JIT_OPERATION_MUL)) + (CLOX_JIT_LOAD_SIZE * (words - 1));
+
+        /* the compare, then the flag in al */
+        case CLOX_JIT_STENCIL_COMPARE:
+            return stack + CLOX_JIT_GUARD_SIZE(2) + (CLOX_JIT_ACCESS_SIZE * 2) + (real ? 21 : 10) + CLOX_JIT_STORE_SIZE + (stencil->condition ? CLOX_JIT_CONDITION_SIZE : 0);
+
+        /* cmp byte [payload], 0; sete al */
+        case CLOX_JIT_STENCIL_TEST:
+            return stack + CLOX_JIT_GUARD_SIZE(1) + 11 + CLOX_JIT_STORE_SIZE;
+
+        case CLOX_JIT_STENCIL_FLAG:
+            return CLOX_JIT_STORE_SIZE + CLOX_JIT_CONDITION_SIZE;
+
+        case CLOX_JIT_STENCIL_POLL:
+            return CLOX_JIT_POLL_SIZE;
+
+        default:
+            return CLOX_JIT_CHECK_SIZE + (CLOX_JIT_COPY_SIZE * words) + CLOX_JIT_ADJUST_SIZE;
+        }
+    }
+#   endif
+
+    switch (clox_JitCallKind(stencil))
+    {
+    case CLOX_JIT_STENCIL_BRANCH:
+        return CLOX_JIT_BRANCH_SIZE(frame);
+
+    case CLOX_JIT_STENCIL_JUMP:
+        return CLOX_JIT_JUMP_SIZE;
+
+    case CLOX_JIT_STENCIL_EXIT:
+        return CLOX_JIT_EXIT_SIZE(frame);
+
+    default:
+        return CLOX_JIT_OP_SIZE(frame);
+    }
+}
+
+#   if CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_AMD64
+CLOX_INLINE byte_t *CLOX_STDCALL clox_JitBytes(byte_t *const code, const void *const bytes, const size_t size)
+{
+    memcpy(code, bytes, size);
+
+    return code + size;
+}
+
+CLOX_INLINE byte_t *CLOX_STDCALL clox_JitRelative(byte_t *code, const byte_t *const target)
+{
+    const int32_t displacement = (int32_t)(target - (code + 4));
+
+    return clox_JitBytes(code, &displacement, 4);
+}
+
+/* mov (0x8B loads, 0x89 stores) between r12 to r15 (4 to 7) and [rbx + offset] */
+CLOX_INLINE byte_t *CLOX_STDCALL clox_JitFrame(byte_t *const code, const byte_t operation, const byte_t reg, const size_t offset)
+{
+    const byte_t bytes[4] = { 0x4C, operation, (byte_t)(0x43 | (reg << 3)), (byte_t)offset };
+
+    return clox_JitBytes(code, bytes, 4);
+}
+
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitPrologue(byte_t *code, const bool_t frame)
+{
+    if (!frame)
+        return clox_JitBytes(code, "\x53\x48\x89\xFB", 4);
+
+    code = clox_JitBytes(code, "\x53\x41\x54\x41\x55\x41\x56\x41\x57\x48\x89\xFB", 12);
+    code = clox_JitFrame(code, 0x8B, 5, offsetof(CloxJitFrame_t, top));
+    code = clox_JitFrame(code, 0x8B, 6, offsetof(CloxJitFrame_t, window));
+    code = clox_JitFrame(code, 0x8B, 7, offsetof(CloxJitFrame_t, bottom));
+
+    return clox_JitFrame(code, 0x8B, 4, offsetof(CloxJitFrame_t, limit));
+}
+
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitCall(byte_t *code, const CloxJitStencil_t *const stencil, const bool_t frame)
+{
+    const uint64_t function = (uint64_t)(uintptr_t)stencil->function;
+
+    if (frame)
+        code = clox_JitFrame(code, 0x89, 5, offsetof(CloxJitFrame_t, top));
+
+    code = clox_JitBytes(code, "\x48\x89\xDF\x48\xBE", 5);
+    code = clox_JitBytes(code, &stencil->operands, 8);
+    code = clox_JitBytes(code, "\x48\xB8", 2);
+    code = clox_JitBytes(code, &function, 8);
+    code = clox_JitBytes(code, "\xFF\xD0", 2);
+
+    if (frame)
+        code = clox_JitFrame(code, 0x8B, 5, offsetof(CloxJitFrame_t, top));
+
+    return clox_JitBytes(code, "\x85\xC0", 2);
+}
+
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitExit(byte_t *code, const uint32_t record, const bool_t frame)
+{
+    if (frame)
+        code = clox_JitFrame(code, 0x89, 5, offsetof(CloxJitFrame_t, top));
+
+    code = clox_JitBytes(code, "\xB8", 1);
+    code = clox_JitBytes(code, &record, 4);
+
+    if (frame)
+        code = clox_JitBytes(code, "\x41\x5F\x41\x5E\x41\x5D\x41\x5C", 8);
+
+    return clox_JitBytes(code, "\x5B\xC3", 2);
+}
+
+/* mov rax, [from + source]; mov [to + destination], rax for each word, where
+ * r13 and r14 are the registers 5 and 6 */
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitCopy(byte_t *code, const byte_t from, const int32_t source, const byte_t to, const int32_t destination, const uint32_t size)
+{
+    CLOX_REGISTER uint32_t i;
+
+    for (i = 0; i < size; i += 8)
+    {
+        const byte_t load[3]  = { 0x49, 0x8B, (byte_t)(0x80 | from) };
+        const byte_t store[3] = { 0x49, 0x89, (byte_t)(0x80 | to) };
+
+        const int32_t loadDisplacement  = source + (int32_t)i;
+        const int32_t storeDisplacement = destination + (int32_t)i;
+
+        code = clox_JitBytes(code, load, 3);
+        code = clox_JitBytes(code, &loadDisplacement, 4);
+        code = clox_JitBytes(code, store, 3);
+        code = clox_JitBytes(code, &storeDisplacement, 4);
+    }
+
+    return code;
+}
+
+/* rcx gets the free bytes of the stack for a push, the used ones otherwise */
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitCheck(byte_t *code, const CloxJitStencilKind_t kind, const uint32_t count, const byte_t *const bail)
+{
+    if (kind == CLOX_JIT_STENCIL_PUSH)
+        code = clox_JitBytes(code, "\x4C\x89\xE1\x4C\x29\xE9", 6);
+    else
+        code = clox_JitBytes(code, "\x4C\x89\xE9\x4C\x29\xF9", 6);
+
+    code = clox_JitBytes(code, "\x48\x81\xF9", 3);
+    code = clox_JitBytes(code, &count, 4);
+    code = clox_JitBytes(code, "\x0F\x82", 2);
+
+    return clox_JitRelative(code, bail);
+}
+
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitTransfer(byte_t *code, const CloxJitStencil_t *const stencil, const byte_t *const bail)
+{
+    const int32_t source      = (int32_t)stencil->source;
+    const int32_t destination = (int32_t)stencil->destination;
+
+    CLOX_REGISTER uint32_t i;
+
+    switch (stencil->kind)
+    {
+    case CLOX_JIT_STENCIL_MOVE:
+        return clox_JitCopy(code, 6, source, 6, destination, stencil->size);
+
+    case CLOX_JIT_STENCIL_PUSH:
+        code = clox_JitCheck(code, stencil->kind, stencil->size, bail);
+        code = clox_JitCopy(code, 6, source, 5, 0, stencil->size);
+        code = clox_JitBytes(code, "\x49\x81\xC5", 3);
+
+        return clox_JitBytes(code, &stencil->size, 4);
+
+    case CLOX_JIT_STENCIL_POP:
+        code = clox_JitCheck(code, stencil->kind, stencil->size, bail);
+        code = clox_JitCopy(code, 5, -(int32_t)stencil->size, 6, destination, stencil->size);
+        code = clox_JitBytes(code, "\x49\x81\xED", 3);
+
+        return clox_JitBytes(code, &stencil->size, 4);
+
+    case CLOX_JIT_STENCIL_PICK:
+        code = clox_JitCheck(code, stencil->kind, (uint32_t)source, bail);
+
+        return clox_JitCopy(code, 5, -source, 6, destination, stencil->size);
+
+    default:
+        /* the words of the value become the immediates of movabs rax */
+        for (i = 0; i < stencil->size; i += 8)
+        {
+            const int32_t displacement = destination + (int32_t)i;
+
+            code = clox_JitBytes(code, "\x48\xB8", 2);
+            code = clox_JitBytes(code, (const byte_t *)stencil->data + i, 8);
+            code = clox_JitBytes(code, "\x49\x89\x86", 3);
+            code = clox_JitBytes(code, &displacement, 4);
+        }
+
+        return code;
+    }
+}
+
+/* an instruction addressing [r13 or r14 + displacement] (the registers 5 and
+ * 6), the ModRM of reg follows its opcode */
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitAccess(byte_t *code, const char *const opcode, const size_t length, const byte_t reg, const byte_t base, const int32_t displacement)
+{
+    const byte_t modrm = (byte_t)(0x80 | (reg << 3) | base);
+
+    code = clox_JitBytes(code, opcode, length);
+    code = clox_JitBytes(code, &modrm, 1);
+
+    return clox_JitBytes(code, &displacement, 4);
+}
+
+/* mov rdx, [rbx + context] */
+CLOX_INLINE byte_t *CLOX_STDCALL clox_JitContext(byte_t *const code)
+{
+    const byte_t bytes[4] = { 0x48, 0x8B, 0x53, (byte_t)offsetof(CloxJitFrame_t, context) };
+
+    return clox_JitBytes(code, bytes, 4);
+}
+
+/* mov between al and [rdx + offset] (0x88 stores and 0x8A loads), after the
+ * context */
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitFlag(byte_t *code, const byte_t operation, const uint32_t offset)
+{
+    const byte_t bytes[2] = { operation, 0x82 };
+
+    code = clox_JitContext(code);
+    code = clox_JitBytes(code, bytes, 2);
+
+    return clox_JitBytes(code, &offset, 4);
+}
+
+/* the test of al (test al, al or cmp al, imm or test al, imm), then the
+ * second byte of the conditional jump */
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitCondition(byte_t *code, const CloxJitCondition_t condition, const byte_t *const target)
+{
+    static const byte_t conditions[][3] = {
+        { 0x84, 0xC0, 0x84 }, /* ZERO: je */
+        { 0x84, 0xC0, 0x85 }, /* NONZERO: jne */
+        { 0x3C, 0x02, 0x84 }, /* GREATER: je */
+        { 0xA8, 0x01, 0x84 }, /* GREATER_EQUAL: je */
+        { 0x3C, 0x01, 0x84 }, /* LESS: je */
+        { 0x3C, 0x02, 0x82 }, /* LESS_EQUAL: jb */
+    };
+
+    code = clox_JitBytes(code, conditions[condition - 1], 2);
+    code = clox_JitBytes(code, "\x0F", 1);
+    code = clox_JitBytes(code, &conditions[condition - 1][2], 1);
+
+    return clox_JitRelative(code, target);
+}
+
+/* rax gets the header of data, and the one of each value is compared with it */
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitGuard(byte_t *code, const CloxJitStencil_t *const stencil, const byte_t base, const int32_t *const values, const size_t count, const byte_t *const slow)
+{
+    CLOX_REGISTER size_t i;
+
+    code = clox_JitBytes(code, "\x48\xB8", 2);
+    code = clox_JitBytes(code, stencil->data, 8);
+
+    for (i = 0; i < count; i++)
+    {
+        code = clox_JitAccess(code, "\x49\x39", 2, 0, base, values[i]);
+        code = clox_JitBytes(code, "\x0F\x85", 2);
+        code = clox_JitRelative(code, slow);
+    }
+
+    return code;
+}
+
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitOperate(byte_t *code, const CloxJitStencil_t *const stencil, const byte_t *const target, const byte_t *const slow)
+{
+    /* add, sub and imul of rcx, then faddp, fsubp and fmulp of st(1) */
+    static const char *const integers[] = { "\x49\x03", "\x49\x2B", "\x49\x0F\xAF" };
+    static const char *const reals[]    = { "\xDE\xC1", "\xDE\xE9", "\xDE\xC9" };
+
+    /* the values are addressed from the window, or below the top when the
+     * stencil pops them */
+    const byte_t  base  = stencil->pop ? 5 : 6;
+    const int32_t sign  = stencil->pop ? -1 : 1;
+    const int32_t x     = sign * (int32_t)stencil->source;
+    const int32_t y     = sign * (int32_t)stencil->other;
+    const int32_t z     = sign * (int32_t)stencil->destination;
+    const int32_t at    = (int32_t)stencil->payload;
+    const bool_t  real  = (bool_t)((stencil->operation & CLOX_JIT_OPERATION_REAL) != 0);
+    const size_t  index = (size_t)(stencil->operation & 3);
+
+    const int32_t values[2] = { x, y };
+
+    CLOX_REGISTER uint32_t i;
+
+    switch (stencil->kind)
+    {
+    case CLOX_JIT_STENCIL_FLAG:
+        code = clox_JitFlag(code, 0x8A, stencil->source);
+
+        return clox_JitCondition(code, stencil->condition, target);
+
+    case CLOX_JIT_STENCIL_POLL:
+        /* cmp dword [rdx + source], 0; cmp qword [rdx + destination], 0 */
+        code = clox_JitContext(code);
+        code = clox_JitBytes(code, "\x83\xBA", 2);
+        code = clox_JitBytes(code, &stencil->source, 4);
+        code = clox_JitBytes(code, "\x00\x0F\x85", 3);
+        code = clox_JitRelative(code, slow);
+        code = clox_JitBytes(code, "\x48\x83\xBA", 3);
+        code = clox_JitBytes(code, &stencil->destination, 4);
+        code = clox_JitBytes(code, "\x00\x0F\x85", 3);
+        code = clox_JitRelative(code, slow);
+        code = clox_JitBytes(code, "\xE9", 1);
+
+        return clox_JitRelative(code, target);
+
+    default:
+        break;
+    }
+
+    if (stencil->pop)
+        code = clox_JitCheck(code, CLOX_JIT_STENCIL_POP, (stencil->source > stencil->other) ? stencil->source : stencil->other, slow);
+
+    code = clox_JitGuard(code, stencil, base, values, (stencil->kind == CLOX_JIT_STENCIL_TEST) ? 1 : 2, slow);
+
+    switch (stencil->kind)
+    {
+    case CLOX_JIT_STENCIL_ARITHMETIC:
+        if (real)
+        {
+            code = clox_JitAccess(code, "\x41\xDB", 2, 5, base, x + at);
+            code = clox_JitAccess(code, "\x41\xDB", 2, 5, base, y + at);
+            code = clox_JitBytes(code, reals[index], 2);
+        }
+        else
+        {
+            code = clox_JitAccess(code, "\x49\x8B", 2, 1, base, x + at);
+            code = clox_JitAccess(code, integers[index], (stencil->operation == CLOX_JIT_OPERATION_MUL) ? 3 : 2, 1, base, y + at);
+        }
+
+        /* the result may overwrite a value, so it is stored last */
+        for (i = 0; i < stencil->size; i += 8)
+        {
+            if (i == stencil->payload)
+                continue;
+
+            code = clox_JitBytes(code, "\x48\xB8", 2);
+            code = clox_JitBytes(code, (const byte_t *)stencil->data + i, 8);
+            code = clox_JitAccess(code, "\x49\x89", 2, 0, base, z + (int32_t)i);
+        }
+
+        if (real)
+            code = clox_JitAccess(code, "\x41\xDB", 2, 7, base, z + at);
+        else
+            code = clox_JitAccess(code, "\x49\x89", 2, 1, base, z + at);
+
+        break;
+
+    case CLOX_JIT_STENCIL_COMPARE:
+        if (real)
+        {
+            /* fucomip of x with y, then al = below | above << 1 | parity * 3 */
+            code = clox_JitAccess(code, "\x41\xDB", 2, 5, base, y + at);
+            code = clox_JitAccess(code, "\x41\xDB", 2, 5, base, x + at);
+            code = clox_JitBytes(code, "\xDF\xE9\xDD\xD8", 4);
+            code = clox_JitBytes(code, "\x0F\x97\xC1\x0F\x92\xC0\x0F\x9A\xC2\x00\xC9\x08\xC8\x00\xD2\x08\xD0", 17);
+        }
+        else
+        {
+            /* cmp of x with y, then al = less | greater << 1 */
+            code = clox_JitAccess(code, "\x49\x8B", 2, 1, base, x + at);
+            code = clox_JitAccess(code, "\x49\x3B", 2, 1, base, y + at);
+            code = clox_JitBytes(code, "\x0F\x9C\xC0\x0F\x9F\xC1\x00\xC9\x08\xC8", 10);
+        }
+
+        code = clox_JitFlag(code, 0x88, stencil->destination);
+        break;
+
+    default:
+        /* cmp byte [payload], 0; sete al */
+        code = clox_JitAccess(code, "\x41\x80", 2, 7, base, x + at);
+        code = clox_JitBytes(code, "\x00\x0F\x94\xC0", 4);
+        code = clox_JitFlag(code, 0x88, stencil->destination);
+        break;
+    }
+
+    if (stencil->pop)
+    {
+        code = clox_JitBytes(code, "\x49\x81\xED", 3);
+        code = clox_JitBytes(code, &stencil->pop, 4);
+    }
+
+    if ((stencil->kind == CLOX_JIT_STENCIL_COMPARE) && stencil->condition)
+        code = clox_JitCondition(code, stencil->condition, target);
+
+    return code;
+}
+#   else
+CLOX_INLINE byte_t *CLOX_STDCALL clox_JitInstruction(byte_t *const code, const uint32_t instruction)
+{
+    memcpy(code, &instruction, 4);
+
+    return code + 4;
+}
+
+/* the displacement (in instructions) of a branch, masked to the given bits */
+CLOX_INLINE uint32_t CLOX_STDCALL clox_JitRelative(const byte_t *const code, const byte_t *const target, const uint32_t bits)
+{
+    return (uint32_t)((int32_t)(target - code) / 4) & ((UINT32_C(1) << bits) - 1);
+}
+
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitMove(byte_t *code, const uint32_t reg, const uint64_t value)
+{
+    CLOX_REGISTER uint32_t hw;
+
+    code = clox_JitInstruction(code, UINT32_C(0xD2800000) | ((uint32_t)(value & 0xFFFF) << 5) | reg);
+
+    for (hw = 1; hw < 4; hw++)
+        code = clox_JitInstruction(code, UINT32_C(0xF2800000) | (hw << 21) | ((uint32_t)((value >> (hw * 16)) & 0xFFFF) << 5) | reg);
+
+    return code;
+}
+
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitPrologue(byte_t *code, const bool_t frame)
+{
+    (void)frame;
+
+    code = clox_JitInstruction(code, UINT32_C(0xA9BE7BFD));
+    code = clox_JitInstruction(code, UINT32_C(0x910003FD));
+    code = clox_JitInstruction(code, UINT32_C(0xF9000BF3));
+
+    return clox_JitInstruction(code, UINT32_C(0xAA0003F3));
+}
+
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitCall(byte_t *code, const CloxJitStencil_t *const stencil, const bool_t frame)
+{
+    (void)frame;
+
+    code = clox_JitInstruction(code, UINT32_C(0xAA1303E0));
+    code = clox_JitMove(code, 1, stencil->operands);
+    code = clox_JitMove(code, 16, (uint64_t)(uintptr_t)stencil->function);
+
+    return clox_JitInstruction(code, UINT32_C(0xD63F0200));
+}
+
+CLOX_STATIC byte_t *CLOX_STDCALL clox_JitExit(byte_t *code, const uint32_t record, const bool_t frame)
+{
+    (void)frame;
+
+    code = clox_JitInstruction(code, UINT32_C(0x52800000) | ((record & 0xFFFF) << 5));
+    code = clox_JitInstruction(code, UINT32_C(0x72A00000) | ((record >> 16) << 5));
+    code = clox_JitInstruction(code, UINT32_C(0xF9400BF3));
+    code = clox_JitInstruction(code, UINT32_C(0xA8C27BFD));
+
+    return clox_JitInstruction(code, UINT32_C(0xD65F03C0));
+}
+#   endif
+#endif
+
+CLOX_API CloxJitCode_t *CLOX_STDCALL cloxJitAssemble(const CloxJitStencil_t *const stencils, const size_t count)
+{
+#if CLOX_VM_JIT
+    CLOX_REGISTER size_t i, size;
+
+    CloxJitCode_t *code;
+    size_t *offsets, *bails, *slows;
+    byte_t *memory, *p;
+    bool_t frame = FALSE;
+
+    if (!stencils || !count || ((stencils[count - 1].kind != CLOX_JIT_STENCIL_JUMP) && (stencils[count - 1].kind != CLOX_JIT_STENCIL_EXIT)))
+        return NULL;
+
+    for (i = 0; i < count; i++)
+    {
+        const CloxJitStencil_t *const stencil = &stencils[i];
+
+        if (stencil->kind > CLOX_JIT_STENCIL_POLL)
+            return NULL;
+
+        if (clox_JitBranches(stencil) && (stencil->target >= count))
+            return NULL;
+
+        if (stencil->kind < CLOX_JIT_STENCIL_MOVE)
+            continue;
+
+        if (!clox_JitInline(stencil))
+        {
+            if (!stencil->function)
+                return NULL;
+        }
+        else if (!clox_JitValid(stencil))
+        {
+            return NULL;
+        }
+        else
+        {
+            /* the state begins with a frame, kept in registers */
+            frame = TRUE;
+        }
+    }
+
+    /* the stencils come first, then a bail stub for each call (and inline
+     * stencil), then a slow stub for each guarded stencil */
+    offsets = dim(size_t, count);
+    bails   = dim(size_t, count);
+    slows   = dim(size_t, count);
+
+    for (i = 0, size = CLOX_JIT_PROLOGUE_SIZE(frame); i < count; i++)
+    {
+        offsets[i] = size;
+        size += clox_JitStencilSize(&stencils[i], frame);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if ((stencils[i].kind != CLOX_JIT_STENCIL_JUMP) && (stencils[i].kind != CLOX_JIT_STENCIL_EXIT))
+        {
+            bails[i] = size;
+            size += CLOX_JIT_EXIT_SIZE(frame);
+        }
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        slows[i] = size;
+
+        if (clox_JitGuarded(&stencils[i]))
+            size += ((clox_JitCallKind(&stencils[i]) == CLOX_JIT_STENCIL_BRANCH) ? CLOX_JIT_BRANCH_SIZE(frame) : CLOX_JIT_OP_SIZE(frame)) + CLOX_JIT_JUMP_SIZE;
+    }
+
+    /* the branches of AArch64 reach one megabyte */
+    if (size >= (1 << 20))
+    {
+        free(offsets);
+        free(bails);
+        free(slows);
+
+        return NULL;
+    }
+
+    size = (size + (size_t)sysconf(_SC_PAGESIZE) - 1) & ~((size_t)sysconf(_SC_PAGESIZE) - 1);
+    memory = (byte_t *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (memory == (byte_t *)MAP_FAILED)
+    {
+        free(offsets);
+        free(bails);
+        free(slows);
+
+        return NULL;
+    }
+
+    p = clox_JitPrologue(memory, frame);
+
+    for (i = 0; i < count; i++)
+    {
+        const CloxJitStencil_t *const stencil = &stencils[i];
+
+        const byte_t *const bail   = memory + bails[i];
+        const byte_t *const target = memory + offsets[stencil->target < count ? stencil->target : 0];
+
+#   if CLOX_JIT_INLINE
+        if (clox_JitInline(stencil))
+        {
+            if (stencil->kind >= CLOX_JIT_STENCIL_ARITHMETIC)
+                p = clox_JitOperate(p, stencil, target, memory + slows[i]);
+            else
+                p = clox_JitTransfer(p, stencil, bail);
+
+            assert(p == (memory + offsets[i] + clox_JitStencilSize(stencil, frame)));
+            continue;
+        }
+#   endif
+
+        switch (clox_JitCallKind(stencil))
+        {
+#   if CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_AMD64
+        case CLOX_JIT_STENCIL_OP:
+            p = clox_JitCall(p, stencil, frame);
+            p = clox_JitBytes(p, "\x0F\x85", 2);
+            p = clox_JitRelative(p, bail);
+            break;
+
+        case CLOX_JIT_STENCIL_BRANCH:
+            p = clox_JitCall(p, stencil, frame);
+            p = clox_JitBytes(p, "\x74\x0E\x83\xF8\x01\x0F\x84", 7);
+            p = clox_JitRelative(p, target);
+            p = clox_JitBytes(p, "\xE9", 1);
+            p = clox_JitRelative(p, bail);
+            break;
+
+        case CLOX_JIT_STENCIL_JUMP:
+            p = clox_JitBytes(p, "\xE9", 1);
+            p = clox_JitRelative(p, target);
+            break;
+#   else
+        case CLOX_JIT_STENCIL_OP:
+            p = clox_JitCall(p, stencil, frame);
+            p = clox_JitInstruction(p, UINT32_C(0x35000000) | (clox_JitRelative(p, bail, 19) << 5));
+            break;
+
+        case CLOX_JIT_STENCIL_BRANCH:
+            p = clox_JitCall(p, stencil, frame);
+            p = clox_JitInstruction(p, UINT32_C(0x34000000) | (4 << 5));
+            p = clox_JitInstruction(p, UINT32_C(0x7100041F));
+            p = clox_JitInstruction(p, UINT32_C(0x54000000) | (clox_JitRelative(p, target, 19) << 5));
+            p = clox_JitInstruction(p, UINT32_C(0x14000000) | clox_JitRelative(p, bail, 26));
+            break;
+
+        case CLOX_JIT_STENCIL_JUMP:
+            p = clox_JitInstruction(p, UINT32_C(0x14000000) | clox_JitRelative(p, target, 26));
+            break;
+#   endif
+
+        default:
+            p = clox_JitExit(p, stencil->record, frame);
+            break;
+        }
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if ((stencils[i].kind != CLOX_JIT_STENCIL_JUMP) && (stencils[i].kind != CLOX_JIT_STENCIL_EXIT))
+            p = clox_JitExit(p, stencils[i].record, frame);
+    }
+
+#   if CLOX_JIT_INLINE
+    /* the slow stubs call the function, then go on with the next stencil (a
+     * guarded stencil is never the last one) */
+    for (i = 0; i < count; i++)
+    {
+        const CloxJitStencil_t *const stencil = &stencils[i];
+
+        if (!clox_JitGuarded(stencil))
+            continue;
+
+        p = clox_JitCall(p, stencil, frame);
+
+        if (clox_JitCallKind(stencil) == CLOX_JIT_STENCIL_BRANCH)
+        {
+            p = clox_JitBytes(p, "\x74\x0E\x83\xF8\x01\x0F\x84", 7);
+            p = clox_JitRelative(p, memory + offsets[stencil->target]);
+            p = clox_JitBytes(p, "\xE9", 1);
+            p = clox_JitRelative(p, memory + bails[i]);
+        }
+        else
+        {
+            p = clox_JitBytes(p, "\x0F\x85", 2);
+            p = clox_JitRelative(p, memory + bails[i]);
+        }
+
+        p = clox_JitBytes(p, "\xE9", 1);
+        p = clox_JitRelative(p, memory + offsets[i + 1]);
+    }
+#   endif
+
+    free(offsets);
+    free(bails);
+    free(slows);
+
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC))
+    {
+        munmap(memory, size);
+        return NULL;
+    }
+
+    __builtin___clear_cache((char *)memory, (char *)p);
+
+    code = alloc(CloxJitCode_t);
+
+    code->memory = memory;
+    code->size   = size;
+    code->entry  = (CloxJitEntry_t)(uintptr_t)memory;
+
+    return code;
+#else
+    (void)stencils;
+    (void)count;
+
+    return NULL;
+#endif
+}
+
+CLOX_API void CLOX_STDCALL cloxJitRelease(CloxJitCode_t *const code)
+{
+    if (!code)
+        return;
+
+#if CLOX_VM_JIT
+    munmap(code->memory, code->size);
+#endif
+
+    free(code);
+
+    return;
+}
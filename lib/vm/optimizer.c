@@ -0,0 +1,529 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/utils.h"
+#include "clox/vm/optimizer.h"
+#include "clox/vm/vm.h"
+
+#include <string.h>
+
+/**
+ * @brief       This data structure provides an instruction of the block being
+ *              optimized. The optimizer doesn't move the instructions, so their
+ *              offsets stay valid: the removed ones are overwritten by 'nop'
+ *              instructions, which the peephole pass drops.
+ */
+typedef struct _CloxOptimizerInstruction
+{
+    /**
+     * @brief   The offset of the instruction.
+     */
+    size_t offset;
+    /**
+     * @brief   The index of the target instruction of a jump or a branch (the
+     *          index of the end of the block is the number of instructions), or
+     *          SIZE_MAX for other instructions.
+     */
+    size_t target;
+    /**
+     * @brief   The index of the previous instruction not removed, or SIZE_MAX
+     *          if there is none.
+     */
+    size_t previous;
+    /**
+     * @brief   The index of the next instruction not removed, or the number of
+     *          instructions if there is none.
+     */
+    size_t next;
+    /**
+     * @brief   The size (in bytes) of the instruction.
+     */
+    byte_t size;
+    /**
+     * @brief   TRUE if the instruction is the target of a jump or a branch.
+     */
+    bool_t isTarget;
+    /**
+     * @brief   TRUE if the instruction has been removed.
+     */
+    bool_t removed;
+    /**
+     * @brief   TRUE if the instruction can be reached from the beginning of the
+     *          block.
+     */
+    bool_t isReached;
+} CloxOptimizerInstruction_t;
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_OptimizerIsFlagJump(const byte_t opCode)
+{
+    return ((opCode >= CLOX_OP_CODE_JEQ) && (opCode <= CLOX_OP_CODE_JLE))
+        || ((opCode >= CLOX_OP_CODE_BEQ) && (opCode <= CLOX_OP_CODE_BLE));
+}
+
+/**
+ * @brief       This function tells whether the instruction after one with the
+ *              specified opcode can be executed.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_OptimizerFallsThrough(const byte_t opCode)
+{
+    switch (opCode)
+    {
+    case CLOX_OP_CODE_ABORT:
+    case CLOX_OP_CODE_EXIT:
+    case CLOX_OP_CODE_TCALL:
+    case CLOX_OP_CODE_RET:
+    case CLOX_OP_CODE_JMP:
+    case CLOX_OP_CODE_BR:
+        return FALSE;
+
+    default:
+        return TRUE;
+    }
+}
+
+/**
+ * @brief       This function gets the offset targeted by a jump or a branch.
+ *
+ * @return      TRUE if the instruction is a jump or a branch, otherwise FALSE.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_OptimizerGetTarget(const byte_t *const bytes, const size_t offset, const size_t size, int64_t *const outTarget)
+{
+    CLOX_REGISTER const byte_t opCode = bytes[0];
+
+    if ((opCode == CLOX_OP_CODE_CALL) || (opCode == CLOX_OP_CODE_TCALL)
+     || ((opCode >= CLOX_OP_CODE_JMP) && (opCode <= CLOX_OP_CODE_JLE))
+     || ((opCode >= CLOX_OP_CODE_CJEQ) && (opCode <= CLOX_OP_CODE_CJLE)))
+        *outTarget = (int64_t)(offset + size) + (int32_t)cloxDecodeOpWord(bytes + 1);
+    else if ((opCode >= CLOX_OP_CODE_BR) && (opCode <= CLOX_OP_CODE_BLE))
+        *outTarget = (int64_t)cloxDecodeOpWord(bytes + 1);
+    else if ((opCode >= CLOX_OP_CODE_RJEQ) && (opCode <= CLOX_OP_CODE_RJLE))
+        *outTarget = (int64_t)(offset + size) + (int16_t)cloxDecodeOpHalf(bytes + 1);
+    else
+        return FALSE;
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function tells whether a jump on the specified flags is
+ *              taken ('cmp' sets the comparison flag, 'tst' the zero flag).
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_OptimizerIsTaken(const byte_t opCode, const byte_t cf, const bool_t zf)
+{
+    switch ((opCode >= CLOX_OP_CODE_BEQ) ? opCode - CLOX_OP_CODE_BEQ + CLOX_OP_CODE_JEQ : opCode)
+    {
+    case CLOX_OP_CODE_JIT:
+        return (bool_t)!zf;
+
+    case CLOX_OP_CODE_JNT:
+        return zf;
+
+    case CLOX_OP_CODE_JEQ:
+        return (bool_t)(cf == 0);
+
+    case CLOX_OP_CODE_JNE:
+        return (bool_t)(cf != 0);
+
+    case CLOX_OP_CODE_JGT:
+        return (bool_t)(cf == 2);
+
+    case CLOX_OP_CODE_JGE:
+        return (bool_t)!(cf & 1);
+
+    case CLOX_OP_CODE_JLT:
+        return (bool_t)(cf == 1);
+
+    default:
+        return (bool_t)(cf < 2);
+    }
+}
+
+/**
+ * @brief       This function gets the index of the instruction before the
+ *              specified one (which is not removed), skipping the removed ones.
+ *
+ * @return      The index of the previous instruction, or SIZE_MAX if there is
+ *              none.
+ */
+CLOX_INLINE size_t CLOX_STDCALL clox_OptimizerPrevious(const CloxOptimizerInstruction_t *const instructions, const size_t index)
+{
+    assert(!instructions[index].removed);
+
+    return instructions[index].previous;
+}
+
+/**
+ * @brief       This function gets the index of the instruction after the
+ *              specified one (which is not removed), skipping the removed ones.
+ *
+ * @return      The index of the next instruction, or the number of instructions
+ *              if there is none.
+ */
+CLOX_INLINE size_t CLOX_STDCALL clox_OptimizerNext(const CloxOptimizerInstruction_t *const instructions, const size_t index)
+{
+    assert(!instructions[index].removed);
+
+    return instructions[index].next;
+}
+
+/**
+ * @brief       This function finds the constant pushed right before the
+ *              specified instruction, by a load and a 'psh' of its register.
+ *
+ * @return      The index of the load, or SIZE_MAX if the value pushed is not a
+ *              constant or if the push is the target of a jump.
+ */
+CLOX_STATIC size_t CLOX_STDCALL clox_OptimizerFindConstant(const CloxCodeBlock_t *const codeBlock, const CloxOptimizerInstruction_t *const instructions, const size_t index, CloxValue_t *const outValue)
+{
+    CLOX_REGISTER const size_t push = clox_OptimizerPrevious(instructions, index);
+
+    if ((push == SIZE_MAX) || instructions[push].isTarget || (codeBlock->array[instructions[push].offset] != CLOX_OP_CODE_PSH))
+        return SIZE_MAX;
+
+    CLOX_REGISTER const size_t load = clox_OptimizerPrevious(instructions, push);
+
+    if (load == SIZE_MAX)
+        return SIZE_MAX;
+
+    const byte_t *const bytes = codeBlock->array + instructions[load].offset;
+
+    if (bytes[1] != codeBlock->array[instructions[push].offset + 1])
+        return SIZE_MAX;
+
+    if (bytes[0] == CLOX_OP_CODE_LDC)
+    {
+        *outValue = cloxSIntValue((int16_t)cloxDecodeOpHalf(bytes + 2));
+    }
+    else if ((bytes[0] == CLOX_OP_CODE_LEC) && (cloxDecodeOpHalf(bytes + 2) < codeBlock->constantsCount))
+    {
+        *outValue = codeBlock->constants[cloxDecodeOpHalf(bytes + 2)];
+    }
+    else
+    {
+        return SIZE_MAX;
+    }
+
+    return load;
+}
+
+/**
+ * @brief       This function overwrites an instruction with 'nop' ones, and
+ *              unlinks it from the instructions not removed (the one after the
+ *              last is the end of the block).
+ */
+CLOX_INLINE void CLOX_STDCALL clox_OptimizerRemove(CloxCodeBlock_t *const codeBlock, CloxOptimizerInstruction_t *const instructions, const size_t index)
+{
+    CloxOptimizerInstruction_t *const instruction = &instructions[index];
+
+    assert(!instruction->removed);
+
+    memset(codeBlock->array + instruction->offset, CLOX_OP_CODE_NOP, instruction->size);
+    instruction->removed = TRUE;
+
+    if (instruction->previous != SIZE_MAX)
+        instructions[instruction->previous].next = instruction->next;
+
+    instructions[instruction->next].previous = instruction->previous;
+
+    return;
+}
+
+/**
+ * @brief       This function rewrites a load so that it loads the specified
+ *              value.
+ *
+ * @return      TRUE on success, FALSE if the pool of constants is full.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_OptimizerRewriteLoad(CloxCodeBlock_t *const codeBlock, const CloxOptimizerInstruction_t *const load, const CloxValue_t value)
+{
+    CLOX_REGISTER const size_t index = cloxCodeBlockInternConstant(codeBlock, value);
+
+    if (index > UINT16_MAX)
+        return FALSE;
+
+    codeBlock->array[load->offset] = CLOX_OP_CODE_LEC;
+    cloxEncodeOpHalf(codeBlock->array + load->offset + 2, (uint16_t)index);
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function folds the instruction at the specified index, if
+ *              its operands are constants.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_OptimizerFold(CloxCodeBlock_t *const codeBlock, CloxOptimizerInstruction_t *const instructions, const size_t count, const size_t index)
+{
+    CloxOptimizerInstruction_t *const instruction = &instructions[index];
+
+    CLOX_REGISTER const byte_t opCode = codeBlock->array[instruction->offset];
+
+    CloxValue_t x, y;
+    size_t first, second, jump = count;
+
+    if (instruction->isTarget)
+        return;
+
+    switch (opCode)
+    {
+    case CLOX_OP_CODE_ADD:
+    case CLOX_OP_CODE_SUB:
+    case CLOX_OP_CODE_MUL:
+    case CLOX_OP_CODE_DIV:
+    case CLOX_OP_CODE_CMP:
+        if ((second = clox_OptimizerFindConstant(codeBlock, instructions, index, &y)) == SIZE_MAX)
+            return;
+
+        /* the second load is removed, so it can't be a target */
+        if (instructions[second].isTarget || ((first = clox_OptimizerFindConstant(codeBlock, instructions, second, &x)) == SIZE_MAX))
+            return;
+
+        break;
+
+    case CLOX_OP_CODE_NEG:
+    case CLOX_OP_CODE_NOT:
+    case CLOX_OP_CODE_TST:
+        if ((first = clox_OptimizerFindConstant(codeBlock, instructions, index, &x)) == SIZE_MAX)
+            return;
+
+        second = SIZE_MAX;
+        y = x;
+        break;
+
+    default:
+        return;
+    }
+
+    /* the flags are read only by the jump right after, which nothing else
+     * jumps to */
+    if ((opCode == CLOX_OP_CODE_CMP) || (opCode == CLOX_OP_CODE_TST))
+    {
+        jump = clox_OptimizerNext(instructions, index);
+
+        if ((jump >= count) || instructions[jump].isTarget)
+            return;
+
+        CLOX_REGISTER const byte_t jumpOpCode = codeBlock->array[instructions[jump].offset];
+
+        if ((opCode == CLOX_OP_CODE_CMP) ? !clox_OptimizerIsFlagJump(jumpOpCode) : ((jumpOpCode != CLOX_OP_CODE_JIT) && (jumpOpCode != CLOX_OP_CODE_JNT)))
+            return;
+
+        CLOX_REGISTER const size_t after = clox_OptimizerNext(instructions, jump);
+
+        if ((after < count) && (clox_OptimizerIsFlagJump(codeBlock->array[instructions[after].offset]) || (codeBlock->array[instructions[after].offset] == CLOX_OP_CODE_JIT) || (codeBlock->array[instructions[after].offset] == CLOX_OP_CODE_JNT)))
+            return;
+    }
+
+    if (!cloxVMEvaluate((CloxOpCode_t)opCode, &x, &y))
+        return;
+
+    if (jump < count)
+    {
+        CloxOptimizerInstruction_t *const jumpInstruction = &instructions[jump];
+
+        CLOX_REGISTER const byte_t jumpOpCode = codeBlock->array[jumpInstruction->offset];
+
+        const bool_t taken = (opCode == CLOX_OP_CODE_CMP)
+            ? clox_OptimizerIsTaken(jumpOpCode, cloxValueAsByte(x), FALSE)
+            : clox_OptimizerIsTaken(jumpOpCode, 0, cloxValueAsBool(x));
+
+        /* the operands, the comparison and the jump if it is never taken */
+        for (size_t i = first; i < jump; i = instructions[i].next)
+            clox_OptimizerRemove(codeBlock, instructions, i);
+
+        if (taken)
+            codeBlock->array[jumpInstruction->offset] = (jumpOpCode >= CLOX_OP_CODE_BR) ? CLOX_OP_CODE_BR : CLOX_OP_CODE_JMP;
+        else
+            clox_OptimizerRemove(codeBlock, instructions, jump);
+
+        return;
+    }
+
+    if (!clox_OptimizerRewriteLoad(codeBlock, &instructions[first], x))
+        return;
+
+    /* the first constant is replaced by the result, its push remains */
+    if (second != SIZE_MAX)
+    {
+        CLOX_REGISTER const size_t push = clox_OptimizerNext(instructions, second);
+
+        clox_OptimizerRemove(codeBlock, instructions, second);
+        clox_OptimizerRemove(codeBlock, instructions, push);
+    }
+
+    clox_OptimizerRemove(codeBlock, instructions, index);
+
+    return;
+}
+
+/**
+ * @brief       This function removes the instructions that can't be reached
+ *              from the beginning of the block, then the jumps to the next
+ *              instruction.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_OptimizerDropDeadCode(CloxCodeBlock_t *const codeBlock, CloxOptimizerInstruction_t *const instructions, const size_t count)
+{
+    size_t *const stack = dim(size_t, count + 1);
+    size_t depth = 0, i;
+
+    stack[depth++] = 0;
+    instructions[0].isReached = TRUE;
+
+    /* each instruction is pushed once, when it is first reached */
+    while (depth)
+    {
+        CLOX_REGISTER const size_t index = stack[--depth];
+        CLOX_REGISTER const byte_t opCode = codeBlock->array[instructions[index].offset];
+
+        CLOX_REGISTER const size_t target = instructions[index].removed ? SIZE_MAX : instructions[index].target;
+        CLOX_REGISTER const size_t next = (instructions[index].removed || clox_OptimizerFallsThrough(opCode)) ? index + 1 : SIZE_MAX;
+
+        if ((target < count) && !instructions[target].isReached)
+        {
+            instructions[target].isReached = TRUE;
+            stack[depth++] = target;
+        }
+
+        if ((next < count) && !instructions[next].isReached)
+        {
+            instructions[next].isReached = TRUE;
+            stack[depth++] = next;
+        }
+    }
+
+    dealloc(stack);
+
+    for (i = 0; i < count; i++)
+    {
+        if (!instructions[i].isReached && !instructions[i].removed)
+            clox_OptimizerRemove(codeBlock, instructions, i);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        CLOX_REGISTER const byte_t opCode = codeBlock->array[instructions[i].offset];
+
+        if (instructions[i].removed || ((opCode != CLOX_OP_CODE_JMP) && (opCode != CLOX_OP_CODE_BR)))
+            continue;
+
+        if ((instructions[i].target > i) && (clox_OptimizerNext(instructions, i) >= instructions[i].target))
+            clox_OptimizerRemove(codeBlock, instructions, i);
+    }
+
+    return;
+}
+
+/**
+ * @brief       This function folds the constants and drops the dead code of a
+ *              block, leaving 'nop' instructions in place of the removed ones.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_OptimizerRun(CloxCodeBlock_t *const codeBlock)
+{
+    CLOX_REGISTER size_t i, n, offset;
+
+    size_t removed, previous;
+
+    CloxOptimizerInstruction_t *const instructions = dim(CloxOptimizerInstruction_t, codeBlock->count + 1);
+    size_t *const indexes = dim(size_t, codeBlock->count + 1);
+
+    /* like in the peephole pass, indexes maps each offset to the index of the
+     * instruction starting there (SIZE_MAX when inside an instruction) */
+    for (offset = 0; offset <= codeBlock->count; offset++)
+        indexes[offset] = SIZE_MAX;
+
+    for (n = 0, offset = 0; offset < codeBlock->count; n++)
+    {
+        CloxOpCodeInfo_t opCodeInfo;
+
+        if (!cloxGetOpCodeInfo(codeBlock->array[offset], &opCodeInfo) || ((offset + cloxGetOpKindSize(opCodeInfo.kind)) > codeBlock->count))
+            goto l_release;
+
+        instructions[n].offset    = offset;
+        instructions[n].target    = SIZE_MAX;
+        instructions[n].previous  = n - 1;
+        instructions[n].next      = n + 1;
+        instructions[n].size      = (byte_t)cloxGetOpKindSize(opCodeInfo.kind);
+        instructions[n].isTarget  = FALSE;
+        instructions[n].removed   = FALSE;
+        instructions[n].isReached = FALSE;
+
+        indexes[offset] = n;
+        offset += instructions[n].size;
+    }
+
+    indexes[codeBlock->count] = n;
+
+    /* the end of the block closes the links (the first instruction has no
+     * previous one, as n - 1 wraps to SIZE_MAX) */
+    instructions[n].previous = n - 1;
+
+    for (i = 0; i < n; i++)
+    {
+        int64_t target;
+
+        if (!clox_OptimizerGetTarget(codeBlock->array + instructions[i].offset, instructions[i].offset, instructions[i].size, &target))
+            continue;
+
+        if ((target < 0) || (target > (int64_t)codeBlock->count) || (indexes[target] == SIZE_MAX))
+            goto l_release;
+
+        instructions[i].target = indexes[target];
+    }
+
+    /* the removed jumps leave new constants to fold (like the operands of
+     * the comparisons materialized as booleans), so the passes are repeated
+     * until nothing is removed */
+    for (removed = 0, previous = SIZE_MAX; n && (removed != previous); )
+    {
+        for (i = 0; i < n; i++)
+        {
+            instructions[i].isTarget  = FALSE;
+            instructions[i].isReached = FALSE;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            if (!instructions[i].removed && (instructions[i].target < n))
+                instructions[instructions[i].target].isTarget = TRUE;
+        }
+
+        /* a fold leaves a constant for the next instructions to fold */
+        for (i = 0; i < n; i++)
+            clox_OptimizerFold(codeBlock, instructions, n, i);
+
+        clox_OptimizerDropDeadCode(codeBlock, instructions, n);
+
+        for (previous = removed, removed = 0, i = 0; i < n; i++)
+            removed += instructions[i].removed;
+    }
+
+l_release:
+    dealloc(indexes);
+    dealloc(instructions);
+
+    return;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxCodeBlockOptimize(CloxCodeBlock_t *const codeBlock, const CloxOptimizationLevel_t level)
+{
+    assert(codeBlock != NULL && !codeBlock->frozen);
+
+    CLOX_REGISTER const size_t count = codeBlock->count;
+
+    if (level >= CLOX_OPTIMIZATION_LEVEL_O2)
+    {
+        cloxCodeBlockInvalidate(codeBlock);
+        clox_OptimizerRun(codeBlock);
+    }
+
+    if (level >= CLOX_OPTIMIZATION_LEVEL_O1)
+        cloxCodeBlockPeephole(codeBlock, CLOX_PEEPHOLE_ALL);
+
+    if (codeBlock->count && (codeBlock->capacity > codeBlock->count))
+        cloxCodeBlockShrink(codeBlock, (uint32_t)(codeBlock->capacity - codeBlock->count));
+
+    return count - codeBlock->count;
+}
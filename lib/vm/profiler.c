@@ -0,0 +1,270 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/vm/profiler.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+#ifndef CLOX_PROFILER_CAPACITY
+/**
+ * @brief       This constant represents the initial number of stacks (and of
+ *              lines) that a profiler can store.
+ */
+#   define CLOX_PROFILER_CAPACITY 64
+#endif
+
+/**
+ * @brief       This function hashes the lines and the functions of a stack
+ *              with the address of its block (FNV-1a over 32-bit words).
+ */
+CLOX_INLINE uint32_t CLOX_STDCALL clox_ProfilerHash(const CloxCodeBlock_t *const codeBlock, const uint32_t *const lines, const uint32_t *const functions, const size_t depth)
+{
+    CLOX_REGISTER uint32_t hash = UINT32_C(2166136261) ^ (uint32_t)((uintptr_t)codeBlock >> 4);
+
+    for (size_t i = 0; i < depth; i++)
+        hash = (((hash ^ lines[i]) * UINT32_C(16777619)) ^ functions[i]) * UINT32_C(16777619);
+
+    return hash;
+}
+
+/**
+ * @brief       This function finds the slot of the index that stores a stack,
+ *              or the empty slot where it has to be inserted.
+ */
+CLOX_STATIC uint32_t *CLOX_STDCALL clox_ProfilerFindSlot(const CloxProfiler_t *const profiler, const CloxCodeBlock_t *const codeBlock, const uint32_t *const lines, const uint32_t *const functions, const size_t depth, const uint32_t hash)
+{
+    CLOX_REGISTER const size_t mask = profiler->indexCapacity - 1;
+    CLOX_REGISTER size_t slot = (size_t)hash & mask;
+
+    /* the index is never full, so linear probing always finds a slot */
+    for (; profiler->index[slot]; slot = (slot + 1) & mask)
+    {
+        const CloxProfilerStack_t *const stack = &profiler->stacks[profiler->index[slot] - 1];
+
+        if ((stack->hash == hash) && (stack->codeBlock == codeBlock) && (stack->depth == depth)
+            && !memcmp(profiler->lines + stack->position, lines, depth * sizeof(uint32_t))
+            && !memcmp(profiler->functions + stack->position, functions, depth * sizeof(uint32_t)))
+            break;
+    }
+
+    return &profiler->index[slot];
+}
+
+/**
+ * @brief       This function grows the index, keeping its load factor below
+ *              one half.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_ProfilerGrowIndex(CloxProfiler_t *const profiler)
+{
+    CLOX_REGISTER const size_t capacity = profiler->indexCapacity * 2;
+    CLOX_REGISTER const size_t mask = capacity - 1;
+
+    uint32_t *const index = dim(uint32_t, capacity);
+
+    for (size_t i = 0; i < profiler->stacksCount; i++)
+    {
+        CLOX_REGISTER size_t slot = (size_t)profiler->stacks[i].hash & mask;
+
+        while (index[slot])
+            slot = (slot + 1) & mask;
+
+        index[slot] = (uint32_t)(i + 1);
+    }
+
+    free(profiler->index);
+
+    profiler->index = index;
+    profiler->indexCapacity = capacity;
+
+    return;
+}
+
+CLOX_API CloxProfiler_t *CLOX_STDCALL cloxInitProfiler(CloxProfiler_t *const profiler, uint64_t period)
+{
+    assert(profiler != NULL);
+
+    if (!period)
+        period = CLOX_PROFILER_PERIOD;
+
+    profiler->period    = period;
+    profiler->deadline  = cloxClockNow() + period;
+    profiler->countdown = CLOX_PROFILER_INTERVAL;
+
+    profiler->lines         = dim(uint32_t, CLOX_PROFILER_CAPACITY);
+    profiler->functions     = dim(uint32_t, CLOX_PROFILER_CAPACITY);
+    profiler->linesCount    = 0;
+    profiler->linesCapacity = CLOX_PROFILER_CAPACITY;
+
+    profiler->stacks         = dim(CloxProfilerStack_t, CLOX_PROFILER_CAPACITY);
+    profiler->stacksCount    = 0;
+    profiler->stacksCapacity = CLOX_PROFILER_CAPACITY;
+
+    profiler->index         = dim(uint32_t, CLOX_PROFILER_CAPACITY * 2);
+    profiler->indexCapacity = CLOX_PROFILER_CAPACITY * 2;
+
+    profiler->scratch         = dim(uint32_t, CLOX_PROFILER_CAPACITY * 2);
+    profiler->scratchCapacity = CLOX_PROFILER_CAPACITY * 2;
+
+    profiler->samplesCount = 0;
+
+    return profiler;
+}
+
+CLOX_API CloxProfiler_t *CLOX_STDCALL cloxFreeProfiler(CloxProfiler_t *const profiler)
+{
+    assert(profiler != NULL);
+
+    if (profiler->lines)
+        dealloc(profiler->lines);
+
+    if (profiler->functions)
+        dealloc(profiler->functions);
+
+    if (profiler->stacks)
+        dealloc(profiler->stacks);
+
+    if (profiler->index)
+        dealloc(profiler->index);
+
+    if (profiler->scratch)
+        dealloc(profiler->scratch);
+
+    profiler->linesCount      = 0;
+    profiler->linesCapacity   = 0;
+    profiler->stacksCount     = 0;
+    profiler->stacksCapacity  = 0;
+    profiler->indexCapacity   = 0;
+    profiler->scratchCapacity = 0;
+    profiler->samplesCount    = 0;
+
+    return profiler;
+}
+
+CLOX_API uint32_t *CLOX_STDCALL cloxProfilerReserve(CloxProfiler_t *const profiler, const size_t depth)
+{
+    assert(profiler != NULL);
+
+    /* the second half of the scratch array gets the functions of the frames */
+    if ((depth * 2) > profiler->scratchCapacity)
+    {
+        CLOX_REGISTER size_t capacity = profiler->scratchCapacity;
+
+        while (capacity < (depth * 2))
+            capacity *= 2;
+
+        profiler->scratch = redim(uint32_t, profiler->scratch, capacity);
+        profiler->scratchCapacity = capacity;
+    }
+
+    return profiler->scratch;
+}
+
+CLOX_API void CLOX_STDCALL cloxProfilerRecord(CloxProfiler_t *const profiler, const CloxCodeBlock_t *const codeBlock, const size_t depth)
+{
+    assert(profiler != NULL && codeBlock != NULL && (depth * 2) <= profiler->scratchCapacity);
+
+    uint32_t *const lines = profiler->scratch, *const functions = profiler->scratch + depth;
+    CloxSourceLocation_t location;
+
+    /* the offsets are resolved in place, the scratch array becomes the lines
+     * of the stack followed by the names of their functions (plus one, zero
+     * for the top-level code) */
+    for (size_t i = 0; i < depth; i++)
+    {
+        const CloxCodeSymbol_t *const symbol = cloxCodeBlockFindSymbol(codeBlock, lines[i]);
+
+        functions[i] = symbol ? symbol->name + 1 : 0;
+        lines[i]     = cloxCodeBlockGetLine(codeBlock, lines[i], &location) ? location.ln + 1 : 0;
+    }
+
+    CLOX_REGISTER const uint32_t hash = clox_ProfilerHash(codeBlock, lines, functions, depth);
+
+    uint32_t *slot = clox_ProfilerFindSlot(profiler, codeBlock, lines, functions, depth, hash);
+
+    profiler->samplesCount++;
+
+    if (*slot)
+    {
+        profiler->stacks[*slot - 1].samples++;
+        return;
+    }
+
+    if (profiler->stacksCount >= profiler->stacksCapacity)
+    {
+        profiler->stacksCapacity *= 2;
+        profiler->stacks = redim(CloxProfilerStack_t, profiler->stacks, profiler->stacksCapacity);
+    }
+
+    if ((profiler->linesCount + depth) > profiler->linesCapacity)
+    {
+        while ((profiler->linesCount + depth) > profiler->linesCapacity)
+            profiler->linesCapacity *= 2;
+
+        profiler->lines     = redim(uint32_t, profiler->lines, profiler->linesCapacity);
+        profiler->functions = redim(uint32_t, profiler->functions, profiler->linesCapacity);
+    }
+
+    CloxProfilerStack_t *const stack = &profiler->stacks[profiler->stacksCount++];
+
+    stack->codeBlock = codeBlock;
+    stack->position  = profiler->linesCount;
+    stack->depth     = (uint32_t)depth;
+    stack->hash      = hash;
+    stack->samples   = 1;
+
+    memcpy(profiler->lines + profiler->linesCount, lines, depth * sizeof(uint32_t));
+    memcpy(profiler->functions + profiler->linesCount, functions, depth * sizeof(uint32_t));
+    profiler->linesCount += depth;
+
+    *slot = (uint32_t)profiler->stacksCount;
+
+    if ((profiler->stacksCount * 2) > profiler->indexCapacity)
+        clox_ProfilerGrowIndex(profiler);
+
+    return;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxProfilerWrite(const CloxProfiler_t *const profiler, FILE *const stream, const CloxCodeBlock_t *const *const codeBlocks, const char *const *const names, const size_t count)
+{
+    assert(profiler != NULL && stream != NULL && (count == 0 || (codeBlocks != NULL && names != NULL)));
+
+    for (size_t i = 0; i < profiler->stacksCount; i++)
+    {
+        const CloxProfilerStack_t *const stack = &profiler->stacks[i];
+        const CloxCodeBlock_t *codeBlock = NULL;
+        const char *name = "?";
+
+        for (size_t j = 0; j < count; j++)
+        {
+            if (codeBlocks[j] == stack->codeBlock)
+            {
+                codeBlock = codeBlocks[j];
+                name = names[j];
+                break;
+            }
+        }
+
+        for (size_t j = 0; j < stack->depth; j++)
+        {
+            CLOX_REGISTER const uint32_t function = profiler->functions[stack->position + j];
+
+            fprintf(stream, "%s%s:", j ? ";" : "", name);
+
+            /* the names of the functions are kept by their block, so only
+             * the frames of the blocks written are named */
+            if (function && codeBlock)
+                fprintf(stream, "%s:", cloxCodeBlockGetName(codeBlock, function - 1));
+
+            fprintf(stream, "%" PRIu32, profiler->lines[stack->position + j]);
+        }
+
+        fprintf(stream, " %" PRIu64 "\n", stack->samples);
+    }
+
+    return (bool_t)!ferror(stream);
+}
@@ -0,0 +1,206 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/errno.h"
+#include "clox/vm/shape.h"
+
+#include <string.h>
+
+/**
+ * @brief       This function gets the overflow array of an instance.
+ *
+ * @return      A pointer to the array object, or NULL if the instance has none.
+ */
+CLOX_INLINE CloxObject_t *CLOX_STDCALL clox_InstanceOverflow(CloxObject_t *const object)
+{
+    const CloxValue_t overflow = cloxObjectValues(object)[CLOX_INSTANCE_OVERFLOW];
+
+    return (cloxValueType(overflow) == CLOX_VALUE_TYPE_OBJT) ? cloxValueAsObject(overflow) : NULL;
+}
+
+CLOX_API CloxShapeTree_t *CLOX_STDCALL cloxInitShapeTree(CloxShapeTree_t *const tree)
+{
+    assert(tree != NULL);
+
+    cloxInitArena(&tree->arena, 0);
+
+    tree->root.parent      = NULL;
+    tree->root.key         = NULL;
+    tree->root.count       = 0;
+    tree->root.transitions = NULL;
+    tree->root.sibling     = NULL;
+    tree->count            = 1;
+
+    return tree;
+}
+
+CLOX_API CloxShapeTree_t *CLOX_STDCALL cloxFreeShapeTree(CloxShapeTree_t *const tree)
+{
+    assert(tree != NULL);
+
+    cloxFreeArena(&tree->arena);
+
+    tree->root.transitions = NULL;
+    tree->count            = 1;
+
+    return tree;
+}
+
+CLOX_API const CloxShape_t *CLOX_STDCALL cloxShapeTransition(CloxShapeTree_t *const tree, const CloxShape_t *const shape, const CloxString_t *const key)
+{
+    assert(tree != NULL && shape != NULL && key != NULL);
+
+    /* the shapes of a tree are never frozen, only the instances see them as
+     * constants */
+    CloxShape_t *const parent = (CloxShape_t *)shape;
+    CloxShape_t *child;
+
+    for (child = parent->transitions; child; child = child->sibling)
+        if (child->key == key)
+            return child;
+
+    if (shape->count >= (UINT32_MAX - CLOX_INSTANCE_FIELDS))
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    child = (CloxShape_t *)cloxArenaAlloc(&tree->arena, sizeof(CloxShape_t));
+
+    child->parent      = shape;
+    child->key         = key;
+    child->count       = shape->count + 1;
+    child->transitions = NULL;
+    child->sibling     = parent->transitions;
+
+    parent->transitions = child;
+    tree->count++;
+
+    return child;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxShapeLookup(const CloxShape_t *const shape, const CloxString_t *const key)
+{
+    assert(shape != NULL);
+
+    /* the names are interned, so they are compared by pointer; the inline
+     * caches keep this walk off the common path */
+    for (const CloxShape_t *current = shape; current->key; current = current->parent)
+        if (current->key == key)
+            return (size_t)current->count - 1;
+
+    return SIZE_MAX;
+}
+
+CLOX_API CloxObject_t *CLOX_STDCALL cloxNewInstance(CloxHeap_t *const heap, CloxShapeTree_t *const tree, size_t capacity)
+{
+    assert(heap != NULL && tree != NULL);
+
+    if (!capacity)
+        capacity = CLOX_INSTANCE_CAPACITY;
+
+    if (capacity > (UINT32_MAX - CLOX_INSTANCE_FIELDS))
+        fail(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS, NULL);
+
+    /* the payload is the one of an array, only the kind tells them apart */
+    CloxObject_t *const object = cloxHeapNewArray(heap, capacity + CLOX_INSTANCE_FIELDS);
+
+    if (!object)
+        return NULL;
+
+    object->kind = CLOX_OBJECT_KIND_INSTANCE;
+    cloxObjectValues(object)[CLOX_INSTANCE_SHAPE] = cloxVPtrValue((vptr_t)&tree->root);
+
+    return object;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxInstanceGet(CloxObject_t *const object, const CloxString_t *const key, CloxValue_t *const outValue)
+{
+    assert(object != NULL && object->kind == CLOX_OBJECT_KIND_INSTANCE && outValue != NULL);
+
+    CLOX_REGISTER const size_t index = cloxShapeLookup(cloxInstanceShape(object), key);
+
+    if (index == SIZE_MAX)
+        return FALSE;
+
+    *outValue = *cloxInstanceField(object, index);
+
+    return TRUE;
+}
+
+CLOX_API void CLOX_STDCALL cloxInstanceStore(CloxHeap_t *const heap, CloxObject_t *const object, const size_t index, const CloxValue_t value)
+{
+    assert(heap != NULL && object != NULL && object->kind == CLOX_OBJECT_KIND_INSTANCE);
+    assert(index < cloxInstanceShape(object)->count);
+
+    CLOX_REGISTER const size_t capacity = (size_t)object->count - CLOX_INSTANCE_FIELDS;
+
+    if (index < capacity)
+        cloxHeapSet(heap, object, CLOX_INSTANCE_FIELDS + index, value);
+    else
+        cloxHeapSet(heap, clox_InstanceOverflow(object), index - capacity, value);
+
+    return;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxInstanceAppend(CloxHeap_t *const heap, CloxObject_t *const object, const CloxShape_t *const shape, const CloxValue_t value)
+{
+    assert(heap != NULL && object != NULL && object->kind == CLOX_OBJECT_KIND_INSTANCE && shape != NULL);
+
+    CloxValue_t *const values = cloxObjectValues(object);
+
+    CLOX_REGISTER const size_t capacity = (size_t)object->count - CLOX_INSTANCE_FIELDS;
+    CLOX_REGISTER const size_t index    = (size_t)shape->count - 1;
+
+    assert(shape->count == (cloxInstanceShape(object)->count + 1));
+
+    if (index >= capacity)
+    {
+        CloxObject_t *overflow = clox_InstanceOverflow(object);
+
+        /* the overflow array doubles, so appending stays amortized constant */
+        if (!overflow || ((index - capacity) >= overflow->count))
+        {
+            CLOX_REGISTER const size_t count = overflow ? (size_t)overflow->count * 2 : capacity ? capacity : CLOX_INSTANCE_CAPACITY;
+            CloxObject_t *const grown = cloxHeapNewArray(heap, count);
+
+            if (!grown)
+                return FALSE;
+
+            if (overflow)
+            {
+                memcpy(cloxObjectValues(grown), cloxObjectValues(overflow), overflow->count * sizeof(CloxValue_t));
+                cloxHeapBarrier(heap, grown);
+            }
+
+            overflow = grown;
+            cloxHeapSet(heap, object, CLOX_INSTANCE_OVERFLOW, cloxObjtValue(overflow));
+        }
+
+        cloxHeapSet(heap, overflow, index - capacity, value);
+    }
+    else
+    {
+        cloxHeapSet(heap, object, CLOX_INSTANCE_FIELDS + index, value);
+    }
+
+    values[CLOX_INSTANCE_SHAPE] = cloxVPtrValue((vptr_t)shape);
+
+    return TRUE;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxInstanceSet(CloxHeap_t *const heap, CloxShapeTree_t *const tree, CloxObject_t *const object, const CloxString_t *const key, const CloxValue_t value)
+{
+    assert(heap != NULL && tree != NULL && object != NULL && object->kind == CLOX_OBJECT_KIND_INSTANCE && key != NULL);
+
+    const CloxShape_t *const shape = cloxInstanceShape(object);
+    CLOX_REGISTER const size_t index = cloxShapeLookup(shape, key);
+
+    if (index == SIZE_MAX)
+        return cloxInstanceAppend(heap, object, cloxShapeTransition(tree, shape, key), value);
+
+    cloxInstanceStore(heap, object, index, value);
+
+    return TRUE;
+}
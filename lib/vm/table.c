@@ -0,0 +1,152 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/vm/table.h"
+
+/**
+ * @brief       This function finds the entry that stores a key, or the empty
+ *              entry where it has to be inserted.
+ */
+CLOX_INLINE CloxTableEntry_t *CLOX_STDCALL clox_TableFindEntry(CloxTableEntry_t *const entries, const size_t capacity, const CloxString_t *const key)
+{
+    CLOX_REGISTER const size_t mask = capacity - 1;
+    CLOX_REGISTER size_t slot = (size_t)key->hash & mask;
+
+    /* the table is never full, so linear probing always finds an entry */
+    while (entries[slot].key && (entries[slot].key != key))
+        slot = (slot + 1) & mask;
+
+    return &entries[slot];
+}
+
+/**
+ * @brief       This function grows the table, keeping its load factor below
+ *              three quarters.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_TableGrow(CloxTable_t *const table)
+{
+    CLOX_REGISTER const size_t capacity = table->capacity ? table->capacity * 2 : CLOX_TABLE_CAPACITY;
+    CloxTableEntry_t *const entries = dim(CloxTableEntry_t, capacity);
+
+    for (size_t i = 0; i < table->capacity; i++)
+        if (table->entries[i].key)
+            *clox_TableFindEntry(entries, capacity, table->entries[i].key) = table->entries[i];
+
+    if (table->entries)
+        free(table->entries);
+
+    table->entries  = entries;
+    table->capacity = capacity;
+    table->epoch++;
+
+    return;
+}
+
+CLOX_API CloxTable_t *CLOX_STDCALL cloxInitTable(CloxTable_t *const table)
+{
+    assert(table != NULL);
+
+    table->entries  = NULL;
+    table->capacity = 0;
+    table->count    = 0;
+    table->epoch    = 1;
+
+    return table;
+}
+
+CLOX_API CloxTable_t *CLOX_STDCALL cloxFreeTable(CloxTable_t *const table)
+{
+    assert(table != NULL);
+
+    if (table->entries)
+        dealloc(table->entries);
+
+    table->capacity = 0;
+    table->count    = 0;
+    table->epoch++;
+
+    return table;
+}
+
+CLOX_API CloxTable_t *CLOX_STDCALL cloxCreateTable(void)
+{
+    return cloxInitTable(alloc(CloxTable_t));
+}
+
+CLOX_API CloxTableEntry_t *CLOX_STDCALL cloxTableFind(const CloxTable_t *const table, const CloxString_t *const key)
+{
+    assert(table != NULL && key != NULL);
+
+    if (!table->count)
+        return NULL;
+
+    CloxTableEntry_t *const entry = clox_TableFindEntry(table->entries, table->capacity, key);
+
+    return entry->key ? entry : NULL;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxTableSet(CloxTable_t *const table, const CloxString_t *const key, const CloxValue_t value)
+{
+    assert(table != NULL && key != NULL);
+
+    if (((table->count + 1) * 4) > (table->capacity * 3))
+        clox_TableGrow(table);
+
+    CloxTableEntry_t *const entry = clox_TableFindEntry(table->entries, table->capacity, key);
+    CLOX_REGISTER const bool_t added = (bool_t)!entry->key;
+
+    /* the new key fills an empty entry, so the others never move */
+    if (added)
+        table->count++;
+
+    entry->key   = key;
+    entry->value = value;
+
+    return added;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxTableDelete(CloxTable_t *const table, const CloxString_t *const key)
+{
+    assert(table != NULL && key != NULL);
+
+    if (!table->count)
+        return FALSE;
+
+    CLOX_REGISTER const size_t mask = table->capacity - 1;
+    CloxTableEntry_t *const entries = table->entries;
+    CLOX_REGISTER size_t hole = (size_t)(clox_TableFindEntry(entries, table->capacity, key) - entries);
+
+    if (!entries[hole].key)
+        return FALSE;
+
+    /* the entries of the run that follows are moved back into the hole when
+     * their home slot doesn't lie between the hole and them (cyclically) */
+    for (size_t slot = (hole + 1) & mask; entries[slot].key; slot = (slot + 1) & mask)
+    {
+        CLOX_REGISTER const size_t home = (size_t)entries[slot].key->hash & mask;
+
+        if (((slot - home) & mask) < ((slot - hole) & mask))
+            continue;
+
+        entries[hole] = entries[slot];
+        hole = slot;
+    }
+
+    entries[hole].key = NULL;
+
+    table->count--;
+    table->epoch++;
+
+    return TRUE;
+}
+
+CLOX_API void CLOX_STDCALL cloxDeleteTable(CloxTable_t *const table)
+{
+    free(cloxFreeTable(table));
+
+    return;
+}
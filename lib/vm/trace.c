@@ -0,0 +1,182 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/vm/trace.h"
+
+#include <string.h>
+
+/**
+ * @brief       This function writes the records of the ring from the first
+ *              specified one (included) to the last one (excluded), which are
+ *              at most a ring apart.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_TraceWriteRecords(const CloxTrace_t *const trace, FILE *const stream, const uint64_t first, const uint64_t last)
+{
+    CLOX_REGISTER const size_t mask  = trace->capacity - 1;
+    CLOX_REGISTER const size_t start = (size_t)(first & mask);
+    CLOX_REGISTER const size_t count = (size_t)(last - first);
+
+    /* the records of the range wrap at most once around the ring */
+    CLOX_REGISTER const size_t tail = ((start + count) > trace->capacity) ? trace->capacity - start : count;
+
+    return (bool_t)((fwrite(trace->records + start, sizeof(CloxTraceRecord_t), tail, stream) == tail)
+                 && (fwrite(trace->records, sizeof(CloxTraceRecord_t), count - tail, stream) == (count - tail)));
+}
+
+/**
+ * @brief       This function writes the header of a trace file.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_TraceWriteHeader(FILE *const stream)
+{
+    CloxTraceHeader_t header;
+
+    header.magic      = CLOX_TRACE_MAGIC_NUMBER;
+    header.version    = CLOX_TRACE_VERSION;
+    header.recordSize = (uint16_t)sizeof(CloxTraceRecord_t);
+
+    return (bool_t)(fwrite(&header, sizeof(header), 1, stream) == 1);
+}
+
+CLOX_API CloxTrace_t *CLOX_STDCALL cloxInitTrace(CloxTrace_t *const trace, size_t capacity, FILE *const stream)
+{
+    assert(trace != NULL);
+
+    if (!capacity)
+        capacity = CLOX_TRACE_CAPACITY;
+
+    /* at least two records, so that each half of the ring has one */
+    CLOX_REGISTER size_t size = 2;
+
+    while (size < capacity)
+        size *= 2;
+
+    trace->records  = dim(CloxTraceRecord_t, size);
+    trace->capacity = size;
+    trace->head     = 0;
+    trace->stream   = stream;
+    trace->flushed  = 0;
+    trace->failed   = FALSE;
+
+    if (stream && !clox_TraceWriteHeader(stream))
+    {
+        trace->stream = NULL;
+        trace->failed = TRUE;
+    }
+
+    return trace;
+}
+
+CLOX_API CloxTrace_t *CLOX_STDCALL cloxFreeTrace(CloxTrace_t *const trace)
+{
+    assert(trace != NULL);
+
+    if (trace->records)
+        dealloc(trace->records);
+
+    trace->capacity = 0;
+    trace->head     = 0;
+    trace->stream   = NULL;
+    trace->flushed  = 0;
+
+    return trace;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxTraceFlush(CloxTrace_t *const trace)
+{
+    assert(trace != NULL);
+
+    if (!trace->stream)
+        return (bool_t)!trace->failed;
+
+    CLOX_REGISTER const uint64_t head = trace->head;
+
+    /* the records overwritten before a flush can't be recovered */
+    if ((head - trace->flushed) > trace->capacity)
+        trace->flushed = head - trace->capacity;
+
+    if (!clox_TraceWriteRecords(trace, trace->stream, trace->flushed, head))
+    {
+        /* the writer must not fail on each record from now on */
+        trace->stream = NULL;
+        trace->failed = TRUE;
+
+        return FALSE;
+    }
+
+    trace->flushed = head;
+
+    return TRUE;
+}
+
+CLOX_API size_t CLOX_STDCALL cloxTraceSnapshot(const CloxTrace_t *const trace, CloxTraceRecord_t *const outRecords, const size_t count)
+{
+    assert(trace != NULL && (count == 0 || outRecords != NULL));
+
+    CLOX_REGISTER const size_t mask = trace->capacity - 1;
+    CLOX_REGISTER const uint64_t head = cloxAtomicLoadAcquire64(&trace->head);
+
+    /* the writer may be storing the record after the last published one, that
+     * overwrites the slot of the record a ring before it, so that one is never
+     * copied */
+    CLOX_REGISTER size_t copied = (size_t)((head < trace->capacity) ? head : trace->capacity - 1);
+
+    if (copied > count)
+        copied = count;
+
+    CLOX_REGISTER const uint64_t first = head - copied;
+
+    for (size_t i = 0; i < copied; i++)
+        outRecords[i] = trace->records[(size_t)(first + i) & mask];
+
+    /* the records overwritten meanwhile are the oldest ones, the others are
+     * still valid (like the readers of a sequence lock) */
+    cloxAtomicFenceAcquire();
+
+    CLOX_REGISTER const uint64_t last = cloxAtomicLoadRelaxed64(&trace->head) + 1;
+
+    if ((last - first) > trace->capacity)
+    {
+        CLOX_REGISTER const size_t dropped = (size_t)(last - first - trace->capacity);
+
+        if (dropped >= copied)
+            return 0;
+
+        memmove(outRecords, outRecords + dropped, (copied - dropped) * sizeof(CloxTraceRecord_t));
+        copied -= dropped;
+    }
+
+    return copied;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxTraceWrite(const CloxTrace_t *const trace, FILE *const stream)
+{
+    assert(trace != NULL && stream != NULL);
+
+    CLOX_REGISTER const uint64_t head = trace->head;
+
+    return (bool_t)(clox_TraceWriteHeader(stream)
+                 && clox_TraceWriteRecords(trace, stream, (head < trace->capacity) ? 0 : head - trace->capacity, head));
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxTraceReadHeader(FILE *const stream)
+{
+    assert(stream != NULL);
+
+    CloxTraceHeader_t header;
+
+    if (fread(&header, sizeof(header), 1, stream) != 1)
+        return FALSE;
+
+    return (bool_t)((header.magic == CLOX_TRACE_MAGIC_NUMBER) && (header.version == CLOX_TRACE_VERSION) && (header.recordSize == sizeof(CloxTraceRecord_t)));
+}
+
+CLOX_API size_t CLOX_STDCALL cloxTraceRead(FILE *const stream, CloxTraceRecord_t *const outRecords, const size_t count)
+{
+    assert(stream != NULL && (count == 0 || outRecords != NULL));
+
+    return fread(outRecords, sizeof(CloxTraceRecord_t), count, stream);
+}
@@ -0,0 +1,607 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/utils.h"
+#include "clox/vm/verifier.h"
+
+#include <string.h>
+
+/**
+ * @brief       This data structure provides an instruction of the block being
+ *              verified.
+ */
+typedef struct _CloxVerifierInstruction
+{
+    /**
+     * @brief   The offset of the instruction.
+     */
+    size_t  offset;
+    /**
+     * @brief   The index of the target instruction of a jump, a branch or a
+     *          call (the index of the end of the block is the number of
+     *          instructions), or SIZE_MAX for other instructions.
+     */
+    size_t  target;
+    /**
+     * @brief   The index of the procedure whose entry is the instruction, or
+     *          SIZE_MAX if it is not the entry of a procedure.
+     */
+    size_t  entry;
+    /**
+     * @brief   The index of the procedure that reaches the instruction in the
+     *          current pass, or SIZE_MAX if it hasn't been reached.
+     */
+    size_t  procedure;
+    /**
+     * @brief   The depth of the evaluation stack before the instruction,
+     *          relative to the entry of its procedure.
+     */
+    int64_t depth;
+} CloxVerifierInstruction_t;
+
+/**
+ * @brief       This data structure provides the summary of a procedure.
+ */
+typedef struct _CloxVerifierProcedure
+{
+    /**
+     * @brief   The index of the instruction at the entry of the procedure.
+     */
+    size_t  entry;
+    /**
+     * @brief   The number of values below its entry the procedure reads, its
+     *          callers must have them on the evaluation stack.
+     */
+    int64_t arguments;
+    /**
+     * @brief   The depth of the evaluation stack at the returns, relative to
+     *          the entry of the procedure.
+     */
+    int64_t results;
+    /**
+     * @brief   TRUE once a return of the procedure has been reached.
+     */
+    bool_t  returns;
+} CloxVerifierProcedure_t;
+
+/**
+ * @brief       This data structure provides the state of the verifier.
+ */
+typedef struct _CloxVerifier
+{
+    const CloxCodeBlock_t     *codeBlock;
+    CloxVerifierInstruction_t *instructions;
+    size_t                     count;
+    CloxVerifierProcedure_t   *procedures;
+    size_t                     proceduresCount;
+    /**
+     * @brief   The instructions reached but not followed yet, each instruction
+     *          is pushed at most once for each pass.
+     */
+    size_t                    *pending;
+    size_t                     pendingCount;
+    /**
+     * @brief   TRUE if a summary has changed during the current pass.
+     */
+    bool_t                     changed;
+} CloxVerifier_t;
+
+/**
+ * @brief       This function gets the offset targeted by a jump, a branch or a
+ *              call.
+ *
+ * @return      TRUE if the instruction is a jump, a branch or a call, otherwise
+ *              FALSE.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_VerifierGetTarget(const byte_t *const bytes, const size_t offset, const size_t size, int64_t *const outTarget)
+{
+    CLOX_REGISTER const byte_t opCode = bytes[0];
+
+    if ((opCode == CLOX_OP_CODE_CALL) || (opCode == CLOX_OP_CODE_TCALL)
+     || ((opCode >= CLOX_OP_CODE_JMP) && (opCode <= CLOX_OP_CODE_JLE))
+     || ((opCode >= CLOX_OP_CODE_CJEQ) && (opCode <= CLOX_OP_CODE_CJLE)))
+        *outTarget = (int64_t)(offset + size) + (int32_t)cloxDecodeOpWord(bytes + 1);
+    else if ((opCode >= CLOX_OP_CODE_BR) && (opCode <= CLOX_OP_CODE_BLE))
+        *outTarget = (int64_t)cloxDecodeOpWord(bytes + 1);
+    else if ((opCode >= CLOX_OP_CODE_RJEQ) && (opCode <= CLOX_OP_CODE_RJLE))
+        *outTarget = (int64_t)(offset + size) + (int16_t)cloxDecodeOpHalf(bytes + 1);
+    else
+        return FALSE;
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function tells whether the instruction after one with the
+ *              specified opcode can be executed (after a call, only once the
+ *              callee returns).
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_VerifierFallsThrough(const byte_t opCode)
+{
+    switch (opCode)
+    {
+    case CLOX_OP_CODE_ABORT:
+    case CLOX_OP_CODE_EXIT:
+    case CLOX_OP_CODE_CALL:
+    case CLOX_OP_CODE_TCALL:
+    case CLOX_OP_CODE_RET:
+    case CLOX_OP_CODE_JMP:
+    case CLOX_OP_CODE_BR:
+        return FALSE;
+
+    default:
+        return TRUE;
+    }
+}
+
+/**
+ * @brief       This function gets the number of values an instruction reads
+ *              from the evaluation stack and the amount by which it changes
+ *              its depth, the ones of calls are given by their callee.
+ *
+ * @return      TRUE on success, FALSE if the effect of the instruction is not
+ *              known (or its operands are invalid).
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_VerifierStackEffect(const byte_t *const bytes, int64_t *const outRequired, int64_t *const outEffect)
+{
+    *outRequired = 0;
+    *outEffect   = 0;
+
+    switch (bytes[0])
+    {
+    case CLOX_OP_CODE_NOP:
+    case CLOX_OP_CODE_BREAK:
+    case CLOX_OP_CODE_ABORT:
+    case CLOX_OP_CODE_EXIT:
+    case CLOX_OP_CODE_RAISE:
+    case CLOX_OP_CODE_CALL:
+    case CLOX_OP_CODE_TCALL:
+    case CLOX_OP_CODE_RET:
+    case CLOX_OP_CODE_JMP:
+    case CLOX_OP_CODE_JIT:
+    case CLOX_OP_CODE_JNT:
+    case CLOX_OP_CODE_JEQ:
+    case CLOX_OP_CODE_JNE:
+    case CLOX_OP_CODE_JGT:
+    case CLOX_OP_CODE_JGE:
+    case CLOX_OP_CODE_JLT:
+    case CLOX_OP_CODE_JLE:
+    case CLOX_OP_CODE_BR:
+    case CLOX_OP_CODE_BEQ:
+    case CLOX_OP_CODE_BNE:
+    case CLOX_OP_CODE_BGT:
+    case CLOX_OP_CODE_BGE:
+    case CLOX_OP_CODE_BLT:
+    case CLOX_OP_CODE_BLE:
+    case CLOX_OP_CODE_LDC:
+    case CLOX_OP_CODE_LDA:
+    case CLOX_OP_CODE_LEC:
+    case CLOX_OP_CODE_LEA:
+    case CLOX_OP_CODE_LECW:
+    case CLOX_OP_CODE_LEAW:
+    case CLOX_OP_CODE_LDG:
+    case CLOX_OP_CODE_STG:
+    case CLOX_OP_CODE_ENT:
+    case CLOX_OP_CODE_LEV:
+    case CLOX_OP_CODE_RADD:
+    case CLOX_OP_CODE_RSUB:
+    case CLOX_OP_CODE_RMUL:
+    case CLOX_OP_CODE_RDIV:
+    case CLOX_OP_CODE_RNEG:
+    case CLOX_OP_CODE_RNOT:
+    case CLOX_OP_CODE_RCMP:
+    case CLOX_OP_CODE_RTST:
+    case CLOX_OP_CODE_RJEQ:
+    case CLOX_OP_CODE_RJNE:
+    case CLOX_OP_CODE_RJGT:
+    case CLOX_OP_CODE_RJGE:
+    case CLOX_OP_CODE_RJLT:
+    case CLOX_OP_CODE_RJLE:
+    case CLOX_OP_CODE_RADC:
+    case CLOX_OP_CODE_RSBC:
+    case CLOX_OP_CODE_NEWO:
+        break;
+
+    case CLOX_OP_CODE_MOV:
+        /* the value at the specified distance from the top of the stack */
+        if (cloxDecodeOpHalf(bytes + 2) & 0x8000)
+            *outRequired = (int64_t)(cloxDecodeOpHalf(bytes + 2) & 0x7FFF) + 1;
+
+        break;
+
+    case CLOX_OP_CODE_PSH:
+        *outEffect = 1;
+        break;
+
+    case CLOX_OP_CODE_DUP:
+        *outRequired = 1;
+        *outEffect   = 1;
+        break;
+
+    case CLOX_OP_CODE_POP:
+    case CLOX_OP_CODE_TST:
+    case CLOX_OP_CODE_GETP:
+    case CLOX_OP_CODE_SETP:
+        *outRequired = 1;
+        *outEffect   = -1;
+        break;
+
+    case CLOX_OP_CODE_NEG:
+    case CLOX_OP_CODE_NOT:
+        *outRequired = 1;
+        break;
+
+    case CLOX_OP_CODE_ADD:
+    case CLOX_OP_CODE_SUB:
+    case CLOX_OP_CODE_MUL:
+    case CLOX_OP_CODE_DIV:
+        *outRequired = 2;
+        *outEffect   = -1;
+        break;
+
+    case CLOX_OP_CODE_CMP:
+    case CLOX_OP_CODE_CJEQ:
+    case CLOX_OP_CODE_CJNE:
+    case CLOX_OP_CODE_CJGT:
+    case CLOX_OP_CODE_CJGE:
+    case CLOX_OP_CODE_CJLT:
+    case CLOX_OP_CODE_CJLE:
+        *outRequired = 2;
+        *outEffect   = -2;
+        break;
+
+    case CLOX_OP_CODE_NCALL:
+        /* the arguments are replaced by the result, a call without arguments
+         * pushes it */
+        *outRequired = bytes[1];
+        *outEffect   = bytes[1] ? 1 - (int64_t)bytes[1] : 1;
+        break;
+
+    case CLOX_OP_CODE_INVK:
+        /* the receiver is the first argument */
+        if (!bytes[1])
+            return FALSE;
+
+        *outRequired = bytes[1];
+        *outEffect   = 1 - (int64_t)bytes[1];
+        break;
+
+    default:
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function checks the operands that reference the pools of a
+ *              block (the constants, the names and the inline cache slots).
+ *
+ * @return      TRUE if the operands are in range, otherwise FALSE.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_VerifierCheckOperands(const CloxCodeBlock_t *const codeBlock, const byte_t *const bytes)
+{
+    switch (bytes[0])
+    {
+    case CLOX_OP_CODE_LEC:
+    case CLOX_OP_CODE_LEA:
+        return (bool_t)(cloxDecodeOpHalf(bytes + 2) < codeBlock->constantsCount);
+
+    case CLOX_OP_CODE_LECW:
+    case CLOX_OP_CODE_LEAW:
+        return (bool_t)(cloxDecodeOpWord(bytes + 2) < codeBlock->constantsCount);
+
+    case CLOX_OP_CODE_LDG:
+    case CLOX_OP_CODE_STG:
+    case CLOX_OP_CODE_NCALL:
+    case CLOX_OP_CODE_GETP:
+    case CLOX_OP_CODE_SETP:
+    case CLOX_OP_CODE_INVK:
+        return (bool_t)((cloxDecodeOpHalf(bytes + 2) < codeBlock->namesSize) && (cloxDecodeOpHalf(bytes + 4) < codeBlock->cachesCount));
+
+    default:
+        return TRUE;
+    }
+}
+
+/**
+ * @brief       This function raises the number of arguments of a procedure, so
+ *              that an instruction reading the specified number of values at
+ *              the specified depth doesn't underflow the evaluation stack.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_VerifierRequire(CloxVerifier_t *const verifier, const size_t procedure, const int64_t depth, const int64_t required)
+{
+    CloxVerifierProcedure_t *const summary = &verifier->procedures[procedure];
+
+    if ((required - depth) > summary->arguments)
+    {
+        summary->arguments = required - depth;
+        verifier->changed  = TRUE;
+    }
+
+    return;
+}
+
+/**
+ * @brief       This function records a return of a procedure.
+ *
+ * @return      TRUE on success, FALSE if the procedure returns at another
+ *              depth elsewhere.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_VerifierReturn(CloxVerifier_t *const verifier, const size_t procedure, const int64_t depth)
+{
+    CloxVerifierProcedure_t *const summary = &verifier->procedures[procedure];
+
+    if (!summary->returns)
+    {
+        summary->returns  = TRUE;
+        summary->results  = depth;
+        verifier->changed = TRUE;
+
+        return TRUE;
+    }
+
+    return (bool_t)(summary->results == depth);
+}
+
+/**
+ * @brief       This function reaches an instruction from a procedure at the
+ *              specified depth.
+ *
+ * @return      TRUE on success, FALSE if the instruction has been reached by
+ *              another procedure or at another depth.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_VerifierVisit(CloxVerifier_t *const verifier, const size_t procedure, const size_t index, const int64_t depth)
+{
+    /* the end of the block stops the execution */
+    if (index >= verifier->count)
+        return TRUE;
+
+    CloxVerifierInstruction_t *const instruction = &verifier->instructions[index];
+
+    if (instruction->procedure == SIZE_MAX)
+    {
+        if ((depth > INT32_MAX) || (depth < -INT32_MAX))
+            return FALSE;
+
+        instruction->procedure = procedure;
+        instruction->depth     = depth;
+
+        verifier->pending[verifier->pendingCount++] = index;
+
+        return TRUE;
+    }
+
+    return (bool_t)((instruction->procedure == procedure) && (instruction->depth == depth));
+}
+
+/**
+ * @brief       This function follows a procedure from its entry, with the
+ *              summaries of its callees known so far: the instructions after a
+ *              call to a procedure that doesn't return yet are not reached.
+ *
+ * @return      TRUE on success, FALSE if the procedure is not well formed.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_VerifierWalk(CloxVerifier_t *const verifier, const size_t procedure)
+{
+    verifier->pendingCount = 0;
+
+    if (!clox_VerifierVisit(verifier, procedure, verifier->procedures[procedure].entry, 0))
+        return FALSE;
+
+    while (verifier->pendingCount)
+    {
+        CLOX_REGISTER const size_t index = verifier->pending[--verifier->pendingCount];
+
+        const CloxVerifierInstruction_t *const instruction = &verifier->instructions[index];
+        const byte_t *const bytes = verifier->codeBlock->array + instruction->offset;
+
+        CLOX_REGISTER const int64_t depth = instruction->depth;
+
+        int64_t required, effect;
+
+        clox_VerifierStackEffect(bytes, &required, &effect);
+        clox_VerifierRequire(verifier, procedure, depth, required);
+
+        if ((bytes[0] == CLOX_OP_CODE_CALL) || (bytes[0] == CLOX_OP_CODE_TCALL))
+        {
+            CLOX_REGISTER const size_t callee = verifier->instructions[instruction->target].entry;
+
+            /* the callee reads its arguments below the depth of the call */
+            clox_VerifierRequire(verifier, procedure, depth, verifier->procedures[callee].arguments);
+
+            if (!verifier->procedures[callee].returns)
+                continue;
+
+            effect = verifier->procedures[callee].results;
+
+            /* the callee of a tail call returns in place of the caller */
+            if (bytes[0] == CLOX_OP_CODE_TCALL)
+            {
+                if (!clox_VerifierReturn(verifier, procedure, depth + effect))
+                    return FALSE;
+            }
+            else if (!clox_VerifierVisit(verifier, procedure, index + 1, depth + effect))
+            {
+                return FALSE;
+            }
+
+            continue;
+        }
+
+        if (bytes[0] == CLOX_OP_CODE_RET)
+        {
+            if (!clox_VerifierReturn(verifier, procedure, depth))
+                return FALSE;
+
+            continue;
+        }
+
+        if ((instruction->target != SIZE_MAX) && !clox_VerifierVisit(verifier, procedure, instruction->target, depth + effect))
+            return FALSE;
+
+        /* the execution suspended by a 'break' or a 'raise' resumes checking
+         * the depth of the stack again, so it may fall into the code of the
+         * next procedure (like the top-level code does before them) */
+        if (((bytes[0] == CLOX_OP_CODE_BREAK) || (bytes[0] == CLOX_OP_CODE_RAISE))
+         && ((index + 1) < verifier->count) && (verifier->instructions[index + 1].entry != SIZE_MAX) && (verifier->instructions[index + 1].entry != procedure))
+            continue;
+
+        if (clox_VerifierFallsThrough(bytes[0]) && !clox_VerifierVisit(verifier, procedure, index + 1, depth + effect))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxCodeBlockVerify(CloxCodeBlock_t *const codeBlock)
+{
+    assert(codeBlock != NULL);
+
+    CLOX_REGISTER size_t i, n, offset;
+
+    CloxVerifier_t verifier;
+    size_t *indexes, pass;
+    int32_t *depths;
+    bool_t verified = FALSE;
+
+    if (codeBlock->depths)
+        return TRUE;
+
+    if (codeBlock->frozen || (codeBlock->count >= UINT32_MAX))
+        return FALSE;
+
+    /* the names are read as strings, the last one must be terminated */
+    if (codeBlock->namesSize && codeBlock->names[codeBlock->namesSize - 1])
+        return FALSE;
+
+    verifier.codeBlock       = codeBlock;
+    verifier.instructions    = dim(CloxVerifierInstruction_t, codeBlock->count + 1);
+    verifier.procedures      = dim(CloxVerifierProcedure_t, codeBlock->count + 1);
+    verifier.pending         = dim(size_t, codeBlock->count + 1);
+    verifier.proceduresCount = 0;
+    verifier.pendingCount    = 0;
+
+    /* like in the peephole pass, indexes maps each offset to the index of the
+     * instruction starting there (SIZE_MAX when inside an instruction) */
+    indexes = dim(size_t, codeBlock->count + 1);
+
+    for (offset = 0; offset <= codeBlock->count; offset++)
+        indexes[offset] = SIZE_MAX;
+
+    for (n = 0, offset = 0; offset < codeBlock->count; n++)
+    {
+        const byte_t *const bytes = codeBlock->array + offset;
+        CloxOpCodeInfo_t opCodeInfo;
+        int64_t required, effect;
+
+        if (!cloxGetOpCodeInfo(bytes[0], &opCodeInfo) || ((offset + cloxGetOpKindSize(opCodeInfo.kind)) > codeBlock->count))
+            goto l_release;
+
+        if (!clox_VerifierStackEffect(bytes, &required, &effect) || !clox_VerifierCheckOperands(codeBlock, bytes))
+            goto l_release;
+
+        verifier.instructions[n].offset    = offset;
+        verifier.instructions[n].target    = SIZE_MAX;
+        verifier.instructions[n].entry     = SIZE_MAX;
+        verifier.instructions[n].procedure = SIZE_MAX;
+        verifier.instructions[n].depth     = 0;
+
+        indexes[offset] = n;
+        offset += cloxGetOpKindSize(opCodeInfo.kind);
+    }
+
+    indexes[codeBlock->count] = n;
+    verifier.count = n;
+
+    /* the top-level code is the first procedure */
+    verifier.procedures[verifier.proceduresCount++].entry = 0;
+
+    if (n)
+        verifier.instructions[0].entry = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        CloxVerifierInstruction_t *const instruction = &verifier.instructions[i];
+        const byte_t *const bytes = codeBlock->array + instruction->offset;
+        const size_t size = ((i + 1) < n ? verifier.instructions[i + 1].offset : codeBlock->count) - instruction->offset;
+        int64_t target;
+
+        if (!clox_VerifierGetTarget(bytes, instruction->offset, size, &target))
+            continue;
+
+        if ((target < 0) || (target > (int64_t)codeBlock->count) || (indexes[target] == SIZE_MAX))
+            goto l_release;
+
+        instruction->target = indexes[target];
+
+        if ((bytes[0] != CLOX_OP_CODE_CALL) && (bytes[0] != CLOX_OP_CODE_TCALL))
+            continue;
+
+        /* a procedure begins with an instruction */
+        if (instruction->target >= n)
+            goto l_release;
+
+        if (verifier.instructions[instruction->target].entry == SIZE_MAX)
+        {
+            verifier.instructions[instruction->target].entry = verifier.proceduresCount;
+            verifier.procedures[verifier.proceduresCount++].entry = instruction->target;
+        }
+    }
+
+    for (i = 0; i < verifier.proceduresCount; i++)
+    {
+        verifier.procedures[i].arguments = 0;
+        verifier.procedures[i].results   = 0;
+        verifier.procedures[i].returns   = FALSE;
+    }
+
+    /* each pass follows all the procedures with the summaries found by the
+     * previous ones, until they don't change: the callees are summarized
+     * before their callers, a recursion once its base case returns. The
+     * summaries only grow, the ones that keep growing (like the arguments of
+     * a recursion that reads more and more values) are refused */
+    for (pass = 0; ; pass++)
+    {
+        if (pass > (2 * verifier.proceduresCount + 2))
+            goto l_release;
+
+        for (i = 0; i < n; i++)
+            verifier.instructions[i].procedure = SIZE_MAX;
+
+        verifier.changed = FALSE;
+
+        for (i = 0; i < verifier.proceduresCount; i++)
+            if (!clox_VerifierWalk(&verifier, i))
+                goto l_release;
+
+        if (!verifier.changed)
+            break;
+    }
+
+    /* the top-level code begins with an empty stack */
+    if (verifier.procedures[0].arguments)
+        goto l_release;
+
+    depths = dim(int32_t, n + 1);
+
+    for (i = 0; i < n; i++)
+        depths[i] = verifier.instructions[i].procedure ? CLOX_VERIFIER_DEPTH_UNKNOWN : (int32_t)verifier.instructions[i].depth;
+
+    depths[n] = CLOX_VERIFIER_DEPTH_UNKNOWN;
+
+    codeBlock->depths = depths;
+    verified = TRUE;
+
+l_release:
+    dealloc(indexes);
+    dealloc(verifier.pending);
+    dealloc(verifier.procedures);
+    dealloc(verifier.instructions);
+
+    return verified;
+}
@@ -0,0 +1,4375 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/clock.h"
+#include "clox/base/errno.h"
+#include "clox/base/thread.h"
+#include "clox/base/utils.h"
+#include "clox/vm/fiber.h"
+#include "clox/vm/verifier.h"
+#include "clox/vm/vm.h"
+
+#include <string.h>
+
+#ifndef CLOX_VM_ERROR_MESSAGE_UNKNOWN_OPCODE
+#   define CLOX_VM_ERROR_MESSAGE_UNKNOWN_OPCODE "unknown opcode"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_TRUNCATED_INSTRUCTION
+#   define CLOX_VM_ERROR_MESSAGE_TRUNCATED_INSTRUCTION "truncated instruction"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_JUMP_OUT_OF_BOUNDS
+#   define CLOX_VM_ERROR_MESSAGE_JUMP_OUT_OF_BOUNDS "jump out of bounds"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_INVALID_OPERANDS
+#   define CLOX_VM_ERROR_MESSAGE_INVALID_OPERANDS "invalid operands"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_WINDOW_OVERFLOW
+#   define CLOX_VM_ERROR_MESSAGE_WINDOW_OVERFLOW "register window overflow"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_WINDOW_UNDERFLOW
+#   define CLOX_VM_ERROR_MESSAGE_WINDOW_UNDERFLOW "register window underflow"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_CALL_OVERFLOW
+#   define CLOX_VM_ERROR_MESSAGE_CALL_OVERFLOW "call stack overflow"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_CALL_UNDERFLOW
+#   define CLOX_VM_ERROR_MESSAGE_CALL_UNDERFLOW "call stack underflow"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_UNDEFINED_GLOBAL
+#   define CLOX_VM_ERROR_MESSAGE_UNDEFINED_GLOBAL "undefined global variable"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_UNDEFINED_NATIVE
+#   define CLOX_VM_ERROR_MESSAGE_UNDEFINED_NATIVE "undefined native function"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_WRONG_ARITY
+#   define CLOX_VM_ERROR_MESSAGE_WRONG_ARITY "wrong number of arguments"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_DIVISION_BY_ZERO
+#   define CLOX_VM_ERROR_MESSAGE_DIVISION_BY_ZERO "division by zero"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_UNDEFINED_PROPERTY
+#   define CLOX_VM_ERROR_MESSAGE_UNDEFINED_PROPERTY "undefined property"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_NOT_AN_INSTANCE
+#   define CLOX_VM_ERROR_MESSAGE_NOT_AN_INSTANCE "not an instance"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_NOT_A_METHOD
+#   define CLOX_VM_ERROR_MESSAGE_NOT_A_METHOD "not a method"
+#endif
+
+#ifndef CLOX_VM_ERROR_MESSAGE_OUT_OF_MEMORY
+#   define CLOX_VM_ERROR_MESSAGE_OUT_OF_MEMORY "out of memory"
+#endif
+
+/**
+ * @brief       The message native functions return to suspend the execution,
+ *              recognized by its address (see cloxVMYield).
+ */
+CLOX_STATIC const char clox_VMYieldMessage[] = "yield";
+
+/**
+ * @brief       This table stores the size (in bytes) of each instruction,
+ *              zero for unknown opcodes, used to reject truncated instructions
+ *              before fetching their operands.
+ */
+CLOX_STATIC const byte_t clox_OpCodeSizes[BYTE_MAX + 1] = {
+    [CLOX_OP_CODE_NOP] = cloxGetOpKindSize(CLOX_OP_KIND_BYTE),
+
+#define cloxDefineOpCode(opEnum, opCode, opName, opKind, opFunc) [opCode] = cloxGetOpKindSize(opKind),
+#include CLOX_VM_OPCODE_INC_
+};
+
+CLOX_INLINE bool_t CLOX_STDCALL clox_VMIsFalsey(const CloxValue_t *const value)
+{
+    return (cloxValueType(*value) == CLOX_VALUE_TYPE_VOID) || ((cloxValueType(*value) == CLOX_VALUE_TYPE_BOOL) && !cloxValueAsBool(*value));
+}
+
+/**
+ * @brief       This function gets the type on which an arithmetic operation
+ *              between two values is performed, following the promotion order
+ *              of numeric types (BYTE values are promoted to UINT ones).
+ *
+ * @return      The promoted type, or CLOX_VALUE_TYPE_VOID if at least one of
+ *              the values is not numeric.
+ */
+CLOX_INLINE CloxValueType_t CLOX_STDCALL clox_VMPromoteTypes(const CloxValueType_t xType, const CloxValueType_t yType)
+{
+    if (!hasflag(xType, CLOX_VALUE_FLAG_NUMERIC) || !hasflag(yType, CLOX_VALUE_FLAG_NUMERIC))
+        return CLOX_VALUE_TYPE_VOID;
+
+    CLOX_REGISTER const CloxValueType_t type = max(xType, yType);
+
+    return (type == CLOX_VALUE_TYPE_BYTE) ? CLOX_VALUE_TYPE_UINT : type;
+}
+
+CLOX_INLINE uint_t CLOX_STDCALL clox_VMToUInt(const CloxValue_t *const value)
+{
+    switch (cloxValueType(*value))
+    {
+    case CLOX_VALUE_TYPE_BYTE:
+        return (uint_t)cloxValueAsByte(*value);
+
+    case CLOX_VALUE_TYPE_SINT:
+        return (uint_t)cloxValueAsSInt(*value);
+
+    case CLOX_VALUE_TYPE_REAL:
+        return (uint_t)cloxValueAsReal(*value);
+
+    default:
+        return cloxValueAsUInt(*value);
+    }
+}
+
+CLOX_INLINE sint_t CLOX_STDCALL clox_VMToSInt(const CloxValue_t *const value)
+{
+    switch (cloxValueType(*value))
+    {
+    case CLOX_VALUE_TYPE_BYTE:
+        return (sint_t)cloxValueAsByte(*value);
+
+    case CLOX_VALUE_TYPE_UINT:
+        return (sint_t)cloxValueAsUInt(*value);
+
+    case CLOX_VALUE_TYPE_REAL:
+        return (sint_t)cloxValueAsReal(*value);
+
+    default:
+        return cloxValueAsSInt(*value);
+    }
+}
+
+CLOX_INLINE real_t CLOX_STDCALL clox_VMToReal(const CloxValue_t *const value)
+{
+    switch (cloxValueType(*value))
+    {
+    case CLOX_VALUE_TYPE_BYTE:
+        return (real_t)cloxValueAsByte(*value);
+
+    case CLOX_VALUE_TYPE_UINT:
+        return (real_t)cloxValueAsUInt(*value);
+
+    case CLOX_VALUE_TYPE_SINT:
+        return (real_t)cloxValueAsSInt(*value);
+
+    default:
+        return cloxValueAsReal(*value);
+    }
+}
+
+/**
+ * @brief       This function performs an arithmetic operation between two
+ *              values, storing the result into the first one. Since the opcode
+ *              is always a constant, after inlining only the selected operation
+ *              remains.
+ *
+ * @return      On success NULL, otherwise the runtime error message.
+ */
+CLOX_INLINE const char *CLOX_STDCALL clox_VMArithmetic(const CloxOpCode_t opCode, CloxValue_t *const x, const CloxValue_t *const y)
+{
+    switch (clox_VMPromoteTypes(cloxValueType(*x), cloxValueType(*y)))
+    {
+    case CLOX_VALUE_TYPE_UINT:
+    {
+        CLOX_REGISTER const uint_t a = clox_VMToUInt(x), b = clox_VMToUInt(y);
+
+        switch (opCode)
+        {
+        case CLOX_OP_CODE_ADD:
+            *x = cloxUIntValue(a + b);
+            break;
+
+        case CLOX_OP_CODE_SUB:
+            *x = cloxUIntValue(a - b);
+            break;
+
+        case CLOX_OP_CODE_MUL:
+            *x = cloxUIntValue(a * b);
+            break;
+
+        default:
+            if (!b)
+                return CLOX_VM_ERROR_MESSAGE_DIVISION_BY_ZERO;
+
+            *x = cloxUIntValue(a / b);
+            break;
+        }
+
+        return NULL;
+    }
+
+    case CLOX_VALUE_TYPE_SINT:
+    {
+        CLOX_REGISTER const sint_t a = clox_VMToSInt(x), b = clox_VMToSInt(y);
+
+        switch (opCode)
+        {
+        case CLOX_OP_CODE_ADD:
+            *x = cloxSIntValue(a + b);
+            break;
+
+        case CLOX_OP_CODE_SUB:
+            *x = cloxSIntValue(a - b);
+            break;
+
+        case CLOX_OP_CODE_MUL:
+            *x = cloxSIntValue(a * b);
+            break;
+
+        default:
+            if (!b)
+                return CLOX_VM_ERROR_MESSAGE_DIVISION_BY_ZERO;
+
+            *x = cloxSIntValue(a / b);
+            break;
+        }
+
+        return NULL;
+    }
+
+    case CLOX_VALUE_TYPE_REAL:
+    {
+        CLOX_REGISTER const real_t a = clox_VMToReal(x), b = clox_VMToReal(y);
+
+        switch (opCode)
+        {
+        case CLOX_OP_CODE_ADD:
+            *x = cloxRealValue(a + b);
+            break;
+
+        case CLOX_OP_CODE_SUB:
+            *x = cloxRealValue(a - b);
+            break;
+
+        case CLOX_OP_CODE_MUL:
+            *x = cloxRealValue(a * b);
+            break;
+
+        default:
+            *x = cloxRealValue(a / b);
+            break;
+        }
+
+        return NULL;
+    }
+
+    default:
+        return CLOX_VM_ERROR_MESSAGE_INVALID_OPERANDS;
+    }
+}
+
+/**
+ * @brief       This function compares two values.
+ *
+ * @return      The value of the comparison flag: 0 if the values are equal,
+ *              1 if the first is less than the second, 2 if the first is
+ *              greater than the second and 3 if they are not comparable.
+ */
+CLOX_INLINE byte_t CLOX_STDCALL clox_VMCompare(const CloxValue_t *const x, const CloxValue_t *const y)
+{
+    switch (clox_VMPromoteTypes(cloxValueType(*x), cloxValueType(*y)))
+    {
+    case CLOX_VALUE_TYPE_UINT:
+    {
+        CLOX_REGISTER const uint_t a = clox_VMToUInt(x), b = clox_VMToUInt(y);
+
+        return (a == b) ? 0 : (a < b) ? 1 : 2;
+    }
+
+    case CLOX_VALUE_TYPE_SINT:
+    {
+        CLOX_REGISTER const sint_t a = clox_VMToSInt(x), b = clox_VMToSInt(y);
+
+        return (a == b) ? 0 : (a < b) ? 1 : 2;
+    }
+
+    case CLOX_VALUE_TYPE_REAL:
+    {
+        CLOX_REGISTER const real_t a = clox_VMToReal(x), b = clox_VMToReal(y);
+
+        return (a == b) ? 0 : (a < b) ? 1 : (a > b) ? 2 : 3;
+    }
+
+    default:
+        break;
+    }
+
+    if (cloxValueType(*x) != cloxValueType(*y))
+        return 3;
+
+    switch (cloxValueType(*x))
+    {
+    case CLOX_VALUE_TYPE_VOID:
+        return 0;
+
+    case CLOX_VALUE_TYPE_BOOL:
+        return (asBool(cloxValueAsBool(*x)) == asBool(cloxValueAsBool(*y))) ? 0 : 3;
+
+    case CLOX_VALUE_TYPE_VPTR:
+    case CLOX_VALUE_TYPE_OBJT:
+        return (cloxValueAsVPtr(*x) == cloxValueAsVPtr(*y)) ? 0 : 3;
+
+    default:
+        return 3;
+    }
+}
+
+/**
+ * @brief       This table maps each quickened opcode to the one it specializes,
+ *              zero for the opcodes of the bytecode.
+ */
+CLOX_STATIC const byte_t clox_QuickBaseOpCodes[BYTE_MAX + 1] = {
+#define cloxDefineQuickOpCode(opEnum, opCode, opBase, opFunc) [opCode] = opBase,
+#include CLOX_VM_QUICK_OPCODE_INC_
+};
+
+/**
+ * @brief       This function gets the opcode of the bytecode from which the
+ *              specified record opcode comes, so the JIT tier and the opcode
+ *              counters see quickened records as the instructions they were.
+ */
+CLOX_INLINE byte_t CLOX_STDCALL clox_VMBaseOpCode(const byte_t opCode)
+{
+    return clox_QuickBaseOpCodes[opCode] ? clox_QuickBaseOpCodes[opCode] : opCode;
+}
+
+/**
+ * @brief       This function selects the form of a quickened opcode for the
+ *              types of its operands.
+ *
+ * @return      The offset of the form from the SINT one: 0 when both values are
+ *              SINT, 1 when both are REAL and 2 (the generic form) otherwise.
+ */
+CLOX_INLINE byte_t CLOX_STDCALL clox_VMQuickForm(const CloxValue_t *const x, const CloxValue_t *const y)
+{
+    CLOX_REGISTER const CloxValueType_t type = cloxValueType(*x);
+
+    if (type != cloxValueType(*y))
+        return 2;
+
+    return (type == CLOX_VALUE_TYPE_SINT) ? 0 : (type == CLOX_VALUE_TYPE_REAL) ? 1 : 2;
+}
+
+/**
+ * @brief       This function is the guard of the specialized forms: it checks
+ *              that both values have the type for which the form has been
+ *              selected.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_VMQuickGuard(const CloxValueType_t type, const CloxValue_t *const x, const CloxValue_t *const y)
+{
+    return (bool_t)((cloxValueType(*x) == type) & (cloxValueType(*y) == type));
+}
+
+/**
+ * @brief       This function performs an arithmetic operation between two
+ *              values of the specified type (checked by the guard), storing the
+ *              result into z. The results are the ones of clox_VMArithmetic.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_VMQuickArithmetic(const CloxOpCode_t opCode, const CloxValueType_t type, CloxValue_t *const z, const CloxValue_t *const x, const CloxValue_t *const y)
+{
+    if (type == CLOX_VALUE_TYPE_SINT)
+    {
+        CLOX_REGISTER const sint_t a = cloxValueAsSInt(*x), b = cloxValueAsSInt(*y);
+
+        *z = cloxSIntValue((opCode == CLOX_OP_CODE_ADD) ? (a + b) : (opCode == CLOX_OP_CODE_SUB) ? (a - b) : (a * b));
+    }
+    else
+    {
+        CLOX_REGISTER const real_t a = cloxValueAsReal(*x), b = cloxValueAsReal(*y);
+
+        *z = cloxRealValue((opCode == CLOX_OP_CODE_ADD) ? (a + b) : (opCode == CLOX_OP_CODE_SUB) ? (a - b) : (a * b));
+    }
+
+    return;
+}
+
+/**
+ * @brief       This function compares two values of the specified type (checked
+ *              by the guard) without branches.
+ *
+ * @return      The value of the comparison flag, as clox_VMCompare.
+ */
+CLOX_INLINE byte_t CLOX_STDCALL clox_VMQuickCompare(const CloxValueType_t type, const CloxValue_t *const x, const CloxValue_t *const y)
+{
+    if (type == CLOX_VALUE_TYPE_SINT)
+    {
+        CLOX_REGISTER const sint_t a = cloxValueAsSInt(*x), b = cloxValueAsSInt(*y);
+
+        return (byte_t)((a < b) | ((a > b) << 1));
+    }
+    else
+    {
+        CLOX_REGISTER const real_t a = cloxValueAsReal(*x), b = cloxValueAsReal(*y);
+
+        /* unordered values (NaNs) are not comparable */
+        return (byte_t)((a < b) | ((a > b) << 1) | (((a != a) | (b != b)) * 3));
+    }
+}
+
+/**
+ * @brief       This function rewrites the specified record into a quickened
+ *              opcode. Since every form of a record gives the same results for
+ *              any operand, the virtual machines sharing a frozen block may see
+ *              the stores in any order.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_VMQuicken(const CloxDecodedInstruction_t *const record, const byte_t opCode, const void *const handler)
+{
+    /* the records are allocated on the heap, only the interpreter sees them as
+     * constants */
+    CloxDecodedInstruction_t *const target = (CloxDecodedInstruction_t *)record;
+
+    cloxAtomicStoreRelaxedPointer(&target->handler, handler);
+    cloxAtomicStoreRelaxedByte(&target->opCode, opCode);
+
+    return;
+}
+
+#if CLOX_VM_COMPUTED_GOTO
+/**
+ * @brief       This macro marks the beginning of an instruction handler.
+ */
+#   define clox_VMHandler(opEnum, opFunc) opFunc:
+/**
+ * @brief       This macro marks the beginning of the handler of opcodes not
+ *              listed in the opcodes table.
+ */
+#   define clox_VMDefaultHandler() _op_unknown:
+/**
+ * @brief       This macro fetches the next instruction and jumps directly to
+ *              its handler, so that each handler has its own indirect branch.
+ *              The table stores the distances of the handlers from the one of
+ *              unknown opcodes, so its missing slots select that handler.
+ */
+#   define clox_VMDispatch()         \
+    do                               \
+    {                                \
+        clox_VMFetch();              \
+        goto *(&&_op_unknown + dispatchTable[*ip++]); \
+    } while (0)
+#else
+/**
+ * @brief       This macro marks the beginning of an instruction handler.
+ */
+#   define clox_VMHandler(opEnum, opFunc) case opEnum:
+/**
+ * @brief       This macro marks the beginning of the handler of opcodes not
+ *              listed in the opcodes table.
+ */
+#   define clox_VMDefaultHandler() default:
+/**
+ * @brief       This macro goes back to the switch statement, that fetches
+ *              the next instruction.
+ */
+#   define clox_VMDispatch() continue
+#endif
+
+#if CLOX_VM_OPCODE_STATS
+/**
+ * @brief       This macro charges the cycles elapsed since the last dispatch
+ *              to the previous instruction, then starts timing the next one.
+ */
+#   define clox_VMCount()                                            \
+    do                                                              \
+    {                                                               \
+        if (lastOpCode >= 0)                                        \
+            clox_VMRecord(&vm->opCodeStats[lastOpCode], cloxClockCycles() - lastCycles); \
+                                                                    \
+        lastOpCode = (ip < end) ? (int)*ip : -1;                    \
+        lastCycles = cloxClockCycles();                             \
+    } while (0)
+#else
+/**
+ * @brief       This macro does nothing, opcode counters are compiled out.
+ */
+#   define clox_VMCount() ((void)0)
+#endif
+
+#if CLOX_VM_TRACE
+/**
+ * @brief       This macro records the next instruction into the attached trace
+ *              (if any).
+ */
+#   define clox_VMTrace()                                            \
+    do                                                              \
+    {                                                               \
+        if (vm->trace)                                              \
+            clox_VMTraceRecord(vm->trace, (size_t)(ip - begin), *ip, stack, sp); \
+    } while (0)
+#else
+/**
+ * @brief       This macro does nothing, the trace is compiled out.
+ */
+#   define clox_VMTrace() ((void)0)
+#endif
+
+/**
+ * @brief       This macro checks that the next instruction is entirely stored
+ *              into the block, terminating the execution at its end.
+ */
+#define clox_VMFetch()                                          \
+    do                                                          \
+    {                                                           \
+        clox_VMCount();                                         \
+                                                                \
+        if (ip >= end)                                          \
+            goto l_end;                                         \
+                                                                \
+        if ((size_t)(end - ip) < clox_OpCodeSizes[*ip])         \
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_TRUNCATED_INSTRUCTION); \
+                                                                \
+        clox_VMTrace();                                         \
+    } while (0)
+
+#define clox_VMError(message) \
+    do                        \
+    {                         \
+        error = (message);    \
+        goto l_error;         \
+    } while (0)
+
+#define clox_VMRequire(count)                                    \
+    do                                                           \
+    {                                                            \
+        if ((size_t)(sp - stack) < (count))                      \
+            clox_VMError(CLOX_ERROR_MESSAGE_STACK_UNDERFLOW);   \
+    } while (0)
+
+/**
+ * @brief       This macro checks the evaluation stack for the interpreter of
+ *              decoded blocks, which skips it when running the top-level code
+ *              of a verified block from the depth proven by the verifier.
+ */
+#define clox_VMDecodedRequire(count)                             \
+    do                                                           \
+    {                                                            \
+        if (checked)                                             \
+            clox_VMRequire(count);                               \
+    } while (0)
+
+/**
+ * @brief       This macro makes room on the evaluation stack, growing it up to
+ *              its limit (the stack may move, so sp is rebased).
+ */
+#define clox_VMReserve(count)                                    \
+    do                                                           \
+    {                                                            \
+        if ((size_t)(stackEnd - sp) < (count))                   \
+        {                                                        \
+            CLOX_REGISTER const size_t _depth = (size_t)(sp - stack); \
+                                                                 \
+            if (!clox_VMGrowStack(vm, _depth + (count)))         \
+                clox_VMError(CLOX_ERROR_MESSAGE_STACK_OVERFLOW); \
+                                                                 \
+            stack    = vm->stack;                                \
+            stackEnd = vm->stack + vm->stackSize;                \
+            sp       = stack + _depth;                           \
+        }                                                        \
+    } while (0)
+
+/**
+ * @brief       This macro takes a step of the running collection on backward
+ *              jumps, so that loops which don't allocate still let it finish,
+ *              and ticks the profiler on backward jumps and calls.
+ */
+#define clox_VMSafepoint(target, hot)                            \
+    do                                                           \
+    {                                                            \
+        if ((target) <= ip)                                      \
+        {                                                        \
+            if (vm->heap.phase != CLOX_HEAP_PHASE_IDLE)          \
+            {                                                    \
+                vm->stackTop = sp;                               \
+                cloxHeapStep(&vm->heap);                         \
+            }                                                    \
+                                                                 \
+            clox_VMProfile((size_t)((target) - begin));          \
+        }                                                        \
+        else if (hot)                                            \
+        {                                                        \
+            clox_VMProfile((size_t)((target) - begin));          \
+        }                                                        \
+    } while (0)
+
+/**
+ * @brief       This macro moves the instruction pointer to the specified offset
+ *              from the beginning of the block, checking that it doesn't fall
+ *              out of the block (the end of the block is a valid target).
+ */
+#define clox_VMTransferTo(position, hot)                         \
+    do                                                           \
+    {                                                            \
+        CLOX_REGISTER const int64_t _position = (position);      \
+                                                                 \
+        if ((_position < 0) || (_position > (end - begin)))      \
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_JUMP_OUT_OF_BOUNDS); \
+                                                                 \
+        clox_VMSafepoint(begin + _position, hot);                \
+                                                                 \
+        ip = begin + _position;                                  \
+    } while (0)
+
+#define clox_VMJumpTo(position) clox_VMTransferTo(position, FALSE)
+
+/**
+ * @brief       This macro moves the instruction pointer to the target of a
+ *              call, which is a safepoint for the profiler whatever its
+ *              direction.
+ */
+#define clox_VMCallTo(position) clox_VMTransferTo(position, TRUE)
+
+/**
+ * @brief       This macro calls a native function on the last count values of
+ *              the evaluation stack, which are replaced by its result.
+ */
+#define clox_VMCallNative(native, count, require)                           \
+    do                                                                      \
+    {                                                                       \
+        CLOX_REGISTER const size_t _count = (count);                        \
+                                                                            \
+        require(_count);                                                    \
+                                                                            \
+        if (!_count)                                                        \
+        {                                                                   \
+            clox_VMReserve(1);                                              \
+            *sp++ = cloxVoidValue();                                        \
+        }                                                                   \
+                                                                            \
+        CloxValue_t *const _arguments = sp - (_count ? _count : 1);         \
+                                                                            \
+        /* the arguments stay reachable if the function allocates */        \
+        vm->stackTop = sp;                                                  \
+                                                                            \
+        if ((error = (native)->function(vm, _arguments, _count)) && (error != clox_VMYieldMessage)) \
+            goto l_error;                                                   \
+                                                                            \
+        sp = _arguments + 1;                                                \
+                                                                            \
+        /* the call is complete, the execution is suspended after it */     \
+        if (error)                                                          \
+            goto l_yield;                                                   \
+    } while (0)
+
+/**
+ * @brief       This macro defines the handler of a relative jump instruction,
+ *              the offset is relative to the next instruction.
+ */
+#define clox_VMJumpHandler(opEnum, opFunc, condition)                       \
+    clox_VMHandler(opEnum, opFunc)                                          \
+    {                                                                       \
+        CLOX_REGISTER const int32_t offset = (int32_t)cloxDecodeOpWord(ip); \
+                                                                            \
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_JUMP) - 1;                     \
+                                                                            \
+        if (condition)                                                      \
+            clox_VMJumpTo((ip - begin) + offset);                           \
+                                                                            \
+        clox_VMDispatch();                                                  \
+    }
+
+/**
+ * @brief       This macro defines the handler of an absolute branch instruction,
+ *              the address is an offset from the beginning of the block.
+ */
+#define clox_VMBranchHandler(opEnum, opFunc, condition)                     \
+    clox_VMHandler(opEnum, opFunc)                                          \
+    {                                                                       \
+        CLOX_REGISTER const uint32_t address = cloxDecodeOpWord(ip);        \
+                                                                            \
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_JUMP) - 1;                     \
+                                                                            \
+        if (condition)                                                      \
+            clox_VMJumpTo((int64_t)address);                                \
+                                                                            \
+        clox_VMDispatch();                                                  \
+    }
+
+#define clox_VMArithmeticHandler(opEnum, opFunc)                            \
+    clox_VMHandler(opEnum, opFunc)                                          \
+    {                                                                       \
+        clox_VMRequire(2);                                                  \
+                                                                            \
+        --sp;                                                               \
+                                                                            \
+        if ((error = clox_VMArithmetic(opEnum, sp - 1, sp)))                \
+            goto l_error;                                                   \
+                                                                            \
+        clox_VMDispatch();                                                  \
+    }
+
+/**
+ * @brief       This macro defines the handler of an arithmetic instruction
+ *              between registers, which stores into Z the result of X and Y.
+ */
+#define clox_VMRegisterArithmeticHandler(opEnum, opFunc, opArithmetic)      \
+    clox_VMHandler(opEnum, opFunc)                                          \
+    {                                                                       \
+        CloxValue_t result = window[ip[1]];                                 \
+                                                                            \
+        if ((error = clox_VMArithmetic(opArithmetic, &result, &window[ip[2]]))) \
+            goto l_error;                                                   \
+                                                                            \
+        window[ip[0]] = result;                                             \
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_REGS) - 1;                     \
+                                                                            \
+        clox_VMDispatch();                                                  \
+    }
+
+/**
+ * @brief       This macro defines the handler of a fused compare and jump
+ *              instruction, which compares the two values on the top of the
+ *              evaluation stack.
+ */
+#define clox_VMCompareJumpHandler(opEnum, opFunc, condition)                \
+    clox_VMHandler(opEnum, opFunc)                                          \
+    {                                                                       \
+        CLOX_REGISTER const int32_t offset = (int32_t)cloxDecodeOpWord(ip); \
+                                                                            \
+        clox_VMRequire(2);                                                  \
+                                                                            \
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_JUMP) - 1;                     \
+        sp -= 2;                                                            \
+        vm->cf = clox_VMCompare(sp, sp + 1);                                \
+                                                                            \
+        if (condition)                                                      \
+            clox_VMJumpTo((ip - begin) + offset);                           \
+                                                                            \
+        clox_VMDispatch();                                                  \
+    }
+
+/**
+ * @brief       This macro defines the handler of a fused compare and jump
+ *              instruction, which compares two registers.
+ */
+#define clox_VMRegisterCompareJumpHandler(opEnum, opFunc, condition)        \
+    clox_VMHandler(opEnum, opFunc)                                          \
+    {                                                                       \
+        CLOX_REGISTER const int16_t offset = (int16_t)cloxDecodeOpHalf(ip); \
+                                                                            \
+        vm->cf = clox_VMCompare(&window[ip[2]], &window[ip[4]]);            \
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_FULL) - 1;                     \
+                                                                            \
+        if (condition)                                                      \
+            clox_VMJumpTo((ip - begin) + offset);                           \
+                                                                            \
+        clox_VMDispatch();                                                  \
+    }
+
+/**
+ * @brief       This macro defines the handler of a fused constant arithmetic
+ *              instruction, which loads the constant into its register before
+ *              the operation (as the fused 'ldc' did).
+ */
+#define clox_VMConstantArithmeticHandler(opEnum, opFunc, opArithmetic)      \
+    clox_VMHandler(opEnum, opFunc)                                          \
+    {                                                                       \
+        CloxValue_t result;                                                 \
+                                                                            \
+        window[ip[2]] = cloxSIntValue((int16_t)cloxDecodeOpHalf(ip + 3));   \
+        result = window[ip[1]];                                             \
+                                                                            \
+        if ((error = clox_VMArithmetic(opArithmetic, &result, &window[ip[2]]))) \
+            goto l_error;                                                   \
+                                                                            \
+        window[ip[0]] = result;                                             \
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;                     \
+                                                                            \
+        clox_VMDispatch();                                                  \
+    }
+
+/**
+ * @brief       This function is the interpreter loop, it executes instructions
+ *              starting from the current instruction pointer of the virtual
+ *              machine until the end of the block, a status control opcode or
+ *              a runtime error.
+ */
+/**
+ * @brief       This function is the slow path of the global instructions: it
+ *              looks up the variable named at the specified offset and fills
+ *              the inline cache slot with its entry.
+ *
+ * @return      TRUE if the variable is defined, otherwise FALSE.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_VMBindCache(CloxVM_t *const vm, const CloxCodeBlock_t *const codeBlock, const CloxTable_t *const table, CloxVMCache_t *const cache, const size_t name)
+{
+    if (!cache->key)
+    {
+        if (name >= codeBlock->namesSize)
+            return FALSE;
+
+        cache->key = cloxStringTableIntern(&vm->strings, codeBlock->names + name, strlen(codeBlock->names + name));
+    }
+
+    if (!(cache->entry = cloxTableFind(table, cache->key)))
+        return FALSE;
+
+    cache->epoch = table->epoch;
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function is the slow path of the native calls: it binds
+ *              the function named at the specified offset to the inline cache
+ *              slot, checking its arity once.
+ *
+ * @return      NULL on success, otherwise the message of the error.
+ */
+CLOX_STATIC const char *CLOX_STDCALL clox_VMBindNative(CloxVM_t *const vm, const CloxCodeBlock_t *const codeBlock, CloxVMCache_t *const cache, const size_t name, const size_t count)
+{
+    if (!clox_VMBindCache(vm, codeBlock, &vm->natives, cache, name))
+        return CLOX_VM_ERROR_MESSAGE_UNDEFINED_NATIVE;
+
+    cache->native = (const CloxVMNative_t *)cloxValueAsVPtr(cache->entry->value);
+
+    if ((cache->native->arity != CLOX_VM_NATIVE_VARIADIC) && (cache->native->arity != count))
+    {
+        cache->epoch = 0;
+        return CLOX_VM_ERROR_MESSAGE_WRONG_ARITY;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief       This function gets the instance object of a value.
+ *
+ * @return      A pointer to the object, or NULL if the value is not an
+ *              instance.
+ */
+CLOX_INLINE CloxObject_t *CLOX_STDCALL clox_VMAsInstance(const CloxValue_t value)
+{
+    if (cloxValueType(value) != CLOX_VALUE_TYPE_OBJT)
+        return NULL;
+
+    CloxObject_t *const object = cloxValueAsObject(value);
+
+    return (object->kind == CLOX_OBJECT_KIND_INSTANCE) ? object : NULL;
+}
+
+/**
+ * @brief       This function is the fast path of the property instructions: it
+ *              finds the entry of a shape in the inline cache slot.
+ *
+ * @return      A pointer to the entry, or NULL if the slot hasn't seen the
+ *              shape.
+ */
+CLOX_INLINE const CloxVMShapeCache_t *CLOX_STDCALL clox_VMFindShape(const CloxVMCache_t *const cache, const CloxShape_t *const shape)
+{
+    for (CLOX_REGISTER uint32_t i = 0; i < cache->shapesCount; i++)
+        if (cache->shapes[i].shape == shape)
+            return &cache->shapes[i];
+
+    return NULL;
+}
+
+/**
+ * @brief       This function is the slow path of the property instructions: it
+ *              looks up the property named at the specified offset in a shape
+ *              (when adding, it takes the transition if the shape doesn't have
+ *              it) and remembers the result into the inline cache slot, unless
+ *              the slot is full, then into the scratch entry.
+ *
+ * @return      A pointer to the entry, or NULL if the property is undefined.
+ */
+CLOX_STATIC const CloxVMShapeCache_t *CLOX_STDCALL clox_VMBindProperty(CloxVM_t *const vm, const CloxCodeBlock_t *const codeBlock, CloxVMCache_t *const cache, const size_t name, const CloxShape_t *const shape, const bool_t add, CloxVMShapeCache_t *const scratch)
+{
+    if (!cache->key)
+    {
+        if (name >= codeBlock->namesSize)
+            return NULL;
+
+        cache->key = cloxStringTableIntern(&vm->strings, codeBlock->names + name, strlen(codeBlock->names + name));
+    }
+
+    /* the megamorphic sites don't evict the shapes already seen, which stay
+     * the fast ones */
+    CloxVMShapeCache_t *const entry = (cache->shapesCount < CLOX_VM_CACHE_SHAPES) ? &cache->shapes[cache->shapesCount] : scratch;
+
+    CLOX_REGISTER const size_t index = cloxShapeLookup(shape, cache->key);
+
+    entry->shape = shape;
+
+    if (index != SIZE_MAX)
+    {
+        entry->target = shape;
+        entry->index  = index;
+    }
+    else if (add)
+    {
+        entry->target = cloxShapeTransition(&vm->shapes, shape, cache->key);
+        entry->index  = shape->count;
+    }
+    else
+    {
+        return NULL;
+    }
+
+    if (entry != scratch)
+        cache->shapesCount++;
+
+    return entry;
+}
+
+/**
+ * @brief       This function checks that the value of a property is a method,
+ *              so a native function of the virtual machine, with the right
+ *              arity. The pointer is compared to the ones of the table of the
+ *              natives before being followed.
+ *
+ * @return      NULL on success, otherwise the message of the error.
+ */
+CLOX_STATIC const char *CLOX_STDCALL clox_VMBindMethod(CloxVM_t *const vm, CloxVMCache_t *const cache, const CloxValue_t value, const size_t count)
+{
+    if (cloxValueType(value) != CLOX_VALUE_TYPE_VPTR)
+        return CLOX_VM_ERROR_MESSAGE_NOT_A_METHOD;
+
+    const CloxVMNative_t *const native = (const CloxVMNative_t *)cloxValueAsVPtr(value);
+    size_t i;
+
+    for (i = 0; i < vm->natives.capacity; i++)
+        if (vm->natives.entries[i].key && (cloxValueAsVPtr(vm->natives.entries[i].value) == (vptr_t)native))
+            break;
+
+    if (i >= vm->natives.capacity)
+        return CLOX_VM_ERROR_MESSAGE_NOT_A_METHOD;
+
+    if ((native->arity != CLOX_VM_NATIVE_VARIADIC) && (native->arity != count))
+        return CLOX_VM_ERROR_MESSAGE_WRONG_ARITY;
+
+    cache->native = native;
+    cache->epoch  = vm->natives.epoch;
+
+    return NULL;
+}
+
+#if CLOX_VM_OPCODE_STATS
+CLOX_INLINE void CLOX_STDCALL clox_VMRecord(CloxOpCodeStats_t *const stats, const uint64_t cycles)
+{
+    CLOX_REGISTER size_t bucket = 0;
+
+    while ((bucket < (CLOX_OP_CODE_HISTOGRAM_SIZE - 1)) && (cycles >> (bucket + 1)))
+        bucket++;
+
+    stats->count++;
+    stats->cycles += cycles;
+    stats->histogram[bucket]++;
+
+    return;
+}
+#endif
+
+#if CLOX_VM_TRACE
+/**
+ * @brief       This function appends to a trace the record of the instruction
+ *              about to be executed.
+ */
+CLOX_INLINE void CLOX_STDCALL clox_VMTraceRecord(CloxTrace_t *const trace, const size_t offset, const byte_t opCode, const CloxValue_t *const stack, const CloxValue_t *const sp)
+{
+    CLOX_REGISTER const size_t depth = (size_t)(sp - stack);
+
+    cloxTraceRecord(trace, (uint32_t)offset, opCode,
+        depth ? (byte_t)cloxValueType(sp[-1]) : (byte_t)CLOX_TRACE_TYPE_NONE,
+        (depth < UINT16_MAX) ? (uint16_t)depth : (uint16_t)UINT16_MAX);
+
+    return;
+}
+#endif
+
+/**
+ * @brief       This function records a sample of the call stack into the
+ *              profiler: the call sites of the frames, then the instruction at
+ *              the specified offset.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_VMSample(const CloxVM_t *const vm, const size_t offset)
+{
+    CLOX_REGISTER const size_t depth = vm->framesCount;
+
+    uint32_t *const offsets = cloxProfilerReserve(vm->profiler, depth + 1);
+
+    /* the return offset is past the call, the one before is still in it */
+    for (size_t i = 0; i < depth; i++)
+        offsets[i] = (uint32_t)(vm->frames[i].returnOffset - 1);
+
+    offsets[depth] = (uint32_t)offset;
+
+    cloxProfilerRecord(vm->profiler, vm->codeBlock, depth + 1);
+
+    return;
+}
+
+/**
+ * @brief       This macro samples the call stack if the profiler is due, at a
+ *              safepoint about to execute the instruction at the specified
+ *              offset.
+ */
+#define clox_VMProfile(offset)                                   \
+    do                                                           \
+    {                                                            \
+        if (vm->profiler && cloxProfilerTick(vm->profiler))      \
+            clox_VMSample(vm, (offset));                         \
+    } while (0)
+
+CLOX_STATIC void CLOX_STDCALL clox_VMMarkRoots(CloxHeap_t *const heap, void *const data)
+{
+    const CloxVM_t *const vm = (const CloxVM_t *)data;
+    CLOX_REGISTER const size_t registersCount = (size_t)(vm->window - vm->registers) + vm->windowSize;
+
+    for (size_t i = 0; i < registersCount; i++)
+        cloxHeapMarkValue(heap, &vm->registers[i]);
+
+    for (const CloxValue_t *value = vm->stack; value < vm->stackTop; value++)
+        cloxHeapMarkValue(heap, value);
+
+    for (size_t i = 0; i < vm->globals.capacity; i++)
+        if (vm->globals.entries[i].key)
+            cloxHeapMarkValue(heap, &vm->globals.entries[i].value);
+
+    if (vm->codeBlock)
+        for (size_t i = 0; i < vm->codeBlock->constantsCount; i++)
+            cloxHeapMarkValue(heap, &vm->codeBlock->constants[i]);
+
+    /* the contexts saved into the fibers, so the one of the virtual machine
+     * itself while a fiber runs */
+    for (const CloxFiber_t *fiber = vm->fibers; fiber; fiber = fiber->next)
+    {
+        CLOX_REGISTER const size_t count = (size_t)(fiber->window - fiber->registers) + fiber->windowSize;
+
+        for (size_t i = 0; i < count; i++)
+            cloxHeapMarkValue(heap, &fiber->registers[i]);
+
+        for (const CloxValue_t *value = fiber->stack; value < fiber->stackTop; value++)
+            cloxHeapMarkValue(heap, value);
+
+        if (fiber->codeBlock)
+            for (size_t i = 0; i < fiber->codeBlock->constantsCount; i++)
+                cloxHeapMarkValue(heap, &fiber->codeBlock->constants[i]);
+    }
+
+    return;
+}
+
+/**
+ * @brief       This function grows the evaluation stack, doubling its size,
+ *              until it can store the specified number of values.
+ *
+ * @note        The stack may move, the top of the stack is updated.
+ *
+ * @return      TRUE on success, FALSE if its limit has been reached.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_VMGrowStack(CloxVM_t *const vm, const size_t count)
+{
+    CLOX_REGISTER const size_t top = (size_t)(vm->stackTop - vm->stack);
+    CLOX_REGISTER size_t size = vm->stackSize ? vm->stackSize : 1;
+
+    if (count > vm->stackLimit)
+        return FALSE;
+
+    while (size < count)
+        size *= 2;
+
+    if (size > vm->stackLimit)
+        size = vm->stackLimit;
+
+    vm->stack     = redim(CloxValue_t, vm->stack, size);
+    vm->stackTop  = vm->stack + top;
+    vm->stackSize = size;
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function makes room for a window beginning at the specified
+ *              register: the stack of the saved windows grows by a chunk when
+ *              it's full, the register file grows until the window can address
+ *              CLOX_VM_REGISTERS_COUNT registers, so that register operands
+ *              never need to be checked.
+ *
+ * @note        The register file may move, the current window is updated.
+ *
+ * @return      TRUE on success, FALSE if a limit has been reached.
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_VMReserveWindow(CloxVM_t *const vm, const size_t base)
+{
+    CLOX_REGISTER const size_t current = (size_t)(vm->window - vm->registers);
+
+    if (vm->windowsCount >= vm->windowsCapacity)
+    {
+        if (vm->windowsCapacity >= CLOX_VM_WINDOWS_COUNT)
+            return FALSE;
+
+        vm->windowsCapacity += CLOX_VM_FRAMES_CHUNK;
+        vm->windows = redim(CloxVMWindow_t, vm->windows, vm->windowsCapacity);
+    }
+
+    if ((base + CLOX_VM_REGISTERS_COUNT) > vm->registersSize)
+    {
+        CLOX_REGISTER size_t size = vm->registersSize;
+
+        while ((base + CLOX_VM_REGISTERS_COUNT) > size)
+            size += CLOX_VM_REGISTER_FILE_SIZE;
+
+        if (size > CLOX_VM_REGISTER_FILE_MAX)
+            return FALSE;
+
+        vm->registers = redim(CloxValue_t, vm->registers, size);
+
+        for (size_t i = vm->registersSize; i < size; i++)
+            vm->registers[i] = cloxVoidValue();
+
+        vm->registersSize = size;
+        vm->window = vm->registers + current;
+    }
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function pushes a call frame, growing their stack by a
+ *              chunk when it's full.
+ *
+ * @return      A pointer to the new frame, or NULL on overflow.
+ */
+CLOX_STATIC CloxVMFrame_t *CLOX_STDCALL clox_VMPushFrame(CloxVM_t *const vm)
+{
+    if (vm->framesCount >= vm->framesCapacity)
+    {
+        if (vm->framesCapacity >= CLOX_VM_FRAMES_COUNT)
+            return NULL;
+
+        vm->framesCapacity += CLOX_VM_FRAMES_CHUNK;
+        vm->frames = redim(CloxVMFrame_t, vm->frames, vm->framesCapacity);
+    }
+
+    CloxVMFrame_t *const frame = &vm->frames[vm->framesCount++];
+
+    frame->windowsCount = vm->windowsCount;
+
+    return frame;
+}
+
+/**
+ * @brief       This function closes the windows saved after the specified
+ *              depth, moving the last count registers of the current window to
+ *              the last count registers of the window restored.
+ *
+ * @return      TRUE on success, FALSE if the windows can't be closed.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_VMUnwindWindows(CloxVM_t *const vm, const size_t windowsCount, const size_t count)
+{
+    if (windowsCount > vm->windowsCount)
+        return FALSE;
+    else if (windowsCount == vm->windowsCount)
+        return count <= vm->windowSize;
+
+    const CloxVMWindow_t *const window = &vm->windows[windowsCount];
+
+    if ((count > vm->windowSize) || (count > window->size))
+        return FALSE;
+
+    const CloxValue_t *const source = vm->window + vm->windowSize - count;
+
+    vm->window       = vm->registers + window->base;
+    vm->windowSize   = window->size;
+    vm->windowsCount = windowsCount;
+
+    memmove(vm->window + vm->windowSize - count, source, count * sizeof(CloxValue_t));
+
+    return TRUE;
+}
+
+/**
+ * @brief       This function searches the record of the instruction at the
+ *              specified offset of a decoded block.
+ *
+ * @return      The index of the record, or SIZE_MAX if no instruction begins at
+ *              that offset.
+ */
+CLOX_STATIC size_t CLOX_STDCALL clox_VMFindRecord(const CloxDecodedBlock_t *const decoded, const size_t offset)
+{
+    CLOX_REGISTER size_t low = 0, high;
+
+    /* the offsets are increasing, the last one is the end of the block */
+    for (high = decoded->count + 1; low < high;)
+    {
+        CLOX_REGISTER const size_t middle = low + (high - low) / 2;
+
+        if (decoded->offsets[middle] < offset)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return ((low <= decoded->count) && (decoded->offsets[low] == offset)) ? low : SIZE_MAX;
+}
+
+CLOX_STATIC CloxVMStatus_t CLOX_STDCALL clox_VMExecute(CloxVM_t *const vm)
+{
+#if CLOX_VM_COMPUTED_GOTO
+    CLOX_STATIC const int dispatchTable[BYTE_MAX + 1] = {
+        [CLOX_OP_CODE_NOP] = &&_op_nop - &&_op_unknown,
+
+#   define cloxDefineOpCode(opEnum, opCode, opName, opKind, opFunc) [opCode] = &&opFunc - &&_op_unknown,
+#   include CLOX_VM_OPCODE_INC_
+    };
+#endif
+
+    const CloxCodeBlock_t *const codeBlock = vm->codeBlock;
+
+    const byte_t *const begin = codeBlock->array;
+    const byte_t *const end   = codeBlock->array + codeBlock->count;
+
+    CloxValue_t *stack     = vm->stack;
+    CloxValue_t *stackEnd  = vm->stack + vm->stackSize;
+
+    CLOX_REGISTER const byte_t *ip = vm->ip;
+    CLOX_REGISTER CloxValue_t  *sp = vm->stackTop;
+    CLOX_REGISTER CloxValue_t  *window = vm->window;
+
+    CloxVMStatus_t status;
+    const char    *error;
+
+#if CLOX_VM_OPCODE_STATS
+    int      lastOpCode = -1;
+    uint64_t lastCycles = 0;
+#endif
+
+#if CLOX_VM_COMPUTED_GOTO
+    clox_VMDispatch();
+#else
+    for (;;)
+    {
+        clox_VMFetch();
+
+        switch (*ip++)
+        {
+#endif
+
+    clox_VMHandler(CLOX_OP_CODE_NOP, _op_nop)
+    {
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_BREAK, _op_break)
+    {
+        status = CLOX_VM_STATUS_BREAK;
+        goto l_halt;
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_ABORT, _op_abort)
+    {
+        status = CLOX_VM_STATUS_ABORT;
+        goto l_halt;
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_EXIT, _op_exit)
+    {
+        vm->exitCode = (int)(int16_t)cloxDecodeOpHalf(ip);
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_CTRL) - 1;
+
+        status = CLOX_VM_STATUS_SUCCESS;
+        goto l_halt;
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_RAISE, _op_raise)
+    {
+        vm->signal = (int)cloxDecodeOpHalf(ip);
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_CTRL) - 1;
+
+        status = CLOX_VM_STATUS_RAISE;
+        goto l_halt;
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_CALL, _op_call)
+    {
+        CLOX_REGISTER const int32_t offset = (int32_t)cloxDecodeOpWord(ip);
+        CloxVMFrame_t *const frame = clox_VMPushFrame(vm);
+
+        if (!frame)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_CALL_OVERFLOW);
+
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_JUMP) - 1;
+
+        frame->returnOffset = (size_t)(ip - begin);
+        frame->returnRecord = SIZE_MAX;
+
+        clox_VMCallTo((ip - begin) + offset);
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_TCALL, _op_tcall)
+    {
+        CLOX_REGISTER const int32_t offset = (int32_t)cloxDecodeOpWord(ip);
+        CLOX_REGISTER const size_t  count  = ip[4];
+        CLOX_REGISTER const size_t  depth  = vm->framesCount ? vm->frames[vm->framesCount - 1].windowsCount : 0;
+
+        if (!clox_VMUnwindWindows(vm, depth, count))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_WINDOW_UNDERFLOW);
+
+        window = vm->window;
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_JUMP) - 1;
+
+        clox_VMJumpTo((ip - begin) + offset);
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_RET, _op_ret)
+    {
+        if (!vm->framesCount)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_CALL_UNDERFLOW);
+
+        const CloxVMFrame_t *const frame = &vm->frames[--vm->framesCount];
+
+        if (!clox_VMUnwindWindows(vm, frame->windowsCount, 0))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_WINDOW_UNDERFLOW);
+
+        window = vm->window;
+
+        clox_VMJumpTo((int64_t)frame->returnOffset);
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_NCALL, _op_ncall)
+    {
+        CLOX_REGISTER const uint16_t y = cloxDecodeOpHalf(ip + 3);
+
+        if (y >= codeBlock->cachesCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        CloxVMCache_t *const cache = &vm->caches[y];
+
+        if ((cache->epoch != vm->natives.epoch) && (error = clox_VMBindNative(vm, codeBlock, cache, cloxDecodeOpHalf(ip + 1), ip[0])))
+            goto l_error;
+
+        clox_VMCallNative(cache->native, ip[0], clox_VMRequire);
+
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMJumpHandler(CLOX_OP_CODE_JMP, _op_jmp, TRUE)
+    clox_VMJumpHandler(CLOX_OP_CODE_JIT, _op_jit, !vm->zf)
+    clox_VMJumpHandler(CLOX_OP_CODE_JNT, _op_jnt, vm->zf)
+    clox_VMJumpHandler(CLOX_OP_CODE_JEQ, _op_jeq, vm->cf == 0)
+    clox_VMJumpHandler(CLOX_OP_CODE_JNE, _op_jne, vm->cf != 0)
+    clox_VMJumpHandler(CLOX_OP_CODE_JGT, _op_jgt, vm->cf == 2)
+    clox_VMJumpHandler(CLOX_OP_CODE_JGE, _op_jge, !(vm->cf & 1))
+    clox_VMJumpHandler(CLOX_OP_CODE_JLT, _op_jlt, vm->cf == 1)
+    clox_VMJumpHandler(CLOX_OP_CODE_JLE, _op_jle, vm->cf < 2)
+
+    clox_VMBranchHandler(CLOX_OP_CODE_BR,  _op_br,  TRUE)
+    clox_VMBranchHandler(CLOX_OP_CODE_BEQ, _op_beq, vm->cf == 0)
+    clox_VMBranchHandler(CLOX_OP_CODE_BNE, _op_bne, vm->cf != 0)
+    clox_VMBranchHandler(CLOX_OP_CODE_BGT, _op_bgt, vm->cf == 2)
+    clox_VMBranchHandler(CLOX_OP_CODE_BGE, _op_bge, !(vm->cf & 1))
+    clox_VMBranchHandler(CLOX_OP_CODE_BLT, _op_blt, vm->cf == 1)
+    clox_VMBranchHandler(CLOX_OP_CODE_BLE, _op_ble, vm->cf < 2)
+
+    clox_VMHandler(CLOX_OP_CODE_MOV, _op_mov)
+    {
+        CLOX_REGISTER const byte_t   z = ip[0];
+        CLOX_REGISTER const uint16_t x = cloxDecodeOpHalf(ip + 1);
+
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_DATA) - 1;
+
+        if (x & 0x8000)
+        {
+            /* the value at the specified distance from the top of the stack */
+            clox_VMRequire((size_t)(x & 0x7FFF) + 1);
+
+            window[z] = sp[-(ptrdiff_t)(x & 0x7FFF) - 1];
+        }
+        else
+        {
+            window[z] = window[(byte_t)x];
+        }
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_PSH, _op_psh)
+    {
+        clox_VMReserve(1);
+
+        *sp++ = window[*ip++];
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_POP, _op_pop)
+    {
+        clox_VMRequire(1);
+
+        window[*ip++] = *--sp;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_DUP, _op_dup)
+    {
+        clox_VMRequire(1);
+        clox_VMReserve(1);
+
+        sp[0] = sp[-1];
+        sp++;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_LDC, _op_ldc)
+    {
+        window[ip[0]] = cloxSIntValue((int16_t)cloxDecodeOpHalf(ip + 1));
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_DATA) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_LDA, _op_lda)
+    {
+        window[ip[0]] = cloxVPtrValue((vptr_t)(iptr_t)cloxDecodeOpHalf(ip + 1));
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_DATA) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_LEC, _op_lec)
+    {
+        CLOX_REGISTER const uint16_t x = cloxDecodeOpHalf(ip + 1);
+
+        if (x >= codeBlock->constantsCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        window[ip[0]] = codeBlock->constants[x];
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_DATA) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_LEA, _op_lea)
+    {
+        CLOX_REGISTER const uint16_t x = cloxDecodeOpHalf(ip + 1);
+
+        if (x >= codeBlock->constantsCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        window[ip[0]] = cloxVPtrValue((vptr_t)&codeBlock->constants[x]);
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_DATA) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_LECW, _op_lecw)
+    {
+        CLOX_REGISTER const uint32_t x = (uint32_t)cloxDecodeOpHalf(ip + 1) | ((uint32_t)cloxDecodeOpHalf(ip + 3) << 16);
+
+        if (x >= codeBlock->constantsCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        window[ip[0]] = codeBlock->constants[x];
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_LEAW, _op_leaw)
+    {
+        CLOX_REGISTER const uint32_t x = (uint32_t)cloxDecodeOpHalf(ip + 1) | ((uint32_t)cloxDecodeOpHalf(ip + 3) << 16);
+
+        if (x >= codeBlock->constantsCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        window[ip[0]] = cloxVPtrValue((vptr_t)&codeBlock->constants[x]);
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_LDG, _op_ldg)
+    {
+        CLOX_REGISTER const uint16_t y = cloxDecodeOpHalf(ip + 3);
+
+        if (y >= codeBlock->cachesCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        CloxVMCache_t *const cache = &vm->caches[y];
+
+        if ((cache->epoch != vm->globals.epoch) && !clox_VMBindCache(vm, codeBlock, &vm->globals, cache, cloxDecodeOpHalf(ip + 1)))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_GLOBAL);
+
+        window[ip[0]] = cache->entry->value;
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_STG, _op_stg)
+    {
+        CLOX_REGISTER const uint16_t y = cloxDecodeOpHalf(ip + 3);
+
+        if (y >= codeBlock->cachesCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        CloxVMCache_t *const cache = &vm->caches[y];
+
+        if ((cache->epoch != vm->globals.epoch) && !clox_VMBindCache(vm, codeBlock, &vm->globals, cache, cloxDecodeOpHalf(ip + 1)))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_GLOBAL);
+
+        cache->entry->value = window[ip[0]];
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_NEWO, _op_newo)
+    {
+        CloxObject_t *object;
+
+        /* the values on the stack stay reachable if the heap collects */
+        vm->stackTop = sp;
+
+        if (!(object = cloxNewInstance(&vm->heap, &vm->shapes, cloxDecodeOpHalf(ip + 1))))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_OUT_OF_MEMORY);
+
+        window[ip[0]] = cloxObjtValue(object);
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_DATA) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_GETP, _op_getp)
+    {
+        CLOX_REGISTER const uint16_t y = cloxDecodeOpHalf(ip + 3);
+
+        if (y >= codeBlock->cachesCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        clox_VMRequire(1);
+
+        CloxVMCache_t *const cache = &vm->caches[y];
+        CloxObject_t *const object = clox_VMAsInstance(sp[-1]);
+        const CloxVMShapeCache_t *entry;
+        CloxVMShapeCache_t scratch;
+
+        if (!object)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_NOT_AN_INSTANCE);
+
+        if (!(entry = clox_VMFindShape(cache, cloxInstanceShape(object))) && !(entry = clox_VMBindProperty(vm, codeBlock, cache, cloxDecodeOpHalf(ip + 1), cloxInstanceShape(object), FALSE, &scratch)))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_PROPERTY);
+
+        window[ip[0]] = *cloxInstanceField(object, entry->index);
+        sp--;
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_SETP, _op_setp)
+    {
+        CLOX_REGISTER const uint16_t y = cloxDecodeOpHalf(ip + 3);
+
+        if (y >= codeBlock->cachesCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        clox_VMRequire(1);
+
+        CloxVMCache_t *const cache = &vm->caches[y];
+        CloxObject_t *const object = clox_VMAsInstance(sp[-1]);
+        const CloxVMShapeCache_t *entry;
+        CloxVMShapeCache_t scratch;
+
+        if (!object)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_NOT_AN_INSTANCE);
+
+        if (!(entry = clox_VMFindShape(cache, cloxInstanceShape(object))) && !(entry = clox_VMBindProperty(vm, codeBlock, cache, cloxDecodeOpHalf(ip + 1), cloxInstanceShape(object), TRUE, &scratch)))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_PROPERTY);
+
+        if (entry->target == entry->shape)
+        {
+            cloxInstanceStore(&vm->heap, object, entry->index, window[ip[0]]);
+        }
+        else
+        {
+            /* the instance is still on the stack if the heap collects */
+            vm->stackTop = sp;
+
+            if (!cloxInstanceAppend(&vm->heap, object, entry->target, window[ip[0]]))
+                clox_VMError(CLOX_VM_ERROR_MESSAGE_OUT_OF_MEMORY);
+        }
+
+        sp--;
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_INVK, _op_invk)
+    {
+        CLOX_REGISTER const uint16_t y = cloxDecodeOpHalf(ip + 3);
+
+        if (y >= codeBlock->cachesCount)
+            clox_VMError(CLOX_ERROR_MESSAGE_INDEX_OUT_OF_BOUNDS);
+
+        /* the receiver is the first argument */
+        if (!ip[0])
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_INVALID_OPERANDS);
+
+        clox_VMRequire(ip[0]);
+
+        CloxVMCache_t *const cache = &vm->caches[y];
+        CloxObject_t *const object = clox_VMAsInstance(sp[-ip[0]]);
+        const CloxVMShapeCache_t *entry;
+        CloxVMShapeCache_t scratch;
+
+        if (!object)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_NOT_AN_INSTANCE);
+
+        if (!(entry = clox_VMFindShape(cache, cloxInstanceShape(object))) && !(entry = clox_VMBindProperty(vm, codeBlock, cache, cloxDecodeOpHalf(ip + 1), cloxInstanceShape(object), FALSE, &scratch)))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_PROPERTY);
+
+        const CloxValue_t method = *cloxInstanceField(object, entry->index);
+
+        if (((cloxValueType(method) != CLOX_VALUE_TYPE_VPTR) || (cache->epoch != vm->natives.epoch) || ((vptr_t)cache->native != cloxValueAsVPtr(method))) && (error = clox_VMBindMethod(vm, cache, method, ip[0])))
+            goto l_error;
+
+        clox_VMCallNative(cache->native, ip[0], clox_VMRequire);
+
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_ENT, _op_ent)
+    {
+        CLOX_REGISTER const size_t size    = cloxDecodeOpHalf(ip);
+        CLOX_REGISTER const size_t overlap = ip[2];
+
+        CLOX_REGISTER const size_t current = (size_t)(window - vm->registers);
+        CLOX_REGISTER const size_t base    = current + vm->windowSize - overlap;
+
+        if ((overlap > vm->windowSize) || (size > CLOX_VM_REGISTERS_COUNT) || !clox_VMReserveWindow(vm, base))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_WINDOW_OVERFLOW);
+
+        vm->windows[vm->windowsCount].base = current;
+        vm->windows[vm->windowsCount].size = vm->windowSize;
+        vm->windowsCount++;
+
+        window = vm->window = vm->registers + base;
+        vm->windowSize = size;
+
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_CTRL) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_LEV, _op_lev)
+    {
+        if (!vm->windowsCount)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_WINDOW_UNDERFLOW);
+
+        vm->windowsCount--;
+
+        window = vm->window = vm->registers + vm->windows[vm->windowsCount].base;
+        vm->windowSize = vm->windows[vm->windowsCount].size;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMArithmeticHandler(CLOX_OP_CODE_ADD, _op_add)
+    clox_VMArithmeticHandler(CLOX_OP_CODE_SUB, _op_sub)
+    clox_VMArithmeticHandler(CLOX_OP_CODE_MUL, _op_mul)
+    clox_VMArithmeticHandler(CLOX_OP_CODE_DIV, _op_div)
+
+    clox_VMHandler(CLOX_OP_CODE_NEG, _op_neg)
+    {
+        clox_VMRequire(1);
+
+        CloxValue_t *const x = sp - 1;
+
+        switch (clox_VMPromoteTypes(cloxValueType(*x), cloxValueType(*x)))
+        {
+        case CLOX_VALUE_TYPE_UINT:
+        case CLOX_VALUE_TYPE_SINT:
+            *x = cloxSIntValue(-clox_VMToSInt(x));
+            break;
+
+        case CLOX_VALUE_TYPE_REAL:
+            *x = cloxRealValue(-cloxValueAsReal(*x));
+            break;
+
+        default:
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_INVALID_OPERANDS);
+        }
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_NOT, _op_not)
+    {
+        clox_VMRequire(1);
+
+        sp[-1] = cloxBoolValue(clox_VMIsFalsey(sp - 1));
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_CMP, _op_cmp)
+    {
+        clox_VMRequire(2);
+
+        sp -= 2;
+        vm->cf = clox_VMCompare(sp, sp + 1);
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_TST, _op_tst)
+    {
+        clox_VMRequire(1);
+
+        vm->zf = (byte_t)clox_VMIsFalsey(--sp);
+
+        clox_VMDispatch();
+    }
+
+    clox_VMRegisterArithmeticHandler(CLOX_OP_CODE_RADD, _op_radd, CLOX_OP_CODE_ADD)
+    clox_VMRegisterArithmeticHandler(CLOX_OP_CODE_RSUB, _op_rsub, CLOX_OP_CODE_SUB)
+    clox_VMRegisterArithmeticHandler(CLOX_OP_CODE_RMUL, _op_rmul, CLOX_OP_CODE_MUL)
+    clox_VMRegisterArithmeticHandler(CLOX_OP_CODE_RDIV, _op_rdiv, CLOX_OP_CODE_DIV)
+
+    clox_VMHandler(CLOX_OP_CODE_RNEG, _op_rneg)
+    {
+        const CloxValue_t *const x = &window[ip[1]];
+
+        switch (clox_VMPromoteTypes(cloxValueType(*x), cloxValueType(*x)))
+        {
+        case CLOX_VALUE_TYPE_UINT:
+        case CLOX_VALUE_TYPE_SINT:
+            window[ip[0]] = cloxSIntValue(-clox_VMToSInt(x));
+            break;
+
+        case CLOX_VALUE_TYPE_REAL:
+            window[ip[0]] = cloxRealValue(-cloxValueAsReal(*x));
+            break;
+
+        default:
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_INVALID_OPERANDS);
+        }
+
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_REGS) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_RNOT, _op_rnot)
+    {
+        window[ip[0]] = cloxBoolValue(clox_VMIsFalsey(&window[ip[1]]));
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_REGS) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_RCMP, _op_rcmp)
+    {
+        vm->cf = clox_VMCompare(&window[ip[1]], &window[ip[2]]);
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_REGS) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMHandler(CLOX_OP_CODE_RTST, _op_rtst)
+    {
+        vm->zf = (byte_t)clox_VMIsFalsey(&window[ip[1]]);
+        ip += cloxGetOpKindSize(CLOX_OP_KIND_REGS) - 1;
+
+        clox_VMDispatch();
+    }
+
+    clox_VMCompareJumpHandler(CLOX_OP_CODE_CJEQ, _op_cjeq, vm->cf == 0)
+    clox_VMCompareJumpHandler(CLOX_OP_CODE_CJNE, _op_cjne, vm->cf != 0)
+    clox_VMCompareJumpHandler(CLOX_OP_CODE_CJGT, _op_cjgt, vm->cf == 2)
+    clox_VMCompareJumpHandler(CLOX_OP_CODE_CJGE, _op_cjge, !(vm->cf & 1))
+    clox_VMCompareJumpHandler(CLOX_OP_CODE_CJLT, _op_cjlt, vm->cf == 1)
+    clox_VMCompareJumpHandler(CLOX_OP_CODE_CJLE, _op_cjle, vm->cf < 2)
+
+    clox_VMRegisterCompareJumpHandler(CLOX_OP_CODE_RJEQ, _op_rjeq, vm->cf == 0)
+    clox_VMRegisterCompareJumpHandler(CLOX_OP_CODE_RJNE, _op_rjne, vm->cf != 0)
+    clox_VMRegisterCompareJumpHandler(CLOX_OP_CODE_RJGT, _op_rjgt, vm->cf == 2)
+    clox_VMRegisterCompareJumpHandler(CLOX_OP_CODE_RJGE, _op_rjge, !(vm->cf & 1))
+    clox_VMRegisterCompareJumpHandler(CLOX_OP_CODE_RJLT, _op_rjlt, vm->cf == 1)
+    clox_VMRegisterCompareJumpHandler(CLOX_OP_CODE_RJLE, _op_rjle, vm->cf < 2)
+
+    clox_VMConstantArithmeticHandler(CLOX_OP_CODE_RADC, _op_radc, CLOX_OP_CODE_ADD)
+    clox_VMConstantArithmeticHandler(CLOX_OP_CODE_RSBC, _op_rsbc, CLOX_OP_CODE_SUB)
+
+    clox_VMDefaultHandler()
+    {
+        --ip;
+        clox_VMError(CLOX_VM_ERROR_MESSAGE_UNKNOWN_OPCODE);
+    }
+
+#if !CLOX_VM_COMPUTED_GOTO
+        }
+    }
+#endif
+
+l_end:
+    status = CLOX_VM_STATUS_SUCCESS;
+    goto l_halt;
+
+l_yield:
+    /* the calls of native functions are long instructions */
+    ip += cloxGetOpKindSize(CLOX_OP_KIND_LONG) - 1;
+
+    status = CLOX_VM_STATUS_YIELD;
+    goto l_halt;
+
+l_error:
+    vm->error = error;
+    status = CLOX_VM_STATUS_ERROR;
+
+l_halt:
+#if CLOX_VM_OPCODE_STATS
+    if (lastOpCode >= 0)
+        clox_VMRecord(&vm->opCodeStats[lastOpCode], cloxClockCycles() - lastCycles);
+#endif
+
+    vm->ip       = ip;
+    vm->stackTop = sp;
+    vm->status   = status;
+
+    return status;
+}
+
+#if CLOX_VM_JIT
+/**
+ * @brief       This data structure provides the state shared by the stencils of
+ *              a compiled region: the registers of the decoded interpreter are
+ *              moved here while the region runs. The first members follow the
+ *              layout of CloxJitFrame_t, for the inline stencils.
+ */
+typedef struct _CloxVMJitState
+{
+    CloxValue_t           *sp;
+    CloxValue_t           *window;
+    CloxValue_t           *bottom;
+    CloxValue_t           *limit;
+    CloxVM_t              *vm;
+    const CloxCodeBlock_t *codeBlock;
+} CloxVMJitState_t;
+
+/* the operands of a stencil are the ones of its record, packed as stored */
+#   define clox_VMJitPack(record) ((uint64_t)(record)->z | ((uint64_t)(record)->x << 8) | ((uint64_t)(record)->y << 16) | ((uint64_t)(record)->operand << 32))
+#   define clox_VMJitZ(operands)       ((byte_t)(operands))
+#   define clox_VMJitX(operands)       ((byte_t)((operands) >> 8))
+#   define clox_VMJitY(operands)       ((byte_t)((operands) >> 16))
+#   define clox_VMJitOperand(operands) ((uint32_t)((operands) >> 32))
+
+/**
+ * @brief       This macro defines a stencil function. Stencils check the guards
+ *              of their instruction first, bailing out before any side effect
+ *              so that the interpreter executes it again and reports its error.
+ */
+#   define clox_VMJitStencil(name)                                          \
+    CLOX_STATIC int clox_VMJit##name(void *const _state, const uint64_t operands)
+
+#   define clox_VMJitGetState() CloxVMJitState_t *const state = (CloxVMJitState_t *)_state
+
+#   define clox_VMJitRequire(count)                                         \
+    do                                                                      \
+    {                                                                       \
+        if ((size_t)(state->sp - state->bottom) < (size_t)(count))          \
+            return CLOX_JIT_STATUS_BAIL;                                    \
+    } while (0)
+
+#   define clox_VMJitReserve(count)                                         \
+    do                                                                      \
+    {                                                                       \
+        if ((size_t)(state->limit - state->sp) < (size_t)(count))           \
+            return CLOX_JIT_STATUS_BAIL;                                    \
+    } while (0)
+
+/**
+ * @brief       This function takes a branch, with a step of the running
+ *              collection and a tick of the profiler when it jumps backward
+ *              (flagged into the lowest bit of the operand, the other ones
+ *              store the index of the target record).
+ */
+CLOX_INLINE int CLOX_STDCALL clox_VMJitTake(CloxVMJitState_t *const state, const uint64_t operands)
+{
+    CloxVM_t *const vm = state->vm;
+
+    if (clox_VMJitOperand(operands) & 1)
+    {
+        if (vm->heap.phase != CLOX_HEAP_PHASE_IDLE)
+        {
+            vm->stackTop = state->sp;
+            cloxHeapStep(&vm->heap);
+        }
+
+        clox_VMProfile(state->codeBlock->decoded.offsets[clox_VMJitOperand(operands) >> 1]);
+    }
+
+    return CLOX_JIT_STATUS_TAKEN;
+}
+
+clox_VMJitStencil(Mov)
+{
+    clox_VMJitGetState();
+
+    CLOX_REGISTER const uint16_t x = (uint16_t)clox_VMJitOperand(operands);
+
+    if (x & 0x8000)
+    {
+        clox_VMJitRequire((size_t)(x & 0x7FFF) + 1);
+
+        state->window[clox_VMJitZ(operands)] = state->sp[-(ptrdiff_t)(x & 0x7FFF) - 1];
+    }
+    else
+    {
+        state->window[clox_VMJitZ(operands)] = state->window[(byte_t)x];
+    }
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Psh)
+{
+    clox_VMJitGetState();
+    clox_VMJitReserve(1);
+
+    *state->sp++ = state->window[clox_VMJitZ(operands)];
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Pop)
+{
+    clox_VMJitGetState();
+    clox_VMJitRequire(1);
+
+    state->window[clox_VMJitZ(operands)] = *--state->sp;
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Dup)
+{
+    clox_VMJitGetState();
+    clox_VMJitRequire(1);
+    clox_VMJitReserve(1);
+
+    (void)operands;
+
+    state->sp[0] = state->sp[-1];
+    state->sp++;
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Ldc)
+{
+    clox_VMJitGetState();
+
+    state->window[clox_VMJitZ(operands)] = cloxSIntValue((int16_t)clox_VMJitOperand(operands));
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Lda)
+{
+    clox_VMJitGetState();
+
+    state->window[clox_VMJitZ(operands)] = cloxVPtrValue((vptr_t)(iptr_t)(uint16_t)clox_VMJitOperand(operands));
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Lec)
+{
+    clox_VMJitGetState();
+
+    state->window[clox_VMJitZ(operands)] = state->codeBlock->constants[clox_VMJitOperand(operands)];
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Lea)
+{
+    clox_VMJitGetState();
+
+    state->window[clox_VMJitZ(operands)] = cloxVPtrValue((vptr_t)&state->codeBlock->constants[clox_VMJitOperand(operands)]);
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+/* the globals are guarded by the epoch of their cache slots, the interpreter
+ * binds them again */
+clox_VMJitStencil(Ldg)
+{
+    clox_VMJitGetState();
+
+    const CloxVMCache_t *const cache = &state->vm->caches[clox_VMJitOperand(operands) >> 16];
+
+    if (cache->epoch != state->vm->globals.epoch)
+        return CLOX_JIT_STATUS_BAIL;
+
+    state->window[clox_VMJitZ(operands)] = cache->entry->value;
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Stg)
+{
+    clox_VMJitGetState();
+
+    const CloxVMCache_t *const cache = &state->vm->caches[clox_VMJitOperand(operands) >> 16];
+
+    if (cache->epoch != state->vm->globals.epoch)
+        return CLOX_JIT_STATUS_BAIL;
+
+    cache->entry->value = state->window[clox_VMJitZ(operands)];
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+#   define clox_VMJitArithmeticStencil(name, opArithmetic)                  \
+    clox_VMJitStencil(name)                                                 \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+        clox_VMJitRequire(2);                                               \
+                                                                            \
+        CloxValue_t result = state->sp[-2];                                 \
+                                                                            \
+        (void)operands;                                                     \
+                                                                            \
+        if (clox_VMArithmetic(opArithmetic, &result, state->sp - 1))        \
+            return CLOX_JIT_STATUS_BAIL;                                    \
+                                                                            \
+        state->sp[-2] = result;                                             \
+        state->sp--;                                                        \
+                                                                            \
+        return CLOX_JIT_STATUS_CONTINUE;                                    \
+    }
+
+#   define clox_VMJitRegisterArithmeticStencil(name, opArithmetic)          \
+    clox_VMJitStencil(name)                                                 \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+                                                                            \
+        CloxValue_t result = state->window[clox_VMJitX(operands)];          \
+                                                                            \
+        if (clox_VMArithmetic(opArithmetic, &result, &state->window[clox_VMJitY(operands)])) \
+            return CLOX_JIT_STATUS_BAIL;                                    \
+                                                                            \
+        state->window[clox_VMJitZ(operands)] = result;                      \
+                                                                            \
+        return CLOX_JIT_STATUS_CONTINUE;                                    \
+    }
+
+/* the constant is stored into y only once the operation cannot fail */
+#   define clox_VMJitConstantArithmeticStencil(name, opArithmetic)          \
+    clox_VMJitStencil(name)                                                 \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+                                                                            \
+        const CloxValue_t constant = cloxSIntValue((int16_t)(clox_VMJitOperand(operands) >> 16)); \
+        CloxValue_t result = (clox_VMJitX(operands) == clox_VMJitY(operands)) ? constant : state->window[clox_VMJitX(operands)]; \
+                                                                            \
+        if (clox_VMArithmetic(opArithmetic, &result, &constant))            \
+            return CLOX_JIT_STATUS_BAIL;                                    \
+                                                                            \
+        state->window[clox_VMJitY(operands)] = constant;                    \
+        state->window[clox_VMJitZ(operands)] = result;                      \
+                                                                            \
+        return CLOX_JIT_STATUS_CONTINUE;                                    \
+    }
+
+clox_VMJitArithmeticStencil(Add, CLOX_OP_CODE_ADD)
+clox_VMJitArithmeticStencil(Sub, CLOX_OP_CODE_SUB)
+clox_VMJitArithmeticStencil(Mul, CLOX_OP_CODE_MUL)
+clox_VMJitArithmeticStencil(Div, CLOX_OP_CODE_DIV)
+
+clox_VMJitRegisterArithmeticStencil(Radd, CLOX_OP_CODE_ADD)
+clox_VMJitRegisterArithmeticStencil(Rsub, CLOX_OP_CODE_SUB)
+clox_VMJitRegisterArithmeticStencil(Rmul, CLOX_OP_CODE_MUL)
+clox_VMJitRegisterArithmeticStencil(Rdiv, CLOX_OP_CODE_DIV)
+
+clox_VMJitConstantArithmeticStencil(Radc, CLOX_OP_CODE_ADD)
+clox_VMJitConstantArithmeticStencil(Rsbc, CLOX_OP_CODE_SUB)
+
+/**
+ * @brief       This macro defines the stencil of an arithmetic form specialized
+ *              for a type (see clox_VMDecodedQuickArithmeticHandler), which runs
+ *              the generic stencil when its guard fails.
+ */
+#   define clox_VMJitQuickArithmeticStencil(name, generic, opArithmetic, type, prologue, z, x, y, epilogue) \
+    clox_VMJitStencil(name)                                                 \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+        prologue;                                                           \
+                                                                            \
+        if (!clox_VMQuickGuard(type, x, y))                                 \
+            return clox_VMJit##generic(_state, operands);                   \
+                                                                            \
+        clox_VMQuickArithmetic(opArithmetic, type, z, x, y);                \
+        epilogue;                                                           \
+                                                                            \
+        return CLOX_JIT_STATUS_CONTINUE;                                    \
+    }
+
+#   define clox_VMJitQuickStackArithmeticStencils(name, opArithmetic)       \
+    clox_VMJitQuickArithmeticStencil(name##Sint, name, opArithmetic, CLOX_VALUE_TYPE_SINT, clox_VMJitRequire(2), state->sp - 2, state->sp - 2, state->sp - 1, state->sp--) \
+    clox_VMJitQuickArithmeticStencil(name##Real, name, opArithmetic, CLOX_VALUE_TYPE_REAL, clox_VMJitRequire(2), state->sp - 2, state->sp - 2, state->sp - 1, state->sp--)
+
+#   define clox_VMJitQuickRegisterArithmeticStencils(name, opArithmetic)    \
+    clox_VMJitQuickArithmeticStencil(name##Sint, name, opArithmetic, CLOX_VALUE_TYPE_SINT, (void)0, &state->window[clox_VMJitZ(operands)], &state->window[clox_VMJitX(operands)], &state->window[clox_VMJitY(operands)], (void)0) \
+    clox_VMJitQuickArithmeticStencil(name##Real, name, opArithmetic, CLOX_VALUE_TYPE_REAL, (void)0, &state->window[clox_VMJitZ(operands)], &state->window[clox_VMJitX(operands)], &state->window[clox_VMJitY(operands)], (void)0)
+
+/**
+ * @brief       This macro defines the stencil of a constant arithmetic form
+ *              specialized for a type, only the register is guarded (see
+ *              clox_VMDecodedQuickConstantArithmeticHandler).
+ */
+#   define clox_VMJitQuickConstantArithmeticStencil(name, generic, opArithmetic, type) \
+    clox_VMJitStencil(name)                                                 \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+                                                                            \
+        CLOX_REGISTER const sint_t _constant = (int16_t)(clox_VMJitOperand(operands) >> 16); \
+        const CloxValue_t x = (clox_VMJitX(operands) == clox_VMJitY(operands)) ? cloxSIntValue(_constant) : state->window[clox_VMJitX(operands)]; \
+        const CloxValue_t y = (type == CLOX_VALUE_TYPE_SINT) ? cloxSIntValue(_constant) : cloxRealValue((real_t)_constant); \
+                                                                            \
+        if (!clox_VMQuickGuard(type, &x, &x))                               \
+            return clox_VMJit##generic(_state, operands);                   \
+                                                                            \
+        state->window[clox_VMJitY(operands)] = cloxSIntValue(_constant);    \
+        clox_VMQuickArithmetic(opArithmetic, type, &state->window[clox_VMJitZ(operands)], &x, &y); \
+                                                                            \
+        return CLOX_JIT_STATUS_CONTINUE;                                    \
+    }
+
+#   define clox_VMJitQuickConstantArithmeticStencils(name, opArithmetic)    \
+    clox_VMJitQuickConstantArithmeticStencil(name##Sint, name, opArithmetic, CLOX_VALUE_TYPE_SINT) \
+    clox_VMJitQuickConstantArithmeticStencil(name##Real, name, opArithmetic, CLOX_VALUE_TYPE_REAL)
+
+clox_VMJitQuickStackArithmeticStencils(Add, CLOX_OP_CODE_ADD)
+clox_VMJitQuickStackArithmeticStencils(Sub, CLOX_OP_CODE_SUB)
+clox_VMJitQuickStackArithmeticStencils(Mul, CLOX_OP_CODE_MUL)
+
+clox_VMJitQuickRegisterArithmeticStencils(Radd, CLOX_OP_CODE_ADD)
+clox_VMJitQuickRegisterArithmeticStencils(Rsub, CLOX_OP_CODE_SUB)
+clox_VMJitQuickRegisterArithmeticStencils(Rmul, CLOX_OP_CODE_MUL)
+
+clox_VMJitQuickConstantArithmeticStencils(Radc, CLOX_OP_CODE_ADD)
+clox_VMJitQuickConstantArithmeticStencils(Rsbc, CLOX_OP_CODE_SUB)
+
+/**
+ * @brief       This function negates the specified value, like the handlers of
+ *              the neg and rneg instructions.
+ *
+ * @return      TRUE on success, FALSE if the value is not a number.
+ */
+CLOX_INLINE bool_t CLOX_STDCALL clox_VMJitNegate(const CloxValue_t *const x, CloxValue_t *const outValue)
+{
+    switch (clox_VMPromoteTypes(cloxValueType(*x), cloxValueType(*x)))
+    {
+    case CLOX_VALUE_TYPE_UINT:
+    case CLOX_VALUE_TYPE_SINT:
+        *outValue = cloxSIntValue(-clox_VMToSInt(x));
+        return TRUE;
+
+    case CLOX_VALUE_TYPE_REAL:
+        *outValue = cloxRealValue(-cloxValueAsReal(*x));
+        return TRUE;
+
+    default:
+        return FALSE;
+    }
+}
+
+clox_VMJitStencil(Neg)
+{
+    clox_VMJitGetState();
+    clox_VMJitRequire(1);
+
+    (void)operands;
+
+    return clox_VMJitNegate(state->sp - 1, state->sp - 1) ? CLOX_JIT_STATUS_CONTINUE : CLOX_JIT_STATUS_BAIL;
+}
+
+clox_VMJitStencil(Rneg)
+{
+    clox_VMJitGetState();
+
+    CloxValue_t result;
+
+    if (!clox_VMJitNegate(&state->window[clox_VMJitX(operands)], &result))
+        return CLOX_JIT_STATUS_BAIL;
+
+    state->window[clox_VMJitZ(operands)] = result;
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Not)
+{
+    clox_VMJitGetState();
+    clox_VMJitRequire(1);
+
+    (void)operands;
+
+    state->sp[-1] = cloxBoolValue(clox_VMIsFalsey(state->sp - 1));
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Rnot)
+{
+    clox_VMJitGetState();
+
+    state->window[clox_VMJitZ(operands)] = cloxBoolValue(clox_VMIsFalsey(&state->window[clox_VMJitX(operands)]));
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Cmp)
+{
+    clox_VMJitGetState();
+    clox_VMJitRequire(2);
+
+    (void)operands;
+
+    state->sp -= 2;
+    state->vm->cf = clox_VMCompare(state->sp, state->sp + 1);
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Rcmp)
+{
+    clox_VMJitGetState();
+
+    state->vm->cf = clox_VMCompare(&state->window[clox_VMJitX(operands)], &state->window[clox_VMJitY(operands)]);
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+/**
+ * @brief       This macro defines the stencil of a comparison form specialized
+ *              for a type, which runs the generic stencil when its guard fails.
+ */
+#   define clox_VMJitQuickCompareStencil(name, generic, type, prologue, x, y, epilogue) \
+    clox_VMJitStencil(name)                                                 \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+        prologue;                                                           \
+                                                                            \
+        if (!clox_VMQuickGuard(type, x, y))                                 \
+            return clox_VMJit##generic(_state, operands);                   \
+                                                                            \
+        state->vm->cf = clox_VMQuickCompare(type, x, y);                    \
+        epilogue;                                                           \
+                                                                            \
+        return CLOX_JIT_STATUS_CONTINUE;                                    \
+    }
+
+clox_VMJitQuickCompareStencil(CmpSint, Cmp, CLOX_VALUE_TYPE_SINT, clox_VMJitRequire(2), state->sp - 2, state->sp - 1, state->sp -= 2)
+clox_VMJitQuickCompareStencil(CmpReal, Cmp, CLOX_VALUE_TYPE_REAL, clox_VMJitRequire(2), state->sp - 2, state->sp - 1, state->sp -= 2)
+clox_VMJitQuickCompareStencil(RcmpSint, Rcmp, CLOX_VALUE_TYPE_SINT, (void)0, &state->window[clox_VMJitX(operands)], &state->window[clox_VMJitY(operands)], (void)0)
+clox_VMJitQuickCompareStencil(RcmpReal, Rcmp, CLOX_VALUE_TYPE_REAL, (void)0, &state->window[clox_VMJitX(operands)], &state->window[clox_VMJitY(operands)], (void)0)
+
+clox_VMJitStencil(Tst)
+{
+    clox_VMJitGetState();
+    clox_VMJitRequire(1);
+
+    (void)operands;
+
+    state->vm->zf = (byte_t)clox_VMIsFalsey(--state->sp);
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Rtst)
+{
+    clox_VMJitGetState();
+
+    state->vm->zf = (byte_t)clox_VMIsFalsey(&state->window[clox_VMJitX(operands)]);
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+clox_VMJitStencil(Jmp)
+{
+    clox_VMJitGetState();
+
+    return clox_VMJitTake(state, operands);
+}
+
+/**
+ * @brief       This macro defines the branch stencil of a condition on the
+ *              flags.
+ */
+#   define clox_VMJitFlagBranchStencil(name, condition)                     \
+    clox_VMJitStencil(J##name)                                              \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+        CloxVM_t *const vm = state->vm;                                     \
+                                                                            \
+        (void)vm;                                                           \
+                                                                            \
+        return (condition) ? clox_VMJitTake(state, operands) : CLOX_JIT_STATUS_CONTINUE; \
+    }
+
+/**
+ * @brief       This macro defines the branch stencils of a condition on the
+ *              comparison flag: on the flags, after a compare of the stack and
+ *              after a compare of two registers, then the forms of the last two
+ *              specialized for SINT and REAL operands.
+ */
+#   define clox_VMJitBranchStencils(name, condition)                        \
+    clox_VMJitFlagBranchStencil(name, condition)                            \
+                                                                            \
+    clox_VMJitStencil(CJ##name)                                             \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+        clox_VMJitRequire(2);                                               \
+        CloxVM_t *const vm = state->vm;                                     \
+                                                                            \
+        state->sp -= 2;                                                     \
+        vm->cf = clox_VMCompare(state->sp, state->sp + 1);                  \
+                                                                            \
+        return (condition) ? clox_VMJitTake(state, operands) : CLOX_JIT_STATUS_CONTINUE; \
+    }                                                                       \
+                                                                            \
+    clox_VMJitStencil(RJ##name)                                             \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+        CloxVM_t *const vm = state->vm;                                     \
+                                                                            \
+        vm->cf = clox_VMCompare(&state->window[clox_VMJitX(operands)], &state->window[clox_VMJitY(operands)]); \
+                                                                            \
+        return (condition) ? clox_VMJitTake(state, operands) : CLOX_JIT_STATUS_CONTINUE; \
+    }                                                                       \
+                                                                            \
+    clox_VMJitQuickBranchStencil(CJ##name##Sint, CJ##name, CLOX_VALUE_TYPE_SINT, clox_VMJitRequire(2), state->sp - 2, state->sp - 1, state->sp -= 2, condition) \
+    clox_VMJitQuickBranchStencil(CJ##name##Real, CJ##name, CLOX_VALUE_TYPE_REAL, clox_VMJitRequire(2), state->sp - 2, state->sp - 1, state->sp -= 2, condition) \
+    clox_VMJitQuickBranchStencil(RJ##name##Sint, RJ##name, CLOX_VALUE_TYPE_SINT, (void)0, &state->window[clox_VMJitX(operands)], &state->window[clox_VMJitY(operands)], (void)0, condition) \
+    clox_VMJitQuickBranchStencil(RJ##name##Real, RJ##name, CLOX_VALUE_TYPE_REAL, (void)0, &state->window[clox_VMJitX(operands)], &state->window[clox_VMJitY(operands)], (void)0, condition)
+
+/**
+ * @brief       This macro defines the stencil of a compare and jump form
+ *              specialized for a type, which runs the generic stencil when its
+ *              guard fails.
+ */
+#   define clox_VMJitQuickBranchStencil(name, generic, type, prologue, x, y, epilogue, condition) \
+    clox_VMJitStencil(name)                                                 \
+    {                                                                       \
+        clox_VMJitGetState();                                               \
+        prologue;                                                           \
+        CloxVM_t *const vm = state->vm;                                     \
+                                                                            \
+        if (!clox_VMQuickGuard(type, x, y))                                 \
+            return clox_VMJit##generic(_state, operands);                   \
+                                                                            \
+        vm->cf = clox_VMQuickCompare(type, x, y);                           \
+        epilogue;                                                           \
+                                                                            \
+        return (condition) ? clox_VMJitTake(state, operands) : CLOX_JIT_STATUS_CONTINUE; \
+    }
+
+clox_VMJitFlagBranchStencil(it, !vm->zf)
+clox_VMJitFlagBranchStencil(nt, vm->zf)
+
+clox_VMJitBranchStencils(eq, vm->cf == 0)
+clox_VMJitBranchStencils(ne, vm->cf != 0)
+clox_VMJitBranchStencils(gt, vm->cf == 2)
+clox_VMJitBranchStencils(ge, !(vm->cf & 1))
+clox_VMJitBranchStencils(lt, vm->cf == 1)
+clox_VMJitBranchStencils(le, vm->cf < 2)
+
+/**
+ * @brief       This function selects the stencil of the specified record (with
+ *              the opcode read once, as the record may be quickened meanwhile),
+ *              the value of a load is stored into outValue.
+ *
+ * @return      TRUE if the instruction is supported by the JIT tier, else
+ *              FALSE (the region ends there).
+ */
+CLOX_STATIC bool_t CLOX_STDCALL clox_VMJitSelect(const CloxCodeBlock_t *const codeBlock, const CloxDecodedInstruction_t *const record, const byte_t opCode, CloxJitStencil_t *const outStencil, CloxValue_t *const outValue)
+{
+    outStencil->kind        = CLOX_JIT_STENCIL_OP;
+    outStencil->operands    = clox_VMJitPack(record);
+    outStencil->size        = (uint32_t)sizeof(CloxValue_t);
+    outStencil->source      = 0;
+    outStencil->destination = (uint32_t)(record->z * sizeof(CloxValue_t));
+    outStencil->other       = 0;
+    outStencil->pop         = 0;
+    outStencil->payload     = 0;
+    outStencil->operation   = CLOX_JIT_OPERATION_ADD;
+    outStencil->condition   = CLOX_JIT_CONDITION_NONE;
+    outStencil->data        = outValue;
+
+#   define clox_VMJitCase(opEnum, name)                                     \
+    case opEnum:                                                            \
+        outStencil->function = &clox_VMJit##name;                           \
+        return TRUE
+
+#   define clox_VMJitBranchCase(opEnum, name)                               \
+    case opEnum:                                                            \
+        outStencil->function = &clox_VMJit##name;                           \
+        outStencil->kind     = CLOX_JIT_STENCIL_BRANCH;                     \
+        return TRUE
+
+/* the moves of values are emitted inline, the function is called on the
+ * targets that don't support them */
+#   define clox_VMJitInline(name, inlineKind)                               \
+    do                                                                      \
+    {                                                                       \
+        outStencil->function = &clox_VMJit##name;                           \
+        outStencil->kind     = inlineKind;                                  \
+        return TRUE;                                                        \
+    } while (0)
+
+#   define clox_VMJitQuickCases(opQuick, name)                              \
+    clox_VMJitCase(opQuick##_SINT, name##Sint);                             \
+    clox_VMJitCase(opQuick##_REAL, name##Real)
+
+#   define clox_VMJitQuickBranchCases(opQuick, name)                        \
+    clox_VMJitBranchCase(opQuick##_SINT, name##Sint);                       \
+    clox_VMJitBranchCase(opQuick##_REAL, name##Real)
+
+    /* the forms of the quickened records specialized for a type keep their
+     * fast path, the generic ones are compiled as the instructions */
+    switch (opCode)
+    {
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_ADD,  Add);
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_SUB,  Sub);
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_MUL,  Mul);
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_CMP,  Cmp);
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_RADD, Radd);
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_RSUB, Rsub);
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_RMUL, Rmul);
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_RCMP, Rcmp);
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_RADC, Radc);
+    clox_VMJitQuickCases(CLOX_QUICK_OP_CODE_RSBC, Rsbc);
+
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_CJEQ, CJeq);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_CJNE, CJne);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_CJGT, CJgt);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_CJGE, CJge);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_CJLT, CJlt);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_CJLE, CJle);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_RJEQ, RJeq);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_RJNE, RJne);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_RJGT, RJgt);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_RJGE, RJge);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_RJLT, RJlt);
+    clox_VMJitQuickBranchCases(CLOX_QUICK_OP_CODE_RJLE, RJle);
+
+    default:
+        break;
+    }
+
+    switch (clox_VMBaseOpCode(opCode))
+    {
+    case CLOX_OP_CODE_NOP:
+        outStencil->function = NULL;
+        outStencil->kind     = CLOX_JIT_STENCIL_JUMP;
+        return TRUE;
+
+    case CLOX_OP_CODE_MOV:
+        if (record->operand & 0x8000)
+        {
+            outStencil->source = (uint32_t)(((record->operand & 0x7FFF) + 1) * sizeof(CloxValue_t));
+            clox_VMJitInline(Mov, CLOX_JIT_STENCIL_PICK);
+        }
+
+        outStencil->source = (uint32_t)((byte_t)record->operand * sizeof(CloxValue_t));
+        clox_VMJitInline(Mov, CLOX_JIT_STENCIL_MOVE);
+
+    case CLOX_OP_CODE_PSH:
+        outStencil->source = outStencil->destination;
+        clox_VMJitInline(Psh, CLOX_JIT_STENCIL_PUSH);
+
+    case CLOX_OP_CODE_POP:
+        clox_VMJitInline(Pop, CLOX_JIT_STENCIL_POP);
+
+    clox_VMJitCase(CLOX_OP_CODE_DUP,  Dup);
+
+    case CLOX_OP_CODE_LDC:
+        *outValue = cloxSIntValue((int16_t)record->operand);
+        clox_VMJitInline(Ldc, CLOX_JIT_STENCIL_LOAD);
+
+    case CLOX_OP_CODE_LDA:
+        *outValue = cloxVPtrValue((vptr_t)(iptr_t)(uint16_t)record->operand);
+        clox_VMJitInline(Lda, CLOX_JIT_STENCIL_LOAD);
+
+    /* the constants are not changed once added, they are copied into the
+     * code */
+    case CLOX_OP_CODE_LEC:
+    case CLOX_OP_CODE_LECW:
+        *outValue = codeBlock->constants[record->operand];
+        clox_VMJitInline(Lec, CLOX_JIT_STENCIL_LOAD);
+    clox_VMJitCase(CLOX_OP_CODE_LEA,  Lea);
+    clox_VMJitCase(CLOX_OP_CODE_LEAW, Lea);
+    clox_VMJitCase(CLOX_OP_CODE_LDG,  Ldg);
+    clox_VMJitCase(CLOX_OP_CODE_STG,  Stg);
+    clox_VMJitCase(CLOX_OP_CODE_ADD,  Add);
+    clox_VMJitCase(CLOX_OP_CODE_SUB,  Sub);
+    clox_VMJitCase(CLOX_OP_CODE_MUL,  Mul);
+    clox_VMJitCase(CLOX_OP_CODE_DIV,  Div);
+    clox_VMJitCase(CLOX_OP_CODE_NEG,  Neg);
+    clox_VMJitCase(CLOX_OP_CODE_NOT,  Not);
+    clox_VMJitCase(CLOX_OP_CODE_CMP,  Cmp);
+    clox_VMJitCase(CLOX_OP_CODE_TST,  Tst);
+    clox_VMJitCase(CLOX_OP_CODE_RADD, Radd);
+    clox_VMJitCase(CLOX_OP_CODE_RSUB, Rsub);
+    clox_VMJitCase(CLOX_OP_CODE_RMUL, Rmul);
+    clox_VMJitCase(CLOX_OP_CODE_RDIV, Rdiv);
+    clox_VMJitCase(CLOX_OP_CODE_RNEG, Rneg);
+    clox_VMJitCase(CLOX_OP_CODE_RNOT, Rnot);
+    clox_VMJitCase(CLOX_OP_CODE_RCMP, Rcmp);
+    clox_VMJitCase(CLOX_OP_CODE_RTST, Rtst);
+    clox_VMJitCase(CLOX_OP_CODE_RADC, Radc);
+    clox_VMJitCase(CLOX_OP_CODE_RSBC, Rsbc);
+
+    clox_VMJitBranchCase(CLOX_OP_CODE_JMP, Jmp);
+    clox_VMJitBranchCase(CLOX_OP_CODE_JIT, Jit);
+    clox_VMJitBranchCase(CLOX_OP_CODE_JNT, Jnt);
+    clox_VMJitBranchCase(CLOX_OP_CODE_JEQ, Jeq);
+    clox_VMJitBranchCase(CLOX_OP_CODE_JNE, Jne);
+    clox_VMJitBranchCase(CLOX_OP_CODE_JGT, Jgt);
+    clox_VMJitBranchCase(CLOX_OP_CODE_JGE, Jge);
+    clox_VMJitBranchCase(CLOX_OP_CODE_JLT, Jlt);
+    clox_VMJitBranchCase(CLOX_OP_CODE_JLE, Jle);
+    clox_VMJitBranchCase(CLOX_OP_CODE_BR,  Jmp);
+    clox_VMJitBranchCase(CLOX_OP_CODE_BEQ, Jeq);
+    clox_VMJitBranchCase(CLOX_OP_CODE_BNE, Jne);
+    clox_VMJitBranchCase(CLOX_OP_CODE_BGT, Jgt);
+    clox_VMJitBranchCase(CLOX_OP_CODE_BGE, Jge);
+    clox_VMJitBranchCase(CLOX_OP_CODE_BLT, Jlt);
+    clox_VMJitBranchCase(CLOX_OP_CODE_BLE, Jle);
+    clox_VMJitBranchCase(CLOX_OP_CODE_CJEQ, CJeq);
+    clox_VMJitBranchCase(CLOX_OP_CODE_CJNE, CJne);
+    clox_VMJitBranchCase(CLOX_OP_CODE_CJGT, CJgt);
+    clox_VMJitBranchCase(CLOX_OP_CODE_CJGE, CJge);
+    clox_VMJitBranchCase(CLOX_OP_CODE_CJLT, CJlt);
+    clox_VMJitBranchCase(CLOX_OP_CODE_CJLE, CJle);
+    clox_VMJitBranchCase(CLOX_OP_CODE_RJEQ, RJeq);
+    clox_VMJitBranchCase(CLOX_OP_CODE_RJNE, RJne);
+    clox_VMJitBranchCase(CLOX_OP_CODE_RJGT, RJgt);
+    clox_VMJitBranchCase(CLOX_OP_CODE_RJGE, RJge);
+    clox_VMJitBranchCase(CLOX_OP_CODE_RJLT, RJlt);
+    clox_VMJitBranchCase(CLOX_OP_CODE_RJLE, RJle);
+
+#   undef clox_VMJitCase
+#   undef clox_VMJitBranchCase
+#   undef clox_VMJitInline
+#   undef clox_VMJitQuickCases
+#   undef clox_VMJitQuickBranchCases
+
+    default:
+        return FALSE;
+    }
+}
+
+#   if !CLOX_VALUE_NAN_BOXING
+/**
+ * @brief       This macro is TRUE when the first eight bytes of a value are its
+ *              type and its size, the header compared by the guards of the
+ *              inline stencils, and when the payloads are the 64 bits integers
+ *              and the x87 reals that they compute.
+ */
+#   define clox_VMJitGuards ((offsetof(CloxValue_t, size) == 4) && (sizeof(CloxValueType_t) == 4) && (sizeof(CloxValueSize_t) == 4) && (sizeof(sint_t) == 8) && (LDBL_MANT_DIG == 64))
+
+/**
+ * @brief       This function turns the stencil of a record specialized for SINT
+ *              or REAL values (or of a test, or of a branch on the flags) into
+ *              an inline one, whose fast path is guarded by the header of the
+ *              value stored into outValue: its function runs when a guard
+ *              fails.
+ *
+ *              The values of the stack forms are counted below the top, the
+ *              ones of the register forms from the window.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_VMJitSpecialize(const CloxDecodedInstruction_t *const record, const byte_t opCode, CloxJitStencil_t *const outStencil, CloxValue_t *const outValue)
+{
+    CLOX_REGISTER const uint32_t size = (uint32_t)sizeof(CloxValue_t);
+
+    if (!clox_VMJitGuards)
+        return;
+
+#   define clox_VMJitGuardedCase(opEnum, stencilKind, stencilOperation, stencilCondition, x, y, z, popped) \
+    case opEnum:                                                            \
+        outStencil->kind        = stencilKind;                              \
+        outStencil->operation   = (CloxJitOperation_t)(stencilOperation);   \
+        outStencil->condition   = stencilCondition;                         \
+        outStencil->source      = (uint32_t)(x) * size;                     \
+        outStencil->other       = (uint32_t)(y) * size;                     \
+        outStencil->destination = (uint32_t)(z);                            \
+        outStencil->pop         = (uint32_t)(popped) * size;                \
+        break
+
+/* the SINT form, then the REAL one */
+#   define clox_VMJitGuardedCases(opQuick, stencilKind, stencilOperation, stencilCondition, x, y, z, popped) \
+    clox_VMJitGuardedCase(opQuick##_SINT, stencilKind, stencilOperation, stencilCondition, x, y, z, popped); \
+    clox_VMJitGuardedCase(opQuick##_REAL, stencilKind, (stencilOperation) | CLOX_JIT_OPERATION_REAL, stencilCondition, x, y, z, popped)
+
+#   define clox_VMJitArithmeticCases(opQuick, opRegister, stencilOperation)  \
+    clox_VMJitGuardedCases(opQuick, CLOX_JIT_STENCIL_ARITHMETIC, stencilOperation, CLOX_JIT_CONDITION_NONE, 2, 1, 2 * size, 1); \
+    clox_VMJitGuardedCases(opRegister, CLOX_JIT_STENCIL_ARITHMETIC, stencilOperation, CLOX_JIT_CONDITION_NONE, record->x, record->y, record->z * size, 0)
+
+/* the compares store the comparison flag, from the context (the virtual
+ * machine) */
+#   define clox_VMJitCompareCases(opQuick, opRegister, stencilCondition)    \
+    clox_VMJitGuardedCases(opQuick, CLOX_JIT_STENCIL_COMPARE, 0, stencilCondition, 2, 1, offsetof(CloxVM_t, cf), 2); \
+    clox_VMJitGuardedCases(opRegister, CLOX_JIT_STENCIL_COMPARE, 0, stencilCondition, record->x, record->y, offsetof(CloxVM_t, cf), 0)
+
+#   define clox_VMJitFlagCase(opEnum, flag, stencilCondition)               \
+    case opEnum:                                                            \
+        outStencil->kind      = CLOX_JIT_STENCIL_FLAG;                      \
+        outStencil->condition = stencilCondition;                           \
+        outStencil->source    = (uint32_t)offsetof(CloxVM_t, flag);         \
+        return
+
+    switch (opCode)
+    {
+    clox_VMJitArithmeticCases(CLOX_QUICK_OP_CODE_ADD, CLOX_QUICK_OP_CODE_RADD, CLOX_JIT_OPERATION_ADD);
+    clox_VMJitArithmeticCases(CLOX_QUICK_OP_CODE_SUB, CLOX_QUICK_OP_CODE_RSUB, CLOX_JIT_OPERATION_SUB);
+    clox_VMJitArithmeticCases(CLOX_QUICK_OP_CODE_MUL, CLOX_QUICK_OP_CODE_RMUL, CLOX_JIT_OPERATION_MUL);
+
+    /* the generic records were not quickened yet (they didn't run before the
+     * region got hot), they guess the reals, the numbers of the language */
+    clox_VMJitGuardedCase(CLOX_OP_CODE_ADD,  CLOX_JIT_STENCIL_ARITHMETIC, CLOX_JIT_OPERATION_REAL_ADD, CLOX_JIT_CONDITION_NONE, 2, 1, 2 * size, 1);
+    clox_VMJitGuardedCase(CLOX_OP_CODE_SUB,  CLOX_JIT_STENCIL_ARITHMETIC, CLOX_JIT_OPERATION_REAL_SUB, CLOX_JIT_CONDITION_NONE, 2, 1, 2 * size, 1);
+    clox_VMJitGuardedCase(CLOX_OP_CODE_MUL,  CLOX_JIT_STENCIL_ARITHMETIC, CLOX_JIT_OPERATION_REAL_MUL, CLOX_JIT_CONDITION_NONE, 2, 1, 2 * size, 1);
+    clox_VMJitGuardedCase(CLOX_OP_CODE_RADD, CLOX_JIT_STENCIL_ARITHMETIC, CLOX_JIT_OPERATION_REAL_ADD, CLOX_JIT_CONDITION_NONE, record->x, record->y, record->z * size, 0);
+    clox_VMJitGuardedCase(CLOX_OP_CODE_RSUB, CLOX_JIT_STENCIL_ARITHMETIC, CLOX_JIT_OPERATION_REAL_SUB, CLOX_JIT_CONDITION_NONE, record->x, record->y, record->z * size, 0);
+    clox_VMJitGuardedCase(CLOX_OP_CODE_RMUL, CLOX_JIT_STENCIL_ARITHMETIC, CLOX_JIT_OPERATION_REAL_MUL, CLOX_JIT_CONDITION_NONE, record->x, record->y, record->z * size, 0);
+
+    clox_VMJitCompareCases(CLOX_QUICK_OP_CODE_CMP,  CLOX_QUICK_OP_CODE_RCMP, CLOX_JIT_CONDITION_NONE);
+    clox_VMJitCompareCases(CLOX_QUICK_OP_CODE_CJEQ, CLOX_QUICK_OP_CODE_RJEQ, CLOX_JIT_CONDITION_ZERO);
+    clox_VMJitCompareCases(CLOX_QUICK_OP_CODE_CJNE, CLOX_QUICK_OP_CODE_RJNE, CLOX_JIT_CONDITION_NONZERO);
+    clox_VMJitCompareCases(CLOX_QUICK_OP_CODE_CJGT, CLOX_QUICK_OP_CODE_RJGT, CLOX_JIT_CONDITION_GREATER);
+    clox_VMJitCompareCases(CLOX_QUICK_OP_CODE_CJGE, CLOX_QUICK_OP_CODE_RJGE, CLOX_JIT_CONDITION_GREATER_EQUAL);
+    clox_VMJitCompareCases(CLOX_QUICK_OP_CODE_CJLT, CLOX_QUICK_OP_CODE_RJLT, CLOX_JIT_CONDITION_LESS);
+    clox_VMJitCompareCases(CLOX_QUICK_OP_CODE_CJLE, CLOX_QUICK_OP_CODE_RJLE, CLOX_JIT_CONDITION_LESS_EQUAL);
+
+    /* only a false boolean is tested inline, other values are rare there */
+    clox_VMJitGuardedCase(CLOX_OP_CODE_TST,  CLOX_JIT_STENCIL_TEST, 0, CLOX_JIT_CONDITION_NONE, 1, 0, offsetof(CloxVM_t, zf), 1);
+    clox_VMJitGuardedCase(CLOX_OP_CODE_RTST, CLOX_JIT_STENCIL_TEST, 0, CLOX_JIT_CONDITION_NONE, record->x, 0, offsetof(CloxVM_t, zf), 0);
+
+    clox_VMJitFlagCase(CLOX_OP_CODE_JIT, zf, CLOX_JIT_CONDITION_ZERO);
+    clox_VMJitFlagCase(CLOX_OP_CODE_JNT, zf, CLOX_JIT_CONDITION_NONZERO);
+    clox_VMJitFlagCase(CLOX_OP_CODE_JEQ, cf, CLOX_JIT_CONDITION_ZERO);
+    clox_VMJitFlagCase(CLOX_OP_CODE_JNE, cf, CLOX_JIT_CONDITION_NONZERO);
+    clox_VMJitFlagCase(CLOX_OP_CODE_JGT, cf, CLOX_JIT_CONDITION_GREATER);
+    clox_VMJitFlagCase(CLOX_OP_CODE_JGE, cf, CLOX_JIT_CONDITION_GREATER_EQUAL);
+    clox_VMJitFlagCase(CLOX_OP_CODE_JLT, cf, CLOX_JIT_CONDITION_LESS);
+    clox_VMJitFlagCase(CLOX_OP_CODE_JLE, cf, CLOX_JIT_CONDITION_LESS_EQUAL);
+    clox_VMJitFlagCase(CLOX_OP_CODE_BEQ, cf, CLOX_JIT_CONDITION_ZERO);
+    clox_VMJitFlagCase(CLOX_OP_CODE_BNE, cf, CLOX_JIT_CONDITION_NONZERO);
+    clox_VMJitFlagCase(CLOX_OP_CODE_BGT, cf, CLOX_JIT_CONDITION_GREATER);
+    clox_VMJitFlagCase(CLOX_OP_CODE_BGE, cf, CLOX_JIT_CONDITION_GREATER_EQUAL);
+    clox_VMJitFlagCase(CLOX_OP_CODE_BLT, cf, CLOX_JIT_CONDITION_LESS);
+    clox_VMJitFlagCase(CLOX_OP_CODE_BLE, cf, CLOX_JIT_CONDITION_LESS_EQUAL);
+
+#   undef clox_VMJitGuardedCase
+#   undef clox_VMJitGuardedCases
+#   undef clox_VMJitArithmeticCases
+#   undef clox_VMJitCompareCases
+#   undef clox_VMJitFlagCase
+
+    default:
+        return;
+    }
+
+    switch (opCode)
+    {
+    case CLOX_OP_CODE_TST:
+    case CLOX_OP_CODE_RTST:
+        *outValue = cloxBoolValue(FALSE);
+        break;
+
+    default:
+        *outValue = (outStencil->operation & CLOX_JIT_OPERATION_REAL) ? cloxRealValue(0) : cloxSIntValue(0);
+        break;
+    }
+
+    outStencil->payload = (uint32_t)offsetof(CloxValue_t, data);
+
+    return;
+}
+#   endif
+
+/**
+ * @brief       This function selects the stencils of the records from the
+ *              specified one, up to the first instruction that the JIT tier
+ *              doesn't support.
+ *
+ * @return      The number of records selected.
+ */
+CLOX_STATIC size_t CLOX_STDCALL clox_VMJitSelectRegion(const CloxCodeBlock_t *const codeBlock, const size_t start, CloxJitStencil_t *const stencils, CloxValue_t *const values)
+{
+    const CloxDecodedBlock_t *const decoded = &codeBlock->decoded;
+
+    CLOX_REGISTER size_t n;
+
+    for (n = 0; ((start + n) < decoded->count) && (n < CLOX_VM_JIT_REGION_SIZE); n++)
+    {
+        const CloxDecodedInstruction_t *const record = &decoded->instructions[start + n];
+
+        CLOX_REGISTER const byte_t opCode = cloxAtomicLoadRelaxedByte(&record->opCode);
+
+        if (!clox_VMJitSelect(codeBlock, record, opCode, &stencils[n], &values[n]))
+            break;
+
+#   if !CLOX_VALUE_NAN_BOXING
+        clox_VMJitSpecialize(record, opCode, &stencils[n], &values[n]);
+#   endif
+
+        stencils[n].record = (uint32_t)(start + n);
+    }
+
+    return n;
+}
+
+/* the target of a jump record, a no-op is a jump to the next one */
+#   define clox_VMJitTarget(index) ((decoded->instructions[index].opCode == CLOX_OP_CODE_NOP) ? ((index) + 1) : (size_t)decoded->instructions[index].operand)
+
+#   define clox_VMJitJumps(stencil) (((stencil)->kind == CLOX_JIT_STENCIL_BRANCH) || ((stencil)->kind == CLOX_JIT_STENCIL_JUMP) || ((stencil)->kind == CLOX_JIT_STENCIL_FLAG) || (((stencil)->kind == CLOX_JIT_STENCIL_COMPARE) && (stencil)->condition))
+
+/* a backward jump polls the phase of the heap and the profiler */
+#   define clox_VMJitPoll(stencil)                                          \
+    do                                                                      \
+    {                                                                       \
+        (stencil)->kind        = CLOX_JIT_STENCIL_POLL;                     \
+        (stencil)->source      = (uint32_t)(offsetof(CloxVM_t, heap) + offsetof(CloxHeap_t, phase)); \
+        (stencil)->destination = (uint32_t)offsetof(CloxVM_t, profiler);   \
+    } while (0)
+
+/**
+ * @brief       This function compiles the region of the decoded block entered
+ *              at the specified record, up to the first instruction that the
+ *              JIT tier doesn't support: jumps inside the region stay native,
+ *              the ones leaving it (and the end of the region) resume the
+ *              interpreter from their target.
+ */
+CLOX_STATIC void CLOX_STDCALL clox_VMJitCompile(const CloxCodeBlock_t *const codeBlock, const size_t head)
+{
+    const CloxDecodedBlock_t *const decoded = &codeBlock->decoded;
+
+    CLOX_REGISTER size_t i, n, m, start, lowest, count;
+
+    CloxJitStencil_t *stencils;
+    CloxValue_t *values;
+    bool_t loops;
+
+    assert((offsetof(CloxVMJitState_t, sp) == offsetof(CloxJitFrame_t, top)) && (offsetof(CloxVMJitState_t, window) == offsetof(CloxJitFrame_t, window)));
+    assert((offsetof(CloxVMJitState_t, bottom) == offsetof(CloxJitFrame_t, bottom)) && (offsetof(CloxVMJitState_t, limit) == offsetof(CloxJitFrame_t, limit)));
+    assert(offsetof(CloxVMJitState_t, vm) == offsetof(CloxJitFrame_t, context));
+
+    /* the branches pack the index of their target into 31 bits */
+    if (decoded->count > (UINT32_MAX >> 1))
+        return;
+
+    /* the entry jump, one stencil for each record, an exit (or a poll and
+     * two exits) for each of them and the last one */
+    stencils = dim(CloxJitStencil_t, (CLOX_VM_JIT_REGION_SIZE * 4) + 2);
+    values   = dim(CloxValue_t, CLOX_VM_JIT_REGION_SIZE);
+
+    n = clox_VMJitSelectRegion(codeBlock, start = head, stencils + 1, values);
+
+    /* the head is often the increment of a loop, jumping back to its condition
+     * above: the region starts from the lowest target of such jumps (while it
+     * still covers the records after it), or it would leave the loop at each
+     * iteration */
+    for (;;)
+    {
+        for (i = 0, lowest = start; i < n; i++)
+        {
+            if (clox_VMJitJumps(&stencils[i + 1]) && (clox_VMJitTarget(start + i) < lowest))
+                lowest = clox_VMJitTarget(start + i);
+        }
+
+        if (lowest == start)
+            break;
+
+        m = clox_VMJitSelectRegion(codeBlock, lowest, stencils + 1, values);
+
+        if ((lowest + m) < (start + n))
+        {
+            n = clox_VMJitSelectRegion(codeBlock, start, stencils + 1, values);
+            break;
+        }
+
+        start = lowest;
+        n     = m;
+    }
+
+    stencils[0].kind   = CLOX_JIT_STENCIL_JUMP;
+    stencils[0].record = (uint32_t)head;
+    stencils[0].target = (uint32_t)(head - start + 1);
+
+    stencils[n + 1].kind   = CLOX_JIT_STENCIL_EXIT;
+    stencils[n + 1].record = (uint32_t)(start + n);
+
+    for (i = 0, count = n + 2, loops = FALSE; i < n; i++)
+    {
+        CloxJitStencil_t *const stencil = &stencils[i + 1];
+
+        CLOX_REGISTER const size_t record = start + i;
+        CLOX_REGISTER size_t target;
+
+        if (!clox_VMJitJumps(stencil))
+            continue;
+
+        target = clox_VMJitTarget(record);
+
+        if ((target >= start) && (target < (start + n)))
+        {
+            stencil->target = (uint32_t)(target - start + 1);
+            loops = loops || (target <= record);
+        }
+        else
+        {
+            stencil->target = (uint32_t)count;
+
+            stencils[count].kind   = CLOX_JIT_STENCIL_EXIT;
+            stencils[count].record = (uint32_t)target;
+            count++;
+        }
+
+        /* the branches flag backward targets for the safepoint, forward
+         * unconditional jumps need no call, and the backward ones call it only
+         * when the heap is collecting or the profiler is set. The inline
+         * conditional branches going backward jump to such a poll, appended
+         * after the stencils of the records, the other ones are left to their
+         * function */
+        stencil->operands = (stencil->operands & UINT64_C(0xFFFFFFFF)) | ((uint64_t)((target << 1) | (target <= record)) << 32);
+
+        if (target > record)
+        {
+            if (stencil->function == &clox_VMJitJmp)
+                stencil->kind = CLOX_JIT_STENCIL_JUMP;
+        }
+        else if (sizeof(CloxHeapPhase_t) != sizeof(uint32_t))
+        {
+            stencil->kind = CLOX_JIT_STENCIL_BRANCH;
+        }
+        else if (stencil->function == &clox_VMJitJmp)
+        {
+            clox_VMJitPoll(stencil);
+        }
+        else if (stencil->kind != CLOX_JIT_STENCIL_BRANCH)
+        {
+            /* the poll takes the branch, an exit to its target follows it
+             * since the last stencil must not fall through */
+            stencils[count] = *stencil;
+
+            clox_VMJitPoll(&stencils[count]);
+            stencils[count].function = &clox_VMJitJmp;
+            stencils[count].record   = (uint32_t)target;
+
+            stencils[count + 1].kind   = CLOX_JIT_STENCIL_EXIT;
+            stencils[count + 1].record = (uint32_t)target;
+
+            stencil->operands ^= UINT64_C(1) << 32;
+            stencil->target    = (uint32_t)count;
+            count += 2;
+        }
+    }
+
+    /* entering and leaving a region costs more than the few records it runs
+     * at each entry unless it loops inside, the others stay interpreted. The
+     * region is published with its code, the virtual machines sharing a
+     * frozen block may enter it as soon as they see it */
+    if (loops && (head < (start + n)))
+        __atomic_store_n(&decoded->regions[head], cloxJitAssemble(stencils, count), __ATOMIC_RELEASE);
+
+    free(stencils);
+    free(values);
+
+    return;
+}
+
+#   undef clox_VMJitTarget
+#   undef clox_VMJitJumps
+#   undef clox_VMJitPoll
+
+/**
+ * @brief       This function counts a transfer to the specified record and,
+ *              once it is hot, compiles and runs its region (unless the
+ *              virtual machine is tracing).
+ *
+ *              The top of the evaluation stack is moved from and into the one
+ *              of the virtual machine.
+ *
+ * @return      The index of the record from which the interpreter resumes.
+ */
+CLOX_STATIC size_t CLOX_STDCALL clox_VMJitEnter(CloxVM_t *const vm, const CloxCodeBlock_t *const codeBlock, const size_t head, CloxValue_t *const window, const bool_t tracing)
+{
+    uint32_t *const counter = &codeBlock->decoded.counters[head];
+    const CloxJitCode_t *region;
+    CloxVMJitState_t state;
+
+    /* only the run that reaches the threshold compiles the region */
+    if ((__atomic_load_n(counter, __ATOMIC_RELAXED) < CLOX_VM_JIT_THRESHOLD) && (__atomic_add_fetch(counter, 1, __ATOMIC_RELAXED) == CLOX_VM_JIT_THRESHOLD))
+        clox_VMJitCompile(codeBlock, head);
+
+    if (tracing || !(region = __atomic_load_n(&codeBlock->decoded.regions[head], __ATOMIC_ACQUIRE)))
+        return head;
+
+    state.sp        = vm->stackTop;
+    state.window    = window;
+    state.bottom    = vm->stack;
+    state.limit     = vm->stack + vm->stackSize;
+    state.vm        = vm;
+    state.codeBlock = vm->codeBlock;
+
+    const size_t index = region->entry(&state);
+
+    vm->stackTop = state.sp;
+
+    return index;
+}
+
+/**
+ * @brief       This macro counts a transfer to the record in execution and,
+ *              once it is hot, compiles and enters its region: the records
+ *              counted out without a region only pay for its check, the rest
+ *              is left out of the handlers.
+ */
+#   define clox_VMDecodedTier()                                             \
+    do                                                                      \
+    {                                                                       \
+        CLOX_REGISTER const size_t _head = (size_t)(rp - records);          \
+                                                                            \
+        if ((__atomic_load_n(&codeBlock->decoded.counters[_head], __ATOMIC_RELAXED) < CLOX_VM_JIT_THRESHOLD) || __atomic_load_n(&codeBlock->decoded.regions[_head], __ATOMIC_RELAXED)) \
+        {                                                                   \
+            vm->stackTop = sp;                                              \
+            rp = records + clox_VMJitEnter(vm, codeBlock, _head, window, clox_VMTracing()); \
+            sp = vm->stackTop;                                              \
+        }                                                                   \
+    } while (0)
+#else
+/**
+ * @brief       This macro does nothing, the JIT tier is compiled out.
+ */
+#   define clox_VMDecodedTier() ((void)0)
+#endif
+
+#if CLOX_VM_COMPUTED_GOTO
+/**
+ * @brief       This macro marks the beginning of a decoded instruction handler.
+ */
+#   define clox_VMDecodedHandler(opEnum, opFunc) opFunc:
+/**
+ * @brief       This macro jumps directly to the handler stored into the record
+ *              of the next instruction (which may be quickened meanwhile).
+ */
+#   define clox_VMDecodedDispatch()  \
+    do                               \
+    {                                \
+        clox_VMDecodedCount();       \
+        clox_VMDecodedTrace();       \
+        goto *__atomic_load_n(&rp->handler, __ATOMIC_RELAXED); \
+    } while (0)
+/**
+ * @brief       This macro moves to the next record and executes it.
+ */
+#   define clox_VMDecodedNext()      \
+    do                               \
+    {                                \
+        rp++;                        \
+        clox_VMDecodedDispatch();    \
+    } while (0)
+#else
+/**
+ * @brief       This macro marks the beginning of a decoded instruction handler.
+ */
+#   define clox_VMDecodedHandler(opEnum, opFunc) case opEnum:
+/**
+ * @brief       This macro goes back to the switch statement, that selects the
+ *              handler of the next instruction.
+ */
+#   define clox_VMDecodedDispatch() continue
+/**
+ * @brief       This macro moves to the next record and goes back to the switch
+ *              statement, it can't be wrapped into a do-while statement since
+ *              its continue must reach the interpreter loop, so it is used only
+ *              as the last statement of a handler.
+ */
+#   define clox_VMDecodedNext() rp++; continue
+#endif
+
+#if CLOX_VM_OPCODE_STATS
+/**
+ * @brief       This macro charges the cycles elapsed since the last dispatch
+ *              to the previous instruction, then starts timing the next one.
+ */
+#   define clox_VMDecodedCount()                                    \
+    do                                                              \
+    {                                                               \
+        if (lastOpCode >= 0)                                        \
+            clox_VMRecord(&vm->opCodeStats[lastOpCode], cloxClockCycles() - lastCycles); \
+                                                                    \
+        lastOpCode = (rp->opCode != CLOX_DECODED_OP_CODE_END) ? (int)clox_VMBaseOpCode(rp->opCode) : -1; \
+        lastCycles = cloxClockCycles();                             \
+    } while (0)
+#else
+/**
+ * @brief       This macro does nothing, opcode counters are compiled out.
+ */
+#   define clox_VMDecodedCount() ((void)0)
+#endif
+
+#if CLOX_VM_TRACE
+/**
+ * @brief       This macro records the next instruction into the attached trace
+ *              (if any), with the opcode of its bytecode.
+ */
+#   define clox_VMDecodedTrace()                                    \
+    do                                                              \
+    {                                                               \
+        if (vm->trace && (rp->opCode != CLOX_DECODED_OP_CODE_END))   \
+            clox_VMTraceRecord(vm->trace, codeBlock->decoded.offsets[rp - records], clox_VMBaseOpCode(rp->opCode), stack, sp); \
+    } while (0)
+/**
+ * @brief       This macro tells whether a trace is attached, then the compiled
+ *              regions are not entered since they don't record anything.
+ */
+#   define clox_VMTracing() (vm->trace != NULL)
+#else
+/**
+ * @brief       This macro does nothing, the trace is compiled out.
+ */
+#   define clox_VMDecodedTrace() ((void)0)
+/**
+ * @brief       This macro is always FALSE, the trace is compiled out.
+ */
+#   define clox_VMTracing() FALSE
+#endif
+
+
+/**
+ * @brief       This macro moves to the target record of a jump, taking a step
+ *              of the running collection on backward jumps (which are counted
+ *              by the JIT tier). Targets have been checked by the decoder.
+ */
+#define clox_VMDecodedTransfer(index, hot)                       \
+    do                                                           \
+    {                                                            \
+        const CloxDecodedInstruction_t *const _target = records + (index); \
+        const bool_t _backward = (bool_t)(_target <= rp);        \
+                                                                 \
+        if (_backward && (vm->heap.phase != CLOX_HEAP_PHASE_IDLE)) \
+        {                                                        \
+            vm->stackTop = sp;                                   \
+            cloxHeapStep(&vm->heap);                             \
+        }                                                        \
+                                                                 \
+        rp = _target;                                            \
+                                                                 \
+        if (_backward || (hot))                                  \
+        {                                                        \
+            clox_VMProfile(codeBlock->decoded.offsets[_target - records]); \
+            clox_VMDecodedTier();                                \
+        }                                                        \
+    } while (0)
+
+#define clox_VMDecodedJumpTo(index) clox_VMDecodedTransfer(index, FALSE)
+
+/**
+ * @brief       This macro moves to the target record of a call, which counts
+ *              as a transfer to a hot region whatever its direction.
+ */
+#define clox_VMDecodedCallTo(index) clox_VMDecodedTransfer(index, TRUE)
+
+#define clox_VMDecodedJumpHandler(opEnum, opFunc, condition)                \
+    clox_VMDecodedHandler(opEnum, opFunc)                                   \
+    {                                                                       \
+        if (condition)                                                      \
+        {                                                                   \
+            clox_VMDecodedJumpTo(rp->operand);                              \
+            clox_VMDecodedDispatch();                                       \
+        }                                                                   \
+                                                                            \
+        clox_VMDecodedNext();                                               \
+    }
+
+#if CLOX_VM_COMPUTED_GOTO
+/**
+ * @brief       This macro rewrites the record in execution into the specified
+ *              quickened opcode, together with its handler.
+ */
+#   define clox_VMDecodedRewrite(opCode) clox_VMQuicken(rp, (byte_t)(opCode), dispatchTable[(opCode)])
+#else
+/**
+ * @brief       This macro rewrites the record in execution into the specified
+ *              quickened opcode, the switch statement selects its handler.
+ */
+#   define clox_VMDecodedRewrite(opCode) clox_VMQuicken(rp, (byte_t)(opCode), NULL)
+#endif
+
+#if CLOX_VM_QUICKENING
+/**
+ * @brief       This macro rewrites the record in execution, which runs for the
+ *              first time, into the form of its quickened opcode selected by the
+ *              types of its operands.
+ */
+#   define clox_VMDecodedObserve(opQuick, x, y) clox_VMDecodedRewrite(opQuick##_SINT + clox_VMQuickForm(x, y))
+#else
+/**
+ * @brief       This macro does nothing, the records are never quickened.
+ */
+#   define clox_VMDecodedObserve(opQuick, x, y) ((void)0)
+#endif
+
+/**
+ * @brief       This macro performs an arithmetic operation of the generic form,
+ *              the result is stored into z only on success.
+ */
+#define clox_VMDecodedArithmetic(opArithmetic, z, x, y)                     \
+    do                                                                      \
+    {                                                                       \
+        CloxValue_t _result = *(x);                                         \
+                                                                            \
+        if ((error = clox_VMArithmetic(opArithmetic, &_result, (y))))       \
+            goto l_error;                                                   \
+                                                                            \
+        *(z) = _result;                                                     \
+    } while (0)
+
+/**
+ * @brief       This macro takes the jump of the record in execution when the
+ *              condition holds, otherwise it moves to the next record.
+ */
+#define clox_VMDecodedBranch(condition)                                     \
+    if (condition)                                                          \
+    {                                                                       \
+        clox_VMDecodedJumpTo(rp->operand);                                  \
+        clox_VMDecodedDispatch();                                           \
+    }                                                                       \
+                                                                            \
+    clox_VMDecodedNext()
+
+#define clox_VMDecodedQuickArithmeticHandler(opFunc, opQuick, opAny, opArithmetic, type, prologue, z, x, y, epilogue) \
+    clox_VMDecodedHandler(opQuick, opFunc)                                  \
+    {                                                                       \
+        prologue;                                                           \
+                                                                            \
+        if (clox_VMQuickGuard(type, x, y))                                  \
+        {                                                                   \
+            clox_VMQuickArithmetic(opArithmetic, type, z, x, y);            \
+        }                                                                   \
+        else                                                                \
+        {                                                                   \
+            clox_VMDecodedRewrite(opAny);                                   \
+            clox_VMDecodedArithmetic(opArithmetic, z, x, y);                \
+        }                                                                   \
+                                                                            \
+        epilogue;                                                           \
+    }
+
+/**
+ * @brief       This macro defines the handlers of an arithmetic instruction:
+ *              the one of the opcode, which quickens the record, the ones of the
+ *              forms specialized for SINT and REAL operands, whose guards fall
+ *              back to the generic form, and the one of the generic form.
+ */
+#define clox_VMDecodedArithmeticHandlers(opEnum, opFunc, opQuick, opArithmetic, prologue, z, x, y, epilogue) \
+    clox_VMDecodedHandler(opEnum, opFunc)                                   \
+    {                                                                       \
+        prologue;                                                           \
+                                                                            \
+        clox_VMDecodedObserve(opQuick, x, y);                               \
+        clox_VMDecodedArithmetic(opArithmetic, z, x, y);                    \
+                                                                            \
+        epilogue;                                                           \
+    }                                                                       \
+                                                                            \
+    clox_VMDecodedQuickArithmeticHandler(opFunc##_sint, opQuick##_SINT, opQuick##_ANY, opArithmetic, CLOX_VALUE_TYPE_SINT, prologue, z, x, y, epilogue) \
+    clox_VMDecodedQuickArithmeticHandler(opFunc##_real, opQuick##_REAL, opQuick##_ANY, opArithmetic, CLOX_VALUE_TYPE_REAL, prologue, z, x, y, epilogue) \
+                                                                            \
+    clox_VMDecodedHandler(opQuick##_ANY, opFunc##_any)                      \
+    {                                                                       \
+        prologue;                                                           \
+                                                                            \
+        clox_VMDecodedArithmetic(opArithmetic, z, x, y);                    \
+                                                                            \
+        epilogue;                                                           \
+    }
+
+#define clox_VMDecodedStackArithmeticHandlers(opEnum, opFunc, opQuick)      \
+    clox_VMDecodedArithmeticHandlers(opEnum, opFunc, opQuick, opEnum, clox_VMDecodedRequire(2); --sp, sp - 1, sp - 1, sp, clox_VMDecodedNext())
+
+#define clox_VMDecodedRegisterArithmeticHandlers(opEnum, opFunc, opQuick, opArithmetic) \
+    clox_VMDecodedArithmeticHandlers(opEnum, opFunc, opQuick, opArithmetic, (void)0, &window[rp->z], &window[rp->x], &window[rp->y], clox_VMDecodedNext())
+
+/**
+ * @brief       This macro defines the handler of a form of an instruction with
+ *              a constant operand, which is SINT: only the type of the register
+ *              is guarded, the constant is converted for the REAL form.
+ */
+#define clox_VMDecodedQuickConstantArithmeticHandler(opFunc, opQuick, opAny, opArithmetic, type) \
+    clox_VMDecodedHandler(opQuick, opFunc)                                  \
+    {                                                                       \
+        CLOX_REGISTER const sint_t _constant = (int16_t)(rp->operand >> 16); \
+                                                                            \
+        window[rp->y] = cloxSIntValue(_constant);                           \
+                                                                            \
+        if (clox_VMQuickGuard(type, &window[rp->x], &window[rp->x]))        \
+        {                                                                   \
+            const CloxValue_t _y = (type == CLOX_VALUE_TYPE_SINT) ? window[rp->y] : cloxRealValue((real_t)_constant); \
+                                                                            \
+            clox_VMQuickArithmetic(opArithmetic, type, &window[rp->z], &window[rp->x], &_y); \
+        }                                                                   \
+        else                                                                \
+        {                                                                   \
+            clox_VMDecodedRewrite(opAny);                                   \
+            clox_VMDecodedArithmetic(opArithmetic, &window[rp->z], &window[rp->x], &window[rp->y]); \
+        }                                                                   \
+                                                                            \
+        clox_VMDecodedNext();                                               \
+    }
+
+#define clox_VMDecodedConstantArithmeticHandlers(opEnum, opFunc, opQuick, opArithmetic) \
+    clox_VMDecodedHandler(opEnum, opFunc)                                   \
+    {                                                                       \
+        window[rp->y] = cloxSIntValue((int16_t)(rp->operand >> 16));        \
+                                                                            \
+        clox_VMDecodedObserve(opQuick, &window[rp->x], &window[rp->x]);     \
+        clox_VMDecodedArithmetic(opArithmetic, &window[rp->z], &window[rp->x], &window[rp->y]); \
+                                                                            \
+        clox_VMDecodedNext();                                               \
+    }                                                                       \
+                                                                            \
+    clox_VMDecodedQuickConstantArithmeticHandler(opFunc##_sint, opQuick##_SINT, opQuick##_ANY, opArithmetic, CLOX_VALUE_TYPE_SINT) \
+    clox_VMDecodedQuickConstantArithmeticHandler(opFunc##_real, opQuick##_REAL, opQuick##_ANY, opArithmetic, CLOX_VALUE_TYPE_REAL) \
+                                                                            \
+    clox_VMDecodedHandler(opQuick##_ANY, opFunc##_any)                      \
+    {                                                                       \
+        window[rp->y] = cloxSIntValue((int16_t)(rp->operand >> 16));        \
+                                                                            \
+        clox_VMDecodedArithmetic(opArithmetic, &window[rp->z], &window[rp->x], &window[rp->y]); \
+                                                                            \
+        clox_VMDecodedNext();                                               \
+    }
+
+#define clox_VMDecodedQuickCompareHandler(opFunc, opQuick, opAny, type, prologue, x, y, epilogue) \
+    clox_VMDecodedHandler(opQuick, opFunc)                                  \
+    {                                                                       \
+        prologue;                                                           \
+                                                                            \
+        if (clox_VMQuickGuard(type, x, y))                                  \
+        {                                                                   \
+            vm->cf = clox_VMQuickCompare(type, x, y);                       \
+        }                                                                   \
+        else                                                                \
+        {                                                                   \
+            clox_VMDecodedRewrite(opAny);                                   \
+            vm->cf = clox_VMCompare(x, y);                                  \
+        }                                                                   \
+                                                                            \
+        epilogue;                                                           \
+    }
+
+/**
+ * @brief       This macro defines the handlers of a comparison instruction, as
+ *              clox_VMDecodedArithmeticHandlers does for arithmetic ones.
+ */
+#define clox_VMDecodedCompareHandlers(opEnum, opFunc, opQuick, prologue, x, y, epilogue) \
+    clox_VMDecodedHandler(opEnum, opFunc)                                   \
+    {                                                                       \
+        prologue;                                                           \
+                                                                            \
+        clox_VMDecodedObserve(opQuick, x, y);                               \
+        vm->cf = clox_VMCompare(x, y);                                      \
+                                                                            \
+        epilogue;                                                           \
+    }                                                                       \
+                                                                            \
+    clox_VMDecodedQuickCompareHandler(opFunc##_sint, opQuick##_SINT, opQuick##_ANY, CLOX_VALUE_TYPE_SINT, prologue, x, y, epilogue) \
+    clox_VMDecodedQuickCompareHandler(opFunc##_real, opQuick##_REAL, opQuick##_ANY, CLOX_VALUE_TYPE_REAL, prologue, x, y, epilogue) \
+                                                                            \
+    clox_VMDecodedHandler(opQuick##_ANY, opFunc##_any)                      \
+    {                                                                       \
+        prologue;                                                           \
+                                                                            \
+        vm->cf = clox_VMCompare(x, y);                                      \
+                                                                            \
+        epilogue;                                                           \
+    }
+
+#define clox_VMDecodedCompareJumpHandlers(opEnum, opFunc, opQuick, condition) \
+    clox_VMDecodedCompareHandlers(opEnum, opFunc, opQuick, clox_VMDecodedRequire(2); sp -= 2, sp, sp + 1, clox_VMDecodedBranch(condition))
+
+#define clox_VMDecodedRegisterCompareJumpHandlers(opEnum, opFunc, opQuick, condition) \
+    clox_VMDecodedCompareHandlers(opEnum, opFunc, opQuick, (void)0, &window[rp->x], &window[rp->y], clox_VMDecodedBranch(condition))
+
+/**
+ * @brief       This function is the interpreter loop of decoded blocks, it
+ *              executes the records of the block in execution starting from
+ *              the one of the current instruction pointer, like clox_VMExecute
+ *              does with the bytecode. The records have been checked by the
+ *              decoder, so only the evaluation stack is checked at run-time,
+ *              and its underflow not even that when the block is verified.
+ *
+ * @param       vm A pointer to the virtual machine, or NULL to get the table
+ *              of the handlers.
+ * @param       index The index of the first record to execute.
+ * @param       outHandlers When vm is NULL, a pointer to set to the table of
+ *              the handlers (NULL without computed gotos, since the records
+ *              are selected by their opcodes).
+ */
+CLOX_STATIC CloxVMStatus_t CLOX_STDCALL clox_VMExecuteDecoded(CloxVM_t *const vm, const size_t index, const void *const **const outHandlers)
+{
+#if CLOX_VM_COMPUTED_GOTO
+    /* the decoder stores only known opcodes, so the other slots are left
+     * empty */
+    CLOX_STATIC const void *const dispatchTable[BYTE_MAX + 1] = {
+        [CLOX_OP_CODE_NOP] = &&_op_nop,
+        [CLOX_DECODED_OP_CODE_END] = &&_op_end,
+
+#   define cloxDefineOpCode(opEnum, opCode, opName, opKind, opFunc) [opCode] = &&opFunc,
+#   include CLOX_VM_OPCODE_INC_
+
+#   define cloxDefineQuickOpCode(opEnum, opCode, opBase, opFunc) [opCode] = &&opFunc,
+#   include CLOX_VM_QUICK_OPCODE_INC_
+    };
+#endif
+
+    /* the labels are visible only here, so the decoder gets them this way */
+    if (!vm)
+    {
+#if CLOX_VM_COMPUTED_GOTO
+        *outHandlers = dispatchTable;
+#else
+        *outHandlers = NULL;
+#endif
+
+        return CLOX_VM_STATUS_SUCCESS;
+    }
+
+    const CloxCodeBlock_t *const codeBlock = vm->codeBlock;
+    const CloxDecodedInstruction_t *const records = codeBlock->decoded.instructions;
+
+    CloxValue_t *stack     = vm->stack;
+    CloxValue_t *stackEnd  = vm->stack + vm->stackSize;
+
+    CLOX_REGISTER const CloxDecodedInstruction_t *rp = records + index;
+    CLOX_REGISTER CloxValue_t *sp = vm->stackTop;
+    CLOX_REGISTER CloxValue_t *window = vm->window;
+
+    /* the depths proven by the verifier hold for the top-level code, when it
+     * is entered with the evaluation stack at the proven depth: the calls
+     * made from there are proven as well */
+    const bool_t checked = !codeBlock->depths || vm->framesCount || (codeBlock->depths[index] != (int32_t)(sp - stack));
+
+    CloxVMStatus_t status;
+    const char    *error;
+
+#if CLOX_VM_OPCODE_STATS
+    int      lastOpCode = -1;
+    uint64_t lastCycles = 0;
+#endif
+
+#if CLOX_VM_COMPUTED_GOTO
+    clox_VMDecodedDispatch();
+#else
+    for (;;)
+    {
+        clox_VMDecodedCount();
+        clox_VMDecodedTrace();
+
+        switch (cloxAtomicLoadRelaxedByte(&rp->opCode))
+        {
+#endif
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_NOP, _op_nop)
+    {
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_BREAK, _op_break)
+    {
+        rp++;
+        status = CLOX_VM_STATUS_BREAK;
+        goto l_halt;
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_ABORT, _op_abort)
+    {
+        rp++;
+        status = CLOX_VM_STATUS_ABORT;
+        goto l_halt;
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_EXIT, _op_exit)
+    {
+        vm->exitCode = (int)(int16_t)rp->operand;
+
+        rp++;
+        status = CLOX_VM_STATUS_SUCCESS;
+        goto l_halt;
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_RAISE, _op_raise)
+    {
+        vm->signal = (int)rp->operand;
+
+        rp++;
+        status = CLOX_VM_STATUS_RAISE;
+        goto l_halt;
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_CALL, _op_call)
+    {
+        CloxVMFrame_t *const frame = clox_VMPushFrame(vm);
+
+        if (!frame)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_CALL_OVERFLOW);
+
+        frame->returnRecord = (size_t)(rp - records) + 1;
+        frame->returnOffset = codeBlock->decoded.offsets[frame->returnRecord];
+
+        clox_VMDecodedCallTo(rp->operand);
+        clox_VMDecodedDispatch();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_TCALL, _op_tcall)
+    {
+        CLOX_REGISTER const size_t depth = vm->framesCount ? vm->frames[vm->framesCount - 1].windowsCount : 0;
+
+        if (!clox_VMUnwindWindows(vm, depth, rp->z))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_WINDOW_UNDERFLOW);
+
+        window = vm->window;
+
+        clox_VMDecodedJumpTo(rp->operand);
+        clox_VMDecodedDispatch();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_RET, _op_ret)
+    {
+        if (!vm->framesCount)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_CALL_UNDERFLOW);
+
+        const CloxVMFrame_t *const frame = &vm->frames[vm->framesCount - 1];
+        CLOX_REGISTER size_t record = frame->returnRecord;
+
+        /* frames pushed on the bytecode only know the offset of the return */
+        if ((record > codeBlock->decoded.count) || (codeBlock->decoded.offsets[record] != frame->returnOffset))
+            record = clox_VMFindRecord(&codeBlock->decoded, frame->returnOffset);
+
+        if (record == SIZE_MAX)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_JUMP_OUT_OF_BOUNDS);
+
+        if (!clox_VMUnwindWindows(vm, frame->windowsCount, 0))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_WINDOW_UNDERFLOW);
+
+        vm->framesCount--;
+        window = vm->window;
+
+        clox_VMDecodedJumpTo(record);
+        clox_VMDecodedDispatch();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_NCALL, _op_ncall)
+    {
+        CloxVMCache_t *const cache = &vm->caches[rp->operand >> 16];
+
+        if ((cache->epoch != vm->natives.epoch) && (error = clox_VMBindNative(vm, codeBlock, cache, rp->operand & 0xFFFF, rp->z)))
+            goto l_error;
+
+        clox_VMCallNative(cache->native, rp->z, clox_VMDecodedRequire);
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_JMP, _op_jmp, TRUE)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_JIT, _op_jit, !vm->zf)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_JNT, _op_jnt, vm->zf)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_JEQ, _op_jeq, vm->cf == 0)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_JNE, _op_jne, vm->cf != 0)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_JGT, _op_jgt, vm->cf == 2)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_JGE, _op_jge, !(vm->cf & 1))
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_JLT, _op_jlt, vm->cf == 1)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_JLE, _op_jle, vm->cf < 2)
+
+    /* once decoded, branches are the same as jumps */
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_BR,  _op_br,  TRUE)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_BEQ, _op_beq, vm->cf == 0)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_BNE, _op_bne, vm->cf != 0)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_BGT, _op_bgt, vm->cf == 2)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_BGE, _op_bge, !(vm->cf & 1))
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_BLT, _op_blt, vm->cf == 1)
+    clox_VMDecodedJumpHandler(CLOX_OP_CODE_BLE, _op_ble, vm->cf < 2)
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_MOV, _op_mov)
+    {
+        CLOX_REGISTER const uint16_t x = (uint16_t)rp->operand;
+
+        if (x & 0x8000)
+        {
+            /* the value at the specified distance from the top of the stack */
+            clox_VMDecodedRequire((size_t)(x & 0x7FFF) + 1);
+
+            window[rp->z] = sp[-(ptrdiff_t)(x & 0x7FFF) - 1];
+        }
+        else
+        {
+            window[rp->z] = window[(byte_t)x];
+        }
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_PSH, _op_psh)
+    {
+        clox_VMReserve(1);
+
+        *sp++ = window[rp->z];
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_POP, _op_pop)
+    {
+        clox_VMDecodedRequire(1);
+
+        window[rp->z] = *--sp;
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_DUP, _op_dup)
+    {
+        clox_VMDecodedRequire(1);
+        clox_VMReserve(1);
+
+        sp[0] = sp[-1];
+        sp++;
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_LDC, _op_ldc)
+    {
+        window[rp->z] = cloxSIntValue((int16_t)rp->operand);
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_LDA, _op_lda)
+    {
+        window[rp->z] = cloxVPtrValue((vptr_t)(iptr_t)(uint16_t)rp->operand);
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_LEC, _op_lec)
+    clox_VMDecodedHandler(CLOX_OP_CODE_LECW, _op_lecw)
+    {
+        window[rp->z] = codeBlock->constants[rp->operand];
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_LEA, _op_lea)
+    clox_VMDecodedHandler(CLOX_OP_CODE_LEAW, _op_leaw)
+    {
+        window[rp->z] = cloxVPtrValue((vptr_t)&codeBlock->constants[rp->operand]);
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_LDG, _op_ldg)
+    {
+        CloxVMCache_t *const cache = &vm->caches[rp->operand >> 16];
+
+        if ((cache->epoch != vm->globals.epoch) && !clox_VMBindCache(vm, codeBlock, &vm->globals, cache, rp->operand & 0xFFFF))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_GLOBAL);
+
+        window[rp->z] = cache->entry->value;
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_STG, _op_stg)
+    {
+        CloxVMCache_t *const cache = &vm->caches[rp->operand >> 16];
+
+        if ((cache->epoch != vm->globals.epoch) && !clox_VMBindCache(vm, codeBlock, &vm->globals, cache, rp->operand & 0xFFFF))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_GLOBAL);
+
+        cache->entry->value = window[rp->z];
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_NEWO, _op_newo)
+    {
+        CloxObject_t *object;
+
+        vm->stackTop = sp;
+
+        if (!(object = cloxNewInstance(&vm->heap, &vm->shapes, rp->operand)))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_OUT_OF_MEMORY);
+
+        window[rp->z] = cloxObjtValue(object);
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_GETP, _op_getp)
+    {
+        clox_VMDecodedRequire(1);
+
+        CloxVMCache_t *const cache = &vm->caches[rp->operand >> 16];
+        CloxObject_t *const object = clox_VMAsInstance(sp[-1]);
+        const CloxVMShapeCache_t *entry;
+        CloxVMShapeCache_t scratch;
+
+        if (!object)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_NOT_AN_INSTANCE);
+
+        if (!(entry = clox_VMFindShape(cache, cloxInstanceShape(object))) && !(entry = clox_VMBindProperty(vm, codeBlock, cache, rp->operand & 0xFFFF, cloxInstanceShape(object), FALSE, &scratch)))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_PROPERTY);
+
+        window[rp->z] = *cloxInstanceField(object, entry->index);
+        sp--;
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_SETP, _op_setp)
+    {
+        clox_VMDecodedRequire(1);
+
+        CloxVMCache_t *const cache = &vm->caches[rp->operand >> 16];
+        CloxObject_t *const object = clox_VMAsInstance(sp[-1]);
+        const CloxVMShapeCache_t *entry;
+        CloxVMShapeCache_t scratch;
+
+        if (!object)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_NOT_AN_INSTANCE);
+
+        if (!(entry = clox_VMFindShape(cache, cloxInstanceShape(object))) && !(entry = clox_VMBindProperty(vm, codeBlock, cache, rp->operand & 0xFFFF, cloxInstanceShape(object), TRUE, &scratch)))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_PROPERTY);
+
+        if (entry->target == entry->shape)
+        {
+            cloxInstanceStore(&vm->heap, object, entry->index, window[rp->z]);
+        }
+        else
+        {
+            vm->stackTop = sp;
+
+            if (!cloxInstanceAppend(&vm->heap, object, entry->target, window[rp->z]))
+                clox_VMError(CLOX_VM_ERROR_MESSAGE_OUT_OF_MEMORY);
+        }
+
+        sp--;
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_INVK, _op_invk)
+    {
+        if (!rp->z)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_INVALID_OPERANDS);
+
+        clox_VMDecodedRequire(rp->z);
+
+        CloxVMCache_t *const cache = &vm->caches[rp->operand >> 16];
+        CloxObject_t *const object = clox_VMAsInstance(sp[-rp->z]);
+        const CloxVMShapeCache_t *entry;
+        CloxVMShapeCache_t scratch;
+
+        if (!object)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_NOT_AN_INSTANCE);
+
+        if (!(entry = clox_VMFindShape(cache, cloxInstanceShape(object))) && !(entry = clox_VMBindProperty(vm, codeBlock, cache, rp->operand & 0xFFFF, cloxInstanceShape(object), FALSE, &scratch)))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNDEFINED_PROPERTY);
+
+        const CloxValue_t method = *cloxInstanceField(object, entry->index);
+
+        if (((cloxValueType(method) != CLOX_VALUE_TYPE_VPTR) || (cache->epoch != vm->natives.epoch) || ((vptr_t)cache->native != cloxValueAsVPtr(method))) && (error = clox_VMBindMethod(vm, cache, method, rp->z)))
+            goto l_error;
+
+        clox_VMCallNative(cache->native, rp->z, clox_VMDecodedRequire);
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_ENT, _op_ent)
+    {
+        CLOX_REGISTER const size_t size    = rp->operand;
+        CLOX_REGISTER const size_t overlap = rp->z;
+
+        CLOX_REGISTER const size_t current = (size_t)(window - vm->registers);
+        CLOX_REGISTER const size_t base    = current + vm->windowSize - overlap;
+
+        if ((overlap > vm->windowSize) || (size > CLOX_VM_REGISTERS_COUNT) || !clox_VMReserveWindow(vm, base))
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_WINDOW_OVERFLOW);
+
+        vm->windows[vm->windowsCount].base = current;
+        vm->windows[vm->windowsCount].size = vm->windowSize;
+        vm->windowsCount++;
+
+        window = vm->window = vm->registers + base;
+        vm->windowSize = size;
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_LEV, _op_lev)
+    {
+        if (!vm->windowsCount)
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_WINDOW_UNDERFLOW);
+
+        vm->windowsCount--;
+
+        window = vm->window = vm->registers + vm->windows[vm->windowsCount].base;
+        vm->windowSize = vm->windows[vm->windowsCount].size;
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedStackArithmeticHandlers(CLOX_OP_CODE_ADD, _op_add, CLOX_QUICK_OP_CODE_ADD)
+    clox_VMDecodedStackArithmeticHandlers(CLOX_OP_CODE_SUB, _op_sub, CLOX_QUICK_OP_CODE_SUB)
+    clox_VMDecodedStackArithmeticHandlers(CLOX_OP_CODE_MUL, _op_mul, CLOX_QUICK_OP_CODE_MUL)
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_DIV, _op_div)
+    {
+        clox_VMDecodedRequire(2);
+
+        --sp;
+
+        if ((error = clox_VMArithmetic(CLOX_OP_CODE_DIV, sp - 1, sp)))
+            goto l_error;
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_NEG, _op_neg)
+    {
+        clox_VMDecodedRequire(1);
+
+        CloxValue_t *const x = sp - 1;
+
+        switch (clox_VMPromoteTypes(cloxValueType(*x), cloxValueType(*x)))
+        {
+        case CLOX_VALUE_TYPE_UINT:
+        case CLOX_VALUE_TYPE_SINT:
+            *x = cloxSIntValue(-clox_VMToSInt(x));
+            break;
+
+        case CLOX_VALUE_TYPE_REAL:
+            *x = cloxRealValue(-cloxValueAsReal(*x));
+            break;
+
+        default:
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_INVALID_OPERANDS);
+        }
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_NOT, _op_not)
+    {
+        clox_VMDecodedRequire(1);
+
+        sp[-1] = cloxBoolValue(clox_VMIsFalsey(sp - 1));
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedCompareHandlers(CLOX_OP_CODE_CMP, _op_cmp, CLOX_QUICK_OP_CODE_CMP, clox_VMDecodedRequire(2); sp -= 2, sp, sp + 1, clox_VMDecodedNext())
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_TST, _op_tst)
+    {
+        clox_VMDecodedRequire(1);
+
+        vm->zf = (byte_t)clox_VMIsFalsey(--sp);
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedRegisterArithmeticHandlers(CLOX_OP_CODE_RADD, _op_radd, CLOX_QUICK_OP_CODE_RADD, CLOX_OP_CODE_ADD)
+    clox_VMDecodedRegisterArithmeticHandlers(CLOX_OP_CODE_RSUB, _op_rsub, CLOX_QUICK_OP_CODE_RSUB, CLOX_OP_CODE_SUB)
+    clox_VMDecodedRegisterArithmeticHandlers(CLOX_OP_CODE_RMUL, _op_rmul, CLOX_QUICK_OP_CODE_RMUL, CLOX_OP_CODE_MUL)
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_RDIV, _op_rdiv)
+    {
+        clox_VMDecodedArithmetic(CLOX_OP_CODE_DIV, &window[rp->z], &window[rp->x], &window[rp->y]);
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_RNEG, _op_rneg)
+    {
+        const CloxValue_t *const x = &window[rp->x];
+
+        switch (clox_VMPromoteTypes(cloxValueType(*x), cloxValueType(*x)))
+        {
+        case CLOX_VALUE_TYPE_UINT:
+        case CLOX_VALUE_TYPE_SINT:
+            window[rp->z] = cloxSIntValue(-clox_VMToSInt(x));
+            break;
+
+        case CLOX_VALUE_TYPE_REAL:
+            window[rp->z] = cloxRealValue(-cloxValueAsReal(*x));
+            break;
+
+        default:
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_INVALID_OPERANDS);
+        }
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_RNOT, _op_rnot)
+    {
+        window[rp->z] = cloxBoolValue(clox_VMIsFalsey(&window[rp->x]));
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedCompareHandlers(CLOX_OP_CODE_RCMP, _op_rcmp, CLOX_QUICK_OP_CODE_RCMP, (void)0, &window[rp->x], &window[rp->y], clox_VMDecodedNext())
+
+    clox_VMDecodedHandler(CLOX_OP_CODE_RTST, _op_rtst)
+    {
+        vm->zf = (byte_t)clox_VMIsFalsey(&window[rp->x]);
+
+        clox_VMDecodedNext();
+    }
+
+    clox_VMDecodedCompareJumpHandlers(CLOX_OP_CODE_CJEQ, _op_cjeq, CLOX_QUICK_OP_CODE_CJEQ,vm->cf == 0)
+    clox_VMDecodedCompareJumpHandlers(CLOX_OP_CODE_CJNE, _op_cjne, CLOX_QUICK_OP_CODE_CJNE,vm->cf != 0)
+    clox_VMDecodedCompareJumpHandlers(CLOX_OP_CODE_CJGT, _op_cjgt, CLOX_QUICK_OP_CODE_CJGT,vm->cf == 2)
+    clox_VMDecodedCompareJumpHandlers(CLOX_OP_CODE_CJGE, _op_cjge, CLOX_QUICK_OP_CODE_CJGE,!(vm->cf & 1))
+    clox_VMDecodedCompareJumpHandlers(CLOX_OP_CODE_CJLT, _op_cjlt, CLOX_QUICK_OP_CODE_CJLT,vm->cf == 1)
+    clox_VMDecodedCompareJumpHandlers(CLOX_OP_CODE_CJLE, _op_cjle, CLOX_QUICK_OP_CODE_CJLE,vm->cf < 2)
+
+    clox_VMDecodedRegisterCompareJumpHandlers(CLOX_OP_CODE_RJEQ, _op_rjeq, CLOX_QUICK_OP_CODE_RJEQ,vm->cf == 0)
+    clox_VMDecodedRegisterCompareJumpHandlers(CLOX_OP_CODE_RJNE, _op_rjne, CLOX_QUICK_OP_CODE_RJNE,vm->cf != 0)
+    clox_VMDecodedRegisterCompareJumpHandlers(CLOX_OP_CODE_RJGT, _op_rjgt, CLOX_QUICK_OP_CODE_RJGT,vm->cf == 2)
+    clox_VMDecodedRegisterCompareJumpHandlers(CLOX_OP_CODE_RJGE, _op_rjge, CLOX_QUICK_OP_CODE_RJGE,!(vm->cf & 1))
+    clox_VMDecodedRegisterCompareJumpHandlers(CLOX_OP_CODE_RJLT, _op_rjlt, CLOX_QUICK_OP_CODE_RJLT,vm->cf == 1)
+    clox_VMDecodedRegisterCompareJumpHandlers(CLOX_OP_CODE_RJLE, _op_rjle, CLOX_QUICK_OP_CODE_RJLE,vm->cf < 2)
+
+    clox_VMDecodedConstantArithmeticHandlers(CLOX_OP_CODE_RADC, _op_radc, CLOX_QUICK_OP_CODE_RADC, CLOX_OP_CODE_ADD)
+    clox_VMDecodedConstantArithmeticHandlers(CLOX_OP_CODE_RSBC, _op_rsbc, CLOX_QUICK_OP_CODE_RSBC, CLOX_OP_CODE_SUB)
+
+    clox_VMDecodedHandler(CLOX_DECODED_OP_CODE_END, _op_end)
+    {
+        status = CLOX_VM_STATUS_SUCCESS;
+        goto l_halt;
+    }
+
+#if !CLOX_VM_COMPUTED_GOTO
+        default:
+        {
+            /* the decoder never stores unknown opcodes */
+            clox_VMError(CLOX_VM_ERROR_MESSAGE_UNKNOWN_OPCODE);
+        }
+        }
+    }
+#endif
+
+l_yield:
+    rp++;
+    status = CLOX_VM_STATUS_YIELD;
+    goto l_halt;
+
+l_error:
+    vm->error = error;
+    status = CLOX_VM_STATUS_ERROR;
+
+    /* like the bytecode interpreter, past the opcode of the failed instruction */
+    vm->ip = codeBlock->array + codeBlock->decoded.offsets[rp - records] + 1;
+    goto l_store;
+
+l_halt:
+    vm->ip = codeBlock->array + codeBlock->decoded.offsets[rp - records];
+
+l_store:
+#if CLOX_VM_OPCODE_STATS
+    if (lastOpCode >= 0)
+        clox_VMRecord(&vm->opCodeStats[lastOpCode], cloxClockCycles() - lastCycles);
+#endif
+
+    vm->stackTop = sp;
+    vm->status   = status;
+
+    return status;
+}
+
+/**
+ * @brief       This function gets the record of the decoded form of the block
+ *              in execution from which the execution continues.
+ *
+ * @return      The index of the record at the current instruction pointer, or
+ *              SIZE_MAX if the block is not decoded for this interpreter or the
+ *              instruction pointer is not at the beginning of an instruction.
+ */
+CLOX_STATIC size_t CLOX_STDCALL clox_VMFindDecoded(const CloxVM_t *const vm)
+{
+    const CloxDecodedBlock_t *const decoded = &vm->codeBlock->decoded;
+    const void *const *handlers;
+
+    clox_VMExecuteDecoded(NULL, 0, &handlers);
+
+    if (!decoded->instructions || (decoded->handlers != handlers) || (vm->ip < vm->codeBlock->array))
+        return SIZE_MAX;
+
+    return clox_VMFindRecord(decoded, (size_t)(vm->ip - vm->codeBlock->array));
+}
+
+CLOX_API CloxVM_t *CLOX_STDCALL cloxInitVM(CloxVM_t *const vm, size_t stackSize)
+{
+    assert(vm != NULL);
+
+    if (!stackSize)
+        stackSize = CLOX_VM_STACK_SIZE;
+
+    vm->registers     = dim(CloxValue_t, CLOX_VM_REGISTER_FILE_SIZE);
+    vm->registersSize = CLOX_VM_REGISTER_FILE_SIZE;
+
+    for (size_t i = 0; i < vm->registersSize; i++)
+        vm->registers[i] = cloxVoidValue();
+
+    vm->window          = vm->registers;
+    vm->windowSize      = CLOX_VM_REGISTERS_COUNT;
+    vm->windows         = dim(CloxVMWindow_t, CLOX_VM_FRAMES_CHUNK);
+    vm->windowsCount    = 0;
+    vm->windowsCapacity = CLOX_VM_FRAMES_CHUNK;
+    vm->frames          = dim(CloxVMFrame_t, CLOX_VM_FRAMES_CHUNK);
+    vm->framesCount     = 0;
+    vm->framesCapacity  = CLOX_VM_FRAMES_CHUNK;
+
+    vm->stack      = dim(CloxValue_t, stackSize);
+    vm->stackTop   = vm->stack;
+    vm->stackSize  = stackSize;
+    vm->stackLimit = stackSize;
+    vm->codeBlock = NULL;
+    vm->ip        = NULL;
+    vm->cf        = 0;
+    vm->zf        = 0;
+    vm->status    = CLOX_VM_STATUS_SUCCESS;
+    vm->exitCode  = 0;
+    vm->signal    = 0;
+    vm->error     = NULL;
+
+    cloxInitStringTable(&vm->strings, NULL);
+    cloxInitTable(&vm->globals);
+    cloxInitTable(&vm->natives);
+
+    vm->caches         = NULL;
+    vm->cachesCapacity = 0;
+
+    cloxInitHeap(&vm->heap, &clox_VMMarkRoots, vm);
+    cloxInitShapeTree(&vm->shapes);
+
+    vm->profiler = NULL;
+    vm->trace    = NULL;
+    vm->fiber    = NULL;
+    vm->fibers   = NULL;
+
+#if CLOX_VM_OPCODE_STATS
+    vm->opCodeStats = dim(CloxOpCodeStats_t, BYTE_MAX + 1);
+#endif
+
+    return vm;
+}
+
+CLOX_API CloxVM_t *CLOX_STDCALL cloxFreeVM(CloxVM_t *const vm)
+{
+    assert(vm != NULL);
+
+    if (vm->stack)
+        dealloc(vm->stack);
+
+    if (vm->registers)
+        dealloc(vm->registers);
+
+    if (vm->windows)
+        dealloc(vm->windows);
+
+    if (vm->frames)
+        dealloc(vm->frames);
+
+    if (vm->caches)
+        dealloc(vm->caches);
+
+    vm->cachesCapacity = 0;
+
+    cloxFreeHeap(&vm->heap);
+    cloxFreeShapeTree(&vm->shapes);
+
+#if CLOX_VM_OPCODE_STATS
+    if (vm->opCodeStats)
+        dealloc(vm->opCodeStats);
+#endif
+    for (size_t i = 0; i < vm->natives.capacity; i++)
+    {
+        if (vm->natives.entries[i].key)
+        {
+            CloxVMNative_t *const native = (CloxVMNative_t *)cloxValueAsVPtr(vm->natives.entries[i].value);
+
+            if (native->module)
+                dlunload(native->module);
+
+            dealloc(native);
+        }
+    }
+
+    cloxFreeTable(&vm->globals);
+    cloxFreeTable(&vm->natives);
+    cloxFreeStringTable(&vm->strings);
+
+    vm->registersSize   = 0;
+    vm->window          = NULL;
+    vm->windowSize      = 0;
+    vm->windowsCount    = 0;
+    vm->windowsCapacity = 0;
+    vm->framesCount     = 0;
+    vm->framesCapacity  = 0;
+
+    vm->stackTop   = NULL;
+    vm->stackSize  = 0;
+    vm->stackLimit = 0;
+    vm->codeBlock  = NULL;
+    vm->ip         = NULL;
+
+    return vm;
+}
+
+CLOX_API CloxVM_t *CLOX_STDCALL cloxCreateVM(size_t stackSize)
+{
+    return cloxInitVM(alloc(CloxVM_t), stackSize);
+}
+
+CLOX_API CloxVMStatus_t CLOX_STDCALL cloxVMRun(CloxVM_t *const vm, const CloxCodeBlock_t *const codeBlock)
+{
+    assert(vm != NULL && codeBlock != NULL);
+
+    vm->codeBlock    = codeBlock;
+    vm->ip           = codeBlock->array;
+    vm->stackTop     = vm->stack;
+    vm->window       = vm->registers;
+    vm->windowSize   = CLOX_VM_REGISTERS_COUNT;
+    vm->windowsCount = 0;
+    vm->framesCount  = 0;
+    vm->cf           = 0;
+    vm->zf           = 0;
+    vm->exitCode     = 0;
+    vm->signal       = 0;
+    vm->error        = NULL;
+
+    /* the slots are bound to the instructions of one block, so each run starts
+     * with empty ones */
+    if (codeBlock->cachesCount > vm->cachesCapacity)
+    {
+        if (vm->caches)
+            dealloc(vm->caches);
+
+        vm->caches         = dim(CloxVMCache_t, codeBlock->cachesCount);
+        vm->cachesCapacity = codeBlock->cachesCount;
+    }
+    else if (codeBlock->cachesCount)
+    {
+        memset(vm->caches, 0, sizeof(CloxVMCache_t) * codeBlock->cachesCount);
+    }
+
+    CLOX_REGISTER const size_t index = clox_VMFindDecoded(vm);
+
+    return (index != SIZE_MAX) ? clox_VMExecuteDecoded(vm, index, NULL) : clox_VMExecute(vm);
+}
+
+CLOX_API CloxVMStatus_t CLOX_STDCALL cloxVMResume(CloxVM_t *const vm)
+{
+    assert(vm != NULL);
+
+    if ((vm->status != CLOX_VM_STATUS_BREAK) && (vm->status != CLOX_VM_STATUS_RAISE) && (vm->status != CLOX_VM_STATUS_YIELD))
+        return vm->status;
+
+    CLOX_REGISTER const size_t index = clox_VMFindDecoded(vm);
+
+    return (index != SIZE_MAX) ? clox_VMExecuteDecoded(vm, index, NULL) : clox_VMExecute(vm);
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxVMDecode(CloxCodeBlock_t *const codeBlock)
+{
+    assert(codeBlock != NULL);
+
+    const void *const *handlers;
+
+    clox_VMExecuteDecoded(NULL, 0, &handlers);
+
+    if (!cloxCodeBlockDecode(codeBlock, handlers))
+        return FALSE;
+
+    /* a block that can't be verified is executed with all the checks */
+    cloxCodeBlockVerify(codeBlock);
+
+    return TRUE;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxVMFreeze(CloxCodeBlock_t *const codeBlock)
+{
+    assert(codeBlock != NULL);
+
+    /* a block that can't be decoded is shared all the same, it is executed on
+     * its bytecode */
+    cloxVMDecode(codeBlock);
+
+    return cloxCodeBlockFreeze(codeBlock);
+}
+
+CLOX_API CloxValue_t *CLOX_STDCALL cloxVMPush(CloxVM_t *const vm, const CloxValue_t value)
+{
+    assert(vm != NULL);
+
+    if ((vm->stackTop >= (vm->stack + vm->stackSize)) && !clox_VMGrowStack(vm, vm->stackSize + 1))
+        fail(CLOX_ERROR_MESSAGE_STACK_OVERFLOW, NULL);
+
+    *vm->stackTop = value;
+
+    return vm->stackTop++;
+}
+
+CLOX_API CloxValue_t CLOX_STDCALL cloxVMPop(CloxVM_t *const vm)
+{
+    assert(vm != NULL);
+
+    if (vm->stackTop <= vm->stack)
+        fail(CLOX_ERROR_MESSAGE_STACK_UNDERFLOW, NULL);
+
+    return *--vm->stackTop;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxVMDefineGlobal(CloxVM_t *const vm, const char *const name, const CloxValue_t value)
+{
+    assert(vm != NULL && name != NULL);
+
+    return cloxTableSet(&vm->globals, cloxStringTableIntern(&vm->strings, name, strlen(name)), value);
+}
+
+CLOX_API CloxValue_t *CLOX_STDCALL cloxVMGetGlobal(CloxVM_t *const vm, const char *const name)
+{
+    assert(vm != NULL && name != NULL);
+
+    const CloxString_t *const key = cloxStringTableFind(&vm->strings, name, strlen(name));
+    CloxTableEntry_t *const entry = key ? cloxTableFind(&vm->globals, key) : NULL;
+
+    return entry ? &entry->value : NULL;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxVMUndefineGlobal(CloxVM_t *const vm, const char *const name)
+{
+    assert(vm != NULL && name != NULL);
+
+    const CloxString_t *const key = cloxStringTableFind(&vm->strings, name, strlen(name));
+
+    return (bool_t)(key && cloxTableDelete(&vm->globals, key));
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxVMDefineNative(CloxVM_t *const vm, const char *const name, const CloxVMNativeFunction_t function, const size_t arity)
+{
+    assert(vm != NULL && name != NULL && function != NULL);
+
+    const CloxString_t *const key = cloxStringTableIntern(&vm->strings, name, strlen(name));
+    CloxTableEntry_t *const entry = cloxTableFind(&vm->natives, key);
+
+    if (entry)
+    {
+        CloxVMNative_t *const native = (CloxVMNative_t *)cloxValueAsVPtr(entry->value);
+
+        if (native->module)
+            dlunload(native->module);
+
+        native->function = function;
+        native->arity    = arity;
+        native->module   = NULL;
+
+        /* the call sites bound to the function check its arity again */
+        vm->natives.epoch++;
+
+        return FALSE;
+    }
+
+    CloxVMNative_t *const native = alloc(CloxVMNative_t);
+
+    native->function = function;
+    native->arity    = arity;
+    native->module   = NULL;
+
+    return cloxTableSet(&vm->natives, key, cloxVPtrValue(native));
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxVMImportNative(CloxVM_t *const vm, const char *const name, const char *const module, const char *const symbol, const size_t arity)
+{
+    assert(vm != NULL && name != NULL && symbol != NULL);
+
+    /* the handle of the running program is shared, so it is never unloaded */
+    const handle_t handle = module ? dlload(module) : dlload_current();
+
+    if (!handle)
+        return FALSE;
+
+    const CloxVMNativeFunction_t function = (CloxVMNativeFunction_t)dlimpf(handle, symbol);
+
+    if (!function)
+    {
+        if (module)
+            dlunload(handle);
+
+        return FALSE;
+    }
+
+    cloxVMDefineNative(vm, name, function, arity);
+
+    if (module)
+        ((CloxVMNative_t *)cloxVMGetNative(vm, name))->module = handle;
+
+    return TRUE;
+}
+
+CLOX_API const CloxVMNative_t *CLOX_STDCALL cloxVMGetNative(CloxVM_t *const vm, const char *const name)
+{
+    assert(vm != NULL && name != NULL);
+
+    const CloxString_t *const key = cloxStringTableFind(&vm->strings, name, strlen(name));
+    const CloxTableEntry_t *const entry = key ? cloxTableFind(&vm->natives, key) : NULL;
+
+    return entry ? (const CloxVMNative_t *)cloxValueAsVPtr(entry->value) : NULL;
+}
+
+CLOX_API const char *CLOX_STDCALL cloxVMYield(CloxVM_t *const vm)
+{
+    assert(vm != NULL);
+
+    (void)vm;
+
+    return clox_VMYieldMessage;
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxVMEvaluate(const CloxOpCode_t opCode, CloxValue_t *const x, const CloxValue_t *const y)
+{
+    assert(x != NULL && y != NULL);
+
+    if (hasflag(cloxValueType(*x), CLOX_VALUE_FLAG_POINTER) || hasflag(cloxValueType(*y), CLOX_VALUE_FLAG_POINTER))
+        return FALSE;
+
+    switch (opCode)
+    {
+    case CLOX_OP_CODE_ADD:
+        return (bool_t)!clox_VMArithmetic(CLOX_OP_CODE_ADD, x, y);
+
+    case CLOX_OP_CODE_SUB:
+        return (bool_t)!clox_VMArithmetic(CLOX_OP_CODE_SUB, x, y);
+
+    case CLOX_OP_CODE_MUL:
+        return (bool_t)!clox_VMArithmetic(CLOX_OP_CODE_MUL, x, y);
+
+    case CLOX_OP_CODE_DIV:
+        return (bool_t)!clox_VMArithmetic(CLOX_OP_CODE_DIV, x, y);
+
+    case CLOX_OP_CODE_NEG:
+        switch (clox_VMPromoteTypes(cloxValueType(*x), cloxValueType(*x)))
+        {
+        case CLOX_VALUE_TYPE_UINT:
+        case CLOX_VALUE_TYPE_SINT:
+            *x = cloxSIntValue(-clox_VMToSInt(x));
+            return TRUE;
+
+        case CLOX_VALUE_TYPE_REAL:
+            *x = cloxRealValue(-cloxValueAsReal(*x));
+            return TRUE;
+
+        default:
+            return FALSE;
+        }
+
+    case CLOX_OP_CODE_NOT:
+        *x = cloxBoolValue(clox_VMIsFalsey(x));
+        return TRUE;
+
+    case CLOX_OP_CODE_CMP:
+        *x = cloxByteValue(clox_VMCompare(x, y));
+        return TRUE;
+
+    case CLOX_OP_CODE_TST:
+        *x = cloxBoolValue(clox_VMIsFalsey(x));
+        return TRUE;
+
+    default:
+        return FALSE;
+    }
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxVMGetLocation(const CloxVM_t *const vm, CloxSourceLocation_t *const outLocation)
+{
+    assert(vm != NULL && outLocation != NULL);
+
+    if (!vm->codeBlock || !vm->ip || (vm->ip <= vm->codeBlock->array))
+        return FALSE;
+
+    /* the instruction pointer is past the opcode of the last instruction */
+    return cloxCodeBlockGetLine(vm->codeBlock, (size_t)(vm->ip - vm->codeBlock->array) - 1, outLocation);
+}
+
+CLOX_API bool_t CLOX_STDCALL cloxVMGetOpCodeStats(const CloxVM_t *const vm, CloxOpCodeStats_t *const outStats)
+{
+    assert(vm != NULL && outStats != NULL);
+
+#if CLOX_VM_OPCODE_STATS
+    memcpy(outStats, vm->opCodeStats, sizeof(CloxOpCodeStats_t) * (BYTE_MAX + 1));
+
+    return TRUE;
+#else
+    memset(outStats, 0, sizeof(CloxOpCodeStats_t) * (BYTE_MAX + 1));
+
+    return FALSE;
+#endif
+}
+
+CLOX_API void CLOX_STDCALL cloxVMResetOpCodeStats(CloxVM_t *const vm)
+{
+    assert(vm != NULL);
+
+#if CLOX_VM_OPCODE_STATS
+    memset(vm->opCodeStats, 0, sizeof(CloxOpCodeStats_t) * (BYTE_MAX + 1));
+#endif
+
+    return;
+}
+
+CLOX_API void CLOX_STDCALL cloxDeleteVM(CloxVM_t *const vm)
+{
+    free(cloxFreeVM(vm));
+
+    return;
+}
@@ -0,0 +1,68 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/vm/debug.h"
+#include "clox/vm/trace.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* the exit codes follow the ones of BSD sysexits.h */
+#define CLOX_EXIT_USAGE   64
+#define CLOX_EXIT_DATAERR 65
+#define CLOX_EXIT_NOINPUT 66
+
+/* the number of records read at once */
+#define CLOX_TRACE_CHUNK_SIZE 4096
+
+static CloxTraceRecord_t records[CLOX_TRACE_CHUNK_SIZE];
+
+/**
+ * The trace written by clox -t is printed a record on each line, preceded by
+ * its index: the offset and the name of the instruction, the type of the value
+ * on top of the stack and the depth of the stack before its execution.
+ */
+int main(int argc, char **argv)
+{
+    uint64_t index = 0;
+    size_t count;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s trace\n", argv[0]);
+        return CLOX_EXIT_USAGE;
+    }
+
+    FILE *const stream = fopen(argv[1], "rb");
+
+    if (!stream)
+    {
+        fprintf(stderr, "error: cannot open '%s'\n", argv[1]);
+        return CLOX_EXIT_NOINPUT;
+    }
+
+    if (!cloxTraceReadHeader(stream))
+    {
+        fprintf(stderr, "error: '%s' is not a trace\n", argv[1]);
+        fclose(stream);
+
+        return CLOX_EXIT_DATAERR;
+    }
+
+    while ((count = cloxTraceRead(stream, records, CLOX_TRACE_CHUNK_SIZE)))
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            printf("%12" PRIu64 " ", index++);
+            cloxDumpTraceRecord(stdout, &records[i]);
+        }
+    }
+
+    fclose(stream);
+
+    return EXIT_SUCCESS;
+}
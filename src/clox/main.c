@@ -1,6 +1,484 @@
+/**
+ * This file is part of the clox programming language project,
+ * under the MIT License. See repo's LICENSE file for license
+ * informations.
+ */
+
+#include "clox/base/alloc.h"
+#include "clox/base/clock.h"
+#include "clox/base/memory.h"
+#include "clox/compiler/compiler.h"
+#include "clox/compiler/driver.h"
+#include "clox/source/source_buffer.h"
+#include "clox/source/source_stream.h"
+#include "clox/vm/code_block.h"
+#include "clox/vm/debug.h"
+#include "clox/vm/image.h"
+#include "clox/vm/optimizer.h"
+#include "clox/vm/profiler.h"
+#include "clox/vm/trace.h"
+#include "clox/vm/vm.h"
+
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* the exit codes follow the ones of BSD sysexits.h */
+#define CLOX_EXIT_USAGE     64
+#define CLOX_EXIT_DATAERR   65
+#define CLOX_EXIT_NOINPUT   66
+#define CLOX_EXIT_SOFTWARE  70
+#define CLOX_EXIT_CANTCREAT 73
+
+/* the free space of the line buffer of the REPL before a read */
+#define CLOX_REPL_LINE_SIZE 256
+
+static void printValue(const CloxValue_t *const value)
+{
+    if (cloxValueType(*value) == CLOX_VALUE_TYPE_VOID)
+        fputs("nil", stdout);
+    else
+        cloxDumpValue(stdout, value);
+
+    fputc('\n', stdout);
+}
+
+/* clock() returns the seconds elapsed since an arbitrary point */
+static const char *CLOX_STDCALL nativeClock(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    (void)vm;
+    (void)count;
+
+    arguments[0] = cloxRealValue((real_t)cloxClockNow() / 1e9);
+
+    return NULL;
+}
+
+static void defineNatives(CloxVM_t *const vm)
+{
+    cloxVMDefineNative(vm, "clock", &nativeClock, 0);
+}
+
+/* a script over the memory budget stops, without leaving a partial result */
+static void CLOX_STDCALL memoryLimit(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size)
+{
+    fflush(stdout);
+    fprintf(stderr, "error: out of memory (%" PRIu64 " more bytes of %s memory with %" PRIu64 " of %" PRIu64 " in use)\n",
+        (uint64_t)size, cloxGetMemoryKindName(kind), (uint64_t)memory->bytes, (uint64_t)memory->limit);
+
+    exit(CLOX_EXIT_SOFTWARE);
+}
+
+static int execute(CloxVM_t *const vm, const char *const path, CloxCodeBlock_t *const codeBlock)
+{
+    CloxVMStatus_t status;
+
+    /* blocks the decoder rejects still run, on their bytecode */
+    cloxVMDecode(codeBlock);
+
+    for (status = cloxVMRun(vm, codeBlock); status == CLOX_VM_STATUS_RAISE; status = cloxVMResume(vm))
+    {
+        if (vm->signal != CLOX_COMPILER_SIGNAL_PRINT)
+            break;
+
+        CloxValue_t value = cloxVMPop(vm);
+
+        printValue(&value);
+    }
+
+    /* the values printed before the error come first */
+    fflush(stdout);
+
+    if (status == CLOX_VM_STATUS_ERROR)
+    {
+        CloxSourceLocation_t location;
+
+        if (cloxVMGetLocation(vm, &location))
+            fprintf(stderr, "%s:%" PRIu32 ":%" PRIu32 ": ", path, location.ln + 1, location.co + 1);
+
+        fprintf(stderr, "runtime error: %s\n", vm->error);
+
+        return CLOX_EXIT_SOFTWARE;
+    }
+    else if (status != CLOX_VM_STATUS_SUCCESS)
+    {
+        fprintf(stderr, "runtime error: unhandled signal %d\n", vm->signal);
+
+        return CLOX_EXIT_SOFTWARE;
+    }
+    else
+    {
+        return vm->exitCode;
+    }
+}
+
+static void dumpStats(CloxVM_t *const vm)
+{
+#if CLOX_VM_OPCODE_STATS
+    /* instrumented builds report where the time went */
+    CloxOpCodeStats_t *const stats = dim(CloxOpCodeStats_t, BYTE_MAX + 1);
+
+    cloxVMGetOpCodeStats(vm, stats);
+    cloxDumpOpCodeStats(stderr, stats);
+
+    dealloc(stats);
+#else
+    (void)vm;
+#endif
+
+    return;
+}
+
+static void writeProfile(const CloxProfiler_t *const profiler, const char *const path, const char *const *const paths, CloxCodeBlock_t *const *const codeBlocks, const size_t count)
+{
+    FILE *const stream = fopen(path, "w");
+
+    if (!stream || !cloxProfilerWrite(profiler, stream, (const CloxCodeBlock_t *const *)codeBlocks, paths, count))
+        fprintf(stderr, "error: cannot write '%s'\n", path);
+
+    if (stream)
+        fclose(stream);
+
+    return;
+}
+
+/* the scripts run on one virtual machine, so they share its natives and the
+ * globals defined by the host, not their variables (which live in their own
+ * registers); each one runs after the previous succeeded */
+static int run(const char *const *const paths, CloxCodeBlock_t *const *const codeBlocks, const size_t count, const char *const profile, const char *const tracePath)
+{
+    CloxProfiler_t profiler;
+    CloxTrace_t trace;
+    CloxVM_t vm;
+    FILE *traceStream = NULL;
+    int result = EXIT_SUCCESS;
+    size_t i;
+
+    if (tracePath && !(traceStream = fopen(tracePath, "wb")))
+    {
+        fprintf(stderr, "error: cannot write '%s'\n", tracePath);
+        return CLOX_EXIT_CANTCREAT;
+    }
+
+    cloxInitVM(&vm, 0);
+    defineNatives(&vm);
+
+    if (profile)
+        vm.profiler = cloxInitProfiler(&profiler, 0);
+
+    if (traceStream)
+        vm.trace = cloxInitTrace(&trace, 0, traceStream);
+
+    for (i = 0; (i < count) && (result == EXIT_SUCCESS); i++)
+        result = execute(&vm, paths[i], codeBlocks[i]);
+
+    if (profile)
+    {
+        writeProfile(&profiler, profile, paths, codeBlocks, count);
+        cloxFreeProfiler(&profiler);
+    }
+
+    if (traceStream)
+    {
+        if (!cloxTraceFlush(&trace) || fclose(traceStream))
+            fprintf(stderr, "error: cannot write '%s'\n", tracePath);
+
+        cloxFreeTrace(&trace);
+    }
+
+    dumpStats(&vm);
+    cloxFreeVM(&vm);
+
+    return result;
+}
 
-int main()
+/**
+ * The REPL compiles and runs each statement as soon as its last line arrives,
+ * on the same compiler and virtual machine, so the variables declared by a
+ * statement are visible to the following ones. The exit code is the one of the
+ * last statement.
+ */
+static int repl(const CloxOptimizationLevel_t optimization)
 {
-    printf("Hello, world!\n");
+    CloxSourceStream_t *const sourceStream = cloxOpenStandardSourceStream();
+    CloxSourceBuffer_t chunk;
+    CloxCodeBlock_t codeBlock;
+    CloxCompiler_t compiler;
+    CloxCompilerStatus_t status;
+    CloxArena_t arena;
+    CloxVM_t vm;
+
+    size_t capacity = CLOX_REPL_LINE_SIZE * 2, length = 0, count;
+    char *text = dim(char, capacity);
+    bool_t isLast = FALSE;
+    int result = EXIT_SUCCESS;
+
+    /* the pending lines are viewed as a buffer, the stream copies them once */
+    chunk.arena    = NULL;
+    chunk.memory   = NULL;
+    chunk.isMapped = FALSE;
+    chunk.mapping  = NULL;
+    chunk.validity = CLOX_SOURCE_VALIDITY_UNKNOWN;
+
+    cloxInitArena(&arena, 0);
+    cloxInitCompiler(&compiler, &arena);
+    cloxInitVM(&vm, 0);
+    defineNatives(&vm);
+
+    compiler.optimization = optimization;
+
+    while (!isLast)
+    {
+        if ((capacity - length) < CLOX_REPL_LINE_SIZE)
+        {
+            capacity *= 2;
+            text = redim(char, text, capacity);
+        }
+
+        count = cloxSourceStreamReadLine(sourceStream, text + length, capacity - length);
+        length += count;
+        isLast = (bool_t)!count;
+
+        /* a line longer than the free space is read in pieces */
+        if (!isLast && (text[length - 1] != EOL))
+            continue;
+
+        if (!length)
+            continue;
+
+        chunk.data = (byte_t *)text;
+        chunk.size = length;
+
+        cloxInitCodeBlock(&codeBlock, 0);
+
+        status = cloxCompileIncremental(&compiler, &chunk, sourceStream->path, &codeBlock, isLast);
+
+        if (status == CLOX_COMPILER_STATUS_SUCCESS)
+            result = execute(&vm, sourceStream->path, &codeBlock);
+        else if (status == CLOX_COMPILER_STATUS_ERROR)
+            result = CLOX_EXIT_DATAERR;
+
+        if (status != CLOX_COMPILER_STATUS_INCOMPLETE)
+            length = 0;
+
+        cloxFreeCodeBlock(&codeBlock);
+
+        /* the output of a statement is sent before waiting for the next one */
+        fflush(stdout);
+    }
+
+    dumpStats(&vm);
+
+    cloxFreeVM(&vm);
+    cloxFreeCompiler(&compiler);
+    cloxFreeArena(&arena);
+
+    /* stdin is left open, only the stream is released */
+    sourceStream->isOpen = FALSE;
+    cloxDeleteSourceStream(sourceStream);
+
+    dealloc(text);
+
+    return result;
+}
+
+/**
+ * A script is compiled only when its image is missing or stale, the stale ones
+ * are compiled together on the worker threads. The errors are reported in the
+ * order of the scripts and, if there are none, the scripts run in that order.
+ * The images hold the blocks optimized at the default level, so they are
+ * neither reused nor written at other levels.
+ */
+static int runScripts(const char *const *const paths, const size_t count, const size_t threads, const char *const profile, const char *const trace, const bool_t verify, const CloxOptimizationLevel_t optimization)
+{
+    const bool_t useImages = (bool_t)(optimization == CLOX_OPTIMIZATION_LEVEL_DEFAULT);
+
+    CloxImage_t **images = dim(CloxImage_t *, count);
+    CloxImageStamp_t *stamps = dim(CloxImageStamp_t, count);
+    CloxCodeBlock_t **codeBlocks = dim(CloxCodeBlock_t *, count);
+    CloxCompileJob_t *jobs = dim(CloxCompileJob_t, count);
+    char **imagePaths = dim(char *, count);
+
+    size_t i, jobsCount = 0;
+    int result = EXIT_SUCCESS;
+
+    for (i = 0; i < count; i++)
+    {
+        const size_t pathLength = strlen(paths[i]);
+
+        if (!cloxGetImageStamp(paths[i], &stamps[i]))
+        {
+            fprintf(stderr, "error: cannot open '%s'\n", paths[i]);
+            result = CLOX_EXIT_NOINPUT;
+            break;
+        }
+
+        imagePaths[i] = dim(char, pathLength + sizeof(CLOX_IMAGE_EXTENSION));
+
+        memcpy(imagePaths[i], paths[i], pathLength);
+        memcpy(imagePaths[i] + pathLength, CLOX_IMAGE_EXTENSION, sizeof(CLOX_IMAGE_EXTENSION));
+
+        images[i] = cloxCreateImageFromFile(imagePaths[i]);
+
+        if (!verify && useImages && images[i] && cloxImageIsFresh(images[i], &stamps[i]))
+        {
+            codeBlocks[i] = &images[i]->codeBlock;
+        }
+        else
+        {
+            codeBlocks[i] = &cloxInitCompileJob(&jobs[jobsCount], paths[i])->codeBlock;
+
+            jobs[jobsCount].verify         = verify;
+            jobs[jobsCount++].optimization = optimization;
+        }
+    }
+
+    if ((result == EXIT_SUCCESS) && (cloxCompileJobs(jobs, jobsCount, threads) < jobsCount))
+    {
+        for (i = 0; i < jobsCount; i++)
+        {
+            if (jobs[i].diagnostics)
+                fputs(jobs[i].diagnostics, stderr);
+
+            if (jobs[i].status == CLOX_COMPILE_JOB_STATUS_NOINPUT)
+            {
+                fprintf(stderr, "error: cannot read '%s'\n", jobs[i].path);
+
+                if (result == EXIT_SUCCESS)
+                    result = CLOX_EXIT_NOINPUT;
+            }
+            else if ((jobs[i].status == CLOX_COMPILE_JOB_STATUS_ERROR) && (result == EXIT_SUCCESS))
+            {
+                result = CLOX_EXIT_DATAERR;
+            }
+        }
+    }
+
+    if (result == EXIT_SUCCESS)
+    {
+        /* a missing image only costs a compilation, so errors are ignored */
+        for (i = 0; i < count; i++)
+        {
+            if (useImages && (!images[i] || (codeBlocks[i] != &images[i]->codeBlock)))
+                cloxWriteImage(imagePaths[i], codeBlocks[i], &stamps[i]);
+        }
+
+        result = run(paths, codeBlocks, count, profile, trace);
+    }
+
+    for (i = 0; i < jobsCount; i++)
+        cloxFreeCompileJob(&jobs[i]);
+
+    for (i = 0; i < count; i++)
+    {
+        if (images[i])
+            cloxDeleteImage(images[i]);
+
+        if (imagePaths[i])
+            dealloc(imagePaths[i]);
+    }
+
+    dealloc(imagePaths);
+    dealloc(jobs);
+    dealloc(codeBlocks);
+    dealloc(stamps);
+    dealloc(images);
+
+    return result;
+}
+
+/**
+ * The compiled script is stored next to the source (script.lox has its image
+ * in script.loxc) and it is reused while the source keeps its size and its
+ * modification time, so a script is compiled only once. Without scripts, or
+ * with "-", the statements are read from the standard input. The -j option
+ * sets the number of threads that compile the scripts, by default one for
+ * each processor. The -p option samples the scripts while they run and writes
+ * the samples into the given file, as collapsed stacks for flamegraph tools.
+ * The -t option records each executed instruction into the given file, for
+ * the clox-trace tool (only when the interpreter is built with the trace).
+ * The -c option compiles the scripts again, with the bodies of the functions
+ * that nothing calls, so that all their errors are reported. The -O0, -O1 and
+ * -O2 options select the optimization level of the compiled code (-O2 by
+ * default, -O0 keeps each instruction on its source line for debugging). The
+ * -m option limits the bytes of source, code, heap objects and strings that
+ * the scripts can use.
+ */
+int main(int argc, char **argv)
+{
+    const char *profile = NULL;
+    const char *trace = NULL;
+    CloxOptimizationLevel_t optimization = CLOX_OPTIMIZATION_LEVEL_DEFAULT;
+    bool_t verify = FALSE;
+    size_t threads = 0;
+    int i, count = 0;
+
+    CloxMemory_t memory;
+
+    cloxInitMemory(&memory, 0);
+    memory.onLimit = &memoryLimit;
+
+    for (i = 1; i < argc; i++)
+    {
+        const char *option = NULL;
+        const char *limit = NULL;
+        char *end;
+
+        if (!strcmp(argv[i], "-j") && ((i + 1) < argc))
+            option = argv[++i];
+        else if (!strncmp(argv[i], "-j", 2) && argv[i][2])
+            option = argv[i] + 2;
+        else if (!strcmp(argv[i], "-p") && ((i + 1) < argc))
+            profile = argv[++i];
+        else if (!strncmp(argv[i], "-p", 2) && argv[i][2])
+            profile = argv[i] + 2;
+        else if (!strcmp(argv[i], "-t") && ((i + 1) < argc))
+            trace = argv[++i];
+        else if (!strncmp(argv[i], "-t", 2) && argv[i][2])
+            trace = argv[i] + 2;
+        else if (!strcmp(argv[i], "-m") && ((i + 1) < argc))
+            limit = argv[++i];
+        else if (!strncmp(argv[i], "-m", 2) && argv[i][2])
+            limit = argv[i] + 2;
+        else if (!strcmp(argv[i], "-c"))
+            verify = TRUE;
+        else if (!strncmp(argv[i], "-O", 2) && (argv[i][2] >= '0') && (argv[i][2] <= '2') && !argv[i][3])
+            optimization = (CloxOptimizationLevel_t)(argv[i][2] - '0');
+        else
+            argv[1 + count++] = argv[i];
+
+        if (option && (!(threads = (size_t)strtoul(option, &end, 10)) || *end))
+        {
+            fprintf(stderr, "error: invalid number of threads '%s'\n", option);
+            return CLOX_EXIT_USAGE;
+        }
+
+        if (limit && (!(memory.limit = (size_t)strtoull(limit, &end, 10)) || *end))
+        {
+            fprintf(stderr, "error: invalid memory limit '%s'\n", limit);
+            return CLOX_EXIT_USAGE;
+        }
+    }
+
+    cloxSetMemory(&memory);
+
+    if (trace && !CLOX_VM_TRACE)
+    {
+        fputs("error: the interpreter is built without the trace (see CLOX_ENABLE_TRACE)\n", stderr);
+        return CLOX_EXIT_USAGE;
+    }
+
+    if (!count || ((count == 1) && !strcmp(argv[1], "-")))
+        return repl(optimization);
+
+    for (i = 1; i <= count; i++)
+    {
+        if (!strcmp(argv[i], "-") || !strcmp(argv[i], "-j") || !strcmp(argv[i], "-p") || !strcmp(argv[i], "-t") || !strcmp(argv[i], "-m") || !strncmp(argv[i], "-O", 2))
+        {
+            fprintf(stderr, "usage: %s [-c] [-O0 | -O1 | -O2] [-j threads] [-m bytes] [-p profile] [-t trace] [script... | -]\n", argv[0]);
+            return CLOX_EXIT_USAGE;
+        }
+    }
+
+    return runScripts((const char *const *)(argv + 1), (size_t)count, threads, profile, trace, verify, optimization);
 }
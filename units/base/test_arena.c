@@ -0,0 +1,75 @@
+#include "clox/base/arena.h"
+
+#include "check.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+int main()
+{
+    CloxArena_t arena;
+    CloxArenaMark_t mark;
+    byte_t *block, *other;
+    size_t i;
+
+    cloxInitArena(&arena, CLOX_PAGESIZ);
+    check(arena.chunk == NULL && arena.chunksCount == 0);
+
+    /* many small blocks share a few chunks */
+    for (i = 0; i < 1000; i++)
+    {
+        block = (byte_t *)cloxArenaAlloc(&arena, 24);
+
+        check(((uintptr_t)block % CLOX_ARENA_ALIGNMENT) == 0);
+        memset(block, (int)i, 24);
+    }
+
+    check(arena.allocated == 1000 * 32);
+    check(arena.chunksCount <= 10);
+
+    /* the zeroed arrays are zeroed */
+    block = arenadim(&arena, byte_t, 100);
+
+    for (i = 0; i < 100; i++)
+        check(block[i] == 0);
+
+    /* the last block grows in place, the others are copied */
+    other = (byte_t *)cloxArenaRealloc(&arena, block, 100, 200);
+    check(other == block);
+
+    block[0] = 42;
+    cloxArenaAlloc(&arena, 8);
+    other = (byte_t *)cloxArenaRealloc(&arena, block, 200, 400);
+    check(other != block && other[0] == 42);
+
+    /* rewinding releases the blocks allocated after the mark */
+    mark = cloxArenaMark(&arena);
+    i = arena.chunksCount;
+
+    cloxArenaAlloc(&arena, CLOX_PAGESIZ * 4);
+    check(arena.chunksCount == i + 1);
+
+    cloxArenaRewind(&arena, mark);
+    check(arena.chunksCount == i);
+    check(arena.allocated == mark.allocated);
+    check(arena.spare != NULL);
+
+    /* the spare chunk is reused by the next big allocation */
+    other = (byte_t *)arena.spare;
+    cloxArenaAlloc(&arena, CLOX_PAGESIZ * 2);
+    check((byte_t *)arena.chunk == other && arena.spare == NULL);
+
+    cloxFreeArena(&arena);
+    check(arena.chunk == NULL && arena.spare == NULL && arena.allocated == 0);
+
+    /* an arena can be rewound to the empty state */
+    mark = cloxArenaMark(&arena);
+    cloxArenaAlloc(&arena, 16);
+    cloxArenaRewind(&arena, mark);
+    check(arena.chunk == NULL && arena.chunksCount == 0);
+
+    cloxFreeArena(&arena);
+
+    return 0;
+}
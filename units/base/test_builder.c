@@ -0,0 +1,78 @@
+#include "clox/base/builder.h"
+#include "clox/base/intern.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+int main()
+{
+    CloxStringBuilder_t builder;
+    CloxStringTable_t table;
+    CloxMemoryStats_t stats;
+    size_t i, grows = 0, capacity;
+
+    cloxInitStringBuilder(&builder);
+    cloxInitStringTable(&table, NULL);
+
+    /* an empty builder is an empty string */
+    check(!strcmp(cloxStringBuilderChars(&builder), ""));
+    check(cloxStringBuilderHash(&builder) == cloxHashString("", 0));
+    check(cloxStringBuilderIntern(&builder, &table) == cloxStringTableIntern(&table, "", 0));
+
+    /* the buffer grows geometrically, so repeated appends don't copy the
+     * whole string each time */
+    capacity = builder.capacity;
+
+    for (i = 0; i < 10000; i++)
+    {
+        cloxStringBuilderAppend(&builder, "line ", 5);
+        cloxStringBuilderAppendChar(&builder, (char)('0' + (i % 10)));
+        cloxStringBuilderAppendString(&builder, "\n");
+
+        if (builder.capacity != capacity)
+            capacity = builder.capacity, grows++;
+    }
+
+    check(builder.length == 70000);
+    check(grows < 16 && builder.capacity < 2 * (builder.length + 1));
+    check(!strncmp(cloxStringBuilderChars(&builder), "line 0\nline 1\n", 14));
+    check(!strcmp(cloxStringBuilderChars(&builder) + builder.length - 7, "line 9\n"));
+
+    /* the hash is cached until the next append */
+    check(cloxStringBuilderHash(&builder) == cloxHashString(builder.chars, builder.length));
+    check(builder.hashed);
+
+    cloxStringBuilderClear(&builder);
+    check(!builder.hashed && builder.capacity == capacity);
+
+    /* formatted strings are appended in place, or after growing the buffer */
+    check(cloxStringBuilderAppendF(&builder, "%d + %d = %s", 2, 40, "42"));
+    check(!strcmp(cloxStringBuilderChars(&builder), "2 + 40 = 42"));
+
+    cloxStringBuilderClear(&builder);
+    cloxFreeStringBuilder(&builder);
+    check(builder.chars == NULL && builder.capacity == 0);
+
+    check(cloxStringBuilderAppendF(&builder, "%0200d|", 7));
+    check(builder.length == 201 && builder.chars[199] == '7' && builder.chars[200] == '|');
+    check(!cloxStringBuilderAppendF(&builder, NULL));
+
+    /* interning gets the same string as the characters would */
+    cloxStringBuilderClear(&builder);
+    cloxStringBuilderAppendString(&builder, "hello");
+    cloxStringBuilderAppendString(&builder, " world");
+
+    check(cloxStringBuilderIntern(&builder, &table) == cloxStringTableIntern(&table, "hello world", 11));
+    check(cloxStringBuilderHash(&builder) == cloxStringTableFind(&table, "hello world", 11)->hash);
+
+    /* the buffer is accounted as string memory */
+    cloxGetMemoryStats(builder.memory, CLOX_MEMORY_KIND_STRING, &stats);
+    check(stats.bytes >= builder.capacity);
+
+    cloxFreeStringBuilder(&builder);
+    cloxFreeStringTable(&table);
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include "clox/base/intern.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+int main()
+{
+    CloxStringTable_t table;
+    CloxArena_t arena;
+    const CloxString_t *a, *b;
+    const CloxString_t *strings[1000];
+    char name[16];
+    size_t i;
+
+    cloxInitStringTable(&table, NULL);
+    check(cloxStringTableFind(&table, "x", 1) == NULL);
+
+    /* equal strings are interned once, at the same address */
+    a = cloxStringTableIntern(&table, "hello world", 5);
+    b = cloxStringTableIntern(&table, "hello", 5);
+
+    check(cloxStringEquals(a, b));
+    check(a->length == 5 && !strcmp(a->chars, "hello"));
+    check(a->hash == cloxHashString("hello", 5));
+    check(cloxStringTableFind(&table, "hello", 5) == a);
+    check(cloxStringTableFind(&table, "hell", 4) == NULL);
+    check(!cloxStringEquals(a, cloxStringTableIntern(&table, "hell", 4)));
+    check(table.count == 2);
+
+    /* the empty string is a string too */
+    check(cloxStringTableIntern(&table, NULL, 0) == cloxStringTableIntern(&table, "", 0));
+    check(table.count == 3);
+
+    /* the decomposed form (e + combining acute) is the precomposed letter */
+    a = cloxStringTableIntern(&table, "caf\xC3\xA9", 5);
+    b = cloxStringTableIntern(&table, "cafe\xCC\x81", 6);
+
+    check(a == b);
+    check(a->length == 5 && !memcmp(a->chars, "caf\xC3\xA9", 5));
+    check(cloxStringTableFind(&table, "cafe\xCC\x81", 6) == a);
+
+    /* invalid UTF-8 is interned as it is */
+    a = cloxStringTableIntern(&table, "\xFF\xFE", 2);
+
+    check(a->length == 2 && !memcmp(a->chars, "\xFF\xFE", 2));
+    check(cloxStringTableIntern(&table, "\xFF\xFE", 2) == a);
+
+    /* growing never moves the strings */
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf(name, sizeof(name), "name%zu", i);
+        strings[i] = cloxStringTableIntern(&table, name, strlen(name));
+    }
+
+    check(table.count == 1005);
+    check((table.count * 4) <= (table.capacity * 3));
+
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf(name, sizeof(name), "name%zu", i);
+        check(cloxStringTableFind(&table, name, strlen(name)) == strings[i]);
+        check(!strcmp(strings[i]->chars, name));
+    }
+
+    cloxFreeStringTable(&table);
+    check(table.count == 0 && table.slots == NULL);
+
+    /* the same works with an arena, which owns the strings */
+    cloxInitArena(&arena, 0);
+    cloxInitStringTable(&table, &arena);
+
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf(name, sizeof(name), "name%zu", i);
+        strings[i] = cloxStringTableIntern(&table, name, strlen(name));
+    }
+
+    for (i = 0; i < 1000; i++)
+    {
+        snprintf(name, sizeof(name), "name%zu", i);
+        check(cloxStringTableIntern(&table, name, strlen(name)) == strings[i]);
+    }
+
+    check(table.count == 1000);
+
+    cloxFreeStringTable(&table);
+    cloxFreeArena(&arena);
+
+    return 0;
+}
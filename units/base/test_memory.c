@@ -0,0 +1,153 @@
+#include "clox/base/intern.h"
+#include "clox/base/memory.h"
+#include "clox/base/thread.h"
+
+#include "check.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static size_t calls = 0;
+
+static void *CLOX_STDCALL countingAllocator(void *const data, void *const block, const size_t oldSize, const size_t newSize)
+{
+    (void)oldSize;
+
+    ++*(size_t *)data;
+
+    if (!newSize)
+    {
+        free(block);
+        return NULL;
+    }
+
+    return realloc(block, newSize);
+}
+
+static jmp_buf recovery;
+
+static void CLOX_STDCALL recover(CloxMemory_t *const memory, const CloxMemoryKind_t kind, const size_t size)
+{
+    (void)memory, (void)kind, (void)size;
+
+    longjmp(recovery, 1);
+}
+
+#define THREADS 4
+
+static CloxMemory_t shared;
+static volatile size_t charged = 0;
+
+static void CLOX_STDCALL chargeTogether(void *const argument)
+{
+    (void)argument;
+
+    cloxMemoryCharge(&shared, CLOX_MEMORY_KIND_OTHER, 1024);
+    cloxAtomicFetchAdd(&charged, 1);
+
+    /* every thread holds its bytes until all of them are charged */
+    while (cloxAtomicFetchAdd(&charged, 0) < THREADS)
+        continue;
+
+    cloxMemoryDischarge(&shared, CLOX_MEMORY_KIND_OTHER, 1024);
+
+    return;
+}
+
+int main()
+{
+    CloxMemory_t memory;
+    CloxMemoryStats_t stats;
+    CloxStringTable_t table;
+    CloxThread_t threads[THREADS];
+    void *block;
+
+    cloxInitMemory(&memory, 0);
+    cloxSetMemoryAllocator(&memory, &countingAllocator, &calls);
+
+    check(cloxGetMemory() != &memory);
+    check(cloxSetMemory(&memory) != &memory);
+    check(cloxGetMemory() == &memory);
+
+    /* the tables take the current memory, then keep it */
+    cloxInitStringTable(&table, NULL);
+    cloxStringTableIntern(&table, "alpha", 5);
+    cloxStringTableIntern(&table, "beta", 4);
+    cloxStringTableIntern(&table, "alpha", 5);
+
+    cloxGetMemoryStats(&memory, CLOX_MEMORY_KIND_STRING, &stats);
+
+    /* the slots and two strings */
+    check(stats.count == 3);
+    check(stats.bytes == memory.bytes);
+    check(stats.bytes > (CLOX_STRING_TABLE_CAPACITY * sizeof(CloxString_t *)));
+    check(calls == 3);
+
+    cloxFreeStringTable(&table);
+    cloxGetMemoryStats(&memory, CLOX_MEMORY_KIND_STRING, &stats);
+
+    check(stats.count == 0);
+    check(stats.bytes == 0);
+    check(stats.allocations == 3);
+    check(memory.bytes == 0);
+    check(calls == 6);
+
+    /* resizes move the bytes, not the number of blocks */
+    block = cloxMemoryAlloc(&memory, CLOX_MEMORY_KIND_CODE, 64);
+    block = cloxMemoryRealloc(&memory, CLOX_MEMORY_KIND_CODE, block, 64, 256);
+    cloxGetMemoryStats(&memory, CLOX_MEMORY_KIND_CODE, &stats);
+
+    check(stats.bytes == 256);
+    check(stats.count == 1);
+    check(stats.allocations == 2);
+    check(memory.peak >= 256);
+
+    /* over the limit the allocations fail, the accounting doesn't change */
+    memory.limit = 512;
+
+    check(cloxMemoryTryAlloc(&memory, CLOX_MEMORY_KIND_OTHER, 512) == NULL);
+    check(!cloxMemoryCharge(&memory, CLOX_MEMORY_KIND_HEAP, 257));
+    check(cloxMemoryCharge(&memory, CLOX_MEMORY_KIND_HEAP, 256));
+    check(memory.bytes == 512);
+    check(memory.failures == 2);
+
+    cloxMemoryDischarge(&memory, CLOX_MEMORY_KIND_HEAP, 256);
+
+    /* the limit function recovers from the checked allocations */
+    memory.onLimit = &recover;
+
+    if (!setjmp(recovery))
+    {
+        block = cloxMemoryRealloc(&memory, CLOX_MEMORY_KIND_CODE, block, 256, 1024);
+        check(FALSE);
+    }
+
+    check(memory.failures == 3);
+    check(memory.bytes == 256);
+
+    cloxMemoryFree(&memory, CLOX_MEMORY_KIND_CODE, block, 256);
+    cloxGetMemoryStats(&memory, CLOX_MEMORY_KIND_CODE, &stats);
+
+    check(stats.bytes == 0);
+    check(stats.count == 0);
+    check(memory.bytes == 0);
+
+    /* the peak is raised by the thread that reached it, the threads that
+     * charged before it can't lower it */
+    cloxInitMemory(&shared, 0);
+
+    for (size_t i = 0; i < THREADS; i++)
+        check((threads[i] = cloxThreadCreate(&chargeTogether, NULL)) != NULL);
+
+    for (size_t i = 0; i < THREADS; i++)
+        check(cloxThreadJoin(threads[i]));
+
+    check(shared.bytes == 0);
+    check(shared.peak == (THREADS * 1024));
+
+    check(cloxSetMemory(NULL) == &memory);
+    check(cloxGetMemory() != &memory);
+
+    return 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+/**
+ * @file        check.h
+ *
+ * @author      Federico Cristina <federico.cristina@outlook.it>
+ *
+ * @copyright   Copyright (c) 2024 Federico Cristina
+ *
+ *              This file is part of the clox programming language project,
+ *              under the MIT License. See repo's LICENSE file for license
+ *              informations.
+ *
+ * @brief       In this header is defined the assertion shared by the unit
+ *              tests: a failed check reports its condition and location, then
+ *              makes the enclosing function return 1.
+ */
+
+#ifndef CLOX_UNITS_CHECK_H_
+#define CLOX_UNITS_CHECK_H_
+
+#include <stdio.h>
+
+#define check(condition)                                                  \
+    do                                                                    \
+    {                                                                     \
+        if (!(condition))                                                 \
+        {                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return 1;                                                     \
+        }                                                                 \
+    } while (0)
+
+#endif /* CLOX_UNITS_CHECK_H_ */
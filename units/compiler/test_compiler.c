@@ -0,0 +1,412 @@
+#include "clox/compiler/compiler.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char program[] =
+    "var a = 1;\n"
+    "var b = 2.5;\n"
+    "print a + b * 2;\n"
+    "var sum = 0;\n"
+    "for (var i = 0; i < 10; i = i + 1) { sum = sum + i; }\n"
+    "print sum;\n"
+    "var n = 0;\n"
+    "while (n < 3) { n = n + 1; if (n == 2) print true; else print nil; }\n"
+    "print !true or 1 > 2 and false;\n"
+    "print (1 != 2) and -3 <= -3;\n"
+    "{ var a = 10; print a / 4; }\n"
+    "print a = 7;\n";
+
+static const char *const errors[] = {
+    "var a = ;",
+    "print -;",
+    "{ var c = 1; var c = 2; }",
+    "{ var d = d; }",
+    "1 = 2;",
+    "print (1;",
+    "@",
+    "{ var f = 1; f(); }",
+    "print max(1, 2;",
+    "return 1;",
+    "fun f(a) { return a; } print f();",
+    "fun f() {} print f;",
+    "fun f() { print 1;",
+    "{ fun g() {} }",
+    "fun f() {} fun f() {}",
+    "var v = 1; fun h() { print v; } h();",
+};
+
+/* only the called functions are compiled, the broken body is not */
+static const char functions[] =
+    "fun broken() { print ; }\n"
+    "fun fact(n) { if (n <= 1) return 1; return n * fact(n - 1); }\n"
+    "fun even(n) { if (n == 0) return true; return odd(n - 1); }\n"
+    "fun odd(n) { if (n == 0) return false; return even(n - 1); }\n"
+    "fun none(a, b) { var c = a + b; }\n"
+    "print fact(10);\n"
+    "print odd(7);\n"
+    "print none(1, 2);\n";
+
+/* the values printed by program, nil is VOID */
+static const CloxValueType_t types[] = {
+    CLOX_VALUE_TYPE_REAL, CLOX_VALUE_TYPE_REAL, CLOX_VALUE_TYPE_VOID, CLOX_VALUE_TYPE_BOOL, CLOX_VALUE_TYPE_VOID,
+    CLOX_VALUE_TYPE_BOOL, CLOX_VALUE_TYPE_BOOL, CLOX_VALUE_TYPE_REAL, CLOX_VALUE_TYPE_REAL,
+};
+
+static const double reals[] = { 6, 45, 0, 1, 0, 0, 1, 2.5, 7 };
+
+static const char *CLOX_STDCALL nativeMax(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    (void)vm;
+
+    for (size_t i = 1; i < count; i++)
+        if (cloxValueAsReal(arguments[i]) > cloxValueAsReal(arguments[0]))
+            arguments[0] = arguments[i];
+
+    return NULL;
+}
+
+static bool_t compile(CloxCompiler_t *const compiler, const char *const text, CloxCodeBlock_t *const block)
+{
+    CloxSourceBuffer_t *buffer = cloxCreateSourceBufferFromText(text);
+    bool_t result = cloxCompile(compiler, buffer, "test", block);
+
+    cloxDeleteSourceBuffer(buffer);
+
+    return result;
+}
+
+/* checks that the errors written since the specified position contain the
+ * message, then moves back to the end to write the next ones */
+static bool_t reported(FILE *const stream, const long position, const char *const message)
+{
+    char line[256];
+    bool_t found = FALSE;
+
+    fseek(stream, position, SEEK_SET);
+
+    while (!found && fgets(line, sizeof(line), stream))
+        found = (bool_t)(strstr(line, message) != NULL);
+
+    fseek(stream, 0, SEEK_END);
+
+    return found;
+}
+
+int main()
+{
+    CloxCompiler_t compiler;
+    CloxCodeBlock_t block;
+    CloxVM_t vm;
+    size_t printed = 0;
+
+    cloxInitCompiler(&compiler, NULL);
+    cloxInitCodeBlock(&block, 0);
+    cloxInitVM(&vm, 0);
+
+    /* errors are expected, they are not shown */
+    compiler.errorStream = tmpfile();
+
+    check(compile(&compiler, program, &block));
+    check(compiler.errorsCount == 0);
+
+    CloxVMStatus_t status;
+
+    for (status = cloxVMRun(&vm, &block); status == CLOX_VM_STATUS_RAISE; status = cloxVMResume(&vm))
+    {
+        check(vm.signal == CLOX_COMPILER_SIGNAL_PRINT);
+        check(printed < (sizeof(types) / sizeof(*types)));
+
+        CloxValue_t value = cloxVMPop(&vm);
+
+        check(cloxValueType(value) == types[printed]);
+
+        if (types[printed] == CLOX_VALUE_TYPE_REAL)
+            check(cloxValueAsReal(value) == reals[printed]);
+        else if (types[printed] == CLOX_VALUE_TYPE_BOOL)
+            check(asBool(cloxValueAsBool(value)) == (reals[printed] != 0));
+
+        printed++;
+    }
+
+    check(status == CLOX_VM_STATUS_SUCCESS);
+    check(printed == (sizeof(types) / sizeof(*types)));
+    check(vm.stackTop == vm.stack);
+
+    /* names not in scope are globals of the host, read and written through
+     * the inline caches of their instructions */
+    cloxFreeCodeBlock(&block);
+    cloxInitCodeBlock(&block, 0);
+
+    check(compile(&compiler, "for (var i = 0; i < 100; i = i + 1) total = total + step;", &block));
+    check(block.cachesCount == 3);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+
+    cloxVMDefineGlobal(&vm, "total", cloxRealValue(0));
+    cloxVMDefineGlobal(&vm, "step", cloxRealValue(0.5));
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsReal(*cloxVMGetGlobal(&vm, "total")) == 50);
+
+    /* a removed global is looked up again, the error points to its name */
+    check(cloxVMUndefineGlobal(&vm, "step"));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(cloxValueAsReal(*cloxVMGetGlobal(&vm, "total")) == 50);
+
+    CloxSourceLocation_t location;
+
+    check(cloxVMGetLocation(&vm, &location));
+    check(location.ln == 0 && location.co == 52);
+
+    /* runtime errors are located at their operator */
+    cloxFreeCodeBlock(&block);
+    cloxInitCodeBlock(&block, 0);
+
+    check(compile(&compiler, "var a = 1;\nvar b = true;\nprint a\n    - b;", &block));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(cloxVMGetLocation(&vm, &location));
+    check(location.ln == 3 && location.co == 4);
+
+    /* calls of names not in scope go to the natives of the host */
+    cloxFreeCodeBlock(&block);
+    cloxInitCodeBlock(&block, 0);
+
+    check(compile(&compiler, "print max(1, 3 * 2, 4) + max(-1);\nprint max(max());", &block));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+
+    cloxVMDefineNative(&vm, "max", &nativeMax, CLOX_VM_NATIVE_VARIADIC);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_RAISE);
+    check(cloxValueAsReal(cloxVMPop(&vm)) == 5);
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_RAISE);
+    check(cloxValueType(cloxVMPop(&vm)) == CLOX_VALUE_TYPE_VOID);
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_SUCCESS);
+
+    cloxVMDefineNative(&vm, "max", &nativeMax, 2);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(cloxVMGetLocation(&vm, &location));
+    check(location.ln == 0 && location.co == 6);
+
+    /* function bodies are compiled at the end of the source, when they are
+     * called, unless the compiler verifies them all */
+    cloxFreeCodeBlock(&block);
+    cloxInitCodeBlock(&block, 0);
+
+    check(compile(&compiler, functions, &block));
+    check(compiler.functionsCount == 5);
+    check(compiler.functions[0].offset == SIZE_MAX && compiler.functions[4].offset != SIZE_MAX);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_RAISE);
+    check(cloxValueAsReal(cloxVMPop(&vm)) == 3628800);
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_RAISE);
+    check(asBool(cloxValueAsBool(cloxVMPop(&vm))));
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_RAISE);
+    check(cloxValueType(cloxVMPop(&vm)) == CLOX_VALUE_TYPE_VOID);
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_SUCCESS);
+    check(vm.stackTop == vm.stack && vm.framesCount == 0);
+
+    /* a call that is the whole value of a return replaces the frame of its
+     * caller, so deep tail recursion runs in constant frames */
+    static const char *const loops[] = {
+        "fun loop(n) { if (n < 1) return 0; return loop(n - 1); }\nprint loop(1000000);",
+        "fun even(n) { if (n == 0) return true; return odd(n - 1); }\nfun odd(n) { if (n == 0) return false; return even(n - 1); }\nprint even(1000000);",
+    };
+
+    for (size_t i = 0; i < (sizeof(loops) / sizeof(*loops)); i++)
+    {
+        cloxFreeCodeBlock(&block);
+        cloxInitCodeBlock(&block, 0);
+
+        check(compile(&compiler, loops[i], &block));
+        check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_RAISE);
+        check(vm.framesCapacity < 1000);
+
+        const CloxValue_t value = cloxVMPop(&vm);
+
+        check(i ? asBool(cloxValueAsBool(value)) : (cloxValueAsReal(value) == 0));
+        check(cloxVMResume(&vm) == CLOX_VM_STATUS_SUCCESS);
+        check(vm.stackTop == vm.stack && vm.framesCount == 0 && vm.windowsCount == 0);
+    }
+
+    compiler.verify = TRUE;
+
+    cloxFreeCodeBlock(&block);
+    cloxInitCodeBlock(&block, 0);
+
+    check(!compile(&compiler, functions, &block));
+    check(compiler.errorsCount == 1);
+
+    compiler.verify = FALSE;
+
+    /* a function that nothing calls adds no code */
+    cloxFreeCodeBlock(&block);
+    cloxInitCodeBlock(&block, 0);
+
+    check(compile(&compiler, "print 1;", &block));
+
+    const size_t count = block.count;
+
+    cloxFreeCodeBlock(&block);
+    cloxInitCodeBlock(&block, 0);
+
+    check(compile(&compiler, "fun f(x) { return x * 2; }\nprint 1;", &block));
+    check(block.count == count);
+
+    /* the bodies verified but never called are dead code, which the
+     * optimizer drops in a time linear in the size of the block (the body
+     * called is laid out after them) */
+    const size_t uncalled = 2000;
+    char *const text = (char *)malloc(uncalled * 96 + 64);
+    size_t length = (size_t)sprintf(text, "fun g(x) { return x + 1; }\n");
+
+    for (size_t i = 0; i < uncalled; i++)
+        length += (size_t)sprintf(text + length, "fun f%zu(x) { var y = x + %zu; if (y > 3) return y * 2; return y - 1; }\n", i, i);
+
+    strcpy(text + length, "print g(1);");
+
+    cloxFreeCodeBlock(&block);
+    cloxInitCodeBlock(&block, 0);
+
+    compiler.verify       = TRUE;
+    compiler.optimization = CLOX_OPTIMIZATION_LEVEL_O2;
+
+    const clock_t begin = clock();
+
+    check(compile(&compiler, text, &block));
+    check(((double)(clock() - begin) / CLOCKS_PER_SEC) < 2.0);
+
+    compiler.verify       = FALSE;
+    compiler.optimization = CLOX_OPTIMIZATION_LEVEL_DEFAULT;
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_RAISE);
+    check(cloxValueAsReal(cloxVMPop(&vm)) == 2);
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_SUCCESS);
+
+    free(text);
+
+    /* each broken statement reports one error, the parser recovers after it */
+    for (size_t i = 0; i < (sizeof(errors) / sizeof(*errors)); i++)
+    {
+        cloxFreeCodeBlock(&block);
+        cloxInitCodeBlock(&block, 0);
+
+        check(!compile(&compiler, errors[i], &block));
+        check(compiler.errorsCount == 1);
+    }
+
+    /* the variables of the script live in its registers, a function reading
+     * one is rejected with a diagnostic (it is not a global) */
+    long position = ftell(compiler.errorStream);
+
+    check(!compile(&compiler, "var v = 1; fun h() { return v; } print h();", &block));
+    check(reported(compiler.errorStream, position, "can't use a variable of the script in a function"));
+
+    /* the chunks of a session share their variables and their functions,
+     * incomplete ones wait for the lines that follow them */
+    static const char *const chunks[] = {
+        "var a = 2;\n", "{\n", "  var b = 3;\n", "  a = a * b;\n}\n", "var c = ;\n", "print a + c;\n", "var c = a +\n", "1; print c;",
+        "fun sq(x) {\n", "  return x * x;\n} print sq(c);\n", "fun f(x) { return x * 2; }\n", "print f(21) + sq(2);\n",
+        "fun g(x) { return f(x) + 1; } print g(f(1));\n", "fun bad(x) {\n  return x + true;\n}\n", "print bad(1);\n",
+        "fun lost(x) { return x +; }\n", "print lost(1);\n",
+    };
+    static const CloxCompilerStatus_t statuses[] = {
+        CLOX_COMPILER_STATUS_SUCCESS, CLOX_COMPILER_STATUS_INCOMPLETE, CLOX_COMPILER_STATUS_INCOMPLETE, CLOX_COMPILER_STATUS_SUCCESS,
+        CLOX_COMPILER_STATUS_ERROR, CLOX_COMPILER_STATUS_SUCCESS, CLOX_COMPILER_STATUS_INCOMPLETE, CLOX_COMPILER_STATUS_SUCCESS,
+        CLOX_COMPILER_STATUS_INCOMPLETE, CLOX_COMPILER_STATUS_SUCCESS, CLOX_COMPILER_STATUS_SUCCESS, CLOX_COMPILER_STATUS_SUCCESS,
+        CLOX_COMPILER_STATUS_SUCCESS, CLOX_COMPILER_STATUS_SUCCESS, CLOX_COMPILER_STATUS_SUCCESS,
+        CLOX_COMPILER_STATUS_ERROR, CLOX_COMPILER_STATUS_ERROR,
+    };
+    static const double results[] = { 0, 0, 0, 0, 0, 0, 0, 7, 0, 49, 0, 46, 5 };
+
+    char pending[256] = { 0 };
+    CloxSourceBuffer_t *buffer;
+    CloxCompilerStatus_t compiled;
+
+    cloxFreeCompiler(&compiler);
+    cloxInitCompiler(&compiler, NULL);
+    compiler.errorStream = tmpfile();
+
+    for (size_t i = 0; i < (sizeof(chunks) / sizeof(*chunks)); i++)
+    {
+        strcat(pending, chunks[i]);
+
+        cloxFreeCodeBlock(&block);
+        cloxInitCodeBlock(&block, 0);
+
+        buffer = cloxCreateSourceBufferFromText(pending);
+        compiled = cloxCompileIncremental(&compiler, buffer, "test", &block, FALSE);
+        cloxDeleteSourceBuffer(buffer);
+
+        check(compiled == statuses[i]);
+
+        if (compiled == CLOX_COMPILER_STATUS_INCOMPLETE)
+            continue;
+
+        pending[0] = '\0';
+
+        /* the functions of a broken chunk are dropped, their calls are
+         * reported instead of failing as missing native functions */
+        if (i == 16)
+            check(reported(compiler.errorStream, position, "function declared by a chunk that failed to compile"));
+
+        position = ftell(compiler.errorStream);
+
+        if (compiled == CLOX_COMPILER_STATUS_ERROR)
+            continue;
+
+        status = cloxVMRun(&vm, &block);
+
+        /* c is not declared by the broken chunk, so it is a missing global */
+        if (i == 5)
+        {
+            check(status == CLOX_VM_STATUS_ERROR);
+            check(cloxVMGetLocation(&vm, &location));
+            check(location.ln == 6 && location.co == 10);
+            continue;
+        }
+
+        /* a function of a previous chunk is compiled again where it is
+         * called, its lines are the ones of its chunk */
+        if (i == 14)
+        {
+            check(status == CLOX_VM_STATUS_ERROR);
+            check(cloxVMGetLocation(&vm, &location));
+            check(location.ln == 15 && location.co == 11);
+            continue;
+        }
+
+        if ((i < (sizeof(results) / sizeof(*results))) && results[i])
+        {
+            check(status == CLOX_VM_STATUS_RAISE);
+            check(cloxValueAsReal(cloxVMPop(&vm)) == results[i]);
+            status = cloxVMResume(&vm);
+        }
+
+        check(status == CLOX_VM_STATUS_SUCCESS);
+    }
+
+    check(compiler.localsCount == 2 && compiler.line == 20);
+    check(compiler.functionsKept == 4 && compiler.chunksCount == 4);
+
+    /* the end of the input is compiled even if it is incomplete */
+    buffer = cloxCreateSourceBufferFromText("print (a");
+    check(cloxCompileIncremental(&compiler, buffer, "test", &block, FALSE) == CLOX_COMPILER_STATUS_INCOMPLETE);
+    check(cloxCompileIncremental(&compiler, buffer, "test", &block, TRUE) == CLOX_COMPILER_STATUS_ERROR);
+    check(compiler.errorsCount == 1);
+    cloxDeleteSourceBuffer(buffer);
+
+    if (compiler.errorStream)
+        fclose(compiler.errorStream);
+
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&block);
+    cloxFreeCompiler(&compiler);
+
+    return 0;
+}
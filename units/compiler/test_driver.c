@@ -0,0 +1,98 @@
+#include "clox/compiler/driver.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define MODULES_COUNT 24
+
+static char paths[MODULES_COUNT][32];
+
+static int writeModules(void)
+{
+    for (int i = 0; i < MODULES_COUNT; i++)
+    {
+        FILE *stream;
+
+        snprintf(paths[i], sizeof(paths[i]), "test_driver_%d.lox", i);
+        check((stream = fopen(paths[i], "w")) != NULL);
+
+        /* every seventh module has an error, the others differ by their size */
+        if ((i % 7) == 3)
+            fprintf(stream, "var x = %d;\nprint x +;\n", i);
+        else
+            for (int j = 0; j <= i; j++)
+                fprintf(stream, "var a%d = %d;\nfor (var i = 0; i < a%d; i = i + 1) { print i * %d; }\n", j, j, j, i);
+
+        fclose(stream);
+    }
+
+    return 0;
+}
+
+static int compileAll(CloxCompileJob_t *const jobs, const size_t threads, const size_t expected)
+{
+    for (int i = 0; i < MODULES_COUNT; i++)
+        cloxInitCompileJob(&jobs[i], paths[i]);
+
+    check(cloxCompileJobs(jobs, MODULES_COUNT, threads) == expected);
+
+    return 0;
+}
+
+int main()
+{
+    CloxCompileJob_t serial[MODULES_COUNT + 1], parallel[MODULES_COUNT + 1];
+    size_t i;
+
+    check(writeModules() == 0);
+
+    /* the results are the same whatever the number of workers */
+    check(compileAll(serial, 1, MODULES_COUNT - 3) == 0);
+    check(compileAll(parallel, 8, MODULES_COUNT - 3) == 0);
+
+    for (i = 0; i < MODULES_COUNT; i++)
+    {
+        check(serial[i].status == parallel[i].status);
+
+        if ((i % 7) == 3)
+        {
+            check(serial[i].status == CLOX_COMPILE_JOB_STATUS_ERROR);
+            check(serial[i].diagnostics && parallel[i].diagnostics);
+            check(!strcmp(serial[i].diagnostics, parallel[i].diagnostics));
+            check(!strncmp(parallel[i].diagnostics, paths[i], strlen(paths[i])));
+            check(strstr(parallel[i].diagnostics, ":2:") != NULL);
+        }
+        else
+        {
+            check(serial[i].status == CLOX_COMPILE_JOB_STATUS_SUCCESS);
+            check(!serial[i].diagnostics && !parallel[i].diagnostics);
+            check(serial[i].codeBlock.count == parallel[i].codeBlock.count);
+            check(!memcmp(serial[i].codeBlock.array, parallel[i].codeBlock.array, serial[i].codeBlock.count));
+            check(serial[i].codeBlock.constantsCount == parallel[i].codeBlock.constantsCount);
+        }
+
+        cloxFreeCompileJob(&serial[i]);
+        cloxFreeCompileJob(&parallel[i]);
+    }
+
+    /* missing modules are reported on their job, the others still compile */
+    cloxInitCompileJob(&parallel[0], paths[0]);
+    cloxInitCompileJob(&parallel[1], "test_driver_missing.lox");
+    cloxInitCompileJob(&parallel[2], paths[1]);
+
+    check(cloxCompileJobs(parallel, 3, 0) == 2);
+    check(parallel[1].status == CLOX_COMPILE_JOB_STATUS_NOINPUT);
+    check(parallel[0].status == CLOX_COMPILE_JOB_STATUS_SUCCESS && parallel[2].status == CLOX_COMPILE_JOB_STATUS_SUCCESS);
+
+    for (i = 0; i < 3; i++)
+        cloxFreeCompileJob(&parallel[i]);
+
+    check(cloxCompileJobs(NULL, 0, 4) == 0);
+
+    for (i = 0; i < MODULES_COUNT; i++)
+        remove(paths[i]);
+
+    return 0;
+}
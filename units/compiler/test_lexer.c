@@ -0,0 +1,101 @@
+#include "clox/compiler/lexer.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char source[] =
+    "fun fib(n) {\n"
+    "    if (n < 2) return n; // a comment with \xC3\xA8\n"
+    "    return fib(n - 1) + fib(n - 2);\n"
+    "}\n"
+    "var s = \"two\nlines\"; print s != nil and 3.25 >= 1;\n";
+
+static const CloxTokenKind_t kinds[] = {
+    CLOX_TOKEN_KIND_FUN, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_LEFT_PAREN, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_RIGHT_PAREN, CLOX_TOKEN_KIND_LEFT_BRACE,
+    CLOX_TOKEN_KIND_IF, CLOX_TOKEN_KIND_LEFT_PAREN, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_LESS, CLOX_TOKEN_KIND_NUMBER, CLOX_TOKEN_KIND_RIGHT_PAREN, CLOX_TOKEN_KIND_RETURN, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_SEMICOLON,
+    CLOX_TOKEN_KIND_RETURN, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_LEFT_PAREN, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_MINUS, CLOX_TOKEN_KIND_NUMBER, CLOX_TOKEN_KIND_RIGHT_PAREN,
+    CLOX_TOKEN_KIND_PLUS, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_LEFT_PAREN, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_MINUS, CLOX_TOKEN_KIND_NUMBER, CLOX_TOKEN_KIND_RIGHT_PAREN, CLOX_TOKEN_KIND_SEMICOLON,
+    CLOX_TOKEN_KIND_RIGHT_BRACE,
+    CLOX_TOKEN_KIND_VAR, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_EQUAL, CLOX_TOKEN_KIND_STRING, CLOX_TOKEN_KIND_SEMICOLON, CLOX_TOKEN_KIND_PRINT, CLOX_TOKEN_KIND_IDENTIFIER, CLOX_TOKEN_KIND_BANG_EQUAL,
+    CLOX_TOKEN_KIND_NIL, CLOX_TOKEN_KIND_AND, CLOX_TOKEN_KIND_NUMBER, CLOX_TOKEN_KIND_GREATER_EQUAL, CLOX_TOKEN_KIND_NUMBER, CLOX_TOKEN_KIND_SEMICOLON,
+    CLOX_TOKEN_KIND_EOF,
+};
+
+int main()
+{
+    CloxSourceStream_t *stream = cloxCreateSourceStreamFromText(source, CLOX_SOURCE_ENCODING_UTF_8);
+    CloxSourceBuffer_t *buffer;
+    CloxLexer_t lexer;
+    CloxArena_t arena;
+    CloxSourceLocation_t location;
+    size_t i, size;
+    clock_t begin;
+    double seconds;
+    char *text;
+
+    cloxInitLexer(&lexer, NULL);
+
+    check(cloxLexerScan(&lexer, stream) == countof(kinds));
+    check(lexer.errorsCount == 0);
+
+    for (i = 0; i < countof(kinds); i++)
+        check(lexer.tokens[i].kind == kinds[i]);
+
+    cloxDumpLexer(&lexer, stdout);
+
+    /* lexemes are slices of the buffer, locations are zero based */
+    check(lexer.tokens[1].length == 3 && !memcmp(cloxLexerTokenText(&lexer, &lexer.tokens[1]), "fib", 3));
+    check(lexer.tokens[6].line == 1 && lexer.tokens[6].column == 4);
+    check(lexer.tokens[15].line == 2 && lexer.tokens[15].column == 4);
+    check(lexer.tokens[34].length == 11 && lexer.tokens[35].line == 5 && lexer.tokens[35].column == 6);
+    check(lexer.tokens[41].length == 4 && !memcmp(cloxLexerTokenText(&lexer, &lexer.tokens[41]), "3.25", 4));
+
+    location = cloxTokenLocation(&lexer.tokens[31]);
+    check(location.ln == 4 && location.co == 0 && location.ch == lexer.tokens[31].offset);
+
+    cloxDeleteSourceStream(stream);
+
+    /* errors are tokens too */
+    buffer = cloxCreateSourceBufferFromText("a # \xC3\xA8 \"open");
+    check(cloxLexerScanBuffer(&lexer, buffer) == 5);
+    check(lexer.errorsCount == 3);
+    check(lexer.tokens[1].kind == CLOX_TOKEN_KIND_ERROR && lexer.tokens[1].error == CLOX_TOKEN_ERROR_UNEXPECTED_CHARACTER);
+    check(lexer.tokens[2].length == 2);
+    check(lexer.tokens[3].error == CLOX_TOKEN_ERROR_UNTERMINATED_STRING && lexer.tokens[3].length == 5);
+    cloxDeleteSourceBuffer(buffer);
+
+    cloxFreeLexer(&lexer);
+
+    /* throughput over a big source, with the tokens taken from an arena */
+    size = strlen(source) * 20000;
+    text = (char *)malloc(size + 1);
+
+    for (i = 0; i < 20000; i++)
+        memcpy(text + i * strlen(source), source, strlen(source));
+
+    text[size] = '\0';
+    buffer = cloxCreateSourceBufferFromText(text);
+
+    cloxInitArena(&arena, 0);
+    cloxInitLexer(&lexer, &arena);
+
+    begin = clock();
+    check(cloxLexerScanBuffer(&lexer, buffer) == (countof(kinds) - 1) * 20000 + 1);
+    seconds = (double)(clock() - begin) / CLOCKS_PER_SEC;
+
+    check(lexer.scannedBytes == size);
+    check(lexer.tokens[lexer.tokensCount - 1].line == 20000 * 6);
+
+    printf("lexer: %zu bytes, %zu tokens, %.1f MB/s\n", lexer.scannedBytes, lexer.tokensCount, seconds > 0 ? (double)size / (1024.0 * 1024.0) / seconds : 0.0);
+
+    cloxFreeLexer(&lexer);
+    cloxFreeArena(&arena);
+    cloxDeleteSourceBuffer(buffer);
+    free(text);
+
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "clox/source/source_buffer.h"
+#include "clox/source/source_stream.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define PATH "test_source_buffer.lox"
+
+static int checkSkip(const char *const text, CloxSourceClass_t classes, size_t expected)
+{
+    CloxSourceStream_t *skipped = cloxCreateSourceStreamFromText(text, CLOX_SOURCE_ENCODING_UTF_8);
+    CloxSourceStream_t *read = cloxCreateSourceStreamFromText(text, CLOX_SOURCE_ENCODING_UTF_8);
+    size_t i;
+
+    check(cloxSourceStreamSkip(skipped, classes) == expected);
+
+    for (i = 0; i < expected; i++)
+        cloxSourceStreamRead(read);
+
+    /* skipping tracks locations as reading one character at a time */
+    check(skipped->forwardLocation.ch == read->forwardLocation.ch);
+    check(skipped->forwardLocation.co == read->forwardLocation.co);
+    check(skipped->forwardLocation.ln == read->forwardLocation.ln);
+    check(skipped->streamLocation.ln == read->streamLocation.ln);
+    check(cloxSourceStreamPeek(skipped) == cloxSourceStreamPeek(read));
+
+    cloxDeleteSourceStream(skipped);
+    cloxDeleteSourceStream(read);
+
+    return 0;
+}
+
+static CloxSourceValidity_t validate(const char *const text)
+{
+    CloxSourceBuffer_t *const buffer = cloxCreateSourceBufferFromText(text);
+    const CloxSourceValidity_t validity = (CloxSourceValidity_t)buffer->validity;
+
+    cloxDeleteSourceBuffer(buffer);
+
+    return validity;
+}
+
+int main()
+{
+    CloxSourceBuffer_t *buffer;
+    CloxSourceStream_t *stream;
+    FILE *file;
+    size_t i, size = CLOX_SOURCE_BUFFER_MAPPING_THRESHOLD + 3;
+
+    /* runs of each class, shorter and longer than a vector */
+    check(checkSkip("abc_XYZ09 + 1", CLOX_SOURCE_CLASS_IDENTIFIER, 9) == 0);
+    check(checkSkip("abc_XYZ09 + 1", CLOX_SOURCE_CLASS_ALPHA, 7) == 0);
+    check(checkSkip("0123456789012345678901234567890123456789.5", CLOX_SOURCE_CLASS_DIGIT, 40) == 0);
+    check(checkSkip(" \t\r\n    \n\n                      \n       \n   x", CLOX_SOURCE_CLASS_SPACE, 44) == 0);
+    check(checkSkip("// a comment that is longer than a single vector\nprint", CLOX_SOURCE_CLASS_LINE, 48) == 0);
+    check(checkSkip("identifier_with_a_long_name_and_\xC3\xA8", CLOX_SOURCE_CLASS_IDENTIFIER, 32) == 0);
+    check(checkSkip("[@`{", CLOX_SOURCE_CLASS_ALPHA, 0) == 0);
+    check(checkSkip("", CLOX_SOURCE_CLASS_SPACE, 0) == 0);
+
+    /* the decoder is still used for the other characters */
+    buffer = cloxCreateSourceBufferFromText("\xC3\xA8" "a");
+    check(cloxSourceBufferSpan(buffer, 0, CLOX_SOURCE_CLASS_LINE) == 0);
+    check(cloxSourceBufferSpan(buffer, 2, CLOX_SOURCE_CLASS_LINE) == 1);
+    check(cloxSourceBufferGetChar(buffer, CLOX_SOURCE_ENCODING_UTF_8, 0, NULL) == 0xE8);
+    cloxDeleteSourceBuffer(buffer);
+
+    /* buffers are validated once, ill-formed sequences are found even after
+     * long runs of ASCII characters */
+    check(validate("") == CLOX_SOURCE_VALIDITY_ASCII);
+    check(validate("print \"a\";") == CLOX_SOURCE_VALIDITY_ASCII);
+    check(validate("\xC3\xA8 \xE2\x82\xAC \xED\x9F\xBF \xF0\x9F\x98\x80 \xF4\x8F\xBF\xBF") == CLOX_SOURCE_VALIDITY_UTF_8);
+    check(validate("// a comment that is longer than two vectors of the widest kind\xC3\xA8") == CLOX_SOURCE_VALIDITY_UTF_8);
+    check(validate("// a comment that is longer than two vectors of the widest kind\xC3") == CLOX_SOURCE_VALIDITY_INVALID);
+    check(validate("\xC0\x80") == CLOX_SOURCE_VALIDITY_INVALID);
+    check(validate("\xE0\x9F\xBF") == CLOX_SOURCE_VALIDITY_INVALID);
+    check(validate("\xED\xA0\x80") == CLOX_SOURCE_VALIDITY_INVALID);
+    check(validate("\xF0\x8F\xBF\xBF") == CLOX_SOURCE_VALIDITY_INVALID);
+    check(validate("\xF4\x90\x80\x80") == CLOX_SOURCE_VALIDITY_INVALID);
+    check(validate("a\x80") == CLOX_SOURCE_VALIDITY_INVALID);
+    check(validate("\xFF") == CLOX_SOURCE_VALIDITY_INVALID);
+
+    /* well-formed buffers are decoded without checks, the same way */
+    static const char mixed[] = "\xC3\xA8\xE2\x82\xAC\xF0\x9F\x98\x80";
+    static const int32_t chars[] = { 0xE8, 0x20AC, 0x1F600 };
+    ssize_t offset;
+    uint64_t position = 0;
+
+    buffer = cloxCreateSourceBufferFromText(mixed);
+
+    for (i = 0; i < (sizeof(chars) / sizeof(*chars)); i++, position += (uint64_t)offset)
+    {
+        check(cloxSourceBufferGetChar(buffer, CLOX_SOURCE_ENCODING_UTF_8, position, &offset) == chars[i]);
+        check(offset == (ssize_t)(i + 2));
+
+        buffer->validity = CLOX_SOURCE_VALIDITY_UNKNOWN;
+        check(cloxSourceBufferGetChar(buffer, CLOX_SOURCE_ENCODING_UTF_8, position, NULL) == chars[i]);
+        buffer->validity = CLOX_SOURCE_VALIDITY_UTF_8;
+    }
+
+    cloxDeleteSourceBuffer(buffer);
+
+    /* buffers written after their creation are validated by their writer */
+    buffer = cloxCreateSourceBuffer(4, NULL, 0);
+    check(buffer->validity == CLOX_SOURCE_VALIDITY_UNKNOWN);
+    memcpy(buffer->data, "\xC3\xA8", 2);
+    check(cloxSourceBufferValidate(buffer) == CLOX_SOURCE_VALIDITY_UTF_8);
+    check(cloxClearSourceBuffer(buffer) && buffer->validity == CLOX_SOURCE_VALIDITY_UNKNOWN);
+    cloxDeleteSourceBuffer(buffer);
+
+    check((file = fopen(PATH, "wb")) != NULL);
+
+    for (i = 0; i < size; i++)
+        fputc((i % 64) == 63 ? '\n' : 'a' + (int)(i % 26), file);
+
+    fclose(file);
+
+    /* mapped buffers are read-only views of the whole file */
+    check((buffer = cloxCreateSourceBufferFromMappedFile(PATH)) != NULL);
+    check(buffer->isMapped && buffer->size == size);
+    check(buffer->validity == CLOX_SOURCE_VALIDITY_ASCII);
+    check(buffer->data[0] == 'a' && buffer->data[size - 1] == 'a' + (int)((size - 1) % 26));
+    check(cloxSourceBufferGetChar(buffer, CLOX_SOURCE_ENCODING_UTF_8, size, NULL) == EOF);
+    check(!cloxClearSourceBuffer(buffer));
+    cloxDeleteSourceBuffer(buffer);
+
+    /* big files are mapped automatically by source streams */
+    check((stream = cloxCreateSourceStreamFromFile(PATH, FALSE, CLOX_SOURCE_ENCODING_UTF_8)) != NULL);
+    check(stream->buffer->isMapped);
+
+    for (i = 0; i < 64; i++)
+        check(cloxSourceStreamRead(stream) == ((i % 64) == 63 ? '\n' : 'a' + (int)(i % 26)));
+
+    check(stream->streamLocation.ln == 1 && stream->streamLocation.co == 0);
+    cloxDeleteSourceStream(stream);
+
+    /* small files are loaded into a copy */
+    check((file = fopen(PATH, "wb")) != NULL);
+    fputs("print 1;", file);
+    fclose(file);
+
+    check((stream = cloxCreateSourceStreamFromFile(PATH, FALSE, CLOX_SOURCE_ENCODING_UTF_8)) != NULL);
+    check(!stream->buffer->isMapped && strcmp((const char *)stream->buffer->data, "print 1;") == 0);
+    cloxDeleteSourceStream(stream);
+
+    /* empty files cannot be mapped */
+    check((file = fopen(PATH, "wb")) != NULL);
+    fclose(file);
+    check(cloxCreateSourceBufferFromMappedFile(PATH) == NULL);
+
+    remove(PATH);
+
+    return 0;
+}
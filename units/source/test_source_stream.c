@@ -0,0 +1,103 @@
+#include "clox/source/source_stream.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define PATH "test_source_stream.lox"
+
+/* the lines are longer than the ring, so it wraps around many times */
+#define LINES_COUNT 100
+#define LINE_LENGTH 99
+
+static char expected(size_t line, size_t column)
+{
+    return (column == (LINE_LENGTH - 1)) ? '\n' : (char)('a' + (int)((line + column) % 26));
+}
+
+int main()
+{
+    CloxSourceStream_t *stream;
+    FILE *file;
+    char line[LINE_LENGTH + 1];
+    size_t i, j;
+
+    check((file = fopen(PATH, "wb")) != NULL);
+
+    for (i = 0; i < LINES_COUNT; i++)
+        for (j = 0; j < LINE_LENGTH; j++)
+            fputc(expected(i, j), file);
+
+    fputs("\xC3\xA8" "end", file);
+    fclose(file);
+
+    /* lines are copied out of the ring, even when they wrap around it */
+    check((stream = cloxOpenSourceStream(PATH, FALSE, CLOX_SOURCE_ENCODING_UTF_8)) != NULL);
+
+    for (i = 0; i < LINES_COUNT; i += 2)
+    {
+        check(cloxSourceStreamReadLine(stream, line, sizeof(line)) == LINE_LENGTH);
+
+        for (j = 0; j < LINE_LENGTH; j++)
+            check(line[j] == expected(i, j));
+
+        check(line[LINE_LENGTH] == '\0');
+        check(stream->forwardLocation.ln == (i + 1) && stream->forwardLocation.co == 0);
+
+        /* the reads of characters and lines are mixed freely */
+        for (j = 0; j < LINE_LENGTH; j++)
+            check(cloxSourceStreamRead(stream) == expected(i + 1, j));
+    }
+
+    check(stream->loadedCount > CLOX_SOURCE_STREAM_RING_SIZE);
+    check(stream->forwardLocation.ch == (LINES_COUNT * LINE_LENGTH));
+
+    /* the last line has no end of line, a small buffer takes it in pieces */
+    check(cloxSourceStreamPeek(stream) == 0xE8);
+    check(cloxSourceStreamReadLine(stream, line, 3) == 2 && strcmp(line, "\xC3\xA8") == 0);
+    check(cloxSourceStreamReadLine(stream, line, sizeof(line)) == 3 && strcmp(line, "end") == 0);
+    check(cloxSourceStreamReadLine(stream, line, sizeof(line)) == 0 && line[0] == '\0');
+    check(cloxSourceStreamRead(stream) == EOF);
+    cloxDeleteSourceStream(stream);
+
+    /* runs of spaces are skipped across the end of the ring */
+    check((file = fopen(PATH, "wb")) != NULL);
+
+    for (i = 0; i < (CLOX_SOURCE_STREAM_RING_SIZE * 3); i++)
+        fputc((i % 10) == 9 ? '\n' : ' ', file);
+
+    fputc('x', file);
+    fclose(file);
+
+    check((stream = cloxOpenSourceStream(PATH, FALSE, CLOX_SOURCE_ENCODING_UTF_8)) != NULL);
+    check(cloxSourceStreamSkip(stream, CLOX_SOURCE_CLASS_SPACE) == (CLOX_SOURCE_STREAM_RING_SIZE * 3));
+    check(stream->forwardLocation.ln == ((CLOX_SOURCE_STREAM_RING_SIZE * 3) / 10));
+    check(stream->forwardLocation.co == ((CLOX_SOURCE_STREAM_RING_SIZE * 3) % 10));
+    check(cloxSourceStreamRead(stream) == 'x');
+    cloxDeleteSourceStream(stream);
+
+    /* interactive streams load a line at each refill */
+    check((file = fopen(PATH, "wb")) != NULL);
+    fputs("print 1;\nprint 2;\n", file);
+    fclose(file);
+
+    check(freopen(PATH, "rb", stdin) != NULL);
+    check((stream = cloxOpenStandardSourceStream()) != NULL);
+    check(cloxSourceStreamReadLine(stream, line, sizeof(line)) == 9 && strcmp(line, "print 1;\n") == 0);
+    check(stream->loadedCount == 9);
+    check(cloxSourceStreamReadLine(stream, line, sizeof(line)) == 9 && strcmp(line, "print 2;\n") == 0);
+    check(cloxSourceStreamReadLine(stream, line, sizeof(line)) == 0);
+    cloxDeleteSourceStream(stream);
+
+    /* text streams end at their terminator */
+    check((stream = cloxCreateSourceStreamFromText("a\nb", CLOX_SOURCE_ENCODING_UTF_8)) != NULL);
+    check(cloxSourceStreamReadLine(stream, line, sizeof(line)) == 2 && strcmp(line, "a\n") == 0);
+    check(cloxSourceStreamReadLine(stream, line, sizeof(line)) == 1 && strcmp(line, "b") == 0);
+    check(cloxSourceStreamReadLine(stream, line, sizeof(line)) == 0);
+    cloxDeleteSourceStream(stream);
+
+    remove(PATH);
+
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+
+/* sum(n) = n ? n + sum(n - 1) : 0, the argument overlaps the window of the
+ * caller and the result is returned on the stack */
+static void emitRecursion(CloxCodeBlock_t *const block, const int16_t n)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_ENT, 1, 0);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 0, (uint16_t)n);
+
+    const size_t call = cloxEmitCall(&emitter, CLOX_OP_CODE_CALL, 0, 1);
+
+    cloxEmitByte(&emitter, CLOX_OP_CODE_LEV);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0);
+
+    const size_t sum = cloxEmitCtrl(&emitter, CLOX_OP_CODE_ENT, 3, 1);
+
+    cloxEmitterPatchJump(&emitter, call, sum);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 1, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t base = cloxEmitJump(&emitter, CLOX_OP_CODE_JEQ, 0);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 1, 1);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RSUB, 2, 0, 1);
+    cloxEmitCall(&emitter, CLOX_OP_CODE_CALL, sum, 1);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_POP, 1);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 1, 0, 1);
+    cloxEmitterPatchJump(&emitter, base, cloxEmitterOffset(&emitter));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_RET);
+
+    cloxFreeEmitter(&emitter);
+}
+
+/* sum(n, acc) = n ? sum(n - 1, acc + n) : acc, as a tail call */
+static void emitTailRecursion(CloxCodeBlock_t *const block, const int16_t n)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_ENT, 2, 0);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 0, (uint16_t)n);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 1, 0);
+
+    const size_t call = cloxEmitCall(&emitter, CLOX_OP_CODE_CALL, 0, 2);
+
+    cloxEmitByte(&emitter, CLOX_OP_CODE_LEV);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0);
+
+    const size_t sum = cloxEmitCtrl(&emitter, CLOX_OP_CODE_ENT, 4, 2);
+
+    cloxEmitterPatchJump(&emitter, call, sum);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 2, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t done = cloxEmitJump(&emitter, CLOX_OP_CODE_JEQ, 0);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 2, 1);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RSUB, 2, 0, 2);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 3, 1, 0);
+    cloxEmitCall(&emitter, CLOX_OP_CODE_TCALL, sum, 2);
+    cloxEmitterPatchJump(&emitter, done, cloxEmitterOffset(&emitter));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_RET);
+
+    cloxFreeEmitter(&emitter);
+}
+
+static int runSum(CloxVM_t *const vm, const CloxCodeBlock_t *const block, const sint_t expected)
+{
+    check(cloxVMRun(vm, block) == CLOX_VM_STATUS_RAISE);
+    check(vm->signal == 1);
+    check(vm->framesCount == 0);
+    check(vm->windowsCount == 0);
+    check(vm->stackTop == vm->stack + 1);
+
+    const CloxValue_t result = cloxVMPop(vm);
+
+    check(cloxValueType(result) == CLOX_VALUE_TYPE_SINT && cloxValueAsSInt(result) == expected);
+
+    return 0;
+}
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitVM(&vm, 0);
+
+    /* deep enough to grow the frames, the saved windows and the registers */
+    emitRecursion(&block, 3000);
+
+    check(block.array[8] == CLOX_OP_CODE_CALL && block.array[8 + 5] == 1);
+    check(runSum(&vm, &block, 4501500) == 0);
+    check(vm.framesCapacity >= 3001 && vm.windowsCapacity >= 3001);
+    check(vm.registersSize > CLOX_VM_REGISTER_FILE_SIZE);
+
+    check(cloxVMDecode(&block));
+    check(block.decoded.instructions[2].opCode == CLOX_OP_CODE_CALL && block.decoded.instructions[2].z == 1);
+    check(runSum(&vm, &block, 4501500) == 0);
+
+    cloxCodeBlockPeephole(&block, CLOX_PEEPHOLE_ALL);
+    check(runSum(&vm, &block, 4501500) == 0);
+    check(cloxVMDecode(&block));
+    check(runSum(&vm, &block, 4501500) == 0);
+
+    /* tail calls reuse the frame of the caller, whatever the depth */
+    cloxCodeBlockResize(&block, 0);
+    emitTailRecursion(&block, 30000);
+
+    const size_t framesCapacity = vm.framesCapacity, registersSize = vm.registersSize;
+
+    check(runSum(&vm, &block, 450015000) == 0);
+    check(cloxVMDecode(&block));
+    check(runSum(&vm, &block, 450015000) == 0);
+    check(vm.framesCapacity == framesCapacity && vm.registersSize == registersSize);
+
+    cloxCodeBlockPeephole(&block, CLOX_PEEPHOLE_ALL);
+    check(cloxVMDecode(&block));
+    check(runSum(&vm, &block, 450015000) == 0);
+
+    /* a frame pushed on the bytecode returns on the records */
+    CloxEmitter_t emitter;
+
+    cloxCodeBlockResize(&block, 0);
+    cloxInitEmitter(&emitter, &block);
+
+    const size_t call = cloxEmitCall(&emitter, CLOX_OP_CODE_CALL, 0, 0);
+
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 2, 0);
+    cloxEmitterPatchJump(&emitter, call, cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0));
+    cloxEmitByte(&emitter, CLOX_OP_CODE_RET);
+    cloxFreeEmitter(&emitter);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_RAISE);
+    check(vm.signal == 1 && vm.framesCount == 1);
+    check(cloxVMDecode(&block));
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_RAISE);
+    check(vm.signal == 2 && vm.framesCount == 0);
+
+    /* returning without a call and calling without an end are errors */
+    byte_t ret[] = { CLOX_OP_CODE_RET };
+    byte_t loop[] = { CLOX_OP_CODE_CALL, 0xFA, 0xFF, 0xFF, 0xFF, 0 };
+
+    cloxCodeBlockResize(&block, 0);
+    cloxCodeBlockWrite(&block, ret, countof(ret));
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(vm.error != NULL);
+    check(cloxVMDecode(&block));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+
+    cloxCodeBlockResize(&block, 0);
+    cloxCodeBlockWrite(&block, loop, countof(loop));
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(vm.framesCount == CLOX_VM_FRAMES_COUNT);
+    check(cloxVMDecode(&block));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(vm.framesCount == CLOX_VM_FRAMES_COUNT);
+
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
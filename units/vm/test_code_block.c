@@ -1,6 +1,8 @@
 #include "clox/vm/debug.h"
 #include "clox/vm/code.h"
 
+#include "check.h"
+
 int main()
 {
     byte_t program[] = {
@@ -8,8 +10,24 @@ int main()
     };
 
     CloxCodeBlock_t block;
+    CloxMemoryStats_t before, after;
 
     cloxInitCodeBlock(&block, 0);
     cloxCodeBlockWrite(&block, (const byte_t *)program, countof(program));
     cloxDisassembleCodeBlock(stdout, &block);
+
+    /* the writes grow the block geometrically, not by the missing bytes */
+    cloxGetMemoryStats(block.memory, CLOX_MEMORY_KIND_CODE, &before);
+
+    for (size_t i = 0; i < 4096; i++)
+        cloxCodeBlockWrite(&block, (const byte_t *)program, countof(program));
+
+    cloxGetMemoryStats(block.memory, CLOX_MEMORY_KIND_CODE, &after);
+
+    check(block.count == 4097);
+    check((after.allocations - before.allocations) <= 16);
+
+    cloxFreeCodeBlock(&block);
+
+    return 0;
 }
@@ -0,0 +1,82 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <math.h>
+#include <stdio.h>
+
+/* more constants than the 16-bit index of 'lec' can address */
+#define WIDE_COUNT (UINT16_MAX + 2)
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxEmitter_t emitter;
+    CloxArena_t arena;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&block, 0);
+
+    /* equal values share one constant, whatever their type */
+    check(cloxCodeBlockInternConstant(&block, cloxRealValue(1.5)) == 0);
+    check(cloxCodeBlockInternConstant(&block, cloxBoolValue(TRUE)) == 1);
+    check(cloxCodeBlockInternConstant(&block, cloxRealValue(1.5)) == 0);
+    check(cloxCodeBlockInternConstant(&block, cloxSIntValue(100000)) == 2);
+    check(cloxCodeBlockInternConstant(&block, cloxRealValue(100000)) == 3);
+    check(cloxCodeBlockInternConstant(&block, cloxBoolValue(TRUE)) == 1);
+    check(cloxCodeBlockInternConstant(&block, cloxVoidValue()) == 4);
+    check(cloxCodeBlockInternConstant(&block, cloxVoidValue()) == 4);
+    check(block.constantsCount == 5);
+
+    /* reals are compared bitwise */
+    check(cloxCodeBlockInternConstant(&block, cloxRealValue(0.0)) == 5);
+    check(cloxCodeBlockInternConstant(&block, cloxRealValue(-0.0)) == 6);
+    check(cloxCodeBlockInternConstant(&block, cloxRealValue(NAN)) == 7);
+    check(cloxCodeBlockInternConstant(&block, cloxRealValue(NAN)) == 8);
+
+    /* duplicates appended without the index resolve to the first copy */
+    check(cloxCodeBlockAddConstant(&block, cloxRealValue(1.5)) == 9);
+    check(cloxCodeBlockAddConstant(&block, cloxRealValue(2.5)) == 10);
+    check(cloxCodeBlockAddConstant(&block, cloxRealValue(2.5)) == 11);
+    check(cloxCodeBlockInternConstant(&block, cloxRealValue(1.5)) == 0);
+    check(cloxCodeBlockInternConstant(&block, cloxRealValue(2.5)) == 10);
+
+    cloxFreeCodeBlock(&block);
+
+    /* past the 16-bit index the emitter switches to 'lecw' */
+    cloxInitArena(&arena, 0);
+    cloxInitCodeBlockInArena(&block, 0, &arena);
+    cloxInitEmitter(&emitter, &block);
+
+    for (size_t i = 0; i < WIDE_COUNT; i++)
+        cloxEmitConstant(&emitter, 0, cloxRealValue((real_t)i));
+
+    check(block.constantsCount == WIDE_COUNT);
+    check((CloxOpCode_t)block.array[block.count - cloxGetOpKindSize(CLOX_OP_KIND_LONG)] == CLOX_OP_CODE_LECW);
+
+    cloxEmitConstant(&emitter, 1, cloxRealValue((real_t)(WIDE_COUNT - 1)));
+    cloxEmitConstant(&emitter, 2, cloxRealValue(7));
+    check(block.constantsCount == WIDE_COUNT);
+
+    cloxEmitLong(&emitter, CLOX_OP_CODE_LEAW, 3, (uint16_t)(WIDE_COUNT - 1), (uint16_t)((WIDE_COUNT - 1) >> 16));
+
+    cloxInitVM(&vm, 0);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsReal(vm.registers[0]) == (real_t)(WIDE_COUNT - 1));
+    check(cloxValueAsReal(vm.registers[1]) == (real_t)(WIDE_COUNT - 1));
+    check(cloxValueAsReal(vm.registers[2]) == 7);
+    check(cloxValueAsVPtr(vm.registers[3]) == (vptr_t)&block.constants[WIDE_COUNT - 1]);
+
+    /* the wide index is checked too */
+    cloxEmitLong(&emitter, CLOX_OP_CODE_LECW, 0, 0, 2);
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+
+    cloxFreeVM(&vm);
+    cloxFreeEmitter(&emitter);
+    cloxFreeCodeBlock(&block);
+    cloxFreeArena(&arena);
+
+    return 0;
+}
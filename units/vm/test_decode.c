@@ -0,0 +1,160 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+
+static size_t loop, exitJump, division;
+
+static void emitProgram(CloxCodeBlock_t *const block)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    /* sum = 0; i = 1; while (i <= 10) { sum = sum + i; i = i + 1; } total = sum */
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(0));
+    cloxEmitConstant(&emitter, 1, cloxSIntValue(1));
+    cloxEmitConstant(&emitter, 2, cloxSIntValue(10));
+    cloxEmitConstant(&emitter, 3, cloxRealValue(1.0));
+
+    loop = cloxEmitterOffset(&emitter);
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    exitJump = cloxEmitJump(&emitter, CLOX_OP_CODE_JGT, 0);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 0, 0, 1);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 1, 1, 3);
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JMP, loop);
+    cloxEmitterPatchJump(&emitter, exitJump, cloxEmitterOffset(&emitter));
+
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_STG, 0, cloxCodeBlockAddName(block, "total", 5));
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 7, 0);
+
+    /* then a division by zero */
+    cloxEmitConstant(&emitter, 4, cloxSIntValue(0));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 4);
+
+    division = cloxEmitByte(&emitter, CLOX_OP_CODE_DIV);
+
+    cloxFreeEmitter(&emitter);
+}
+
+static CloxOpCodeStats_t stats[BYTE_MAX + 1];
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitVM(&vm, 0);
+    emitProgram(&block);
+
+    check(cloxVMDefineGlobal(&vm, "total", cloxVoidValue()));
+
+    /* one record for each instruction, plus the one ending the block */
+    check(cloxVMDecode(&block));
+    check(block.decoded.count == 17);
+    check(block.decoded.offsets[block.decoded.count] == block.count);
+    check(block.decoded.instructions[block.decoded.count].opCode == CLOX_DECODED_OP_CODE_END);
+    check((block.decoded.instructions[0].handler != NULL) == CLOX_VM_COMPUTED_GOTO);
+
+    /* the operands are unpacked, jumps store the index of their target */
+    const CloxDecodedInstruction_t *const records = block.decoded.instructions;
+
+    check(records[2].opCode == CLOX_OP_CODE_LDC && records[2].z == 2 && (int16_t)records[2].operand == 10);
+    check(records[3].opCode == CLOX_OP_CODE_LEC && records[3].z == 3 && records[3].operand == 0);
+    check(records[7].opCode == CLOX_OP_CODE_JGT && records[7].operand == 11);
+    check(records[8].opCode == CLOX_OP_CODE_RADD && records[8].z == 0 && records[8].x == 0 && records[8].y == 1);
+    check(records[10].opCode == CLOX_OP_CODE_JMP && records[10].operand == 4);
+    check(block.decoded.offsets[4] == loop);
+    check(records[11].opCode == CLOX_OP_CODE_STG && (records[11].operand >> 16) == 0);
+
+    /* decoding again reuses the cached records */
+    check(cloxVMDecode(&block));
+    check(block.decoded.instructions == records);
+
+    /* the decoded run stops where the bytecode one does */
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_RAISE);
+    check(vm.signal == 7);
+    check(vm.ip == block.array + block.decoded.offsets[13]);
+    check(cloxValueType(vm.registers[0]) == CLOX_VALUE_TYPE_REAL && cloxValueAsReal(vm.registers[0]) == 55.0);
+    check(cloxValueAsReal(cloxVMGetGlobal(&vm, "total")[0]) == 55.0);
+
+    if (cloxVMGetOpCodeStats(&vm, stats))
+    {
+        check(stats[CLOX_OP_CODE_CMP].count == 11);
+        check(stats[CLOX_OP_CODE_JMP].count == 10);
+        check(stats[CLOX_OP_CODE_RAISE].count == 1);
+
+        cloxVMResetOpCodeStats(&vm);
+    }
+
+    /* resuming continues on the records, errors point past the opcode */
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_ERROR);
+    check(vm.error != NULL);
+    check(vm.ip == block.array + division + 1);
+
+    /* any change of the bytecode drops the records, the next run uses it */
+    cloxCodeBlockPush(&block, CLOX_OP_CODE_NOP);
+
+    check(block.decoded.instructions == NULL);
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_RAISE);
+    check(cloxValueAsReal(vm.registers[0]) == 55.0);
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_ERROR);
+    check(vm.ip == block.array + division + 1);
+
+    /* fused instructions are decoded too, the end of the block is a record */
+    cloxCodeBlockPop(&block);
+    cloxCodeBlockPeephole(&block, CLOX_PEEPHOLE_ALL);
+
+    check(block.decoded.instructions == NULL);
+    check(cloxVMDecode(&block));
+    check(block.decoded.instructions[6].opCode == CLOX_OP_CODE_CJGT);
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_RAISE);
+    check(cloxValueAsReal(vm.registers[0]) == 55.0);
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_ERROR);
+
+    /* blocks the decoder rejects run on their bytecode */
+    byte_t middle[] = { CLOX_OP_CODE_JMP, 0xFC, 0xFF, 0xFF, 0xFF, 0, CLOX_OP_CODE_BREAK };
+    byte_t bounds[] = { CLOX_OP_CODE_LEC, 0, 9, 0 };
+    byte_t exitProgram[] = { CLOX_OP_CODE_EXIT, 42, 0, 0 };
+
+    cloxCodeBlockResize(&block, 0);
+    cloxCodeBlockWrite(&block, middle, countof(middle));
+
+    check(!cloxVMDecode(&block));
+    check(block.decoded.instructions == NULL);
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+
+    cloxCodeBlockResize(&block, 0);
+    cloxCodeBlockWrite(&block, bounds, countof(bounds));
+
+    check(!cloxVMDecode(&block));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+
+    cloxCodeBlockResize(&block, 0);
+    cloxCodeBlockPush(&block, CLOX_OP_CODE_JMP);
+
+    check(!cloxVMDecode(&block));
+
+    cloxCodeBlockResize(&block, 0);
+    cloxCodeBlockWrite(&block, exitProgram, countof(exitProgram));
+
+    check(cloxVMDecode(&block));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(vm.exitCode == 42);
+
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&block);
+
+    check(block.decoded.instructions == NULL);
+
+    return 0;
+}
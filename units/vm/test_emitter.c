@@ -0,0 +1,70 @@
+#include "clox/vm/debug.h"
+#include "clox/vm/emitter.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxEmitter_t emitter;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitEmitter(&emitter, &block);
+
+    /* sum = 0; i = 1; while (i <= 1000) { sum = sum + i; i = i + 1; } */
+    const byte_t sum = cloxEmitterPushRegister(&emitter);
+    const byte_t i   = cloxEmitterPushRegister(&emitter);
+    const byte_t n   = cloxEmitterPushRegister(&emitter);
+    const byte_t one = cloxEmitterPushRegister(&emitter);
+
+    cloxEmitConstant(&emitter, sum, cloxSIntValue(0));
+    cloxEmitConstant(&emitter, i,   cloxSIntValue(1));
+    cloxEmitConstant(&emitter, n,   cloxSIntValue(1000));
+    cloxEmitConstant(&emitter, one, cloxSIntValue(1));
+
+    const size_t loop = cloxEmitterOffset(&emitter);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RCMP, 0, i, n);
+
+    const size_t exit = cloxEmitJump(&emitter, CLOX_OP_CODE_JGT, 0);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, sum, sum, i);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, i, i, one);
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JMP, loop);
+    cloxEmitterPatchJump(&emitter, exit, cloxEmitterOffset(&emitter));
+
+    /* double(x) in a window overlapping the last register of the caller's one */
+    cloxEmitConstant(&emitter, BYTE_MAX, cloxSIntValue(21));
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_ENT, 2, 1);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 1, 0, 0);
+    cloxEmitData(&emitter, CLOX_OP_CODE_MOV, 0, 1);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_LEV);
+
+    check(emitter.registersMax == 4);
+    cloxEmitterPopRegisters(&emitter, 4);
+    check(emitter.registersCount == 0);
+
+    cloxDisassembleCodeBlock(stdout, &block);
+
+    cloxInitVM(&vm, 0);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsSInt(vm.registers[sum]) == 500500);
+    check(cloxValueAsSInt(vm.registers[i]) == 1001);
+    check(cloxValueAsSInt(vm.registers[BYTE_MAX]) == 42);
+    check(vm.window == vm.registers && vm.windowsCount == 0);
+
+    /* unbalanced 'lev' is a runtime error */
+    cloxEmitByte(&emitter, CLOX_OP_CODE_LEV);
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+
+    cloxFreeVM(&vm);
+    cloxFreeEmitter(&emitter);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
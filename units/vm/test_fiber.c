@@ -0,0 +1,317 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/event_loop.h"
+#include "clox/vm/fiber.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if !CLOX_PLATFORM_IS_WINDOWS
+#   include <unistd.h>
+#endif
+
+static char journal[16];
+static size_t journalCount;
+
+static void note(const char c)
+{
+    if (journalCount < (sizeof(journal) - 1))
+        journal[journalCount++] = c;
+}
+
+/* step(id) notes the id and lets another fiber run, the argument is left as
+ * the result */
+static const char *CLOX_STDCALL step(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    (void)count;
+
+    note((char)cloxValueAsSInt(arguments[0]));
+
+    return cloxVMYield(vm);
+}
+
+#if !CLOX_PLATFORM_IS_WINDOWS
+/* await(fd) waits for the descriptor to be readable, its result is the events
+ * the descriptor is ready for */
+static const char *CLOX_STDCALL await(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    (void)count;
+
+    note('a');
+
+    return cloxEventLoopWait(vm, (CloxPollHandle_t)cloxValueAsSInt(arguments[0]), CLOX_POLL_READ);
+}
+
+static int pipes[2];
+
+/* consume(events) reads a byte from the pipe, which is the result */
+static const char *CLOX_STDCALL consume(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    char c;
+
+    (void)vm;
+    (void)count;
+
+    if (cloxValueAsUInt(arguments[0]) != CLOX_POLL_READ)
+        return "not readable";
+
+    if (read(pipes[0], &c, 1) != 1)
+        return "nothing read";
+
+    note('c');
+    arguments[0] = cloxSIntValue(c);
+
+    return NULL;
+}
+
+/* produce() writes a byte to the pipe */
+static const char *CLOX_STDCALL produce(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    (void)vm;
+    (void)count;
+
+    if (write(pipes[1], "x", 1) != 1)
+        return "nothing written";
+
+    note('p');
+    arguments[0] = cloxVoidValue();
+
+    return NULL;
+}
+#endif
+
+static void emitCall(CloxEmitter_t *const emitter, const char *const name, const byte_t count)
+{
+    cloxEmitGlobal(emitter, CLOX_OP_CODE_NCALL, count, cloxCodeBlockAddName(emitter->codeBlock, name, strlen(name)));
+}
+
+/* step(id); step(id); exit */
+static void emitSteps(CloxCodeBlock_t *const block, const char id)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitCodeBlock(block, 0);
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 0, (uint16_t)id);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    emitCall(&emitter, "step", 1);
+    emitCall(&emitter, "step", 1);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_EXIT, 0, 0);
+
+    cloxFreeEmitter(&emitter);
+}
+
+static int testYield(CloxVM_t *const vm)
+{
+    CloxCodeBlock_t block;
+
+    emitSteps(&block, '0');
+    journalCount = 0;
+
+    /* without fibers a yield just suspends the virtual machine */
+    check(cloxVMRun(vm, &block) == CLOX_VM_STATUS_YIELD);
+    check(vm->fiber == NULL && vm->stackTop == vm->stack + 1);
+    check(cloxVMResume(vm) == CLOX_VM_STATUS_YIELD);
+    check(cloxVMResume(vm) == CLOX_VM_STATUS_SUCCESS);
+    check(journalCount == 2);
+
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
+
+static int testSchedule(CloxVM_t *const vm, const bool_t decoded)
+{
+    CloxCodeBlock_t first, second;
+    CloxEventLoop_t loop;
+
+    emitSteps(&first, '1');
+    emitSteps(&second, '2');
+
+    if (decoded)
+        check(cloxVMDecode(&first) && cloxVMDecode(&second));
+
+    journalCount = 0;
+
+    check(cloxInitEventLoop(&loop, vm) != NULL);
+
+    CloxFiber_t *const one = cloxEventLoopSpawn(&loop, &first);
+    CloxFiber_t *const two = cloxEventLoopSpawn(&loop, &second);
+
+    check(vm->fibers == two && two->next == one);
+
+    /* the fibers alternate, each one returns when it terminates */
+    check(cloxEventLoopRun(&loop) == one);
+    check(one->status == CLOX_VM_STATUS_SUCCESS);
+    check(cloxEventLoopRun(&loop) == two);
+    check(cloxEventLoopRun(&loop) == NULL);
+    check(vm->fibers == NULL && vm->fiber == NULL);
+
+    journal[journalCount] = '\0';
+    check(strcmp(journal, "1212") == 0);
+
+    cloxFreeEventLoop(&loop);
+    cloxFreeCodeBlock(&first);
+    cloxFreeCodeBlock(&second);
+
+    return 0;
+}
+
+static int testStack(CloxVM_t *const vm)
+{
+    CloxCodeBlock_t block;
+    CloxEmitter_t emitter;
+    CloxFiber_t fiber;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitEmitter(&emitter, &block);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 0, 9);
+
+    for (int i = 0; i < 100; i++)
+        cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0);
+    cloxFreeEmitter(&emitter);
+
+    /* the stack of the fiber grows up to its limit */
+    cloxInitFiber(&fiber, vm, &block, 0);
+    check(fiber.stackSize == CLOX_FIBER_STACK_SIZE);
+    check(cloxFiberResume(&fiber) == CLOX_VM_STATUS_RAISE);
+    check(fiber.stackTop == fiber.stack + 100 && fiber.stackSize >= 100);
+    check(cloxValueAsSInt(fiber.stackTop[-1]) == 9);
+    check(cloxFiberResume(&fiber) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxFiberResume(&fiber) == CLOX_VM_STATUS_SUCCESS);
+    cloxFreeFiber(&fiber);
+
+    cloxInitFiber(&fiber, vm, &block, 64);
+    check(cloxFiberResume(&fiber) == CLOX_VM_STATUS_ERROR);
+    check(fiber.stackSize == 64);
+    cloxFreeFiber(&fiber);
+
+    /* the virtual machine keeps its own context */
+    check(vm->stackSize == CLOX_VM_STACK_SIZE && vm->fibers == NULL);
+
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
+
+#if !CLOX_PLATFORM_IS_WINDOWS
+static int testWait(CloxVM_t *const vm)
+{
+    CloxCodeBlock_t reader, writer;
+    CloxEmitter_t emitter;
+    CloxEventLoop_t loop;
+
+    check(pipe(pipes) == 0);
+
+    /* consume(await(fd)); exit */
+    cloxInitCodeBlock(&reader, 0);
+    cloxInitEmitter(&emitter, &reader);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 0, (uint16_t)pipes[0]);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    emitCall(&emitter, "await", 1);
+    emitCall(&emitter, "consume", 1);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0);
+    cloxFreeEmitter(&emitter);
+
+    /* step('w'); produce(); exit */
+    cloxInitCodeBlock(&writer, 0);
+    cloxInitEmitter(&emitter, &writer);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 0, 'w');
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    emitCall(&emitter, "step", 1);
+    emitCall(&emitter, "produce", 0);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_EXIT, 0, 0);
+    cloxFreeEmitter(&emitter);
+
+    /* waiting outside of an event loop is an error */
+    check(cloxVMRun(vm, &reader) == CLOX_VM_STATUS_ERROR);
+
+    journalCount = 0;
+
+    check(cloxInitEventLoop(&loop, vm) != NULL);
+
+    CloxFiber_t *const first = cloxEventLoopSpawn(&loop, &reader);
+
+    cloxEventLoopSpawn(&loop, &writer);
+
+    /* the reader waits, the writer runs meanwhile, then the reader is resumed
+     * with the byte available */
+    CloxFiber_t *const stopped = cloxEventLoopRun(&loop);
+
+    check(stopped != first && stopped->status == CLOX_VM_STATUS_SUCCESS);
+    check(loop.waitingCount == 1);
+    check(cloxEventLoopRun(&loop) == first);
+    check(first->status == CLOX_VM_STATUS_RAISE);
+    check(cloxValueAsSInt(first->stackTop[-1]) == 'x');
+    check(loop.waitingCount == 0);
+
+    journal[journalCount] = '\0';
+    check(strcmp(journal, "awpc") == 0);
+
+    /* the raising fiber is scheduled again, it terminates at the end of its
+     * block */
+    check(cloxEventLoopRun(&loop) == first);
+    check(cloxEventLoopRun(&loop) == NULL);
+
+    /* a waiting fiber is released with the loop */
+    CloxCodeBlock_t halt;
+
+    cloxInitCodeBlock(&halt, 0);
+    cloxInitEmitter(&emitter, &halt);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0);
+    cloxFreeEmitter(&emitter);
+
+    cloxEventLoopSpawn(&loop, &reader);
+
+    CloxFiber_t *const halted = cloxEventLoopSpawn(&loop, &halt);
+
+    check(cloxEventLoopRun(&loop) == halted);
+    check(loop.waitingCount == 1);
+
+    cloxFreeEventLoop(&loop);
+    check(vm->fibers == NULL);
+
+    cloxFreeCodeBlock(&halt);
+    cloxFreeCodeBlock(&reader);
+    cloxFreeCodeBlock(&writer);
+
+    close(pipes[0]);
+    close(pipes[1]);
+
+    return 0;
+}
+#endif
+
+int main()
+{
+    CloxVM_t vm;
+
+    cloxInitVM(&vm, 0);
+
+    check(cloxVMDefineNative(&vm, "step", &step, 1));
+
+#if !CLOX_PLATFORM_IS_WINDOWS
+    check(cloxVMDefineNative(&vm, "await", &await, 1));
+    check(cloxVMDefineNative(&vm, "consume", &consume, 1));
+    check(cloxVMDefineNative(&vm, "produce", &produce, 0));
+#endif
+
+    check(testYield(&vm) == 0);
+    check(testSchedule(&vm, FALSE) == 0);
+    check(testSchedule(&vm, TRUE) == 0);
+    check(testStack(&vm) == 0);
+
+#if !CLOX_PLATFORM_IS_WINDOWS
+    check(testWait(&vm) == 0);
+#endif
+
+    cloxFreeVM(&vm);
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include "clox/vm/heap.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define NODES_COUNT 1000
+
+static CloxValue_t roots[2];
+
+static void CLOX_STDCALL markRoots(CloxHeap_t *const heap, void *const data)
+{
+    (void)data;
+
+    for (size_t i = 0; i < sizeof(roots) / sizeof(roots[0]); i++)
+        cloxHeapMarkValue(heap, &roots[i]);
+}
+
+int main()
+{
+    CloxHeap_t heap;
+    CloxObject_t *root, *node, *last, *moved, *object;
+    size_t arenaAllocated, steps, i;
+
+    cloxInitHeap(&heap, &markRoots, NULL);
+
+    check(heap.growthFactor == CLOX_HEAP_GROWTH_FACTOR);
+    check(heap.maxPause == CLOX_HEAP_MAX_PAUSE);
+
+    /* objects are values of their own type */
+    object = cloxHeapNewArray(&heap, 3);
+
+    check(cloxValueType(cloxObjtValue(object)) == CLOX_VALUE_TYPE_OBJT);
+    check(cloxValueAsObject(cloxObjtValue(object)) == object);
+    check(cloxValueType(cloxObjectValues(object)[2]) == CLOX_VALUE_TYPE_VOID);
+
+    /* a full collection keeps what the roots reach, the rest is released */
+    root = cloxHeapNewArray(&heap, 2);
+    roots[0] = cloxObjtValue(root);
+
+    cloxHeapSet(&heap, root, 0, cloxObjtValue(cloxHeapNewBytes(&heap, 24)));
+    cloxHeapSet(&heap, root, 1, cloxObjtValue(cloxHeapNewBytes(&heap, 4096)));
+
+    for (i = 0; i < 100; i++)
+        cloxHeapNewArray(&heap, i % 8);
+
+    cloxHeapNewBytes(&heap, 8192);
+
+    check(heap.objectsCount == 105);
+
+    cloxHeapCollect(&heap);
+
+    check(heap.phase == CLOX_HEAP_PHASE_IDLE);
+    check(heap.cyclesCount == 1);
+    check(heap.objectsCount == 3);
+    check(cloxObjectBytes(cloxValueAsObject(cloxObjectValues(root)[1]))[4095] == 0);
+
+    /* released blocks are reused before the arena grows */
+    arenaAllocated = heap.arena.allocated;
+
+    for (i = 0; i < 100; i++)
+        cloxHeapNewArray(&heap, i % 8);
+
+    check(heap.arena.allocated == arenaAllocated);
+
+    cloxHeapCollect(&heap);
+
+    check(heap.objectsCount == 3);
+
+    /* without roots everything is released */
+    roots[0] = cloxVoidValue();
+
+    cloxHeapCollect(&heap);
+
+    check(heap.objectsCount == 0);
+    check(heap.allocated == 0);
+
+    /* a collection proceeds step by step: a list longer than a step is
+     * marked across several of them */
+    root = cloxHeapNewArray(&heap, 2);
+    roots[0] = cloxObjtValue(root);
+
+    for (node = root, i = 0; i < NODES_COUNT; i++)
+    {
+        last = cloxHeapNewArray(&heap, 1);
+        cloxHeapSet(&heap, node, 0, cloxObjtValue(last));
+        node = last;
+    }
+
+    moved = cloxHeapNewBytes(&heap, 16);
+    cloxHeapSet(&heap, last, 0, cloxObjtValue(moved));
+
+    for (i = 0; i < 50; i++)
+        cloxHeapNewBytes(&heap, 100);
+
+    heap.maxPause  = 0;
+    heap.threshold = 0;
+
+    check(!cloxHeapStep(&heap));
+    check(heap.phase == CLOX_HEAP_PHASE_MARK);
+    check(root->color == CLOX_OBJECT_COLOR_BLACK);
+
+    /* the only reference to a white object moves into a black one: the write
+     * barrier keeps it alive */
+    cloxHeapSet(&heap, root, 1, cloxObjtValue(moved));
+    cloxHeapSet(&heap, last, 0, cloxVoidValue());
+
+    /* objects created while marking survive the running collection */
+    object = cloxHeapNewBytes(&heap, 8);
+    roots[1] = cloxObjtValue(object);
+
+    for (steps = 1; !cloxHeapStep(&heap); steps++)
+        check(steps < 1000);
+
+    check(steps > 2);
+    check(heap.phase == CLOX_HEAP_PHASE_IDLE);
+    check(heap.objectsCount == NODES_COUNT + 3);
+    check(cloxValueAsObject(cloxObjectValues(root)[1]) == moved);
+    check(heap.threshold >= CLOX_HEAP_THRESHOLD);
+    check(heap.stepsCount == steps + 1);
+
+    cloxFreeHeap(&heap);
+
+    check(heap.objectsCount == 0);
+
+    /* the roots of a virtual machine are its registers, its stack and its
+     * global variables */
+    CloxVM_t vm;
+
+    cloxInitVM(&vm, 0);
+
+    cloxVMDefineGlobal(&vm, "kept", cloxObjtValue(cloxHeapNewArray(&vm.heap, 4)));
+    vm.registers[7] = cloxObjtValue(cloxHeapNewBytes(&vm.heap, 32));
+    cloxVMPush(&vm, cloxObjtValue(cloxHeapNewBytes(&vm.heap, 1)));
+
+    cloxHeapNewArray(&vm.heap, 4);
+    cloxHeapNewBytes(&vm.heap, 1000);
+
+    check(vm.heap.objectsCount == 5);
+
+    cloxHeapCollect(&vm.heap);
+
+    check(vm.heap.objectsCount == 3);
+
+    cloxVMUndefineGlobal(&vm, "kept");
+    cloxVMPop(&vm);
+    vm.registers[7] = cloxVoidValue();
+
+    cloxHeapCollect(&vm.heap);
+
+    check(vm.heap.objectsCount == 0);
+
+    cloxFreeVM(&vm);
+
+    /* at the limit of its memory the heap collects the garbage, and fails
+     * only when the live objects fill it */
+    CloxMemory_t memory;
+    CloxMemoryStats_t stats;
+
+    cloxInitMemory(&memory, 4096);
+    cloxSetMemory(&memory);
+    cloxInitHeap(&heap, &markRoots, NULL);
+
+    roots[0] = cloxObjtValue(cloxHeapNewBytes(&heap, 1024));
+    roots[1] = cloxVoidValue();
+
+    for (size_t i = 0; i < 64; i++)
+        check(cloxHeapNewBytes(&heap, 1024) != NULL);
+
+    check(heap.cyclesCount > 0);
+
+    roots[1] = cloxObjtValue(cloxHeapNewBytes(&heap, 2048));
+
+    check(cloxHeapNewBytes(&heap, 1024) == NULL);
+    check(memory.failures > 0);
+
+    cloxGetMemoryStats(&memory, CLOX_MEMORY_KIND_HEAP, &stats);
+
+    check(stats.count == heap.objectsCount);
+    check(stats.bytes == heap.allocated);
+
+    cloxFreeHeap(&heap);
+    cloxSetMemory(NULL);
+
+    check(memory.bytes == 0);
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/image.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char path[] = "test_image.loxc";
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxEmitter_t emitter;
+    CloxImageStamp_t stamp = { 1234, 5678 };
+    CloxCodeBlockReader_t reader;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitEmitter(&emitter, &block);
+
+    /* push 2.5 * scale (a global set to 4) and exit */
+    cloxEmitConstant(&emitter, 0, cloxRealValue(2.5));
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_LDG, 1, cloxCodeBlockAddName(&block, "scale", 5));
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RMUL, 0, 0, 1);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxCodeBlockAddSymbol(&block, 0, cloxEmitterOffset(&emitter), "scaled", 6);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_EXIT, 3, 0);
+
+    check(cloxWriteImage(path, &block, &stamp));
+
+    CloxImage_t *image = cloxCreateImageFromFile(path);
+
+    check(image != NULL);
+    check(cloxImageIsFresh(image, &stamp));
+    check(image->codeBlock.count == block.count);
+    check(image->codeBlock.constantsCount == block.constantsCount);
+    check(!memcmp(image->codeBlock.array, block.array, block.count));
+    check(!memcmp(image->codeBlock.constants, block.constants, block.constantsCount * sizeof(CloxValue_t)));
+    check(image->codeBlock.namesSize == block.namesSize && !strcmp(cloxCodeBlockGetName(&image->codeBlock, 0), "scale"));
+    check(image->codeBlock.cachesCount == 1);
+
+    /* and so are the symbols of the functions */
+    check(image->codeBlock.symbolsCount == 1);
+    check(!strcmp(cloxCodeBlockGetName(&image->codeBlock, cloxCodeBlockFindSymbol(&image->codeBlock, 0)->name), "scaled"));
+    check(cloxCodeBlockFindSymbol(&image->codeBlock, block.count - 1) == NULL);
+
+    /* the sections are read in place from the mapping */
+    check(image->codeBlock.array > image->data && image->codeBlock.array < image->data + image->size);
+    check(((size_t)image->codeBlock.constants % CLOX_IMAGE_ALIGNMENT) == 0);
+
+    cloxInitImageReader(image, &reader);
+    check(reader.array == image->codeBlock.array && reader.count == block.count);
+    check(cloxCodeBlockReaderGet(&reader) == block.array[0]);
+    cloxFreeCodeBlockReader(&reader, FALSE);
+
+    cloxInitVM(&vm, 0);
+    cloxVMDefineGlobal(&vm, "scale", cloxRealValue(4));
+    check(cloxVMRun(&vm, &image->codeBlock) == CLOX_VM_STATUS_SUCCESS);
+    check(vm.exitCode == 3);
+
+    CloxValue_t result = cloxVMPop(&vm);
+
+    check(cloxValueType(result) == CLOX_VALUE_TYPE_REAL && cloxValueAsReal(result) == 10);
+    cloxFreeVM(&vm);
+
+    stamp.time++;
+    check(!cloxImageIsFresh(image, &stamp));
+    cloxDeleteImage(image);
+
+    /* truncated or foreign files are refused */
+    FILE *stream = fopen(path, "r+b");
+
+    check(stream != NULL);
+    check(!fseek(stream, 0, SEEK_SET) && (fputc(0xFF, stream) != EOF));
+    fclose(stream);
+    check(cloxCreateImageFromFile(path) == NULL);
+
+    check(cloxWriteImage(path, &block, NULL));
+    stream = fopen(path, "ab");
+    check(stream != NULL && fputc(0, stream) != EOF);
+    fclose(stream);
+    check(cloxCreateImageFromFile(path) == NULL);
+
+    check(cloxCreateImageFromFile("missing.loxc") == NULL);
+
+    /* pointers can't be relocated */
+    cloxCodeBlockAddConstant(&block, cloxVPtrValue((vptr_t)&block));
+    check(!cloxWriteImage(path, &block, NULL));
+
+    remove(path);
+
+    cloxFreeEmitter(&emitter);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include "clox/base/thread.h"
+
+#include "clox/vm/emitter.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ISOLATES_COUNT 8
+#define RUNS_COUNT     4
+
+typedef struct _Isolate
+{
+    const CloxCodeBlock_t *block;
+    sint_t                 step;
+    sint_t                 total;
+    int                    failures;
+} Isolate_t;
+
+/* i = 1; while (i <= 10000) { sum = sum + i; i = i + step; total = sum } */
+static void emitSum(CloxCodeBlock_t *const block)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(0));
+    cloxEmitConstant(&emitter, 1, cloxSIntValue(1));
+    cloxEmitConstant(&emitter, 2, cloxSIntValue(10000));
+
+    const size_t loop = cloxEmitGlobal(&emitter, CLOX_OP_CODE_LDG, 3, cloxCodeBlockAddName(block, "step", 4));
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t exitJump = cloxEmitJump(&emitter, CLOX_OP_CODE_JGT, 0);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 0, 0, 1);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 1, 1, 3);
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_STG, 0, cloxCodeBlockAddName(block, "total", 5));
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JMP, loop);
+    cloxEmitterPatchJump(&emitter, exitJump, cloxEmitterOffset(&emitter));
+
+    cloxFreeEmitter(&emitter);
+}
+
+static sint_t expectedSum(const sint_t step)
+{
+    sint_t sum = 0;
+
+    for (sint_t i = 1; i <= 10000; i += step)
+        sum += i;
+
+    return sum;
+}
+
+/* each isolate has its own globals, so its own step */
+static void CLOX_STDCALL runIsolate(void *const argument)
+{
+    Isolate_t *const isolate = (Isolate_t *)argument;
+    CloxVM_t vm;
+
+    cloxInitVM(&vm, 0);
+    cloxVMDefineGlobal(&vm, "step", cloxSIntValue(isolate->step));
+    cloxVMDefineGlobal(&vm, "total", cloxVoidValue());
+
+    for (int i = 0; i < RUNS_COUNT; i++)
+    {
+        if (cloxVMRun(&vm, isolate->block) != CLOX_VM_STATUS_SUCCESS)
+            isolate->failures++;
+
+        isolate->total = cloxValueAsSInt(cloxVMGetGlobal(&vm, "total")[0]);
+
+        if (isolate->total != expectedSum(isolate->step))
+            isolate->failures++;
+    }
+
+    cloxFreeVM(&vm);
+}
+
+int main()
+{
+    CloxCodeBlock_t block;
+    Isolate_t isolates[ISOLATES_COUNT];
+    CloxThread_t threads[ISOLATES_COUNT];
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&block, 0);
+    emitSum(&block);
+
+    /* the block is decoded when it is frozen, and it stays so */
+    check(cloxVMFreeze(&block));
+    check(block.frozen);
+    check(block.decoded.instructions != NULL);
+    check(cloxVMDecode(&block));
+    check(cloxVMFreeze(&block));
+
+    const size_t count = block.count;
+    byte_t *const bytecode = (byte_t *)malloc(count);
+
+    memcpy(bytecode, block.array, count);
+
+    for (int i = 0; i < ISOLATES_COUNT; i++)
+    {
+        isolates[i].block    = &block;
+        isolates[i].step     = i + 1;
+        isolates[i].total    = 0;
+        isolates[i].failures = 0;
+    }
+
+    /* the isolates run the same block at the same time */
+    for (int i = 0; i < ISOLATES_COUNT; i++)
+        check((threads[i] = cloxThreadCreate(&runIsolate, &isolates[i])) != NULL);
+
+    for (int i = 0; i < ISOLATES_COUNT; i++)
+        check(cloxThreadJoin(threads[i]));
+
+    for (int i = 0; i < ISOLATES_COUNT; i++)
+    {
+        check(isolates[i].failures == 0);
+        check(isolates[i].total == expectedSum(i + 1));
+    }
+
+#if CLOX_VM_JIT
+    check(block.decoded.regions[3] != NULL);
+#endif
+
+    check(block.count == count && !memcmp(block.array, bytecode, count));
+    check(block.decoded.instructions != NULL);
+
+    free(bytecode);
+
+    /* a freed block can be modified again */
+    cloxFreeCodeBlock(&block);
+    check(!block.frozen);
+
+    /* heap objects belong to one virtual machine, they can't be shared */
+    cloxInitVM(&vm, 0);
+    cloxInitCodeBlock(&block, 0);
+
+    cloxCodeBlockAddConstant(&block, cloxObjtValue(cloxHeapNewBytes(&vm.heap, 8)));
+
+    check(!cloxVMFreeze(&block));
+    check(!block.frozen);
+
+    cloxFreeCodeBlock(&block);
+    cloxFreeVM(&vm);
+
+    return 0;
+}
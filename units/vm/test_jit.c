@@ -0,0 +1,344 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/jit.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+
+static size_t step, division;
+
+/* i = 1; while (i <= 10000) { sum = sum + i; i = i + step; total = sum } */
+static void emitSum(CloxCodeBlock_t *const block)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(0));
+    cloxEmitConstant(&emitter, 1, cloxSIntValue(1));
+    cloxEmitConstant(&emitter, 2, cloxSIntValue(10000));
+
+    const size_t loop = cloxEmitGlobal(&emitter, CLOX_OP_CODE_LDG, 3, cloxCodeBlockAddName(block, "step", 4));
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t exitJump = cloxEmitJump(&emitter, CLOX_OP_CODE_JGT, 0);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 0, 0, 1);
+
+    step = cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 1, 1, 3);
+
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_STG, 0, cloxCodeBlockAddName(block, "total", 5));
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JMP, loop);
+    cloxEmitterPatchJump(&emitter, exitJump, cloxEmitterOffset(&emitter));
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 7, 0);
+
+    cloxFreeEmitter(&emitter);
+}
+
+/* i = 5000; while (TRUE) { x = 1000000 / i; i = i - 1 } */
+static void emitDivision(CloxCodeBlock_t *const block)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(5000));
+    cloxEmitConstant(&emitter, 3, cloxSIntValue(-1));
+    cloxEmitConstant(&emitter, 4, cloxSIntValue(1000000));
+
+    const size_t loop = cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 4);
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+
+    division = cloxEmitByte(&emitter, CLOX_OP_CODE_DIV);
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_POP, 5);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 0, 0, 3);
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JMP, loop);
+
+    cloxFreeEmitter(&emitter);
+}
+
+static int runSum(CloxVM_t *const vm, const CloxCodeBlock_t *const block, const sint_t expected)
+{
+    check(cloxVMRun(vm, block) == CLOX_VM_STATUS_RAISE);
+    check(vm->signal == 7);
+    check(vm->stackTop == vm->stack);
+    check(cloxValueType(vm->registers[0]) == CLOX_VALUE_TYPE_SINT && cloxValueAsSInt(vm->registers[0]) == expected);
+    check(cloxValueAsSInt(cloxVMGetGlobal(vm, "total")[0]) == expected);
+
+    return 0;
+}
+
+static int countTo(void *state, uint64_t operands)
+{
+    return (++*(uint32_t *)state < (uint32_t)operands) ? CLOX_JIT_STATUS_TAKEN : CLOX_JIT_STATUS_CONTINUE;
+}
+
+static int bail(void *state, uint64_t operands)
+{
+    (void)state;
+    (void)operands;
+
+    return CLOX_JIT_STATUS_BAIL;
+}
+
+#if CLOX_VM_JIT && (CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_AMD64) && !CLOX_VALUE_NAN_BOXING
+/* the state of the inline stencils begins with their frame */
+typedef struct
+{
+    CloxJitFrame_t frame;
+    uint32_t       calls;
+} InlineState_t;
+
+/* the flags and the polled words of the inline stencils */
+typedef struct
+{
+    byte_t   cf, zf;
+    uint32_t phase;
+    uint64_t profiler;
+} InlineContext_t;
+
+static InlineContext_t context;
+
+static int slow(void *state, uint64_t operands)
+{
+    (void)operands;
+
+    ((InlineState_t *)state)->calls++;
+
+    return CLOX_JIT_STATUS_BAIL;
+}
+
+static int slowTest(void *state, uint64_t operands)
+{
+    (void)operands;
+
+    ((InlineState_t *)state)->calls++;
+    context.zf = 0;
+
+    return CLOX_JIT_STATUS_CONTINUE;
+}
+
+static int poll(void *state, uint64_t operands)
+{
+    (void)operands;
+
+    ((InlineState_t *)state)->calls++;
+
+    return CLOX_JIT_STATUS_TAKEN;
+}
+
+static uint32_t runStencils(const CloxJitStencil_t *const stencils, const size_t count, InlineState_t *const state)
+{
+    CloxJitCode_t *const code = cloxJitAssemble(stencils, count);
+
+    if (!code)
+        return UINT32_MAX;
+
+    const uint32_t record = code->entry(state);
+
+    cloxJitRelease(code);
+
+    return record;
+}
+
+static int runInline(void)
+{
+    const uint32_t size = (uint32_t)sizeof(CloxValue_t), payload = (uint32_t)offsetof(CloxValue_t, data);
+
+    CloxValue_t stack[2], window[4];
+    CloxValue_t x = cloxRealValue(2.5), y = cloxRealValue(4);
+    CloxValue_t real = cloxRealValue(0), sint = cloxSIntValue(0), boolean = cloxBoolValue(FALSE);
+    InlineState_t state;
+
+    state.frame.top     = (byte_t *)stack;
+    state.frame.window  = (byte_t *)window;
+    state.frame.bottom  = (byte_t *)stack;
+    state.frame.limit   = (byte_t *)(stack + 2);
+    state.frame.context = (byte_t *)&context;
+    state.calls         = 0;
+
+    /* x * y > y, the values are loaded and moved through the stack */
+    CloxJitStencil_t product[] = {
+        { .kind = CLOX_JIT_STENCIL_LOAD, .record = 0, .size = size, .destination = 0, .data = &x },
+        { .kind = CLOX_JIT_STENCIL_PUSH, .record = 1, .size = size, .source = 0 },
+        { .kind = CLOX_JIT_STENCIL_LOAD, .record = 2, .size = size, .destination = size, .data = &y },
+        { .kind = CLOX_JIT_STENCIL_PUSH, .record = 3, .size = size, .source = size },
+        { .function = &slow, .kind = CLOX_JIT_STENCIL_ARITHMETIC, .record = 4, .size = size, .source = 2 * size, .destination = 2 * size, .other = size, .pop = size, .payload = payload, .operation = CLOX_JIT_OPERATION_REAL_MUL, .data = &real },
+        { .kind = CLOX_JIT_STENCIL_POP, .record = 5, .size = size, .destination = 2 * size },
+        { .function = &slow, .kind = CLOX_JIT_STENCIL_COMPARE, .record = 6, .target = 8, .size = size, .source = 2 * size, .destination = (uint32_t)offsetof(InlineContext_t, cf), .other = size, .payload = payload, .operation = CLOX_JIT_OPERATION_REAL, .condition = CLOX_JIT_CONDITION_GREATER, .data = &real },
+        { .kind = CLOX_JIT_STENCIL_EXIT, .record = 7 },
+        { .kind = CLOX_JIT_STENCIL_EXIT, .record = 8 },
+    };
+
+    check(runStencils(product, countof(product), &state) == 8);
+    check(cloxValueType(window[2]) == CLOX_VALUE_TYPE_REAL && cloxValueAsReal(window[2]) == 10);
+    check(state.frame.top == (byte_t *)stack && context.cf == 2 && state.calls == 0);
+
+    /* a value of another type fails the guard, its function bails */
+    y = cloxSIntValue(4);
+
+    check(runStencils(product, countof(product), &state) == 4);
+    check(state.frame.top == (byte_t *)(stack + 2) && state.calls == 1);
+
+    /* so does a push past the limit of the stack */
+    product[2].kind = CLOX_JIT_STENCIL_EXIT;
+
+    check(runStencils(product, 3, &state) == 1);
+    check(state.frame.top == (byte_t *)(stack + 2));
+
+    /* i = 3; do { i = i - 1 } while (i > 0), polling at each iteration */
+    CloxJitStencil_t countdown[] = {
+        { .function = &slow, .kind = CLOX_JIT_STENCIL_ARITHMETIC, .record = 0, .size = size, .source = 0, .destination = 0, .other = size, .payload = payload, .operation = CLOX_JIT_OPERATION_SUB, .data = &sint },
+        { .function = &slow, .kind = CLOX_JIT_STENCIL_COMPARE, .record = 1, .target = 3, .size = size, .source = 0, .destination = (uint32_t)offsetof(InlineContext_t, cf), .other = 2 * size, .payload = payload, .condition = CLOX_JIT_CONDITION_LESS_EQUAL, .data = &sint },
+        { .function = &poll, .kind = CLOX_JIT_STENCIL_POLL, .record = 0, .target = 0, .size = size, .source = (uint32_t)offsetof(InlineContext_t, phase), .destination = (uint32_t)offsetof(InlineContext_t, profiler) },
+        { .kind = CLOX_JIT_STENCIL_EXIT, .record = 3 },
+    };
+
+    window[0] = cloxSIntValue(3);
+    window[1] = cloxSIntValue(1);
+    window[2] = cloxSIntValue(0);
+    state.calls = 0;
+
+    check(runStencils(countdown, countof(countdown), &state) == 3);
+    check(cloxValueAsSInt(window[0]) == 0 && context.cf == 0 && state.calls == 0);
+
+    /* the poll calls its function when a word is set */
+    window[0] = cloxSIntValue(3);
+    context.profiler = 1;
+
+    check(runStencils(countdown, countof(countdown), &state) == 3);
+    check(cloxValueAsSInt(window[0]) == 0 && state.calls == 2);
+
+    /* the test of a boolean sets the flag, a branch reads it */
+    CloxJitStencil_t test[] = {
+        { .function = &slowTest, .kind = CLOX_JIT_STENCIL_TEST, .record = 0, .size = size, .source = 3 * size, .destination = (uint32_t)offsetof(InlineContext_t, zf), .payload = payload, .data = &boolean },
+        { .kind = CLOX_JIT_STENCIL_FLAG, .record = 1, .target = 3, .size = size, .source = (uint32_t)offsetof(InlineContext_t, zf), .condition = CLOX_JIT_CONDITION_NONZERO },
+        { .kind = CLOX_JIT_STENCIL_EXIT, .record = 2 },
+        { .kind = CLOX_JIT_STENCIL_EXIT, .record = 3 },
+    };
+
+    window[3] = cloxBoolValue(FALSE);
+    state.calls = 0;
+
+    check(runStencils(test, countof(test), &state) == 3 && context.zf == 1);
+
+    window[3] = cloxBoolValue(TRUE);
+
+    check(runStencils(test, countof(test), &state) == 2 && context.zf == 0);
+
+    /* the function of a failed guard may go on with the next stencil */
+    window[3] = cloxSIntValue(0);
+    context.zf = 1;
+
+    check(runStencils(test, countof(test), &state) == 2 && state.calls == 1);
+
+    return 0;
+}
+#endif
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxVM_t vm;
+
+    /* the assembler stitches the stencils, exits return their record */
+    CloxJitStencil_t stencils[] = {
+        { .function = &countTo, .operands = 10, .kind = CLOX_JIT_STENCIL_BRANCH, .record = 0 },
+        { .function = &bail,    .operands = 0,  .kind = CLOX_JIT_STENCIL_OP,     .record = 5 },
+        { .function = NULL,     .operands = 0,  .kind = CLOX_JIT_STENCIL_EXIT,   .record = 9 },
+    };
+
+    CloxJitCode_t *code = cloxJitAssemble(stencils, countof(stencils));
+    uint32_t counter = 0;
+
+    check((code != NULL) == CLOX_VM_JIT);
+
+    if (code)
+    {
+        check(code->entry(&counter) == 5 && counter == 10);
+
+        stencils[1].kind = CLOX_JIT_STENCIL_JUMP;
+        stencils[1].target = 2;
+
+        cloxJitRelease(code);
+        code = cloxJitAssemble(stencils, countof(stencils));
+
+        check(code->entry(&counter) == 9 && counter == 11);
+        cloxJitRelease(code);
+    }
+
+    /* the last stencil must not fall through */
+    check(cloxJitAssemble(stencils, 1) == NULL);
+
+#if CLOX_VM_JIT && (CLOX_ARCHTECT_ID == CLOX_ARCHTECT_ID_AMD64) && !CLOX_VALUE_NAN_BOXING
+    check(runInline() == 0);
+#endif
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitVM(&vm, 0);
+
+    check(cloxVMDefineGlobal(&vm, "step", cloxSIntValue(1)));
+    check(cloxVMDefineGlobal(&vm, "total", cloxVoidValue()));
+
+    /* hot loops run the same with or without their compiled region */
+    emitSum(&block);
+
+    check(runSum(&vm, &block, 50005000) == 0);
+    check(cloxVMDecode(&block));
+    check(runSum(&vm, &block, 50005000) == 0);
+
+#if CLOX_VM_JIT
+    check(block.decoded.counters[3] >= CLOX_VM_JIT_THRESHOLD);
+    check(block.decoded.regions[3] != NULL);
+#endif
+
+    check(runSum(&vm, &block, 50005000) == 0);
+
+    /* a value of another type fails the guard, the interpreter reports it */
+    cloxVMGetGlobal(&vm, "step")[0] = cloxBoolValue(TRUE);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(vm.error != NULL);
+    check(vm.ip == block.array + step + 1);
+
+    /* so does a global defined again, its cache slot is bound again */
+    check(cloxVMUndefineGlobal(&vm, "step"));
+    check(cloxVMDefineGlobal(&vm, "step", cloxSIntValue(2)));
+    check(runSum(&vm, &block, 25000000) == 0);
+
+    /* fused instructions are compiled too */
+    cloxCodeBlockPeephole(&block, CLOX_PEEPHOLE_ALL);
+
+    check(cloxVMDecode(&block));
+    check(runSum(&vm, &block, 25000000) == 0);
+    check(runSum(&vm, &block, 25000000) == 0);
+
+    /* errors of a compiled region point past the opcode of the instruction */
+    cloxCodeBlockResize(&block, 0);
+    emitDivision(&block);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(vm.ip == block.array + division + 1);
+    check(cloxValueAsSInt(vm.registers[0]) == 0);
+    check(cloxValueAsSInt(vm.registers[5]) == 1000000);
+
+    vm.stackTop = vm.stack;
+
+    check(cloxVMDecode(&block));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(vm.error != NULL);
+    check(vm.ip == block.array + division + 1);
+    check(cloxValueAsSInt(vm.registers[0]) == 0);
+    check(cloxValueAsSInt(vm.registers[5]) == 1000000);
+
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/image.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define RUNS_COUNT 1000
+#define RUN_SIZE   5
+
+static const char path[] = "test_lines.loxc";
+
+static CloxSourceLocation_t *at(CloxSourceLocation_t *const location, uint32_t line, uint32_t column)
+{
+    return cloxSetSourceLocation(location, 0, column, line);
+}
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxEmitter_t emitter;
+    CloxSourceLocation_t location;
+    size_t i, offset;
+
+    cloxInitCodeBlock(&block, 0);
+
+    /* a block without line table has no locations */
+    check(!cloxCodeBlockGetLine(&block, 0, &location));
+
+    /* runs every RUN_SIZE bytes, lines and columns moving both ways */
+    for (i = 0; i < RUNS_COUNT; i++)
+        cloxCodeBlockAddLine(&block, 10 + i * RUN_SIZE, at(&location, (uint32_t)(i / 3 * 2), (uint32_t)((i * 7) % 41)));
+
+    check(block.lines.count == RUNS_COUNT);
+    check(block.lines.checkpointsCount == (RUNS_COUNT + CLOX_LINE_TABLE_CHECKPOINT_INTERVAL - 1) / CLOX_LINE_TABLE_CHECKPOINT_INTERVAL);
+    check(block.lines.runsSize <= RUNS_COUNT * 3);
+
+    check(!cloxCodeBlockGetLine(&block, 9, &location));
+
+    for (offset = 10; offset < 10 + RUNS_COUNT * RUN_SIZE + 100; offset++)
+    {
+        i = min((offset - 10) / RUN_SIZE, (size_t)RUNS_COUNT - 1);
+
+        check(cloxCodeBlockGetLine(&block, offset, &location));
+        check(location.ln == (uint32_t)(i / 3 * 2) && location.co == (uint32_t)((i * 7) % 41));
+    }
+
+    cloxFreeCodeBlock(&block);
+
+    /* the same location continues the run, a new location at the same offset
+     * replaces the empty run */
+    cloxInitCodeBlock(&block, 0);
+
+    cloxCodeBlockAddLine(&block, 0, at(&location, 1, 1));
+    cloxCodeBlockAddLine(&block, 4, at(&location, 1, 1));
+    cloxCodeBlockAddLine(&block, 8, at(&location, 2, 0));
+    cloxCodeBlockAddLine(&block, 8, at(&location, 3, 5));
+
+    check(block.lines.count == 2);
+    check(cloxCodeBlockGetLine(&block, 6, &location) && location.ln == 1);
+    check(cloxCodeBlockGetLine(&block, 8, &location) && location.ln == 3 && location.co == 5);
+
+    /* when it is the previous location the runs merge */
+    cloxCodeBlockAddLine(&block, 8, at(&location, 1, 1));
+
+    check(block.lines.count == 1);
+    check(cloxCodeBlockGetLine(&block, 100, &location) && location.ln == 1 && location.co == 1);
+
+    cloxFreeCodeBlock(&block);
+
+    /* fused instructions keep the location of the first one, the runs after
+     * them move back */
+    cloxInitCodeBlock(&block, 0);
+    cloxInitEmitter(&emitter, &block);
+
+    cloxCodeBlockAddLine(&block, cloxEmitterOffset(&emitter), at(&location, 0, 0));
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(1));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+
+    cloxCodeBlockAddLine(&block, cloxEmitterOffset(&emitter), at(&location, 1, 4));
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    cloxCodeBlockAddLine(&block, cloxEmitterOffset(&emitter), at(&location, 2, 4));
+
+    const size_t skip = cloxEmitJump(&emitter, CLOX_OP_CODE_JGT, 0);
+
+    cloxCodeBlockAddLine(&block, cloxEmitterOffset(&emitter), at(&location, 3, 8));
+    cloxEmitByte(&emitter, CLOX_OP_CODE_ABORT);
+    cloxEmitterPatchJump(&emitter, skip, cloxEmitterOffset(&emitter));
+
+    const size_t compare = block.count - 1 - cloxGetOpKindSize(CLOX_OP_KIND_JUMP) - 1;
+
+    check(cloxCodeBlockPeephole(&block, CLOX_PEEPHOLE_ALL) > 0);
+    check(block.array[compare] == CLOX_OP_CODE_CJGT);
+    check(block.array[block.count - 1] == CLOX_OP_CODE_ABORT);
+
+    check(cloxCodeBlockGetLine(&block, 0, &location) && location.ln == 0);
+    check(cloxCodeBlockGetLine(&block, compare, &location) && location.ln == 1 && location.co == 4);
+    check(cloxCodeBlockGetLine(&block, block.count - 2, &location) && location.ln == 1);
+    check(cloxCodeBlockGetLine(&block, block.count - 1, &location) && location.ln == 3 && location.co == 8);
+
+    /* images carry the line table */
+    check(cloxWriteImage(path, &block, NULL));
+
+    CloxImage_t *const image = cloxCreateImageFromFile(path);
+
+    check(image != NULL);
+    check(image->codeBlock.lines.runsSize == block.lines.runsSize);
+    check(cloxCodeBlockGetLine(&image->codeBlock, compare, &location) && location.ln == 1 && location.co == 4);
+    check(cloxCodeBlockGetLine(&image->codeBlock, block.count - 1, &location) && location.ln == 3);
+
+    cloxDeleteImage(image);
+    remove(path);
+
+    cloxFreeEmitter(&emitter);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static size_t calls;
+
+static const char *CLOX_STDCALL add(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    (void)vm;
+    (void)count;
+
+    calls++;
+    arguments[0] = cloxSIntValue(cloxValueAsSInt(arguments[0]) + cloxValueAsSInt(arguments[1]));
+
+    return NULL;
+}
+
+static const char *CLOX_STDCALL multiply(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    (void)vm;
+    (void)count;
+
+    arguments[0] = cloxSIntValue(cloxValueAsSInt(arguments[0]) * cloxValueAsSInt(arguments[1]));
+
+    return NULL;
+}
+
+static const char *CLOX_STDCALL countArguments(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    /* the arguments are read in place from the evaluation stack */
+    if ((arguments + (count ? count : 1)) != vm->stackTop)
+        return "arguments not in place";
+
+    arguments[0] = cloxSIntValue((sint_t)count);
+
+    return NULL;
+}
+
+/* exported by the test program, so that it can be imported from it */
+const char *CLOX_STDCALL cloxTestNegate(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    (void)vm;
+    (void)count;
+
+    arguments[0] = cloxSIntValue(-cloxValueAsSInt(arguments[0]));
+
+    return NULL;
+}
+
+static void emitCall(CloxEmitter_t *const emitter, const char *const name, const byte_t count)
+{
+    cloxEmitGlobal(emitter, CLOX_OP_CODE_NCALL, count, cloxCodeBlockAddName(emitter->codeBlock, name, strlen(name)));
+}
+
+static int runProgram(CloxVM_t *const vm, CloxCodeBlock_t *const block, const sint_t expected)
+{
+    check(cloxVMRun(vm, block) == CLOX_VM_STATUS_RAISE);
+    check(vm->stackTop == vm->stack + 3);
+    check(cloxValueAsSInt(vm->stack[0]) == expected);
+    check(cloxValueAsSInt(vm->stack[1]) == 0);
+    check(cloxValueAsSInt(vm->stack[2]) == 3);
+
+    return 0;
+}
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxEmitter_t emitter;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitVM(&vm, 0);
+    cloxInitEmitter(&emitter, &block);
+
+    /* add(2, 40); count(); count(1, 2, 3) */
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 0, 2);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 1, 40);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    emitCall(&emitter, "add", 2);
+    emitCall(&emitter, "count", 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    emitCall(&emitter, "count", 3);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0);
+    emitCall(&emitter, "missing", 0);
+
+    cloxFreeEmitter(&emitter);
+
+    check(cloxVMDefineNative(&vm, "add", &add, 2));
+    check(cloxVMDefineNative(&vm, "count", &countArguments, CLOX_VM_NATIVE_VARIADIC));
+    check(cloxVMGetNative(&vm, "add")->function == &add);
+    check(cloxVMGetNative(&vm, "missing") == NULL);
+
+    check(runProgram(&vm, &block, 42) == 0);
+    check(calls == 1);
+
+    /* undefined functions fail when they are called */
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_ERROR);
+    check(vm.error != NULL);
+
+    check(cloxVMDecode(&block));
+    check(block.decoded.instructions[4].opCode == CLOX_OP_CODE_NCALL && block.decoded.instructions[4].z == 2);
+    check(runProgram(&vm, &block, 42) == 0);
+    check(calls == 2);
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_ERROR);
+
+    /* replacing a function rebinds the call sites */
+    check(!cloxVMDefineNative(&vm, "add", &multiply, 2));
+    check(runProgram(&vm, &block, 80) == 0);
+
+    /* the arity is checked when a call site is bound */
+    cloxVMDefineNative(&vm, "add", &add, 1);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(vm.ip == block.array + block.decoded.offsets[4] + 1);
+
+    cloxCodeBlockInvalidate(&block);
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+
+    /* symbols are resolved once, on import */
+    check(!cloxVMImportNative(&vm, "add", "libclox-test-missing.so", "cloxTestNegate", 1));
+    check(!cloxVMImportNative(&vm, "add", NULL, "cloxTestMissing", 1));
+    check(cloxVMGetNative(&vm, "add")->function == &add);
+
+    check(cloxVMImportNative(&vm, "add", NULL, "cloxTestNegate", 2));
+    check(cloxVMGetNative(&vm, "add")->function == &cloxTestNegate);
+    check(runProgram(&vm, &block, -2) == 0);
+
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "clox/vm/debug.h"
+#include "clox/vm/emitter.h"
+#include "clox/vm/optimizer.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void emitProgram(CloxCodeBlock_t *const block)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    /* x = -(6 * 7) */
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(6));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(7));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_MUL);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_NEG);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_POP, 1);
+
+    /* if (1 < 2) skip the abort */
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(1));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(2));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t skip = cloxEmitJump(&emitter, CLOX_OP_CODE_JLT, 0);
+
+    cloxEmitByte(&emitter, CLOX_OP_CODE_ABORT);
+    cloxEmitterPatchJump(&emitter, skip, cloxEmitterOffset(&emitter));
+
+    /* the code after exit is never run */
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_EXIT, 3, 0);
+    cloxEmitConstant(&emitter, 1, cloxSIntValue(0));
+    cloxEmitByte(&emitter, CLOX_OP_CODE_ABORT);
+
+    cloxFreeEmitter(&emitter);
+}
+
+static bool_t contains(const CloxCodeBlock_t *const block, const CloxOpCode_t opCode)
+{
+    CloxCodeBlockReader_t reader;
+    CloxOpCodeInfo_t opCodeInfo;
+
+    cloxInitCodeBlockReader(&reader, block);
+
+    while (!cloxCodeBlockReaderIsAtEnd(&reader))
+    {
+        cloxGetOpCodeInfo(reader.array[reader.index], &opCodeInfo);
+
+        if (opCodeInfo.code == opCode)
+            return TRUE;
+
+        reader.index += cloxGetOpKindSize(opCodeInfo.kind);
+    }
+
+    return FALSE;
+}
+
+int main()
+{
+    CloxCodeBlock_t plain, peephole, folded;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&plain, 0);
+    cloxInitCodeBlock(&peephole, 0);
+    cloxInitCodeBlock(&folded, 0);
+    emitProgram(&plain);
+    emitProgram(&peephole);
+    emitProgram(&folded);
+
+    /* O0 keeps every instruction, it only gives back the spare capacity (the
+     * capacity stays aligned to a word) */
+    const size_t count = plain.count;
+
+    check(cloxCodeBlockOptimize(&plain, CLOX_OPTIMIZATION_LEVEL_O0) == 0);
+    check(plain.count == count);
+    check(plain.capacity == cloxAlignToWordPtr(plain.count));
+    check(contains(&plain, CLOX_OP_CODE_MUL));
+
+    check(cloxCodeBlockOptimize(&peephole, CLOX_OPTIMIZATION_LEVEL_O1) > 0);
+    check(contains(&peephole, CLOX_OP_CODE_MUL));
+    check(contains(&peephole, CLOX_OP_CODE_ABORT));
+
+    check(cloxCodeBlockOptimize(&folded, CLOX_OPTIMIZATION_LEVEL_O2) > 0);
+    check(folded.count < peephole.count);
+    check(folded.capacity == cloxAlignToWordPtr(folded.count));
+    check(!contains(&folded, CLOX_OP_CODE_MUL));
+    check(!contains(&folded, CLOX_OP_CODE_NEG));
+    check(!contains(&folded, CLOX_OP_CODE_CMP));
+    check(!contains(&folded, CLOX_OP_CODE_ABORT));
+    check(!contains(&folded, CLOX_OP_CODE_NOP));
+    check(contains(&folded, CLOX_OP_CODE_EXIT));
+
+    cloxDisassembleCodeBlock(stdout, &folded);
+
+    cloxInitVM(&vm, 0);
+
+    check(cloxVMRun(&vm, &plain) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsSInt(vm.registers[1]) == -42);
+    check(vm.exitCode == 3);
+    check(cloxVMRun(&vm, &folded) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsSInt(vm.registers[1]) == -42);
+    check(vm.exitCode == 3);
+
+    /* a division by zero is left to fail at run time */
+    CloxCodeBlock_t failing;
+    CloxEmitter_t emitter;
+
+    cloxInitCodeBlock(&failing, 0);
+    cloxInitEmitter(&emitter, &failing);
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(1));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(0));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_DIV);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_EXIT, 0, 0);
+    cloxFreeEmitter(&emitter);
+
+    cloxCodeBlockOptimize(&failing, CLOX_OPTIMIZATION_LEVEL_O2);
+
+    check(contains(&failing, CLOX_OP_CODE_DIV));
+    check(cloxVMRun(&vm, &failing) != CLOX_VM_STATUS_SUCCESS);
+
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&failing);
+    cloxFreeCodeBlock(&plain);
+    cloxFreeCodeBlock(&peephole);
+    cloxFreeCodeBlock(&folded);
+
+    return 0;
+}
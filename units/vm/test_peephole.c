@@ -0,0 +1,123 @@
+#include "clox/vm/debug.h"
+#include "clox/vm/emitter.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void emitProgram(CloxCodeBlock_t *const block)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    /* sum = 0; i = 0; while (i < 100) { sum = sum + i; i = i + 1; } */
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(0));
+    cloxEmitConstant(&emitter, 1, cloxSIntValue(0));
+    cloxEmitConstant(&emitter, 2, cloxSIntValue(100));
+
+    const size_t loop = cloxEmitterOffset(&emitter);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RCMP, 0, 1, 2);
+
+    const size_t exit = cloxEmitJump(&emitter, CLOX_OP_CODE_JGE, 0);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 0, 0, 1);
+    cloxEmitConstant(&emitter, 3, cloxSIntValue(1));
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 1, 1, 3);
+
+    /* a jump to a jump to the loop head */
+    const size_t chain = cloxEmitJump(&emitter, CLOX_OP_CODE_JMP, 0);
+
+    cloxEmitterPatchJump(&emitter, exit, cloxEmitterOffset(&emitter) + 6);
+    cloxEmitterPatchJump(&emitter, chain, cloxEmitterOffset(&emitter));
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JMP, loop);
+
+    /* the stack form: if (sum <= 0) abort */
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitConstant(&emitter, 4, cloxSIntValue(0));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 4);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t skip = cloxEmitJump(&emitter, CLOX_OP_CODE_JGT, 0);
+
+    cloxEmitByte(&emitter, CLOX_OP_CODE_ABORT);
+    cloxEmitterPatchJump(&emitter, skip, cloxEmitterOffset(&emitter));
+
+    cloxFreeEmitter(&emitter);
+}
+
+static bool_t contains(const CloxCodeBlock_t *const block, const CloxOpCode_t opCode)
+{
+    CloxCodeBlockReader_t reader;
+    CloxOpCodeInfo_t opCodeInfo;
+
+    cloxInitCodeBlockReader(&reader, block);
+
+    while (!cloxCodeBlockReaderIsAtEnd(&reader))
+    {
+        cloxGetOpCodeInfo(reader.array[reader.index], &opCodeInfo);
+
+        if (opCodeInfo.code == opCode)
+            return TRUE;
+
+        reader.index += cloxGetOpKindSize(opCodeInfo.kind);
+    }
+
+    return FALSE;
+}
+
+int main()
+{
+    CloxCodeBlock_t plain, fused;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&plain, 0);
+    cloxInitCodeBlock(&fused, 0);
+    emitProgram(&plain);
+    emitProgram(&fused);
+
+    check(cloxCodeBlockPeephole(&plain, CLOX_PEEPHOLE_NONE) == 0);
+    check(cloxCodeBlockPeephole(&fused, CLOX_PEEPHOLE_ALL) > 0);
+    check(fused.count < plain.count);
+    check(contains(&fused, CLOX_OP_CODE_RJGE));
+    check(contains(&fused, CLOX_OP_CODE_RADC));
+    check(contains(&fused, CLOX_OP_CODE_CJGT));
+    check(!contains(&fused, CLOX_OP_CODE_RCMP));
+
+    cloxDisassembleCodeBlock(stdout, &fused);
+
+    cloxInitVM(&vm, 0);
+
+    check(cloxVMRun(&vm, &plain) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsSInt(vm.registers[0]) == 4950);
+    check(cloxVMRun(&vm, &fused) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsSInt(vm.registers[0]) == 4950);
+    check(cloxValueAsSInt(vm.registers[3]) == 1);
+
+    /* a block allocated from an arena gives back the scratch data */
+    CloxArena_t arena;
+    CloxCodeBlock_t *scratch;
+    size_t allocated;
+
+    cloxInitArena(&arena, 0);
+    scratch = cloxCreateCodeBlockInArena(0, &arena);
+    emitProgram(scratch);
+
+    allocated = arena.allocated;
+    check(cloxCodeBlockPeephole(scratch, CLOX_PEEPHOLE_ALL) == plain.count - fused.count);
+    check(arena.allocated == allocated);
+    check(cloxVMRun(&vm, scratch) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsSInt(vm.registers[0]) == 4950);
+
+    cloxDeleteCodeBlock(scratch);
+    cloxFreeArena(&arena);
+
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&plain);
+    cloxFreeCodeBlock(&fused);
+
+    return 0;
+}
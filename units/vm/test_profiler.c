@@ -0,0 +1,154 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/profiler.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static void mark(CloxEmitter_t *const emitter, const uint32_t line)
+{
+    CloxSourceLocation_t location;
+
+    cloxCodeBlockAddLine(emitter->codeBlock, cloxEmitterOffset(emitter), cloxSetSourceLocation(&location, 0, 0, line - 1));
+}
+
+/* f() is called from line 1, its loop is on line 4 and 5 */
+static void emitLoop(CloxCodeBlock_t *const block)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    mark(&emitter, 1);
+
+    const size_t call = cloxEmitCall(&emitter, CLOX_OP_CODE_CALL, 0, 0);
+    const size_t skip = cloxEmitJump(&emitter, CLOX_OP_CODE_JMP, 0);
+
+    mark(&emitter, 3);
+
+    const size_t f = cloxEmitConstant(&emitter, 0, cloxSIntValue(0));
+
+    cloxEmitterPatchJump(&emitter, call, f);
+    cloxEmitConstant(&emitter, 1, cloxSIntValue(1));
+    cloxEmitConstant(&emitter, 2, cloxSIntValue(200000));
+
+    mark(&emitter, 4);
+
+    const size_t loop = cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t exit = cloxEmitJump(&emitter, CLOX_OP_CODE_JGE, 0);
+
+    mark(&emitter, 5);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 0, 0, 1);
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JMP, loop);
+
+    mark(&emitter, 6);
+
+    cloxEmitterPatchJump(&emitter, exit, cloxEmitterOffset(&emitter));
+    cloxEmitByte(&emitter, CLOX_OP_CODE_RET);
+    cloxCodeBlockAddSymbol(block, f, cloxEmitterOffset(&emitter), "f", 1);
+    cloxEmitterPatchJump(&emitter, skip, cloxEmitterOffset(&emitter));
+
+    cloxFreeEmitter(&emitter);
+}
+
+/* every sample is taken at the backward jump, in f called from line 1 of the
+ * top-level code */
+static int checkProfile(const CloxProfiler_t *const profiler, const CloxCodeBlock_t *const block)
+{
+    uint64_t samples = 0;
+
+    check(profiler->samplesCount >= 200000 / CLOX_PROFILER_INTERVAL / 2);
+    check(profiler->stacksCount == 1);
+
+    for (size_t i = 0; i < profiler->stacksCount; i++)
+        samples += profiler->stacks[i].samples;
+
+    check(samples == profiler->samplesCount);
+    check(profiler->stacks[0].codeBlock == block);
+    check(profiler->stacks[0].depth == 2);
+    check(profiler->lines[profiler->stacks[0].position] == 1);
+    check(profiler->lines[profiler->stacks[0].position + 1] == 4);
+    check(profiler->functions[profiler->stacks[0].position] == 0);
+    check(!strcmp(cloxCodeBlockGetName(block, profiler->functions[profiler->stacks[0].position + 1] - 1), "f"));
+
+    return 0;
+}
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxProfiler_t profiler;
+    CloxVM_t vm;
+    char text[64], expected[64];
+
+    const CloxCodeBlock_t *const blocks[] = { &block };
+    const char *const names[] = { "loop.lox" };
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitVM(&vm, 0);
+
+    emitLoop(&block);
+
+    /* without a profiler nothing is sampled */
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsSInt(vm.registers[0]) == 200000);
+
+    /* a period of one nanosecond samples at each clock read, on the bytecode */
+    cloxInitProfiler(&profiler, 1);
+    vm.profiler = &profiler;
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(checkProfile(&profiler, &block) == 0);
+
+    cloxFreeProfiler(&profiler);
+
+    /* and on the records (and the compiled regions) */
+    cloxInitProfiler(&profiler, 1);
+
+    check(cloxVMDecode(&block));
+
+    for (int i = 0; i < 3; i++)
+        check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+
+    check(checkProfile(&profiler, &block) == 0);
+
+    /* the samples are written as collapsed stacks */
+    FILE *const stream = tmpfile();
+
+    check(stream != NULL);
+    check(cloxProfilerWrite(&profiler, stream, blocks, names, 1));
+    check(cloxProfilerWrite(&profiler, stream, NULL, NULL, 0));
+
+    rewind(stream);
+
+    snprintf(expected, sizeof(expected), "loop.lox:1;loop.lox:f:4 %llu\n", (unsigned long long)profiler.samplesCount);
+    check(fgets(text, sizeof(text), stream) && !strcmp(text, expected));
+
+    snprintf(expected, sizeof(expected), "?:1;?:4 %llu\n", (unsigned long long)profiler.samplesCount);
+    check(fgets(text, sizeof(text), stream) && !strcmp(text, expected));
+    check(!fgets(text, sizeof(text), stream));
+
+    fclose(stream);
+    cloxFreeProfiler(&profiler);
+
+    /* a period longer than the run takes no sample */
+    cloxInitProfiler(&profiler, UINT64_C(1) << 62);
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(profiler.samplesCount == 0 && profiler.stacksCount == 0);
+
+    vm.profiler = NULL;
+
+    cloxFreeProfiler(&profiler);
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
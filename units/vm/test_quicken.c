@@ -0,0 +1,161 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+
+/* sum = zero; i = start; do { sum = sum + i; i = i + 1; } while (i < limit); total = sum
+ * after the peephole pass the loop is 'add', 'radc' and 'cjlt' */
+static void emitLoop(CloxCodeBlock_t *const block)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_LDG, 0, cloxCodeBlockAddName(block, "zero", 4));
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_LDG, 1, cloxCodeBlockAddName(block, "start", 5));
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_LDG, 2, cloxCodeBlockAddName(block, "limit", 5));
+
+    const size_t loop = cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_ADD);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_POP, 0);
+    cloxEmitConstant(&emitter, 3, cloxSIntValue(1));
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 1, 1, 3);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JLT, loop);
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_STG, 0, cloxCodeBlockAddName(block, "total", 5));
+
+    cloxFreeEmitter(&emitter);
+    cloxCodeBlockPeephole(block, CLOX_PEEPHOLE_ALL);
+}
+
+/* the record of the first instruction with the specified opcode */
+static const CloxDecodedInstruction_t *find(const CloxCodeBlock_t *const block, const CloxOpCode_t opCode)
+{
+    for (size_t i = 0; i < block->decoded.count; i++)
+        if (block->array[block->decoded.offsets[i]] == opCode)
+            return &block->decoded.instructions[i];
+
+    return NULL;
+}
+
+/* the records of the loop are in the specified forms, without quickening they
+ * keep their opcodes */
+static int checkForms(const CloxCodeBlock_t *const block, const int add, const int radc, const int cjlt)
+{
+#if CLOX_VM_QUICKENING
+    check(find(block, CLOX_OP_CODE_ADD)->opCode == add);
+    check(find(block, CLOX_OP_CODE_RADC)->opCode == radc);
+    check(find(block, CLOX_OP_CODE_CJLT)->opCode == cjlt);
+#else
+    (void)add;
+    (void)radc;
+    (void)cjlt;
+
+    check(find(block, CLOX_OP_CODE_ADD)->opCode == CLOX_OP_CODE_ADD);
+    check(find(block, CLOX_OP_CODE_RADC)->opCode == CLOX_OP_CODE_RADC);
+    check(find(block, CLOX_OP_CODE_CJLT)->opCode == CLOX_OP_CODE_CJLT);
+#endif
+
+    return 0;
+}
+
+static CloxVMStatus_t run(CloxVM_t *const vm, const CloxCodeBlock_t *const block, const CloxValue_t zero, const CloxValue_t start, const CloxValue_t limit)
+{
+    *cloxVMGetGlobal(vm, "zero")  = zero;
+    *cloxVMGetGlobal(vm, "start") = start;
+    *cloxVMGetGlobal(vm, "limit") = limit;
+
+    return cloxVMRun(vm, block);
+}
+
+static CloxOpCodeStats_t stats[BYTE_MAX + 1];
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitVM(&vm, 0);
+
+    emitLoop(&block);
+
+    check(cloxVMDefineGlobal(&vm, "zero", cloxVoidValue()));
+    check(cloxVMDefineGlobal(&vm, "start", cloxVoidValue()));
+    check(cloxVMDefineGlobal(&vm, "limit", cloxVoidValue()));
+    check(cloxVMDefineGlobal(&vm, "total", cloxVoidValue()));
+
+    check(cloxVMDecode(&block));
+    check(find(&block, CLOX_OP_CODE_ADD) && find(&block, CLOX_OP_CODE_RADC) && find(&block, CLOX_OP_CODE_CJLT));
+    check(checkForms(&block, CLOX_OP_CODE_ADD, CLOX_OP_CODE_RADC, CLOX_OP_CODE_CJLT) == 0);
+
+    const void *const handler = find(&block, CLOX_OP_CODE_ADD)->handler;
+
+    /* the first run specializes the records for the integers it sees */
+    check(run(&vm, &block, cloxSIntValue(0), cloxSIntValue(0), cloxSIntValue(100)) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueType(*cloxVMGetGlobal(&vm, "total")) == CLOX_VALUE_TYPE_SINT);
+    check(cloxValueAsSInt(*cloxVMGetGlobal(&vm, "total")) == 4950);
+    check(checkForms(&block, CLOX_QUICK_OP_CODE_ADD_SINT, CLOX_QUICK_OP_CODE_RADC_SINT, CLOX_QUICK_OP_CODE_CJLT_SINT) == 0);
+    check((find(&block, CLOX_OP_CODE_ADD)->handler != handler) == (CLOX_VM_QUICKENING && CLOX_VM_COMPUTED_GOTO));
+
+    /* the counters see the quickened records as their instructions */
+    if (cloxVMGetOpCodeStats(&vm, stats))
+    {
+        check(stats[CLOX_OP_CODE_ADD].count == 100);
+        check(stats[CLOX_OP_CODE_CJLT].count == 100);
+
+        cloxVMResetOpCodeStats(&vm);
+    }
+
+    /* reals fail the guards: the records go back to the generic forms and the
+     * results are the ones of the generic instructions */
+    check(run(&vm, &block, cloxRealValue(0.0), cloxRealValue(0.5), cloxRealValue(100.0)) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueType(*cloxVMGetGlobal(&vm, "total")) == CLOX_VALUE_TYPE_REAL);
+    check(cloxValueAsReal(*cloxVMGetGlobal(&vm, "total")) == 5000.0);
+    check(checkForms(&block, CLOX_QUICK_OP_CODE_ADD_ANY, CLOX_QUICK_OP_CODE_RADC_ANY, CLOX_QUICK_OP_CODE_CJLT_ANY) == 0);
+
+    /* and stay there, whatever they see next */
+    check(run(&vm, &block, cloxSIntValue(0), cloxSIntValue(0), cloxSIntValue(100)) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsSInt(*cloxVMGetGlobal(&vm, "total")) == 4950);
+    check(checkForms(&block, CLOX_QUICK_OP_CODE_ADD_ANY, CLOX_QUICK_OP_CODE_RADC_ANY, CLOX_QUICK_OP_CODE_CJLT_ANY) == 0);
+
+    /* mixed operands select the generic forms at once */
+    cloxCodeBlockInvalidate(&block);
+
+    check(cloxVMDecode(&block));
+    check(run(&vm, &block, cloxSIntValue(0), cloxRealValue(0.5), cloxRealValue(100.0)) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsReal(*cloxVMGetGlobal(&vm, "total")) == 5000.0);
+    check(checkForms(&block, CLOX_QUICK_OP_CODE_ADD_ANY, CLOX_QUICK_OP_CODE_RADC_REAL, CLOX_QUICK_OP_CODE_CJLT_REAL) == 0);
+
+    /* records decoded again are specialized for the reals they see first */
+    cloxCodeBlockInvalidate(&block);
+
+    check(cloxVMDecode(&block));
+    check(run(&vm, &block, cloxRealValue(0.0), cloxRealValue(0.5), cloxRealValue(100.0)) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsReal(*cloxVMGetGlobal(&vm, "total")) == 5000.0);
+    check(checkForms(&block, CLOX_QUICK_OP_CODE_ADD_REAL, CLOX_QUICK_OP_CODE_RADC_REAL, CLOX_QUICK_OP_CODE_CJLT_REAL) == 0);
+
+    /* NaNs pass the guards of the reals, but they are still not comparable */
+    const real_t nan = 0.0 / 0.0;
+
+    check(run(&vm, &block, cloxRealValue(0.0), cloxRealValue(nan), cloxRealValue(100.0)) == CLOX_VM_STATUS_SUCCESS);
+    check(vm.cf == 3);
+    check(cloxValueAsReal(*cloxVMGetGlobal(&vm, "total")) != cloxValueAsReal(*cloxVMGetGlobal(&vm, "total")));
+    check(checkForms(&block, CLOX_QUICK_OP_CODE_ADD_REAL, CLOX_QUICK_OP_CODE_RADC_REAL, CLOX_QUICK_OP_CODE_CJLT_REAL) == 0);
+
+    /* the errors are the ones of the generic instructions */
+    check(run(&vm, &block, cloxBoolValue(TRUE), cloxSIntValue(0), cloxSIntValue(100)) == CLOX_VM_STATUS_ERROR);
+    check(vm.ip == block.array + block.decoded.offsets[find(&block, CLOX_OP_CODE_ADD) - block.decoded.instructions] + 1);
+    check(checkForms(&block, CLOX_QUICK_OP_CODE_ADD_ANY, CLOX_QUICK_OP_CODE_RADC_REAL, CLOX_QUICK_OP_CODE_CJLT_REAL) == 0);
+
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
@@ -0,0 +1,205 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/shape.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *CLOX_STDCALL twice(CloxVM_t *const vm, CloxValue_t *const arguments, const size_t count)
+{
+    (void)vm;
+    (void)count;
+
+    if ((cloxValueType(arguments[0]) != CLOX_VALUE_TYPE_OBJT) || (cloxValueAsObject(arguments[0])->kind != CLOX_OBJECT_KIND_INSTANCE))
+        return "receiver is not an instance";
+
+    arguments[0] = cloxSIntValue(cloxValueAsSInt(arguments[1]) * 2);
+
+    return NULL;
+}
+
+static int testShapes(CloxVM_t *const vm)
+{
+    const CloxString_t *const x = cloxStringTableIntern(&vm->strings, "x", 1);
+    const CloxString_t *const y = cloxStringTableIntern(&vm->strings, "y", 1);
+    const CloxString_t *const z = cloxStringTableIntern(&vm->strings, "z", 1);
+
+    CloxObject_t *const a = cloxNewInstance(&vm->heap, &vm->shapes, 2);
+    cloxVMPush(vm, cloxObjtValue(a));
+    CloxObject_t *const b = cloxNewInstance(&vm->heap, &vm->shapes, 2);
+    cloxVMPush(vm, cloxObjtValue(b));
+    CloxObject_t *const c = cloxNewInstance(&vm->heap, &vm->shapes, 0);
+    cloxVMPush(vm, cloxObjtValue(c));
+
+    CloxValue_t value;
+
+    check(cloxInstanceShape(a) == &vm->shapes.root);
+
+    /* the same properties in the same order share the shape */
+    check(cloxInstanceSet(&vm->heap, &vm->shapes, a, x, cloxSIntValue(1)));
+    check(cloxInstanceSet(&vm->heap, &vm->shapes, a, y, cloxSIntValue(2)));
+    check(cloxInstanceSet(&vm->heap, &vm->shapes, b, x, cloxSIntValue(3)));
+    check(cloxInstanceSet(&vm->heap, &vm->shapes, b, y, cloxSIntValue(4)));
+    check(cloxInstanceShape(a) == cloxInstanceShape(b));
+    check(cloxInstanceShape(a)->count == 2);
+    check(vm->shapes.count == 3);
+
+    /* another order is another layout */
+    check(cloxInstanceSet(&vm->heap, &vm->shapes, c, y, cloxSIntValue(5)));
+    check(cloxInstanceSet(&vm->heap, &vm->shapes, c, x, cloxSIntValue(6)));
+    check(cloxInstanceShape(c) != cloxInstanceShape(a));
+    check(cloxShapeLookup(cloxInstanceShape(c), x) == 1);
+    check(cloxShapeLookup(cloxInstanceShape(a), x) == 0);
+    check(vm->shapes.count == 5);
+
+    /* updates don't move the instance */
+    check(cloxInstanceSet(&vm->heap, &vm->shapes, a, x, cloxSIntValue(7)));
+    check(cloxInstanceShape(a) == cloxInstanceShape(b));
+    check(cloxInstanceGet(a, x, &value) && (cloxValueAsSInt(value) == 7));
+    check(!cloxInstanceGet(a, z, &value));
+
+    /* the properties beyond the capacity go into the overflow array, which
+     * survives a collection with the values it stores */
+    check(cloxInstanceSet(&vm->heap, &vm->shapes, b, z, cloxObjtValue(c)));
+    check(cloxValueType(cloxObjectValues(b)[CLOX_INSTANCE_OVERFLOW]) == CLOX_VALUE_TYPE_OBJT);
+
+    cloxHeapCollect(&vm->heap);
+
+    check(cloxInstanceGet(b, z, &value) && (cloxValueAsObject(value) == c));
+    check(cloxInstanceGet(b, y, &value) && (cloxValueAsSInt(value) == 4));
+    check(cloxInstanceGet(c, y, &value) && (cloxValueAsSInt(value) == 5));
+
+    cloxVMPop(vm);
+    cloxVMPop(vm);
+    cloxVMPop(vm);
+
+    return 0;
+}
+
+static uint16_t cacheSlot(const CloxCodeBlock_t *const block, const size_t offset)
+{
+    return cloxDecodeOpHalf(block->array + offset + 4);
+}
+
+/* a = { x: 1 }; b = { y: 7, x: 2 }; sum = 0;
+ * for (i = 0; i < 2; i++) { sum += a.x; swap(a, b) }
+ * a.twice = twice; result = a.twice(sum); a.missing */
+static size_t emitProgram(CloxCodeBlock_t *const block, size_t *const outGetter)
+{
+    CloxEmitter_t emitter;
+
+    const size_t x = cloxCodeBlockAddName(block, "x", 1);
+    const size_t y = cloxCodeBlockAddName(block, "y", 1);
+
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_NEWO, 0, 0);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 1, 1);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_SETP, 1, x);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_NEWO, 2, 1);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 3, 7);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_SETP, 3, y);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 3, 2);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_SETP, 3, x);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 4, 0);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 5, 0);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 6, 1);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 7, 2);
+
+    const size_t loop = cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 5);
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 7);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t exitJump = cloxEmitJump(&emitter, CLOX_OP_CODE_JGE, 0);
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+
+    *outGetter = cloxEmitGlobal(&emitter, CLOX_OP_CODE_GETP, 8, x);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 4, 4, 8);
+    cloxEmitData(&emitter, CLOX_OP_CODE_MOV, 9, 0);
+    cloxEmitData(&emitter, CLOX_OP_CODE_MOV, 0, 2);
+    cloxEmitData(&emitter, CLOX_OP_CODE_MOV, 2, 9);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 5, 5, 6);
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JMP, loop);
+    cloxEmitterPatchJump(&emitter, exitJump, cloxEmitterOffset(&emitter));
+
+    const size_t method = cloxCodeBlockAddName(block, "twice", 5);
+
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_LDG, 10, method);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_SETP, 10, method);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 4);
+
+    const size_t call = cloxEmitGlobal(&emitter, CLOX_OP_CODE_INVK, 2, method);
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_POP, 11);
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_STG, 11, cloxCodeBlockAddName(block, "result", 6));
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitGlobal(&emitter, CLOX_OP_CODE_GETP, 8, cloxCodeBlockAddName(block, "missing", 7));
+
+    cloxFreeEmitter(&emitter);
+
+    return call;
+}
+
+static int runProgram(CloxVM_t *const vm, CloxCodeBlock_t *const block, const size_t getter, const size_t call)
+{
+    check(cloxVMRun(vm, block) == CLOX_VM_STATUS_RAISE);
+    check(vm->stackTop == vm->stack);
+    check(cloxValueAsSInt(*cloxVMGetGlobal(vm, "result")) == 6);
+
+    /* the getter has seen both layouts, the method call one */
+    check(vm->caches[cacheSlot(block, getter)].shapesCount == 2);
+    check(vm->caches[cacheSlot(block, call)].shapesCount == 1);
+    check(vm->caches[cacheSlot(block, call)].native == cloxVMGetNative(vm, "twice"));
+
+    /* undefined properties fail when they are read */
+    check(cloxVMResume(vm) == CLOX_VM_STATUS_ERROR);
+    check(vm->error != NULL);
+
+    return 0;
+}
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxVM_t vm;
+    size_t getter;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitVM(&vm, 0);
+
+    check(testShapes(&vm) == 0);
+
+    const size_t call = emitProgram(&block, &getter);
+
+    check(cloxVMDefineNative(&vm, "twice", &twice, 2));
+    check(cloxVMDefineGlobal(&vm, "twice", cloxVPtrValue((vptr_t)cloxVMGetNative(&vm, "twice"))));
+    check(cloxVMDefineGlobal(&vm, "result", cloxVoidValue()));
+
+    check(runProgram(&vm, &block, getter, call) == 0);
+
+    check(cloxVMDecode(&block));
+    check(runProgram(&vm, &block, getter, call) == 0);
+
+    /* a value that is not a registered native is not a method */
+    cloxVMDefineGlobal(&vm, "twice", cloxSIntValue(0));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+    check(strcmp(vm.error, "not a method") == 0);
+
+    cloxFreeCodeBlock(&block);
+    cloxFreeVM(&vm);
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "clox/vm/table.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define KEYS_COUNT 1000
+
+int main()
+{
+    CloxStringTable_t strings;
+    CloxTable_t table;
+    CloxString_t colliding[8];
+    const CloxString_t *keys[KEYS_COUNT];
+    char name[16];
+    uint32_t epoch;
+    size_t i;
+
+    cloxInitStringTable(&strings, NULL);
+    cloxInitTable(&table);
+
+    for (i = 0; i < KEYS_COUNT; i++)
+    {
+        snprintf(name, sizeof(name), "k%zu", i);
+        keys[i] = cloxStringTableIntern(&strings, name, strlen(name));
+    }
+
+    check(cloxTableFind(&table, keys[0]) == NULL);
+    check(!cloxTableDelete(&table, keys[0]));
+
+    /* a new key is added once, then its value is replaced */
+    check(cloxTableSet(&table, keys[0], cloxRealValue(1)));
+    check(!cloxTableSet(&table, keys[0], cloxRealValue(2)));
+    check(table.count == 1);
+    check(cloxValueAsReal(cloxTableFind(&table, keys[0])->value) == 2);
+
+    /* adding keys without growing never moves the entries */
+    CloxTableEntry_t *const entry = cloxTableFind(&table, keys[0]);
+
+    epoch = table.epoch;
+    check(cloxTableSet(&table, keys[1], cloxRealValue(1)));
+    check(table.epoch == epoch && cloxTableFind(&table, keys[0]) == entry);
+
+    for (i = 0; i < KEYS_COUNT; i++)
+        cloxTableSet(&table, keys[i], cloxSIntValue((sint_t)i));
+
+    check(table.count == KEYS_COUNT);
+    check(table.epoch != epoch);
+    check((table.count * 4) <= (table.capacity * 3));
+
+    /* removing every other key keeps the others reachable */
+    for (i = 0; i < KEYS_COUNT; i += 2)
+        check(cloxTableDelete(&table, keys[i]));
+
+    check(table.count == KEYS_COUNT / 2);
+
+    for (i = 0; i < KEYS_COUNT; i++)
+    {
+        CloxTableEntry_t *const found = cloxTableFind(&table, keys[i]);
+
+        if (i % 2)
+            check(found && cloxValueAsSInt(found->value) == (sint_t)i);
+        else
+            check(found == NULL);
+    }
+
+    cloxFreeTable(&table);
+    cloxInitTable(&table);
+
+    /* keys with the same hash share a run, that a deletion shifts back */
+    for (i = 0; i < 8; i++)
+    {
+        colliding[i].chars  = "";
+        colliding[i].length = 0;
+        colliding[i].hash   = (i < 6) ? 14 : 15;
+    }
+
+    for (i = 0; i < 8; i++)
+        check(cloxTableSet(&table, &colliding[i], cloxSIntValue((sint_t)i)));
+
+    check(table.capacity == CLOX_TABLE_CAPACITY);
+
+    check(cloxTableDelete(&table, &colliding[0]));
+    check(cloxTableDelete(&table, &colliding[3]));
+    check(cloxTableDelete(&table, &colliding[7]));
+
+    for (i = 0; i < 8; i++)
+    {
+        CloxTableEntry_t *const found = cloxTableFind(&table, &colliding[i]);
+
+        if ((i == 0) || (i == 3) || (i == 7))
+            check(found == NULL);
+        else
+            check(found && cloxValueAsSInt(found->value) == (sint_t)i);
+    }
+
+    /* no slot is left marked, so the deleted slots are empty again */
+    for (i = 0, epoch = 0; i < table.capacity; i++)
+        epoch += (table.entries[i].key != NULL);
+
+    check(epoch == table.count && table.count == 5);
+
+    cloxFreeTable(&table);
+    cloxFreeStringTable(&strings);
+
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/trace.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+
+#define LIMIT 2000
+
+/* i = 0; while (i < LIMIT) i = i + 1, so 7 + 6 * LIMIT instructions */
+static void emitLoop(CloxCodeBlock_t *const block)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitConstant(&emitter, 0, cloxSIntValue(0));
+    cloxEmitConstant(&emitter, 1, cloxSIntValue(1));
+    cloxEmitConstant(&emitter, 2, cloxSIntValue(LIMIT));
+
+    const size_t loop = cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 2);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t exit = cloxEmitJump(&emitter, CLOX_OP_CODE_JGE, 0);
+
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 0, 0, 1);
+    cloxEmitJumpTo(&emitter, CLOX_OP_CODE_JMP, loop);
+    cloxEmitterPatchJump(&emitter, exit, cloxEmitterOffset(&emitter));
+
+    cloxFreeEmitter(&emitter);
+}
+
+#if CLOX_VM_TRACE
+/* the last records of a run are the exit test of the loop */
+static int checkExit(const CloxTraceRecord_t *const records, const size_t count)
+{
+    check(count >= 4);
+    check(records[count - 4].opCode == CLOX_OP_CODE_PSH && records[count - 4].type == CLOX_TRACE_TYPE_NONE && records[count - 4].depth == 0);
+    check(records[count - 3].opCode == CLOX_OP_CODE_PSH && records[count - 3].type == (byte_t)CLOX_VALUE_TYPE_SINT && records[count - 3].depth == 1);
+    check(records[count - 2].opCode == CLOX_OP_CODE_CMP && records[count - 2].depth == 2);
+    check(records[count - 1].opCode == CLOX_OP_CODE_JGE && records[count - 1].depth == 0);
+    check(records[count - 1].offset > records[count - 4].offset);
+
+    return 0;
+}
+#endif
+
+static CloxTraceRecord_t records[64];
+
+int main()
+{
+    CloxCodeBlock_t block;
+    CloxTrace_t trace;
+    CloxVM_t vm;
+
+    /* the ring keeps the most recent records, the snapshots skip the oldest
+     * one that the writer may be overwriting */
+    cloxInitTrace(&trace, 5, NULL);
+    check(trace.capacity == 8);
+
+    for (uint32_t i = 0; i < 20; i++)
+        cloxTraceRecord(&trace, i, CLOX_OP_CODE_NOP, CLOX_TRACE_TYPE_NONE, 0);
+
+    check(cloxTraceSnapshot(&trace, records, countof(records)) == 7);
+    check(records[0].offset == 13 && records[6].offset == 19);
+    check(cloxTraceSnapshot(&trace, records, 3) == 3);
+    check(records[0].offset == 17 && records[2].offset == 19);
+    check(cloxTraceFlush(&trace));
+
+    /* it can be written afterwards */
+    FILE *stream = tmpfile();
+
+    check(stream != NULL);
+    check(cloxTraceWrite(&trace, stream));
+
+    rewind(stream);
+
+    check(cloxTraceReadHeader(stream));
+    check(cloxTraceRead(stream, records, countof(records)) == 8);
+    check(records[0].offset == 12 && records[7].offset == 19);
+
+    fclose(stream);
+    cloxFreeTrace(&trace);
+
+    /* with a stream every record is flushed, each half of the ring once it is
+     * complete and the rest on demand */
+    stream = tmpfile();
+
+    check(stream != NULL);
+
+    cloxInitTrace(&trace, 4, stream);
+
+    for (uint32_t i = 0; i < 11; i++)
+        cloxTraceRecord(&trace, i, CLOX_OP_CODE_NOP, CLOX_TRACE_TYPE_NONE, 0);
+
+    check(trace.flushed == 10);
+    check(cloxTraceFlush(&trace));
+    check(trace.flushed == 11);
+
+    rewind(stream);
+
+    check(cloxTraceReadHeader(stream));
+    check(cloxTraceRead(stream, records, countof(records)) == 11);
+
+    for (uint32_t i = 0; i < 11; i++)
+        check(records[i].offset == i);
+
+    /* anything else is refused */
+    rewind(stream);
+    fputc(0, stream);
+    rewind(stream);
+
+    check(!cloxTraceReadHeader(stream));
+
+    fclose(stream);
+    cloxFreeTrace(&trace);
+
+    /* the virtual machine records each instruction it executes */
+    cloxInitCodeBlock(&block, 0);
+    cloxInitVM(&vm, 0);
+
+    emitLoop(&block);
+
+    cloxInitTrace(&trace, CLOX_TRACE_CAPACITY, NULL);
+    vm.trace = &trace;
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(cloxValueAsSInt(vm.registers[0]) == LIMIT);
+
+#if CLOX_VM_TRACE
+    check(trace.head == 7 + 6 * LIMIT);
+    check(cloxTraceSnapshot(&trace, records, countof(records)) == countof(records));
+    check(checkExit(records, countof(records)) == 0);
+#else
+    check(trace.head == 0);
+#endif
+
+    /* the same records are taken on the decoded block, also past the threshold
+     * of the JIT tier */
+    check(cloxVMDecode(&block));
+
+    for (int i = 0; i < 3; i++)
+    {
+        trace.head = 0;
+
+        check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+        check(cloxValueAsSInt(vm.registers[0]) == LIMIT);
+
+#if CLOX_VM_TRACE
+        check(trace.head == 7 + 6 * LIMIT);
+        check(cloxTraceSnapshot(&trace, records, countof(records)) == countof(records));
+        check(checkExit(records, countof(records)) == 0);
+#endif
+    }
+
+    /* without a trace nothing is recorded */
+    vm.trace = NULL;
+    trace.head = 0;
+
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(trace.head == 0);
+
+    cloxFreeTrace(&trace);
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include "clox/vm/value.h"
+
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static const char *dump(const CloxValue_t value)
+{
+    static char buffer[64];
+
+    FILE *const stream = tmpfile();
+    size_t length;
+
+    cloxDumpValue(stream, &value);
+    rewind(stream);
+    length = fread(buffer, 1, sizeof(buffer) - 1, stream);
+    buffer[length] = '\0';
+    fclose(stream);
+
+    return buffer;
+}
+
+int main()
+{
+    int x;
+
+    check(cloxValueType(cloxVoidValue()) == CLOX_VALUE_TYPE_VOID);
+    check(cloxValueType(cloxBoolValue(TRUE)) == CLOX_VALUE_TYPE_BOOL && cloxValueAsBool(cloxBoolValue(TRUE)));
+    check(cloxValueType(cloxByteValue(0xAB)) == CLOX_VALUE_TYPE_BYTE && cloxValueAsByte(cloxByteValue(0xAB)) == 0xAB);
+    check(cloxValueType(cloxUIntValue(7)) == CLOX_VALUE_TYPE_UINT && cloxValueAsUInt(cloxUIntValue(7)) == 7);
+    check(cloxValueType(cloxSIntValue(-7)) == CLOX_VALUE_TYPE_SINT && cloxValueAsSInt(cloxSIntValue(-7)) == -7);
+    check(cloxValueType(cloxRealValue(-2.5)) == CLOX_VALUE_TYPE_REAL && cloxValueAsReal(cloxRealValue(-2.5)) == -2.5);
+    check(cloxValueType(cloxVPtrValue(&x)) == CLOX_VALUE_TYPE_VPTR && cloxValueAsVPtr(cloxVPtrValue(&x)) == &x);
+    check(cloxValueType(cloxRealValue(0.0 / 0.0)) == CLOX_VALUE_TYPE_REAL);
+
+    check(!strcmp(dump(cloxVoidValue()), "void"));
+    check(!strcmp(dump(cloxBoolValue(FALSE)), "false"));
+    check(!strcmp(dump(cloxByteValue(0x0F)), "0F"));
+    check(!strcmp(dump(cloxUIntValue(42)), "42"));
+    check(!strcmp(dump(cloxSIntValue(-42)), "-42"));
+    check(!strcmp(dump(cloxRealValue(1.5)), "1.5"));
+
+#if CLOX_VALUE_NAN_BOXING
+    check(sizeof(CloxValue_t) == 8);
+#endif
+
+    return 0;
+}
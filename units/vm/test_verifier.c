@@ -0,0 +1,185 @@
+#include "clox/vm/emitter.h"
+#include "clox/vm/verifier.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+
+/* sum(n) = n ? n + sum(n - 1) : 0, the result is returned on the stack */
+static void emitRecursion(CloxCodeBlock_t *const block, const int16_t n)
+{
+    CloxEmitter_t emitter;
+
+    cloxInitEmitter(&emitter, block);
+
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_ENT, 1, 0);
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 0, (uint16_t)n);
+
+    const size_t call = cloxEmitCall(&emitter, CLOX_OP_CODE_CALL, 0, 1);
+
+    cloxEmitByte(&emitter, CLOX_OP_CODE_LEV);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0);
+
+    const size_t sum = cloxEmitCtrl(&emitter, CLOX_OP_CODE_ENT, 3, 1);
+
+    cloxEmitterPatchJump(&emitter, call, sum);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 1, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_CMP);
+
+    const size_t base = cloxEmitJump(&emitter, CLOX_OP_CODE_JEQ, 0);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 1, 1);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RSUB, 2, 0, 1);
+    cloxEmitCall(&emitter, CLOX_OP_CODE_CALL, sum, 1);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_POP, 1);
+    cloxEmitRegs(&emitter, CLOX_OP_CODE_RADD, 1, 0, 1);
+    cloxEmitterPatchJump(&emitter, base, cloxEmitterOffset(&emitter));
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 1);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_RET);
+
+    cloxFreeEmitter(&emitter);
+}
+
+static int testRecursion(CloxVM_t *const vm)
+{
+    CloxCodeBlock_t block;
+
+    cloxInitCodeBlock(&block, 0);
+    emitRecursion(&block, 100);
+
+    check(cloxVMDecode(&block));
+    check(block.depths != NULL);
+
+    /* the top-level code has the result of the call on the stack after it,
+     * the instructions of the procedure are relative to its entry */
+    check(block.depths[0] == 0 && block.depths[2] == 0);
+    check(block.depths[3] == 1 && block.depths[4] == 1);
+    check(block.depths[5] == CLOX_VERIFIER_DEPTH_UNKNOWN);
+    check(block.depths[block.decoded.count] == CLOX_VERIFIER_DEPTH_UNKNOWN);
+
+    check(cloxVMRun(vm, &block) == CLOX_VM_STATUS_RAISE);
+    check(vm->stackTop == vm->stack + 1);
+    check(cloxValueAsSInt(cloxVMPop(vm)) == 5050);
+
+    /* modifying the bytecode drops the proof with the decoded form */
+    cloxCodeBlockInvalidate(&block);
+    check(block.depths == NULL);
+
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
+
+/* a value is kept on the stack across a 'break', the execution resumes
+ * without checks only when it is still there */
+static int testResume(CloxVM_t *const vm)
+{
+    CloxCodeBlock_t block;
+    CloxEmitter_t emitter;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxInitEmitter(&emitter, &block);
+
+    cloxEmitData(&emitter, CLOX_OP_CODE_LDC, 0, 7);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_PSH, 0);
+    cloxEmitByte(&emitter, CLOX_OP_CODE_BREAK);
+    cloxEmitFast(&emitter, CLOX_OP_CODE_POP, 1);
+    cloxEmitCtrl(&emitter, CLOX_OP_CODE_RAISE, 1, 0);
+
+    cloxFreeEmitter(&emitter);
+
+    check(cloxVMDecode(&block));
+    check(block.depths != NULL && block.depths[3] == 1);
+
+    check(cloxVMRun(vm, &block) == CLOX_VM_STATUS_BREAK);
+    check(cloxVMResume(vm) == CLOX_VM_STATUS_RAISE);
+    check(vm->stackTop == vm->stack);
+
+    check(cloxVMRun(vm, &block) == CLOX_VM_STATUS_BREAK);
+    cloxVMPop(vm);
+    check(cloxVMResume(vm) == CLOX_VM_STATUS_ERROR);
+    check(vm->error != NULL);
+
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}
+
+static bool_t verify(const byte_t *const bytes, const size_t count)
+{
+    CloxCodeBlock_t block;
+    bool_t verified;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxCodeBlockWrite(&block, bytes, count);
+
+    verified = cloxCodeBlockVerify(&block);
+
+    cloxFreeCodeBlock(&block);
+
+    return verified;
+}
+
+static int testRejected(void)
+{
+    /* underflows */
+    byte_t pop[] = { CLOX_OP_CODE_POP, 0 };
+    byte_t add[] = { CLOX_OP_CODE_PSH, 0, CLOX_OP_CODE_ADD };
+
+    check(!verify(pop, sizeof(pop)));
+    check(!verify(add, sizeof(add)));
+
+    /* a constant that doesn't exist */
+    byte_t lec[] = { CLOX_OP_CODE_LEC, 0, 5, 0 };
+
+    check(!verify(lec, sizeof(lec)));
+
+    /* the paths merge at another depth */
+    byte_t merge[] = { CLOX_OP_CODE_JEQ, 2, 0, 0, 0, 0, CLOX_OP_CODE_PSH, 0, CLOX_OP_CODE_NOP };
+
+    check(!verify(merge, sizeof(merge)));
+
+    /* a jump into an instruction */
+    byte_t jump[] = { CLOX_OP_CODE_JMP, 1, 0, 0, 0, 0, CLOX_OP_CODE_PSH, 0 };
+
+    check(!verify(jump, sizeof(jump)));
+
+    /* a procedure that returns one or two values */
+    byte_t ret[] = {
+        CLOX_OP_CODE_CALL, 4, 0, 0, 0, 0,
+        CLOX_OP_CODE_EXIT, 0, 0, 0,
+        CLOX_OP_CODE_PSH, 0,
+        CLOX_OP_CODE_JEQ, 2, 0, 0, 0, 0,
+        CLOX_OP_CODE_PSH, 0,
+        CLOX_OP_CODE_RET,
+    };
+
+    check(!verify(ret, sizeof(ret)));
+
+    /* the same procedure returning always one value */
+    ret[18] = CLOX_OP_CODE_NOP;
+    ret[19] = CLOX_OP_CODE_NOP;
+
+    check(verify(ret, sizeof(ret)));
+
+    return 0;
+}
+
+int main()
+{
+    CloxVM_t vm;
+
+    cloxInitVM(&vm, 0);
+
+    check(testRecursion(&vm) == 0);
+    check(testResume(&vm) == 0);
+    check(testRejected() == 0);
+
+    cloxFreeVM(&vm);
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include "clox/vm/debug.h"
+#include "clox/vm/code.h"
+#include "clox/vm/vm.h"
+
+#include "check.h"
+
+#include <stdio.h>
+
+static byte_t *emitData(byte_t *ip, const CloxOpCode_t opCode, const byte_t z, const uint16_t x)
+{
+    *ip++ = (byte_t)opCode;
+    *ip++ = z;
+
+    return cloxEncodeOpHalf(ip, x);
+}
+
+static byte_t *emitFast(byte_t *ip, const CloxOpCode_t opCode, const byte_t x)
+{
+    *ip++ = (byte_t)opCode;
+    *ip++ = x;
+
+    return ip;
+}
+
+static byte_t *emitJump(byte_t *ip, const CloxOpCode_t opCode, const int32_t z)
+{
+    *ip++ = (byte_t)opCode;
+    ip = cloxEncodeOpWord(ip, (uint32_t)z);
+    *ip++ = 0;
+
+    return ip;
+}
+
+static CloxOpCodeStats_t stats[BYTE_MAX + 1];
+
+int main()
+{
+    byte_t program[64], *ip = program, *loop, *exit;
+
+    /* sum = 0; i = 1; while (i <= 10) { sum = sum + i; i = i + 1; } */
+    ip = emitData(ip, CLOX_OP_CODE_LDC, 0, 0);
+    ip = emitData(ip, CLOX_OP_CODE_LDC, 1, 1);
+    ip = emitData(ip, CLOX_OP_CODE_LDC, 2, 10);
+    ip = emitData(ip, CLOX_OP_CODE_LEC, 3, 0);
+
+    loop = ip;
+    ip = emitFast(ip, CLOX_OP_CODE_PSH, 1);
+    ip = emitFast(ip, CLOX_OP_CODE_PSH, 2);
+    *ip++ = CLOX_OP_CODE_CMP;
+    exit = ip;
+    ip = emitJump(ip, CLOX_OP_CODE_JGT, 0);
+    ip = emitFast(ip, CLOX_OP_CODE_PSH, 0);
+    ip = emitFast(ip, CLOX_OP_CODE_PSH, 1);
+    *ip++ = CLOX_OP_CODE_ADD;
+    ip = emitFast(ip, CLOX_OP_CODE_POP, 0);
+    ip = emitFast(ip, CLOX_OP_CODE_PSH, 1);
+    ip = emitFast(ip, CLOX_OP_CODE_PSH, 3);
+    *ip++ = CLOX_OP_CODE_ADD;
+    ip = emitFast(ip, CLOX_OP_CODE_POP, 1);
+    ip = emitJump(ip, CLOX_OP_CODE_JMP, (int32_t)(loop - (ip + 6)));
+
+    emitJump(exit, CLOX_OP_CODE_JGT, (int32_t)(ip - (exit + 6)));
+
+    *ip++ = CLOX_OP_CODE_BREAK;
+    ip = emitData(ip, CLOX_OP_CODE_LDC, 4, 0);
+    ip = emitFast(ip, CLOX_OP_CODE_PSH, 0);
+    ip = emitFast(ip, CLOX_OP_CODE_PSH, 4);
+    *ip++ = CLOX_OP_CODE_DIV;
+
+    CloxCodeBlock_t block;
+    CloxVM_t vm;
+
+    cloxInitCodeBlock(&block, 0);
+    cloxCodeBlockWrite(&block, (const byte_t *)program, (size_t)(ip - program));
+    check(cloxCodeBlockAddConstant(&block, cloxUIntValue(1)) == 0);
+    cloxDisassembleCodeBlock(stdout, &block);
+
+    cloxInitVM(&vm, 0);
+
+    /* the loop stops on 'break' */
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_BREAK);
+    check(cloxValueType(vm.registers[0]) == CLOX_VALUE_TYPE_SINT && cloxValueAsSInt(vm.registers[0]) == 55);
+    check(cloxValueAsSInt(vm.registers[1]) == 11);
+    check(vm.stackTop == vm.stack);
+
+    /* each execution is counted once, and falls into one histogram bucket */
+    if (cloxVMGetOpCodeStats(&vm, stats))
+    {
+        uint64_t total = 0;
+
+        check(stats[CLOX_OP_CODE_CMP].count == 11);
+        check(stats[CLOX_OP_CODE_JMP].count == 10);
+        check(stats[CLOX_OP_CODE_BREAK].count == 1);
+
+        for (size_t i = 0; i < CLOX_OP_CODE_HISTOGRAM_SIZE; i++)
+            total += stats[CLOX_OP_CODE_CMP].histogram[i];
+
+        check(total == 11);
+
+        cloxDumpOpCodeStats(stdout, stats);
+        cloxVMResetOpCodeStats(&vm);
+        cloxVMGetOpCodeStats(&vm, stats);
+    }
+
+    check(stats[CLOX_OP_CODE_CMP].count == 0);
+
+    /* then the division by zero is a runtime error */
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_ERROR);
+    check(vm.error != NULL);
+    check(cloxVMResume(&vm) == CLOX_VM_STATUS_ERROR);
+
+    /* truncated instructions are rejected */
+    cloxCodeBlockResize(&block, 0);
+    cloxCodeBlockPush(&block, CLOX_OP_CODE_JMP);
+    cloxCodeBlockPush(&block, 0);
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_ERROR);
+
+    /* exit code */
+    byte_t exitProgram[] = { CLOX_OP_CODE_NOP, CLOX_OP_CODE_EXIT, 42, 0, 0, CLOX_OP_CODE_ABORT };
+
+    cloxCodeBlockResize(&block, 0);
+    cloxCodeBlockWrite(&block, exitProgram, countof(exitProgram));
+    check(cloxVMRun(&vm, &block) == CLOX_VM_STATUS_SUCCESS);
+    check(vm.exitCode == 42);
+
+    cloxFreeVM(&vm);
+    cloxFreeCodeBlock(&block);
+
+    return 0;
+}